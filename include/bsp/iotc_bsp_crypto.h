@@ -121,6 +121,61 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(const iotc_crypto_key_data_t* private_key,
                                      const uint8_t* src_buf,
                                      size_t src_buf_size);
 
+/**
+ * @typedef iotc_bsp_ecc_key_t
+ * @brief A private key prepared for signing, e.g. parsed from its PEM.
+ *
+ * @details The SDK keeps the key for the lifetime of a
+ * {@link iotc_jwt_manager_create() JWT manager} so the signatures of the
+ * tokens it renews skip the key parsing. The structure is defined by the
+ * implementation.
+ */
+typedef struct iotc_bsp_ecc_key_s iotc_bsp_ecc_key_t;
+
+/**
+ * @brief Prepares a private key for iotc_bsp_ecc_key_sign().
+ *
+ * @param [in] private_key The private key data or slot number, as provided to
+ *     iotc_bsp_ecc().
+ * @param [out] key A pointer to the prepared key. The SDK releases it with
+ *     iotc_bsp_ecc_key_destroy().
+ *
+ * @returns A {@link iotc_bsp_crypto_state_e crytography function status}.
+ */
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_create(
+    const iotc_crypto_key_data_t* private_key, iotc_bsp_ecc_key_t** key);
+
+/**
+ * @brief Generates an Elliptic Curve signature with a prepared key.
+ *
+ * @details Produces the same signature format as iotc_bsp_ecc(). The SDK
+ * doesn't call this function for the same key from two threads at once.
+ *
+ * @param [in] key A key returned by iotc_bsp_ecc_key_create().
+ * @param [in,out] dst_buf A pointer to a buffer into which the function
+ *     stores the Elliptic Curve signature.
+ * @param [in] dst_buf_size The size, in bytes, of the buffer to which
+ *     dst_buf points.
+ * @param [out] bytes_written The number of bytes written to dst_buf.
+ * @param [in] src_buf A pointer to a buffer of data to sign.
+ * @param [in] src_buf_size The size, in bytes, of the buffer to which
+ *     src_buf points.
+ */
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_sign(iotc_bsp_ecc_key_t* key,
+                                              uint8_t* dst_buf,
+                                              size_t dst_buf_size,
+                                              size_t* bytes_written,
+                                              const uint8_t* src_buf,
+                                              size_t src_buf_size);
+
+/**
+ * @brief Releases a key returned by iotc_bsp_ecc_key_create() and sets the
+ *     pointer to NULL.
+ *
+ * @param [in,out] key A pointer to the key. May point to NULL.
+ */
+void iotc_bsp_ecc_key_destroy(iotc_bsp_ecc_key_t** key);
+
 #ifdef __cplusplus
 }
 #endif
@@ -111,6 +111,13 @@ typedef enum iotc_bsp_io_fs_open_flags {
   IOTC_BSP_IO_FS_OPEN_WRITE = 1 << 1,
   /** Open and append to the file. */
   IOTC_BSP_IO_FS_OPEN_APPEND = 1 << 2,
+  /** With IOTC_BSP_IO_FS_OPEN_READ, hand out the file in place, e.g. from a
+   * memory mapping, instead of copying it chunk by chunk. The buffers read
+   * stay valid until the file closes. A BSP that can't may ignore it. */
+  IOTC_BSP_IO_FS_OPEN_MMAP = 1 << 3,
+  /** With IOTC_BSP_IO_FS_OPEN_WRITE, create the file if it doesn't exist.
+   * The content of an existing file is kept. */
+  IOTC_BSP_IO_FS_OPEN_CREATE = 1 << 4,
 } iotc_bsp_io_fs_open_flags_t;
 
 /**
@@ -123,7 +130,8 @@ iotc_bsp_io_fs_state_t iotc_bsp_io_fs_stat(
     const char* const resource_name, iotc_bsp_io_fs_stat_t* resource_stat);
 
 /**
- * @details Opens a file.
+ * @details Opens a file. A file opened for writing is created if it doesn't
+ * exist yet, its contents are kept otherwise.
  *
  * @param [in] resource_name The filename.
  * @param [in] size The size, in bytes, of the file.
@@ -85,8 +85,9 @@
  * iotc_bsp_io_net_socket_connect() | Creates a {@link iotc_bsp_io_net_socket_connect() socket} and connects it to an endpoint. | 
  * iotc_bsp_io_net_connection_check() | Checks a {@link iotc_bsp_io_net_socket_connect() socket} connection status |
  * iotc_bsp_io_net_read() | Reads from a {@link iotc_bsp_io_net_socket_connect() socket}. |
- * iotc_bsp_io_net_select() | Checks a {@link iotc_bsp_io_net_socket_connect() socket} for scheduled read or write operations. |
+ * iotc_bsp_io_net_select_ms() | Checks a {@link iotc_bsp_io_net_socket_connect() socket} for scheduled read or write operations. |
  * iotc_bsp_io_net_write() | Writes to a {@link iotc_bsp_io_net_socket_connect() socket}. |
+ * iotc_bsp_io_net_writev() | Writes several buffers to a {@link iotc_bsp_io_net_socket_connect() socket} at once. |
  * iotc_bsp_io_net_close_socket() | Closes a {@link iotc_bsp_io_net_socket_connect() socket}. | 
  *
  * # POSIX BSP
@@ -189,6 +190,21 @@ typedef enum iotc_bsp_protocol_type_e {
  */
 typedef intptr_t iotc_bsp_socket_t;
 
+/**
+ * @typedef iotc_bsp_io_net_chunk_t
+ * @brief A buffer that iotc_bsp_io_net_writev() writes.
+ * @see #iotc_bsp_io_net_chunk_s
+ *
+ * @struct iotc_bsp_io_net_chunk_s
+ * @brief A buffer that iotc_bsp_io_net_writev() writes.
+ */
+typedef struct iotc_bsp_io_net_chunk_s {
+  /** A pointer to the data. */
+  const uint8_t* buf;
+  /** The size, in bytes, of the data. */
+  size_t count;
+} iotc_bsp_io_net_chunk_t;
+
 /**
  * @typedef iotc_bsp_socket_events_t
  * @brief The socket state.
@@ -247,6 +263,24 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_socket_connect(
  * @param [in] socket_events_array An array of socket events.
  * @param [in] socket_events_array_size The number of elements in
  *     socket_events_array.
+ * @param [in] timeout_ms The number of milliseconds before timing out.
+ *
+ * @returns A {@link #iotc_bsp_socket_events_s networking function state}.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select_ms(
+    iotc_bsp_socket_events_t* socket_events_array,
+    size_t socket_events_array_size, long timeout_ms);
+
+/**
+ * @brief Checks a {@link iotc_bsp_io_net_socket_connect() socket} for scheduled
+ * read or write operations.
+ *
+ * @deprecated The SDK calls iotc_bsp_io_net_select_ms(). The bundled BSPs
+ * keep this function as a wrapper of it for the applications that call it.
+ *
+ * @param [in] socket_events_array An array of socket events.
+ * @param [in] socket_events_array_size The number of elements in
+ *     socket_events_array.
  * @param [in] timeout_sec The number of seconds before timing out.
  *
  * @returns A {@link #iotc_bsp_socket_events_s networking function state}.
@@ -289,6 +323,27 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_write(
     iotc_bsp_socket_t iotc_socket_nonblocking, int* out_written_count,
     const uint8_t* buf, size_t count);
 
+/**
+ * @brief Writes several buffers to a
+ * {@link iotc_bsp_io_net_socket_connect() socket} with one call.
+ *
+ * @details The SDK calls this function to send an MQTT message whose header
+ * and payload are in separate buffers without copying them together first.
+ * The buffers are written in order, as if they were one buffer. Like
+ * iotc_bsp_io_net_write(), the function may write fewer bytes than the
+ * buffers hold and the SDK calls it again with the rest. A platform without a
+ * gather write can write the buffers one by one with iotc_bsp_io_net_write()
+ * until a buffer isn't written whole.
+ *
+ * @param [in] iotc_socket_nonblocking The socket on which to send data.
+ * @param [out] out_written_count The number of bytes written to the socket.
+ * @param [in] chunks The buffers to write.
+ * @param [in] chunk_count The number of elements in chunks.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_writev(
+    iotc_bsp_socket_t iotc_socket_nonblocking, int* out_written_count,
+    const iotc_bsp_io_net_chunk_t* chunks, size_t chunk_count);
+
 /**
  * @brief Reads data from a {@link iotc_bsp_io_net_socket_connect() socket}.
  *
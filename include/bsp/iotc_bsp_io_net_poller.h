@@ -0,0 +1,141 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IOTC_BSP_IO_NET_POLLER_H__
+#define __IOTC_BSP_IO_NET_POLLER_H__
+
+/**
+ * @file  iotc_bsp_io_net_poller.h
+ * @brief Waits for socket events with a persistent interest set.
+ *
+ * @details The poller is an optional alternative to
+ * iotc_bsp_io_net_select_ms(). Instead of passing every socket to the BSP on
+ * each event loop tick, the SDK registers a socket once and updates its
+ * interest only when it changes. A wait returns just the sockets that are
+ * ready, so the cost of a tick depends on the number of ready sockets rather
+ * than the number of open sockets.
+ *
+ * The SDK uses the poller if the library is built with
+ * <code>IOTC_EVENT_LOOP=epoll</code> or <code>IOTC_EVENT_LOOP=io_uring</code>.
+ * The default <code>IOTC_EVENT_LOOP=select</code> build does not call these
+ * functions, so a BSP only needs to implement them to support those modes.
+ *
+ * A typical poller workflow:
+ *    1. Create a poller.
+ *    2. Add a socket or change its interest with
+ *       iotc_bsp_io_net_poller_update().
+ *    3. Wait for ready sockets.
+ *    4. Remove the socket before closing it.
+ *    5. Destroy the poller.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iotc_bsp_io_net.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @typedef iotc_bsp_poller_t
+ * @brief The poller representation.
+ */
+typedef intptr_t iotc_bsp_poller_t;
+
+/**
+ * @brief Creates a poller with an empty interest set.
+ *
+ * @param [out] out_poller The platform-specific poller representation. This
+ *     value is passed to all further BSP poller calls.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_create(
+    iotc_bsp_poller_t* out_poller);
+
+/**
+ * @brief Destroys a poller and frees its resources.
+ *
+ * @details The sockets in the interest set are not closed.
+ *
+ * @param [in,out] poller The poller to destroy.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_destroy(
+    iotc_bsp_poller_t* poller);
+
+/**
+ * @brief Adds a socket to the interest set or changes its interest.
+ *
+ * @details Only the <code>iotc_socket</code> and <code>in_socket_want_*</code>
+ * fields of socket_events are read. A socket with no
+ * <code>in_socket_want_*</code> bit set stays registered but isn't reported,
+ * except for errors.
+ *
+ * @param [in] poller The poller.
+ * @param [in] socket_events The socket and its new interest.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_update(
+    iotc_bsp_poller_t poller, const iotc_bsp_socket_events_t* socket_events);
+
+/**
+ * @brief Removes a socket from the interest set.
+ *
+ * @param [in] poller The poller.
+ * @param [in] iotc_socket The socket to remove.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_remove(
+    iotc_bsp_poller_t poller, iotc_bsp_socket_t iotc_socket);
+
+/**
+ * @brief Waits until at least one socket in the interest set is ready.
+ *
+ * @details Each element written to out_events has its
+ * <code>iotc_socket</code>, <code>in_socket_want_*</code> and
+ * <code>out_socket_*</code> fields set the same way iotc_bsp_io_net_select_ms()
+ * sets them. Sockets that don't fit in out_events are reported by the next
+ * wait.
+ *
+ * @param [in] poller The poller.
+ * @param [out] out_events An array for the ready sockets.
+ * @param [in] out_events_size The number of elements in out_events.
+ * @param [out] out_events_count The number of ready sockets written to
+ *     out_events.
+ * @param [in] timeout_ms The number of milliseconds before timing out.
+ *
+ * @retval IOTC_BSP_IO_NET_STATE_OK At least one socket is ready.
+ * @retval IOTC_BSP_IO_NET_STATE_TIMEOUT No socket became ready in time.
+ * @retval IOTC_BSP_IO_NET_STATE_ERROR The wait failed.
+ */
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_wait(
+    iotc_bsp_poller_t poller, iotc_bsp_socket_events_t* out_events,
+    size_t out_events_size, size_t* out_events_count, long timeout_ms);
+
+/**
+ * @brief Gets a socket that becomes readable when the poller has ready
+ * sockets.
+ *
+ * @details The SDK passes this socket to iotc_bsp_io_net_select_ms() when one
+ * event loop drives several pollers.
+ *
+ * @param [in] poller The poller.
+ */
+iotc_bsp_socket_t iotc_bsp_io_net_poller_get_socket(iotc_bsp_poller_t poller);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IOTC_BSP_IO_NET_POLLER_H__ */
@@ -95,6 +95,12 @@ typedef struct iotc_bsp_tls_init_params_s {
  */
 typedef void iotc_bsp_tls_context_t;
 
+/**
+ * @typedef iotc_bsp_tls_session_t
+ * @brief A TLS session saved for resumption.
+ */
+typedef void iotc_bsp_tls_session_t;
+
 /**
  * @brief Initializes a TLS library and creates a TLS context.
  *
@@ -108,6 +114,16 @@ typedef void iotc_bsp_tls_context_t;
  */
 iotc_bsp_tls_state_t iotc_bsp_tls_init(iotc_bsp_tls_context_t** tls_context,
                                        iotc_bsp_tls_init_params_t* init_params);
+/**
+ * @brief Releases the TLS configuration that TLS contexts share.
+ *
+ * @details iotc_bsp_tls_init() may keep the parsed CA certificates, the
+ * library configuration and the seeded random number generator between
+ * connections instead of building them for every TLS context. The SDK calls
+ * this function from iotc_shutdown() to free them.
+ */
+void iotc_bsp_tls_shutdown();
+
 /**
  * @brief Frees a TLS context from memory and deletes any associated data.
  *
@@ -126,6 +142,56 @@ iotc_bsp_tls_state_t iotc_bsp_tls_cleanup(iotc_bsp_tls_context_t** tls_context);
  */
 iotc_bsp_tls_state_t iotc_bsp_tls_connect(iotc_bsp_tls_context_t* tls_context);
 
+/**
+ * @brief Saves the session of a TLS context after a successful handshake.
+ *
+ * @details The SDK keeps the session and offers it to the same host on the
+ * next connection of the context, which then skips the key exchange and the
+ * certificate verification if the server accepts it. The session carries an
+ * RFC 5077 session ticket or a session ID, whichever the server issued.
+ *
+ * @param [in] tls_context A pointer to
+ *     {@link ::iotc_bsp_tls_context_t the TLS context}.
+ * @param [out] session The saved session, to be freed with
+ *     iotc_bsp_tls_free_session(). NULL if there is nothing to resume.
+ */
+iotc_bsp_tls_state_t iotc_bsp_tls_save_session(
+    iotc_bsp_tls_context_t* tls_context, iotc_bsp_tls_session_t** session);
+
+/**
+ * @brief Offers a saved session in the next handshake of a TLS context.
+ *
+ * @details Called after iotc_bsp_tls_init() and before the first
+ * iotc_bsp_tls_connect(). A server that doesn't accept the session falls back
+ * to a full handshake.
+ *
+ * @param [in] tls_context A pointer to
+ *     {@link ::iotc_bsp_tls_context_t the TLS context}.
+ * @param [in] session A session from iotc_bsp_tls_save_session().
+ */
+iotc_bsp_tls_state_t iotc_bsp_tls_restore_session(
+    iotc_bsp_tls_context_t* tls_context,
+    const iotc_bsp_tls_session_t* session);
+
+/**
+ * @brief Tells whether the completed handshake of a TLS context resumed the
+ * offered session.
+ *
+ * @param [in] tls_context A pointer to
+ *     {@link ::iotc_bsp_tls_context_t the TLS context}.
+ *
+ * @retval 1 The handshake was abbreviated.
+ * @retval 0 The handshake was a full one.
+ */
+int iotc_bsp_tls_session_resumed(iotc_bsp_tls_context_t* tls_context);
+
+/**
+ * @brief Frees a session saved by iotc_bsp_tls_save_session().
+ *
+ * @param [in,out] session The session, set to NULL.
+ */
+void iotc_bsp_tls_free_session(iotc_bsp_tls_session_t** session);
+
 /**
  * @brief Reads data on a socket.
  *
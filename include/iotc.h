@@ -79,6 +79,7 @@ extern "C" {
  * | iotc_set_fs_functions() | Sets the file operations to the <a href="../../bsp/html/d8/dc3/iotc__bsp__io__fs_8h.html">custom file management functions</a> in the <a href="../../bsp/html/index.html">BSP</a>. |
  * | iotc_set_maximum_heap_usage() | Sets the maximum heap memory that the SDK can use. |
  * | iotc_set_network_timeout() | Sets the connection timeout. |
+ * | iotc_set_io_threads() | Spreads the contexts over a number of I/O threads. |
  *
  * ## Defining and managing connection contexts
  * | Function | Description |
@@ -93,6 +94,9 @@ extern "C" {
  * | iotc_connect() | Connects to Cloud IoT Core. |
  * | iotc_connect_to() | Connects to a custom MQTT broker endpoint. |
  * | iotc_create_iotcore_jwt() | Creates a JSON Web Token for authenticating to Cloud IoT Core. | 
+ * | iotc_get_backoff_state() | Gets the connection backoff of a context. |
+ * | iotc_set_backoff_policy() | Sets how a context delays connection attempts after failures. |
+ * | iotc_set_jwt_rotation() | Makes a context renew the JWT of its connection before it expires. |
  * | iotc_shutdown_connection() | Disconnects asynchronously from an MQTT broker. |
  *
  * ## Sending and receiving messages
@@ -100,12 +104,16 @@ extern "C" {
  * | --- | --- | 
  * | iotc_publish() | Publishes a message to an MQTT topic. |
  * | iotc_publish_data() | Publishes binary data to an MQTT topic. | 
+ * | iotc_publish_data_zero_copy() | Publishes binary data to an MQTT topic without copying it. |
+ * | iotc_set_in_flight_window() | Limits the QoS 1 messages waiting for an acknowledgement. |
+ * | iotc_set_offline_queue() | Keeps the messages published while a context is disconnected in files. |
  * | iotc_subscribe() | Subscribes to an MQTT topic. |
  *
  * ## Scheduling functions
  * | Function | Description |
  * | --- | --- |
  * | iotc_schedule_timed_task() | Invokes a callback after an interval. |
+ * | iotc_schedule_timed_task_ms() | Invokes a callback after an interval in milliseconds. |
  * | iotc_cancel_timed_task() | Removes a scheduled task from the internal event system. |
  * | iotc_events_process_blocking() | Invokes the event processing loop and executes the event engine as the main application process. |
  * | iotc_events_process_tick() | Invokes the event processing loop on RTOS or non-OS devices that must yield for standard tick operations. |
@@ -141,6 +149,13 @@ extern "C" {
  * <a href="../../bsp/html/d8/dc3/iotc__bsp__rng_8h.html">random number</a>
  * libraries in the <a href="../../bsp/html/index.html">BSP</a>. You must call
  * this function before you create a new connection context.
+ *
+ * This function can also reserve memory pools that serve the SDK's
+ * short-lived objects, such as data buffers descriptors and MQTT messages,
+ * so that iotc_publish_data_zero_copy() doesn't call iotc_bsp_mem_alloc() once
+ * the pools are warm. Each object type has a pool of its own, sized by an
+ * <code>IOTC_MEM_POOL_*_COUNT</code> build flag. The flags default to 0, which
+ * leaves the objects to iotc_bsp_mem_alloc().
  */
 extern iotc_state_t iotc_initialize();
 
@@ -327,9 +342,148 @@ extern iotc_state_t iotc_publish_data(iotc_context_handle_t iotc_h,
                                       iotc_user_callback_t* callback,
                                       void* user_data);
 
+/**
+ * @brief Publishes binary data to an MQTT topic without copying the payload
+ *     or the topic.
+ *
+ * @details Performs the same operations as iotc_publish_data() but borrows
+ * the caller's buffers instead of duplicating them, which saves a copy of
+ * every message on the heap. The topic and the payload must stay valid and
+ * unchanged until release_callback is invoked: for QoS 0 once the message
+ * has been written to the network, for QoS 1 once the broker acknowledged it
+ * or the message was dropped. Borrowed payloads aren't counted by
+ * iotc_get_heap_usage(); iotc_get_io_stats() counts them instead.
+ *
+ * With {@link iotc_set_publish_coalescing() publish coalescing} on, QoS 0
+ * payloads are copied into the pending batch and released right away.
+ *
+ * release_callback is invoked exactly once on the event loop thread, also
+ * when the publish fails, possibly before this function returns.
+ *
+ * @param [in] iotc_h A {@link iotc_create_context() context handle}.
+ * @param [in] topic The MQTT topic.
+ * @param [in] data A pointer to a buffer with the message payload.
+ * @param [in] data_len The size, in bytes, of the message.
+ * @param [in] qos The Quality of Service (QoS) level. Can be <code>0</code> or
+ *     <code>1</code>. QoS level <code>2</code> isn't supported.
+ * @param [in] callback (Optional) The callback function. Invoked after a
+ *     message is successfully or unsuccessfully delivered.
+ * @param [in] user_data (Optional) Abstract data passed to the callback
+ *     function.
+ * @param [in] release_callback The
+ *     {@link ::iotc_publish_release_callback_t function} that gets the
+ *     buffers back.
+ * @param [in] release_data (Optional) Abstract data passed to
+ *     release_callback.
+ */
+extern iotc_state_t iotc_publish_data_zero_copy(
+    iotc_context_handle_t iotc_h, const char* topic, const uint8_t* data,
+    size_t data_len, const iotc_mqtt_qos_t qos, iotc_user_callback_t* callback,
+    void* user_data, iotc_publish_release_callback_t* release_callback,
+    void* release_data);
+
+/**
+ * @brief Limits the QoS 1 messages that wait for an acknowledgement from the
+ *     MQTT broker.
+ *
+ * @details QoS 1 messages are written to the network as soon as they are
+ * published, without waiting for the acknowledgement of the previous ones.
+ * The in-flight window bounds how many of them, and how many payload bytes,
+ * may be outstanding at once. Once the window is full, the publish functions
+ * return IOTC_IN_FLIGHT_WINDOW_FULL without sending the message until
+ * acknowledgements free some room. A message larger than max_bytes is
+ * accepted when nothing else is in flight. QoS 0 messages aren't limited.
+ *
+ * Messages that aren't acknowledged in time, or that are outstanding when the
+ * connection drops, are sent again with the DUP flag set and stay in the
+ * window until they are acknowledged.
+ *
+ * @param [in] iotc_h A {@link iotc_create_context() context handle}.
+ * @param [in] max_messages The number of outstanding QoS 1 messages. 0 is no
+ *     limit.
+ * @param [in] max_bytes The number of outstanding QoS 1 payload bytes. 0 is
+ *     no limit.
+ *
+ * @retval IOTC_STATE_OK The window applies to messages published after this
+ *     call.
+ * @retval IOTC_INVALID_PARAMETER The context handle is invalid.
+ */
+extern iotc_state_t iotc_set_in_flight_window(iotc_context_handle_t iotc_h,
+                                              uint32_t max_messages,
+                                              size_t max_bytes);
+
+/**
+ * @brief Keeps the messages a context publishes while it is disconnected in
+ *     files and sends them once it connects again.
+ *
+ * @details While the context isn't connected, and until everything kept has
+ * been sent, the publish functions append their messages to a log of segment
+ * files through the {@link iotc_set_fs_functions() file functions} instead of
+ * sending them. Messages that don't fit fail with IOTC_OFFLINE_QUEUE_FULL, or
+ * make room by dropping the oldest segment if the drop policy says so.
+ *
+ * After a connection is made the messages are published in order, a few at a
+ * time, and a message leaves the log once it is delivered: written to the
+ * connection for QoS 0, acknowledged for QoS 1. What a lost connection
+ * didn't deliver is published again on the next one, so a message may arrive
+ * more than once. The callback of a message is called when it is delivered,
+ * or with IOTC_OFFLINE_QUEUE_FULL when it is dropped.
+ *
+ * The log is written in batches, so a crash loses the last few messages, and
+ * its index only records whole segments, so after a restart the delivered
+ * messages of a partly sent segment are published again. A log left by a
+ * previous run under the same name is picked up, its messages are published
+ * without a callback.
+ *
+ * @param [in] iotc_h A {@link iotc_create_context() context handle}.
+ * @param [in] config The name, size limits and drop policy of the log. NULL
+ *     stops keeping messages, the files stay for a later call.
+ *
+ * @retval IOTC_STATE_OK The messages published from now on are kept.
+ * @retval IOTC_INVALID_PARAMETER The context handle or the configuration is
+ *     invalid.
+ * @retval IOTC_ALREADY_INITIALIZED The context is connecting or connected.
+ */
+extern iotc_state_t iotc_set_offline_queue(
+    iotc_context_handle_t iotc_h, const iotc_offline_queue_config_t* config);
+
+/**
+ * @brief Sets how a context delays its connection attempts after failed
+ *     connections.
+ *
+ * @details Every context keeps its own backoff, so a failing connection
+ * doesn't delay the other contexts of the process. The new policy applies to
+ * the next failure, a delay that is already pending is kept within the new
+ * bounds. See ::iotc_backoff_policy_t for how delays are drawn.
+ *
+ * @param [in] iotc_h A {@link iotc_create_context() context handle}.
+ * @param [in] policy The delay bounds in milliseconds.
+ *
+ * @retval IOTC_STATE_OK The policy is set.
+ * @retval IOTC_INVALID_PARAMETER The context handle or the policy is invalid.
+ */
+extern iotc_state_t iotc_set_backoff_policy(
+    iotc_context_handle_t iotc_h, const iotc_backoff_policy_t* policy);
+
+/**
+ * @brief Gets the connection backoff of a context.
+ *
+ * @param [in] iotc_h A {@link iotc_create_context() context handle}.
+ * @param [out] out_state The backoff state of the context.
+ *
+ * @retval IOTC_STATE_OK The state is written to out_state.
+ * @retval IOTC_INVALID_PARAMETER The context handle or out_state is invalid.
+ */
+extern iotc_state_t iotc_get_backoff_state(iotc_context_handle_t iotc_h,
+                                           iotc_backoff_state_t* out_state);
+
 /**
  * @brief Subscribes to an MQTT topic.
  *
+ * @details The topic can contain the <code>+</code> and <code>#</code> MQTT
+ * wildcards. If a message matches several subscriptions, the callback of each
+ * of them is invoked.
+ *
  * @param [in] iotc_h A {@link iotc_create_context() context handle}.
  * @param [in] topic The MQTT topic.
  * @param [in] qos The Quality of Service (QoS) level. Can be <code>0</code>,
@@ -379,6 +533,30 @@ iotc_timed_task_handle_t iotc_schedule_timed_task(
     const iotc_time_t seconds_from_now, const uint8_t repeats_forever,
     void* data);
 
+/**
+ * @brief Returns a unique ID for the scheduled task and invokes a callback
+ *     after an interval given in milliseconds.
+ *
+ * @details Works like iotc_schedule_timed_task() for intervals shorter than a
+ * second or not a whole number of seconds. The interval is measured on the
+ * {@link iotc_bsp_time_getmonotonictime_milliseconds() monotonic clock}.
+ *
+ * @param [in] iotc_h A {@link iotc_create_context() context handle}.
+ * @param [in] iotc_user_task_callback_t The
+ *     {@link ::iotc_user_task_callback_t function} invoked after an interval.
+ * @param [in] milliseconds_from_now The number of milliseconds to wait before
+ *     invoking the callback.
+ * @param [in] repeats_forever If the repeats_forever parameter is set to
+ *     <code>0</code>, the callback is executed only once. Otherwise, the
+ *     callback is repeatedly executed at milliseconds_from_now intervals.
+ * @param [in] data (Optional) A pointer that will be passed to the callback
+ *     function's user_data parameter.
+ */
+iotc_timed_task_handle_t iotc_schedule_timed_task_ms(
+    iotc_context_handle_t iotc_h, iotc_user_task_callback_t* callback,
+    const iotc_time_t milliseconds_from_now, const uint8_t repeats_forever,
+    void* data);
+
 /**
  * @brief Removes a scheduled task from the internal event system.
  *
@@ -411,6 +589,100 @@ extern void iotc_set_network_timeout(uint32_t timeout);
  */
 extern uint32_t iotc_get_network_timeout(void);
 
+/**
+ * @brief Sets the size of the buffer that a connection reads into. Reads
+ * that start after this call use the new size.
+ *
+ * @details A larger buffer means fewer socket reads and fewer passes through
+ * the MQTT parser for large messages, at the cost of heap memory held while a
+ * read is processed. The default is 4096 bytes.
+ *
+ * @param [in] size The buffer size in bytes, between 32 and 16384.
+ *
+ * @retval IOTC_STATE_OK The size is set.
+ * @retval IOTC_INVALID_PARAMETER The size is out of range.
+ */
+extern iotc_state_t iotc_set_receive_buffer_size(size_t size);
+
+/**
+ * @brief Gets the
+ * {@link iotc_set_receive_buffer_size() receive buffer size}.
+ */
+extern size_t iotc_get_receive_buffer_size(void);
+
+/**
+ * @brief Packs outgoing QoS 0 PUBLISH messages into shared writes.
+ *
+ * @details By default each MQTT message is written to the network on its
+ * own, which costs a system call and, on secure connections, a TLS record per
+ * message. With coalescing on, QoS 0 PUBLISH messages are serialised into a
+ * pending batch that is written when it reaches max_bytes, when max_delay_ms
+ * milliseconds pass, or when a message of another kind has to be sent. A
+ * delay of 0 writes the batch on the next pass of the event loop, which
+ * collects the messages published in between.
+ *
+ * The publish callback of a batched message reports IOTC_STATE_OK once its
+ * batch is written. A batch that fails to be written, or that is dropped
+ * because the connection closes, reports IOTC_STATE_FAILED_WRITING; a failed
+ * write closes the connection like any other write error.
+ *
+ * @param [in] max_bytes The batch size, in bytes, that triggers a write,
+ *     up to 16384. 0 turns coalescing off.
+ * @param [in] max_delay_ms The number of milliseconds a batch may wait.
+ *
+ * @retval IOTC_STATE_OK The settings are applied to messages published after
+ *     this call.
+ * @retval IOTC_INVALID_PARAMETER max_bytes is out of range.
+ */
+extern iotc_state_t iotc_set_publish_coalescing(size_t max_bytes,
+                                                uint32_t max_delay_ms);
+
+/**
+ * @brief Copies the {@link iotc_io_stats_t write counters} to out_stats.
+ */
+extern void iotc_get_io_stats(iotc_io_stats_t* out_stats);
+
+/**
+ * @brief Sets the {@link iotc_io_stats_t write counters} to zero.
+ */
+extern void iotc_reset_io_stats(void);
+
+/**
+ * @brief Spreads the contexts over a number of I/O threads.
+ *
+ * @details By default iotc_events_process_blocking() drives every context
+ * from the calling thread, so the TLS, MQTT parsing and dispatching of all
+ * the connections share a single core. With I/O threads each context created
+ * afterwards is assigned to one of the threads in turns and is driven by that
+ * thread only, through an event loop of its own. The threads start with the
+ * first context and end when the last context is deleted.
+ *
+ * iotc_events_process_blocking() and iotc_events_process_tick() still run
+ * the timed tasks. iotc_events_stop() stops the I/O threads as well, and
+ * iotc_events_process_blocking() returns once they have finished, so the
+ * contexts may be deleted after it like without I/O threads.
+ *
+ * iotc_connect(), iotc_publish(), iotc_subscribe() and
+ * iotc_shutdown_connection() may be called from any thread, e.g. from a
+ * callback. Called outside of the thread of the context, they hand the
+ * request over to it and return IOTC_STATE_OK. A publish rejected there,
+ * because of a terminal backoff or a full
+ * {@link iotc_set_in_flight_window() in-flight window}, reports the error to
+ * its callback, and so does a connect rejected because the context is
+ * connecting or connected already.
+ *
+ * The function requires the thread module.
+ *
+ * @param [in] num_of_threads The number of I/O threads, up to 16. 0 drives
+ *     the contexts from the thread of iotc_events_process_blocking().
+ *
+ * @retval IOTC_STATE_OK The contexts created from now on use the threads.
+ * @retval IOTC_INVALID_PARAMETER num_of_threads is out of range.
+ * @retval IOTC_ALREADY_INITIALIZED A context exists already.
+ * @retval IOTC_NOT_SUPPORTED The SDK is built without the thread module.
+ */
+extern iotc_state_t iotc_set_io_threads(uint8_t num_of_threads);
+
 /**
  * @details Sets the maximum heap memory that the SDK can use.
  *
@@ -429,6 +701,9 @@ iotc_state_t iotc_set_maximum_heap_usage(const size_t max_bytes);
  * <a href="../../../user_guide.md#memory-limiter">memory limiter</a>. If no
  * heap memory is allocated, this function runs but returns
  * IOTC_INVALID_PARAMETER.
+ *
+ * The amount includes the whole memory pools reserved by iotc_initialize(),
+ * whether their blocks are in use or not.
  */
 iotc_state_t iotc_get_heap_usage(size_t* const heap_usage);
 
@@ -107,6 +107,8 @@ typedef enum {
   /** The buffer is too small for the data. @internal Numeric code: 74 @endinternal */ IOTC_BUFFER_TOO_SMALL_ERROR,
   /** The buffer for storing formatted and signed JWTs is null. @internal Numeric code: 75 @endinternal */ IOTC_NULL_KEY_DATA_ERROR,
   /** @cond Numeric code: 76 */ IOTC_NULL_CLIENT_ID_ERROR, /** @endcond */
+  /** The in-flight window of the context is full. Publish again once outstanding QoS 1 messages are acknowledged. @internal Numeric code: 77 @endinternal */ IOTC_IN_FLIGHT_WINDOW_FULL,
+  /** The offline queue of the context is full. @internal Numeric code: 78 @endinternal */ IOTC_OFFLINE_QUEUE_FULL,
 
   /** @cond */ IOTC_ERROR_COUNT /** @endcond */ /* Add errors above this line; this should always be last line. */
 } iotc_state_t;
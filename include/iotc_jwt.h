@@ -69,6 +69,92 @@ iotc_state_t iotc_create_iotcore_jwt(
     const iotc_crypto_key_data_t* private_key_data, char* dst_jwt_buf,
     size_t dst_jwt_buf_len, size_t* bytes_written);
 
+/**
+ * @typedef iotc_jwt_manager_t
+ * @brief Keeps a signed JWT ready for the next connection.
+ *
+ * @details The manager parses the private key once and signs a new token on a
+ * {@link iotc_schedule_timed_task() timed task} every half of the expiration
+ * period, so a (re)connection takes a token that is already signed.
+ */
+typedef struct iotc_jwt_manager_s iotc_jwt_manager_t;
+
+/**
+ * @brief Creates a JWT manager and signs its first token.
+ *
+ * @details The renewals run on the event loop of
+ * iotc_events_process_blocking() or iotc_events_process_tick(). Destroy the
+ * manager before the context.
+ *
+ * @param [in] iotc_h The {@link iotc_create_context() context handle} of the
+ *     renewal timed task.
+ * @param [in] project_id The GCP project ID.
+ * @param [in] expiration_period_sec The number of seconds before each JWT
+ *     expires, at least 2.
+ * @param [in] private_key_data ES256 private key data. The key data must stay
+ *     valid until the manager is destroyed.
+ * @param [out] out_manager The new manager.
+ */
+iotc_state_t iotc_jwt_manager_create(
+    iotc_context_handle_t iotc_h, const char* project_id,
+    uint32_t expiration_period_sec,
+    const iotc_crypto_key_data_t* private_key_data,
+    iotc_jwt_manager_t** out_manager);
+
+/**
+ * @brief Copies the token signed last into a buffer.
+ *
+ * @details The token has at least a quarter of its expiration period left. If
+ * the renewals fall behind, the function signs a token itself. The function
+ * may be called from any thread.
+ *
+ * @param [in] manager The manager.
+ * @param [in,out] dst_jwt_buf A pointer to a buffer that stores the JWT.
+ * @param [in] dst_jwt_buf_len The length, in bytes, of the buffer to which
+ *     dst_jwt_buf points. IOTC_JWT_SIZE is enough.
+ * @param [out] bytes_written The number of bytes written to the buffer to which
+ *     dst_jwt_buf points.
+ */
+iotc_state_t iotc_jwt_manager_get_jwt(iotc_jwt_manager_t* manager,
+                                      char* dst_jwt_buf, size_t dst_jwt_buf_len,
+                                      size_t* bytes_written);
+
+/**
+ * @brief Cancels the renewals, frees the manager and sets the pointer to NULL.
+ *
+ * @param [in,out] manager A pointer to the manager. May point to NULL.
+ */
+void iotc_jwt_manager_destroy(iotc_jwt_manager_t** manager);
+
+/**
+ * @brief Makes a context sign the password of its connections and swap the
+ *     connection before the token expires.
+ *
+ * @details Call the function before iotc_connect(), the password passed to
+ * iotc_connect() is then ignored. Each connection takes a token of a
+ * {@link iotc_jwt_manager_create() JWT manager} the context owns. In the last
+ * quarter of the token's lifetime, at a random point so devices that connected
+ * together don't reconnect together, the context waits for a moment without
+ * messages in flight and reconnects with a fresh token. An eighth of the
+ * lifetime before the expiration it reconnects regardless.
+ *
+ * The swap keeps the publishes that weren't sent or acknowledged yet and
+ * renews the subscriptions without calling their SUBACK callbacks again. The
+ * connection state callback isn't called for the swap, only if the new
+ * connection fails.
+ *
+ * @param [in] iotc_h The {@link iotc_create_context() context handle}.
+ * @param [in] project_id The GCP project ID.
+ * @param [in] expiration_period_sec The number of seconds before each JWT
+ *     expires, at least 2.
+ * @param [in] private_key_data ES256 private key data. The key data must stay
+ *     valid until the context is deleted. NULL turns the rotation off.
+ */
+iotc_state_t iotc_set_jwt_rotation(
+    iotc_context_handle_t iotc_h, const char* project_id,
+    uint32_t expiration_period_sec,
+    const iotc_crypto_key_data_t* private_key_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -78,6 +78,23 @@ typedef void(iotc_user_task_callback_t)(
 typedef void(iotc_user_callback_t)(iotc_context_handle_t in_context_handle,
                                    void* data, iotc_state_t state);
 
+/**
+ * @typedef iotc_publish_release_callback_t
+ * @brief Hands back the payload lent to
+ *     {@link iotc_publish_data_zero_copy() a zero-copy publish}.
+ *
+ * @details Once invoked, the SDK no longer reads the payload or the topic of
+ * the message, so the application can reuse or free them.
+ *
+ * @param [in] data The payload passed to iotc_publish_data_zero_copy().
+ * @param [in] data_len The size, in bytes, of the payload.
+ * @param [in] user_data The release_data passed to
+ *     iotc_publish_data_zero_copy().
+ */
+typedef void(iotc_publish_release_callback_t)(const uint8_t* data,
+                                              size_t data_len,
+                                              void* user_data);
+
 /**
  * @typedef iotc_sub_call_type_t
  * @brief The data type of the user-defined subscription callback.
@@ -268,6 +285,113 @@ typedef struct {
   iotc_crypto_key_signature_algorithm_t crypto_key_signature_algorithm;
 } iotc_crypto_key_data_t;
 
+/**
+ * @typedef iotc_io_stats_t
+ * @struct iotc_io_stats_t
+ * @brief Counts the writes that outgoing MQTT messages take.
+ *
+ * @details Dividing the write counts by <code>messages_sent</code> gives the
+ * system calls and TLS records spent per message, e.g. to tune
+ * {@link iotc_set_publish_coalescing() publish coalescing}. The borrowed
+ * payload counters show the copies that
+ * {@link iotc_publish_data_zero_copy() zero-copy publishes} saved, the TLS
+ * handshake counters show how often reconnects resumed their TLS session.
+ */
+typedef struct {
+  /** The number of MQTT messages handed to the network layers. */
+  uint32_t messages_sent;
+  /** The number of socket write calls. */
+  uint32_t socket_writes;
+  /** The number of TLS write calls. Each one produces at least one TLS
+   * record. */
+  uint32_t tls_records;
+  /** The number of payloads published without a copy. */
+  uint32_t borrowed_payloads;
+  /** The number of payload bytes published without a copy. */
+  uint64_t borrowed_payload_bytes;
+  /** The number of completed TLS handshakes. */
+  uint32_t tls_handshakes;
+  /** The number of TLS handshakes that resumed the session of the previous
+   * connection. */
+  uint32_t tls_resumed_handshakes;
+  /** The milliseconds spent in TLS handshakes, from the first handshake
+   * message to the last. */
+  uint64_t tls_handshake_time_ms;
+} iotc_io_stats_t;
+
+/**
+ * @typedef iotc_backoff_policy_t
+ * @struct iotc_backoff_policy_t
+ * @brief How a context {@link iotc_set_backoff_policy() delays} its
+ *     connection attempts after failed connections.
+ *
+ * @details Each failed connection picks the next delay at random between
+ * base_ms and three times the previous delay, capped at cap_ms. Contexts
+ * draw their delays independently so they don't reconnect in step. Every
+ * decay_ms that a connection stays up halves the delay, and the penalty is
+ * gone once the delay drops below base_ms.
+ */
+typedef struct {
+  /** The smallest delay in milliseconds. Must not be 0. */
+  uint32_t base_ms;
+  /** The largest delay in milliseconds. Must not be less than base_ms. */
+  uint32_t cap_ms;
+  /** The milliseconds of healthy connection that halve the delay. Must not
+   * be 0. */
+  uint32_t decay_ms;
+} iotc_backoff_policy_t;
+
+/**
+ * @typedef iotc_backoff_state_t
+ * @struct iotc_backoff_state_t
+ * @brief The {@link iotc_get_backoff_state() backoff state} of a context.
+ */
+typedef struct {
+  /** The delay in milliseconds before the next connection attempt, 0 if the
+   * context has no penalty. */
+  uint32_t delay_ms;
+  /** The number of failed connections that haven't decayed yet. */
+  uint32_t failures;
+  /** Non-zero while the last connection attempt of the context failed.
+   * Publishes and subscriptions return IOTC_BACKOFF_TERMINAL until a
+   * connection succeeds. */
+  uint8_t in_backoff;
+} iotc_backoff_state_t;
+
+/**
+ * @typedef iotc_offline_queue_drop_policy_t
+ * @brief What a full {@link iotc_set_offline_queue() offline queue} does with
+ *     a new message.
+ */
+typedef enum {
+  /** The new message is rejected with IOTC_OFFLINE_QUEUE_FULL. */
+  IOTC_OFFLINE_QUEUE_DROP_NEWEST = 0,
+  /** The oldest segment of the queue is dropped to make room. */
+  IOTC_OFFLINE_QUEUE_DROP_OLDEST
+} iotc_offline_queue_drop_policy_t;
+
+/**
+ * @typedef iotc_offline_queue_config_t
+ * @struct iotc_offline_queue_config_t
+ * @brief The {@link iotc_set_offline_queue() offline queue} of a context.
+ *
+ * @details The queue is a log of segment files, the messages are appended to
+ * the newest segment and read from the oldest one. A segment is removed once
+ * all of its messages are handed to the connection.
+ */
+typedef struct {
+  /** The name the resources of the queue start with, e.g. a path for the
+   * POSIX filesystem. Each context needs its own. */
+  const char* name;
+  /** The number of bytes the queue takes at most. */
+  size_t max_bytes;
+  /** The number of bytes after which the queue starts a new segment. Must
+   * not be 0 or more than max_bytes. */
+  size_t segment_bytes;
+  /** What to do with a message that doesn't fit. */
+  iotc_offline_queue_drop_policy_t drop_policy;
+} iotc_offline_queue_config_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -128,6 +128,34 @@ ifneq (,$(findstring memory_limiter,$(CONFIG)))
 	IOTC_SRCDIRS += $(LIBIOTC_SOURCE_DIR)/debug_extensions/memory_limiter
 endif
 
+# EVENT LOOP: epoll and io_uring keep the sockets registered in a BSP poller
+# (include/bsp/iotc_bsp_io_net_poller.h) instead of passing all of them to
+# iotc_bsp_io_net_select on each loop iteration
+ifeq ($(IOTC_EVENT_LOOP),epoll)
+	IOTC_CONFIG_FLAGS += -DIOTC_EVENT_LOOP_POLLER
+	IOTC_CONFIG_FLAGS += -DIOTC_EVENT_LOOP_EPOLL
+else ifeq ($(IOTC_EVENT_LOOP),io_uring)
+	IOTC_CONFIG_FLAGS += -DIOTC_EVENT_LOOP_POLLER
+	IOTC_CONFIG_FLAGS += -DIOTC_EVENT_LOOP_IO_URING
+else ifneq ($(IOTC_EVENT_LOOP),select)
+	$(error Invalid IOTC_EVENT_LOOP: [$(IOTC_EVENT_LOOP)], valid values are select, epoll and io_uring)
+endif
+
+# TIME EVENTS: the timer wheel keeps add, restart and cancel of a time event
+# O(1), the sorted vector is smaller for a handful of time events
+ifeq ($(IOTC_TIME_EVENTS),wheel)
+	IOTC_CONFIG_FLAGS += -DIOTC_TIME_EVENTS_WHEEL
+else ifneq ($(IOTC_TIME_EVENTS),vector)
+	$(error Invalid IOTC_TIME_EVENTS: [$(IOTC_TIME_EVENTS)], valid values are vector and wheel)
+endif
+
+# VECTOR INDEX: with the default 8 bit index the time events, sockets,
+# contexts and subscriptions are limited to 127 entries each
+ifneq (,$(filter-out 8 16 32,$(IOTC_VECTOR_INDEX_WIDTH)))
+	$(error Invalid IOTC_VECTOR_INDEX_WIDTH: [$(IOTC_VECTOR_INDEX_WIDTH)], valid values are 8, 16 and 32)
+endif
+IOTC_CONFIG_FLAGS += -DIOTC_VECTOR_INDEX_WIDTH=$(IOTC_VECTOR_INDEX_WIDTH)
+
 # CONFIG: modules here we are going to check each defined module
 
 IOTC_PLATFORM_MODULES ?= iotc_thread
@@ -243,6 +271,7 @@ endif
 ifdef MAKEFILE_DEBUG
 $(info --mt-config-- Using [$(IOTC_BSP_PLATFORM)] BSP configuration)
 $(info --mt-config-- event_loop=$(IOTC_EVENT_LOOP))
+$(info --mt-config-- time_events=$(IOTC_TIME_EVENTS))
 $(info --mt-config-- $$IOTC_PLATFORM_BASE is [${IOTC_PLATFORM_BASE}])
 $(info --mt-config-- $$IOTC_PLATFORM_MODULES is [${IOTC_PLATFORM_MODULES}])
 $(info --mt-config-- $$LIBIOTC_SOURCE_DIR is [${LIBIOTC_SOURCE_DIR}])
@@ -23,3 +23,11 @@ IOTC_TLS_LIB_DEP ?= $(IOTC_TLS_LIB_DIR)libmbedtls.a
 
 IOTC_CONFIG_FLAGS += -DIOTC_TLS_LIB_MBEDTLS
 IOTC_CONFIG_FLAGS += -DMBEDTLS_PLATFORM_MEMORY
+
+# the TLS contexts of the I/O threads share one DRBG and one configuration,
+# mbedTLS has to guard them with its own mutexes; the library and the BSP
+# have to agree on it since it changes the layout of the mbedTLS contexts
+ifneq (,$(findstring threading,$(CONFIG)))
+    IOTC_CONFIG_FLAGS += -DMBEDTLS_THREADING_C -DMBEDTLS_THREADING_PTHREAD
+    IOTC_BSP_TLS_BUILD_ARGS += -DMBEDTLS_THREADING_C -DMBEDTLS_THREADING_PTHREAD
+endif
@@ -23,6 +23,7 @@ IOTC_TLS_LIB_DEP ?= $(IOTC_TLS_LIB_DIR)libwolfssl.a
 
 # wolfssl API
 IOTC_CONFIG_FLAGS += -DHAVE_SNI
+IOTC_CONFIG_FLAGS += -DHAVE_SESSION_TICKET
 IOTC_CONFIG_FLAGS += -DHAVE_CERTIFICATE_STATUS_REQUEST
 IOTC_CONFIG_FLAGS += -DHAVE_ECC
 IOTC_CONFIG_FLAGS += -DTFM_TIMING_RESISTANT -DECC_TIMING_RESISTANT -DWC_RSA_BLINDING
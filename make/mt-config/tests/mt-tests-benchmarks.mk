@@ -0,0 +1,30 @@
+# Copyright 2018-2020 Google LLC
+#
+# This is part of the Google Cloud IoT Device SDK for Embedded C.
+# It is licensed under the BSD 3-Clause license; you may not use this file
+# except in compliance with the License.
+#
+# You may obtain a copy of the License at:
+#  https://opensource.org/licenses/BSD-3-Clause
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+include make/mt-config/tests/mt-tests.mk
+
+# each iotc_benchmark_*.c file in the benchmarks directory is a standalone
+# program linked against the library
+IOTC_BENCHMARKS_SOURCE_DIR := $(IOTC_TEST_DIR)/benchmarks
+IOTC_BENCHMARKS_OBJDIR := $(IOTC_TEST_OBJDIR)/benchmarks
+IOTC_BENCHMARKS_BINDIR := $(IOTC_TEST_BINDIR)/benchmarks
+
+IOTC_BENCHMARKS_SOURCES := $(wildcard $(IOTC_BENCHMARKS_SOURCE_DIR)/iotc_benchmark_*.c)
+IOTC_BENCHMARKS := $(addprefix $(IOTC_BENCHMARKS_BINDIR)/,$(notdir $(IOTC_BENCHMARKS_SOURCES:.c=)))
+
+IOTC_BENCHMARKS_CFLAGS := $(IOTC_CONFIG_FLAGS) $(IOTC_COMMON_COMPILER_FLAGS) $(IOTC_C_FLAGS)
+IOTC_BENCHMARKS_INCLUDE_FLAGS := $(IOTC_INCLUDE_FLAGS) -I$(IOTC_BENCHMARKS_SOURCE_DIR)
+
+IOTC_RUN_BENCHMARK = (cd $(IOTC_BENCHMARKS_BINDIR) && $(1)) &&
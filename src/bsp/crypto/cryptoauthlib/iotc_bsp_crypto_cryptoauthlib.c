@@ -20,6 +20,7 @@
  */
 
 #include "iotc_bsp_crypto.h"
+#include "iotc_bsp_mem.h"
 #include "iotc_helpers.h"
 #include "iotc_macros.h"
 
@@ -65,10 +66,17 @@ iotc_bsp_crypto_state_t iotc_bsp_sha256(uint8_t* dst_buf_32_bytes,
   }
 }
 
-iotc_bsp_crypto_state_t iotc_bsp_ecc(
-    const iotc_crypto_key_data_t* private_key_data, uint8_t* dst_buf,
-    size_t dst_buf_size, size_t* bytes_written, const uint8_t* src_buf,
-    size_t src_buf_size) {
+/* the key never leaves the secure element, only its slot is kept */
+struct iotc_bsp_ecc_key_s {
+  uint8_t slot_id;
+};
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_create(
+    const iotc_crypto_key_data_t* private_key_data, iotc_bsp_ecc_key_t** key) {
+  if (NULL == private_key_data || NULL == key) {
+    return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
+  }
+
   if (IOTC_CRYPTO_KEY_UNION_TYPE_SLOT_ID !=
       private_key_data->crypto_key_union_type) {
     iotc_debug_format(
@@ -79,7 +87,27 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(
     return IOTC_BSP_CRYPTO_ERROR;
   }
 
-  uint8_t slot_id = private_key_data->crypto_key_union.key_slot.slot_id;
+  *key = (iotc_bsp_ecc_key_t*)iotc_bsp_mem_alloc(sizeof(iotc_bsp_ecc_key_t));
+
+  if (NULL == *key) {
+    return IOTC_BSP_CRYPTO_ERROR;
+  }
+
+  (*key)->slot_id = private_key_data->crypto_key_union.key_slot.slot_id;
+
+  return IOTC_BSP_CRYPTO_STATE_OK;
+}
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_sign(iotc_bsp_ecc_key_t* key,
+                                              uint8_t* dst_buf,
+                                              size_t dst_buf_size,
+                                              size_t* bytes_written,
+                                              const uint8_t* src_buf,
+                                              size_t src_buf_size) {
+  if (NULL == key || NULL == dst_buf || NULL == bytes_written ||
+      NULL == src_buf) {
+    return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
+  }
 
   IOTC_CHECK_DEBUG_FORMAT(64 > dst_buf_size,
                           "dst_buf_size must be >= %zu: was %zu", 64,
@@ -90,7 +118,7 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(
                           src_buf_size);
 
   // input message is 32 bytes, output is 64 bytes
-  const int ret = atcab_sign(slot_id, src_buf, dst_buf);
+  const int ret = atcab_sign(key->slot_id, src_buf, dst_buf);
 
   IOTC_CHECK_DEBUG_FORMAT(ATCA_SUCCESS != ret, "atcab_sign returned %d", ret);
 
@@ -100,3 +128,31 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(
 err_handling:
   return IOTC_BSP_CRYPTO_ERROR;
 }
+
+void iotc_bsp_ecc_key_destroy(iotc_bsp_ecc_key_t** key) {
+  if (NULL == key || NULL == *key) {
+    return;
+  }
+
+  iotc_bsp_mem_free(*key);
+  *key = NULL;
+}
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc(
+    const iotc_crypto_key_data_t* private_key_data, uint8_t* dst_buf,
+    size_t dst_buf_size, size_t* bytes_written, const uint8_t* src_buf,
+    size_t src_buf_size) {
+  iotc_bsp_ecc_key_t* key = NULL;
+
+  iotc_bsp_crypto_state_t return_code =
+      iotc_bsp_ecc_key_create(private_key_data, &key);
+
+  if (IOTC_BSP_CRYPTO_STATE_OK == return_code) {
+    return_code = iotc_bsp_ecc_key_sign(key, dst_buf, dst_buf_size,
+                                        bytes_written, src_buf, src_buf_size);
+  }
+
+  iotc_bsp_ecc_key_destroy(&key);
+
+  return return_code;
+}
@@ -183,5 +183,45 @@ TEST_F(IotcBspCryptoEcc, SimpleTextValidation) {
   EXPECT_EQ(bytes_written_ecc_signature, 64u);
 }
 
+TEST_F(IotcBspCryptoEcc, PreparedKeySignsValidSignatures) {
+  iotc_bsp_ecc_key_t* key = nullptr;
+  ASSERT_EQ(iotc_bsp_ecc_key_create(&DefaultPrivateKey, &key),
+            IOTC_BSP_CRYPTO_STATE_OK);
+  ASSERT_NE(key, nullptr);
+
+  // The same key signs repeatedly without being parsed again.
+  for (int i = 0; i < 3; ++i) {
+    size_t bytes_written = 0;
+    uint8_t ecc_signature[IOTC_JWT_MAX_SIGNATURE_SIZE] = {0};
+    EXPECT_EQ(iotc_bsp_ecc_key_sign(key, ecc_signature,
+                                    IOTC_JWT_MAX_SIGNATURE_SIZE,
+                                    &bytes_written, kDefaultDataToSign,
+                                    kDefaultDataToSignLength),
+              IOTC_BSP_CRYPTO_STATE_OK);
+    EXPECT_EQ(bytes_written, 64u);
+    EXPECT_TRUE(openssl::ecc_is_valid(kDefaultDataToSign,
+                                      kDefaultDataToSignLength, ecc_signature,
+                                      bytes_written, kPublicKey));
+  }
+
+  iotc_bsp_ecc_key_destroy(&key);
+  EXPECT_EQ(key, nullptr);
+}
+
+TEST_F(IotcBspCryptoEcc, PreparedKeyReportsErrorOnInvalidPrivateKey) {
+  constexpr char kInvalid[] = "invalid key";
+  const iotc_crypto_key_data_t kInvalidKey = {
+      IOTC_CRYPTO_KEY_UNION_TYPE_PEM, const_cast<char*>(kInvalid),
+      IOTC_CRYPTO_KEY_SIGNATURE_ALGORITHM_ES256};
+  iotc_bsp_ecc_key_t* key = nullptr;
+
+  EXPECT_EQ(iotc_bsp_ecc_key_create(&kInvalidKey, &key),
+            IOTC_BSP_CRYPTO_KEY_PARSE_ERROR);
+  EXPECT_EQ(key, nullptr);
+
+  // Destroying an empty handle is a no-op.
+  iotc_bsp_ecc_key_destroy(&key);
+}
+
 } // namespace
 } // namespace iotctest
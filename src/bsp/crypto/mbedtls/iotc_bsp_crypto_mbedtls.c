@@ -96,12 +96,13 @@ err_handling:
   return IOTC_BSP_CRYPTO_SHA256_ERROR;
 }
 
-iotc_bsp_crypto_state_t iotc_bsp_ecc(
-    const iotc_crypto_key_data_t* private_key_data, uint8_t* dst_buf,
-    size_t dst_buf_size, size_t* bytes_written, const uint8_t* src_buf,
-    size_t src_buf_len) {
-  if (NULL == private_key_data || NULL == dst_buf || NULL == bytes_written ||
-      NULL == src_buf) {
+struct iotc_bsp_ecc_key_s {
+  mbedtls_pk_context pk;
+};
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_create(
+    const iotc_crypto_key_data_t* private_key_data, iotc_bsp_ecc_key_t** key) {
+  if (NULL == private_key_data || NULL == key) {
     return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
   }
 
@@ -116,32 +117,67 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(
 
   iotc_bsp_crypto_state_t return_code = IOTC_BSP_CRYPTO_STATE_OK;
 
-  int mbedtls_ret = -1;
+  int mbedtls_ret = 0;
 
-  mbedtls_mpi r, s;
-  mbedtls_pk_context pk;
-  mbedtls_ecdsa_context ecdsa_sign;
+  *key = (iotc_bsp_ecc_key_t*)iotc_bsp_mem_alloc(sizeof(iotc_bsp_ecc_key_t));
 
-  mbedtls_mpi_init(&r);
-  mbedtls_mpi_init(&s);
-  mbedtls_pk_init(&pk);
-  mbedtls_ecdsa_init(&ecdsa_sign);
+  if (NULL == *key) {
+    return IOTC_BSP_CRYPTO_ERROR;
+  }
+
+  mbedtls_pk_init(&(*key)->pk);
 
   IOTC_CHECK_CND_DBGMESSAGE(
-      (mbedtls_ret =
-           mbedtls_pk_parse_key(&pk, (const unsigned char*)private_key_pem,
-                                strlen(private_key_pem) + 1, NULL, 0)) != 0,
+      (mbedtls_ret = mbedtls_pk_parse_key(
+           &(*key)->pk, (const unsigned char*)private_key_pem,
+           strlen(private_key_pem) + 1, NULL, 0)) != 0,
       IOTC_BSP_CRYPTO_KEY_PARSE_ERROR, return_code, "mbedtls_pk_parse_key");
 
-  IOTC_CHECK_CND_DBGMESSAGE(
-      (mbedtls_ret = mbedtls_ecdsa_from_keypair(&ecdsa_sign, pk.pk_ctx)) != 0,
-      IOTC_BSP_CRYPTO_ECC_ERROR, return_code, "mbedtls_ecdsa_from_keypair");
+  IOTC_CHECK_CND_DBGMESSAGE(!mbedtls_pk_can_do(&(*key)->pk, MBEDTLS_PK_ECKEY),
+                            IOTC_BSP_CRYPTO_KEY_PARSE_ERROR, return_code,
+                            "not an EC key");
+
+  return IOTC_BSP_CRYPTO_STATE_OK;
+
+err_handling:
+  if (0 != mbedtls_ret) {
+    iotc_debug_format("mbedtls_ret: %d", mbedtls_ret);
+  }
+
+  iotc_bsp_ecc_key_destroy(key);
+
+  return return_code;
+}
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_sign(iotc_bsp_ecc_key_t* key,
+                                              uint8_t* dst_buf,
+                                              size_t dst_buf_size,
+                                              size_t* bytes_written,
+                                              const uint8_t* src_buf,
+                                              size_t src_buf_len) {
+  if (NULL == key || NULL == dst_buf || NULL == bytes_written ||
+      NULL == src_buf) {
+    return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
+  }
+
+  iotc_bsp_crypto_state_t return_code = IOTC_BSP_CRYPTO_STATE_OK;
+
+  int mbedtls_ret = -1;
+
+  /* signs with the parsed key pair directly, its group caches the
+   * precomputed points between the signatures */
+  mbedtls_ecp_keypair* keypair = mbedtls_pk_ec(key->pk);
+
+  mbedtls_mpi r, s;
+
+  mbedtls_mpi_init(&r);
+  mbedtls_mpi_init(&s);
 
   // Deterministic signatures are generally preferable on devices with poor
   // entropy sources as is so often the case with IoT.
   IOTC_CHECK_CND_DBGMESSAGE((mbedtls_ret = mbedtls_ecdsa_sign_det(
-                                 &ecdsa_sign.grp, &r, &s, &ecdsa_sign.d,
-                                 src_buf, src_buf_len, MBEDTLS_MD_SHA256)) != 0,
+                                 &keypair->grp, &r, &s, &keypair->d, src_buf,
+                                 src_buf_len, MBEDTLS_MD_SHA256)) != 0,
                             IOTC_BSP_CRYPTO_ECC_ERROR, return_code,
                             "mbedtls_ecdsa_sign_det");
 
@@ -170,8 +206,39 @@ err_handling:
   mbedtls_mpi_free(&r);
   mbedtls_mpi_free(&s);
 
-  mbedtls_ecdsa_free(&ecdsa_sign);
-  mbedtls_pk_free(&pk);
+  return return_code;
+}
+
+void iotc_bsp_ecc_key_destroy(iotc_bsp_ecc_key_t** key) {
+  if (NULL == key || NULL == *key) {
+    return;
+  }
+
+  mbedtls_pk_free(&(*key)->pk);
+  iotc_bsp_mem_free(*key);
+  *key = NULL;
+}
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc(
+    const iotc_crypto_key_data_t* private_key_data, uint8_t* dst_buf,
+    size_t dst_buf_size, size_t* bytes_written, const uint8_t* src_buf,
+    size_t src_buf_len) {
+  if (NULL == private_key_data || NULL == dst_buf || NULL == bytes_written ||
+      NULL == src_buf) {
+    return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
+  }
+
+  iotc_bsp_ecc_key_t* key = NULL;
+
+  iotc_bsp_crypto_state_t return_code =
+      iotc_bsp_ecc_key_create(private_key_data, &key);
+
+  if (IOTC_BSP_CRYPTO_STATE_OK == return_code) {
+    return_code = iotc_bsp_ecc_key_sign(key, dst_buf, dst_buf_size,
+                                        bytes_written, src_buf, src_buf_len);
+  }
+
+  iotc_bsp_ecc_key_destroy(&key);
 
   return return_code;
 }
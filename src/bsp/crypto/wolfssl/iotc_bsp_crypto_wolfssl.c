@@ -120,13 +120,13 @@ err_handling:
   return IOTC_BSP_CRYPTO_SHA256_ERROR;
 }
 
-iotc_bsp_crypto_state_t iotc_bsp_ecc(
-    const iotc_crypto_key_data_t* private_key_data, uint8_t* dst_buf,
-    size_t dst_buf_size, size_t* bytes_written, const uint8_t* src_buf,
-    size_t src_buf_len) {
+struct iotc_bsp_ecc_key_s {
+  ecc_key ecc_key_private;
+};
 
-  if (NULL == private_key_data || NULL == dst_buf || NULL == bytes_written ||
-      NULL == src_buf) {
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_create(
+    const iotc_crypto_key_data_t* private_key_data, iotc_bsp_ecc_key_t** key) {
+  if (NULL == private_key_data || NULL == key) {
     return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
   }
 
@@ -139,34 +139,68 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(
 
   const char* private_key_pem = private_key_data->crypto_key_union.key_pem.key;
 
-  int ret = 0;
+  *key = (iotc_bsp_ecc_key_t*)iotc_bsp_mem_alloc(sizeof(iotc_bsp_ecc_key_t));
+
+  if (NULL == *key) {
+    return IOTC_BSP_CRYPTO_ERROR;
+  }
 
   DerBuffer* pDer = NULL;
+
+  int ret = wc_ecc_init(&(*key)->ecc_key_private);
+
+  if (0 != ret) {
+    iotc_bsp_mem_free(*key);
+    *key = NULL;
+    return IOTC_BSP_CRYPTO_ERROR;
+  }
+
   ret = PemToDer((unsigned char*)private_key_pem, strlen(private_key_pem),
                  ECC_PRIVATEKEY_TYPE, &pDer, NULL, NULL, NULL);
 
   IOTC_CHECK_STATE(ret);
 
-  ecc_key ecc_key_private;
-  wc_ecc_init(&ecc_key_private);
-
   word32 in_out_idx = 0;
-  ret = wc_EccPrivateKeyDecode(pDer->buffer, &in_out_idx, &ecc_key_private,
-                               pDer->length);
+  ret = wc_EccPrivateKeyDecode(pDer->buffer, &in_out_idx,
+                               &(*key)->ecc_key_private, pDer->length);
   IOTC_CHECK_STATE(ret);
 
-  mp_int r;
-  ret = mp_init(&r);
-  IOTC_CHECK_STATE(ret);
+  FreeDer(&pDer);
+
+  return IOTC_BSP_CRYPTO_STATE_OK;
+
+err_handling:
 
+  FreeDer(&pDer);
+  iotc_bsp_ecc_key_destroy(key);
+
+  return IOTC_BSP_CRYPTO_KEY_PARSE_ERROR;
+}
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc_key_sign(iotc_bsp_ecc_key_t* key,
+                                              uint8_t* dst_buf,
+                                              size_t dst_buf_size,
+                                              size_t* bytes_written,
+                                              const uint8_t* src_buf,
+                                              size_t src_buf_len) {
+  if (NULL == key || NULL == dst_buf || NULL == bytes_written ||
+      NULL == src_buf) {
+    return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
+  }
+
+  int ret = 0;
+
+  mp_int r;
   mp_int s;
-  ret = mp_init(&s);
+
+  /* both are freed on the error path, neither may be left uninitialized */
+  ret = mp_init_multi(&r, &s, NULL, NULL, NULL, NULL);
   IOTC_CHECK_STATE(ret);
 
-  // wolfcrypt_rng is declared in iotc_bsp_crypto_wolfssl.c and should 
+  // wolfcrypt_rng is declared in iotc_bsp_crypto_wolfssl.c and should
   // be instantiated in platform BSP RNG implementation
-  ret = wc_ecc_sign_hash_ex((const byte*)src_buf, src_buf_len, 
-                            &wolfcrypt_rng, &ecc_key_private, &r, &s);
+  ret = wc_ecc_sign_hash_ex((const byte*)src_buf, src_buf_len, &wolfcrypt_rng,
+                            &key->ecc_key_private, &r, &s);
   IOTC_CHECK_STATE(ret);
 
   // two 32 byte integers build up a JWT ECC signature: r and s
@@ -187,19 +221,49 @@ iotc_bsp_crypto_state_t iotc_bsp_ecc(
 
 err_handling:
 
-  FreeDer(&pDer);
-  wc_ecc_free(&ecc_key_private);
   mp_free(&r);
   mp_free(&s);
 
   switch (ret) {
+    case 0:
+      return IOTC_BSP_CRYPTO_STATE_OK;
     case BUFFER_E:
       return IOTC_BSP_CRYPTO_BUFFER_TOO_SMALL_ERROR;
-    case ASN_NO_PEM_HEADER:
-      return IOTC_BSP_CRYPTO_KEY_PARSE_ERROR;
     default:
-      return IOTC_BSP_CRYPTO_STATE_OK;
+      return IOTC_BSP_CRYPTO_ECC_ERROR;
   }
+}
 
-  return IOTC_BSP_CRYPTO_STATE_OK;
+void iotc_bsp_ecc_key_destroy(iotc_bsp_ecc_key_t** key) {
+  if (NULL == key || NULL == *key) {
+    return;
+  }
+
+  wc_ecc_free(&(*key)->ecc_key_private);
+  iotc_bsp_mem_free(*key);
+  *key = NULL;
+}
+
+iotc_bsp_crypto_state_t iotc_bsp_ecc(
+    const iotc_crypto_key_data_t* private_key_data, uint8_t* dst_buf,
+    size_t dst_buf_size, size_t* bytes_written, const uint8_t* src_buf,
+    size_t src_buf_len) {
+  if (NULL == private_key_data || NULL == dst_buf || NULL == bytes_written ||
+      NULL == src_buf) {
+    return IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR;
+  }
+
+  iotc_bsp_ecc_key_t* key = NULL;
+
+  iotc_bsp_crypto_state_t return_code =
+      iotc_bsp_ecc_key_create(private_key_data, &key);
+
+  if (IOTC_BSP_CRYPTO_STATE_OK == return_code) {
+    return_code = iotc_bsp_ecc_key_sign(key, dst_buf, dst_buf_size,
+                                        bytes_written, src_buf, src_buf_len);
+  }
+
+  iotc_bsp_ecc_key_destroy(&key);
+
+  return return_code;
 }
@@ -55,6 +55,18 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_write(iotc_bsp_socket_t iotc_socket,
   return IOTC_BSP_IO_NET_STATE_OK;
 }
 
+iotc_bsp_io_net_state_t iotc_bsp_io_net_writev(
+    iotc_bsp_socket_t iotc_socket, int* out_written_count,
+    const iotc_bsp_io_net_chunk_t* chunks, size_t chunk_count) {
+  IOTC_UNUSED(iotc_socket);
+  size_t i = 0;
+  *out_written_count = 0;
+  for (i = 0; i < chunk_count; ++i) {
+    *out_written_count += chunks[i].count;
+  }
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
 iotc_bsp_io_net_state_t iotc_bsp_io_net_read(iotc_bsp_socket_t iotc_socket,
                                              int* out_read_count, uint8_t* buf,
                                              size_t count) {
@@ -71,16 +83,24 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_close_socket(
   return IOTC_BSP_IO_NET_STATE_OK;
 }
 
-iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select_ms(
     iotc_bsp_socket_events_t* socket_events_array,
-    size_t socket_events_array_size, long timeout_sec) {
+    size_t socket_events_array_size, long timeout_ms) {
   IOTC_UNUSED(socket_events_array);
   IOTC_UNUSED(socket_events_array_size);
-  IOTC_UNUSED(timeout_sec);
+  IOTC_UNUSED(timeout_ms);
 
   return IOTC_BSP_IO_NET_STATE_OK;
 }
 
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
+    iotc_bsp_socket_events_t* socket_events_array,
+    size_t socket_events_array_size, long timeout_sec) {
+  return iotc_bsp_io_net_select_ms(socket_events_array,
+                                   socket_events_array_size,
+                                   timeout_sec * 1000);
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
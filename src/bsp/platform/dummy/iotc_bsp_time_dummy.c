@@ -22,3 +22,10 @@ void iotc_bsp_time_init() { /* empty */
 iotc_time_t iotc_bsp_time_getcurrenttime_seconds() { return 1; }
 
 iotc_time_t iotc_bsp_time_getcurrenttime_milliseconds() { return 1; }
+
+/* a counter, so waits on the monotonic clock still come to an end */
+iotc_time_t iotc_bsp_time_getmonotonictime_milliseconds() {
+  static iotc_time_t iotc_bsp_time_dummy_monotonic_ms = 0;
+
+  return ++iotc_bsp_time_dummy_monotonic_ms;
+}
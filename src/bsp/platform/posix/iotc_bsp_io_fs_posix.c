@@ -17,6 +17,8 @@
 #include <iotc_bsp_io_fs.h>
 #include <iotc_bsp_mem.h>
 
+#include <iotc_critical_section.h>
+#include <iotc_critical_section_def.h>
 #include <iotc_list.h>
 
 #include <assert.h>
@@ -24,6 +26,7 @@
 #include <iotc_fs_bsp_to_iotc_mapping.h>
 #include <memory.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
@@ -46,6 +49,11 @@ const size_t iotc_bsp_io_fs_buffer_size = 1024;
 typedef struct iotc_bsp_io_fs_posix_file_handle_container_s {
   int posix_fd;
   uint8_t* memory_buffer;
+  /* the file mapped for IOTC_BSP_IO_FS_OPEN_MMAP, NULL until the first read
+   * and after a failed mapping */
+  uint8_t* mapping;
+  size_t mapping_size;
+  uint8_t mmap_requested;
   struct iotc_bsp_io_fs_posix_file_handle_container_s* __next;
 } iotc_bsp_io_fs_posix_file_handle_container_t;
 
@@ -53,6 +61,10 @@ typedef struct iotc_bsp_io_fs_posix_file_handle_container_s {
 static iotc_bsp_io_fs_posix_file_handle_container_t*
     iotc_bsp_io_fs_posix_files_container;
 
+/* guards the list, the I/O threads of iotc_set_io_threads() open and close
+ * files at the same time, an entry is only used by the owner of its fd */
+static struct iotc_critical_section_s iotc_bsp_io_fs_posix_files_cs = {0};
+
 /* translates bsp errno errors to the iotc_bsp_io_fs_state_t values */
 iotc_bsp_io_fs_state_t iotc_bsp_io_fs_posix_errno_2_iotc_bsp_io_fs_state(
     int errno_value) {
@@ -112,6 +124,65 @@ static uint8_t iotc_bsp_io_fs_posix_file_list_cnd(
   return (list_element->posix_fd == fd) ? 1 : 0;
 }
 
+static iotc_bsp_io_fs_posix_file_handle_container_t*
+iotc_bsp_io_fs_posix_find_file(int fd) {
+  iotc_bsp_io_fs_posix_file_handle_container_t* elem = NULL;
+
+  /* just to satisfy the compiler */
+  (void)iotc_bsp_io_fs_posix_files_cs;
+
+  iotc_lock_critical_section(&iotc_bsp_io_fs_posix_files_cs);
+  IOTC_LIST_FIND(iotc_bsp_io_fs_posix_file_handle_container_t,
+                 iotc_bsp_io_fs_posix_files_container,
+                 iotc_bsp_io_fs_posix_file_list_cnd, fd, elem);
+  iotc_unlock_critical_section(&iotc_bsp_io_fs_posix_files_cs);
+
+  return elem;
+}
+
+static void iotc_bsp_io_fs_posix_unmap(
+    iotc_bsp_io_fs_posix_file_handle_container_t* elem) {
+  if (NULL != elem->mapping) {
+    munmap(elem->mapping, elem->mapping_size);
+  }
+
+  elem->mapping = NULL;
+  elem->mapping_size = 0;
+}
+
+/* maps the whole file, again if it has grown past the old mapping, returns 0
+ * if the file can't be mapped and has to be read */
+static uint8_t iotc_bsp_io_fs_posix_map(
+    iotc_bsp_io_fs_posix_file_handle_container_t* elem, size_t offset) {
+  struct stat stat_struct;
+
+  if (NULL != elem->mapping && offset < elem->mapping_size) {
+    return 1;
+  }
+
+  if (0 != fstat(elem->posix_fd, &stat_struct) ||
+      (size_t)stat_struct.st_size <= offset) {
+    /* nothing to map at the offset, the read tells why */
+    return 0;
+  }
+
+  iotc_bsp_io_fs_posix_unmap(elem);
+
+  void* mapping = mmap(NULL, (size_t)stat_struct.st_size, PROT_READ,
+                       MAP_PRIVATE, elem->posix_fd, 0);
+
+  if (MAP_FAILED == mapping) {
+    /* e.g. a pipe, it is read chunk by chunk from now on */
+    elem->mmap_requested = 0;
+    return 0;
+  }
+
+  elem->mapping = (uint8_t*)mapping;
+  elem->mapping_size = (size_t)stat_struct.st_size;
+
+  return 1;
+}
+
 iotc_bsp_io_fs_state_t iotc_bsp_io_fs_stat(
     const char* const resource_name, iotc_bsp_io_fs_stat_t* resource_stat) {
   if (NULL == resource_stat || NULL == resource_name) {
@@ -156,8 +227,15 @@ iotc_bsp_io_fs_state_t iotc_bsp_io_fs_open(
   iotc_bsp_io_fs_posix_file_handle_container_t* new_entry = NULL;
   iotc_bsp_io_fs_state_t ret = IOTC_BSP_IO_FS_STATE_OK;
 
-  int fd = open(resource_name,
-                (open_flags & IOTC_BSP_IO_FS_OPEN_READ) ? O_RDONLY : O_WRONLY);
+  int fd = -1;
+
+  if (open_flags & IOTC_BSP_IO_FS_OPEN_READ) {
+    fd = open(resource_name, O_RDONLY);
+  } else if (open_flags & IOTC_BSP_IO_FS_OPEN_CREATE) {
+    fd = open(resource_name, O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR);
+  } else {
+    fd = open(resource_name, O_WRONLY);
+  }
 
   /* if error on fopen check the errno value */
   IOTC_BSP_IO_FS_CHECK_CND(
@@ -171,10 +249,15 @@ iotc_bsp_io_fs_state_t iotc_bsp_io_fs_open(
 
   /* store the posix file pointer */
   new_entry->posix_fd = fd;
+  new_entry->mmap_requested =
+      (open_flags & IOTC_BSP_IO_FS_OPEN_READ) &&
+      (open_flags & IOTC_BSP_IO_FS_OPEN_MMAP);
 
   /* add the entry to the database */
+  iotc_lock_critical_section(&iotc_bsp_io_fs_posix_files_cs);
   IOTC_LIST_PUSH_BACK(iotc_bsp_io_fs_posix_file_handle_container_t,
                       iotc_bsp_io_fs_posix_files_container, new_entry);
+  iotc_unlock_critical_section(&iotc_bsp_io_fs_posix_files_cs);
 
   /* make sure that the size is as expected. */
   assert(sizeof(fd) <= sizeof(iotc_bsp_io_fs_resource_handle_t));
@@ -205,14 +288,20 @@ iotc_bsp_io_fs_state_t iotc_bsp_io_fs_read(
   int fd = (int)resource_handle;
   int fop_ret = 0;
 
-  iotc_bsp_io_fs_posix_file_handle_container_t* elem = NULL;
-  IOTC_LIST_FIND(iotc_bsp_io_fs_posix_file_handle_container_t,
-                 iotc_bsp_io_fs_posix_files_container,
-                 iotc_bsp_io_fs_posix_file_list_cnd, fd, elem);
+  iotc_bsp_io_fs_posix_file_handle_container_t* elem =
+      iotc_bsp_io_fs_posix_find_file(fd);
 
   IOTC_BSP_IO_FS_CHECK_CND(NULL == elem, IOTC_BSP_IO_FS_RESOURCE_NOT_AVAILABLE,
                            ret);
 
+  /* the rest of the file at once, straight from the page cache */
+  if (elem->mmap_requested && iotc_bsp_io_fs_posix_map(elem, offset)) {
+    *buffer = elem->mapping + offset;
+    *buffer_size = elem->mapping_size - offset;
+
+    return IOTC_BSP_IO_FS_STATE_OK;
+  }
+
   /* make an allocation for memory block */
   if (NULL == elem->memory_buffer) {
     elem->memory_buffer =
@@ -265,10 +354,8 @@ iotc_bsp_io_fs_state_t iotc_bsp_io_fs_write(
   iotc_bsp_io_fs_state_t ret = IOTC_BSP_IO_FS_STATE_OK;
   int fd = (int)resource_handle;
 
-  iotc_bsp_io_fs_posix_file_handle_container_t* elem = NULL;
-  IOTC_LIST_FIND(iotc_bsp_io_fs_posix_file_handle_container_t,
-                 iotc_bsp_io_fs_posix_files_container,
-                 iotc_bsp_io_fs_posix_file_list_cnd, fd, elem);
+  iotc_bsp_io_fs_posix_file_handle_container_t* elem =
+      iotc_bsp_io_fs_posix_find_file(fd);
 
   IOTC_BSP_IO_FS_CHECK_CND(NULL == elem, IOTC_BSP_IO_FS_RESOURCE_NOT_AVAILABLE,
                            ret);
@@ -305,17 +392,25 @@ iotc_bsp_io_fs_state_t iotc_bsp_io_fs_close(
   iotc_bsp_io_fs_posix_file_handle_container_t* elem = NULL;
   int fop_ret = 0;
 
+  iotc_lock_critical_section(&iotc_bsp_io_fs_posix_files_cs);
+
   IOTC_LIST_FIND(iotc_bsp_io_fs_posix_file_handle_container_t,
                  iotc_bsp_io_fs_posix_files_container,
                  iotc_bsp_io_fs_posix_file_list_cnd, fd, elem);
 
+  /* remove element from the list */
+  if (NULL != elem) {
+    IOTC_LIST_DROP(iotc_bsp_io_fs_posix_file_handle_container_t,
+                   iotc_bsp_io_fs_posix_files_container, elem);
+  }
+
+  iotc_unlock_critical_section(&iotc_bsp_io_fs_posix_files_cs);
+
   /* if element not on the list return resource not available error */
   IOTC_BSP_IO_FS_CHECK_CND(NULL == elem, IOTC_BSP_IO_FS_RESOURCE_NOT_AVAILABLE,
                            ret);
 
-  /* remove element from the list */
-  IOTC_LIST_DROP(iotc_bsp_io_fs_posix_file_handle_container_t,
-                 iotc_bsp_io_fs_posix_files_container, elem);
+  iotc_bsp_io_fs_posix_unmap(elem);
 
   fop_ret = close(fd);
 
@@ -0,0 +1,221 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef IOTC_EVENT_LOOP_EPOLL
+
+#include <iotc_bsp_io_net_poller.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef IOTC_BSP_IO_NET_POLLER_EPOLL_MAX_EVENTS
+#define IOTC_BSP_IO_NET_POLLER_EPOLL_MAX_EVENTS 32
+#endif
+
+/* the interest of a socket travels with it in the upper half of the epoll
+ * user data, so a wait can tell a finished connect from a writable socket
+ * without looking the socket up */
+#define IOTC_POLLER_WANT_READ (1u << 0)
+#define IOTC_POLLER_WANT_WRITE (1u << 1)
+#define IOTC_POLLER_WANT_ERROR (1u << 2)
+#define IOTC_POLLER_WANT_CONNECT (1u << 3)
+
+static uint64_t iotc_bsp_poller_pack(iotc_bsp_socket_t iotc_socket,
+                                     uint32_t interest) {
+  return ((uint64_t)interest << 32) | (uint32_t)iotc_socket;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_create(
+    iotc_bsp_poller_t* out_poller) {
+  if (NULL == out_poller) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+  if (-1 == epoll_fd) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  *out_poller = epoll_fd;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_destroy(
+    iotc_bsp_poller_t* poller) {
+  if (NULL == poller) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  close(*poller);
+
+  *poller = -1;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_update(
+    iotc_bsp_poller_t poller, const iotc_bsp_socket_events_t* socket_events) {
+  if (NULL == socket_events) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  uint32_t interest = 0;
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+
+  if (1 == socket_events->in_socket_want_read) {
+    event.events |= EPOLLIN;
+    interest |= IOTC_POLLER_WANT_READ;
+  }
+
+  if (1 == socket_events->in_socket_want_write) {
+    event.events |= EPOLLOUT;
+    interest |= IOTC_POLLER_WANT_WRITE;
+  }
+
+  if (1 == socket_events->in_socket_want_connect) {
+    event.events |= EPOLLOUT;
+    interest |= IOTC_POLLER_WANT_CONNECT;
+  }
+
+  /* select reports out-of-band data through the error set */
+  if (1 == socket_events->in_socket_want_error) {
+    event.events |= EPOLLPRI;
+    interest |= IOTC_POLLER_WANT_ERROR;
+  }
+
+  event.data.u64 = iotc_bsp_poller_pack(socket_events->iotc_socket, interest);
+
+  /* most updates change the interest of an already registered socket */
+  if (0 == epoll_ctl(poller, EPOLL_CTL_MOD, socket_events->iotc_socket,
+                     &event)) {
+    return IOTC_BSP_IO_NET_STATE_OK;
+  }
+
+  if (ENOENT == errno &&
+      0 == epoll_ctl(poller, EPOLL_CTL_ADD, socket_events->iotc_socket,
+                     &event)) {
+    errno = 0;
+    return IOTC_BSP_IO_NET_STATE_OK;
+  }
+
+  errno = 0;
+  return IOTC_BSP_IO_NET_STATE_ERROR;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_remove(
+    iotc_bsp_poller_t poller, iotc_bsp_socket_t iotc_socket) {
+  /* a non-NULL event keeps pre 2.6.9 kernels happy */
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+
+  if (-1 == epoll_ctl(poller, EPOLL_CTL_DEL, iotc_socket, &event)) {
+    errno = 0;
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_wait(
+    iotc_bsp_poller_t poller, iotc_bsp_socket_events_t* out_events,
+    size_t out_events_size, size_t* out_events_count, long timeout_ms) {
+  if (NULL == out_events || NULL == out_events_count) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  *out_events_count = 0;
+
+  struct epoll_event events[IOTC_BSP_IO_NET_POLLER_EPOLL_MAX_EVENTS];
+
+  const int max_events =
+      (int)(out_events_size < IOTC_BSP_IO_NET_POLLER_EPOLL_MAX_EVENTS
+                ? out_events_size
+                : IOTC_BSP_IO_NET_POLLER_EPOLL_MAX_EVENTS);
+
+  const int result =
+      epoll_wait(poller, events, max_events, (int)timeout_ms);
+
+  if (0 > result) {
+    const int errval = errno;
+    errno = 0;
+
+    /* a signal is not a failure of the poller, treat it as a short wait */
+    return (EINTR == errval) ? IOTC_BSP_IO_NET_STATE_TIMEOUT
+                             : IOTC_BSP_IO_NET_STATE_ERROR;
+  } else if (0 == result) {
+    return IOTC_BSP_IO_NET_STATE_TIMEOUT;
+  }
+
+  int event_id = 0;
+  for (event_id = 0; event_id < result; ++event_id) {
+    const uint32_t interest = (uint32_t)(events[event_id].data.u64 >> 32);
+    const uint32_t ready = events[event_id].events;
+
+    iotc_bsp_socket_events_t* socket_events = &out_events[event_id];
+    memset(socket_events, 0, sizeof(iotc_bsp_socket_events_t));
+
+    socket_events->iotc_socket =
+        (int32_t)(events[event_id].data.u64 & 0xFFFFFFFF);
+
+    socket_events->in_socket_want_read =
+        (interest & IOTC_POLLER_WANT_READ) ? 1 : 0;
+    socket_events->in_socket_want_write =
+        (interest & IOTC_POLLER_WANT_WRITE) ? 1 : 0;
+    socket_events->in_socket_want_error =
+        (interest & IOTC_POLLER_WANT_ERROR) ? 1 : 0;
+    socket_events->in_socket_want_connect =
+        (interest & IOTC_POLLER_WANT_CONNECT) ? 1 : 0;
+
+    if (ready & EPOLLIN) {
+      socket_events->out_socket_can_read = 1;
+    }
+
+    if (ready & EPOLLOUT) {
+      socket_events->out_socket_connect_finished =
+          socket_events->in_socket_want_connect;
+      socket_events->out_socket_can_write = socket_events->in_socket_want_write;
+    }
+
+    /* epoll always reports errors and hang ups, which is what a select based
+     * loop eventually learns through a failing read or write */
+    if (ready & (EPOLLERR | EPOLLHUP | EPOLLPRI)) {
+      socket_events->out_socket_error = 1;
+    }
+  }
+
+  *out_events_count = (size_t)result;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+iotc_bsp_socket_t iotc_bsp_io_net_poller_get_socket(iotc_bsp_poller_t poller) {
+  return poller;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTC_EVENT_LOOP_EPOLL */
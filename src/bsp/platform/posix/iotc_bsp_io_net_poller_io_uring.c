@@ -0,0 +1,565 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef IOTC_EVENT_LOOP_IO_URING
+
+#include <iotc_bsp_io_net_poller.h>
+#include <iotc_bsp_mem.h>
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sockets are watched with one-shot IORING_OP_POLL_ADD requests. A request is
+ * re-armed after each completion, which keeps the level-triggered semantics of
+ * select. Changing the interest of an armed socket cancels its request and
+ * arms a new one; the generation in the user data lets the wait drop
+ * completions of cancelled requests.
+ */
+
+#ifndef IOTC_BSP_IO_NET_POLLER_IO_URING_ENTRIES
+#define IOTC_BSP_IO_NET_POLLER_IO_URING_ENTRIES 64
+#endif
+
+#define IOTC_POLLER_WANT_READ (1u << 0)
+#define IOTC_POLLER_WANT_WRITE (1u << 1)
+#define IOTC_POLLER_WANT_ERROR (1u << 2)
+#define IOTC_POLLER_WANT_CONNECT (1u << 3)
+
+/* completions of POLL_REMOVE requests carry this bit and are dropped */
+#define IOTC_POLLER_USER_DATA_REMOVE (1ull << 63)
+
+typedef struct iotc_bsp_poller_socket_s {
+  uint32_t interest;
+  uint32_t generation;
+  uint8_t registered;
+  uint8_t armed;
+} iotc_bsp_poller_socket_t;
+
+typedef struct iotc_bsp_poller_io_uring_s {
+  int ring_fd;
+
+  void* sq_ring;
+  size_t sq_ring_size;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_ring_mask;
+  unsigned* sq_array;
+  unsigned sq_entries;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  unsigned to_submit;
+
+  void* cq_ring;
+  size_t cq_ring_size;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_ring_mask;
+  struct io_uring_cqe* cqes;
+
+  iotc_bsp_poller_socket_t* sockets;
+  size_t sockets_size;
+} iotc_bsp_poller_io_uring_t;
+
+static int iotc_io_uring_setup(unsigned entries,
+                               struct io_uring_params* params) {
+  return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int iotc_io_uring_enter(int ring_fd, unsigned to_submit,
+                               unsigned min_complete, unsigned flags, void* arg,
+                               size_t arg_size) {
+  return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                      flags, arg, arg_size);
+}
+
+static uint64_t iotc_bsp_poller_pack(iotc_bsp_socket_t iotc_socket,
+                                     uint32_t generation) {
+  return ((uint64_t)(generation & 0x7FFFFFFF) << 32) | (uint32_t)iotc_socket;
+}
+
+static uint32_t iotc_bsp_poller_poll_mask(uint32_t interest) {
+  uint32_t mask = 0;
+
+  if (interest & IOTC_POLLER_WANT_READ) {
+    mask |= POLLIN;
+  }
+
+  if (interest & (IOTC_POLLER_WANT_WRITE | IOTC_POLLER_WANT_CONNECT)) {
+    mask |= POLLOUT;
+  }
+
+  if (interest & IOTC_POLLER_WANT_ERROR) {
+    mask |= POLLPRI;
+  }
+
+  return mask;
+}
+
+static iotc_bsp_io_net_state_t iotc_bsp_poller_submit(
+    iotc_bsp_poller_io_uring_t* ring) {
+  while (0 < ring->to_submit) {
+    const int result =
+        iotc_io_uring_enter(ring->ring_fd, ring->to_submit, 0, 0, NULL, 0);
+
+    if (0 > result) {
+      if (EINTR == errno || EAGAIN == errno || EBUSY == errno) {
+        errno = 0;
+        continue;
+      }
+
+      errno = 0;
+      return IOTC_BSP_IO_NET_STATE_ERROR;
+    }
+
+    ring->to_submit -= (unsigned)result;
+  }
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+static struct io_uring_sqe* iotc_bsp_poller_get_sqe(
+    iotc_bsp_poller_io_uring_t* ring) {
+  const unsigned tail = *ring->sq_tail;
+
+  /* the submission queue is full, let the kernel consume it first */
+  if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >=
+      ring->sq_entries) {
+    if (IOTC_BSP_IO_NET_STATE_OK != iotc_bsp_poller_submit(ring)) {
+      return NULL;
+    }
+  }
+
+  const unsigned index = tail & *ring->sq_ring_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring->to_submit += 1;
+
+  return sqe;
+}
+
+static iotc_bsp_io_net_state_t iotc_bsp_poller_arm(
+    iotc_bsp_poller_io_uring_t* ring, iotc_bsp_socket_t iotc_socket) {
+  iotc_bsp_poller_socket_t* entry = &ring->sockets[iotc_socket];
+  struct io_uring_sqe* sqe = iotc_bsp_poller_get_sqe(ring);
+
+  if (NULL == sqe) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = (int32_t)iotc_socket;
+  sqe->poll32_events = iotc_bsp_poller_poll_mask(entry->interest);
+  sqe->user_data = iotc_bsp_poller_pack(iotc_socket, entry->generation);
+
+  entry->armed = 1;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+static iotc_bsp_io_net_state_t iotc_bsp_poller_disarm(
+    iotc_bsp_poller_io_uring_t* ring, iotc_bsp_socket_t iotc_socket) {
+  iotc_bsp_poller_socket_t* entry = &ring->sockets[iotc_socket];
+
+  if (1 == entry->armed) {
+    struct io_uring_sqe* sqe = iotc_bsp_poller_get_sqe(ring);
+
+    if (NULL == sqe) {
+      return IOTC_BSP_IO_NET_STATE_ERROR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = iotc_bsp_poller_pack(iotc_socket, entry->generation);
+    sqe->user_data = IOTC_POLLER_USER_DATA_REMOVE;
+  }
+
+  entry->armed = 0;
+  entry->generation += 1;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+static iotc_bsp_io_net_state_t iotc_bsp_poller_reserve(
+    iotc_bsp_poller_io_uring_t* ring, iotc_bsp_socket_t iotc_socket) {
+  if ((size_t)iotc_socket < ring->sockets_size) {
+    return IOTC_BSP_IO_NET_STATE_OK;
+  }
+
+  size_t new_size = (0 == ring->sockets_size) ? 16 : ring->sockets_size * 2;
+
+  while (new_size <= (size_t)iotc_socket) {
+    new_size *= 2;
+  }
+
+  iotc_bsp_poller_socket_t* sockets = (iotc_bsp_poller_socket_t*)
+      iotc_bsp_mem_realloc(ring->sockets, new_size * sizeof(*sockets));
+
+  if (NULL == sockets) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  memset(sockets + ring->sockets_size, 0,
+         (new_size - ring->sockets_size) * sizeof(*sockets));
+
+  ring->sockets = sockets;
+  ring->sockets_size = new_size;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+static void iotc_bsp_poller_unmap(iotc_bsp_poller_io_uring_t* ring) {
+  if (NULL != ring->sqes) {
+    munmap(ring->sqes, ring->sqes_size);
+  }
+
+  if (NULL != ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+
+  if (NULL != ring->sq_ring) {
+    munmap(ring->sq_ring, ring->sq_ring_size);
+  }
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_create(
+    iotc_bsp_poller_t* out_poller) {
+  if (NULL == out_poller) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  iotc_bsp_poller_io_uring_t* ring =
+      (iotc_bsp_poller_io_uring_t*)iotc_bsp_mem_alloc(sizeof(*ring));
+
+  if (NULL == ring) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  memset(ring, 0, sizeof(*ring));
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  ring->ring_fd =
+      iotc_io_uring_setup(IOTC_BSP_IO_NET_POLLER_IO_URING_ENTRIES, &params);
+
+  if (0 > ring->ring_fd) {
+    errno = 0;
+    iotc_bsp_mem_free(ring);
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  /* the wait relies on the timeout argument of io_uring_enter (Linux 5.11) */
+  if (0 == (params.features & IORING_FEAT_EXT_ARG)) {
+    goto err_handling;
+  }
+
+  ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cq_ring_size > ring->sq_ring_size) {
+      ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+
+  ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                       IORING_OFF_SQ_RING);
+
+  if (MAP_FAILED == ring->sq_ring) {
+    ring->sq_ring = NULL;
+    goto err_handling;
+  }
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    ring->cq_ring = ring->sq_ring;
+  } else {
+    ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                         IORING_OFF_CQ_RING);
+
+    if (MAP_FAILED == ring->cq_ring) {
+      ring->cq_ring = NULL;
+      goto err_handling;
+    }
+  }
+
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = (struct io_uring_sqe*)mmap(
+      NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+      ring->ring_fd, IORING_OFF_SQES);
+
+  if (MAP_FAILED == ring->sqes) {
+    ring->sqes = NULL;
+    goto err_handling;
+  }
+
+  ring->sq_head = (unsigned*)((uint8_t*)ring->sq_ring + params.sq_off.head);
+  ring->sq_tail = (unsigned*)((uint8_t*)ring->sq_ring + params.sq_off.tail);
+  ring->sq_ring_mask =
+      (unsigned*)((uint8_t*)ring->sq_ring + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned*)((uint8_t*)ring->sq_ring + params.sq_off.array);
+  ring->sq_entries = params.sq_entries;
+
+  ring->cq_head = (unsigned*)((uint8_t*)ring->cq_ring + params.cq_off.head);
+  ring->cq_tail = (unsigned*)((uint8_t*)ring->cq_ring + params.cq_off.tail);
+  ring->cq_ring_mask =
+      (unsigned*)((uint8_t*)ring->cq_ring + params.cq_off.ring_mask);
+  ring->cqes =
+      (struct io_uring_cqe*)((uint8_t*)ring->cq_ring + params.cq_off.cqes);
+
+  *out_poller = (iotc_bsp_poller_t)ring;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+
+err_handling:
+  errno = 0;
+  iotc_bsp_poller_unmap(ring);
+  close(ring->ring_fd);
+  iotc_bsp_mem_free(ring);
+
+  return IOTC_BSP_IO_NET_STATE_ERROR;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_destroy(
+    iotc_bsp_poller_t* poller) {
+  if (NULL == poller || 0 == *poller) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  iotc_bsp_poller_io_uring_t* ring = (iotc_bsp_poller_io_uring_t*)*poller;
+
+  /* closing the ring cancels all pending poll requests */
+  iotc_bsp_poller_unmap(ring);
+  close(ring->ring_fd);
+  iotc_bsp_mem_free(ring->sockets);
+  iotc_bsp_mem_free(ring);
+
+  *poller = 0;
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_update(
+    iotc_bsp_poller_t poller, const iotc_bsp_socket_events_t* socket_events) {
+  if (0 == poller || NULL == socket_events || 0 > socket_events->iotc_socket) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  iotc_bsp_poller_io_uring_t* ring = (iotc_bsp_poller_io_uring_t*)poller;
+  const iotc_bsp_socket_t iotc_socket = socket_events->iotc_socket;
+
+  if (IOTC_BSP_IO_NET_STATE_OK != iotc_bsp_poller_reserve(ring, iotc_socket)) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  uint32_t interest = 0;
+  interest |= socket_events->in_socket_want_read ? IOTC_POLLER_WANT_READ : 0;
+  interest |= socket_events->in_socket_want_write ? IOTC_POLLER_WANT_WRITE : 0;
+  interest |= socket_events->in_socket_want_error ? IOTC_POLLER_WANT_ERROR : 0;
+  interest |=
+      socket_events->in_socket_want_connect ? IOTC_POLLER_WANT_CONNECT : 0;
+
+  iotc_bsp_poller_socket_t* entry = &ring->sockets[iotc_socket];
+
+  if (1 == entry->registered && 1 == entry->armed &&
+      interest == entry->interest) {
+    return IOTC_BSP_IO_NET_STATE_OK;
+  }
+
+  if (IOTC_BSP_IO_NET_STATE_OK != iotc_bsp_poller_disarm(ring, iotc_socket)) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  entry->registered = 1;
+  entry->interest = interest;
+
+  return iotc_bsp_poller_arm(ring, iotc_socket);
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_remove(
+    iotc_bsp_poller_t poller, iotc_bsp_socket_t iotc_socket) {
+  if (0 == poller || 0 > iotc_socket) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  iotc_bsp_poller_io_uring_t* ring = (iotc_bsp_poller_io_uring_t*)poller;
+
+  if ((size_t)iotc_socket >= ring->sockets_size ||
+      0 == ring->sockets[iotc_socket].registered) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  const iotc_bsp_io_net_state_t state =
+      iotc_bsp_poller_disarm(ring, iotc_socket);
+
+  ring->sockets[iotc_socket].registered = 0;
+  ring->sockets[iotc_socket].interest = 0;
+
+  /* the socket is usually closed right after, the cancellation must reach
+   * the kernel before the descriptor number can be reused */
+  if (IOTC_BSP_IO_NET_STATE_OK != state) {
+    return state;
+  }
+
+  return iotc_bsp_poller_submit(ring);
+}
+
+iotc_bsp_io_net_state_t iotc_bsp_io_net_poller_wait(
+    iotc_bsp_poller_t poller, iotc_bsp_socket_events_t* out_events,
+    size_t out_events_size, size_t* out_events_count, long timeout_ms) {
+  if (0 == poller || NULL == out_events || NULL == out_events_count) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  iotc_bsp_poller_io_uring_t* ring = (iotc_bsp_poller_io_uring_t*)poller;
+
+  *out_events_count = 0;
+
+  struct __kernel_timespec timeout;
+  memset(&timeout, 0, sizeof(timeout));
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.ts = (uint64_t)(uintptr_t)&timeout;
+
+  const int result = iotc_io_uring_enter(
+      ring->ring_fd, ring->to_submit, 1,
+      IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+  if (0 > result) {
+    const int errval = errno;
+    errno = 0;
+
+    if (ETIME != errval && EINTR != errval) {
+      return IOTC_BSP_IO_NET_STATE_ERROR;
+    }
+  } else {
+    ring->to_submit -= (unsigned)result;
+  }
+
+  unsigned head = *ring->cq_head;
+  const unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_ring_mask];
+
+    if (cqe->user_data & IOTC_POLLER_USER_DATA_REMOVE) {
+      continue;
+    }
+
+    const iotc_bsp_socket_t iotc_socket =
+        (iotc_bsp_socket_t)(cqe->user_data & 0xFFFFFFFF);
+    const uint32_t generation = (uint32_t)(cqe->user_data >> 32);
+
+    if ((size_t)iotc_socket >= ring->sockets_size) {
+      continue;
+    }
+
+    iotc_bsp_poller_socket_t* entry = &ring->sockets[iotc_socket];
+
+    /* a completion of a request that has been cancelled or replaced */
+    if (0 == entry->registered ||
+        generation != (entry->generation & 0x7FFFFFFF)) {
+      continue;
+    }
+
+    entry->armed = 0;
+
+    if (*out_events_count < out_events_size) {
+      /* a failed request, e.g. on a closed descriptor, is reported as an
+       * error on the socket and isn't re-armed */
+      const uint32_t ready = (0 <= cqe->res) ? (uint32_t)cqe->res : POLLERR;
+
+      iotc_bsp_socket_events_t* socket_events = &out_events[*out_events_count];
+      memset(socket_events, 0, sizeof(iotc_bsp_socket_events_t));
+
+      socket_events->iotc_socket = iotc_socket;
+      socket_events->in_socket_want_read =
+          (entry->interest & IOTC_POLLER_WANT_READ) ? 1 : 0;
+      socket_events->in_socket_want_write =
+          (entry->interest & IOTC_POLLER_WANT_WRITE) ? 1 : 0;
+      socket_events->in_socket_want_error =
+          (entry->interest & IOTC_POLLER_WANT_ERROR) ? 1 : 0;
+      socket_events->in_socket_want_connect =
+          (entry->interest & IOTC_POLLER_WANT_CONNECT) ? 1 : 0;
+
+      if (ready & POLLIN) {
+        socket_events->out_socket_can_read = 1;
+      }
+
+      if (ready & POLLOUT) {
+        socket_events->out_socket_connect_finished =
+            socket_events->in_socket_want_connect;
+        socket_events->out_socket_can_write =
+            socket_events->in_socket_want_write;
+      }
+
+      if (ready & (POLLERR | POLLHUP | POLLPRI)) {
+        socket_events->out_socket_error = 1;
+      }
+
+      *out_events_count += 1;
+    }
+
+    if (0 > cqe->res) {
+      continue;
+    }
+
+    /* one-shot requests are re-armed; a socket that is still ready, or that
+     * didn't fit in out_events, completes again on the next wait */
+    if (IOTC_BSP_IO_NET_STATE_OK != iotc_bsp_poller_arm(ring, iotc_socket)) {
+      __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+      return IOTC_BSP_IO_NET_STATE_ERROR;
+    }
+  }
+
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+  return (0 == *out_events_count) ? IOTC_BSP_IO_NET_STATE_TIMEOUT
+                                  : IOTC_BSP_IO_NET_STATE_OK;
+}
+
+iotc_bsp_socket_t iotc_bsp_io_net_poller_get_socket(iotc_bsp_poller_t poller) {
+  if (0 == poller) {
+    return -1;
+  }
+
+  return ((iotc_bsp_poller_io_uring_t*)poller)->ring_fd;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTC_EVENT_LOOP_IO_URING */
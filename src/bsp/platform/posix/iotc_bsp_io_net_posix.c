@@ -25,6 +25,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include "iotc_macros.h"
 
@@ -36,6 +37,11 @@ extern "C" {
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #endif
 
+/* well below the IOV_MAX of any POSIX system */
+#ifndef IOTC_BSP_IO_NET_POSIX_MAX_IOV
+#define IOTC_BSP_IO_NET_POSIX_MAX_IOV 16
+#endif
+
 iotc_bsp_io_net_state_t iotc_bsp_io_net_socket_connect(
     iotc_bsp_socket_t* iotc_socket, const char* host, uint16_t port,
     iotc_bsp_socket_type_t socket_type) {
@@ -160,6 +166,57 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_write(iotc_bsp_socket_t iotc_socket,
   return IOTC_BSP_IO_NET_STATE_OK;
 }
 
+iotc_bsp_io_net_state_t iotc_bsp_io_net_writev(
+    iotc_bsp_socket_t iotc_socket, int* out_written_count,
+    const iotc_bsp_io_net_chunk_t* chunks, size_t chunk_count) {
+  if (NULL == out_written_count || NULL == chunks || 0 == chunk_count) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  struct iovec iov[IOTC_BSP_IO_NET_POSIX_MAX_IOV];
+  const size_t iov_count = IOTC_MIN(chunk_count, IOTC_ARRAYSIZE(iov));
+  size_t i = 0;
+
+  for (i = 0; i < iov_count; ++i) {
+    iov[i].iov_base = (void*)chunks[i].buf;
+    iov[i].iov_len = chunks[i].count;
+  }
+
+  int errval = 0;
+  socklen_t lon = sizeof(int);
+
+  if (getsockopt(iotc_socket, SOL_SOCKET, SO_ERROR, (void*)(&errval), &lon) <
+      0) {
+    errval = errno;
+    errno = 0;
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  if (errval != 0) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  *out_written_count = writev(iotc_socket, iov, (int)iov_count);
+
+  if (*out_written_count < 0) {
+    *out_written_count = 0;
+
+    errval = errno;
+    errno = 0;
+
+    if (EAGAIN == errval) {
+      return IOTC_BSP_IO_NET_STATE_BUSY;
+    }
+
+    if (ECONNRESET == errval || EPIPE == errval) {
+      return IOTC_BSP_IO_NET_STATE_CONNECTION_RESET;
+    }
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  return IOTC_BSP_IO_NET_STATE_OK;
+}
+
 iotc_bsp_io_net_state_t iotc_bsp_io_net_read(iotc_bsp_socket_t iotc_socket,
                                              int* out_read_count, uint8_t* buf,
                                              size_t count) {
@@ -209,9 +266,9 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_close_socket(
   return IOTC_BSP_IO_NET_STATE_OK;
 }
 
-iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select_ms(
     iotc_bsp_socket_events_t* socket_events_array,
-    size_t socket_events_array_size, long timeout_sec) {
+    size_t socket_events_array_size, long timeout_ms) {
   fd_set rfds;
   fd_set wfds;
   fd_set efds;
@@ -263,7 +320,8 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
   /* calculate max fd */
   const int max_fd = MAX(max_fd_read, MAX(max_fd_write, max_fd_error));
 
-  tv.tv_sec = timeout_sec;
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = (timeout_ms % 1000) * 1000;
 
   /* call the actual posix select */
   const int result = select(max_fd + 1, &rfds, &wfds, &efds, &tv);
@@ -300,6 +358,14 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
   return IOTC_BSP_IO_NET_STATE_ERROR;
 }
 
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
+    iotc_bsp_socket_events_t* socket_events_array,
+    size_t socket_events_array_size, long timeout_sec) {
+  return iotc_bsp_io_net_select_ms(socket_events_array,
+                                   socket_events_array_size,
+                                   timeout_sec * 1000);
+}
+
 #ifdef __cplusplus
 }
 #endif
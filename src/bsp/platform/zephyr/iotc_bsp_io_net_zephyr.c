@@ -131,6 +131,40 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_write(iotc_bsp_socket_t iotc_socket,
   return IOTC_BSP_IO_NET_STATE_OK;
 }
 
+iotc_bsp_io_net_state_t iotc_bsp_io_net_writev(
+    iotc_bsp_socket_t iotc_socket, int* out_written_count,
+    const iotc_bsp_io_net_chunk_t* chunks, size_t chunk_count) {
+  if (NULL == out_written_count || NULL == chunks || 0 == chunk_count) {
+    return IOTC_BSP_IO_NET_STATE_ERROR;
+  }
+
+  iotc_bsp_io_net_state_t state = IOTC_BSP_IO_NET_STATE_OK;
+  int written_count = 0;
+  size_t chunk_id = 0;
+
+  *out_written_count = 0;
+
+  /* no gather write here, the buffers are written one by one until the socket
+   * takes less than a whole buffer; the SDK calls again with the rest */
+  for (chunk_id = 0; chunk_id < chunk_count; ++chunk_id) {
+    state = iotc_bsp_io_net_write(iotc_socket, &written_count,
+                                  chunks[chunk_id].buf, chunks[chunk_id].count);
+
+    if (IOTC_BSP_IO_NET_STATE_OK != state) {
+      break;
+    }
+
+    *out_written_count += written_count;
+
+    if ((size_t)written_count < chunks[chunk_id].count) {
+      break;
+    }
+  }
+
+  /* the buffers written before a failed one still count as written */
+  return (0 < *out_written_count) ? IOTC_BSP_IO_NET_STATE_OK : state;
+}
+
 iotc_bsp_io_net_state_t iotc_bsp_io_net_read(iotc_bsp_socket_t iotc_socket,
                                              int* out_read_count, uint8_t* buf,
                                              size_t count) {
@@ -182,9 +216,9 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_close_socket(
   pollfd.events |= event;
 #define FD_ISSET(event, pollfd) (pollfd.revents | event)
 
-iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select_ms(
     iotc_bsp_socket_events_t* socket_events_array,
-    size_t socket_events_array_size, long timeout_sec) {
+    size_t socket_events_array_size, long timeout_ms) {
   struct pollfd fds[1];  // note: single socket support
 
   /* translate the library socket events settings to the event sets used by
@@ -214,7 +248,7 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
   }
 
   /* call the actual posix select */
-  const int result = poll(fds, 1, timeout_sec);
+  const int result = poll(fds, 1, timeout_ms);
 
   if (0 < result) {
     /* translate the result back to the socket events structure */
@@ -248,3 +282,11 @@ iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
   return IOTC_BSP_IO_NET_STATE_ERROR;
 }
 
+iotc_bsp_io_net_state_t iotc_bsp_io_net_select(
+    iotc_bsp_socket_events_t* socket_events_array,
+    size_t socket_events_array_size, long timeout_sec) {
+  return iotc_bsp_io_net_select_ms(socket_events_array,
+                                   socket_events_array_size,
+                                   timeout_sec * 1000);
+}
+
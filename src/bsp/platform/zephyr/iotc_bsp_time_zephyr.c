@@ -16,6 +16,7 @@
 
 #include <iotc_bsp_time.h>
 
+#include <kernel.h>
 #include <stddef.h>
 #include <time.h>
 
@@ -37,3 +38,8 @@ iotc_time_t iotc_bsp_time_getcurrenttime_milliseconds() {
                        (current_time.tv_usec + 500) /
                            1000); /* round the microseconds to milliseconds */
 }
+
+iotc_time_t iotc_bsp_time_getmonotonictime_milliseconds() {
+  /* the time since the kernel started, it doesn't follow clock changes */
+  return (iotc_time_t)k_uptime_get();
+}
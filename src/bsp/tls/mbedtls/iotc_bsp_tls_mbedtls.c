@@ -18,6 +18,8 @@
 #include <iotc_allocator.h>
 #include <iotc_bsp_debug.h>
 #include <iotc_bsp_tls.h>
+#include <iotc_critical_section.h>
+#include <iotc_critical_section_def.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -29,6 +31,12 @@
 #include <mbedtls/platform.h>
 #include <mbedtls/ssl.h>
 
+/* the contexts of all the I/O threads draw from the shared DRBG, which only
+ * mbedTLS itself can lock */
+#if defined(IOTC_MODULE_THREAD_ENABLED) && !defined(MBEDTLS_THREADING_C)
+#error "threading builds need mbedTLS built with MBEDTLS_THREADING_C"
+#endif
+
 /**
  * @brief If the libiotc's certificate buffer's last character is '\n' (common
  * after file reading, and replicated in iotc_RootCA_list for consistency),
@@ -44,19 +52,147 @@ static void mbedtls_prepare_certificate_buffer(uint8_t* cert_buffer,
 }
 
 /**
- * @typedef mbedtls_tls_context_t
- * @brief holds data important for mbedtls related bsp functions
+ * @typedef mbedtls_tls_shared_config_t
+ * @brief holds the configuration all TLS contexts are set up from
+ *
+ * Built by the first iotc_bsp_tls_init() and kept until
+ * iotc_bsp_tls_shutdown(), reconnects neither parse the CA certificates nor
+ * seed the DRBG again.
  **/
-typedef struct mbedtls_tls_context_s {
-  mbedtls_ssl_context ssl;
+typedef struct mbedtls_tls_shared_config_s {
   mbedtls_ssl_config conf;
 
   mbedtls_entropy_context entropy;
   mbedtls_ctr_drbg_context ctr_drbg;
 
   mbedtls_x509_crt cacert;
+
+  /* identify the PEM buffer the chain was parsed from */
+  size_t ca_cert_pem_buf_length;
+  uint32_t ca_cert_pem_buf_hash;
+
+  /* number of TLS contexts set up from the configuration */
+  uint32_t users;
+  uint8_t initialized;
+  /* iotc_bsp_tls_shutdown() came while contexts were still in use */
+  uint8_t release_pending;
+} mbedtls_tls_shared_config_t;
+
+static mbedtls_tls_shared_config_t mbedtls_tls_shared_config;
+
+/* guards mbedtls_tls_shared_config, the I/O threads of iotc_set_io_threads()
+ * set up and clean up their TLS contexts at the same time */
+static struct iotc_critical_section_s mbedtls_tls_shared_config_cs = {0};
+
+/**
+ * @typedef mbedtls_tls_context_t
+ * @brief holds data important for mbedtls related bsp functions
+ **/
+typedef struct mbedtls_tls_context_s {
+  mbedtls_ssl_context ssl;
+
+  /* the master secret of the offered session, an abbreviated handshake keeps
+   * it while a full one negotiates a new one */
+  unsigned char offered_master[sizeof(((mbedtls_ssl_session*)0)->master)];
+  uint8_t session_offered;
+  uint8_t session_resumed;
 } mbedtls_tls_context_t;
 
+/* FNV-1a, tells whether the CA certificates changed since they were parsed */
+static uint32_t mbedtls_hash_certificate_buffer(const uint8_t* cert_buffer,
+                                                size_t cert_buffer_len) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+
+  for (; i < cert_buffer_len; ++i) {
+    hash = (hash ^ cert_buffer[i]) * 16777619u;
+  }
+
+  return hash;
+}
+
+static void mbedtls_shared_config_free() {
+  mbedtls_tls_shared_config_t* const shared = &mbedtls_tls_shared_config;
+
+  if (shared->initialized) {
+    mbedtls_x509_crt_free(&shared->cacert);
+    mbedtls_ssl_config_free(&shared->conf);
+    mbedtls_ctr_drbg_free(&shared->ctr_drbg);
+    mbedtls_entropy_free(&shared->entropy);
+  }
+
+  memset(shared, 0, sizeof(mbedtls_tls_shared_config_t));
+}
+
+static iotc_bsp_tls_state_t mbedtls_shared_config_setup(
+    iotc_bsp_tls_init_params_t* init_params, uint32_t ca_cert_pem_buf_hash) {
+  mbedtls_tls_shared_config_t* const shared = &mbedtls_tls_shared_config;
+
+  /* return state used for checking each mbedtls function */
+  int ret_state = 0;
+
+  /* RNG related string */
+  const char personalization[] = "iotc_bsp_mbedtls_more_entropy_pls";
+
+  mbedtls_ssl_config_init(&shared->conf);
+
+  /* initialise RNG */
+  mbedtls_entropy_init(&shared->entropy);
+  mbedtls_ctr_drbg_init(&shared->ctr_drbg);
+
+  /* init the CA certificates */
+  mbedtls_x509_crt_init(&shared->cacert);
+
+  shared->initialized = 1;
+
+  if ((ret_state = mbedtls_ctr_drbg_seed(
+           &shared->ctr_drbg, mbedtls_entropy_func, &shared->entropy,
+           (const unsigned char*)personalization, sizeof(personalization))) !=
+      0) {
+    iotc_bsp_debug_format(" failed ! mbedtls_ctr_drbg_seed returned %d",
+                          ret_state);
+    goto err_handling;
+  }
+
+  if ((ret_state = mbedtls_ssl_config_defaults(
+           &shared->conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+           MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
+    iotc_bsp_debug_format(" failed ! mbedtls_ssl_config_defaults returned %d",
+                          ret_state);
+    goto err_handling;
+  }
+
+#ifdef IOTC_DISABLE_CERTVERIFY
+  mbedtls_ssl_conf_authmode(&shared->conf, MBEDTLS_SSL_VERIFY_NONE);
+#else
+  mbedtls_ssl_conf_authmode(&shared->conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+#endif
+
+  ret_state = mbedtls_x509_crt_parse(&shared->cacert,
+                                     init_params->ca_cert_pem_buf,
+                                     init_params->ca_cert_pem_buf_length);
+
+  if (ret_state < 0) {
+    iotc_bsp_debug_format("failed ! mbedtls_x509_crt_parse returned %d",
+                          ret_state);
+    goto err_handling;
+  }
+
+  /* set the ca certificate chain */
+  mbedtls_ssl_conf_ca_chain(&shared->conf, &shared->cacert, NULL);
+  mbedtls_ssl_conf_rng(&shared->conf, mbedtls_ctr_drbg_random,
+                       &shared->ctr_drbg);
+
+  shared->ca_cert_pem_buf_length = init_params->ca_cert_pem_buf_length;
+  shared->ca_cert_pem_buf_hash = ca_cert_pem_buf_hash;
+
+  return IOTC_BSP_TLS_STATE_OK;
+
+err_handling:
+  mbedtls_shared_config_free();
+  return IOTC_BSP_TLS_STATE_INIT_ERROR;
+}
+
 int iotc_mbedtls_recv(void* libiotc_io_callback_context, unsigned char* buf,
                       size_t len) {
   assert(NULL != libiotc_io_callback_context);
@@ -130,85 +266,83 @@ iotc_bsp_tls_state_t iotc_bsp_tls_init(
     return IOTC_BSP_TLS_STATE_INIT_ERROR;
   }
 
+  mbedtls_tls_shared_config_t* const shared = &mbedtls_tls_shared_config;
+
   /* return state used for checking each mbedtls function */
   int ret_state = 0;
 
-  /* RNG related string */
-  const char personalization[] = "iotc_bsp_mbedtls_more_entropy_pls";
-
 #ifdef MBEDTLS_PLATFORM_MEMORY
   mbedtls_platform_set_calloc_free(init_params->fp_libiotc_calloc,
                                    init_params->fp_libiotc_free);
 #endif
 
+  /* this is required via the mbedtls in order to parse the PEM certificate
+   * correctly - mbedtls requires '\0' at the end of the buffer that contains
+   * PEM certificate */
+  mbedtls_prepare_certificate_buffer(init_params->ca_cert_pem_buf,
+                                     init_params->ca_cert_pem_buf_length);
+
+  const uint32_t ca_cert_pem_buf_hash = mbedtls_hash_certificate_buffer(
+      init_params->ca_cert_pem_buf, init_params->ca_cert_pem_buf_length);
+
   mbedtls_tls_context_t* mbedtls_tls_context =
       (mbedtls_tls_context_t*)mbedtls_calloc(sizeof(mbedtls_tls_context_t), 1);
 
-  /* save tls context, this value will be passed back in other BSP TLS functions
-   */
-  *tls_context = mbedtls_tls_context;
+  if (NULL == mbedtls_tls_context) {
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
 
-  /* initialise the mbedtls context */
-  mbedtls_ssl_init(&mbedtls_tls_context->ssl);
-  mbedtls_ssl_config_init(&mbedtls_tls_context->conf);
+  /* just to satisfy the compiler */
+  (void)mbedtls_tls_shared_config_cs;
 
-  /* initialise RNG */
-  mbedtls_entropy_init(&mbedtls_tls_context->entropy);
-  mbedtls_ctr_drbg_init(&mbedtls_tls_context->ctr_drbg);
+  iotc_lock_critical_section(&mbedtls_tls_shared_config_cs);
 
-  if ((ret_state = mbedtls_ctr_drbg_seed(
-           &mbedtls_tls_context->ctr_drbg, mbedtls_entropy_func,
-           &mbedtls_tls_context->entropy, (const unsigned char*)personalization,
-           sizeof(personalization))) != 0) {
-    iotc_bsp_debug_format(" failed ! mbedtls_ctr_drbg_seed returned %d",
-                          ret_state);
-    goto err_handling;
-  }
+  if (shared->initialized &&
+      (shared->ca_cert_pem_buf_length != init_params->ca_cert_pem_buf_length ||
+       shared->ca_cert_pem_buf_hash != ca_cert_pem_buf_hash)) {
+    /* the chain in use can't be swapped under the connections using it */
+    if (0 != shared->users) {
+      iotc_unlock_critical_section(&mbedtls_tls_shared_config_cs);
+      mbedtls_free(mbedtls_tls_context);
 
-  /* register I/O functions */
-  mbedtls_ssl_set_bio(&mbedtls_tls_context->ssl,
-                      init_params->libiotc_io_callback_context,
-                      iotc_mbedtls_send, iotc_mbedtls_recv, NULL);
+      iotc_bsp_debug_logger(
+          "failed ! the CA certificates changed while connections use them");
+      return IOTC_BSP_TLS_STATE_INIT_ERROR;
+    }
 
-  ret_state = mbedtls_ssl_config_defaults(
-      &mbedtls_tls_context->conf, MBEDTLS_SSL_IS_CLIENT,
-      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    mbedtls_shared_config_free();
+  }
 
-#ifdef IOTC_DISABLE_CERTVERIFY
-  mbedtls_ssl_conf_authmode(&mbedtls_tls_context->conf,
-                            MBEDTLS_SSL_VERIFY_NONE);
-#else
-  mbedtls_ssl_conf_authmode(&mbedtls_tls_context->conf,
-                            MBEDTLS_SSL_VERIFY_REQUIRED);
-#endif
+  if (!shared->initialized) {
+    const iotc_bsp_tls_state_t state =
+        mbedtls_shared_config_setup(init_params, ca_cert_pem_buf_hash);
 
-  /* init & parse the CA certificates */
-  mbedtls_x509_crt_init(&mbedtls_tls_context->cacert);
+    if (IOTC_BSP_TLS_STATE_OK != state) {
+      iotc_unlock_critical_section(&mbedtls_tls_shared_config_cs);
+      mbedtls_free(mbedtls_tls_context);
+      return state;
+    }
+  }
 
-  /* this is required via the mbedtls in order to parse the PEM certificate
-   * correctly - mbedtls requires '\0' at the end of the buffer that contains
-   * PEM certificate */
-  mbedtls_prepare_certificate_buffer(init_params->ca_cert_pem_buf,
-                                     init_params->ca_cert_pem_buf_length);
+  /* the configuration stays while the context uses it */
+  ++shared->users;
 
-  ret_state = mbedtls_x509_crt_parse(&mbedtls_tls_context->cacert,
-                                     init_params->ca_cert_pem_buf,
-                                     init_params->ca_cert_pem_buf_length);
+  iotc_unlock_critical_section(&mbedtls_tls_shared_config_cs);
 
-  if (ret_state < 0) {
-    iotc_bsp_debug_format("failed ! mbedtls_x509_crt_parse returned %d",
-                          ret_state);
-    goto err_handling;
-  }
+  /* save tls context, this value will be passed back in other BSP TLS functions
+   */
+  *tls_context = mbedtls_tls_context;
 
-  /* set the ca certificate chain */
-  mbedtls_ssl_conf_ca_chain(&mbedtls_tls_context->conf,
-                            &mbedtls_tls_context->cacert, NULL);
-  mbedtls_ssl_conf_rng(&mbedtls_tls_context->conf, mbedtls_ctr_drbg_random,
-                       &mbedtls_tls_context->ctr_drbg);
+  /* initialise the mbedtls context */
+  mbedtls_ssl_init(&mbedtls_tls_context->ssl);
+
+  /* register I/O functions */
+  mbedtls_ssl_set_bio(&mbedtls_tls_context->ssl,
+                      init_params->libiotc_io_callback_context,
+                      iotc_mbedtls_send, iotc_mbedtls_recv, NULL);
 
   if ((ret_state = mbedtls_ssl_setup(&mbedtls_tls_context->ssl,
-                                     &mbedtls_tls_context->conf)) != 0) {
+                                     &shared->conf)) != 0) {
     iotc_bsp_debug_format(" failed  ! mbedtls_ssl_setup returned %d",
                           ret_state);
     goto err_handling;
@@ -258,12 +392,108 @@ iotc_bsp_tls_state_t iotc_bsp_tls_connect(iotc_bsp_tls_context_t* tls_context) {
       return IOTC_BSP_TLS_STATE_CONNECT_ERROR;
   }
 
-  /* after succesfull connection unload the certificate */
-  mbedtls_x509_crt_free(&mbedtls_tls_context->cacert);
+  mbedtls_tls_context->session_resumed =
+      mbedtls_tls_context->session_offered &&
+      0 == memcmp(mbedtls_tls_context->offered_master,
+                  mbedtls_tls_context->ssl.session->master,
+                  sizeof(mbedtls_tls_context->offered_master));
 
+  /* the certificates stay parsed in the shared configuration for the next
+   * connection */
   return IOTC_BSP_TLS_STATE_OK;
 }
 
+iotc_bsp_tls_state_t iotc_bsp_tls_save_session(
+    iotc_bsp_tls_context_t* tls_context, iotc_bsp_tls_session_t** session) {
+  assert(NULL != tls_context);
+  assert(NULL != session);
+
+  iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
+
+  mbedtls_tls_context_t* mbedtls_tls_context = tls_context;
+
+  *session = NULL;
+
+  mbedtls_ssl_session* saved_session =
+      (mbedtls_ssl_session*)mbedtls_calloc(sizeof(mbedtls_ssl_session), 1);
+
+  if (NULL == saved_session) {
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  mbedtls_ssl_session_init(saved_session);
+
+  const int ret_state =
+      mbedtls_ssl_get_session(&mbedtls_tls_context->ssl, saved_session);
+
+  if (0 != ret_state) {
+    iotc_bsp_debug_format("failed ! mbedtls_ssl_get_session returned %d",
+                          ret_state);
+    iotc_bsp_tls_free_session((iotc_bsp_tls_session_t**)&saved_session);
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  /* a server may issue neither a ticket nor a session ID */
+  int resumable = 0 != saved_session->id_len;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  resumable = resumable || NULL != saved_session->ticket;
+#endif
+
+  if (!resumable) {
+    iotc_bsp_tls_free_session((iotc_bsp_tls_session_t**)&saved_session);
+    return IOTC_BSP_TLS_STATE_OK;
+  }
+
+  *session = saved_session;
+
+  return IOTC_BSP_TLS_STATE_OK;
+}
+
+iotc_bsp_tls_state_t iotc_bsp_tls_restore_session(
+    iotc_bsp_tls_context_t* tls_context,
+    const iotc_bsp_tls_session_t* session) {
+  assert(NULL != tls_context);
+  assert(NULL != session);
+
+  iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
+
+  mbedtls_tls_context_t* mbedtls_tls_context = tls_context;
+  const mbedtls_ssl_session* offered_session = session;
+
+  const int ret_state =
+      mbedtls_ssl_set_session(&mbedtls_tls_context->ssl, offered_session);
+
+  if (0 != ret_state) {
+    iotc_bsp_debug_format("failed ! mbedtls_ssl_set_session returned %d",
+                          ret_state);
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  memcpy(mbedtls_tls_context->offered_master, offered_session->master,
+         sizeof(mbedtls_tls_context->offered_master));
+  mbedtls_tls_context->session_offered = 1;
+
+  return IOTC_BSP_TLS_STATE_OK;
+}
+
+int iotc_bsp_tls_session_resumed(iotc_bsp_tls_context_t* tls_context) {
+  assert(NULL != tls_context);
+
+  mbedtls_tls_context_t* mbedtls_tls_context = tls_context;
+
+  return mbedtls_tls_context->session_resumed;
+}
+
+void iotc_bsp_tls_free_session(iotc_bsp_tls_session_t** session) {
+  assert(NULL != session);
+
+  if (NULL != *session) {
+    mbedtls_ssl_session_free((mbedtls_ssl_session*)*session);
+    mbedtls_free(*session);
+    *session = NULL;
+  }
+}
+
 iotc_bsp_tls_state_t iotc_bsp_tls_read(iotc_bsp_tls_context_t* tls_context,
                                        uint8_t* data_ptr, size_t data_size,
                                        int* bytes_read) {
@@ -337,16 +567,39 @@ iotc_bsp_tls_state_t iotc_bsp_tls_cleanup(
   mbedtls_tls_context_t* mbedtls_tls_context = *tls_context;
 
   if (NULL != mbedtls_tls_context) {
-    mbedtls_x509_crt_free(&mbedtls_tls_context->cacert);
-    mbedtls_ssl_config_free(&mbedtls_tls_context->conf);
+    mbedtls_tls_shared_config_t* const shared = &mbedtls_tls_shared_config;
+
     mbedtls_ssl_free(&mbedtls_tls_context->ssl);
-    mbedtls_ctr_drbg_free(&mbedtls_tls_context->ctr_drbg);
-    mbedtls_entropy_free(&mbedtls_tls_context->entropy);
 
     mbedtls_free(*tls_context);
 
     *tls_context = NULL;
+
+    iotc_lock_critical_section(&mbedtls_tls_shared_config_cs);
+
+    assert(0 < shared->users);
+    --shared->users;
+
+    if (shared->release_pending && 0 == shared->users) {
+      mbedtls_shared_config_free();
+    }
+
+    iotc_unlock_critical_section(&mbedtls_tls_shared_config_cs);
   }
 
   return IOTC_BSP_TLS_STATE_OK;
 }
+
+void iotc_bsp_tls_shutdown() {
+  iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
+
+  iotc_lock_critical_section(&mbedtls_tls_shared_config_cs);
+
+  if (0 == mbedtls_tls_shared_config.users) {
+    mbedtls_shared_config_free();
+  } else {
+    mbedtls_tls_shared_config.release_pending = 1;
+  }
+
+  iotc_unlock_critical_section(&mbedtls_tls_shared_config_cs);
+}
@@ -19,17 +19,66 @@
 #include <cyassl/ssl.h>
 #include <iotc_bsp_debug.h>
 #include <iotc_bsp_tls.h>
+#include <iotc_critical_section.h>
+#include <iotc_critical_section_def.h>
 #include <wolfssl/error-ssl.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #define WOLFSSL_DEBUG_LOG 0
 
-typedef struct wolfssl_tls_context_s {
+/* the CyaSSL context all TLS objects are created from, it holds the CA
+ * certificates and lives from the first iotc_bsp_tls_init() until
+ * iotc_bsp_tls_shutdown() so reconnects don't load them again */
+typedef struct wolfssl_tls_shared_config_s {
   CYASSL_CTX* ctx;
+
+  /* identify the PEM buffer the certificates were loaded from */
+  size_t ca_cert_pem_buf_length;
+  uint32_t ca_cert_pem_buf_hash;
+
+  /* number of TLS objects created from the context */
+  uint32_t users;
+  /* iotc_bsp_tls_shutdown() came while objects were still in use */
+  uint8_t release_pending;
+} wolfssl_tls_shared_config_t;
+
+static wolfssl_tls_shared_config_t wolfssl_tls_shared_config;
+
+/* guards wolfssl_tls_shared_config, the I/O threads of iotc_set_io_threads()
+ * set up and clean up their TLS objects at the same time */
+static struct iotc_critical_section_s wolfssl_tls_shared_config_cs = {0};
+
+typedef struct wolfssl_tls_context_s {
   CYASSL* obj;
 } wolfssl_tls_context_t;
 
+/* FNV-1a, tells whether the CA certificates changed since they were loaded */
+static uint32_t wolfssl_hash_certificate_buffer(const uint8_t* cert_buffer,
+                                                size_t cert_buffer_len) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+
+  for (; i < cert_buffer_len; ++i) {
+    hash = (hash ^ cert_buffer[i]) * 16777619u;
+  }
+
+  return hash;
+}
+
+static void wolfssl_shared_config_free() {
+  wolfssl_tls_shared_config_t* const shared = &wolfssl_tls_shared_config;
+
+  if (NULL != shared->ctx) {
+    CyaSSL_CTX_UnloadCAs(shared->ctx);
+    CyaSSL_CTX_free(shared->ctx);
+    CyaSSL_Cleanup();
+  }
+
+  memset(shared, 0, sizeof(wolfssl_tls_shared_config_t));
+}
+
 int iotc_wolfssl_recv(CYASSL* ssl, char* buf, int sz, void* context) {
   iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
 
@@ -74,6 +123,68 @@ int iotc_wolfssl_send(CYASSL* ssl, char* buf, int sz, void* context) {
   }
 }
 
+static iotc_bsp_tls_state_t wolfssl_shared_config_setup(
+    iotc_bsp_tls_init_params_t* init_params, uint32_t ca_cert_pem_buf_hash) {
+  wolfssl_tls_shared_config_t* const shared = &wolfssl_tls_shared_config;
+
+  int ret = CyaSSL_Init();
+
+  if (ret != SSL_SUCCESS) {
+    iotc_bsp_debug_logger("failed to initialize CyaSSL library");
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  ret = CyaSSL_SetAllocators(init_params->fp_libiotc_alloc,
+                             init_params->fp_libiotc_free,
+                             init_params->fp_libiotc_realloc);
+
+  if (0 != ret) {
+    iotc_bsp_debug_logger("failed to initialize CyaSSL library");
+    CyaSSL_Cleanup();
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  iotc_bsp_debug_logger("initialized CyaSSL library");
+
+  shared->ctx = CyaSSL_CTX_new(CyaSSLv23_client_method());
+
+  if (NULL == shared->ctx) {
+    iotc_bsp_debug_logger("failed to create CyaSSL context");
+    CyaSSL_Cleanup();
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  iotc_bsp_debug_logger("CyaSSL context created");
+
+  CyaSSL_SetIORecv(shared->ctx, iotc_wolfssl_recv);
+  CyaSSL_SetIOSend(shared->ctx, iotc_wolfssl_send);
+
+#ifdef IOTC_DISABLE_CERTVERIFY
+  /* disable verify cause no proper certificate */
+  CyaSSL_CTX_set_verify(shared->ctx, SSL_VERIFY_NONE, 0);
+#endif
+
+  /* POST/PRE-CONDITIONS */
+  assert(NULL != init_params->ca_cert_pem_buf);
+  assert(0 < init_params->ca_cert_pem_buf_length);
+
+  /* loading the certificate */
+  ret = CyaSSL_CTX_load_verify_buffer(
+      shared->ctx, init_params->ca_cert_pem_buf,
+      init_params->ca_cert_pem_buf_length, SSL_FILETYPE_PEM);
+
+  if (SSL_SUCCESS != ret) {
+    iotc_bsp_debug_format("failed to load CA certificate, reason: %d", ret);
+    wolfssl_shared_config_free();
+    return IOTC_BSP_TLS_STATE_CERT_ERROR;
+  }
+
+  shared->ca_cert_pem_buf_length = init_params->ca_cert_pem_buf_length;
+  shared->ca_cert_pem_buf_hash = ca_cert_pem_buf_hash;
+
+  return IOTC_BSP_TLS_STATE_OK;
+}
+
 iotc_bsp_tls_state_t iotc_bsp_tls_init(
     iotc_bsp_tls_context_t** tls_context,
     iotc_bsp_tls_init_params_t* init_params) {
@@ -82,6 +193,10 @@ iotc_bsp_tls_state_t iotc_bsp_tls_init(
   int ret = 0;
   iotc_bsp_tls_state_t result = IOTC_BSP_TLS_STATE_OK;
   wolfssl_tls_context_t* wolfssl_tls_context = NULL;
+  wolfssl_tls_shared_config_t* const shared = &wolfssl_tls_shared_config;
+
+  /* only used by the OCSP options */
+  (void)ret;
 
 #if WOLFSSL_DEBUG_LOG
   wolfSSL_Debugging_ON();
@@ -91,52 +206,58 @@ iotc_bsp_tls_state_t iotc_bsp_tls_init(
   const int nonce_options = 0;
 #endif
 
-  ret = CyaSSL_Init();
+  const uint32_t ca_cert_pem_buf_hash = wolfssl_hash_certificate_buffer(
+      init_params->ca_cert_pem_buf, init_params->ca_cert_pem_buf_length);
 
-  if (ret != SSL_SUCCESS) {
-    iotc_bsp_debug_logger("failed to initialize CyaSSL library");
-    result = IOTC_BSP_TLS_STATE_INIT_ERROR;
-    goto err_handling;
+  wolfssl_tls_context =
+      (wolfssl_tls_context_t*)wolfSSL_Malloc(sizeof(wolfssl_tls_context_t));
+
+  if (NULL == wolfssl_tls_context) {
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
   }
 
-  ret = CyaSSL_SetAllocators(init_params->fp_libiotc_alloc,
-                             init_params->fp_libiotc_free,
-                             init_params->fp_libiotc_realloc);
+  /* just to satisfy the compiler */
+  (void)wolfssl_tls_shared_config_cs;
 
-  if (0 != ret) {
-    iotc_bsp_debug_logger("failed to initialize CyaSSL library");
-    result = IOTC_BSP_TLS_STATE_INIT_ERROR;
-    goto err_handling;
-  }
+  iotc_lock_critical_section(&wolfssl_tls_shared_config_cs);
 
-  iotc_bsp_debug_logger("initialized CyaSSL library");
+  if (NULL != shared->ctx &&
+      (shared->ca_cert_pem_buf_length != init_params->ca_cert_pem_buf_length ||
+       shared->ca_cert_pem_buf_hash != ca_cert_pem_buf_hash)) {
+    /* the certificates in use can't be swapped under the objects using them */
+    if (0 != shared->users) {
+      iotc_unlock_critical_section(&wolfssl_tls_shared_config_cs);
+      wolfSSL_Free(wolfssl_tls_context);
 
-  wolfssl_tls_context =
-      (wolfssl_tls_context_t*)wolfSSL_Malloc(sizeof(wolfssl_tls_context_t));
+      iotc_bsp_debug_logger(
+          "the CA certificates changed while connections use them");
+      return IOTC_BSP_TLS_STATE_INIT_ERROR;
+    }
 
-  /* save tls context, this value will be passed back in other BSP TLS functions
-   */
-  *tls_context = wolfssl_tls_context;
+    wolfssl_shared_config_free();
+  }
 
-  wolfssl_tls_context->ctx = CyaSSL_CTX_new(CyaSSLv23_client_method());
+  if (NULL == shared->ctx) {
+    result = wolfssl_shared_config_setup(init_params, ca_cert_pem_buf_hash);
 
-  if (NULL == wolfssl_tls_context->ctx) {
-    iotc_bsp_debug_logger("failed to create CyaSSL context");
-    result = IOTC_BSP_TLS_STATE_INIT_ERROR;
-    goto err_handling;
+    if (IOTC_BSP_TLS_STATE_OK != result) {
+      iotc_unlock_critical_section(&wolfssl_tls_shared_config_cs);
+      wolfSSL_Free(wolfssl_tls_context);
+      return result;
+    }
   }
 
-  iotc_bsp_debug_logger("CyaSSL context created");
+  /* the context stays while the object uses it */
+  ++shared->users;
+  CYASSL_CTX* const ctx = shared->ctx;
 
-  CyaSSL_SetIORecv(wolfssl_tls_context->ctx, iotc_wolfssl_recv);
-  CyaSSL_SetIOSend(wolfssl_tls_context->ctx, iotc_wolfssl_send);
+  iotc_unlock_critical_section(&wolfssl_tls_shared_config_cs);
 
-#ifdef IOTC_DISABLE_CERTVERIFY
-  /* disable verify cause no proper certificate */
-  CyaSSL_CTX_set_verify(wolfssl_tls_context->ctx, SSL_VERIFY_NONE, 0);
-#endif
+  /* save tls context, this value will be passed back in other BSP TLS functions
+   */
+  *tls_context = wolfssl_tls_context;
 
-  wolfssl_tls_context->obj = CyaSSL_new(wolfssl_tls_context->ctx);
+  wolfssl_tls_context->obj = CyaSSL_new(ctx);
 
   if (NULL == wolfssl_tls_context->obj) {
     iotc_bsp_debug_logger("failed to create CYASSL object");
@@ -155,6 +276,16 @@ iotc_bsp_tls_state_t iotc_bsp_tls_init(
     goto err_handling;
   }
 
+#ifdef HAVE_SESSION_TICKET
+  /* ask for an RFC 5077 ticket, servers without session tickets fall back to
+   * session IDs */
+  if (SSL_SUCCESS != CyaSSL_UseSessionTicket(wolfssl_tls_context->obj)) {
+    iotc_bsp_debug_logger("failed to enable session tickets");
+    result = IOTC_BSP_TLS_STATE_INIT_ERROR;
+    goto err_handling;
+  }
+#endif
+
   /* enable SNI */
   /* Note: we are doing this on the object to future proof ourselves.
      in theory this could be set on the context, and any created objects
@@ -212,21 +343,6 @@ iotc_bsp_tls_state_t iotc_bsp_tls_init(
   CyaSSL_SetIOWriteCtx(wolfssl_tls_context->obj,
                        init_params->libiotc_io_callback_context);
 
-  /* POST/PRE-CONDITIONS */
-  assert(NULL != init_params->ca_cert_pem_buf);
-  assert(0 < init_params->ca_cert_pem_buf_length);
-
-  /* loading the certificate */
-  ret = CyaSSL_CTX_load_verify_buffer(
-      wolfssl_tls_context->ctx, init_params->ca_cert_pem_buf,
-      init_params->ca_cert_pem_buf_length, SSL_FILETYPE_PEM);
-
-  if (SSL_SUCCESS != ret) {
-    iotc_bsp_debug_format("failed to load CA certificate, reason: %d", ret);
-    result = IOTC_BSP_TLS_STATE_CERT_ERROR;
-    goto err_handling;
-  }
-
 err_handling:
 
   return result;
@@ -269,6 +385,57 @@ iotc_bsp_tls_state_t iotc_bsp_tls_connect(iotc_bsp_tls_context_t* tls_context) {
   return IOTC_BSP_TLS_STATE_CONNECT_ERROR;
 }
 
+/* the sessions live in the session cache of the library, which the shared
+ * context keeps until iotc_bsp_tls_shutdown(), a session the cache dropped in
+ * the meantime is not accepted and the handshake is a full one */
+iotc_bsp_tls_state_t iotc_bsp_tls_save_session(
+    iotc_bsp_tls_context_t* tls_context, iotc_bsp_tls_session_t** session) {
+  assert(NULL != tls_context);
+  assert(NULL != session);
+
+  iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
+
+  wolfssl_tls_context_t* wolfssl_tls_context = tls_context;
+
+  *session = CyaSSL_get_session(wolfssl_tls_context->obj);
+
+  return IOTC_BSP_TLS_STATE_OK;
+}
+
+iotc_bsp_tls_state_t iotc_bsp_tls_restore_session(
+    iotc_bsp_tls_context_t* tls_context,
+    const iotc_bsp_tls_session_t* session) {
+  assert(NULL != tls_context);
+  assert(NULL != session);
+
+  iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
+
+  wolfssl_tls_context_t* wolfssl_tls_context = tls_context;
+
+  if (SSL_SUCCESS != CyaSSL_set_session(wolfssl_tls_context->obj,
+                                        (CYASSL_SESSION*)session)) {
+    iotc_bsp_debug_logger("failed to set the session to resume");
+    return IOTC_BSP_TLS_STATE_INIT_ERROR;
+  }
+
+  return IOTC_BSP_TLS_STATE_OK;
+}
+
+int iotc_bsp_tls_session_resumed(iotc_bsp_tls_context_t* tls_context) {
+  assert(NULL != tls_context);
+
+  wolfssl_tls_context_t* wolfssl_tls_context = tls_context;
+
+  return CyaSSL_session_reused(wolfssl_tls_context->obj);
+}
+
+void iotc_bsp_tls_free_session(iotc_bsp_tls_session_t** session) {
+  assert(NULL != session);
+
+  /* owned by the session cache */
+  *session = NULL;
+}
+
 iotc_bsp_tls_state_t iotc_bsp_tls_read(iotc_bsp_tls_context_t* tls_context,
                                        uint8_t* data_ptr, size_t data_size,
                                        int* ret_bytes_read) {
@@ -375,19 +542,43 @@ iotc_bsp_tls_state_t iotc_bsp_tls_cleanup(
   }
 
   wolfssl_tls_context_t* wolfssl_tls_context = *tls_context;
+  wolfssl_tls_shared_config_t* const shared = &wolfssl_tls_shared_config;
 
-  // here unload the possibly remaining cert binary
-  CyaSSL_CTX_UnloadCAs(wolfssl_tls_context->ctx);
-  CyaSSL_free(wolfssl_tls_context->obj);
-  CyaSSL_CTX_free(wolfssl_tls_context->ctx);
-  CyaSSL_Cleanup();
+  if (NULL != wolfssl_tls_context->obj) {
+    CyaSSL_free(wolfssl_tls_context->obj);
+  }
 
   wolfSSL_Free(*tls_context);
   *tls_context = NULL;
 
+  iotc_lock_critical_section(&wolfssl_tls_shared_config_cs);
+
+  assert(0 < shared->users);
+  --shared->users;
+
+  if (shared->release_pending && 0 == shared->users) {
+    wolfssl_shared_config_free();
+  }
+
+  iotc_unlock_critical_section(&wolfssl_tls_shared_config_cs);
+
   return IOTC_BSP_TLS_STATE_OK;
 }
 
+void iotc_bsp_tls_shutdown() {
+  iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
+
+  iotc_lock_critical_section(&wolfssl_tls_shared_config_cs);
+
+  if (0 == wolfssl_tls_shared_config.users) {
+    wolfssl_shared_config_free();
+  } else {
+    wolfssl_tls_shared_config.release_pending = 1;
+  }
+
+  iotc_unlock_critical_section(&wolfssl_tls_shared_config_cs);
+}
+
 int iotc_bsp_tls_pending(iotc_bsp_tls_context_t* tls_context) {
   iotc_bsp_debug_format("[ %s ]", __FUNCTION__);
 
@@ -18,12 +18,14 @@
 #include "iotc_event_handle.h"
 #include "iotc_event_thread_dispatcher.h"
 #include "iotc_globals.h"
+#include "iotc_jwt_rotation.h"
 #include "iotc_layer_api.h"
 #include "iotc_layer_macros.h"
 #include "iotc_list.h"
 #include "iotc_macros.h"
 #include "iotc_mqtt_logic_layer_data.h"
 #include "iotc_mqtt_message.h"
+#include "iotc_offline_queue.h"
 #include "iotc_types_internal.h"
 
 #ifdef __cplusplus
@@ -34,17 +36,26 @@ iotc_state_t iotc_control_topic_connection_state_changed(void* context,
                                                          iotc_state_t state) {
   iotc_debug_printf("%s\n", __FUNCTION__);
 
-  IOTC_CONTEXT_DATA(context)->connection_callback.handlers.h3.a2 =
-      IOTC_CONTEXT_DATA(context)->connection_data;
+  const uint8_t opened =
+      state == IOTC_STATE_OK &&
+      IOTC_CONTEXT_DATA(context)->connection_data->connection_state ==
+          IOTC_CONNECTION_STATE_OPENED;
 
-  IOTC_CONTEXT_DATA(context)->connection_callback.handlers.h3.a3 = state;
+  /* the application doesn't see a JWT rotation swapping the connection */
+  if (!opened || 0 == IOTC_CONTEXT_DATA(context)->jwt_rotation.in_progress) {
+    IOTC_CONTEXT_DATA(context)->connection_callback.handlers.h3.a2 =
+        IOTC_CONTEXT_DATA(context)->connection_data;
 
-  iotc_evttd_execute(IOTC_CONTEXT_DATA(context)->evtd_instance,
-                     IOTC_CONTEXT_DATA(context)->connection_callback);
+    IOTC_CONTEXT_DATA(context)->connection_callback.handlers.h3.a3 = state;
 
-  if (state == IOTC_STATE_OK &&
-      IOTC_CONTEXT_DATA(context)->connection_data->connection_state ==
-          IOTC_CONNECTION_STATE_OPENED) {
+    iotc_evttd_execute_ordered(IOTC_CONTEXT_DATA(context)->evtd_instance,
+                               IOTC_CONTEXT_DATA(context)->connection_callback,
+                               IOTC_CONTEXT_DATA(context));
+  }
+
+  if (opened) {
+    iotc_jwt_rotation_connected(context);
+    iotc_offline_queue_connected(context);
     IOTC_PROCESS_POST_CONNECT_ON_THIS_LAYER(context, NULL, state);
   }
 
@@ -111,15 +122,32 @@ iotc_state_t iotc_control_topic_layer_close_externally(
 
   IOTC_UNUSED(data);
 
-  if (IOTC_CONTEXT_DATA(context)->connection_data->connection_state ==
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+
+  if (context_data->connection_data->connection_state ==
       IOTC_CONNECTION_STATE_OPENING) {
-    IOTC_CONTEXT_DATA(context)->connection_data->connection_state =
+    context_data->connection_data->connection_state =
         IOTC_CONNECTION_STATE_OPEN_FAILED;
   } else {
-    IOTC_CONTEXT_DATA(context)->connection_data->connection_state =
+    context_data->connection_data->connection_state =
         IOTC_CONNECTION_STATE_CLOSED;
   }
 
+  iotc_jwt_rotation_closed(context);
+
+  /* the connection a JWT rotation closed comes back with a fresh token, if
+   * the new one fails or the application shuts down the user is told */
+  if (context_data->jwt_rotation.in_progress) {
+    if (IOTC_CONNECTION_STATE_CLOSED ==
+            context_data->connection_data->connection_state &&
+        IOTC_SHUTDOWN_UNINITIALISED == context_data->shutdown_state &&
+        IOTC_STATE_OK == iotc_jwt_rotation_reconnect(context)) {
+      return IOTC_STATE_OK;
+    }
+
+    context_data->jwt_rotation.in_progress = 0;
+  }
+
   /* call the connection callback to notify the user */
   return iotc_control_topic_connection_state_changed(context, in_out_state);
 }
@@ -42,6 +42,35 @@
     }                                          \
   }
 
+/* variants of push and pop for lists which keep a pointer to their last
+ * element, pushing to the back doesn't walk the list */
+#define IOTC_LIST_PUSH_BACK_WITH_TAIL(type, list, tail, elem) \
+  {                                                           \
+    elem->__next = NULL;                                      \
+    if (NULL == list) {                                       \
+      list = elem;                                            \
+    } else {                                                  \
+      tail->__next = elem;                                    \
+    }                                                         \
+    tail = elem;                                              \
+  }
+
+#define IOTC_LIST_PUSH_FRONT_WITH_TAIL(type, list, tail, elem) \
+  {                                                            \
+    if (NULL == list) {                                        \
+      tail = elem;                                             \
+    }                                                          \
+    IOTC_LIST_PUSH_FRONT(type, list, elem);                    \
+  }
+
+#define IOTC_LIST_POP_WITH_TAIL(type, list, tail, out) \
+  {                                                    \
+    IOTC_LIST_POP(type, list, out);                    \
+    if (NULL == list) {                                \
+      tail = NULL;                                     \
+    }                                                  \
+  }
+
 #define IOTC_LIST_FIND(type, list, cnd, val, out) \
   {                                               \
     out = list;                                   \
@@ -35,11 +35,15 @@ extern "C" {
  *
  * IOTC_MEMORY_TYPE_UNMANAGED - buffer memory is not managed by the entity.
  * Therefore the buffer will not be freed whenever destroy is called.
+ *
+ * IOTC_MEMORY_TYPE_BORROWED - buffer memory is lent by its owner, destroy
+ * hands it back through a release callback instead of freeing it.
  **/
 typedef enum {
   IOTC_MEMORY_TYPE_UNKNOWN,
   IOTC_MEMORY_TYPE_MANAGED,
-  IOTC_MEMORY_TYPE_UNMANAGED
+  IOTC_MEMORY_TYPE_UNMANAGED,
+  IOTC_MEMORY_TYPE_BORROWED
 } iotc_memory_type_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,505 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "iotc_topic_trie.h"
+
+#include <string.h>
+
+#include "iotc_allocator.h"
+#include "iotc_debug.h"
+#include "iotc_list.h"
+#include "iotc_macros.h"
+
+#define IOTC_TOPIC_TRIE_INITIAL_BUCKETS_NO 4
+
+typedef struct iotc_topic_trie_value_s {
+  void* value;
+  struct iotc_topic_trie_value_s* __next;
+} iotc_topic_trie_value_t;
+
+struct iotc_topic_trie_node_s {
+  iotc_topic_trie_node_t* parent;
+  /* the next node in the same bucket of the parent's hash table */
+  iotc_topic_trie_node_t* next_in_bucket;
+  /* hash table of the literal levels below this node, the number of buckets is
+   * always a power of two */
+  iotc_topic_trie_node_t** buckets;
+  size_t buckets_no;
+  size_t children_no;
+  iotc_topic_trie_node_t* plus_child;
+  iotc_topic_trie_node_t* hash_child;
+  iotc_topic_trie_value_t* values;
+  uint32_t level_hash;
+  size_t level_length;
+  char level[];
+};
+
+/*
+ * STATIC INTERNAL FUNCTIONS
+ */
+
+/* FNV-1a */
+static uint32_t iotc_topic_trie_hash(const char* level, size_t level_length) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+
+  for (i = 0; i < level_length; ++i) {
+    hash ^= (uint8_t)level[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static const char* iotc_topic_trie_level_end(const char* level,
+                                             const char* topic_end) {
+  const char* separator = memchr(level, '/', topic_end - level);
+  return (NULL == separator) ? topic_end : separator;
+}
+
+static iotc_topic_trie_node_t* iotc_topic_trie_make_node(
+    iotc_topic_trie_node_t* parent, const char* level, size_t level_length) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  IOTC_ALLOC_BUFFER(iotc_topic_trie_node_t, node,
+                    sizeof(iotc_topic_trie_node_t) + level_length + 1, state);
+
+  node->parent = parent;
+  node->level_length = level_length;
+  node->level_hash = iotc_topic_trie_hash(level, level_length);
+  memcpy(node->level, level, level_length);
+
+  return node;
+
+err_handling:
+  return NULL;
+}
+
+static iotc_topic_trie_node_t* iotc_topic_trie_find_child(
+    const iotc_topic_trie_node_t* node, const char* level,
+    size_t level_length) {
+  if (0 == node->children_no) {
+    return NULL;
+  }
+
+  const uint32_t hash = iotc_topic_trie_hash(level, level_length);
+  iotc_topic_trie_node_t* child = node->buckets[hash & (node->buckets_no - 1)];
+
+  for (; NULL != child; child = child->next_in_bucket) {
+    if (child->level_hash == hash && child->level_length == level_length &&
+        0 == memcmp(child->level, level, level_length)) {
+      return child;
+    }
+  }
+
+  return NULL;
+}
+
+static iotc_state_t iotc_topic_trie_grow_buckets(iotc_topic_trie_node_t* node) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  const size_t buckets_no = (0 == node->buckets_no)
+                                ? IOTC_TOPIC_TRIE_INITIAL_BUCKETS_NO
+                                : node->buckets_no * 2;
+
+  IOTC_ALLOC_BUFFER(iotc_topic_trie_node_t*, buckets,
+                    buckets_no * sizeof(iotc_topic_trie_node_t*), state);
+
+  size_t i = 0;
+  for (i = 0; i < node->buckets_no; ++i) {
+    iotc_topic_trie_node_t* child = node->buckets[i];
+
+    while (NULL != child) {
+      iotc_topic_trie_node_t* next = child->next_in_bucket;
+      const size_t bucket = child->level_hash & (buckets_no - 1);
+
+      child->next_in_bucket = buckets[bucket];
+      buckets[bucket] = child;
+      child = next;
+    }
+  }
+
+  IOTC_SAFE_FREE(node->buckets);
+
+  node->buckets = buckets;
+  node->buckets_no = buckets_no;
+
+err_handling:
+  return state;
+}
+
+/* '+' and '#' are wildcards when they take a whole level, '#' only as the last
+ * level; other levels, such as the "b+" of a filter a broker granted anyway,
+ * are literals and match only the same level of a topic */
+static iotc_topic_trie_node_t** iotc_topic_trie_wildcard_slot(
+    iotc_topic_trie_node_t* node, const char* level, size_t level_length,
+    uint8_t last_level) {
+  if (1 == level_length && '+' == level[0]) {
+    return &node->plus_child;
+  } else if (1 == level_length && '#' == level[0] && last_level) {
+    return &node->hash_child;
+  }
+
+  return NULL;
+}
+
+static iotc_topic_trie_node_t* iotc_topic_trie_get_or_add_child(
+    iotc_topic_trie_node_t* node, const char* level, size_t level_length,
+    uint8_t last_level) {
+  iotc_topic_trie_node_t** slot =
+      iotc_topic_trie_wildcard_slot(node, level, level_length, last_level);
+
+  if (NULL != slot) {
+    if (NULL == *slot) {
+      *slot = iotc_topic_trie_make_node(node, level, level_length);
+    }
+
+    return *slot;
+  }
+
+  iotc_topic_trie_node_t* child =
+      iotc_topic_trie_find_child(node, level, level_length);
+
+  if (NULL != child) {
+    return child;
+  }
+
+  /* keep the load factor of the hash table at most 1 */
+  if (node->children_no == node->buckets_no &&
+      IOTC_STATE_OK != iotc_topic_trie_grow_buckets(node)) {
+    return NULL;
+  }
+
+  child = iotc_topic_trie_make_node(node, level, level_length);
+
+  if (NULL != child) {
+    iotc_topic_trie_node_t** bucket =
+        &node->buckets[child->level_hash & (node->buckets_no - 1)];
+
+    child->next_in_bucket = *bucket;
+    *bucket = child;
+    node->children_no += 1;
+  }
+
+  return child;
+}
+
+static uint8_t iotc_topic_trie_node_is_unused(
+    const iotc_topic_trie_node_t* node) {
+  return (0 == node->children_no && NULL == node->plus_child &&
+          NULL == node->hash_child && NULL == node->values)
+             ? 1
+             : 0;
+}
+
+static void iotc_topic_trie_unlink_node(iotc_topic_trie_node_t* node) {
+  iotc_topic_trie_node_t* parent = node->parent;
+
+  if (parent->plus_child == node) {
+    parent->plus_child = NULL;
+  } else if (parent->hash_child == node) {
+    parent->hash_child = NULL;
+  } else {
+    iotc_topic_trie_node_t** curr =
+        &parent->buckets[node->level_hash & (parent->buckets_no - 1)];
+
+    while (*curr != node) {
+      curr = &(*curr)->next_in_bucket;
+    }
+
+    *curr = node->next_in_bucket;
+    parent->children_no -= 1;
+  }
+}
+
+static void iotc_topic_trie_free_node(iotc_topic_trie_node_t* node) {
+  if (NULL == node) {
+    return;
+  }
+
+  size_t i = 0;
+  for (i = 0; i < node->buckets_no; ++i) {
+    iotc_topic_trie_node_t* child = node->buckets[i];
+
+    while (NULL != child) {
+      iotc_topic_trie_node_t* next = child->next_in_bucket;
+      iotc_topic_trie_free_node(child);
+      child = next;
+    }
+  }
+
+  iotc_topic_trie_free_node(node->plus_child);
+  iotc_topic_trie_free_node(node->hash_child);
+
+  while (NULL != node->values) {
+    iotc_topic_trie_value_t* next = node->values->__next;
+    IOTC_SAFE_FREE(node->values);
+    node->values = next;
+  }
+
+  IOTC_SAFE_FREE(node->buckets);
+  IOTC_SAFE_FREE(node);
+}
+
+/* drops the node and its ancestors as long as no filter needs them */
+static void iotc_topic_trie_prune(iotc_topic_trie_node_t* node) {
+  while (NULL != node->parent && iotc_topic_trie_node_is_unused(node)) {
+    iotc_topic_trie_node_t* parent = node->parent;
+    iotc_topic_trie_unlink_node(node);
+    iotc_topic_trie_free_node(node);
+    node = parent;
+  }
+}
+
+static size_t iotc_topic_trie_call_values(const iotc_topic_trie_node_t* node,
+                                          iotc_topic_trie_for_t* fun_for,
+                                          void* arg) {
+  size_t values_no = 0;
+  const iotc_topic_trie_value_t* value = node->values;
+
+  for (; NULL != value; value = value->__next, ++values_no) {
+    (*fun_for)(value->value, arg);
+  }
+
+  return values_no;
+}
+
+/**
+ * @brief iotc_topic_trie_match_node
+ *
+ * Matches the levels of the topic starting at level against the filters below
+ * the node. A NULL level means that the whole topic has been consumed.
+ */
+static size_t iotc_topic_trie_match_node(const iotc_topic_trie_node_t* node,
+                                         const char* level,
+                                         const char* topic_end,
+                                         iotc_topic_trie_for_t* fun_for,
+                                         void* arg) {
+  size_t matches_no = 0;
+
+  if (NULL == level) {
+    matches_no += iotc_topic_trie_call_values(node, fun_for, arg);
+
+    /* "a/#" matches "a" too */
+    if (NULL != node->hash_child) {
+      matches_no += iotc_topic_trie_call_values(node->hash_child, fun_for, arg);
+    }
+
+    return matches_no;
+  }
+
+  const char* level_end = iotc_topic_trie_level_end(level, topic_end);
+  const char* next_level = (level_end < topic_end) ? level_end + 1 : NULL;
+
+  /* wildcards of the first level don't match the $SYS like topics */
+  const uint8_t wildcards_match =
+      (NULL != node->parent || level == level_end || '$' != level[0]) ? 1 : 0;
+
+  if (wildcards_match && NULL != node->hash_child) {
+    matches_no += iotc_topic_trie_call_values(node->hash_child, fun_for, arg);
+  }
+
+  if (wildcards_match && NULL != node->plus_child) {
+    matches_no += iotc_topic_trie_match_node(node->plus_child, next_level,
+                                             topic_end, fun_for, arg);
+  }
+
+  const iotc_topic_trie_node_t* child =
+      iotc_topic_trie_find_child(node, level, level_end - level);
+
+  if (NULL != child) {
+    matches_no +=
+        iotc_topic_trie_match_node(child, next_level, topic_end, fun_for, arg);
+  }
+
+  return matches_no;
+}
+
+static void iotc_topic_trie_for_each_node(const iotc_topic_trie_node_t* node,
+                                          iotc_topic_trie_for_t* fun_for,
+                                          void* arg) {
+  if (NULL == node) {
+    return;
+  }
+
+  iotc_topic_trie_call_values(node, fun_for, arg);
+
+  size_t i = 0;
+  for (i = 0; i < node->buckets_no; ++i) {
+    const iotc_topic_trie_node_t* child = node->buckets[i];
+
+    for (; NULL != child; child = child->next_in_bucket) {
+      iotc_topic_trie_for_each_node(child, fun_for, arg);
+    }
+  }
+
+  iotc_topic_trie_for_each_node(node->plus_child, fun_for, arg);
+  iotc_topic_trie_for_each_node(node->hash_child, fun_for, arg);
+}
+
+/*
+ * PUBLIC FUNCTIONS
+ */
+
+iotc_topic_trie_t* iotc_topic_trie_create() {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  IOTC_ALLOC(iotc_topic_trie_t, trie, state);
+
+  IOTC_CHECK_MEMORY(trie->root = iotc_topic_trie_make_node(NULL, "", 0),
+                    state);
+
+  return trie;
+
+err_handling:
+  IOTC_SAFE_FREE(trie);
+  return NULL;
+}
+
+iotc_topic_trie_t* iotc_topic_trie_destroy(iotc_topic_trie_t* trie) {
+  /* PRECONDITION */
+  assert(NULL != trie);
+
+  iotc_topic_trie_free_node(trie->root);
+  IOTC_SAFE_FREE(trie);
+
+  return NULL;
+}
+
+iotc_state_t iotc_topic_trie_add(iotc_topic_trie_t* trie,
+                                 const char* topic_filter, void* value) {
+  /* PRECONDITIONS */
+  assert(NULL != trie);
+
+  if (NULL == topic_filter || '\0' == topic_filter[0]) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  const char* filter_end = topic_filter + strlen(topic_filter);
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_topic_trie_node_t* node = trie->root;
+  const char* level = topic_filter;
+
+  for (;;) {
+    const char* level_end = iotc_topic_trie_level_end(level, filter_end);
+    iotc_topic_trie_node_t* child = iotc_topic_trie_get_or_add_child(
+        node, level, level_end - level, level_end == filter_end);
+
+    IOTC_CHECK_MEMORY(child, state);
+
+    node = child;
+
+    if (level_end == filter_end) {
+      break;
+    }
+
+    level = level_end + 1;
+  }
+
+  IOTC_ALLOC(iotc_topic_trie_value_t, trie_value, state);
+
+  trie_value->value = value;
+  IOTC_LIST_PUSH_BACK(iotc_topic_trie_value_t, node->values, trie_value);
+  trie->elem_no += 1;
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  /* don't leave the levels added so far behind */
+  iotc_topic_trie_prune(node);
+
+  return state;
+}
+
+iotc_state_t iotc_topic_trie_remove(iotc_topic_trie_t* trie,
+                                    const char* topic_filter, void* value) {
+  /* PRECONDITIONS */
+  assert(NULL != trie);
+
+  if (NULL == topic_filter || '\0' == topic_filter[0]) {
+    return IOTC_ELEMENT_NOT_FOUND;
+  }
+
+  const char* filter_end = topic_filter + strlen(topic_filter);
+  iotc_topic_trie_node_t* node = trie->root;
+  const char* level = topic_filter;
+
+  for (;;) {
+    const char* level_end = iotc_topic_trie_level_end(level, filter_end);
+    const size_t level_length = level_end - level;
+    iotc_topic_trie_node_t** slot = iotc_topic_trie_wildcard_slot(
+        node, level, level_length, level_end == filter_end);
+
+    node = (NULL != slot) ? *slot
+                          : iotc_topic_trie_find_child(node, level,
+                                                       level_length);
+
+    if (NULL == node) {
+      return IOTC_ELEMENT_NOT_FOUND;
+    }
+
+    if (level_end == filter_end) {
+      break;
+    }
+
+    level = level_end + 1;
+  }
+
+  iotc_topic_trie_value_t** curr = &node->values;
+
+  while (NULL != *curr && (*curr)->value != value) {
+    curr = &(*curr)->__next;
+  }
+
+  if (NULL == *curr) {
+    return IOTC_ELEMENT_NOT_FOUND;
+  }
+
+  iotc_topic_trie_value_t* trie_value = *curr;
+  *curr = trie_value->__next;
+  IOTC_SAFE_FREE(trie_value);
+  trie->elem_no -= 1;
+
+  iotc_topic_trie_prune(node);
+
+  return IOTC_STATE_OK;
+}
+
+size_t iotc_topic_trie_match(const iotc_topic_trie_t* trie,
+                             const uint8_t* topic, size_t topic_length,
+                             iotc_topic_trie_for_t* fun_for, void* arg) {
+  /* PRECONDITIONS */
+  assert(NULL != trie);
+  assert(NULL != fun_for);
+
+  /* an empty topic is not a valid MQTT topic */
+  if (NULL == topic || 0 == topic_length) {
+    return 0;
+  }
+
+  return iotc_topic_trie_match_node(trie->root, (const char*)topic,
+                                    (const char*)topic + topic_length, fun_for,
+                                    arg);
+}
+
+void iotc_topic_trie_for_each(const iotc_topic_trie_t* trie,
+                              iotc_topic_trie_for_t* fun_for, void* arg) {
+  /* PRECONDITIONS */
+  assert(NULL != trie);
+  assert(NULL != fun_for);
+
+  iotc_topic_trie_for_each_node(trie->root, fun_for, arg);
+}
@@ -0,0 +1,123 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IOTC_TOPIC_TRIE_H__
+#define __IOTC_TOPIC_TRIE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iotc_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A trie of MQTT topic filters.
+ *
+ * Each node of the trie stands for one level of a topic filter. The levels
+ * are the parts of the filter between the '/' separators. The literal levels
+ * below a node are kept in a hash table. The '+' and '#' wildcard levels have
+ * their own slots.
+ *
+ * Any number of values can be attached to a filter. Matching a topic visits
+ * each value attached to a filter that matches the topic, so the cost of a
+ * match depends on the number of levels of the topic and not on the number of
+ * filters in the trie.
+ */
+
+typedef struct iotc_topic_trie_node_s iotc_topic_trie_node_t;
+
+typedef struct {
+  iotc_topic_trie_node_t* root;
+  size_t elem_no; /* the number of values stored in the trie */
+} iotc_topic_trie_t;
+
+typedef void(iotc_topic_trie_for_t)(void* value, void* arg);
+
+extern iotc_topic_trie_t* iotc_topic_trie_create();
+
+/**
+ * @brief iotc_topic_trie_destroy
+ *
+ * Releases the trie. The values aren't released, use
+ * iotc_topic_trie_for_each to release them first.
+ *
+ * @param trie
+ * @return NULL
+ */
+extern iotc_topic_trie_t* iotc_topic_trie_destroy(iotc_topic_trie_t* trie);
+
+/**
+ * @brief iotc_topic_trie_add
+ *
+ * Attaches the value to the topic filter. '+' and '#' are wildcards when they
+ * take a whole level, '#' only as the last level of the filter. Any other
+ * filter a broker may grant is accepted too, its levels are matched
+ * literally.
+ *
+ * @param trie
+ * @param topic_filter
+ * @param value
+ * @return IOTC_STATE_OK, IOTC_INVALID_PARAMETER if the filter is empty or
+ * IOTC_OUT_OF_MEMORY
+ */
+extern iotc_state_t iotc_topic_trie_add(iotc_topic_trie_t* trie,
+                                        const char* topic_filter, void* value);
+
+/**
+ * @brief iotc_topic_trie_remove
+ *
+ * Detaches the value from the topic filter and drops the levels no other
+ * filter uses.
+ *
+ * @param trie
+ * @param topic_filter
+ * @param value
+ * @return IOTC_STATE_OK or IOTC_ELEMENT_NOT_FOUND
+ */
+extern iotc_state_t iotc_topic_trie_remove(iotc_topic_trie_t* trie,
+                                           const char* topic_filter,
+                                           void* value);
+
+/**
+ * @brief iotc_topic_trie_match
+ *
+ * Calls fun_for with each value attached to a filter that matches the topic.
+ * Following the MQTT specification, the wildcards of the first level don't
+ * match topics that start with '$'.
+ *
+ * @param trie
+ * @param topic - the topic of a PUBLISH, it doesn't have to be NUL terminated
+ * @param topic_length
+ * @param fun_for
+ * @param arg
+ * @return the number of values fun_for has been called with
+ */
+extern size_t iotc_topic_trie_match(const iotc_topic_trie_t* trie,
+                                    const uint8_t* topic, size_t topic_length,
+                                    iotc_topic_trie_for_t* fun_for, void* arg);
+
+extern void iotc_topic_trie_for_each(const iotc_topic_trie_t* trie,
+                                     iotc_topic_trie_for_t* fun_for,
+                                     void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IOTC_TOPIC_TRIE_H__ */
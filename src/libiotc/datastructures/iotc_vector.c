@@ -32,7 +32,7 @@ static int8_t iotc_vector_realloc(iotc_vector_t* vector,
   }
 
   iotc_state_t state = IOTC_STATE_OK;
-  size_t elems_size = new_size * sizeof(iotc_vector_elem_t);
+  size_t elems_size = (size_t)new_size * sizeof(iotc_vector_elem_t);
 
   IOTC_ALLOC_BUFFER(iotc_vector_elem_t, new_array, elems_size, state);
 
@@ -76,6 +76,7 @@ iotc_vector_t* iotc_vector_create_from(iotc_vector_elem_t* array, size_t len,
                                        iotc_memory_type_t memory_type) {
   assert(array != 0);
   assert(len > 0);
+  assert(len <= IOTC_VECTOR_INDEX_MAX);
 
   iotc_state_t state = IOTC_STATE_OK;
 
@@ -141,7 +142,18 @@ const iotc_vector_elem_t* iotc_vector_push(
   iotc_state_t state = IOTC_STATE_OK;
 
   if (vector->elem_no + 1 > vector->capacity) {
-    IOTC_CHECK_MEMORY(iotc_vector_realloc(vector, vector->capacity * 2), state);
+    /* the index type can't address more elements, doubling the capacity
+     * would wrap it around */
+    if (IOTC_VECTOR_INDEX_MAX == vector->capacity) {
+      goto err_handling;
+    }
+
+    const int64_t new_capacity =
+        IOTC_MIN((int64_t)vector->capacity * 2, IOTC_VECTOR_INDEX_MAX);
+
+    IOTC_CHECK_MEMORY(
+        iotc_vector_realloc(vector, (iotc_vector_index_type_t)new_capacity),
+        state);
   }
 
   vector->array[vector->elem_no].selector_t = value;
@@ -27,8 +27,25 @@
 extern "C" {
 #endif
 
+/* IOTC_VECTOR_INDEX_WIDTH selects the width of the index type in bits, it
+ * limits the number of elements a vector can hold to IOTC_VECTOR_INDEX_MAX */
+#ifndef IOTC_VECTOR_INDEX_WIDTH
+#define IOTC_VECTOR_INDEX_WIDTH 8
+#endif
+
 /* ! This type has to be SIGNED ! */
+#if IOTC_VECTOR_INDEX_WIDTH == 8
 typedef int8_t iotc_vector_index_type_t;
+#define IOTC_VECTOR_INDEX_MAX INT8_MAX
+#elif IOTC_VECTOR_INDEX_WIDTH == 16
+typedef int16_t iotc_vector_index_type_t;
+#define IOTC_VECTOR_INDEX_MAX INT16_MAX
+#elif IOTC_VECTOR_INDEX_WIDTH == 32
+typedef int32_t iotc_vector_index_type_t;
+#define IOTC_VECTOR_INDEX_MAX INT32_MAX
+#else
+#error "IOTC_VECTOR_INDEX_WIDTH has to be 8, 16 or 32"
+#endif
 
 union iotc_vector_selector_u {
   void* ptr_value;
@@ -78,7 +95,7 @@ extern iotc_vector_t* iotc_vector_create();
  * @brief iotc_vector_create_from
  *
  * In the vector implementation it is possible to create vector from the chunk
- * of already allocated memory.
+ * of already allocated memory. The len can't exceed IOTC_VECTOR_INDEX_MAX.
  *
  * returns new vector created on given memory or NULL if there is not enough
  * memory to create the vector structure
@@ -108,6 +125,8 @@ extern int8_t iotc_vector_reserve(iotc_vector_t* vector,
 
 extern iotc_vector_t* iotc_vector_destroy(iotc_vector_t* vector);
 
+/* returns NULL if the memory can't be allocated or the vector already holds
+ * IOTC_VECTOR_INDEX_MAX elements */
 extern const iotc_vector_elem_t* iotc_vector_push(
     iotc_vector_t* vector, const union iotc_vector_selector_u value);
 
@@ -138,6 +138,41 @@ size_t iotc_memory_limiter_get_allocated_space() {
   return iotc_memory_allocated;
 }
 
+/* Fills the header of a new allocation and counts size bytes of it, the caller
+ * holds iotc_memory_limiter_cs. */
+static void* iotc_memory_limiter_track(void* entry_ptr, size_t size,
+                                       const char* file, size_t line) {
+  iotc_memory_limiter_entry_t* entry = (iotc_memory_limiter_entry_t*)entry_ptr;
+  memset(entry, 0, sizeof(iotc_memory_limiter_entry_t));
+
+#if IOTC_DEBUG_EXTRA_INFO
+  entry->allocation_origin_file_name = file;
+  entry->allocation_origin_line_number = line;
+
+#ifdef IOTC_PLATFORM_BASE_POSIX
+  int no_of_backtraces =
+      backtrace(entry->backtrace_symbols_buffer, MAX_BACKTRACE_SYMBOLS);
+  entry->backtrace_symbols_buffer_size = no_of_backtraces;
+#endif
+
+  if (NULL == iotc_memory_limiter_entry_list_head) {
+    iotc_memory_limiter_entry_list_head = entry;
+  } else {
+    entry->next = iotc_memory_limiter_entry_list_head;
+    iotc_memory_limiter_entry_list_head->prev = entry;
+    iotc_memory_limiter_entry_list_head = entry;
+  }
+#else
+  IOTC_UNUSED(file);
+  IOTC_UNUSED(line);
+#endif
+
+  entry->size = size;
+  iotc_memory_allocated += size;
+
+  return get_ptr_from_entry(entry_ptr);
+}
+
 void* iotc_memory_limiter_alloc(
     iotc_memory_limiter_allocation_type_t limit_type, size_t size_to_alloc,
     const char* file, size_t line) {
@@ -170,39 +205,35 @@ void* iotc_memory_limiter_alloc(
     goto end;
   }
 
-  ptr_to_ret = get_ptr_from_entry(entry_ptr);
+  ptr_to_ret =
+      iotc_memory_limiter_track(entry_ptr, real_size_to_alloc, file, line);
 
-  iotc_memory_limiter_entry_t* entry = (iotc_memory_limiter_entry_t*)entry_ptr;
-  memset(entry, 0, sizeof(iotc_memory_limiter_entry_t));
+end:
+  iotc_unlock_critical_section(&iotc_memory_limiter_cs);
+  return ptr_to_ret;
+}
 
-#if IOTC_DEBUG_EXTRA_INFO
-  entry->allocation_origin_file_name = file;
-  entry->allocation_origin_line_number = line;
+void* iotc_memory_limiter_alloc_pooled(
+    iotc_memory_limiter_allocation_type_t limit_type,
+    iotc_mem_pool_type_t pool_type, size_t size_to_alloc, const char* file,
+    size_t line) {
+  void* ptr_to_ret = NULL;
 
-#ifdef IOTC_PLATFORM_BASE_POSIX
-  int no_of_backtraces =
-      backtrace(entry->backtrace_symbols_buffer, MAX_BACKTRACE_SYMBOLS);
-  entry->backtrace_symbols_buffer_size = no_of_backtraces;
-#endif
+  iotc_lock_critical_section(&iotc_memory_limiter_cs);
 
-  if (NULL == iotc_memory_limiter_entry_list_head) {
-    iotc_memory_limiter_entry_list_head = entry;
-  } else {
-    entry->next = iotc_memory_limiter_entry_list_head;
-    iotc_memory_limiter_entry_list_head->prev = entry;
-    iotc_memory_limiter_entry_list_head = entry;
-  }
-#else
-  IOTC_UNUSED(file);
-  IOTC_UNUSED(line);
-#endif
+  void* entry_ptr = iotc_mem_pool_alloc(
+      pool_type, size_to_alloc + sizeof(iotc_memory_limiter_entry_t));
 
-  entry->size = real_size_to_alloc;
-  iotc_memory_allocated += real_size_to_alloc;
+  /* the slab of the block has been counted when the pool was made */
+  if (NULL != entry_ptr) {
+    ptr_to_ret = iotc_memory_limiter_track(entry_ptr, 0, file, line);
+  }
 
-end:
   iotc_unlock_critical_section(&iotc_memory_limiter_cs);
-  return ptr_to_ret;
+
+  return (NULL != ptr_to_ret) ? ptr_to_ret
+                              : iotc_memory_limiter_alloc(
+                                    limit_type, size_to_alloc, file, line);
 }
 
 void* iotc_memory_limiter_calloc(
@@ -227,8 +258,9 @@ void* iotc_memory_limiter_calloc(
 void* iotc_memory_limiter_realloc(
     iotc_memory_limiter_allocation_type_t limit_type, void* ptr,
     size_t size_to_alloc, const char* file, size_t line) {
+  /* like realloc, a NULL pointer allocates */
   if (NULL == ptr) {
-    return NULL;
+    return iotc_memory_limiter_alloc(limit_type, size_to_alloc, file, line);
   }
 
   assert(limit_type < IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_COUNT);
@@ -291,8 +323,13 @@ void* iotc_memory_limiter_realloc(
   IOTC_UNUSED(line);
 #endif
 
-  entry->size = real_size_to_alloc;
-  iotc_memory_allocated += real_diff;
+  /* a block that still fits its pool stays covered by the slab */
+  if (0 != iotc_mem_pool_block_size(r_ptr)) {
+    entry->size = 0;
+  } else {
+    entry->size = real_size_to_alloc;
+    iotc_memory_allocated += real_diff;
+  }
 
   ptr_to_ret = get_ptr_from_entry(r_ptr);
 
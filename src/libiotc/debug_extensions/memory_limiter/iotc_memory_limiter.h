@@ -21,6 +21,8 @@
 
 #include <iotc_error.h>
 
+#include "iotc_mem_pool.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -78,6 +80,15 @@ void* iotc_memory_limiter_realloc(
     iotc_memory_limiter_allocation_type_t limit_type, void* ptr,
     size_t size_to_alloc, const char* file, size_t line);
 
+/**
+ * @brief takes a block of the pool of pool_type, the block isn't counted as
+ * its slab has been, an empty pool falls back to iotc_memory_limiter_alloc
+ */
+void* iotc_memory_limiter_alloc_pooled(
+    iotc_memory_limiter_allocation_type_t limit_type,
+    iotc_mem_pool_type_t pool_type, size_t size_to_alloc, const char* file,
+    size_t line);
+
 /**
  * @brief sets the limit of the memory limiter
  */
@@ -16,9 +16,9 @@
 
 #include <inttypes.h>
 
+#include "iotc_atomic.h"
 #include "iotc_event_dispatcher_api.h"
 #include "iotc_helpers.h"
-#include "iotc_list.h"
 
 static inline int8_t iotc_evtd_cmp_fd(
     const union iotc_vector_selector_u* e0,
@@ -34,6 +34,59 @@ static inline int8_t iotc_evtd_cmp_fd(
   return -1;
 }
 
+#ifdef IOTC_EVENT_LOOP_POLLER
+static iotc_state_t iotc_evtd_poller_update(iotc_evtd_instance_t* instance,
+                                            const iotc_evtd_fd_tuple_t* tuple) {
+  iotc_bsp_socket_events_t socket_events;
+  memset(&socket_events, 0, sizeof(iotc_bsp_socket_events_t));
+
+  socket_events.iotc_socket = tuple->fd;
+  socket_events.in_socket_want_read =
+      ((tuple->event_type & IOTC_EVENT_WANT_READ) > 0) ? 1 : 0;
+  socket_events.in_socket_want_write =
+      ((tuple->event_type & IOTC_EVENT_WANT_WRITE) > 0) ? 1 : 0;
+  socket_events.in_socket_want_error =
+      ((tuple->event_type & IOTC_EVENT_ERROR) > 0) ? 1 : 0;
+  socket_events.in_socket_want_connect =
+      ((tuple->event_type & IOTC_EVENT_WANT_CONNECT) > 0) ? 1 : 0;
+
+  if (IOTC_BSP_IO_NET_STATE_OK !=
+      iotc_bsp_io_net_poller_update(instance->poller, &socket_events)) {
+    iotc_debug_format("poller rejected socket [%d]", (int)tuple->fd);
+    return IOTC_SOCKET_ERROR;
+  }
+
+  return IOTC_STATE_OK;
+}
+#endif
+
+/**
+ * @brief iotc_evtd_set_socket_event_type
+ *
+ * Changes the event a socket is waiting for. With a poller based event loop
+ * the interest is pushed to the poller here, only if it has changed, instead
+ * of being collected from all the sockets on every loop iteration.
+ */
+static iotc_state_t iotc_evtd_set_socket_event_type(
+    iotc_evtd_instance_t* instance, iotc_evtd_fd_tuple_t* tuple,
+    iotc_event_type_t event_type) {
+  assert(IOTC_EVTD_FD_TYPE_SOCKET == tuple->fd_type);
+
+  IOTC_UNUSED(instance);
+
+  if (tuple->event_type == event_type) {
+    return IOTC_STATE_OK;
+  }
+
+  tuple->event_type = event_type;
+
+#ifdef IOTC_EVENT_LOOP_POLLER
+  return iotc_evtd_poller_update(instance, tuple);
+#else
+  return IOTC_STATE_OK;
+#endif
+}
+
 static int8_t iotc_evtd_register_fd(iotc_evtd_instance_t* instance,
                                     iotc_vector_t* container,
                                     iotc_event_type_t event_type,
@@ -71,6 +124,14 @@ static int8_t iotc_evtd_register_fd(iotc_evtd_instance_t* instance,
     }
   }
 
+#ifdef IOTC_EVENT_LOOP_POLLER
+  if (IOTC_EVTD_FD_TYPE_SOCKET == fd_type &&
+      IOTC_STATE_OK != iotc_evtd_poller_update(instance, tuple)) {
+    iotc_vector_del(container, container->elem_no - 1);
+    goto err_handling;
+  }
+#endif
+
   iotc_unlock_critical_section(instance->cs);
 
   return 1;
@@ -115,6 +176,17 @@ static int8_t iotc_evtd_unregister_fd(iotc_evtd_instance_t* instance,
   /* remove from the vector */
   if (-1 != id) {
     assert(NULL != container->array[id].selector_t.ptr_value);
+
+#ifdef IOTC_EVENT_LOOP_POLLER
+    if (IOTC_EVTD_FD_TYPE_SOCKET ==
+        ((iotc_evtd_fd_tuple_t*)container->array[id].selector_t.ptr_value)
+            ->fd_type) {
+      /* the socket may have been closed already which removes it from the
+       * poller implicitly, so the result doesn't matter here */
+      iotc_bsp_io_net_poller_remove(instance->poller, fd);
+    }
+#endif
+
     IOTC_SAFE_FREE(container->array[id].selector_t.ptr_value);
     iotc_vector_del(container, id);
 
@@ -158,12 +230,14 @@ int8_t iotc_evtd_continue_when_evt_on_socket(iotc_evtd_instance_t* instance,
 
     assert(IOTC_EVTD_FD_TYPE_SOCKET == tuple->fd_type);
 
-    tuple->event_type = event_type;
     tuple->handle = handle;
 
+    const iotc_state_t state =
+        iotc_evtd_set_socket_event_type(instance, tuple, event_type);
+
     iotc_unlock_critical_section(instance->cs);
 
-    return 1;
+    return (IOTC_STATE_OK == state) ? 1 : -1;
   }
 
   iotc_unlock_critical_section(instance->cs);
@@ -176,24 +250,46 @@ void iotc_evtd_continue_when_empty(iotc_evtd_instance_t* instance,
   instance->on_empty = handle;
 }
 
+void iotc_evtd_set_wakeup(iotc_evtd_instance_t* instance,
+                          const iotc_evtd_wakeup_t* wakeup) {
+  assert(NULL != instance);
+
+  iotc_atomic_store_ptr((void**)&instance->wakeup, (void*)wakeup);
+}
+
+static void iotc_evtd_wakeup(iotc_evtd_instance_t* instance) {
+  const iotc_evtd_wakeup_t* wakeup = (const iotc_evtd_wakeup_t*)
+      iotc_atomic_load_ptr((void* const*)&instance->wakeup);
+
+  if (NULL != wakeup) {
+    wakeup->fn(wakeup->data);
+  }
+}
+
+/* must be called with the critical section held, returns with it released */
+static void iotc_evtd_unlock_and_wakeup(iotc_evtd_instance_t* instance) {
+  iotc_unlock_critical_section(instance->cs);
+
+  iotc_evtd_wakeup(instance);
+}
+
+/* lock free, the producers only meet on the head of the call queue */
 iotc_event_handle_queue_t* iotc_evtd_execute(iotc_evtd_instance_t* instance,
                                              iotc_event_handle_t handle) {
-  iotc_state_t state = IOTC_STATE_OK;
-  IOTC_ALLOC_SYSTEM(iotc_event_handle_queue_t, queue_elem, state);
+  iotc_event_handle_queue_t* queue_elem =
+      iotc_event_handle_mpsc_alloc_node(&instance->call_queue);
 
-  queue_elem->handle = handle;
+  if (NULL == queue_elem) {
+    return NULL;
+  }
 
-  iotc_lock_critical_section(instance->cs);
+  queue_elem->handle = handle;
 
-  IOTC_LIST_PUSH_BACK(iotc_event_handle_queue_t, instance->call_queue,
-                      queue_elem);
+  iotc_event_handle_mpsc_push(&instance->call_queue, queue_elem);
 
-  iotc_unlock_critical_section(instance->cs);
+  iotc_evtd_wakeup(instance);
 
   return queue_elem;
-
-err_handling:
-  return NULL;
 }
 
 iotc_state_t iotc_evtd_execute_in(
@@ -208,10 +304,10 @@ iotc_state_t iotc_evtd_execute_in(
 
   iotc_lock_critical_section(instance->cs);
 
-  ret_state = iotc_time_event_add(instance->time_events_container, time_event,
-                                  ret_time_event_handle);
+  ret_state = iotc_time_event_container_add(
+      instance->time_events_container, time_event, ret_time_event_handle);
 
-  iotc_unlock_critical_section(instance->cs);
+  iotc_evtd_unlock_and_wakeup(instance);
 
   return ret_state;
 
@@ -226,8 +322,8 @@ iotc_state_t iotc_evtd_cancel(iotc_evtd_instance_t* instance,
 
   iotc_lock_critical_section(instance->cs);
 
-  ret_state = iotc_time_event_cancel(instance->time_events_container,
-                                     time_event_handle, &time_event);
+  ret_state = iotc_time_event_container_cancel(
+      instance->time_events_container, time_event_handle, &time_event);
 
   iotc_unlock_critical_section(instance->cs);
 
@@ -243,11 +339,11 @@ iotc_state_t iotc_evtd_restart(iotc_evtd_instance_t* instance,
 
   iotc_lock_critical_section(instance->cs);
 
-  ret_state = iotc_time_event_restart(instance->time_events_container,
-                                      time_event_handle,
-                                      instance->current_step + new_time);
+  ret_state = iotc_time_event_container_restart(
+      instance->time_events_container, time_event_handle,
+      instance->current_step + new_time);
 
-  iotc_unlock_critical_section(instance->cs);
+  iotc_evtd_unlock_and_wakeup(instance);
 
   return ret_state;
 }
@@ -256,7 +352,7 @@ iotc_evtd_instance_t* iotc_evtd_create_instance(void) {
   iotc_state_t state = IOTC_STATE_OK;
   IOTC_ALLOC(iotc_evtd_instance_t, evtd_instance, state);
 
-  evtd_instance->time_events_container = iotc_vector_create();
+  evtd_instance->time_events_container = iotc_time_event_container_create();
   IOTC_CHECK_MEMORY(evtd_instance->time_events_container, state);
 
   evtd_instance->handles_and_socket_fd = iotc_vector_create();
@@ -267,6 +363,28 @@ iotc_evtd_instance_t* iotc_evtd_create_instance(void) {
 
   IOTC_CHECK_STATE(iotc_init_critical_section(&evtd_instance->cs));
 
+  if (IOTC_STATE_OK !=
+      iotc_event_handle_mpsc_init(&evtd_instance->call_queue,
+                                  IOTC_EVTD_CALL_QUEUE_NODES)) {
+    iotc_destroy_critical_section(&evtd_instance->cs);
+    iotc_vector_destroy(evtd_instance->handles_and_file_fd);
+    iotc_vector_destroy(evtd_instance->handles_and_socket_fd);
+    iotc_time_event_container_destroy(evtd_instance->time_events_container);
+    goto err_handling;
+  }
+
+#ifdef IOTC_EVENT_LOOP_POLLER
+  if (IOTC_BSP_IO_NET_STATE_OK !=
+      iotc_bsp_io_net_poller_create(&evtd_instance->poller)) {
+    iotc_event_handle_mpsc_destroy(&evtd_instance->call_queue);
+    iotc_destroy_critical_section(&evtd_instance->cs);
+    iotc_vector_destroy(evtd_instance->handles_and_file_fd);
+    iotc_vector_destroy(evtd_instance->handles_and_socket_fd);
+    iotc_time_event_container_destroy(evtd_instance->time_events_container);
+    goto err_handling;
+  }
+#endif
+
   return evtd_instance;
 
 err_handling:
@@ -285,8 +403,14 @@ void iotc_evtd_destroy_instance(iotc_evtd_instance_t* instance) {
 
   iotc_vector_destroy(instance->handles_and_file_fd);
   iotc_vector_destroy(instance->handles_and_socket_fd);
-  iotc_time_event_destroy(instance->time_events_container);
-  iotc_vector_destroy(instance->time_events_container);
+  iotc_time_event_container_destroy_time_events(
+      instance->time_events_container);
+  iotc_time_event_container_destroy(instance->time_events_container);
+  iotc_event_handle_mpsc_destroy(&instance->call_queue);
+
+#ifdef IOTC_EVENT_LOOP_POLLER
+  iotc_bsp_io_net_poller_destroy(&instance->poller);
+#endif
 
   IOTC_SAFE_FREE(instance);
 
@@ -353,13 +477,11 @@ extern uint8_t iotc_evtd_single_step(iotc_evtd_instance_t* evtd_instance,
 
   evtd_instance->current_step = new_step;
 
-  iotc_event_handle_queue_t* queue_elem = NULL;
-
+  /* the workers of a threadpool step the same dispatcher, the critical
+   * section keeps them to one consumer at a time */
   iotc_lock_critical_section(evtd_instance->cs);
-  if (!IOTC_LIST_EMPTY(iotc_event_handle_queue_t, evtd_instance->call_queue)) {
-    IOTC_LIST_POP(iotc_event_handle_queue_t, evtd_instance->call_queue,
-                  queue_elem);
-  }
+  iotc_event_handle_queue_t* queue_elem =
+      iotc_event_handle_mpsc_pop(&evtd_instance->call_queue);
   iotc_unlock_critical_section(evtd_instance->cs);
 
   if (queue_elem == NULL) return 0;
@@ -370,7 +492,7 @@ extern uint8_t iotc_evtd_single_step(iotc_evtd_instance_t* evtd_instance,
     iotc_debug_logger("error while processing normal events");
   }
 
-  IOTC_SAFE_FREE(queue_elem);
+  iotc_event_handle_mpsc_free_node(&evtd_instance->call_queue, queue_elem);
 
   return 1;
 }
@@ -389,11 +511,14 @@ void iotc_evtd_step(iotc_evtd_instance_t* evtd_instance, iotc_time_t new_step) {
 
   iotc_lock_critical_section(evtd_instance->cs);
 
-  /* zero - not NULL elem_no it's a number not a pointer */
-  while (0 != evtd_instance->time_events_container->elem_no) {
-    tmp = iotc_time_event_peek_top(evtd_instance->time_events_container);
+  /* zero - not NULL size it's a number not a pointer */
+  while (0 != iotc_time_event_container_size(
+                   evtd_instance->time_events_container)) {
+    tmp = iotc_time_event_container_peek_top(
+        evtd_instance->time_events_container);
     if (tmp->time_of_execution <= evtd_instance->current_step) {
-      tmp = iotc_time_event_get_top(evtd_instance->time_events_container);
+      tmp = iotc_time_event_container_get_top(
+          evtd_instance->time_events_container);
       iotc_event_handle_t* handle = (iotc_event_handle_t*)&tmp->event_handle;
 
       iotc_unlock_critical_section(evtd_instance->cs);
@@ -432,7 +557,8 @@ void iotc_evtd_step(iotc_evtd_instance_t* evtd_instance, iotc_time_t new_step) {
   /* here we can call the on_empty handler
    * watch out, handler is called only once and
    * it is disposed after that */
-  if ((0 == evtd_instance->time_events_container->elem_no) &&
+  if ((0 == iotc_time_event_container_size(
+                evtd_instance->time_events_container)) &&
       (evtd_instance->on_empty.handle_type != IOTC_EVENT_HANDLE_UNSET)) {
     iotc_debug_logger("calling on_empty_handler");
 
@@ -462,9 +588,9 @@ uint8_t iotc_evtd_all_continue(iotc_evtd_instance_t** event_dispatchers,
   return all_continue;
 }
 
-iotc_state_t iotc_evtd_update_event_on_fd(iotc_evtd_instance_t* instance,
-                                          iotc_vector_t* container,
-                                          iotc_fd_t fd) {
+static iotc_state_t iotc_evtd_dispatch_event_on_fd(
+    iotc_evtd_instance_t* instance, iotc_vector_t* container, iotc_fd_t fd,
+    uint8_t stop_if_not_found) {
   assert(instance != 0);
   iotc_lock_critical_section(instance->cs);
 
@@ -481,7 +607,8 @@ iotc_state_t iotc_evtd_update_event_on_fd(iotc_evtd_instance_t* instance,
 
     /* set the default one if fd type socket */
     if (IOTC_EVTD_FD_TYPE_SOCKET == tuple->fd_type) {
-      tuple->event_type = IOTC_EVENT_WANT_READ;  // default
+      iotc_evtd_set_socket_event_type(instance, tuple,
+                                      IOTC_EVENT_WANT_READ);  // default
       tuple->handle = tuple->read_handle;
     }
 
@@ -494,24 +621,42 @@ iotc_state_t iotc_evtd_update_event_on_fd(iotc_evtd_instance_t* instance,
     iotc_evtd_execute_handle(&to_exec);
 
     iotc_lock_critical_section(instance->cs);
-  } else {
-    iotc_evtd_stop(instance);
+  } else if (1 == stop_if_not_found) {
+    /* the critical section is held, and the dispatcher is being stepped so
+     * there is no one to wake up */
+    instance->stop = 1;
 
     iotc_unlock_critical_section(instance->cs);
 
     return IOTC_FD_HANDLER_NOT_FOUND;
+  } else {
+    iotc_unlock_critical_section(instance->cs);
+
+    return IOTC_ELEMENT_NOT_FOUND;
   }
 
   iotc_unlock_critical_section(instance->cs);
   return IOTC_STATE_OK;
 }
 
+iotc_state_t iotc_evtd_update_event_on_fd(iotc_evtd_instance_t* instance,
+                                          iotc_vector_t* container,
+                                          iotc_fd_t fd) {
+  return iotc_evtd_dispatch_event_on_fd(instance, container, fd, 1);
+}
+
 iotc_state_t iotc_evtd_update_event_on_socket(iotc_evtd_instance_t* instance,
                                               iotc_fd_t fd) {
   return iotc_evtd_update_event_on_fd(instance, instance->handles_and_socket_fd,
                                       fd);
 }
 
+iotc_state_t iotc_evtd_update_event_on_ready_socket(
+    iotc_evtd_instance_t* instance, iotc_fd_t fd) {
+  return iotc_evtd_dispatch_event_on_fd(instance,
+                                        instance->handles_and_socket_fd, fd, 0);
+}
+
 iotc_state_t iotc_evtd_update_event_on_file(iotc_evtd_instance_t* instance,
                                             iotc_fd_t fd) {
   return iotc_evtd_update_event_on_fd(instance, instance->handles_and_file_fd,
@@ -521,7 +666,11 @@ iotc_state_t iotc_evtd_update_event_on_file(iotc_evtd_instance_t* instance,
 void iotc_evtd_stop(iotc_evtd_instance_t* instance) {
   assert(instance != 0);
 
+  iotc_lock_critical_section(instance->cs);
+
   instance->stop = 1;
+
+  iotc_evtd_unlock_and_wakeup(instance);
 }
 
 uint8_t iotc_evtd_update_file_fd_events(
@@ -561,9 +710,9 @@ iotc_state_t iotc_evtd_get_time_of_earliest_event(
 
   iotc_lock_critical_section(instance->cs);
 
-  if (0 != instance->time_events_container->elem_no) {
+  if (0 != iotc_time_event_container_size(instance->time_events_container)) {
     iotc_time_event_t* elem =
-        iotc_time_event_peek_top(instance->time_events_container);
+        iotc_time_event_container_peek_top(instance->time_events_container);
     *out_timeout = elem->time_of_execution;
     ret_state = IOTC_STATE_OK;
   }
@@ -27,11 +27,15 @@
 #include "iotc_event_handle_queue.h"
 #include "iotc_macros.h"
 #include "iotc_time.h"
-#include "iotc_time_event.h"
+#include "iotc_time_event_container.h"
 #include "iotc_vector.h"
 
 #include "iotc_critical_section.h"
 
+#ifdef IOTC_EVENT_LOOP_POLLER
+#include "iotc_bsp_io_net_poller.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -51,14 +55,29 @@ typedef struct iotc_evtd_tuple_s {
   iotc_evtd_fd_type_t fd_type;
 } iotc_evtd_fd_tuple_t;
 
+/* called whenever another thread may have handed the dispatcher work, lets a
+ * thread sleeping on the dispatcher pick it up right away */
+typedef struct iotc_evtd_wakeup_s {
+  void (*fn)(void* data);
+  void* data;
+} iotc_evtd_wakeup_t;
+
 typedef struct iotc_evtd_instance_s {
+  /* time of the last step in milliseconds of the monotonic clock */
   iotc_time_t current_step;
-  iotc_vector_t* time_events_container;
-  iotc_event_handle_queue_t* call_queue;
+  iotc_time_event_container_t* time_events_container;
+  /* events any thread may add, popped by one stepping thread at a time */
+  iotc_event_handle_mpsc_t call_queue;
   struct iotc_critical_section_s* cs;
   iotc_vector_t* handles_and_socket_fd;
   iotc_vector_t* handles_and_file_fd;
   iotc_event_handle_t on_empty;
+  /* owned by whoever sets it, swapped as a whole so producers that don't
+   * take the critical section never see half of it */
+  const iotc_evtd_wakeup_t* wakeup;
+#ifdef IOTC_EVENT_LOOP_POLLER
+  iotc_bsp_poller_t poller;
+#endif
   uint8_t stop;
 } iotc_evtd_instance_t;
 
@@ -84,9 +103,21 @@ extern int8_t iotc_evtd_continue_when_evt_on_socket(
 extern void iotc_evtd_continue_when_empty(iotc_evtd_instance_t* instance,
                                           iotc_event_handle_t handle);
 
+/**
+ * @brief iotc_evtd_set_wakeup
+ *
+ * Sets the function called after an event is queued, a time event is added
+ * or restarted, or the dispatcher is stopped. NULL removes it. The function
+ * runs on the thread that changed the dispatcher, outside of its critical
+ * section. The wakeup must outlive its use by the dispatcher.
+ */
+extern void iotc_evtd_set_wakeup(iotc_evtd_instance_t* instance,
+                                 const iotc_evtd_wakeup_t* wakeup);
+
 extern iotc_event_handle_queue_t* iotc_evtd_execute(
     iotc_evtd_instance_t* instance, iotc_event_handle_t handle);
 
+/* time_diff and new_time are milliseconds relative to the current step */
 extern iotc_state_t iotc_evtd_execute_in(
     iotc_evtd_instance_t* instance, iotc_event_handle_t handle,
     iotc_time_t time_diff, iotc_time_event_handle_t* ret_time_event_handle);
@@ -120,6 +151,20 @@ extern uint8_t iotc_evtd_all_continue(iotc_evtd_instance_t** event_dispatchers,
 extern iotc_state_t iotc_evtd_update_event_on_socket(
     iotc_evtd_instance_t* instance, iotc_fd_t fds);
 
+/**
+ * @brief iotc_evtd_update_event_on_ready_socket
+ *
+ * Same as iotc_evtd_update_event_on_socket but a socket that is no longer
+ * registered is skipped instead of stopping the dispatcher. A poller reports
+ * a batch of ready sockets and a handler executed for one of them may
+ * unregister another one from the same batch.
+ *
+ * @return IOTC_STATE_OK if the handle has been executed, IOTC_ELEMENT_NOT_FOUND
+ * if the socket is not registered
+ */
+extern iotc_state_t iotc_evtd_update_event_on_ready_socket(
+    iotc_evtd_instance_t* instance, iotc_fd_t fd);
+
 extern iotc_state_t iotc_evtd_update_event_on_file(
     iotc_evtd_instance_t* instance, iotc_fd_t fds);
 
@@ -0,0 +1,231 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "iotc_allocator.h"
+#include "iotc_atomic.h"
+#include "iotc_event_handle_queue.h"
+#include "iotc_macros.h"
+
+/*
+ * STATIC INTERNAL FUNCTIONS
+ */
+
+static iotc_event_handle_queue_t* iotc_event_handle_mpsc_load_next(
+    const iotc_event_handle_queue_t* node) {
+  return (iotc_event_handle_queue_t*)iotc_atomic_load_ptr(
+      (void* const*)&node->__next);
+}
+
+static void iotc_event_handle_mpsc_store_next(iotc_event_handle_queue_t* node,
+                                              iotc_event_handle_queue_t* next) {
+  iotc_atomic_store_ptr((void**)&node->__next, next);
+}
+
+static uint8_t iotc_event_handle_mpsc_is_preallocated(
+    const iotc_event_handle_mpsc_t* queue,
+    const iotc_event_handle_queue_t* node) {
+  return (NULL != queue->nodes && node >= queue->nodes &&
+          node < queue->nodes + queue->nodes_count)
+             ? 1
+             : 0;
+}
+
+/* 0 stands for NULL, so an empty set of idle nodes is 0 in the low half */
+static uint32_t iotc_event_handle_mpsc_node_to_index(
+    const iotc_event_handle_mpsc_t* queue,
+    const iotc_event_handle_queue_t* node) {
+  return (NULL == node) ? 0 : (uint32_t)(node - queue->nodes) + 1;
+}
+
+static uint64_t iotc_event_handle_mpsc_next_idle(uint64_t idle_nodes,
+                                                 uint32_t index) {
+  return (((idle_nodes >> 32) + 1) << 32) | index;
+}
+
+/*
+ * PUBLIC FUNCTIONS
+ */
+
+iotc_state_t iotc_event_handle_mpsc_init(iotc_event_handle_mpsc_t* queue,
+                                         uint32_t nodes_count) {
+  assert(NULL != queue);
+
+  iotc_state_t state = IOTC_STATE_OK;
+
+  memset(queue, 0, sizeof(iotc_event_handle_mpsc_t));
+
+  queue->head = &queue->stub;
+  queue->tail = &queue->stub;
+
+  if (0 < nodes_count) {
+    IOTC_ALLOC_SYSTEM_BUFFER_AT(
+        iotc_event_handle_queue_t, queue->nodes,
+        nodes_count * sizeof(iotc_event_handle_queue_t), state);
+
+    queue->nodes_count = nodes_count;
+
+    uint32_t i = 0;
+    for (; i + 1 < nodes_count; ++i) {
+      queue->nodes[i].__next = &queue->nodes[i + 1];
+    }
+
+    queue->idle_nodes = 1;
+  }
+
+err_handling:
+  return state;
+}
+
+void iotc_event_handle_mpsc_destroy(iotc_event_handle_mpsc_t* queue) {
+  assert(NULL != queue);
+
+  iotc_event_handle_queue_t* node = NULL;
+
+  while (NULL != (node = iotc_event_handle_mpsc_pop(queue))) {
+    iotc_event_handle_mpsc_free_node(queue, node);
+  }
+
+  IOTC_SAFE_FREE(queue->nodes);
+  memset(queue, 0, sizeof(iotc_event_handle_mpsc_t));
+}
+
+iotc_event_handle_queue_t* iotc_event_handle_mpsc_alloc_node(
+    iotc_event_handle_mpsc_t* queue) {
+  assert(NULL != queue);
+
+  iotc_state_t state = IOTC_STATE_OK;
+  uint64_t idle_nodes = iotc_atomic_load_u64(&queue->idle_nodes);
+
+  while (0 != (uint32_t)idle_nodes) {
+    iotc_event_handle_queue_t* node =
+        &queue->nodes[(uint32_t)idle_nodes - 1];
+
+    /* the node may have been taken by another thread in the meantime, the
+     * counter in idle_nodes has changed then and the exchange fails */
+    const uint32_t next = iotc_event_handle_mpsc_node_to_index(
+        queue, iotc_event_handle_mpsc_load_next(node));
+
+    if (iotc_atomic_compare_exchange_u64(
+            &queue->idle_nodes, &idle_nodes,
+            iotc_event_handle_mpsc_next_idle(idle_nodes, next))) {
+      memset(node, 0, sizeof(iotc_event_handle_queue_t));
+      return node;
+    }
+  }
+
+  IOTC_ALLOC_SYSTEM_POOLED(IOTC_MEM_POOL_EVENT_HANDLE,
+                           iotc_event_handle_queue_t, node, state);
+
+  return node;
+
+err_handling:
+  return NULL;
+}
+
+void iotc_event_handle_mpsc_free_node(iotc_event_handle_mpsc_t* queue,
+                                      iotc_event_handle_queue_t* node) {
+  assert(NULL != queue);
+
+  if (NULL == node) {
+    return;
+  }
+
+  if (0 == iotc_event_handle_mpsc_is_preallocated(queue, node)) {
+    IOTC_SAFE_FREE(node);
+    return;
+  }
+
+  const uint32_t index = iotc_event_handle_mpsc_node_to_index(queue, node);
+  uint64_t idle_nodes = iotc_atomic_load_u64(&queue->idle_nodes);
+
+  do {
+    iotc_event_handle_mpsc_store_next(
+        node, (0 == (uint32_t)idle_nodes)
+                  ? NULL
+                  : &queue->nodes[(uint32_t)idle_nodes - 1]);
+  } while (!iotc_atomic_compare_exchange_u64(
+      &queue->idle_nodes, &idle_nodes,
+      iotc_event_handle_mpsc_next_idle(idle_nodes, index)));
+}
+
+void iotc_event_handle_mpsc_push(iotc_event_handle_mpsc_t* queue,
+                                 iotc_event_handle_queue_t* node) {
+  assert(NULL != queue);
+  assert(NULL != node);
+
+  iotc_event_handle_mpsc_store_next(node, NULL);
+
+  iotc_event_handle_queue_t* prev =
+      (iotc_event_handle_queue_t*)iotc_atomic_exchange_ptr(
+          (void**)&queue->head, node);
+
+  /* until this store the consumer can't reach the node, see the pop */
+  iotc_event_handle_mpsc_store_next(prev, node);
+}
+
+iotc_event_handle_queue_t* iotc_event_handle_mpsc_pop(
+    iotc_event_handle_mpsc_t* queue) {
+  assert(NULL != queue);
+
+  iotc_event_handle_queue_t* tail = queue->tail;
+  iotc_event_handle_queue_t* next = iotc_event_handle_mpsc_load_next(tail);
+
+  if (&queue->stub == tail) {
+    if (NULL == next) {
+      return NULL;
+    }
+
+    queue->tail = next;
+    tail = next;
+    next = iotc_event_handle_mpsc_load_next(next);
+  }
+
+  if (NULL != next) {
+    queue->tail = next;
+    return tail;
+  }
+
+  /* tail is the last linked node, it may only be handed out once another
+   * node follows it, if the head has moved on a producer is in the middle of
+   * a push */
+  if (tail != iotc_atomic_load_ptr((void* const*)&queue->head)) {
+    return NULL;
+  }
+
+  iotc_event_handle_mpsc_push(queue, &queue->stub);
+
+  next = iotc_event_handle_mpsc_load_next(tail);
+
+  if (NULL != next) {
+    queue->tail = next;
+    return tail;
+  }
+
+  return NULL;
+}
+
+uint8_t iotc_event_handle_mpsc_empty(const iotc_event_handle_mpsc_t* queue) {
+  assert(NULL != queue);
+
+  /* the stub is pushed back behind the last node popped */
+  return (&queue->stub ==
+          iotc_atomic_load_ptr((void* const*)&queue->head))
+             ? 1
+             : 0;
+}
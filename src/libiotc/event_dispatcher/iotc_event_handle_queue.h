@@ -17,11 +17,80 @@
 #ifndef __IOTC_EVENT_HANDLE_QUEUE_H__
 #define __IOTC_EVENT_HANDLE_QUEUE_H__
 
+#include <stdint.h>
+
 #include "iotc_event_handle.h"
 
+#include <iotc_error.h>
+
 typedef struct iotc_event_handle_queue_s {
   struct iotc_event_handle_queue_s* __next;
   iotc_event_handle_t handle;
 } iotc_event_handle_queue_t;
 
+/**
+ * @brief intrusive multi-producer single-consumer queue of event handles
+ *
+ * Any number of threads may push at the same time without a lock, a push is
+ * one atomic exchange. Only one thread at a time may pop. The queue always
+ * holds a stub node so head and tail are never NULL.
+ *
+ * Nodes come from a preallocated set and go back to it once their handle has
+ * been executed, the system allocator is only used when the set is exhausted.
+ */
+typedef struct iotc_event_handle_mpsc_s {
+  /* the node pushed last, swapped in by the producers */
+  iotc_event_handle_queue_t* head;
+  /* the node to pop next, only touched by the consumer */
+  iotc_event_handle_queue_t* tail;
+  iotc_event_handle_queue_t stub;
+  /* the preallocated nodes, an idle one links to the next idle one */
+  iotc_event_handle_queue_t* nodes;
+  uint32_t nodes_count;
+  /* index + 1 of the first idle node in the low half, the high half counts
+   * the changes so a pop working on a stale first node fails */
+  uint64_t idle_nodes;
+} iotc_event_handle_mpsc_t;
+
+extern iotc_state_t iotc_event_handle_mpsc_init(iotc_event_handle_mpsc_t* queue,
+                                                uint32_t nodes_count);
+
+/**
+ * @brief iotc_event_handle_mpsc_destroy
+ *
+ * Releases the nodes still queued without executing their handles and the
+ * preallocated nodes. No thread may use the queue anymore.
+ */
+extern void iotc_event_handle_mpsc_destroy(iotc_event_handle_mpsc_t* queue);
+
+/**
+ * @brief iotc_event_handle_mpsc_alloc_node
+ *
+ * Takes an idle node, safe to call from any thread.
+ *
+ * @return a zeroed node or NULL if the system allocator is out of memory
+ */
+extern iotc_event_handle_queue_t* iotc_event_handle_mpsc_alloc_node(
+    iotc_event_handle_mpsc_t* queue);
+
+extern void iotc_event_handle_mpsc_free_node(iotc_event_handle_mpsc_t* queue,
+                                             iotc_event_handle_queue_t* node);
+
+extern void iotc_event_handle_mpsc_push(iotc_event_handle_mpsc_t* queue,
+                                        iotc_event_handle_queue_t* node);
+
+/**
+ * @brief iotc_event_handle_mpsc_pop
+ *
+ * Must not run on two threads at once. A push that has swapped the head but
+ * not linked its node yet isn't visible, the node is returned by a later pop.
+ *
+ * @return the oldest node or NULL
+ */
+extern iotc_event_handle_queue_t* iotc_event_handle_mpsc_pop(
+    iotc_event_handle_mpsc_t* queue);
+
+extern uint8_t iotc_event_handle_mpsc_empty(
+    const iotc_event_handle_mpsc_t* queue);
+
 #endif /* __IOTC_EVENT_HANDLE_QUEUE_H__ */
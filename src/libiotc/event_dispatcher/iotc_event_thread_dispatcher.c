@@ -36,6 +36,18 @@ iotc_event_handle_queue_t* iotc_evttd_execute(iotc_evtd_instance_t* evtd,
 
   return NULL;
 }
+
+iotc_event_handle_queue_t* iotc_evttd_execute_ordered(
+    iotc_evtd_instance_t* evtd, iotc_event_handle_t handle, const void* key) {
+  if (handle.target_tid == IOTC_THREADID_ANYTHREAD &&
+      iotc_globals.main_threadpool != NULL) {
+    return iotc_threadpool_execute_ordered(iotc_globals.main_threadpool,
+                                           handle, key);
+  }
+
+  /* the main thread and a single workerthread keep the order anyway */
+  return iotc_evttd_execute(evtd, handle);
+}
 #else
 /*
  * Using strict compiler settings requires every translation unit to contain
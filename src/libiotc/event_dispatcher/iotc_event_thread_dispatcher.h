@@ -32,6 +32,17 @@
 extern iotc_event_handle_queue_t* iotc_evttd_execute(
     iotc_evtd_instance_t* evtd, iotc_event_handle_t handle);
 
+/**
+ * @brief dispatches event like iotc_evttd_execute, any-thread events run after
+ *        the events dispatched before with the same key
+ *
+ * Used for the user callbacks, the callbacks of a subscription or of a
+ * connection are called in the order they were dispatched while the callbacks
+ * of different ones may run in parallel on the workerthreads.
+ */
+extern iotc_event_handle_queue_t* iotc_evttd_execute_ordered(
+    iotc_evtd_instance_t* evtd, iotc_event_handle_t handle, const void* key);
+
 #else
 
 /**
@@ -39,6 +50,8 @@ extern iotc_event_handle_queue_t* iotc_evttd_execute(
  *          for main thread execution
  */
 #define iotc_evttd_execute(evtd, handle) iotc_evtd_execute(evtd, handle)
+#define iotc_evttd_execute_ordered(evtd, handle, key) \
+  iotc_evtd_execute(evtd, handle)
 
 #endif
 
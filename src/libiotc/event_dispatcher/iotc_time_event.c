@@ -179,14 +179,14 @@ static void iotc_time_event_move_to_the_end(iotc_vector_t* vector,
   assert(index >= 0);
 
   const iotc_vector_index_type_t last_elem_index = vector->elem_no - 1;
-  iotc_vector_index_type_t elem_to_swap_with_index = index + 1;
 
+  /* index + 1 is computed only below last_elem_index so it can't overflow
+   * the index type when the vector is full */
   while (index < last_elem_index) {
-    iotc_swap_time_events(vector, index, elem_to_swap_with_index);
+    iotc_swap_time_events(vector, index, index + 1);
 
-    /* once swapped update the indexes */
+    /* once swapped update the index */
     index += 1;
-    elem_to_swap_with_index += 1;
   }
 }
 
@@ -43,6 +43,10 @@ typedef struct iotc_time_event_s {
   iotc_time_t time_of_execution;
   iotc_vector_index_type_t position;
   iotc_time_event_handle_t* time_event_handle;
+  /* used only by the timer wheel container, see iotc_time_wheel.h */
+  struct iotc_time_event_s* __next;
+  struct iotc_time_event_s* __prev;
+  uint16_t slot;
 } iotc_time_event_t;
 
 #define IOTC_TIME_EVENT_POSITION_INVALID -1
@@ -53,8 +57,11 @@ typedef struct iotc_time_event_s {
 #define iotc_make_time_event_handle(event_handle) \
   { &event_handle->position }
 
-#define iotc_make_empty_time_event() \
-  { iotc_make_empty_event_handle(), 0, IOTC_TIME_EVENT_POSITION_INVALID, NULL }
+#define iotc_make_empty_time_event()                                     \
+  {                                                                      \
+    iotc_make_empty_event_handle(), 0, IOTC_TIME_EVENT_POSITION_INVALID, \
+        NULL, NULL, NULL, 0                                              \
+  }
 
 /* API */
 /**
@@ -0,0 +1,65 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IOTC_TIME_EVENT_CONTAINER_H__
+#define __IOTC_TIME_EVENT_CONTAINER_H__
+
+/**
+ * @file iotc_time_event_container.h
+ * @brief Selects the container the event dispatcher keeps time events in
+ *
+ * The default container is the sorted vector of iotc_time_event.h. Building
+ * with IOTC_TIME_EVENTS=wheel selects the timer wheel of iotc_time_wheel.h,
+ * which keeps add, restart and cancel O(1) with many time events.
+ */
+
+#include "iotc_time_event.h"
+#include "iotc_time_wheel.h"
+#include "iotc_vector.h"
+
+#ifdef IOTC_TIME_EVENTS_WHEEL
+
+typedef iotc_time_wheel_t iotc_time_event_container_t;
+
+#define iotc_time_event_container_create iotc_time_wheel_create
+#define iotc_time_event_container_destroy iotc_time_wheel_destroy
+#define iotc_time_event_container_size(container) ((container)->size)
+#define iotc_time_event_container_add iotc_time_wheel_add
+#define iotc_time_event_container_get_top iotc_time_wheel_get_top
+#define iotc_time_event_container_peek_top iotc_time_wheel_peek_top
+#define iotc_time_event_container_restart iotc_time_wheel_restart
+#define iotc_time_event_container_cancel iotc_time_wheel_cancel
+#define iotc_time_event_container_destroy_time_events \
+  iotc_time_wheel_destroy_time_events
+
+#else /* IOTC_TIME_EVENTS_WHEEL */
+
+typedef iotc_vector_t iotc_time_event_container_t;
+
+#define iotc_time_event_container_create iotc_vector_create
+#define iotc_time_event_container_destroy iotc_vector_destroy
+#define iotc_time_event_container_size(container) \
+  ((size_t)(container)->elem_no)
+#define iotc_time_event_container_add iotc_time_event_add
+#define iotc_time_event_container_get_top iotc_time_event_get_top
+#define iotc_time_event_container_peek_top iotc_time_event_peek_top
+#define iotc_time_event_container_restart iotc_time_event_restart
+#define iotc_time_event_container_cancel iotc_time_event_cancel
+#define iotc_time_event_container_destroy_time_events iotc_time_event_destroy
+
+#endif /* IOTC_TIME_EVENTS_WHEEL */
+
+#endif /* __IOTC_TIME_EVENT_CONTAINER_H__ */
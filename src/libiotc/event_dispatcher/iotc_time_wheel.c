@@ -0,0 +1,393 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "iotc_time_wheel.h"
+#include "iotc_macros.h"
+
+/*
+ * STATIC INTERNAL FUNCTIONS
+ */
+
+static uint8_t iotc_time_wheel_first_bit(uint64_t bits) {
+  assert(0 != bits);
+
+#if defined(__GNUC__)
+  return (uint8_t)__builtin_ctzll(bits);
+#else
+  uint8_t bit = 0;
+  while (0 == (bits & 1)) {
+    bits >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+static iotc_time_event_t** iotc_time_wheel_slot(iotc_time_wheel_t* wheel,
+                                                uint16_t slot) {
+  if (IOTC_TIME_WHEEL_OVERFLOW_SLOT == slot) {
+    return &wheel->overflow;
+  }
+
+  return &wheel->slots[slot / IOTC_TIME_WHEEL_SLOTS]
+                      [slot % IOTC_TIME_WHEEL_SLOTS];
+}
+
+/**
+ * @brief iotc_time_wheel_slot_for
+ *
+ * Finds the slot of a time event given the current time of the wheel. A time
+ * event that is already due goes to the slot of the current time.
+ */
+static uint16_t iotc_time_wheel_slot_for(const iotc_time_wheel_t* wheel,
+                                         iotc_time_t time_of_execution) {
+  const uint64_t now = (uint64_t)wheel->now;
+  const uint64_t key = (time_of_execution < wheel->now)
+                           ? now
+                           : (uint64_t)time_of_execution;
+  uint16_t level = 0;
+
+  for (level = 0; level < IOTC_TIME_WHEEL_LEVELS; ++level) {
+    const uint8_t shift = (level + 1) * IOTC_TIME_WHEEL_SLOT_BITS;
+
+    if ((key >> shift) == (now >> shift)) {
+      return level * IOTC_TIME_WHEEL_SLOTS +
+             (uint16_t)((key >> (level * IOTC_TIME_WHEEL_SLOT_BITS)) &
+                        (IOTC_TIME_WHEEL_SLOTS - 1));
+    }
+  }
+
+  return IOTC_TIME_WHEEL_OVERFLOW_SLOT;
+}
+
+static void iotc_time_wheel_link(iotc_time_wheel_t* wheel,
+                                 iotc_time_event_t* time_event) {
+  const uint16_t slot =
+      iotc_time_wheel_slot_for(wheel, time_event->time_of_execution);
+  iotc_time_event_t** head = iotc_time_wheel_slot(wheel, slot);
+
+  time_event->slot = slot;
+
+  if (NULL == *head) {
+    time_event->__next = time_event;
+    time_event->__prev = time_event;
+    *head = time_event;
+
+    if (IOTC_TIME_WHEEL_OVERFLOW_SLOT != slot) {
+      wheel->occupied[slot / IOTC_TIME_WHEEL_SLOTS] |=
+          (uint64_t)1 << (slot % IOTC_TIME_WHEEL_SLOTS);
+    }
+
+    return;
+  }
+
+  /* time events of a level 0 slot share the same time unless they were due
+   * when added, so the walk from the tail is short */
+  iotc_time_event_t* after = (*head)->__prev;
+
+  if (slot < IOTC_TIME_WHEEL_SLOTS) {
+    while (after != *head &&
+           after->time_of_execution > time_event->time_of_execution) {
+      after = after->__prev;
+    }
+
+    if (after == *head &&
+        after->time_of_execution > time_event->time_of_execution) {
+      /* the new time event becomes the head */
+      after = (*head)->__prev;
+      *head = time_event;
+    }
+  }
+
+  time_event->__prev = after;
+  time_event->__next = after->__next;
+  after->__next->__prev = time_event;
+  after->__next = time_event;
+}
+
+static void iotc_time_wheel_unlink(iotc_time_wheel_t* wheel,
+                                   iotc_time_event_t* time_event) {
+  const uint16_t slot = time_event->slot;
+  iotc_time_event_t** head = iotc_time_wheel_slot(wheel, slot);
+
+  if (time_event->__next == time_event) {
+    *head = NULL;
+
+    if (IOTC_TIME_WHEEL_OVERFLOW_SLOT != slot) {
+      wheel->occupied[slot / IOTC_TIME_WHEEL_SLOTS] &=
+          ~((uint64_t)1 << (slot % IOTC_TIME_WHEEL_SLOTS));
+    }
+  } else {
+    time_event->__prev->__next = time_event->__next;
+    time_event->__next->__prev = time_event->__prev;
+
+    if (*head == time_event) {
+      *head = time_event->__next;
+    }
+  }
+
+  time_event->__next = NULL;
+  time_event->__prev = NULL;
+}
+
+/**
+ * @brief iotc_time_wheel_relink_slot
+ *
+ * Moves all time events of a slot to the slots that match the current time of
+ * the wheel.
+ */
+static void iotc_time_wheel_relink_slot(iotc_time_wheel_t* wheel,
+                                        uint16_t slot) {
+  iotc_time_event_t** head = iotc_time_wheel_slot(wheel, slot);
+  iotc_time_event_t* time_event = *head;
+
+  if (NULL == time_event) {
+    return;
+  }
+
+  /* detach the whole list first, an overflow time event may go back to the
+   * overflow list */
+  *head = NULL;
+  time_event->__prev->__next = NULL;
+
+  if (IOTC_TIME_WHEEL_OVERFLOW_SLOT != slot) {
+    wheel->occupied[slot / IOTC_TIME_WHEEL_SLOTS] &=
+        ~((uint64_t)1 << (slot % IOTC_TIME_WHEEL_SLOTS));
+  }
+
+  while (NULL != time_event) {
+    iotc_time_event_t* next = time_event->__next;
+    iotc_time_wheel_link(wheel, time_event);
+    time_event = next;
+  }
+}
+
+/**
+ * @brief iotc_time_wheel_find_top
+ *
+ * Moves the current time of the wheel forward to the earliest upper slot until
+ * a level 0 slot is occupied. The head of that slot is the earliest time event.
+ */
+static iotc_time_event_t* iotc_time_wheel_find_top(iotc_time_wheel_t* wheel) {
+  if (0 == wheel->size) {
+    return NULL;
+  }
+
+  for (;;) {
+    const uint64_t now = (uint64_t)wheel->now;
+    uint16_t level = 0;
+
+    for (level = 0; level < IOTC_TIME_WHEEL_LEVELS; ++level) {
+      const uint8_t shift = level * IOTC_TIME_WHEEL_SLOT_BITS;
+      const uint64_t pending =
+          wheel->occupied[level] &
+          (~(uint64_t)0 << ((now >> shift) & (IOTC_TIME_WHEEL_SLOTS - 1)));
+
+      if (0 == pending) {
+        continue;
+      }
+
+      const uint8_t index = iotc_time_wheel_first_bit(pending);
+
+      if (0 == level) {
+        return wheel->slots[0][index];
+      }
+
+      /* enter the slot: keep the bits above the level, replace the bits of
+       * the level and clear the ones below */
+      const uint8_t upper_shift = shift + IOTC_TIME_WHEEL_SLOT_BITS;
+      const uint64_t slot_start =
+          ((now >> upper_shift) << upper_shift) | ((uint64_t)index << shift);
+
+      wheel->now = (iotc_time_t)IOTC_MAX(slot_start, now);
+
+      iotc_time_wheel_relink_slot(wheel, level * IOTC_TIME_WHEEL_SLOTS + index);
+      break;
+    }
+
+    if (IOTC_TIME_WHEEL_LEVELS == level) {
+      /* only the overflow list is left, jump to the range of its earliest
+       * time event */
+      assert(NULL != wheel->overflow);
+
+      iotc_time_t earliest = wheel->overflow->time_of_execution;
+      const iotc_time_event_t* time_event = wheel->overflow->__next;
+
+      while (time_event != wheel->overflow) {
+        earliest = IOTC_MIN(earliest, time_event->time_of_execution);
+        time_event = time_event->__next;
+      }
+
+      const uint8_t top_shift =
+          IOTC_TIME_WHEEL_LEVELS * IOTC_TIME_WHEEL_SLOT_BITS;
+      const uint64_t range_start = ((uint64_t)earliest >> top_shift)
+                                   << top_shift;
+
+      wheel->now = (iotc_time_t)IOTC_MAX(range_start, now);
+
+      iotc_time_wheel_relink_slot(wheel, IOTC_TIME_WHEEL_OVERFLOW_SLOT);
+    }
+  }
+}
+
+static void iotc_time_wheel_dispose_time_event(iotc_time_event_t* time_event) {
+  time_event->position = IOTC_TIME_EVENT_POSITION_INVALID;
+
+  if (NULL != time_event->time_event_handle) {
+    time_event->time_event_handle->ptr_to_position = NULL;
+  }
+}
+
+/*
+ * PUBLIC FUNCTIONS
+ */
+
+iotc_time_wheel_t* iotc_time_wheel_create(void) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  IOTC_ALLOC_SYSTEM(iotc_time_wheel_t, wheel, state);
+
+  return wheel;
+
+err_handling:
+  return NULL;
+}
+
+void iotc_time_wheel_destroy(iotc_time_wheel_t* wheel) {
+  IOTC_SAFE_FREE(wheel);
+}
+
+iotc_state_t iotc_time_wheel_add(
+    iotc_time_wheel_t* wheel, iotc_time_event_t* time_event,
+    iotc_time_event_handle_t* ret_time_event_handle) {
+  /* PRE-CONDITIONS */
+  assert(NULL != wheel);
+  assert(NULL != time_event);
+  assert((NULL != ret_time_event_handle &&
+          NULL == ret_time_event_handle->ptr_to_position) ||
+         (NULL == ret_time_event_handle));
+
+  iotc_time_wheel_link(wheel, time_event);
+  ++wheel->size;
+
+  /* the position only tells a scheduled time event from a disposed one */
+  time_event->position = 0;
+
+  if (NULL != ret_time_event_handle) {
+    ret_time_event_handle->ptr_to_position = &time_event->position;
+    time_event->time_event_handle = ret_time_event_handle;
+  }
+
+  return IOTC_STATE_OK;
+}
+
+iotc_time_event_t* iotc_time_wheel_get_top(iotc_time_wheel_t* wheel) {
+  /* PRE-CONDITIONS */
+  assert(NULL != wheel);
+
+  iotc_time_event_t* top_one = iotc_time_wheel_find_top(wheel);
+
+  if (NULL == top_one) {
+    return NULL;
+  }
+
+  iotc_time_wheel_unlink(wheel, top_one);
+  --wheel->size;
+
+  /* nothing left in the wheel is due before the time event taken */
+  wheel->now = IOTC_MAX(wheel->now, top_one->time_of_execution);
+
+  iotc_time_wheel_dispose_time_event(top_one);
+
+  return top_one;
+}
+
+iotc_time_event_t* iotc_time_wheel_peek_top(iotc_time_wheel_t* wheel) {
+  /* PRE-CONDITIONS */
+  assert(NULL != wheel);
+
+  return iotc_time_wheel_find_top(wheel);
+}
+
+iotc_state_t iotc_time_wheel_restart(
+    iotc_time_wheel_t* wheel, iotc_time_event_handle_t* time_event_handle,
+    iotc_time_t new_time) {
+  /* PRE-CONDITIONS */
+  assert(NULL != wheel);
+  assert(NULL != time_event_handle);
+
+  if (NULL == time_event_handle->ptr_to_position ||
+      IOTC_TIME_EVENT_POSITION_INVALID == *time_event_handle->ptr_to_position) {
+    return IOTC_ELEMENT_NOT_FOUND;
+  }
+
+  iotc_time_event_t* time_event = (iotc_time_event_t*)(
+      (char*)time_event_handle->ptr_to_position -
+      offsetof(iotc_time_event_t, position));
+
+  /* sanity check on the time handle */
+  assert(time_event->time_event_handle == time_event_handle);
+
+  iotc_time_wheel_unlink(wheel, time_event);
+  time_event->time_of_execution = new_time;
+  iotc_time_wheel_link(wheel, time_event);
+
+  return IOTC_STATE_OK;
+}
+
+iotc_state_t iotc_time_wheel_cancel(
+    iotc_time_wheel_t* wheel, iotc_time_event_handle_t* time_event_handle,
+    iotc_time_event_t** cancelled_time_event) {
+  /* PRE-CONDITIONS */
+  assert(NULL != wheel);
+  assert(NULL != time_event_handle);
+  assert(NULL != time_event_handle->ptr_to_position);
+  assert(NULL != cancelled_time_event);
+
+  if (IOTC_TIME_EVENT_POSITION_INVALID == *time_event_handle->ptr_to_position) {
+    return IOTC_ELEMENT_NOT_FOUND;
+  }
+
+  iotc_time_event_t* time_event = (iotc_time_event_t*)(
+      (char*)time_event_handle->ptr_to_position -
+      offsetof(iotc_time_event_t, position));
+
+  iotc_time_wheel_unlink(wheel, time_event);
+  --wheel->size;
+
+  iotc_time_wheel_dispose_time_event(time_event);
+
+  *cancelled_time_event = time_event;
+
+  return IOTC_STATE_OK;
+}
+
+void iotc_time_wheel_destroy_time_events(iotc_time_wheel_t* wheel) {
+  uint16_t slot = 0;
+
+  for (slot = 0; slot <= IOTC_TIME_WHEEL_OVERFLOW_SLOT; ++slot) {
+    iotc_time_event_t** head = iotc_time_wheel_slot(wheel, slot);
+
+    while (NULL != *head) {
+      iotc_time_event_t* time_event = *head;
+      iotc_time_wheel_unlink(wheel, time_event);
+      time_event->position = IOTC_TIME_EVENT_POSITION_INVALID;
+      IOTC_SAFE_FREE(time_event);
+    }
+  }
+
+  wheel->size = 0;
+}
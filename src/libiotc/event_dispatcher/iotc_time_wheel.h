@@ -0,0 +1,118 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file iotc_time_wheel.h
+ * @brief Hierarchical timer wheel container for time events
+ *
+ * The wheel is an alternative to the sorted vector of iotc_time_event.h with
+ * the same set of operations. Adding, restarting and cancelling a time event
+ * is O(1), taking the earliest time event is amortised O(1).
+ *
+ * Each level of the wheel has 64 slots. A slot of level 0 covers one time unit,
+ * a slot of level n covers 64 slots of level n - 1. A time event sits in the
+ * lowest level whose range holds both its execution time and the current time
+ * of the wheel, time events out of the range of the top level wait on an
+ * overflow list. Slots of upper levels are cascaded down when the current time
+ * of the wheel enters them.
+ */
+
+#ifndef __IOTC_TIME_WHEEL_H__
+#define __IOTC_TIME_WHEEL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iotc_time.h"
+#include "iotc_time_event.h"
+
+#ifndef IOTC_TIME_WHEEL_LEVELS
+#define IOTC_TIME_WHEEL_LEVELS 4
+#endif
+
+#define IOTC_TIME_WHEEL_SLOT_BITS 6
+#define IOTC_TIME_WHEEL_SLOTS (1 << IOTC_TIME_WHEEL_SLOT_BITS)
+#define IOTC_TIME_WHEEL_OVERFLOW_SLOT \
+  (IOTC_TIME_WHEEL_LEVELS * IOTC_TIME_WHEEL_SLOTS)
+
+typedef struct iotc_time_wheel_s {
+  /* no time event is due before this time */
+  iotc_time_t now;
+  size_t size;
+  /* one bit per non-empty slot */
+  uint64_t occupied[IOTC_TIME_WHEEL_LEVELS];
+  /* each slot is a circular list, a slot of level 0 is sorted by execution
+   * time */
+  iotc_time_event_t* slots[IOTC_TIME_WHEEL_LEVELS][IOTC_TIME_WHEEL_SLOTS];
+  iotc_time_event_t* overflow;
+} iotc_time_wheel_t;
+
+/**
+ * @brief iotc_time_wheel_create
+ *
+ * @return an empty wheel or NULL if there is not enough memory
+ */
+iotc_time_wheel_t* iotc_time_wheel_create(void);
+
+/**
+ * @brief iotc_time_wheel_destroy
+ *
+ * Releases the wheel. The time events are not released.
+ *
+ * @see iotc_time_wheel_destroy_time_events
+ */
+void iotc_time_wheel_destroy(iotc_time_wheel_t* wheel);
+
+/**
+ * @see iotc_time_event_add
+ */
+iotc_state_t iotc_time_wheel_add(
+    iotc_time_wheel_t* wheel, iotc_time_event_t* time_event,
+    iotc_time_event_handle_t* ret_time_event_handle);
+
+/**
+ * @see iotc_time_event_get_top
+ */
+iotc_time_event_t* iotc_time_wheel_get_top(iotc_time_wheel_t* wheel);
+
+/**
+ * @see iotc_time_event_peek_top
+ *
+ * @note Finding the earliest time event may cascade upper slots, so the wheel
+ * is not const.
+ */
+iotc_time_event_t* iotc_time_wheel_peek_top(iotc_time_wheel_t* wheel);
+
+/**
+ * @see iotc_time_event_restart
+ */
+iotc_state_t iotc_time_wheel_restart(
+    iotc_time_wheel_t* wheel, iotc_time_event_handle_t* time_event_handle,
+    iotc_time_t new_time);
+
+/**
+ * @see iotc_time_event_cancel
+ */
+iotc_state_t iotc_time_wheel_cancel(
+    iotc_time_wheel_t* wheel, iotc_time_event_handle_t* time_event_handle,
+    iotc_time_event_t** cancelled_time_event);
+
+/**
+ * @see iotc_time_event_destroy
+ */
+void iotc_time_wheel_destroy_time_events(iotc_time_wheel_t* wheel);
+
+#endif /* __IOTC_TIME_WHEEL_H__ */
@@ -19,6 +19,79 @@
 #include "iotc_bsp_time.h"
 #include "iotc_event_dispatcher_api.h"
 
+#ifdef IOTC_EVENT_LOOP_POLLER
+#include "iotc_bsp_io_net_poller.h"
+#endif
+
+/**
+ * @brief iotc_event_loop_calculate_timeout
+ *
+ * Picks the time until the earliest time event of all dispatchers and
+ * processes pending file events. If any file has been updated the timeout is
+ * zero so the loop doesn't block.
+ */
+static iotc_state_t iotc_event_loop_calculate_timeout(
+    iotc_evtd_instance_t** in_event_dispatchers, uint8_t in_num_evtds,
+    iotc_time_t* out_timeout) {
+  uint8_t was_file_updated = 0;
+  uint8_t was_timeout_candidate_set = 0;
+  iotc_time_t timeout_candidate = 0;
+
+  uint8_t evtd_id = 0;
+  for (evtd_id = 0; evtd_id < in_num_evtds; ++evtd_id) {
+    iotc_evtd_instance_t* event_dispatcher = in_event_dispatchers[evtd_id];
+    assert(NULL != event_dispatcher);
+
+    /* pick the smallest possible timeout with respect to all dispatchers */
+    {
+      iotc_time_t tmp_timeout = 0;
+      iotc_state_t state =
+          iotc_evtd_get_time_of_earliest_event(event_dispatcher, &tmp_timeout);
+
+      /* if the heap wasn't empty */
+      if (IOTC_STATE_OK == state) {
+        /* if the timeout candidate has been initialised */
+        if (1 == was_timeout_candidate_set) {
+          timeout_candidate = IOTC_MIN(timeout_candidate, tmp_timeout);
+        } else /* if it hasn't been initialised */
+        {
+          timeout_candidate = tmp_timeout;
+        }
+
+        was_timeout_candidate_set = 1;
+      }
+    }
+
+    was_file_updated |= iotc_evtd_update_file_fd_events(event_dispatcher);
+  }
+
+  /* store the current time, time events are kept on the monotonic clock */
+  const iotc_time_t current_time =
+      iotc_bsp_time_getmonotonictime_milliseconds();
+
+  /* recalculate the timeout */
+  if (was_timeout_candidate_set) {
+    if (timeout_candidate >= current_time) {
+      timeout_candidate = timeout_candidate - current_time;
+    } else {
+      /* this is possible if the first event to execute is in the past */
+      timeout_candidate = 0;
+    }
+  } else {
+    timeout_candidate = IOTC_DEFAULT_IDLE_TIMEOUT_MS;
+  }
+
+  /* make it clamped from the top */
+  timeout_candidate = IOTC_MIN(timeout_candidate, IOTC_MAX_IDLE_TIMEOUT_MS);
+
+  /* update the return parameter */
+  *out_timeout = (was_file_updated != 0) ? (0) : (timeout_candidate);
+
+  return IOTC_STATE_OK;
+}
+
+#ifndef IOTC_EVENT_LOOP_POLLER
+
 /**
  * @brief iotc_bsp_event_loop_count_all_sockets
  * @param event_dispatchers
@@ -55,9 +128,6 @@ iotc_state_t iotc_bsp_event_loop_transform_to_bsp_select(
   }
 
   size_t socket_id = 0;
-  uint8_t was_file_updated = 0;
-  uint8_t was_timeout_candidate_set = 0;
-  iotc_time_t timeout_candidate = 0;
 
   uint8_t evtd_id = 0;
   for (evtd_id = 0; evtd_id < in_num_evtds; ++evtd_id) {
@@ -66,26 +136,6 @@ iotc_state_t iotc_bsp_event_loop_transform_to_bsp_select(
 
     iotc_vector_index_type_t i = 0;
 
-    /* pick the smallest possible timeout with respect to all dispatchers */
-    {
-      iotc_time_t tmp_timeout = 0;
-      iotc_state_t state =
-          iotc_evtd_get_time_of_earliest_event(event_dispatcher, &tmp_timeout);
-
-      /* if the heap wasn't empty */
-      if (IOTC_STATE_OK == state) {
-        /* if the timeout candidate has been initialised */
-        if (1 == was_timeout_candidate_set) {
-          timeout_candidate = IOTC_MIN(timeout_candidate, tmp_timeout);
-        } else /* if it hasn't been initialised */
-        {
-          timeout_candidate = tmp_timeout;
-        }
-
-        was_timeout_candidate_set = 1;
-      }
-    }
-
     for (i = 0; i < event_dispatcher->handles_and_socket_fd->elem_no; ++i) {
       iotc_evtd_fd_tuple_t* tuple =
           (iotc_evtd_fd_tuple_t*)event_dispatcher->handles_and_socket_fd
@@ -113,32 +163,10 @@ iotc_state_t iotc_bsp_event_loop_transform_to_bsp_select(
 
       socket_id += 1;
     }
-
-    was_file_updated |= iotc_evtd_update_file_fd_events(event_dispatcher);
   }
 
-  /* store the current time */
-  const iotc_time_t current_time = iotc_bsp_time_getcurrenttime_seconds();
-
-  /* recalculate the timeout */
-  if (was_timeout_candidate_set) {
-    if (timeout_candidate >= current_time) {
-      timeout_candidate = timeout_candidate - current_time;
-    } else {
-      /* this is possible if the first event to execute is in the past */
-      timeout_candidate = 0;
-    }
-  } else {
-    timeout_candidate = IOTC_DEFAULT_IDLE_TIMEOUT;
-  }
-
-  /* make it clamped from the top */
-  timeout_candidate = IOTC_MIN(timeout_candidate, IOTC_MAX_IDLE_TIMEOUT);
-
-  /* update the return parameter */
-  *out_timeout = (was_file_updated != 0) ? (0) : (timeout_candidate);
-
-  return IOTC_STATE_OK;
+  return iotc_event_loop_calculate_timeout(in_event_dispatchers, in_num_evtds,
+                                           out_timeout);
 }
 
 iotc_state_t iotc_bsp_event_loop_update_event_dispatcher(
@@ -236,7 +264,7 @@ iotc_state_t iotc_event_loop_with_evtds(
     IOTC_CHECK_STATE(state);
 
     /* call the bsp select function */
-    const iotc_bsp_io_net_state_t select_state = iotc_bsp_io_net_select(
+    const iotc_bsp_io_net_state_t select_state = iotc_bsp_io_net_select_ms(
         (iotc_bsp_socket_events_t*)&array_of_sockets_to_update,
         no_of_sockets_to_update, timeout);
 
@@ -255,10 +283,143 @@ iotc_state_t iotc_event_loop_with_evtds(
     uint8_t evtd_id = 0;
     for (evtd_id = 0; evtd_id < num_evtds; ++evtd_id) {
       iotc_evtd_step(event_dispatchers[evtd_id],
-                     iotc_bsp_time_getcurrenttime_seconds());
+                     iotc_bsp_time_getmonotonictime_milliseconds());
     }
   }
 
 err_handling:
   return state;
 }
+
+#else /* IOTC_EVENT_LOOP_POLLER */
+
+/**
+ * @brief iotc_event_loop_dispatch_ready_sockets
+ *
+ * Executes the handles of the sockets reported ready by the poller of the
+ * given dispatcher.
+ */
+static iotc_state_t iotc_event_loop_dispatch_ready_sockets(
+    iotc_evtd_instance_t* event_dispatcher,
+    const iotc_bsp_socket_events_t* ready_sockets, size_t ready_sockets_count) {
+  size_t socket_id = 0;
+  for (socket_id = 0; socket_id < ready_sockets_count; ++socket_id) {
+    const iotc_bsp_socket_events_t* ready_socket = &ready_sockets[socket_id];
+
+    if (0 != ready_socket->out_socket_can_read ||
+        0 != ready_socket->out_socket_can_write ||
+        0 != ready_socket->out_socket_connect_finished ||
+        0 != ready_socket->out_socket_error) {
+      const iotc_state_t state = iotc_evtd_update_event_on_ready_socket(
+          event_dispatcher, ready_socket->iotc_socket);
+
+      /* the socket has been unregistered by one of the previous handles */
+      if (IOTC_ELEMENT_NOT_FOUND == state) {
+        continue;
+      }
+
+      IOTC_CHECK_STATE(state);
+    }
+  }
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  return IOTC_INTERNAL_ERROR;
+}
+
+/**
+ * @brief iotc_event_loop_wait_for_pollers
+ *
+ * With more than one dispatcher the loop can't block on a single poller, so
+ * it blocks on all of them through the BSP select and then collects the ready
+ * sockets from each poller that has woken up.
+ */
+static iotc_bsp_io_net_state_t iotc_event_loop_wait_for_pollers(
+    iotc_evtd_instance_t** event_dispatchers, uint8_t num_evtds,
+    iotc_time_t timeout) {
+  iotc_bsp_socket_events_t pollers[num_evtds];
+  memset(pollers, 0, sizeof(iotc_bsp_socket_events_t) * num_evtds);
+
+  uint8_t evtd_id = 0;
+  for (evtd_id = 0; evtd_id < num_evtds; ++evtd_id) {
+    pollers[evtd_id].iotc_socket =
+        iotc_bsp_io_net_poller_get_socket(event_dispatchers[evtd_id]->poller);
+    pollers[evtd_id].in_socket_want_read = 1;
+  }
+
+  return iotc_bsp_io_net_select_ms(pollers, num_evtds, timeout);
+}
+
+iotc_state_t iotc_event_loop_with_evtds(
+    uint32_t num_iterations, iotc_evtd_instance_t** event_dispatchers,
+    uint8_t num_evtds) {
+  if (NULL == event_dispatchers || 0 == num_evtds) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc_state_t state = IOTC_STATE_OK;
+  uint32_t loops_processed = 0;
+
+  while (iotc_evtd_all_continue(event_dispatchers, num_evtds) &&
+         (0 == num_iterations || loops_processed < num_iterations)) {
+    loops_processed += 1;
+
+    /* for storing the timeout */
+    iotc_time_t timeout = 0;
+
+    state = iotc_event_loop_calculate_timeout(event_dispatchers, num_evtds,
+                                              &timeout);
+    IOTC_CHECK_STATE(state);
+
+    /* with a single dispatcher block directly on its poller */
+    iotc_time_t poller_timeout = timeout;
+
+    if (1 < num_evtds) {
+      const iotc_bsp_io_net_state_t select_state =
+          iotc_event_loop_wait_for_pollers(event_dispatchers, num_evtds,
+                                           timeout);
+
+      if (IOTC_BSP_IO_NET_STATE_ERROR == select_state) {
+        state = IOTC_INTERNAL_ERROR;
+        goto err_handling;
+      }
+
+      poller_timeout = 0;
+    }
+
+    uint8_t evtd_id = 0;
+    for (evtd_id = 0; evtd_id < num_evtds; ++evtd_id) {
+      iotc_evtd_instance_t* event_dispatcher = event_dispatchers[evtd_id];
+
+      iotc_bsp_socket_events_t
+          ready_sockets[IOTC_EVENT_LOOP_POLLER_MAX_READY_SOCKETS];
+      size_t ready_sockets_count = 0;
+
+      const iotc_bsp_io_net_state_t wait_state = iotc_bsp_io_net_poller_wait(
+          event_dispatcher->poller, ready_sockets,
+          IOTC_EVENT_LOOP_POLLER_MAX_READY_SOCKETS, &ready_sockets_count,
+          poller_timeout);
+
+      if (IOTC_BSP_IO_NET_STATE_OK == wait_state) {
+        state = iotc_event_loop_dispatch_ready_sockets(
+            event_dispatcher, ready_sockets, ready_sockets_count);
+        IOTC_CHECK_STATE(state);
+      } else if (IOTC_BSP_IO_NET_STATE_ERROR == wait_state) {
+        state = IOTC_INTERNAL_ERROR;
+        goto err_handling;
+      }
+    }
+
+    /* update time based events */
+    for (evtd_id = 0; evtd_id < num_evtds; ++evtd_id) {
+      iotc_evtd_step(event_dispatchers[evtd_id],
+                     iotc_bsp_time_getmonotonictime_milliseconds());
+    }
+  }
+
+err_handling:
+  return state;
+}
+
+#endif /* IOTC_EVENT_LOOP_POLLER */
@@ -42,6 +42,11 @@ typedef enum iotc_fs_open_flags_e {
   IOTC_FS_OPEN_READ = 1 << 0,
   IOTC_FS_OPEN_WRITE = 1 << 1,
   IOTC_FS_OPEN_APPEND = 1 << 2,
+  /* read in place, the buffers stay valid until close, see
+   * IOTC_BSP_IO_FS_OPEN_MMAP */
+  IOTC_FS_OPEN_MMAP = 1 << 3,
+  /* a write creates a missing file, see IOTC_BSP_IO_FS_OPEN_CREATE */
+  IOTC_FS_OPEN_CREATE = 1 << 4,
 } iotc_fs_open_flags_t;
 
 /* The size of the buffer to be used for reads */
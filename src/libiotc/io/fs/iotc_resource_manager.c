@@ -94,7 +94,7 @@ static iotc_state_t iotc_resource_manager_set_callback_state(
                                                                             \
   /* register callback invocation */                                        \
   IOTC_CHECK_MEMORY(                                                        \
-      iotc_evtd_execute(iotc_globals.evtd_instance, ctx->callback),         \
+      iotc_evtd_execute(ctx->evtd_instance, ctx->callback),                 \
       ret_state);                                                           \
                                                                             \
   /* dispose the callback handle */                                         \
@@ -138,6 +138,7 @@ iotc_state_t iotc_resource_manager_make_context(
   }
 
   (*context)->resource_handle = iotc_resource_manager_get_invalid_unique_fd();
+  (*context)->evtd_instance = iotc_globals.evtd_instance;
 
   return state;
 
@@ -190,14 +191,14 @@ static iotc_state_t iotc_resource_manager_open_coroutine(void* context,
 
   /* yield from stat_resource */
   IOTC_RESOURCE_MANAGER_YIELD_FROM(
-      ctx->cs, iotc_globals.evtd_instance, ctx->resource_handle,
+      ctx->cs, ctx->evtd_instance, ctx->resource_handle,
       IOTC_EVENT_WANT_READ, IOTC_STATE_WANT_READ, local_handle, ret_state,
       {/* empty block of code */}, iotc_internals.fs_functions.stat_resource,
       NULL, resource_type, resource_name, &ctx->resource_stat);
 
   /* yield from open_resource */
   IOTC_RESOURCE_MANAGER_YIELD_FROM(
-      ctx->cs, iotc_globals.evtd_instance, ctx->resource_handle,
+      ctx->cs, ctx->evtd_instance, ctx->resource_handle,
       IOTC_EVENT_WANT_READ, IOTC_STATE_WANT_READ, local_handle, ret_state,
       {/* empty block of code */}, iotc_internals.fs_functions.open_resource,
       NULL, resource_type, resource_name, ctx->open_flags, &resource_handle);
@@ -243,10 +244,17 @@ iotc_state_t iotc_resource_manager_read_coroutine(void* context) {
   ctx->data_offset = 0;
 
   IOTC_RESOURCE_MANAGER_YIELD_FROM(
-      ctx->cs, iotc_globals.evtd_instance, ctx->resource_handle,
+      ctx->cs, ctx->evtd_instance, ctx->resource_handle,
       IOTC_EVENT_WANT_READ, IOTC_STATE_WANT_READ, local_handle, ret_state,
       { /* this section will be called after each read_resource function
            invocation */
+
+        /* a resource grown since the stat is read as the stat saw it */
+        if (IOTC_STATE_OK == ret_state &&
+            ctx->resource_stat.resource_size - ctx->data_offset < buffer_size) {
+          buffer_size = ctx->resource_stat.resource_size - ctx->data_offset;
+        }
+
         ctx->data_offset += buffer_size;
 
         /* if not the whole file has been read */
@@ -323,7 +331,7 @@ iotc_state_t iotc_resource_manager_close_coroutine(void* context) {
   IOTC_CR_START(ctx->cs);
 
   IOTC_RESOURCE_MANAGER_YIELD_FROM(
-      ctx->cs, iotc_globals.evtd_instance, ctx->resource_handle,
+      ctx->cs, ctx->evtd_instance, ctx->resource_handle,
       IOTC_EVENT_WANT_READ, IOTC_STATE_WANT_READ, local_handle, ret_state,
       {/* empty block of code */}, iotc_internals.fs_functions.close_resource,
       NULL, ctx->resource_handle);
@@ -366,12 +374,17 @@ iotc_state_t iotc_resource_manager_open(
 
   iotc_state_t state = IOTC_STATE_OK;
 
-  context->open_flags = open_flags;
+  /* a resource read whole is shared in place if the filesystem can map it,
+   * writes are left alone */
+  context->open_flags = (open_flags & IOTC_FS_OPEN_READ)
+                            ? (iotc_fs_open_flags_t)(open_flags |
+                                                     IOTC_FS_OPEN_MMAP)
+                            : open_flags;
   context->callback = callback;
 
   IOTC_CHECK_MEMORY(
       iotc_evtd_execute(
-          iotc_globals.evtd_instance,
+          context->evtd_instance,
           iotc_make_handle(&iotc_resource_manager_open_coroutine,
                            (void*)context, (void*)(intptr_t)resource_type,
                            IOTC_STATE_OK, (void*)resource_name)),
@@ -401,7 +414,7 @@ iotc_state_t iotc_resource_manager_read(
   context->callback = callback;
 
   IOTC_CHECK_MEMORY(
-      iotc_evtd_execute(iotc_globals.evtd_instance,
+      iotc_evtd_execute(context->evtd_instance,
                         iotc_make_handle(&iotc_resource_manager_read_coroutine,
                                          (void*)context)),
       state);
@@ -431,7 +444,7 @@ iotc_state_t iotc_resource_manager_close(
   context->callback = callback;
 
   IOTC_CHECK_MEMORY(
-      iotc_evtd_execute(iotc_globals.evtd_instance,
+      iotc_evtd_execute(context->evtd_instance,
                         iotc_make_handle(&iotc_resource_manager_close_coroutine,
                                          (void*)context)),
       state);
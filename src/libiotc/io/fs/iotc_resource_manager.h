@@ -18,6 +18,7 @@
 #define __IOTC_RESOURCE_MANAGER_H__
 
 #include "iotc_data_desc.h"
+#include "iotc_event_dispatcher_api.h"
 #include "iotc_event_handle.h"
 #include "iotc_fs_api.h"
 
@@ -33,6 +34,9 @@ typedef struct iotc_resource_manager_context_s {
    * While it is set means that one of the operation is pending( open, read,
    * write, close )*/
   iotc_event_handle_t callback;
+  /* the dispatcher running the operations and the callback, the global one
+   * unless the owner sets its own */
+  iotc_evtd_instance_t* evtd_instance;
   iotc_fs_stat_t resource_stat; /* copy of the resource stat passed with open */
   iotc_fs_resource_handle_t resource_handle; /* handle to the opened resource */
   iotc_fs_open_flags_t open_flags; /* copy of open flags passed with open */
@@ -108,6 +112,11 @@ iotc_state_t iotc_resource_manager_open(
  * operation. The read buffer can be taken from the
  * iotc_resource_manager_context_t's data_buffer.
  *
+ * Resources opened for reading are opened with IOTC_FS_OPEN_MMAP. If the
+ * filesystem hands out the whole resource in one read, e.g. the POSIX one
+ * from a memory mapping, the data_buffer shares that memory instead of
+ * copying it and is only valid until the resource is closed.
+ *
  * @param callback function that will be called upon a success or an error
  * @param context previously created context
  * @return IOTC_STATE_OK if operation succeded, one of error code otherwise
@@ -14,6 +14,13 @@
  * limitations under the License.
  */
 
+
+#include <string.h>
+
+#include "iotc_allocator.h"
+#include "iotc_config.h"
+#include "iotc_critical_section.h"
+#include "iotc_critical_section_def.h"
 #include "iotc_debug.h"
 #include "iotc_fs_filename_defs.h"
 #include "iotc_fs_header.h"
@@ -30,146 +37,283 @@ const size_t iotc_fs_buffer_size = IOTC_ROOTCA_LIST_BYTE_LENGTH;
 const size_t iotc_fs_buffer_size = 512;
 #endif /* IOTC_NO_TLS_LAYER */
 
-/* local stat handler function type defined per resource id */
-typedef iotc_state_t(iotc_fs_memory_stat_t)(
-    const iotc_fs_resource_handle_t resource_id, iotc_fs_stat_t* resource_stat);
-
-/* local open handler function type defined per resource id */
-typedef iotc_state_t(iotc_fs_memory_open_t)(
-    const iotc_fs_resource_handle_t resource_id);
-
-typedef enum iotc_fs_memory_resource_state_e {
-  IOTC_FS_MEMORY_RESOURCE_STATE_CLOSED = 0,
-  IOTC_FS_MEMORY_RESOURCE_STATE_OPEN
-} iotc_fs_memory_resource_state_t;
-
-/* declarations of all memory functions */
-#ifndef IOTC_NO_TLS_LAYER
-iotc_state_t iotc_fs_memory_stat_builtin_cert(
-    const iotc_fs_resource_handle_t resource_id, iotc_fs_stat_t* resource_stat);
-iotc_state_t iotc_fs_memory_open_builtin_cert(
-    const iotc_fs_resource_handle_t resource_id);
+#if (0 != (IOTC_FS_MEMORY_BUCKETS & (IOTC_FS_MEMORY_BUCKETS - 1)))
+#error IOTC_FS_MEMORY_BUCKETS must be a power of 2
 #endif
 
 /*
- * @struct iotc_fs_memory_database_s
- * @brief describes a single entry in a memory of fs database
+ * @struct iotc_fs_memory_file_s
+ * @brief a file compiled in and read only, or one written at runtime
+ *
+ * A written file keeps its content in blocks that never move, so a buffer
+ * handed out by a read stays valid while the file grows.
  */
-typedef struct iotc_fs_memory_database_s {
-  const char* const file_name; /* file name of the entry */
-  iotc_fs_memory_stat_t*
-      stat_handler_function; /* associated stat handler function */
-  iotc_fs_memory_open_t*
-      open_handler_function; /* associated open handler function */
-  const void* memory_ptr;    /* resource memory pointer */
-  size_t open_counter;       /* the counter for open counts */
-  iotc_fs_memory_resource_state_t resource_state; /* state associated to that
-                                                   resource */
-} iotc_fs_memory_database_t;
-
-iotc_fs_memory_database_t IOTC_FS_MEMORY_DATABASE[] = {
+typedef struct iotc_fs_memory_file_s {
+  struct iotc_fs_memory_file_s* __next; /* the next file of the bucket */
+  const char* name;
+  uint32_t name_hash;
+  const uint8_t* builtin_data; /* the compiled in content, NULL if written */
+  size_t size;
+  uint8_t** blocks;
+  size_t block_count;
+  size_t block_capacity;
+  size_t open_counter;
+  uint8_t removed; /* freed by the last close */
+} iotc_fs_memory_file_t;
+
+/* an open file, the resource handle is its index */
+typedef struct iotc_fs_memory_handle_s {
+  iotc_fs_memory_file_t* file;
+  iotc_fs_open_flags_t open_flags;
+} iotc_fs_memory_handle_t;
+
 #ifndef IOTC_NO_TLS_LAYER
-    {.file_name = IOTC_GLOBAL_CERTIFICATE_FILE_NAME_DEF,
-     .stat_handler_function = &iotc_fs_memory_stat_builtin_cert,
-     .open_handler_function = &iotc_fs_memory_open_builtin_cert,
-     .resource_state = IOTC_FS_MEMORY_RESOURCE_STATE_CLOSED,
-     .open_counter = 0,
-     .memory_ptr = NULL}
+static iotc_fs_memory_file_t iotc_fs_memory_builtin_files[] = {
+    {.name = IOTC_GLOBAL_CERTIFICATE_FILE_NAME_DEF,
+     .builtin_data = iotc_RootCA_list,
+     .size = sizeof(iotc_RootCA_list)}};
 #endif
-};
 
-#ifndef IOTC_NO_TLS_LAYER
-iotc_state_t iotc_fs_memory_stat_builtin_cert(
-    const iotc_fs_resource_handle_t resource_id,
-    iotc_fs_stat_t* resource_stat) {
-  IOTC_UNUSED(resource_id);
+static iotc_fs_memory_file_t* iotc_fs_memory_buckets[IOTC_FS_MEMORY_BUCKETS];
+static uint8_t iotc_fs_memory_builtin_files_indexed;
+static iotc_fs_memory_handle_t iotc_fs_memory_handles[IOTC_FS_MEMORY_MAX_OPEN];
 
-  if (NULL == resource_stat) {
-    return IOTC_INVALID_PARAMETER;
+/* the bytes the written files take out of IOTC_FS_MEMORY_BUDGET */
+static size_t iotc_fs_memory_used;
+
+/* guards the index, the handles and the budget, the I/O threads of
+ * iotc_set_io_threads() reach them at the same time */
+static struct iotc_critical_section_s iotc_fs_memory_cs = {0};
+
+/* returned by reads at the end of an empty written file */
+static const uint8_t iotc_fs_memory_empty[1] = {0};
+
+/* FNV-1a */
+static uint32_t iotc_fs_memory_hash(const char* name) {
+  uint32_t hash = 2166136261u;
+
+  for (; '\0' != *name; ++name) {
+    hash ^= (uint8_t)*name;
+    hash *= 16777619u;
   }
 
-  /* update the resource size by taking it from the compiled in array */
-  resource_stat->resource_size = sizeof(iotc_RootCA_list);
+  return hash;
+}
 
-  return IOTC_STATE_OK;
+static iotc_fs_memory_file_t** iotc_fs_memory_bucket(uint32_t name_hash) {
+  return &iotc_fs_memory_buckets[name_hash & (IOTC_FS_MEMORY_BUCKETS - 1)];
 }
 
-iotc_state_t iotc_fs_memory_open_builtin_cert(
-    const iotc_fs_resource_handle_t resource_id) {
-  assert(resource_id >= 0);
-  assert(resource_id < (signed)IOTC_ARRAYSIZE(IOTC_FS_MEMORY_DATABASE));
+static void iotc_fs_memory_index(iotc_fs_memory_file_t* file) {
+  iotc_fs_memory_file_t** bucket = iotc_fs_memory_bucket(file->name_hash);
 
-  iotc_fs_memory_database_t* const entry =
-      &IOTC_FS_MEMORY_DATABASE[resource_id];
+  file->__next = *bucket;
+  *bucket = file;
+}
 
-  entry->memory_ptr = iotc_RootCA_list;
+static void iotc_fs_memory_unindex(iotc_fs_memory_file_t* file) {
+  iotc_fs_memory_file_t** link = iotc_fs_memory_bucket(file->name_hash);
 
-  return IOTC_STATE_OK;
+  for (; NULL != *link; link = &(*link)->__next) {
+    if (file == *link) {
+      *link = file->__next;
+      file->__next = NULL;
+      return;
+    }
+  }
 }
+
+/* the compiled in files join the index on the first lookup */
+static void iotc_fs_memory_index_builtin_files(void) {
+  if (iotc_fs_memory_builtin_files_indexed) {
+    return;
+  }
+
+#ifndef IOTC_NO_TLS_LAYER
+  size_t i = 0;
+
+  for (; i < IOTC_ARRAYSIZE(iotc_fs_memory_builtin_files); ++i) {
+    iotc_fs_memory_file_t* file = &iotc_fs_memory_builtin_files[i];
+
+    file->name_hash = iotc_fs_memory_hash(file->name);
+    iotc_fs_memory_index(file);
+  }
 #endif
 
-inline static iotc_state_t iotc_fs_memory_find_entry(
-    const char* resource_name, iotc_fs_resource_handle_t* resource_id) {
-  const size_t database_size = IOTC_ARRAYSIZE(IOTC_FS_MEMORY_DATABASE);
+  iotc_fs_memory_builtin_files_indexed = 1;
+}
 
+static iotc_fs_memory_file_t* iotc_fs_memory_find_entry(
+    const char* resource_name, uint32_t name_hash) {
   // PRE-CONDITIONS
   assert(NULL != resource_name);
-  assert(NULL != resource_id);
 
+  iotc_fs_memory_index_builtin_files();
+
+  iotc_fs_memory_file_t* file = *iotc_fs_memory_bucket(name_hash);
+
+  for (; NULL != file; file = file->__next) {
+    if (name_hash == file->name_hash &&
+        0 == strcmp(resource_name, file->name)) {
+      return file;
+    }
+  }
+
+  return NULL;
+}
+
+static size_t iotc_fs_memory_file_cost(const char* resource_name) {
+  return sizeof(iotc_fs_memory_file_t) + strlen(resource_name) + 1;
+}
+
+static iotc_fs_memory_file_t* iotc_fs_memory_create_file(
+    const char* resource_name, uint32_t name_hash) {
+  const size_t cost = iotc_fs_memory_file_cost(resource_name);
+  iotc_fs_memory_file_t* file = NULL;
+  char* name = NULL;
+
+  if (IOTC_FS_MEMORY_BUDGET - iotc_fs_memory_used < cost) {
+    return NULL;
+  }
+
+  file = (iotc_fs_memory_file_t*)iotc_calloc(1, sizeof(iotc_fs_memory_file_t));
+  name = (char*)iotc_alloc(strlen(resource_name) + 1);
+
+  if (NULL == file || NULL == name) {
+    iotc_free(file);
+    iotc_free(name);
+    return NULL;
+  }
+
+  strcpy(name, resource_name);
+
+  file->name = name;
+  file->name_hash = name_hash;
+
+  iotc_fs_memory_used += cost;
+  iotc_fs_memory_index(file);
+
+  return file;
+}
+
+static void iotc_fs_memory_free_file(iotc_fs_memory_file_t* file) {
   size_t i = 0;
 
-  *resource_id = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  assert(NULL == file->builtin_data);
 
-  for (; i < database_size; ++i) {
-    if (0 == strcmp(resource_name, IOTC_FS_MEMORY_DATABASE[i].file_name)) {
-      /* update the return resource_id parameter value */
-      *resource_id = (iotc_fs_resource_handle_t)i;
+  for (; i < file->block_count; ++i) {
+    iotc_free(file->blocks[i]);
+  }
+
+  iotc_fs_memory_used -= file->block_count * IOTC_FS_MEMORY_BLOCK_SIZE +
+                         iotc_fs_memory_file_cost(file->name);
+
+  iotc_free(file->blocks);
+  iotc_free((char*)file->name);
+  iotc_free(file);
+}
+
+/* adds the blocks up to the offset, zeroed so the gaps read as zeros */
+static iotc_state_t iotc_fs_memory_reserve(iotc_fs_memory_file_t* file,
+                                           size_t end_offset) {
+  const size_t block_count =
+      (end_offset + IOTC_FS_MEMORY_BLOCK_SIZE - 1) / IOTC_FS_MEMORY_BLOCK_SIZE;
+
+  if (block_count <= file->block_count) {
+    return IOTC_STATE_OK;
+  }
 
-      /* bail out as early as it's possible */
-      return IOTC_STATE_OK;
+  if ((IOTC_FS_MEMORY_BUDGET - iotc_fs_memory_used) /
+          IOTC_FS_MEMORY_BLOCK_SIZE <
+      block_count - file->block_count) {
+    return IOTC_OUT_OF_MEMORY;
+  }
+
+  if (file->block_capacity < block_count) {
+    const size_t block_capacity =
+        IOTC_MAX(block_count, 2 * file->block_capacity);
+    /* not every allocator takes a NULL pointer to realloc */
+    uint8_t** blocks =
+        (NULL == file->blocks)
+            ? (uint8_t**)iotc_alloc(block_capacity * sizeof(uint8_t*))
+            : (uint8_t**)iotc_realloc(file->blocks,
+                                      block_capacity * sizeof(uint8_t*));
+
+    if (NULL == blocks) {
+      return IOTC_OUT_OF_MEMORY;
     }
+
+    file->blocks = blocks;
+    file->block_capacity = block_capacity;
   }
 
-  return IOTC_FS_RESOURCE_NOT_AVAILABLE;
-}
+  while (file->block_count < block_count) {
+    uint8_t* block = (uint8_t*)iotc_calloc(1, IOTC_FS_MEMORY_BLOCK_SIZE);
 
-iotc_state_t iotc_fs_stat(const void* context,
-                          const iotc_fs_resource_type_t resource_type,
-                          const char* const resource_name,
-                          iotc_fs_stat_t* resource_stat) {
-  IOTC_UNUSED(context);
+    if (NULL == block) {
+      return IOTC_OUT_OF_MEMORY;
+    }
 
-  iotc_state_t ret = IOTC_FS_RESOURCE_NOT_AVAILABLE;
-  iotc_fs_resource_handle_t resource_id = iotc_fs_init_resource_handle();
+    file->blocks[file->block_count++] = block;
+    iotc_fs_memory_used += IOTC_FS_MEMORY_BLOCK_SIZE;
+  }
 
-  if (NULL == resource_stat || NULL == resource_name) {
-    return IOTC_INVALID_PARAMETER;
+  return IOTC_STATE_OK;
+}
+
+static iotc_fs_memory_handle_t* iotc_fs_memory_get_handle(
+    const iotc_fs_resource_handle_t resource_handle) {
+  if (resource_handle < 0 ||
+      resource_handle >= (iotc_fs_resource_handle_t)IOTC_FS_MEMORY_MAX_OPEN ||
+      NULL == iotc_fs_memory_handles[resource_handle].file) {
+    return NULL;
   }
 
+  return &iotc_fs_memory_handles[resource_handle];
+}
+
+static uint8_t iotc_fs_memory_is_valid_type(
+    const iotc_fs_resource_type_t resource_type) {
   switch (resource_type) {
     case IOTC_FS_CERTIFICATE:
     case IOTC_FS_CREDENTIALS:
     case IOTC_FS_CONFIG_DATA:
-      ret = iotc_fs_memory_find_entry(resource_name, &resource_id);
-      break;
+      return 1;
     default:
-      assert(0);
-      ret = IOTC_INTERNAL_ERROR;
+      return 0;
+  }
+}
+
+static iotc_state_t iotc_fs_memory_stat(
+    const void* context, const iotc_fs_resource_type_t resource_type,
+    const char* const resource_name, iotc_fs_stat_t* resource_stat) {
+  IOTC_UNUSED(context);
+
+  if (NULL == resource_stat || NULL == resource_name) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  if (!iotc_fs_memory_is_valid_type(resource_type)) {
+    assert(0);
+    return IOTC_INTERNAL_ERROR;
   }
 
-  if (IOTC_STATE_OK == ret) {
-    return (*IOTC_FS_MEMORY_DATABASE[resource_id].stat_handler_function)(
-        resource_id, resource_stat);
+  const iotc_fs_memory_file_t* file = iotc_fs_memory_find_entry(
+      resource_name, iotc_fs_memory_hash(resource_name));
+
+  if (NULL == file) {
+    return IOTC_FS_RESOURCE_NOT_AVAILABLE;
   }
 
-  return IOTC_FS_RESOURCE_NOT_AVAILABLE;
+  resource_stat->resource_size = file->size;
+
+  return IOTC_STATE_OK;
 }
 
-iotc_state_t iotc_fs_open(const void* context,
-                          const iotc_fs_resource_type_t resource_type,
-                          const char* const resource_name,
-                          const iotc_fs_open_flags_t open_flags,
-                          iotc_fs_resource_handle_t* resource_handle) {
+static iotc_state_t iotc_fs_memory_open(
+    const void* context, const iotc_fs_resource_type_t resource_type,
+    const char* const resource_name, const iotc_fs_open_flags_t open_flags,
+    iotc_fs_resource_handle_t* resource_handle) {
   IOTC_UNUSED(resource_type);
   IOTC_UNUSED(context);
 
@@ -177,49 +321,72 @@ iotc_state_t iotc_fs_open(const void* context,
     return IOTC_INVALID_PARAMETER;
   }
 
-  /* it's read only filesystem */
-  if (IOTC_FS_OPEN_WRITE == (open_flags & IOTC_FS_OPEN_WRITE) ||
-      IOTC_FS_OPEN_APPEND == (open_flags & IOTC_FS_OPEN_APPEND)) {
+  /* append isn't supported, writes take an offset */
+  if (IOTC_FS_OPEN_APPEND == (open_flags & IOTC_FS_OPEN_APPEND)) {
     return IOTC_FS_ERROR;
   }
 
-  iotc_state_t res = iotc_fs_memory_find_entry(resource_name, resource_handle);
+  const uint8_t write =
+      (IOTC_FS_OPEN_WRITE == (open_flags & IOTC_FS_OPEN_WRITE));
+  const uint32_t name_hash = iotc_fs_memory_hash(resource_name);
+  iotc_fs_memory_file_t* file =
+      iotc_fs_memory_find_entry(resource_name, name_hash);
+  iotc_fs_resource_handle_t i = 0;
 
-  if (IOTC_STATE_OK == res) {
-    /* PRE-CONDITION */
-    assert(*resource_handle >= 0);
-    assert(*resource_handle < (signed)IOTC_ARRAYSIZE(IOTC_FS_MEMORY_DATABASE));
+  *resource_handle = iotc_fs_init_resource_handle();
 
-    iotc_fs_memory_database_t* const entry =
-        &IOTC_FS_MEMORY_DATABASE[*resource_handle];
+  /* the compiled in files are read only */
+  if (NULL != file && NULL != file->builtin_data && write) {
+    return IOTC_FS_ERROR;
+  }
 
-    entry->resource_state = IOTC_FS_MEMORY_RESOURCE_STATE_OPEN;
-    entry->open_counter += 1;
+  for (; i < (iotc_fs_resource_handle_t)IOTC_FS_MEMORY_MAX_OPEN; ++i) {
+    if (NULL == iotc_fs_memory_handles[i].file) {
+      break;
+    }
+  }
 
-    /* PRE-CONDITION */
-    assert(NULL != entry->open_handler_function);
+  if ((iotc_fs_resource_handle_t)IOTC_FS_MEMORY_MAX_OPEN == i) {
+    return IOTC_FS_OPEN_ERROR;
+  }
 
-    return entry->open_handler_function(*resource_handle);
+  /* a file is created only when the caller asks for it */
+  if (NULL == file) {
+    if (!write ||
+        IOTC_FS_OPEN_CREATE != (open_flags & IOTC_FS_OPEN_CREATE)) {
+      return IOTC_FS_RESOURCE_NOT_AVAILABLE;
+    }
+
+    file = iotc_fs_memory_create_file(resource_name, name_hash);
+
+    if (NULL == file) {
+      return IOTC_OUT_OF_MEMORY;
+    }
   }
 
-  return res;
+  file->open_counter += 1;
+
+  iotc_fs_memory_handles[i].file = file;
+  iotc_fs_memory_handles[i].open_flags = open_flags;
+
+  *resource_handle = i;
+
+  return IOTC_STATE_OK;
 }
 
-iotc_state_t iotc_fs_read(const void* context,
-                          const iotc_fs_resource_handle_t resource_handle,
-                          const size_t offset, const uint8_t** buffer,
-                          size_t* const buffer_size) {
+static iotc_state_t iotc_fs_memory_read(
+    const void* context, const iotc_fs_resource_handle_t resource_handle,
+    const size_t offset, const uint8_t** buffer, size_t* const buffer_size) {
   IOTC_UNUSED(context);
 
-  const size_t database_size = IOTC_ARRAYSIZE(IOTC_FS_MEMORY_DATABASE);
-
-  if (IOTC_FS_INVALID_RESOURCE_HANDLE == resource_handle ||
-      resource_handle > (iotc_fs_resource_handle_t)database_size) {
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE == resource_handle) {
     return IOTC_INVALID_PARAMETER;
   }
 
-  if (IOTC_FS_MEMORY_RESOURCE_STATE_OPEN !=
-      IOTC_FS_MEMORY_DATABASE[resource_handle].resource_state) {
+  const iotc_fs_memory_handle_t* handle =
+      iotc_fs_memory_get_handle(resource_handle);
+
+  if (NULL == handle) {
     return IOTC_FS_ERROR;
   }
 
@@ -231,96 +398,209 @@ iotc_state_t iotc_fs_read(const void* context,
     return IOTC_INVALID_PARAMETER;
   }
 
-  iotc_fs_stat_t resource_stat;
+  const iotc_fs_memory_file_t* file = handle->file;
+
+  /* calculate the real offset by picking the min of ( offset value, size ) */
+  const size_t real_offset = IOTC_MIN(offset, file->size);
+
+  if (NULL != file->builtin_data) {
+    *buffer = file->builtin_data + real_offset;
+    *buffer_size = IOTC_MIN(file->size - real_offset, iotc_fs_buffer_size);
+  } else if (real_offset == file->size) {
+    *buffer = iotc_fs_memory_empty;
+    *buffer_size = 0;
+  } else {
+    /* the rest of the block the offset is in */
+    const size_t block_offset = real_offset % IOTC_FS_MEMORY_BLOCK_SIZE;
+
+    *buffer = file->blocks[real_offset / IOTC_FS_MEMORY_BLOCK_SIZE] +
+              block_offset;
+    *buffer_size = IOTC_MIN(IOTC_FS_MEMORY_BLOCK_SIZE - block_offset,
+                            file->size - real_offset);
+  }
+
+  return IOTC_STATE_OK;
+}
+
+static iotc_state_t iotc_fs_memory_write(
+    const void* context, const iotc_fs_resource_handle_t resource_handle,
+    const uint8_t* const buffer, const size_t buffer_size, const size_t offset,
+    size_t* const bytes_written) {
+  IOTC_UNUSED(context);
+
+  iotc_state_t ret = IOTC_STATE_OK;
+  const iotc_fs_memory_handle_t* handle =
+      iotc_fs_memory_get_handle(resource_handle);
 
-  const iotc_fs_memory_database_t* const entry =
-      &IOTC_FS_MEMORY_DATABASE[resource_handle];
+  /* only a file opened for writing takes writes */
+  if (NULL == handle ||
+      IOTC_FS_OPEN_WRITE != (handle->open_flags & IOTC_FS_OPEN_WRITE)) {
+    return IOTC_FS_ERROR;
+  }
 
-  // PRE-CONDITION
-  assert(NULL != entry->stat_handler_function);
+  if (NULL == buffer || NULL == bytes_written ||
+      SIZE_MAX - offset < buffer_size) {
+    return IOTC_INVALID_PARAMETER;
+  }
 
-  iotc_state_t res =
-      entry->stat_handler_function(resource_handle, &resource_stat);
+  iotc_fs_memory_file_t* file = handle->file;
+  size_t position = offset;
+  size_t left = buffer_size;
 
-  if (IOTC_STATE_OK == res) {
-    /* calculate the real offset by picking the min of
-     * ( offset value, size ) */
-    intptr_t real_offset =
-        (intptr_t)(IOTC_MIN(offset, resource_stat.resource_size));
+  *bytes_written = 0;
 
-    /* update the return pointer with the proper information */
-    *buffer = (const uint8_t*)((intptr_t)entry->memory_ptr + real_offset);
+  IOTC_CHECK_STATE(ret = iotc_fs_memory_reserve(file, offset + buffer_size));
 
-    /* update the size of the buffer to be returned taking into account chunk
-     * size */
-    *buffer_size = IOTC_MIN(resource_stat.resource_size - real_offset,
-                            iotc_fs_buffer_size);
+  while (0 < left) {
+    const size_t block_offset = position % IOTC_FS_MEMORY_BLOCK_SIZE;
+    const size_t count =
+        IOTC_MIN(left, IOTC_FS_MEMORY_BLOCK_SIZE - block_offset);
+
+    memcpy(file->blocks[position / IOTC_FS_MEMORY_BLOCK_SIZE] + block_offset,
+           buffer + (position - offset), count);
+
+    position += count;
+    left -= count;
   }
 
-  return res;
+  file->size = IOTC_MAX(file->size, offset + buffer_size);
+  *bytes_written = buffer_size;
+
+err_handling:
+  return ret;
 }
 
-iotc_state_t iotc_fs_write(const void* context,
-                           const iotc_fs_resource_handle_t resource_handle,
-                           const uint8_t* const buffer,
-                           const size_t buffer_size, const size_t offset,
-                           size_t* const bytes_written) {
+static iotc_state_t iotc_fs_memory_close(
+    const void* context, const iotc_fs_resource_handle_t resource_handle) {
   IOTC_UNUSED(context);
-  IOTC_UNUSED(resource_handle);
-  IOTC_UNUSED(buffer);
-  IOTC_UNUSED(buffer_size);
-  IOTC_UNUSED(offset);
-  IOTC_UNUSED(bytes_written);
-
-  /* writing is forbidden as this is read only filesystem */
-  return IOTC_FS_ERROR;
+
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE == resource_handle) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc_fs_memory_handle_t* handle = iotc_fs_memory_get_handle(resource_handle);
+
+  if (NULL == handle) {
+    return IOTC_FS_ERROR;
+  }
+
+  iotc_fs_memory_file_t* file = handle->file;
+
+  handle->file = NULL;
+  file->open_counter -= 1;
+
+  if (0 == file->open_counter && file->removed) {
+    iotc_fs_memory_free_file(file);
+  }
+
+  return IOTC_STATE_OK;
 }
 
-iotc_state_t iotc_fs_close(const void* context,
-                           const iotc_fs_resource_handle_t resource_handle) {
+static iotc_state_t iotc_fs_memory_remove(
+    const void* context, const iotc_fs_resource_type_t resource_type,
+    const char* const resource_name) {
   IOTC_UNUSED(context);
 
-  const size_t database_size = IOTC_ARRAYSIZE(IOTC_FS_MEMORY_DATABASE);
-
-  if (IOTC_FS_INVALID_RESOURCE_HANDLE == resource_handle ||
-      resource_handle > (iotc_fs_resource_handle_t)database_size) {
+  if (NULL == resource_name || !iotc_fs_memory_is_valid_type(resource_type)) {
     return IOTC_INVALID_PARAMETER;
   }
 
-  iotc_fs_memory_database_t* const entry =
-      &IOTC_FS_MEMORY_DATABASE[resource_handle];
+  iotc_fs_memory_file_t* file = iotc_fs_memory_find_entry(
+      resource_name, iotc_fs_memory_hash(resource_name));
 
-  if (IOTC_FS_MEMORY_RESOURCE_STATE_OPEN != entry->resource_state) {
+  if (NULL == file) {
+    return IOTC_FS_RESOURCE_NOT_AVAILABLE;
+  }
+
+  /* the compiled in files can't be removed */
+  if (NULL != file->builtin_data) {
     return IOTC_FS_ERROR;
   }
 
-  entry->open_counter -= 1;
+  /* an open file goes away with its last close, the name is free at once */
+  iotc_fs_memory_unindex(file);
 
-  if (0 == entry->open_counter) {
-    entry->memory_ptr = NULL;
-    entry->resource_state = IOTC_FS_MEMORY_RESOURCE_STATE_CLOSED;
+  if (0 < file->open_counter) {
+    file->removed = 1;
+  } else {
+    iotc_fs_memory_free_file(file);
   }
 
   return IOTC_STATE_OK;
 }
 
+/* the filesystem API, each call holds the lock of the filesystem */
+
+iotc_state_t iotc_fs_stat(const void* context,
+                          const iotc_fs_resource_type_t resource_type,
+                          const char* const resource_name,
+                          iotc_fs_stat_t* resource_stat) {
+  /* just to satisfy the compiler */
+  (void)iotc_fs_memory_cs;
+
+  iotc_lock_critical_section(&iotc_fs_memory_cs);
+  const iotc_state_t state = iotc_fs_memory_stat(context, resource_type,
+                                                 resource_name, resource_stat);
+  iotc_unlock_critical_section(&iotc_fs_memory_cs);
+
+  return state;
+}
+
+iotc_state_t iotc_fs_open(const void* context,
+                          const iotc_fs_resource_type_t resource_type,
+                          const char* const resource_name,
+                          const iotc_fs_open_flags_t open_flags,
+                          iotc_fs_resource_handle_t* resource_handle) {
+  iotc_lock_critical_section(&iotc_fs_memory_cs);
+  const iotc_state_t state = iotc_fs_memory_open(
+      context, resource_type, resource_name, open_flags, resource_handle);
+  iotc_unlock_critical_section(&iotc_fs_memory_cs);
+
+  return state;
+}
+
+iotc_state_t iotc_fs_read(const void* context,
+                          const iotc_fs_resource_handle_t resource_handle,
+                          const size_t offset, const uint8_t** buffer,
+                          size_t* const buffer_size) {
+  iotc_lock_critical_section(&iotc_fs_memory_cs);
+  const iotc_state_t state = iotc_fs_memory_read(context, resource_handle,
+                                                 offset, buffer, buffer_size);
+  iotc_unlock_critical_section(&iotc_fs_memory_cs);
+
+  return state;
+}
+
+iotc_state_t iotc_fs_write(const void* context,
+                           const iotc_fs_resource_handle_t resource_handle,
+                           const uint8_t* const buffer,
+                           const size_t buffer_size, const size_t offset,
+                           size_t* const bytes_written) {
+  iotc_lock_critical_section(&iotc_fs_memory_cs);
+  const iotc_state_t state =
+      iotc_fs_memory_write(context, resource_handle, buffer, buffer_size,
+                           offset, bytes_written);
+  iotc_unlock_critical_section(&iotc_fs_memory_cs);
+
+  return state;
+}
+
+iotc_state_t iotc_fs_close(const void* context,
+                           const iotc_fs_resource_handle_t resource_handle) {
+  iotc_lock_critical_section(&iotc_fs_memory_cs);
+  const iotc_state_t state = iotc_fs_memory_close(context, resource_handle);
+  iotc_unlock_critical_section(&iotc_fs_memory_cs);
+
+  return state;
+}
+
 iotc_state_t iotc_fs_remove(const void* context,
                             const iotc_fs_resource_type_t resource_type,
                             const char* const resource_name) {
-  IOTC_UNUSED(context);
-  IOTC_UNUSED(resource_type);
-  IOTC_UNUSED(resource_name);
-
-  iotc_state_t ret = IOTC_FS_ERROR;
-  iotc_fs_resource_handle_t resource_id = iotc_fs_init_resource_handle();
-
-  switch (resource_type) {
-    case IOTC_FS_CERTIFICATE:
-    case IOTC_FS_CREDENTIALS:
-    case IOTC_FS_CONFIG_DATA:
-      ret = iotc_fs_memory_find_entry(resource_name, &resource_id);
-  }
+  iotc_lock_critical_section(&iotc_fs_memory_cs);
+  const iotc_state_t state =
+      iotc_fs_memory_remove(context, resource_type, resource_name);
+  iotc_unlock_critical_section(&iotc_fs_memory_cs);
 
-  return (ret == IOTC_STATE_OK) ? IOTC_FS_ERROR
-                                : IOTC_FS_RESOURCE_NOT_AVAILABLE;
+  return state;
 }
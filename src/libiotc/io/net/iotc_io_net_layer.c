@@ -18,6 +18,7 @@
 #include "iotc_bsp_io_net.h"
 #include "iotc_io_net_layer_state.h"
 
+#include "iotc_atomic.h"
 #include "iotc_connection_data.h"
 #include "iotc_coroutine.h"
 #include "iotc_debug.h"
@@ -28,6 +29,12 @@
 #include "iotc_globals.h"
 #include "iotc_io_timeouts.h"
 
+/* the MQTT codec sends a header and a payload, a few more parts leave room for
+ * batching messages */
+#ifndef IOTC_IO_NET_WRITE_MAX_CHUNKS
+#define IOTC_IO_NET_WRITE_MAX_CHUNKS 8
+#endif
+
 iotc_state_t iotc_io_net_layer_connect(void* context, void* data,
                                        iotc_state_t in_out_state) {
   IOTC_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -131,6 +138,36 @@ err_handling:
   return IOTC_PROCESS_CONNECT_ON_THIS_LAYER(context, data, in_out_state);
 }
 
+/* Collects the unwritten parts of a descriptor chain, e.g. an MQTT header
+ * followed by the payload it shares with the message, so that they can be
+ * handed to the socket with one call. */
+static size_t iotc_io_net_layer_gather(iotc_data_desc_t* buffer,
+                                       iotc_bsp_io_net_chunk_t* chunks,
+                                       size_t max_chunks) {
+  size_t chunk_count = 0;
+
+  for (; NULL != buffer && chunk_count < max_chunks; buffer = buffer->__next) {
+    if (buffer->curr_pos < buffer->capacity) {
+      chunks[chunk_count].buf = buffer->data_ptr + buffer->curr_pos;
+      chunks[chunk_count].count = buffer->capacity - buffer->curr_pos;
+      ++chunk_count;
+    }
+  }
+
+  return chunk_count;
+}
+
+/* Moves the write positions of a descriptor chain forward by len bytes. */
+static void iotc_io_net_layer_advance(iotc_data_desc_t* buffer, size_t len) {
+  for (; NULL != buffer && len > 0; buffer = buffer->__next) {
+    const size_t written =
+        IOTC_MIN(len, (size_t)(buffer->capacity - buffer->curr_pos));
+
+    buffer->curr_pos += written;
+    len -= written;
+  }
+}
+
 iotc_state_t iotc_io_net_layer_push(void* context, void* data,
                                     iotc_state_t in_out_state) {
   IOTC_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -141,69 +178,71 @@ iotc_state_t iotc_io_net_layer_push(void* context, void* data,
       (iotc_io_net_layer_state_t*)IOTC_THIS_LAYER(context)->user_data;
 
   iotc_data_desc_t* buffer = (iotc_data_desc_t*)data;
-  size_t left = 0;
+  iotc_bsp_io_net_chunk_t chunks[IOTC_IO_NET_WRITE_MAX_CHUNKS];
+  size_t chunk_count = 0;
   int len = 0;
   iotc_bsp_io_net_state_t bsp_state = IOTC_BSP_IO_NET_STATE_OK;
 
   /* check if the layer has been disconnected */
   if (IOTC_THIS_LAYER_NOT_OPERATIONAL(context) || layer_data == NULL) {
     iotc_debug_logger("layer not operational");
-    iotc_free_desc(&buffer);
+    iotc_free_desc_chain(&buffer);
 
     return IOTC_STATE_OK;
   }
 
-  if (buffer != 0 && buffer->capacity > 0) {
-    do {
-      /* call bsp write */
-      bsp_state = iotc_bsp_io_net_write(layer_data->socket, &len,
-                                        buffer->data_ptr + buffer->curr_pos,
-                                        buffer->capacity - buffer->curr_pos);
-
-      /* verify the state if it's an error or a need to wait */
-      if (IOTC_BSP_IO_NET_STATE_OK != bsp_state || len < 0) {
-        if (IOTC_BSP_IO_NET_STATE_BUSY ==
-            bsp_state) /* that can happen in asynch environments */
-        {
-          /* mark the socket for wake-up call */
-          if (0 > iotc_evtd_continue_when_evt_on_socket(
-                      IOTC_CONTEXT_DATA(context)->evtd_instance,
-                      IOTC_EVENT_WANT_WRITE,
-                      iotc_make_handle(&iotc_io_net_layer_push, context, data,
-                                       IOTC_STATE_WANT_WRITE),
-                      layer_data->socket)) {
-            iotc_debug_format("given socket is not registered - [%d]",
-                              (int)layer_data->socket);
-            return IOTC_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER(
-                context, 0, IOTC_INTERNAL_ERROR);
-          }
-
-          /* this is not an error so we can leave the coroutine within this
-           * state */
-          iotc_debug_format("yield in write - [%d]", (int)layer_data->socket);
-          return IOTC_STATE_OK;
-        } else if (IOTC_BSP_IO_NET_STATE_CONNECTION_RESET == bsp_state) {
-          iotc_free_desc(&buffer);
-          iotc_debug_logger("connection reset");
+  while (0 < (chunk_count = iotc_io_net_layer_gather(
+                  buffer, chunks, IOTC_IO_NET_WRITE_MAX_CHUNKS))) {
+    /* call bsp write, a single buffer doesn't need a gather write */
+    bsp_state = (1 == chunk_count)
+                    ? iotc_bsp_io_net_write(layer_data->socket, &len,
+                                            chunks[0].buf, chunks[0].count)
+                    : iotc_bsp_io_net_writev(layer_data->socket, &len, chunks,
+                                             chunk_count);
+    iotc_atomic_add_u32(&iotc_globals.io_stats.socket_writes, 1);
+
+    /* verify the state if it's an error or a need to wait */
+    if (IOTC_BSP_IO_NET_STATE_OK != bsp_state || len < 0) {
+      if (IOTC_BSP_IO_NET_STATE_BUSY ==
+          bsp_state) /* that can happen in asynch environments */
+      {
+        /* mark the socket for wake-up call */
+        if (0 > iotc_evtd_continue_when_evt_on_socket(
+                    IOTC_CONTEXT_DATA(context)->evtd_instance,
+                    IOTC_EVENT_WANT_WRITE,
+                    iotc_make_handle(&iotc_io_net_layer_push, context, data,
+                                     IOTC_STATE_WANT_WRITE),
+                    layer_data->socket)) {
+          iotc_debug_format("given socket is not registered - [%d]",
+                            (int)layer_data->socket);
           return IOTC_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER(
-              context, 0, IOTC_CONNECTION_RESET_BY_PEER_ERROR);
-        } else {
-          /* any other issue */
-          iotc_debug_format("error writing: BSP error code = %d, len = %d\n",
-                            (int)bsp_state, len);
-          iotc_free_desc(&buffer);
-          return IOTC_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER(
-              context, data, IOTC_SOCKET_WRITE_ERROR);
+              context, 0, IOTC_INTERNAL_ERROR);
         }
+
+        /* this is not an error so we can leave the coroutine within this
+         * state */
+        iotc_debug_format("yield in write - [%d]", (int)layer_data->socket);
+        return IOTC_STATE_OK;
+      } else if (IOTC_BSP_IO_NET_STATE_CONNECTION_RESET == bsp_state) {
+        iotc_free_desc_chain(&buffer);
+        iotc_debug_logger("connection reset");
+        return IOTC_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER(
+            context, 0, IOTC_CONNECTION_RESET_BY_PEER_ERROR);
+      } else {
+        /* any other issue */
+        iotc_debug_format("error writing: BSP error code = %d, len = %d\n",
+                          (int)bsp_state, len);
+        iotc_free_desc_chain(&buffer);
+        return IOTC_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER(
+            context, data, IOTC_SOCKET_WRITE_ERROR);
       }
+    }
 
-      buffer->curr_pos += len;
-      left = buffer->capacity - buffer->curr_pos;
-    } while (left > 0);
+    iotc_io_net_layer_advance(buffer, (size_t)len);
   }
 
   iotc_debug_format("%d bytes written", len);
-  iotc_free_desc(&buffer);
+  iotc_free_desc_chain(&buffer);
 
   return IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, 0, IOTC_STATE_WRITTEN);
 }
@@ -229,18 +268,24 @@ iotc_state_t iotc_io_net_layer_pull(void* context, void* data,
     return IOTC_STATE_OK;
   }
 
-  if (data) /* let's reuse already allocated buffer */
-  {
+  const size_t buffer_size =
+      iotc_atomic_load_size(&iotc_globals.receive_buffer_size);
+
+  /* let's reuse already allocated buffer unless the size has changed since */
+  if (data) {
     buffer_desc = (iotc_data_desc_t*)data;
 
-    memset(buffer_desc->data_ptr, 0, IOTC_IO_BUFFER_SIZE);
-    assert(buffer_desc->capacity == IOTC_IO_BUFFER_SIZE);  // sanity check
+    if (buffer_desc->capacity != buffer_size) {
+      iotc_free_desc(&buffer_desc);
+    } else {
+      buffer_desc->curr_pos = 0;
+      buffer_desc->length = 0;
+    }
+  }
 
-    buffer_desc->curr_pos = 0;
-    buffer_desc->length = 0;
-  } else /* if there was no buffer we have to create new one */
-  {
-    buffer_desc = iotc_make_empty_desc_alloc(IOTC_IO_BUFFER_SIZE);
+  /* if there was no buffer we have to create new one */
+  if (NULL == buffer_desc) {
+    buffer_desc = iotc_make_empty_desc_alloc(buffer_size);
     IOTC_CHECK_MEMORY(buffer_desc, in_out_state);
   }
 
@@ -280,8 +325,9 @@ iotc_state_t iotc_io_net_layer_pull(void* context, void* data,
   if (IOTC_CONTEXT_DATA(context)->io_timeouts->elem_no > 0 &&
       IOTC_CONTEXT_DATA(context)->connection_data->connection_timeout > 0) {
     iotc_io_timeouts_restart(
-        iotc_globals.evtd_instance,
-        IOTC_CONTEXT_DATA(context)->connection_data->connection_timeout,
+        IOTC_CONTEXT_DATA(context)->evtd_instance,
+        IOTC_SEC_TO_MSEC(
+            IOTC_CONTEXT_DATA(context)->connection_data->connection_timeout),
         IOTC_CONTEXT_DATA(context)->io_timeouts);
   }
 
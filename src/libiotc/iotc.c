@@ -20,9 +20,10 @@
 
 #include "iotc.h"
 #include "iotc_allocator.h"
-#include "iotc_backoff_lut_config.h"
+#include "iotc_atomic.h"
 #include "iotc_backoff_status_api.h"
 #include "iotc_common.h"
+#include "iotc_config.h"
 #include "iotc_connection_data_internal.h"
 #include "iotc_debug.h"
 #include "iotc_event_loop.h"
@@ -31,6 +32,7 @@
 #include "iotc_helpers.h"
 #include "iotc_internals.h"
 #include "iotc_jwt.h"
+#include "iotc_jwt_rotation.h"
 #include "iotc_layer.h"
 #include "iotc_layer_api.h"
 #include "iotc_layer_chain.h"
@@ -39,11 +41,15 @@
 #include "iotc_layer_macros.h"
 #include "iotc_list.h"
 #include "iotc_macros.h"
+#include "iotc_mem_pool.h"
+#include "iotc_mqtt_logic_layer_task_helpers.h"
+#include "iotc_offline_queue.h"
 #include "iotc_timed_task.h"
 #include "iotc_version.h"
 
 #include "iotc_layer_stack.h"
 
+#include "iotc_thread_io_loop.h"
 #include "iotc_thread_threadpool.h"
 
 #include "iotc_user_sub_call_wrapper.h"
@@ -84,19 +90,140 @@ void iotc_set_network_timeout(uint32_t timeout) {
 
 uint32_t iotc_get_network_timeout(void) { return iotc_globals.network_timeout; }
 
+iotc_state_t iotc_set_receive_buffer_size(size_t size) {
+  if (IOTC_IO_BUFFER_SIZE_MIN > size || IOTC_IO_BUFFER_SIZE_MAX < size) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc_atomic_store_size(&iotc_globals.receive_buffer_size, size);
+
+  return IOTC_STATE_OK;
+}
+
+size_t iotc_get_receive_buffer_size(void) {
+  return iotc_atomic_load_size(&iotc_globals.receive_buffer_size);
+}
+
+iotc_state_t iotc_set_publish_coalescing(size_t max_bytes,
+                                         uint32_t max_delay_ms) {
+  if (IOTC_PUBLISH_COALESCING_MAX_BYTES < max_bytes) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  /* the I/O threads read the settings at any time, each on its own */
+  iotc_atomic_store_size(&iotc_globals.publish_coalescing_max_bytes, max_bytes);
+  iotc_atomic_store_u32(&iotc_globals.publish_coalescing_max_delay_ms,
+                        max_delay_ms);
+
+  return IOTC_STATE_OK;
+}
+
+/* the I/O threads keep counting while the statistics are read or reset, each
+ * counter is loaded and stored on its own */
+void iotc_get_io_stats(iotc_io_stats_t* out_stats) {
+  iotc_io_stats_t* const stats = &iotc_globals.io_stats;
+
+  if (NULL == out_stats) {
+    return;
+  }
+
+  memset(out_stats, 0, sizeof(*out_stats));
+
+  out_stats->messages_sent = iotc_atomic_load_u32(&stats->messages_sent);
+  out_stats->socket_writes = iotc_atomic_load_u32(&stats->socket_writes);
+  out_stats->tls_records = iotc_atomic_load_u32(&stats->tls_records);
+  out_stats->borrowed_payloads =
+      iotc_atomic_load_u32(&stats->borrowed_payloads);
+  out_stats->borrowed_payload_bytes =
+      iotc_atomic_load_u64(&stats->borrowed_payload_bytes);
+  out_stats->tls_handshakes = iotc_atomic_load_u32(&stats->tls_handshakes);
+  out_stats->tls_resumed_handshakes =
+      iotc_atomic_load_u32(&stats->tls_resumed_handshakes);
+  out_stats->tls_handshake_time_ms =
+      iotc_atomic_load_u64(&stats->tls_handshake_time_ms);
+}
+
+void iotc_reset_io_stats(void) {
+  iotc_io_stats_t* const stats = &iotc_globals.io_stats;
+
+  iotc_atomic_store_u32(&stats->messages_sent, 0);
+  iotc_atomic_store_u32(&stats->socket_writes, 0);
+  iotc_atomic_store_u32(&stats->tls_records, 0);
+  iotc_atomic_store_u32(&stats->borrowed_payloads, 0);
+  iotc_atomic_store_u64(&stats->borrowed_payload_bytes, 0);
+  iotc_atomic_store_u32(&stats->tls_handshakes, 0);
+  iotc_atomic_store_u32(&stats->tls_resumed_handshakes, 0);
+  iotc_atomic_store_u64(&stats->tls_handshake_time_ms, 0);
+}
+
+iotc_state_t iotc_set_io_threads(uint8_t num_of_threads) {
+#ifndef IOTC_MODULE_THREAD_ENABLED
+  return (0 == num_of_threads) ? IOTC_STATE_OK : IOTC_NOT_SUPPORTED;
+#else
+  if (IOTC_MAX_IO_THREADS < num_of_threads) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  /* the contexts keep the I/O loop they were created on */
+  if (0 != iotc_globals.globals_ref_count) {
+    return IOTC_ALREADY_INITIALIZED;
+  }
+
+  iotc_globals.io_threads = num_of_threads;
+
+  return IOTC_STATE_OK;
+#endif
+}
+
 /*
  * MAIN LIBRARY FUNCTIONS
  */
+/* the objects every publish round-trip allocates and frees, a descriptor
+ * block also fits a borrowed descriptor and a tuple block holds four
+ * pointers */
+#define IOTC_MEM_POOL_BLOCK(type, size, count) \
+  { (type), (size) + IOTC_ALLOC_OVERHEAD, (count) }
+
+static const iotc_mem_pool_config_t iotc_mem_pool_config[] = {
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_DATA_DESC,
+                        sizeof(iotc_data_desc_borrowed_t),
+                        IOTC_MEM_POOL_DATA_DESC_COUNT),
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_MQTT_MESSAGE, sizeof(iotc_mqtt_message_t),
+                        IOTC_MEM_POOL_MQTT_MESSAGE_COUNT),
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_MQTT_TASK, sizeof(iotc_mqtt_logic_task_t),
+                        IOTC_MEM_POOL_MQTT_TASK_COUNT),
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_MQTT_TASK_DATA,
+                        sizeof(iotc_mqtt_task_specific_data_t),
+                        IOTC_MEM_POOL_MQTT_TASK_DATA_COUNT),
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_TUPLE, 4 * sizeof(void*),
+                        IOTC_MEM_POOL_TUPLE_COUNT),
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_BUFFER, IOTC_MEM_POOL_BUFFER_SIZE,
+                        IOTC_MEM_POOL_BUFFER_COUNT),
+    IOTC_MEM_POOL_BLOCK(IOTC_MEM_POOL_EVENT_HANDLE,
+                        sizeof(iotc_event_handle_queue_t),
+                        IOTC_MEM_POOL_EVENT_HANDLE_COUNT)};
+
 iotc_state_t iotc_initialize() {
   iotc_bsp_time_init();
   iotc_bsp_rng_init();
 
-  return IOTC_STATE_OK;
+  const iotc_state_t state = iotc_mem_pool_create(
+      iotc_mem_pool_config, IOTC_ARRAYSIZE(iotc_mem_pool_config));
+
+  /* the pools outlive a shutdown that still had blocks in use */
+  return (IOTC_ALREADY_INITIALIZED == state) ? IOTC_STATE_OK : state;
 }
 
 iotc_state_t iotc_shutdown() {
+#ifndef IOTC_NO_TLS_LAYER
+  iotc_tls_layer_shutdown();
+#endif
+
   iotc_bsp_rng_shutdown();
 
+  /* a failure keeps the pools for the blocks still in use */
+  iotc_mem_pool_destroy();
+
   return IOTC_STATE_OK;
 }
 
@@ -118,18 +245,20 @@ iotc_state_t iotc_create_context_with_custom_layers_and_evtd(
   if (1 == iotc_globals.globals_ref_count) {
     iotc_globals.evtd_instance = iotc_evtd_create_instance();
 
-    IOTC_CHECK_STATE(iotc_backoff_configure_using_data(
-        (iotc_vector_elem_t*)IOTC_BACKOFF_LUT,
-        (iotc_vector_elem_t*)IOTC_DECAY_LUT, IOTC_ARRAYSIZE(IOTC_BACKOFF_LUT),
-        IOTC_MEMORY_TYPE_UNMANAGED));
-
     IOTC_CHECK_MEMORY(iotc_globals.evtd_instance, state);
 
     /* Note: this is NULL if thread module is disabled. */
-    iotc_globals.main_threadpool = iotc_threadpool_create_instance(1);
+    iotc_globals.main_threadpool =
+        iotc_threadpool_create_instance(IOTC_MAIN_THREADPOOL_THREADS);
 
     iotc_globals.context_handles_vector = iotc_vector_create();
     iotc_globals.timed_tasks_container = iotc_make_timed_task_container();
+
+    uint8_t i = 0;
+    for (; i < iotc_globals.io_threads; ++i) {
+      iotc_globals.io_loops[i] = iotc_io_loop_create_instance();
+      IOTC_CHECK_MEMORY(iotc_globals.io_loops[i], state);
+    }
   }
 
   /* Allocate the structure to store new context. */
@@ -139,10 +268,29 @@ iotc_state_t iotc_create_context_with_custom_layers_and_evtd(
   (*context)->context_data.io_timeouts = iotc_vector_create();
 
   IOTC_CHECK_MEMORY((*context)->context_data.io_timeouts, state);
-  /* Set the event dispatcher to the global one, if none is provided. */
+
+  (*context)->context_data.in_flight_window_messages =
+      IOTC_IN_FLIGHT_WINDOW_MAX_MESSAGES;
+  (*context)->context_data.in_flight_window_bytes =
+      IOTC_IN_FLIGHT_WINDOW_MAX_BYTES;
+
+  iotc_backoff_init(&(*context)->context_data.backoff_status);
+
+  /* Set the event dispatcher to the global one or to the one of the next I/O
+   * loop, if none is provided. */
+  if (NULL == event_dispatcher && 0 < iotc_globals.io_threads) {
+    const uint32_t io_loop =
+        iotc_atomic_fetch_add_u32(&iotc_globals.next_io_loop, 1);
+    (*context)->context_data.io_loop =
+        iotc_globals.io_loops[io_loop % iotc_globals.io_threads];
+    event_dispatcher = iotc_io_loop_get_evtd((*context)->context_data.io_loop);
+  }
+
   (*context)->context_data.evtd_instance = (NULL == event_dispatcher)
                                                ? iotc_globals.evtd_instance
                                                : event_dispatcher;
+  (*context)->context_data.backoff_status.evtd_instance =
+      (*context)->context_data.evtd_instance;
 
   /* copy given numeric parameters as is */
   (*context)->protocol = IOTC_MQTT;
@@ -201,17 +349,23 @@ static void iotc_free_context_data(iotc_context_t* context) {
 
   assert(NULL != context_data);
 
+  iotc_cancel_backoff_event(&context_data->backoff_status);
+
+  iotc_jwt_rotation_release(context_data);
+
+  iotc_offline_queue_destroy(context_data);
+
   /* Destroy timeout. */
   iotc_vector_destroy(context_data->io_timeouts);
 
   /* See comment in iotc_types_internal.h. */
   if (context_data->copy_of_handlers_for_topics) {
-    iotc_vector_for_each(context_data->copy_of_handlers_for_topics,
-                         &iotc_mqtt_task_spec_data_free_subscribe_data_vec,
-                         NULL, 0);
+    iotc_topic_trie_for_each(
+        context_data->copy_of_handlers_for_topics,
+        &iotc_mqtt_task_spec_data_free_subscribe_data_trie, NULL);
 
     context_data->copy_of_handlers_for_topics =
-        iotc_vector_destroy(context_data->copy_of_handlers_for_topics);
+        iotc_topic_trie_destroy(context_data->copy_of_handlers_for_topics);
   }
 
   if (context_data->copy_of_q12_unacked_messages_queue) {
@@ -222,6 +376,18 @@ static void iotc_free_context_data(iotc_context_t* context) {
         &context_data->copy_of_q12_unacked_messages_queue);
   }
 
+  if (context_data->copy_of_unsent_tasks_queue) {
+    assert(NULL != context_data->copy_of_q12_unacked_messages_queue_dtor_ptr);
+    context_data->copy_of_q12_unacked_messages_queue_dtor_ptr(
+        &context_data->copy_of_unsent_tasks_queue);
+  }
+
+  if (context_data->copy_of_tls_session) {
+    assert(NULL != context_data->copy_of_tls_session_dtor_ptr);
+    context_data->copy_of_tls_session_dtor_ptr(
+        &context_data->copy_of_tls_session);
+  }
+
   {
     uint16_t id_file = 0;
     for (; id_file < context_data->updateable_files_count; ++id_file) {
@@ -236,6 +402,7 @@ static void iotc_free_context_data(iotc_context_t* context) {
   /* Remember: event dispatcher ownership is not taken, this is why we don't
    * delete it. */
   context_data->evtd_instance = NULL;
+  context_data->io_loop = NULL;
 }
 
 iotc_state_t iotc_delete_context_with_custom_layers(
@@ -264,8 +431,13 @@ iotc_state_t iotc_delete_context_with_custom_layers(
   iotc_globals.globals_ref_count -= 1;
 
   if (0 == iotc_globals.globals_ref_count) {
-    iotc_cancel_backoff_event();
-    iotc_backoff_release();
+    uint8_t i = 0;
+    for (; i < IOTC_MAX_IO_THREADS; ++i) {
+      iotc_io_loop_destroy_instance(&iotc_globals.io_loops[i]);
+    }
+
+    iotc_atomic_store_u32(&iotc_globals.next_io_loop, 0);
+
     iotc_evtd_destroy_instance(iotc_globals.evtd_instance);
     iotc_globals.evtd_instance = NULL;
     iotc_threadpool_destroy_instance(&iotc_globals.main_threadpool);
@@ -332,10 +504,25 @@ extern uint8_t iotc_is_context_connected(iotc_context_handle_t iotc_h) {
          IOTC_SHUTDOWN_UNINITIALISED == iotc->context_data.shutdown_state;
 }
 
-void iotc_events_stop() { iotc_evtd_stop(iotc_globals.evtd_instance); }
+void iotc_events_stop() {
+  iotc_evtd_stop(iotc_globals.evtd_instance);
+
+  uint8_t i = 0;
+  for (; i < IOTC_MAX_IO_THREADS && NULL != iotc_globals.io_loops[i]; ++i) {
+    iotc_io_loop_stop(iotc_globals.io_loops[i]);
+  }
+}
 
 void iotc_events_process_blocking() {
   iotc_event_loop_with_evtds(0, &iotc_globals.evtd_instance, 1);
+
+  /* the contexts may be deleted once this returns, so the I/O loops must be
+   * done with them */
+  uint8_t i = 0;
+  for (; i < IOTC_MAX_IO_THREADS && NULL != iotc_globals.io_loops[i]; ++i) {
+    iotc_io_loop_stop(iotc_globals.io_loops[i]);
+    iotc_io_loop_join(iotc_globals.io_loops[i]);
+  }
 }
 
 iotc_state_t iotc_events_process_tick() {
@@ -347,6 +534,39 @@ iotc_state_t iotc_events_process_tick() {
   return IOTC_EVENT_PROCESS_STOPPED;
 }
 
+/* a context served by an I/O loop only touches its layers on the loop's
+ * thread, any other thread hands its requests over through the loop's evtd */
+static uint8_t iotc_is_handoff_needed(const iotc_context_t* iotc) {
+  return NULL != iotc->context_data.io_loop &&
+         0 == iotc_io_loop_is_current_thread(iotc->context_data.io_loop);
+}
+
+static iotc_state_t iotc_push_task_on_io_loop(void* context, void* data) {
+  iotc_context_t* iotc = (iotc_context_t*)context;
+  iotc_mqtt_logic_task_t* task = (iotc_mqtt_logic_task_t*)data;
+
+  return IOTC_PROCESS_PUSH_ON_THIS_LAYER(
+      &iotc->layer_chain.top->layer_connection, task, IOTC_STATE_OK);
+}
+
+/* registers the execution of the next init */
+static iotc_state_t iotc_schedule_connect(void* context) {
+  iotc_context_t* iotc = (iotc_context_t*)context;
+  iotc_layer_t* input_layer = iotc->layer_chain.top;
+
+  const uint32_t new_backoff =
+      iotc_get_backoff_penalty(&iotc->context_data.backoff_status);
+
+  iotc_debug_format("new backoff value: %u ms", new_backoff);
+
+  return iotc_evtd_execute_in(
+      iotc->context_data.evtd_instance,
+      iotc_make_handle(input_layer->layer_connection.self->layer_funcs->init,
+                       &input_layer->layer_connection,
+                       iotc->context_data.connection_data, IOTC_STATE_OK),
+      new_backoff, &iotc->context_data.connect_handler);
+}
+
 iotc_state_t iotc_connect(iotc_context_handle_t iotc_h, const char* username,
                           const char* password, const char* client_id,
                           uint16_t connection_timeout,
@@ -365,41 +585,12 @@ iotc_state_t iotc_connect(iotc_context_handle_t iotc_h, const char* username,
                          client_callback);
 }
 
-iotc_state_t iotc_connect_to(iotc_context_handle_t iotc_h, const char* host,
-                             uint16_t port, const char* username,
-                             const char* password, const char* client_id,
-                             uint16_t connection_timeout,
-                             uint16_t keepalive_timeout,
-                             iotc_user_callback_t* client_callback) {
+/* applies a connect request on the thread of the context, params carries the
+ * connection parameters only */
+static iotc_state_t iotc_connect_impl(iotc_context_t* iotc,
+                                      const iotc_connection_data_t* params,
+                                      iotc_user_callback_t* client_callback) {
   iotc_state_t state = IOTC_STATE_OK;
-  iotc_context_t* iotc = NULL;
-  iotc_event_handle_t event_handle = iotc_make_empty_event_handle();
-  iotc_layer_t* input_layer = NULL;
-  uint32_t new_backoff = 0;
-
-  IOTC_CHECK_CND_DBGMESSAGE(NULL == host, IOTC_NULL_HOST, state,
-                            "ERROR: NULL host provided");
-
-  IOTC_CHECK_CND_DBGMESSAGE(NULL == client_id, IOTC_NULL_CLIENT_ID_ERROR, state,
-                            "ERROR: NULL client_id provided");
-
-  IOTC_CHECK_CND_DBGMESSAGE(IOTC_INVALID_CONTEXT_HANDLE >= iotc_h,
-                            IOTC_NULL_CONTEXT, state,
-                            "ERROR: invalid context handle provided");
-  if (NULL == username) {
-    username = "";
-  }
-
-  iotc = iotc_object_for_handle(iotc_globals.context_handles_vector, iotc_h);
-
-  IOTC_CHECK_CND_DBGMESSAGE(NULL == iotc, IOTC_NULL_CONTEXT, state,
-                            "ERROR: NULL context provided");
-
-  assert(NULL != client_callback);
-
-  event_handle = iotc_make_threaded_handle(
-      IOTC_THREADID_THREAD_0, &iotc_user_callback_wrapper, iotc, NULL,
-      IOTC_STATE_OK, (void*)client_callback);
 
   /* Guard against adding two connection requests. */
   if (NULL != iotc->context_data.connect_handler.ptr_to_position) {
@@ -426,23 +617,29 @@ iotc_state_t iotc_connect_to(iotc_context_handle_t iotc_h, const char* host,
     return IOTC_ALREADY_INITIALIZED;
   }
 
-  input_layer = iotc->layer_chain.top;
   iotc->protocol = IOTC_MQTT;
 
   if (NULL != iotc->context_data.connection_data) {
-    IOTC_CHECK_STATE(iotc_connection_data_update_lastwill(
-        iotc->context_data.connection_data, host, port, username, password,
-        client_id, connection_timeout, keepalive_timeout, IOTC_SESSION_CLEAN,
-        NULL, NULL, (iotc_mqtt_qos_t)0, (iotc_mqtt_retain_t)0));
+    IOTC_CHECK_STATE(state = iotc_connection_data_update_lastwill(
+        iotc->context_data.connection_data, params->host, params->port,
+        params->username, params->password, params->client_id,
+        params->connection_timeout, params->keepalive_timeout,
+        IOTC_SESSION_CLEAN, NULL, NULL, (iotc_mqtt_qos_t)0,
+        (iotc_mqtt_retain_t)0));
   } else {
     iotc->context_data.connection_data = iotc_alloc_connection_data_lastwill(
-        host, port, username, password, client_id, connection_timeout,
-        keepalive_timeout, IOTC_SESSION_CLEAN, NULL, NULL, (iotc_mqtt_qos_t)0,
-        (iotc_mqtt_retain_t)0);
+        params->host, params->port, params->username, params->password,
+        params->client_id, params->connection_timeout,
+        params->keepalive_timeout, IOTC_SESSION_CLEAN, NULL, NULL,
+        (iotc_mqtt_qos_t)0, (iotc_mqtt_retain_t)0);
 
     IOTC_CHECK_MEMORY(iotc->context_data.connection_data, state);
   }
 
+  /* a context that rotates its JWT signs the password itself */
+  IOTC_CHECK_STATE(state =
+                       iotc_jwt_rotation_update_password(&iotc->context_data));
+
   iotc_debug_format("New host:port [%s]:[%hu]",
                     iotc->context_data.connection_data->host,
                     iotc->context_data.connection_data->port);
@@ -455,30 +652,158 @@ iotc_state_t iotc_connect_to(iotc_context_handle_t iotc_h, const char* host,
   iotc->context_data.shutdown_state = IOTC_SHUTDOWN_UNINITIALISED;
 
   /* Set the connection callback. */
-  iotc->context_data.connection_callback = event_handle;
+  iotc->context_data.connection_callback = iotc_make_threaded_handle(
+      IOTC_THREADID_ANYTHREAD, &iotc_user_callback_wrapper, iotc, NULL,
+      IOTC_STATE_OK, (void*)client_callback);
 
-  new_backoff = iotc_get_backoff_penalty();
+  IOTC_CHECK_STATE(state = iotc_schedule_connect(iotc));
 
-  iotc_debug_format("new backoff value: %d", new_backoff);
+  return IOTC_STATE_OK;
 
-  /* Register the execution in next init. */
-  state = iotc_evtd_execute_in(
-      iotc->context_data.evtd_instance,
-      iotc_make_handle(input_layer->layer_connection.self->layer_funcs->init,
-                       &input_layer->layer_connection,
-                       iotc->context_data.connection_data, IOTC_STATE_OK),
-      new_backoff, &iotc->context_data.connect_handler);
+err_handling:
+  return state;
+}
+
+/* the request has already been accepted by the caller so a rejection on the
+ * loop goes to the connection callback */
+static iotc_state_t iotc_connect_on_io_loop(void* context, void* data,
+                                            iotc_state_t in_state,
+                                            void* client_callback) {
+  IOTC_UNUSED(in_state);
+
+  iotc_context_t* iotc = (iotc_context_t*)context;
+  iotc_connection_data_t* params = (iotc_connection_data_t*)data;
 
-  IOTC_CHECK_STATE(state);
+  const iotc_state_t state =
+      iotc_connect_impl(iotc, params, (iotc_user_callback_t*)client_callback);
+
+  if (IOTC_STATE_OK != state) {
+    iotc_user_callback_wrapper(iotc, iotc->context_data.connection_data, state,
+                               client_callback);
+  }
+
+  iotc_free_connection_data(&params);
 
   return IOTC_STATE_OK;
+}
+
+iotc_state_t iotc_connect_to(iotc_context_handle_t iotc_h, const char* host,
+                             uint16_t port, const char* username,
+                             const char* password, const char* client_id,
+                             uint16_t connection_timeout,
+                             uint16_t keepalive_timeout,
+                             iotc_user_callback_t* client_callback) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_context_t* iotc = NULL;
+  iotc_connection_data_t* params = NULL;
+
+  IOTC_CHECK_CND_DBGMESSAGE(NULL == host, IOTC_NULL_HOST, state,
+                            "ERROR: NULL host provided");
+
+  IOTC_CHECK_CND_DBGMESSAGE(NULL == client_id, IOTC_NULL_CLIENT_ID_ERROR, state,
+                            "ERROR: NULL client_id provided");
+
+  IOTC_CHECK_CND_DBGMESSAGE(IOTC_INVALID_CONTEXT_HANDLE >= iotc_h,
+                            IOTC_NULL_CONTEXT, state,
+                            "ERROR: invalid context handle provided");
+  if (NULL == username) {
+    username = "";
+  }
+
+  iotc = iotc_object_for_handle(iotc_globals.context_handles_vector, iotc_h);
+
+  IOTC_CHECK_CND_DBGMESSAGE(NULL == iotc, IOTC_NULL_CONTEXT, state,
+                            "ERROR: NULL context provided");
+
+  assert(NULL != client_callback);
+
+  /* the context is only touched by the thread of its I/O loop, the request
+   * takes a copy of the parameters there */
+  if (iotc_is_handoff_needed(iotc)) {
+    params = iotc_alloc_connection_data_lastwill(
+        host, port, username, password, client_id, connection_timeout,
+        keepalive_timeout, IOTC_SESSION_CLEAN, NULL, NULL, (iotc_mqtt_qos_t)0,
+        (iotc_mqtt_retain_t)0);
+
+    IOTC_CHECK_MEMORY(params, state);
+
+    IOTC_CHECK_MEMORY(
+        iotc_evtd_execute(
+            iotc->context_data.evtd_instance,
+            iotc_make_handle(&iotc_connect_on_io_loop, iotc, params,
+                             IOTC_STATE_OK, (void*)client_callback)),
+        state);
+
+    return IOTC_STATE_OK;
+  }
+
+  /* the parameters are only read, the strings stay the caller's */
+  const iotc_connection_data_t caller_params = {
+      .host = (char*)host,
+      .username = (char*)username,
+      .password = (char*)password,
+      .client_id = (char*)client_id,
+      .port = port,
+      .connection_timeout = connection_timeout,
+      .keepalive_timeout = keepalive_timeout};
+
+  return iotc_connect_impl(iotc, &caller_params, client_callback);
 
 err_handling:
+  iotc_free_connection_data(&params);
   return state;
 }
 
+/* the MQTT logic layer sits right below the control topic layer */
+static iotc_state_t iotc_publish_admit(const iotc_context_t* iotc,
+                                       const iotc_mqtt_logic_task_t* task) {
+  return iotc_mqtt_logic_publish_admit(
+      &iotc->context_data,
+      (iotc_mqtt_logic_layer_data_t*)iotc->layer_chain.top->layer_connection
+          .prev->user_data,
+      task);
+}
+
+/* the publish has already been accepted by the caller so a rejection on the
+ * loop goes to the publish callback */
+static iotc_state_t iotc_publish_on_io_loop(void* context, void* data) {
+  iotc_context_t* iotc = (iotc_context_t*)context;
+  iotc_mqtt_logic_task_t* task = (iotc_mqtt_logic_task_t*)data;
+
+  /* the queue calls the callback once the message is delivered */
+  if (iotc_offline_queue_takes(&iotc->context_data)) {
+    const iotc_state_t state = iotc_offline_queue_append(
+        &iotc->context_data, task->data.data_u->publish.topic,
+        task->data.data_u->publish.data, task->data.mqtt_settings.qos,
+        task->data.data_u->publish.retain, task->callback);
+
+    if (IOTC_STATE_OK != state) {
+      iotc_mqtt_logic_task_defer_users_callback(
+          &iotc->layer_chain.top->layer_connection, task, state);
+    }
+
+    iotc_mqtt_logic_free_task(&task);
+
+    return IOTC_STATE_OK;
+  }
+
+  const iotc_state_t state = iotc_publish_admit(iotc, task);
+
+  if (IOTC_STATE_OK != state) {
+    iotc_mqtt_logic_task_defer_users_callback(
+        &iotc->layer_chain.top->layer_connection, task, state);
+    iotc_mqtt_logic_free_task(&task);
+
+    return IOTC_STATE_OK;
+  }
+
+  return iotc_push_task_on_io_loop(iotc, task);
+}
+
 iotc_state_t iotc_publish_data_impl(iotc_context_handle_t iotc_h,
-                                    const char* topic, iotc_data_desc_t* data,
+                                    const char* topic,
+                                    iotc_memory_type_t topic_memory_type,
+                                    iotc_data_desc_t* data,
                                     const iotc_mqtt_qos_t qos,
                                     iotc_user_callback_t* callback,
                                     void* user_data) {
@@ -494,32 +819,47 @@ iotc_state_t iotc_publish_data_impl(iotc_context_handle_t iotc_h,
   }
 
   iotc_event_handle_t event_handle = iotc_make_threaded_handle(
-      IOTC_THREADID_THREAD_0, &iotc_user_callback_wrapper, iotc, user_data,
+      IOTC_THREADID_ANYTHREAD, &iotc_user_callback_wrapper, iotc, user_data,
       IOTC_STATE_OK, (void*)callback);
 
   assert(IOTC_EVENT_HANDLE_ARGC4 == event_handle.handle_type ||
          IOTC_EVENT_HANDLE_UNSET == event_handle.handle_type);
 
-  if (IOTC_BACKOFF_CLASS_NONE != iotc_globals.backoff_status.backoff_class) {
-    iotc_free_desc(&data);
-    return IOTC_BACKOFF_TERMINAL;
-  }
-
   iotc_mqtt_qos_t effective_qos = qos;
 
   iotc_mqtt_logic_task_t* task = NULL;
   iotc_state_t state = IOTC_STATE_OK;
   iotc_layer_t* input_layer = iotc->layer_chain.top;
 
-  iotc_mqtt_logic_layer_data_t* layer_data =
-      (iotc_mqtt_logic_layer_data_t*)input_layer->user_data;
+  task = iotc_mqtt_logic_make_publish_task(topic, topic_memory_type, data,
+                                           effective_qos, (iotc_mqtt_retain_t)0,
+                                           event_handle);
 
-  IOTC_UNUSED(layer_data);
+  IOTC_CHECK_MEMORY(task, state);
 
-  task = iotc_mqtt_logic_make_publish_task(topic, data, effective_qos,
-                                           (iotc_mqtt_retain_t)0, event_handle);
+  if (iotc_is_handoff_needed(iotc)) {
+    IOTC_CHECK_MEMORY(
+        iotc_evtd_execute(iotc->context_data.evtd_instance,
+                          iotc_make_handle(&iotc_publish_on_io_loop, iotc,
+                                           task)),
+        state);
 
-  IOTC_CHECK_MEMORY(task, state);
+    return IOTC_STATE_OK;
+  }
+
+  /* the queue calls the callback once the message is delivered */
+  if (iotc_offline_queue_takes(&iotc->context_data)) {
+    IOTC_CHECK_STATE(state = iotc_offline_queue_append(
+                         &iotc->context_data, task->data.data_u->publish.topic,
+                         task->data.data_u->publish.data, effective_qos,
+                         task->data.data_u->publish.retain, task->callback));
+
+    iotc_mqtt_logic_free_task(&task);
+
+    return IOTC_STATE_OK;
+  }
+
+  IOTC_CHECK_STATE(state = iotc_publish_admit(iotc, task));
 
   return IOTC_PROCESS_PUSH_ON_THIS_LAYER(&input_layer->layer_connection, task,
                                          IOTC_STATE_OK);
@@ -545,8 +885,8 @@ iotc_state_t iotc_publish(iotc_context_handle_t iotc_h, const char* topic,
 
   IOTC_CHECK_MEMORY(data_desc, state);
 
-  return iotc_publish_data_impl(iotc_h, topic, data_desc, qos, callback,
-                                user_data);
+  return iotc_publish_data_impl(iotc_h, topic, IOTC_MEMORY_TYPE_MANAGED,
+                                data_desc, qos, callback, user_data);
 
 err_handling:
   return state;
@@ -568,13 +908,123 @@ iotc_state_t iotc_publish_data(iotc_context_handle_t iotc_h, const char* topic,
 
   IOTC_CHECK_MEMORY(data_desc, state);
 
-  return iotc_publish_data_impl(iotc_h, topic, data_desc, qos, callback,
-                                user_data);
+  return iotc_publish_data_impl(iotc_h, topic, IOTC_MEMORY_TYPE_MANAGED,
+                                data_desc, qos, callback, user_data);
+
+err_handling:
+  return state;
+}
+
+iotc_state_t iotc_publish_data_zero_copy(
+    iotc_context_handle_t iotc_h, const char* topic, const uint8_t* data,
+    size_t data_len, const iotc_mqtt_qos_t qos, iotc_user_callback_t* callback,
+    void* user_data, iotc_publish_release_callback_t* release_callback,
+    void* release_data) {
+  /* PRE-CONDITIONS */
+  assert(NULL != topic);
+  assert(NULL != data);
+  assert(0 != data_len);
+  assert(NULL != release_callback);
+
+  iotc_state_t state = IOTC_STATE_OK;
+
+  iotc_data_desc_t* data_desc = iotc_make_desc_from_buffer_borrow(
+      data, data_len, release_callback, release_data);
+
+  IOTC_CHECK_MEMORY(data_desc, state);
+
+  iotc_atomic_add_u32(&iotc_globals.io_stats.borrowed_payloads, 1);
+  iotc_atomic_add_u64(&iotc_globals.io_stats.borrowed_payload_bytes,
+                      data_len);
+
+  /* from here on the descriptor hands the buffers back when it's freed */
+  return iotc_publish_data_impl(iotc_h, topic, IOTC_MEMORY_TYPE_UNMANAGED,
+                                data_desc, qos, callback, user_data);
 
 err_handling:
+  release_callback(data, data_len, release_data);
   return state;
 }
 
+iotc_state_t iotc_set_in_flight_window(iotc_context_handle_t iotc_h,
+                                       uint32_t max_messages,
+                                       size_t max_bytes) {
+  iotc_context_t* iotc = (iotc_context_t*)iotc_object_for_handle(
+      iotc_globals.context_handles_vector, iotc_h);
+
+  if (NULL == iotc) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc->context_data.in_flight_window_messages = max_messages;
+  iotc->context_data.in_flight_window_bytes = max_bytes;
+
+  return IOTC_STATE_OK;
+}
+
+iotc_state_t iotc_set_offline_queue(iotc_context_handle_t iotc_h,
+                                    const iotc_offline_queue_config_t* config) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_offline_queue_t* queue = NULL;
+  iotc_context_t* iotc = (iotc_context_t*)iotc_object_for_handle(
+      iotc_globals.context_handles_vector, iotc_h);
+
+  if (NULL == iotc) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  /* the queue only changes between connections */
+  if (NULL != iotc->context_data.connection_data) {
+    switch (iotc->context_data.connection_data->connection_state) {
+      case IOTC_CONNECTION_STATE_OPENING:
+      case IOTC_CONNECTION_STATE_OPENED:
+        return IOTC_ALREADY_INITIALIZED;
+      default:
+        break;
+    }
+  }
+
+  if (NULL != config) {
+    IOTC_CHECK_STATE(state = iotc_offline_queue_create(config, &queue));
+  }
+
+  iotc_offline_queue_destroy(&iotc->context_data);
+  iotc->context_data.offline_queue = queue;
+
+err_handling:
+  return state;
+}
+
+iotc_state_t iotc_set_backoff_policy(iotc_context_handle_t iotc_h,
+                                     const iotc_backoff_policy_t* policy) {
+  iotc_context_t* iotc = (iotc_context_t*)iotc_object_for_handle(
+      iotc_globals.context_handles_vector, iotc_h);
+
+  if (NULL == iotc) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  return iotc_backoff_set_policy(&iotc->context_data.backoff_status, policy);
+}
+
+iotc_state_t iotc_get_backoff_state(iotc_context_handle_t iotc_h,
+                                    iotc_backoff_state_t* out_state) {
+  iotc_context_t* iotc = (iotc_context_t*)iotc_object_for_handle(
+      iotc_globals.context_handles_vector, iotc_h);
+
+  if (NULL == iotc || NULL == out_state) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  const iotc_backoff_status_t* status = &iotc->context_data.backoff_status;
+
+  out_state->delay_ms = iotc_get_backoff_penalty(status);
+  out_state->failures = status->failures;
+  out_state->in_backoff = IOTC_BACKOFF_CLASS_NONE != status->backoff_class;
+
+  return IOTC_STATE_OK;
+}
+
 iotc_state_t iotc_subscribe(iotc_context_handle_t iotc_h, const char* topic,
                             const iotc_mqtt_qos_t qos,
                             iotc_user_subscription_callback_t* callback,
@@ -596,10 +1046,11 @@ iotc_state_t iotc_subscribe(iotc_context_handle_t iotc_h, const char* topic,
   IOTC_CHECK_MEMORY(iotc, state);
 
   event_handle = iotc_make_threaded_handle(
-      IOTC_THREADID_THREAD_0, &iotc_user_sub_call_wrapper, iotc, NULL,
+      IOTC_THREADID_ANYTHREAD, &iotc_user_sub_call_wrapper, iotc, NULL,
       IOTC_STATE_OK, (void*)callback, (void*)user_data, (void*)NULL);
 
-  if (IOTC_BACKOFF_CLASS_NONE != iotc_globals.backoff_status.backoff_class) {
+  if (IOTC_BACKOFF_CLASS_NONE !=
+      iotc->context_data.backoff_status.backoff_class) {
     return IOTC_BACKOFF_TERMINAL;
   }
 
@@ -619,6 +1070,16 @@ iotc_state_t iotc_subscribe(iotc_context_handle_t iotc_h, const char* topic,
    * subscription failure it will release the memory.) */
   task->data.data_u->subscribe.handler.handlers.h6.a6 = task->data.data_u;
 
+  if (iotc_is_handoff_needed(iotc)) {
+    IOTC_CHECK_MEMORY(
+        iotc_evtd_execute(iotc->context_data.evtd_instance,
+                          iotc_make_handle(&iotc_push_task_on_io_loop, iotc,
+                                           task)),
+        state);
+
+    return IOTC_STATE_OK;
+  }
+
   return IOTC_PROCESS_PUSH_ON_THIS_LAYER(&input_layer->layer_connection, task,
                                          IOTC_STATE_OK);
 
@@ -632,11 +1093,8 @@ err_handling:
   return state;
 }
 
-iotc_state_t iotc_shutdown_connection(iotc_context_handle_t iotc_h) {
-  assert(IOTC_INVALID_CONTEXT_HANDLE < iotc_h);
-  iotc_context_t* itoc =
-      iotc_object_for_handle(iotc_globals.context_handles_vector, iotc_h);
-  assert(NULL != itoc);
+static iotc_state_t iotc_shutdown_connection_impl(void* context) {
+  iotc_context_t* itoc = (iotc_context_t*)context;
 
   iotc_state_t state = IOTC_STATE_OK;
   iotc_layer_t* input_layer = itoc->layer_chain.top;
@@ -657,6 +1115,9 @@ iotc_state_t iotc_shutdown_connection(iotc_context_handle_t iotc_h) {
 
     IOTC_CHECK_STATE(state);
 
+    /* that may be the reconnect of a JWT rotation */
+    itoc->context_data.jwt_rotation.in_progress = 0;
+
     return IOTC_STATE_OK;
   }
 
@@ -685,13 +1146,41 @@ err_handling:
   return state;
 }
 
+iotc_state_t iotc_shutdown_connection(iotc_context_handle_t iotc_h) {
+  assert(IOTC_INVALID_CONTEXT_HANDLE < iotc_h);
+  iotc_context_t* itoc =
+      iotc_object_for_handle(iotc_globals.context_handles_vector, iotc_h);
+  assert(NULL != itoc);
+
+  /* the connection state belongs to the loop so the whole shutdown runs
+   * there */
+  if (iotc_is_handoff_needed(itoc)) {
+    return (NULL != iotc_evtd_execute(
+                        itoc->context_data.evtd_instance,
+                        iotc_make_handle(&iotc_shutdown_connection_impl, itoc)))
+               ? IOTC_STATE_OK
+               : IOTC_OUT_OF_MEMORY;
+  }
+
+  return iotc_shutdown_connection_impl(itoc);
+}
+
 iotc_timed_task_handle_t iotc_schedule_timed_task(
     iotc_context_handle_t iotc_h, iotc_user_task_callback_t* callback,
     const iotc_time_t seconds_from_now, const uint8_t repeats_forever,
     void* data) {
+  return iotc_schedule_timed_task_ms(iotc_h, callback,
+                                     IOTC_SEC_TO_MSEC(seconds_from_now),
+                                     repeats_forever, data);
+}
+
+iotc_timed_task_handle_t iotc_schedule_timed_task_ms(
+    iotc_context_handle_t iotc_h, iotc_user_task_callback_t* callback,
+    const iotc_time_t milliseconds_from_now, const uint8_t repeats_forever,
+    void* data) {
   return iotc_add_timed_task(iotc_globals.timed_tasks_container,
                              iotc_globals.evtd_instance, iotc_h, callback,
-                             seconds_from_now, repeats_forever, data);
+                             milliseconds_from_now, repeats_forever, data);
 }
 
 void iotc_cancel_timed_task(iotc_timed_task_handle_t timed_task_handle) {
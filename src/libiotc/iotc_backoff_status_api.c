@@ -14,8 +14,11 @@
  * limitations under the License.
  */
 
+#include <string.h>
+
 #include "iotc_backoff_status_api.h"
 #include "iotc_bsp_rng.h"
+#include "iotc_config.h"
 #include "iotc_globals.h"
 
 #ifdef __cplusplus
@@ -23,128 +26,101 @@ extern "C" {
 #endif
 
 /* local functions */
-static iotc_state_t iotc_apply_cooldown(void);
-
-void iotc_inc_backoff_penalty() {
-  iotc_globals.backoff_status.backoff_lut_i =
-      IOTC_MIN(iotc_globals.backoff_status.backoff_lut_i + 1,
-               iotc_globals.backoff_status.backoff_lut->elem_no - 1);
+static iotc_state_t iotc_apply_cooldown(void* status);
 
-  iotc_restart_update_time();
+static iotc_evtd_instance_t* iotc_backoff_evtd(
+    const iotc_backoff_status_t* status) {
+  return (NULL != status->evtd_instance) ? status->evtd_instance
+                                         : iotc_globals.evtd_instance;
 }
 
-void iotc_dec_backoff_penalty() {
-  iotc_globals.backoff_status.backoff_lut_i =
-      IOTC_MAX(iotc_globals.backoff_status.backoff_lut_i - 1, 0);
-}
+void iotc_backoff_init(iotc_backoff_status_t* status) {
+  assert(NULL != status);
 
-uint32_t iotc_get_backoff_penalty() {
-  const iotc_backoff_lut_index_t prev_backoff_index =
-      IOTC_MAX(iotc_globals.backoff_status.backoff_lut_i - 1, 0);
-
-  const int32_t prev_backoff_base_value =
-      iotc_globals.backoff_status.backoff_lut->array[prev_backoff_index]
-          .selector_t.ui32_value;
-
-  /* full_range = previous backoff value | 0 if index == 0 */
-  const int32_t full_range = (iotc_globals.backoff_status.backoff_lut_i == 0)
-                                 ? 0
-                                 : prev_backoff_base_value;
-
-  /* base_value = current backoff value */
-  const int32_t base_value =
-      iotc_globals.backoff_status.backoff_lut
-          ->array[iotc_globals.backoff_status.backoff_lut_i]
-          .selector_t.ui32_value;
-
-  /* half_range = max( previous backoff value * 0.5, 1 ) */
-  const int32_t half_range = IOTC_MAX(full_range / 2, 1);
-
-  /* rand_value = random( 0, full_range ) */
-  const int32_t rand_value = iotc_bsp_rng_get() % (full_range + 1);
-
-  /* backoff_value =
-   *      base_value + random( -0.5 * prev_backoff_base_value
-   *                          , 0.5 * prev_backoff_base_value )
-   * because if:
-   *
-   *      rand_value == 0:
-   *
-   *          then: backoff_value = base_value +
-   *              0 - prev_backoff_base_value * 0.5
-   *
-   *      rand_value == prev_backoff_base_value:
-   *
-   *          then: backoff_value = base_value +
-   *              prev_backoff_base_value - prev_backoff_base_value * 0.5
-   *          so: backoff_value = base_value + prev_backoff_base_value * 0.5
-   */
-  const int32_t backoff_value = base_value + rand_value - half_range;
-
-  /*
-   * Clamp the ret_value so that it's not lesser than backoff_lut[ 0 ]
-   */
-  const int32_t ret_value = IOTC_MAX(
-      backoff_value, (int32_t)iotc_globals.backoff_status.backoff_lut->array[0]
-                         .selector_t.ui32_value);
-
-  return ret_value;
-}
+  /* no time event and no penalty */
+  memset(status, 0, sizeof(iotc_backoff_status_t));
 
-void iotc_cancel_backoff_event() {
-  if (NULL != iotc_globals.backoff_status.next_update.ptr_to_position) {
-    iotc_evtd_cancel(iotc_globals.evtd_instance,
-                     &iotc_globals.backoff_status.next_update);
-  }
+  status->policy.base_ms = IOTC_BACKOFF_BASE_MS;
+  status->policy.cap_ms = IOTC_BACKOFF_CAP_MS;
+  status->policy.decay_ms = IOTC_BACKOFF_DECAY_MS;
 }
 
-#ifdef IOTC_BACKOFF_RESET
-void iotc_reset_backoff_penalty() {
-  iotc_globals.backoff_status.backoff_lut_i = 0;
-
-  iotc_cancel_backoff_event();
-}
-#endif
+iotc_state_t iotc_backoff_set_policy(iotc_backoff_status_t* status,
+                                     const iotc_backoff_policy_t* policy) {
+  assert(NULL != status);
 
-static void iotc_backoff_release_luts(void) {
-  if (iotc_globals.backoff_status.backoff_lut != NULL) {
-    iotc_globals.backoff_status.backoff_lut =
-        iotc_vector_destroy(iotc_globals.backoff_status.backoff_lut);
+  if (NULL == policy || 0 == policy->base_ms || 0 == policy->decay_ms ||
+      policy->cap_ms < policy->base_ms) {
+    return IOTC_INVALID_PARAMETER;
   }
 
-  if (iotc_globals.backoff_status.decay_lut != NULL) {
-    iotc_globals.backoff_status.decay_lut =
-        iotc_vector_destroy(iotc_globals.backoff_status.decay_lut);
+  status->policy = *policy;
+
+  if (0 != status->delay_ms) {
+    status->delay_ms =
+        IOTC_MIN(IOTC_MAX(status->delay_ms, policy->base_ms), policy->cap_ms);
   }
+
+  return IOTC_STATE_OK;
 }
 
-iotc_state_t iotc_backoff_configure_using_data(iotc_vector_elem_t* backoff_lut,
-                                               iotc_vector_elem_t* decay_lut,
-                                               size_t len,
-                                               iotc_memory_type_t memory_type) {
-  if (backoff_lut == NULL || decay_lut == NULL || len == 0) {
-    return IOTC_INVALID_PARAMETER;
+void iotc_inc_backoff_penalty(iotc_backoff_status_t* status) {
+  assert(NULL != status);
+
+  const iotc_backoff_policy_t* policy = &status->policy;
+
+  /* decorrelated jitter: random( base, 3 * previous delay ), so the delays
+   * of contexts that failed together drift apart */
+  const uint64_t prev_delay =
+      (0 == status->delay_ms) ? policy->base_ms : status->delay_ms;
+  const uint64_t upper = IOTC_MIN(3 * prev_delay, (uint64_t)policy->cap_ms);
+  const uint64_t range = upper - policy->base_ms + 1;
+
+  status->delay_ms =
+      policy->base_ms + (uint32_t)(iotc_bsp_rng_get() % range);
+
+  if (UINT32_MAX != status->failures) {
+    ++status->failures;
   }
 
-  iotc_state_t local_state = IOTC_STATE_OK;
+  iotc_restart_update_time(status);
+}
 
-  iotc_backoff_release_luts();
+void iotc_dec_backoff_penalty(iotc_backoff_status_t* status) {
+  assert(NULL != status);
 
-  iotc_globals.backoff_status.backoff_lut =
-      iotc_vector_create_from(backoff_lut, len, memory_type);
+  status->delay_ms /= 2;
 
-  IOTC_CHECK_MEMORY(iotc_globals.backoff_status.backoff_lut, local_state);
+  if (status->delay_ms < status->policy.base_ms) {
+    status->delay_ms = 0;
+    status->failures = 0;
+  } else if (0 < status->failures) {
+    --status->failures;
+  }
+}
 
-  iotc_globals.backoff_status.decay_lut =
-      iotc_vector_create_from(decay_lut, len, memory_type);
+uint32_t iotc_get_backoff_penalty(const iotc_backoff_status_t* status) {
+  assert(NULL != status);
 
-  IOTC_CHECK_MEMORY(iotc_globals.backoff_status.decay_lut, local_state);
+  return status->delay_ms;
+}
 
-err_handling:
-  return local_state;
+void iotc_cancel_backoff_event(iotc_backoff_status_t* status) {
+  assert(NULL != status);
+
+  if (NULL != status->next_update.ptr_to_position) {
+    iotc_evtd_cancel(iotc_backoff_evtd(status), &status->next_update);
+  }
 }
 
-extern void iotc_backoff_release() { iotc_backoff_release_luts(); }
+#ifdef IOTC_BACKOFF_RESET
+void iotc_reset_backoff_penalty(iotc_backoff_status_t* status) {
+  status->delay_ms = 0;
+  status->failures = 0;
+
+  iotc_cancel_backoff_event(status);
+}
+#endif
 
 iotc_backoff_class_t iotc_backoff_classify_state(const iotc_state_t state) {
   switch (state) {
@@ -162,17 +138,19 @@ iotc_backoff_class_t iotc_backoff_classify_state(const iotc_state_t state) {
   }
 }
 
-iotc_backoff_class_t iotc_update_backoff_penalty(const iotc_state_t state) {
+iotc_backoff_class_t iotc_update_backoff_penalty(iotc_backoff_status_t* status,
+                                                 const iotc_state_t state) {
+  assert(NULL != status);
+
   iotc_backoff_class_t backoff_class = iotc_backoff_classify_state(state);
 
-  iotc_globals.backoff_status.backoff_class = backoff_class;
+  status->backoff_class = backoff_class;
 
   switch (backoff_class) {
     case IOTC_BACKOFF_CLASS_TERMINAL:
     case IOTC_BACKOFF_CLASS_RECOVERABLE:
-      iotc_inc_backoff_penalty();
-      iotc_debug_format("inc backoff index: %d",
-                        iotc_globals.backoff_status.backoff_lut_i);
+      iotc_inc_backoff_penalty(status);
+      iotc_debug_format("inc backoff delay: %u ms", status->delay_ms);
       break;
     case IOTC_BACKOFF_CLASS_NONE:
       break;
@@ -184,41 +162,38 @@ iotc_backoff_class_t iotc_update_backoff_penalty(const iotc_state_t state) {
   return backoff_class;
 }
 
-iotc_state_t iotc_restart_update_time() {
+iotc_state_t iotc_restart_update_time(iotc_backoff_status_t* status) {
+  assert(NULL != status);
+
   iotc_state_t local_state = IOTC_STATE_OK;
-  iotc_evtd_instance_t* event_dispatcher = iotc_globals.evtd_instance;
-
-  if (NULL != iotc_globals.backoff_status.next_update.ptr_to_position) {
-    local_state = iotc_evtd_restart(
-        event_dispatcher, &iotc_globals.backoff_status.next_update,
-        iotc_globals.backoff_status.decay_lut
-            ->array[iotc_globals.backoff_status.backoff_lut_i]
-            .selector_t.ui32_value);
+  iotc_evtd_instance_t* event_dispatcher = iotc_backoff_evtd(status);
+
+  if (NULL != status->next_update.ptr_to_position) {
+    local_state = iotc_evtd_restart(event_dispatcher, &status->next_update,
+                                    status->policy.decay_ms);
   } else {
     local_state = iotc_evtd_execute_in(
-        event_dispatcher, iotc_make_handle(&iotc_apply_cooldown),
-        iotc_globals.backoff_status.decay_lut
-            ->array[iotc_globals.backoff_status.backoff_lut_i]
-            .selector_t.ui32_value,
-        &iotc_globals.backoff_status.next_update);
+        event_dispatcher, iotc_make_handle(&iotc_apply_cooldown, status),
+        status->policy.decay_ms, &status->next_update);
   }
 
   return local_state;
 }
 
-static iotc_state_t iotc_apply_cooldown(void) {
+static iotc_state_t iotc_apply_cooldown(void* data) {
+  iotc_backoff_status_t* status = (iotc_backoff_status_t*)data;
+
   /* clearing the event pointer is the first thing to do */
-  assert(NULL == iotc_globals.backoff_status.next_update.ptr_to_position);
+  assert(NULL == status->next_update.ptr_to_position);
 
-  if (iotc_globals.backoff_status.backoff_class == IOTC_BACKOFF_CLASS_NONE) {
-    iotc_dec_backoff_penalty();
-    iotc_debug_format("dec backoff index: %d",
-                      iotc_globals.backoff_status.backoff_lut_i);
+  if (status->backoff_class == IOTC_BACKOFF_CLASS_NONE) {
+    iotc_dec_backoff_penalty(status);
+    iotc_debug_format("dec backoff delay: %u ms", status->delay_ms);
   }
 
-  /* if the backoff lut index is greater than 0 */
-  if (iotc_globals.backoff_status.backoff_lut_i > 0) {
-    return iotc_restart_update_time();
+  /* while there is a penalty left */
+  if (status->delay_ms > 0) {
+    return iotc_restart_update_time(status);
   }
 
   return IOTC_STATE_OK;
@@ -22,6 +22,7 @@
 #include "iotc_event_dispatcher_api.h"
 
 #include <iotc_error.h>
+#include <iotc_types.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,41 +34,44 @@ typedef enum {
   IOTC_BACKOFF_CLASS_TERMINAL
 } iotc_backoff_class_t;
 
-typedef iotc_vector_index_type_t iotc_backoff_lut_index_t;
-
+/* the backoff of a single context, the delays follow the decorrelated jitter
+ * of iotc_backoff_policy_t */
 typedef struct iotc_backoff_status_s {
   iotc_time_event_handle_t next_update;
-  iotc_vector_t* backoff_lut;
-  iotc_vector_t* decay_lut;
+  /* the dispatcher of next_update, NULL is the global one */
+  iotc_evtd_instance_t* evtd_instance;
+  iotc_backoff_policy_t policy;
   iotc_backoff_class_t backoff_class;
-  iotc_backoff_lut_index_t backoff_lut_i;
+  /* failures not decayed yet */
+  uint32_t failures;
+  /* the delay of the next connection attempt, 0 without a penalty */
+  uint32_t delay_ms;
 } iotc_backoff_status_t;
 
-extern void iotc_inc_backoff_penalty();
+extern void iotc_backoff_init(iotc_backoff_status_t* status);
 
-extern void iotc_dec_backoff_penalty();
+extern iotc_state_t iotc_backoff_set_policy(
+    iotc_backoff_status_t* status, const iotc_backoff_policy_t* policy);
 
-extern uint32_t iotc_get_backoff_penalty();
+extern void iotc_inc_backoff_penalty(iotc_backoff_status_t* status);
 
-extern void iotc_cancel_backoff_event();
+extern void iotc_dec_backoff_penalty(iotc_backoff_status_t* status);
 
-#ifdef IOTC_BACKOFF_RESET
-extern void iotc_reset_backoff_penalty();
-#endif
+extern uint32_t iotc_get_backoff_penalty(const iotc_backoff_status_t* status);
 
-extern iotc_state_t iotc_backoff_configure_using_data(
-    iotc_vector_elem_t* backoff_lut, iotc_vector_elem_t* decay_lut, size_t len,
-    iotc_memory_type_t memory_type);
+extern void iotc_cancel_backoff_event(iotc_backoff_status_t* status);
 
-extern void iotc_backoff_release();
+#ifdef IOTC_BACKOFF_RESET
+extern void iotc_reset_backoff_penalty(iotc_backoff_status_t* status);
+#endif
 
 extern iotc_backoff_class_t iotc_backoff_classify_state(
     const iotc_state_t state);
 
 extern iotc_backoff_class_t iotc_update_backoff_penalty(
-    const iotc_state_t state);
+    iotc_backoff_status_t* status, const iotc_state_t state);
 
-extern iotc_state_t iotc_restart_update_time();
+extern iotc_state_t iotc_restart_update_time(iotc_backoff_status_t* status);
 
 #ifdef __cplusplus
 }
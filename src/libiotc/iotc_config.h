@@ -17,8 +17,68 @@
 #ifndef __IOTC_CONFIG_H__
 #define __IOTC_CONFIG_H__
 
+/* the default size of the buffer a connection reads into, it can be changed
+ * at runtime with iotc_set_receive_buffer_size() */
 #ifndef IOTC_IO_BUFFER_SIZE
-#define IOTC_IO_BUFFER_SIZE 32
+#define IOTC_IO_BUFFER_SIZE 4096
+#endif
+
+#ifndef IOTC_IO_BUFFER_SIZE_MIN
+#define IOTC_IO_BUFFER_SIZE_MIN 32
+#endif
+
+/* a TLS record never carries more than 16 KB of plaintext */
+#ifndef IOTC_IO_BUFFER_SIZE_MAX
+#define IOTC_IO_BUFFER_SIZE_MAX 16384
+#endif
+
+/* a coalesced batch of publishes fits in one TLS record */
+#ifndef IOTC_PUBLISH_COALESCING_MAX_BYTES
+#define IOTC_PUBLISH_COALESCING_MAX_BYTES IOTC_IO_BUFFER_SIZE_MAX
+#endif
+
+/* parts of an outgoing chain up to this size, e.g. MQTT headers and short
+ * payloads, are copied together into one TLS record, larger ones are
+ * encrypted in place as records of their own */
+#ifndef IOTC_TLS_GATHER_MAX_BYTES
+#define IOTC_TLS_GATHER_MAX_BYTES 1024
+#endif
+
+/* the number of blocks iotc_initialize() reserves for each pooled hot-path
+ * object, 0 leaves that object to the BSP allocator; the pools are off unless
+ * the build sizes them */
+#ifndef IOTC_MEM_POOL_DATA_DESC_COUNT
+#define IOTC_MEM_POOL_DATA_DESC_COUNT 0
+#endif
+
+#ifndef IOTC_MEM_POOL_MQTT_MESSAGE_COUNT
+#define IOTC_MEM_POOL_MQTT_MESSAGE_COUNT 0
+#endif
+
+#ifndef IOTC_MEM_POOL_MQTT_TASK_COUNT
+#define IOTC_MEM_POOL_MQTT_TASK_COUNT 0
+#endif
+
+#ifndef IOTC_MEM_POOL_MQTT_TASK_DATA_COUNT
+#define IOTC_MEM_POOL_MQTT_TASK_DATA_COUNT 0
+#endif
+
+#ifndef IOTC_MEM_POOL_TUPLE_COUNT
+#define IOTC_MEM_POOL_TUPLE_COUNT 0
+#endif
+
+#ifndef IOTC_MEM_POOL_EVENT_HANDLE_COUNT
+#define IOTC_MEM_POOL_EVENT_HANDLE_COUNT 0
+#endif
+
+/* small managed buffers, such as the serialised header of a message, are
+ * pooled in blocks of this size */
+#ifndef IOTC_MEM_POOL_BUFFER_COUNT
+#define IOTC_MEM_POOL_BUFFER_COUNT 0
+#endif
+
+#ifndef IOTC_MEM_POOL_BUFFER_SIZE
+#define IOTC_MEM_POOL_BUFFER_SIZE 64
 #endif
 
 #ifndef IOTC_BACKOFF_CHECK_TIME
@@ -29,12 +89,125 @@
 #define IOTC_MQTT_MAX_PAYLOAD_SIZE 1024 * 128
 #endif
 
+/* the in-flight window a new context starts with, the number of QoS 1
+ * publishes and the payload bytes they may have waiting for a PUBACK, 0 is no
+ * limit */
+#ifndef IOTC_IN_FLIGHT_WINDOW_MAX_MESSAGES
+#define IOTC_IN_FLIGHT_WINDOW_MAX_MESSAGES 0
+#endif
+
+#ifndef IOTC_IN_FLIGHT_WINDOW_MAX_BYTES
+#define IOTC_IN_FLIGHT_WINDOW_MAX_BYTES 0
+#endif
+
+/* the backoff policy a new context starts with, in milliseconds, see
+ * iotc_backoff_policy_t */
+#ifndef IOTC_BACKOFF_BASE_MS
+#define IOTC_BACKOFF_BASE_MS 2000
+#endif
+
+#ifndef IOTC_BACKOFF_CAP_MS
+#define IOTC_BACKOFF_CAP_MS 512000
+#endif
+
+#ifndef IOTC_BACKOFF_DECAY_MS
+#define IOTC_BACKOFF_DECAY_MS 30000
+#endif
+
+/* while a rotated JWT nears its expiration the context checks this often, in
+ * milliseconds, whether the connection is quiet enough to swap it */
+#ifndef IOTC_JWT_ROTATION_QUIET_CHECK_MS
+#define IOTC_JWT_ROTATION_QUIET_CHECK_MS 250
+#endif
+
+/* the offline queue batches its writes in a buffer of this many bytes and
+ * writes a partly filled one after this many milliseconds */
+#ifndef IOTC_OFFLINE_QUEUE_WRITE_BUFFER_SIZE
+#define IOTC_OFFLINE_QUEUE_WRITE_BUFFER_SIZE 4096
+#endif
+
+#ifndef IOTC_OFFLINE_QUEUE_FLUSH_MS
+#define IOTC_OFFLINE_QUEUE_FLUSH_MS 1000
+#endif
+
+/* the messages the offline queue has in flight at most, it tries again after
+ * this many milliseconds when the connection can't take more or fails one */
+#ifndef IOTC_OFFLINE_QUEUE_DRAIN_BATCH
+#define IOTC_OFFLINE_QUEUE_DRAIN_BATCH 8
+#endif
+
+#ifndef IOTC_OFFLINE_QUEUE_DRAIN_RETRY_MS
+#define IOTC_OFFLINE_QUEUE_DRAIN_RETRY_MS 100
+#endif
+
+/* the memory filesystem keeps the files written at runtime in blocks of this
+ * many bytes, the files together take at most IOTC_FS_MEMORY_BUDGET bytes */
+#ifndef IOTC_FS_MEMORY_BLOCK_SIZE
+#define IOTC_FS_MEMORY_BLOCK_SIZE 512
+#endif
+
+#ifndef IOTC_FS_MEMORY_BUDGET
+#define IOTC_FS_MEMORY_BUDGET 65536
+#endif
+
+/* the buckets of the file name index of the memory filesystem, a power of 2,
+ * and the number of files it keeps open at once */
+#ifndef IOTC_FS_MEMORY_BUCKETS
+#define IOTC_FS_MEMORY_BUCKETS 32
+#endif
+
+#ifndef IOTC_FS_MEMORY_MAX_OPEN
+#define IOTC_FS_MEMORY_MAX_OPEN 16
+#endif
+
+/* deprecated, the second based IOTC_DEFAULT_IDLE_TIMEOUT and
+ * IOTC_MAX_IDLE_TIMEOUT still set the millisecond ones below */
+#if defined(IOTC_DEFAULT_IDLE_TIMEOUT) && !defined(IOTC_DEFAULT_IDLE_TIMEOUT_MS)
+#define IOTC_DEFAULT_IDLE_TIMEOUT_MS (IOTC_DEFAULT_IDLE_TIMEOUT * 1000)
+#endif
+
+#if defined(IOTC_MAX_IDLE_TIMEOUT) && !defined(IOTC_MAX_IDLE_TIMEOUT_MS)
+#define IOTC_MAX_IDLE_TIMEOUT_MS (IOTC_MAX_IDLE_TIMEOUT * 1000)
+#endif
+
+/* the event loop waits for sockets this many milliseconds when no time event
+ * is scheduled */
+#ifndef IOTC_DEFAULT_IDLE_TIMEOUT_MS
+#define IOTC_DEFAULT_IDLE_TIMEOUT_MS 5000
+#endif
+
+/* upper bound of a single wait of the event loop, in milliseconds */
+#ifndef IOTC_MAX_IDLE_TIMEOUT_MS
+#define IOTC_MAX_IDLE_TIMEOUT_MS 5000
+#endif
+
 #ifndef IOTC_DEFAULT_IDLE_TIMEOUT
-#define IOTC_DEFAULT_IDLE_TIMEOUT 1
+#define IOTC_DEFAULT_IDLE_TIMEOUT (IOTC_DEFAULT_IDLE_TIMEOUT_MS / 1000)
 #endif
 
 #ifndef IOTC_MAX_IDLE_TIMEOUT
-#define IOTC_MAX_IDLE_TIMEOUT 5
+#define IOTC_MAX_IDLE_TIMEOUT (IOTC_MAX_IDLE_TIMEOUT_MS / 1000)
+#endif
+
+#ifndef IOTC_EVENT_LOOP_POLLER_MAX_READY_SOCKETS
+#define IOTC_EVENT_LOOP_POLLER_MAX_READY_SOCKETS 32
+#endif
+
+/* the number of call queue nodes each event dispatcher preallocates and
+ * recycles, more queued events fall back to the system allocator */
+#ifndef IOTC_EVTD_CALL_QUEUE_NODES
+#define IOTC_EVTD_CALL_QUEUE_NODES 8
+#endif
+
+/* the number of workerthreads calling the user callbacks when the thread
+ * module is enabled, callbacks of different subscriptions run in parallel */
+#ifndef IOTC_MAIN_THREADPOOL_THREADS
+#define IOTC_MAIN_THREADPOOL_THREADS 2
+#endif
+
+/* the most I/O threads iotc_set_io_threads() takes */
+#ifndef IOTC_MAX_IO_THREADS
+#define IOTC_MAX_IO_THREADS 16
 #endif
 
 #ifndef IOTC_MQTT_PORT
@@ -24,11 +24,13 @@ iotc_data_desc_t* iotc_make_empty_desc_alloc(size_t capacity) {
 
   iotc_state_t state = IOTC_STATE_OK;
 
-  IOTC_ALLOC(iotc_data_desc_t, data_desc, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_DATA_DESC, iotc_data_desc_t, data_desc,
+                    state);
 
   data_desc->memory_type = IOTC_MEMORY_TYPE_MANAGED;
 
-  IOTC_ALLOC_BUFFER_AT(unsigned char, data_desc->data_ptr, capacity, state);
+  IOTC_ALLOC_POOLED_BUFFER_AT(unsigned char, data_desc->data_ptr, capacity,
+                              state);
   data_desc->length = 0;
   data_desc->capacity = capacity;
 
@@ -39,13 +41,36 @@ err_handling:
   return NULL;
 }
 
+iotc_data_desc_t* iotc_make_empty_desc_alloc_inline(size_t capacity) {
+  assert(capacity > 0);
+
+  iotc_state_t state = IOTC_STATE_OK;
+
+  /* the buffer follows the descriptor in the same block, so marking it as
+   * unmanaged makes iotc_free_desc release both with a single free */
+  IOTC_ALLOC_BUFFER(uint8_t, block, sizeof(iotc_data_desc_t) + capacity,
+                    state);
+
+  iotc_data_desc_t* data_desc = (iotc_data_desc_t*)block;
+
+  data_desc->data_ptr = block + sizeof(iotc_data_desc_t);
+  data_desc->capacity = capacity;
+  data_desc->memory_type = IOTC_MEMORY_TYPE_UNMANAGED;
+
+  return data_desc;
+
+err_handling:
+  return NULL;
+}
+
 iotc_data_desc_t* iotc_make_desc_from_buffer_copy(unsigned const char* buffer,
                                                   size_t len) {
   assert(buffer != 0);
 
   iotc_state_t state = IOTC_STATE_OK;
 
-  IOTC_ALLOC(iotc_data_desc_t, data_desc, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_DATA_DESC, iotc_data_desc_t, data_desc,
+                    state);
   data_desc->memory_type = IOTC_MEMORY_TYPE_MANAGED;
 
   IOTC_ALLOC_BUFFER_AT(unsigned char, data_desc->data_ptr, len, state);
@@ -67,7 +92,8 @@ iotc_data_desc_t* iotc_make_desc_from_buffer_share(unsigned char* buffer,
 
   iotc_state_t state = IOTC_STATE_OK;
 
-  IOTC_ALLOC(iotc_data_desc_t, data_desc, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_DATA_DESC, iotc_data_desc_t, data_desc,
+                    state);
 
   data_desc->capacity = len;
   data_desc->length = data_desc->capacity;
@@ -81,6 +107,30 @@ err_handling:
   return NULL;
 }
 
+iotc_data_desc_t* iotc_make_desc_from_buffer_borrow(
+    const uint8_t* buffer, size_t len,
+    iotc_data_desc_release_callback_t* release_callback, void* user_data) {
+  assert(buffer != 0);
+  assert(release_callback != 0);
+
+  iotc_state_t state = IOTC_STATE_OK;
+
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_DATA_DESC, iotc_data_desc_borrowed_t,
+                    borrowed_desc, state);
+
+  borrowed_desc->desc.capacity = len;
+  borrowed_desc->desc.length = borrowed_desc->desc.capacity;
+  borrowed_desc->desc.data_ptr = (uint8_t*)buffer;
+  borrowed_desc->desc.memory_type = IOTC_MEMORY_TYPE_BORROWED;
+  borrowed_desc->release_callback = release_callback;
+  borrowed_desc->user_data = user_data;
+
+  return &borrowed_desc->desc;
+
+err_handling:
+  return NULL;
+}
+
 iotc_data_desc_t* iotc_make_desc_from_string_copy(const char* str) {
   if (NULL == str) {
     return NULL;
@@ -89,7 +139,8 @@ iotc_data_desc_t* iotc_make_desc_from_string_copy(const char* str) {
   iotc_state_t state = IOTC_STATE_OK;
   const size_t len = strlen(str);
 
-  IOTC_ALLOC(iotc_data_desc_t, data_desc, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_DATA_DESC, iotc_data_desc_t, data_desc,
+                    state);
   data_desc->memory_type = IOTC_MEMORY_TYPE_MANAGED;
 
   IOTC_ALLOC_BUFFER_AT(unsigned char, data_desc->data_ptr, len, state);
@@ -114,7 +165,8 @@ iotc_data_desc_t* iotc_make_desc_from_string_share(const char* str) {
 
   const size_t len = strlen(str);
 
-  IOTC_ALLOC(iotc_data_desc_t, data_desc, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_DATA_DESC, iotc_data_desc_t, data_desc,
+                    state);
 
   data_desc->data_ptr = (uint8_t*)str;
   data_desc->capacity = len;
@@ -135,12 +187,31 @@ void iotc_free_desc(iotc_data_desc_t** desc) {
 
     if (IOTC_MEMORY_TYPE_MANAGED == (*desc)->memory_type) {
       IOTC_SAFE_FREE((*desc)->data_ptr);
+    } else if (IOTC_MEMORY_TYPE_BORROWED == (*desc)->memory_type) {
+      const iotc_data_desc_borrowed_t* borrowed_desc =
+          (iotc_data_desc_borrowed_t*)*desc;
+
+      borrowed_desc->release_callback(borrowed_desc->desc.data_ptr,
+                                      borrowed_desc->desc.capacity,
+                                      borrowed_desc->user_data);
     }
 
     IOTC_SAFE_FREE((*desc));
   }
 }
 
+void iotc_free_desc_chain(iotc_data_desc_t** desc) {
+  if (NULL == desc) {
+    return;
+  }
+
+  while (NULL != *desc) {
+    iotc_data_desc_t* next = (*desc)->__next;
+    iotc_free_desc(desc);
+    *desc = next;
+  }
+}
+
 uint8_t iotc_data_desc_will_it_fit(const iotc_data_desc_t* const desc,
                                    size_t len) {
   assert(desc);
@@ -203,6 +274,11 @@ iotc_state_t iotc_data_desc_realloc(
     return IOTC_INVALID_PARAMETER;
   }
 
+  /* the owner of a borrowed buffer expects it back, not a copy */
+  if (IOTC_MEMORY_TYPE_BORROWED == desc->memory_type) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
   iotc_state_t ret_state = IOTC_STATE_OK;
 
   unsigned char* old = desc->data_ptr;
@@ -40,20 +40,46 @@ typedef struct data_desc_s {
 
 typedef uint32_t(iotc_data_desc_realloc_strategy_t)(uint32_t, uint32_t);
 
+typedef void(iotc_data_desc_release_callback_t)(const uint8_t* buffer,
+                                                size_t len, void* user_data);
+
+/* a borrowed descriptor carries the release callback of its owner behind the
+ * descriptor, in the same block */
+typedef struct iotc_data_desc_borrowed_s {
+  iotc_data_desc_t desc;
+  iotc_data_desc_release_callback_t* release_callback;
+  void* user_data;
+} iotc_data_desc_borrowed_t;
+
 extern iotc_data_desc_t* iotc_make_empty_desc_alloc(size_t capacity);
 
+/* Allocates the descriptor and its buffer as one block. The buffer can't be
+ * detached from the descriptor, but it can still grow through
+ * iotc_data_desc_realloc(), which moves the data to a managed buffer. */
+extern iotc_data_desc_t* iotc_make_empty_desc_alloc_inline(size_t capacity);
+
 extern iotc_data_desc_t* iotc_make_desc_from_buffer_copy(
     unsigned const char* buffer, size_t len);
 
 extern iotc_data_desc_t* iotc_make_desc_from_buffer_share(unsigned char* buffer,
                                                           size_t len);
 
+/* Shares a buffer lent by its owner. The descriptor can't grow and when it is
+ * freed release_callback gets the buffer back, so the owner knows that no
+ * descriptor refers to it any more. */
+extern iotc_data_desc_t* iotc_make_desc_from_buffer_borrow(
+    const uint8_t* buffer, size_t len,
+    iotc_data_desc_release_callback_t* release_callback, void* user_data);
+
 extern iotc_data_desc_t* iotc_make_desc_from_string_copy(const char* str);
 
 extern iotc_data_desc_t* iotc_make_desc_from_string_share(const char* str);
 
 extern void iotc_free_desc(iotc_data_desc_t** desc);
 
+/* Frees a descriptor and every descriptor linked to it through __next. */
+extern void iotc_free_desc_chain(iotc_data_desc_t** desc);
+
 extern uint8_t iotc_data_desc_will_it_fit(const iotc_data_desc_t* const,
                                           size_t len);
 
@@ -15,9 +15,14 @@
  */
 
 #include "iotc_globals.h"
+#include "iotc_config.h"
 
 iotc_globals_t iotc_globals = {
     .network_timeout = 1500,
+    .receive_buffer_size = IOTC_IO_BUFFER_SIZE,
+    .publish_coalescing_max_bytes = 0,
+    .publish_coalescing_max_delay_ms = 0,
+    .io_stats = {0, 0, 0, 0, 0},
     .globals_ref_count = 0,
     .evtd_instance = NULL,
     .default_context = NULL,
@@ -25,5 +30,6 @@ iotc_globals_t iotc_globals = {
     .context_handles_vector = NULL,
     .timed_tasks_container = NULL,
     .main_threadpool = NULL,
-    .backoff_status = {iotc_make_empty_time_event_handle(), 0, 0,
-                       IOTC_BACKOFF_CLASS_NONE, 0}};
+    .io_threads = 0,
+    .io_loops = {NULL},
+    .next_io_loop = 0};
@@ -17,9 +17,10 @@
 #ifndef __IOTC_GLOBALS_H__
 #define __IOTC_GLOBALS_H__
 
+#include <stddef.h>
 #include <stdint.h>
 
-#include "iotc_backoff_status_api.h"
+#include "iotc_config.h"
 #include "iotc_timed_task.h"
 #include "iotc_types_internal.h"
 
@@ -32,6 +33,10 @@ extern "C" {
 /* This struct is used for run-time config */
 typedef struct {
   uint32_t network_timeout;
+  size_t receive_buffer_size;
+  size_t publish_coalescing_max_bytes;
+  uint32_t publish_coalescing_max_delay_ms;
+  iotc_io_stats_t io_stats;
   uint8_t globals_ref_count;
   iotc_evtd_instance_t* evtd_instance;
   iotc_context_t* default_context;
@@ -39,7 +44,11 @@ typedef struct {
   iotc_vector_t* context_handles_vector;
   iotc_timed_task_container_t* timed_tasks_container;
   struct iotc_threadpool_s* main_threadpool;
-  iotc_backoff_status_t backoff_status;
+  /* with I/O threads each context is driven by one of the io_loops instead
+   * of evtd_instance */
+  uint8_t io_threads;
+  struct iotc_io_loop_s* io_loops[IOTC_MAX_IO_THREADS];
+  uint32_t next_io_loop;
 } iotc_globals_t;
 
 extern iotc_globals_t iotc_globals;
@@ -15,8 +15,14 @@
  */
 
 #include "iotc_handle.h"
+#include "iotc_critical_section.h"
+#include "iotc_critical_section_def.h"
 #include "iotc_types.h"
 
+/* the I/O threads and the application threads look up contexts while other
+ * contexts are created and deleted */
+static struct iotc_critical_section_s iotc_handle_cs = {0};
+
 /* -----------------------------------------------------------------------
  *  INTERNAL FUNCTIONS
  * ----------------------------------------------------------------------- */
@@ -33,16 +39,28 @@ static inline int8_t iotc_compare_context_pointers(
 
 void* iotc_object_for_handle(iotc_vector_t* vector, iotc_handle_t handle) {
   assert(vector != NULL);
-  return iotc_vector_get(vector, handle);
+
+  /* just to satisfy the compiler */
+  (void)iotc_handle_cs;
+
+  iotc_lock_critical_section(&iotc_handle_cs);
+  void* const object = iotc_vector_get(vector, handle);
+  iotc_unlock_critical_section(&iotc_handle_cs);
+
+  return object;
 }
 
 iotc_state_t iotc_find_handle_for_object(iotc_vector_t* vector,
                                          const void* object,
                                          iotc_handle_t* handle) {
   assert(vector != NULL);
+
+  iotc_lock_critical_section(&iotc_handle_cs);
   iotc_vector_index_type_t handler_index = iotc_vector_find(
       vector, IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_PTR((void*)object)),
       iotc_compare_context_pointers);
+  iotc_unlock_critical_section(&iotc_handle_cs);
+
   if (handler_index < 0) {
     *handle = IOTC_INVALID_CONTEXT_HANDLE;
     return IOTC_ELEMENT_NOT_FOUND;
@@ -54,32 +72,41 @@ iotc_state_t iotc_find_handle_for_object(iotc_vector_t* vector,
 iotc_state_t iotc_delete_handle_for_object(iotc_vector_t* vector,
                                            const void* object) {
   assert(vector != NULL);
+
+  iotc_lock_critical_section(&iotc_handle_cs);
   iotc_vector_index_type_t handler_index = iotc_vector_find(
       vector, IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_PTR((void*)object)),
       iotc_compare_context_pointers);
 
-  if (handler_index < 0) {
-    return IOTC_ELEMENT_NOT_FOUND;
+  if (0 <= handler_index) {
+    vector->array[handler_index].selector_t.ptr_value = NULL;
   }
-  vector->array[handler_index].selector_t.ptr_value = NULL;
-  return IOTC_STATE_OK;
+  iotc_unlock_critical_section(&iotc_handle_cs);
+
+  return handler_index < 0 ? IOTC_ELEMENT_NOT_FOUND : IOTC_STATE_OK;
 }
 
 iotc_state_t iotc_register_handle_for_object(iotc_vector_t* vector,
                                              const int32_t max_object_cnt,
                                              const void* object) {
   assert(vector != NULL);
+  iotc_state_t state = IOTC_STATE_OK;
+
+  iotc_lock_critical_section(&iotc_handle_cs);
   iotc_vector_index_type_t handler_index = iotc_vector_find(
       vector, IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_PTR(NULL)),
       iotc_compare_context_pointers);
   if (handler_index < 0) {
     if (vector->elem_no >= max_object_cnt) {
-      return IOTC_NO_MORE_RESOURCE_AVAILABLE;
+      state = IOTC_NO_MORE_RESOURCE_AVAILABLE;
+    } else {
+      iotc_vector_push(vector, IOTC_VEC_CONST_VALUE_PARAM(
+                                   IOTC_VEC_VALUE_PTR((void*)object)));
     }
-    iotc_vector_push(
-        vector, IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_PTR((void*)object)));
   } else {
     vector->array[handler_index].selector_t.ptr_value = (void*)object;
   }
-  return IOTC_STATE_OK;
+  iotc_unlock_critical_section(&iotc_handle_cs);
+
+  return state;
 }
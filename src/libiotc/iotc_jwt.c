@@ -15,8 +15,13 @@
  */
 
 #include "iotc_jwt.h"
+#include "iotc.h"
+#include "iotc_atomic.h"
 #include "iotc_bsp_crypto.h"
 #include "iotc_bsp_time.h"
+#include "iotc_debug.h"
+#include "iotc_helpers.h"
+#include "iotc_jwt_rotation.h"
 #include "iotc_macros.h"
 
 #include <stdio.h>
@@ -35,7 +40,8 @@
  */
 static iotc_bsp_crypto_state_t _iotc_create_iotcore_jwt_b64h_b64p(
     unsigned char* dst_string, size_t dst_string_size, size_t* bytes_written,
-    const char* project_id, uint32_t expiration_period_sec, const char* algo) {
+    const char* project_id, iotc_time_t issued_at_sec,
+    uint32_t expiration_period_sec, const char* algo) {
   iotc_bsp_crypto_state_t ret = IOTC_BSP_CRYPTO_ERROR;
   size_t bytes_written_payload = 0;
 
@@ -45,13 +51,10 @@ static iotc_bsp_crypto_state_t _iotc_create_iotcore_jwt_b64h_b64p(
            algo);
 
   // create payload
-  const iotc_time_t current_time_in_sec =
-      iotc_bsp_time_getcurrenttime_seconds();
-
   char payload[IOTC_JWT_PAYLOAD_BUF_SIZE] = {0};
   snprintf(payload, IOTC_JWT_PAYLOAD_BUF_SIZE,
-           "{\"iat\":%lld,\"exp\":%lld,\"aud\":\"%s\"}", current_time_in_sec,
-           current_time_in_sec + expiration_period_sec, project_id);
+           "{\"iat\":%lld,\"exp\":%lld,\"aud\":\"%s\"}", issued_at_sec,
+           issued_at_sec + expiration_period_sec, project_id);
 
   // base64 encode, header
   *bytes_written = 0;
@@ -80,21 +83,26 @@ err_handling:
   return ret;
 }
 
-// create the JWT: b64(h).b64(p).b64(ecc(sha256(b64(h).b64(p))))
-// h = header
-// p = payload
-// b64 = base64
-// sha = Secure Hash Algorithm
-// ecc = Elliptic Curve Cryptography
-iotc_state_t iotc_create_iotcore_jwt(
-    const char* project_id, uint32_t expiration_period_sec,
-    const iotc_crypto_key_data_t* private_key_data, char* dst_jwt_buf,
-    size_t dst_jwt_buf_len, size_t* bytes_written) {
-  if (NULL == project_id || NULL == private_key_data || NULL == dst_jwt_buf ||
-      NULL == bytes_written) {
-    return IOTC_INVALID_PARAMETER;
+static iotc_state_t _iotc_jwt_state_from_crypto(iotc_bsp_crypto_state_t ret) {
+  switch (ret) {
+    case IOTC_BSP_CRYPTO_STATE_OK:
+      return IOTC_STATE_OK;
+    case IOTC_BSP_CRYPTO_BUFFER_TOO_SMALL_ERROR:
+      return IOTC_BUFFER_TOO_SMALL_ERROR;
+    case IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR:
+      return IOTC_INVALID_PARAMETER;
+    default:
+      return IOTC_JWT_FORMATTION_ERROR;
   }
+}
 
+/**
+ * Checks the parameters shared by iotc_create_iotcore_jwt and
+ * iotc_jwt_manager_create.
+ */
+static iotc_state_t _iotc_check_iotcore_jwt_params(
+    const char* project_id, const iotc_crypto_key_data_t* private_key_data,
+    size_t* bytes_written) {
   if (IOTC_CRYPTO_KEY_SIGNATURE_ALGORITHM_ES256 !=
       private_key_data->crypto_key_signature_algorithm) {
     return IOTC_ALG_NOT_SUPPORTED_ERROR;
@@ -116,17 +124,35 @@ iotc_state_t iotc_create_iotcore_jwt(
   }
 
   if (IOTC_JWT_PROJECTID_MAX_LEN < strlen(project_id)) {
-    *bytes_written = IOTC_JWT_PROJECTID_MAX_LEN;
+    if (NULL != bytes_written) {
+      *bytes_written = IOTC_JWT_PROJECTID_MAX_LEN;
+    }
     return IOTC_JWT_PROJECTID_TOO_LONG_ERROR;
   }
 
+  return IOTC_STATE_OK;
+}
+
+// create the JWT: b64(h).b64(p).b64(ecc(sha256(b64(h).b64(p))))
+// h = header
+// p = payload
+// b64 = base64
+// sha = Secure Hash Algorithm
+// ecc = Elliptic Curve Cryptography
+//
+// signs with the prepared key if there is one, with the key data otherwise
+static iotc_state_t _iotc_sign_iotcore_jwt(
+    const char* project_id, iotc_time_t issued_at_sec,
+    uint32_t expiration_period_sec,
+    const iotc_crypto_key_data_t* private_key_data, iotc_bsp_ecc_key_t* key,
+    char* dst_jwt_buf, size_t dst_jwt_buf_len, size_t* bytes_written) {
   iotc_bsp_crypto_state_t ret = IOTC_BSP_CRYPTO_ERROR;
 
   // create base64 encoded header and payload: b64(h).b64(p)
   IOTC_CHECK_CRYPTO(ret = _iotc_create_iotcore_jwt_b64h_b64p(
                         (unsigned char*)dst_jwt_buf, dst_jwt_buf_len,
-                        bytes_written, project_id, expiration_period_sec,
-                        "ES256"));
+                        bytes_written, project_id, issued_at_sec,
+                        expiration_period_sec, "ES256"));
 
   // create sha256 hash of b64(h).b64(p): sha256(b64(h).b64(p))
   uint8_t sha256_b64h_b64p[32] = {0};
@@ -141,10 +167,16 @@ iotc_state_t iotc_create_iotcore_jwt(
   // create ecc signature: ecc(sha256(b64(h).b64(p)))
   size_t bytes_written_ecc_signature = 0;
   uint8_t ecc_signature[IOTC_JWT_MAX_SIGNATURE_SIZE] = {0};
-  IOTC_CHECK_CRYPTO(ret = iotc_bsp_ecc(private_key_data, ecc_signature,
-                                       IOTC_JWT_MAX_SIGNATURE_SIZE,
-                                       &bytes_written_ecc_signature,
-                                       sha256_b64h_b64p, 32));
+  IOTC_CHECK_CRYPTO(
+      ret = (NULL != key)
+                ? iotc_bsp_ecc_key_sign(key, ecc_signature,
+                                        IOTC_JWT_MAX_SIGNATURE_SIZE,
+                                        &bytes_written_ecc_signature,
+                                        sha256_b64h_b64p, 32)
+                : iotc_bsp_ecc(private_key_data, ecc_signature,
+                               IOTC_JWT_MAX_SIGNATURE_SIZE,
+                               &bytes_written_ecc_signature,
+                               sha256_b64h_b64p, 32));
 
   // base64 encode the ecc signature
   size_t bytes_written_ecc_signature_base64 = 0;
@@ -161,16 +193,248 @@ iotc_state_t iotc_create_iotcore_jwt(
 
 err_handling:
 
-  switch (ret) {
-    case IOTC_BSP_CRYPTO_STATE_OK:
-      return IOTC_STATE_OK;
-    case IOTC_BSP_CRYPTO_BUFFER_TOO_SMALL_ERROR:
-      return IOTC_BUFFER_TOO_SMALL_ERROR;
-    case IOTC_BSP_CRYPTO_INVALID_INPUT_PARAMETER_ERROR:
-      return IOTC_INVALID_PARAMETER;
-    default:
-      return IOTC_JWT_FORMATTION_ERROR;
+  return _iotc_jwt_state_from_crypto(ret);
+}
+
+iotc_state_t iotc_create_iotcore_jwt(
+    const char* project_id, uint32_t expiration_period_sec,
+    const iotc_crypto_key_data_t* private_key_data, char* dst_jwt_buf,
+    size_t dst_jwt_buf_len, size_t* bytes_written) {
+  if (NULL == project_id || NULL == private_key_data || NULL == dst_jwt_buf ||
+      NULL == bytes_written) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  const iotc_state_t state = _iotc_check_iotcore_jwt_params(
+      project_id, private_key_data, bytes_written);
+
+  if (IOTC_STATE_OK != state) {
+    return state;
   }
 
-  return IOTC_JWT_FORMATTION_ERROR;
+  return _iotc_sign_iotcore_jwt(
+      project_id, iotc_bsp_time_getcurrenttime_seconds(), expiration_period_sec,
+      private_key_data, NULL, dst_jwt_buf, dst_jwt_buf_len, bytes_written);
+}
+
+/*
+ * JWT MANAGER
+ */
+
+#define IOTC_JWT_MANAGER_NO_JWT UINT32_MAX
+
+/* the renewal runs every half of the expiration period */
+#define IOTC_JWT_MANAGER_MIN_EXPIRATION_SEC 2
+
+struct iotc_jwt_manager_s {
+  iotc_context_handle_t context_handle;
+  iotc_timed_task_handle_t renewal_task;
+  /* the key parsed once for all the signatures of the timed task */
+  iotc_bsp_ecc_key_t* key;
+  /* the key data for the signatures outside of the timed task */
+  iotc_crypto_key_data_t private_key_data;
+  char* project_id;
+  uint32_t expiration_period_sec;
+  /* the ready token and the one the next renewal writes, the renewal swaps
+   * them so a reader copying the ready one is never overwritten */
+  char jwts[2][IOTC_JWT_SIZE];
+  size_t jwt_lengths[2];
+  iotc_time_t expirations_sec[2];
+  uint32_t ready_jwt;
+};
+
+/* signs the token that doesn't get handed out and makes it the ready one */
+static iotc_state_t _iotc_jwt_manager_renew(iotc_jwt_manager_t* manager) {
+  const uint32_t ready_jwt =
+      iotc_atomic_load_u32(&manager->ready_jwt);
+  const uint32_t next_jwt =
+      (IOTC_JWT_MANAGER_NO_JWT == ready_jwt) ? 0 : 1 - ready_jwt;
+
+  const iotc_time_t now_sec = iotc_bsp_time_getcurrenttime_seconds();
+
+  const iotc_state_t state = _iotc_sign_iotcore_jwt(
+      manager->project_id, now_sec, manager->expiration_period_sec, NULL,
+      manager->key, manager->jwts[next_jwt], IOTC_JWT_SIZE,
+      &manager->jwt_lengths[next_jwt]);
+
+  if (IOTC_STATE_OK != state) {
+    iotc_debug_format("JWT renewal failed: %d", state);
+    return state;
+  }
+
+  manager->expirations_sec[next_jwt] =
+      now_sec + manager->expiration_period_sec;
+
+  iotc_atomic_store_u32(&manager->ready_jwt, next_jwt);
+
+  return IOTC_STATE_OK;
+}
+
+static void _iotc_jwt_manager_renewal_task(
+    const iotc_context_handle_t context_handle,
+    const iotc_timed_task_handle_t timed_task_handle, void* user_data) {
+  IOTC_UNUSED(context_handle);
+  IOTC_UNUSED(timed_task_handle);
+
+  _iotc_jwt_manager_renew((iotc_jwt_manager_t*)user_data);
+}
+
+iotc_state_t iotc_jwt_manager_create(
+    iotc_context_handle_t iotc_h, const char* project_id,
+    uint32_t expiration_period_sec,
+    const iotc_crypto_key_data_t* private_key_data,
+    iotc_jwt_manager_t** out_manager) {
+  if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_h || NULL == project_id ||
+      NULL == private_key_data || NULL == out_manager ||
+      IOTC_JWT_MANAGER_MIN_EXPIRATION_SEC > expiration_period_sec) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_bsp_crypto_state_t crypto_state = IOTC_BSP_CRYPTO_STATE_OK;
+  iotc_jwt_manager_t* manager = NULL;
+
+  *out_manager = NULL;
+
+  IOTC_CHECK_STATE(state = _iotc_check_iotcore_jwt_params(
+                       project_id, private_key_data, NULL));
+
+  IOTC_ALLOC_AT(iotc_jwt_manager_t, manager, state);
+
+  manager->context_handle = iotc_h;
+  manager->renewal_task = IOTC_INVALID_TIMED_TASK_HANDLE;
+  manager->private_key_data = *private_key_data;
+  manager->expiration_period_sec = expiration_period_sec;
+  manager->ready_jwt = IOTC_JWT_MANAGER_NO_JWT;
+
+  IOTC_CHECK_MEMORY(manager->project_id = iotc_str_dup(project_id), state);
+
+  crypto_state = iotc_bsp_ecc_key_create(private_key_data, &manager->key);
+  IOTC_CHECK_STATE(state = _iotc_jwt_state_from_crypto(crypto_state));
+
+  /* the first token is there before the first connection */
+  IOTC_CHECK_STATE(state = _iotc_jwt_manager_renew(manager));
+
+  /* a token handed out keeps at least half of its lifetime */
+  manager->renewal_task = iotc_schedule_timed_task(
+      iotc_h, &_iotc_jwt_manager_renewal_task, expiration_period_sec / 2, 1,
+      manager);
+
+  IOTC_CHECK_CND(0 > manager->renewal_task, -manager->renewal_task, state);
+
+  *out_manager = manager;
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  iotc_jwt_manager_destroy(&manager);
+
+  return state;
+}
+
+/* expiration_sec may be NULL */
+static iotc_state_t _iotc_jwt_manager_get_jwt(iotc_jwt_manager_t* manager,
+                                              char* dst_jwt_buf,
+                                              size_t dst_jwt_buf_len,
+                                              size_t* bytes_written,
+                                              iotc_time_t* expiration_sec) {
+  const uint32_t ready_jwt =
+      iotc_atomic_load_u32(&manager->ready_jwt);
+  const iotc_time_t now_sec = iotc_bsp_time_getcurrenttime_seconds();
+
+  /* the timed task is late, e.g. the events aren't processed, sign one
+   * here rather than hand out a token close to its expiration */
+  if (IOTC_JWT_MANAGER_NO_JWT == ready_jwt ||
+      manager->expirations_sec[ready_jwt] <
+          now_sec + manager->expiration_period_sec / 4) {
+    if (NULL != expiration_sec) {
+      *expiration_sec = now_sec + manager->expiration_period_sec;
+    }
+
+    return _iotc_sign_iotcore_jwt(
+        manager->project_id, now_sec, manager->expiration_period_sec,
+        &manager->private_key_data, NULL, dst_jwt_buf, dst_jwt_buf_len,
+        bytes_written);
+  }
+
+  /* one more byte for the terminating zero */
+  if (dst_jwt_buf_len <= manager->jwt_lengths[ready_jwt]) {
+    *bytes_written = manager->jwt_lengths[ready_jwt] + 1;
+    return IOTC_BUFFER_TOO_SMALL_ERROR;
+  }
+
+  memcpy(dst_jwt_buf, manager->jwts[ready_jwt],
+         manager->jwt_lengths[ready_jwt]);
+  dst_jwt_buf[manager->jwt_lengths[ready_jwt]] = '\0';
+  *bytes_written = manager->jwt_lengths[ready_jwt];
+
+  if (NULL != expiration_sec) {
+    *expiration_sec = manager->expirations_sec[ready_jwt];
+  }
+
+  return IOTC_STATE_OK;
+}
+
+iotc_state_t iotc_jwt_manager_get_jwt(iotc_jwt_manager_t* manager,
+                                      char* dst_jwt_buf, size_t dst_jwt_buf_len,
+                                      size_t* bytes_written) {
+  if (NULL == manager || NULL == dst_jwt_buf || NULL == bytes_written) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  return _iotc_jwt_manager_get_jwt(manager, dst_jwt_buf, dst_jwt_buf_len,
+                                   bytes_written, NULL);
+}
+
+void iotc_jwt_manager_destroy(iotc_jwt_manager_t** manager) {
+  if (NULL == manager || NULL == *manager) {
+    return;
+  }
+
+  if (0 <= (*manager)->renewal_task) {
+    iotc_cancel_timed_task((*manager)->renewal_task);
+  }
+
+  iotc_bsp_ecc_key_destroy(&(*manager)->key);
+  IOTC_SAFE_FREE((*manager)->project_id);
+  IOTC_SAFE_FREE(*manager);
+}
+
+static iotc_state_t _iotc_jwt_rotation_sign(void* signer, char* dst_buf,
+                                            size_t dst_buf_len,
+                                            size_t* bytes_written,
+                                            iotc_time_t* expiration_sec) {
+  return _iotc_jwt_manager_get_jwt((iotc_jwt_manager_t*)signer, dst_buf,
+                                   dst_buf_len, bytes_written, expiration_sec);
+}
+
+static void _iotc_jwt_rotation_release(void** signer) {
+  iotc_jwt_manager_destroy((iotc_jwt_manager_t**)signer);
+}
+
+iotc_state_t iotc_set_jwt_rotation(
+    iotc_context_handle_t iotc_h, const char* project_id,
+    uint32_t expiration_period_sec,
+    const iotc_crypto_key_data_t* private_key_data) {
+  if (NULL == private_key_data) {
+    return iotc_jwt_rotation_set_signer(iotc_h, NULL, NULL, NULL, 0);
+  }
+
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_jwt_manager_t* manager = NULL;
+
+  IOTC_CHECK_STATE(state = iotc_jwt_manager_create(
+                       iotc_h, project_id, expiration_period_sec,
+                       private_key_data, &manager));
+
+  IOTC_CHECK_STATE(state = iotc_jwt_rotation_set_signer(
+                       iotc_h, manager, &_iotc_jwt_rotation_sign,
+                       &_iotc_jwt_rotation_release, expiration_period_sec));
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  iotc_jwt_manager_destroy(&manager);
+
+  return state;
 }
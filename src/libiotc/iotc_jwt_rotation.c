@@ -0,0 +1,239 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <string.h>
+
+#include "iotc_config.h"
+#include "iotc_debug.h"
+#include "iotc_globals.h"
+#include "iotc_handle.h"
+#include "iotc_helpers.h"
+#include "iotc_jwt.h"
+#include "iotc_jwt_rotation.h"
+#include "iotc_layer_api.h"
+#include "iotc_macros.h"
+#include "iotc_mqtt_logic_layer_data.h"
+#include "iotc_types_internal.h"
+
+#include <iotc_bsp_rng.h>
+#include <iotc_bsp_time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static iotc_state_t iotc_jwt_rotation_check(void* context);
+
+/* nothing in flight or waiting to be sent, a swap now loses nothing and
+ * delays nothing */
+static uint8_t iotc_jwt_rotation_is_quiet(void* context) {
+  /* the MQTT logic layer sits right below the top layer */
+  const iotc_mqtt_logic_layer_data_t* layer_data =
+      (const iotc_mqtt_logic_layer_data_t*)((iotc_layer_connectivity_t*)context)
+          ->prev->user_data;
+
+  return NULL != layer_data && 0 == layer_data->q12_tasks_queue.size &&
+         0 == layer_data->q12_recv_tasks_queue.size &&
+         NULL == layer_data->current_q0_task &&
+         NULL == layer_data->q0_tasks_queue;
+}
+
+static void iotc_jwt_rotation_cancel_check(iotc_context_data_t* context_data) {
+  if (NULL != context_data->jwt_rotation.next_check.ptr_to_position) {
+    iotc_evtd_cancel(context_data->evtd_instance,
+                     &context_data->jwt_rotation.next_check);
+  }
+}
+
+static iotc_state_t iotc_jwt_rotation_check(void* context) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+  iotc_jwt_rotation_t* rotation = &context_data->jwt_rotation;
+  iotc_mqtt_logic_task_t* task = NULL;
+
+  assert(NULL == rotation->next_check.ptr_to_position);
+
+  if (NULL == rotation->signer || NULL == context_data->connection_data ||
+      IOTC_CONNECTION_STATE_OPENED !=
+          context_data->connection_data->connection_state ||
+      IOTC_SHUTDOWN_UNINITIALISED != context_data->shutdown_state) {
+    return IOTC_STATE_OK;
+  }
+
+  if (0 == iotc_jwt_rotation_is_quiet(context) &&
+      iotc_bsp_time_getcurrenttime_seconds() < rotation->deadline_sec) {
+    return iotc_evtd_execute_in(
+        context_data->evtd_instance,
+        iotc_make_handle(&iotc_jwt_rotation_check, context),
+        IOTC_JWT_ROTATION_QUIET_CHECK_MS, &rotation->next_check);
+  }
+
+  iotc_debug_logger("JWT rotation: swapping the connection");
+
+  task = iotc_mqtt_logic_make_shutdown_task();
+  IOTC_CHECK_MEMORY(task, state);
+
+  rotation->in_progress = 1;
+
+  return IOTC_PROCESS_PUSH_ON_PREV_LAYER(context, task, IOTC_STATE_OK);
+
+err_handling:
+  return state;
+}
+
+iotc_state_t iotc_jwt_rotation_set_signer(
+    iotc_context_handle_t iotc_h, void* signer, iotc_jwt_rotation_sign_t* sign,
+    void (*signer_dtor_ptr)(void**), uint32_t expiration_period_sec) {
+  if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_h ||
+      (NULL != signer && (NULL == sign || NULL == signer_dtor_ptr))) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc_context_t* iotc = (iotc_context_t*)iotc_object_for_handle(
+      iotc_globals.context_handles_vector, iotc_h);
+
+  if (NULL == iotc) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  iotc_jwt_rotation_release(&iotc->context_data);
+
+  iotc_jwt_rotation_t* rotation = &iotc->context_data.jwt_rotation;
+
+  rotation->signer = signer;
+  rotation->sign = sign;
+  rotation->signer_dtor_ptr = signer_dtor_ptr;
+  rotation->expiration_period_sec = expiration_period_sec;
+
+  return IOTC_STATE_OK;
+}
+
+void iotc_jwt_rotation_release(iotc_context_data_t* context_data) {
+  assert(NULL != context_data);
+
+  iotc_jwt_rotation_t* rotation = &context_data->jwt_rotation;
+
+  iotc_jwt_rotation_cancel_check(context_data);
+
+  if (NULL != rotation->signer) {
+    assert(NULL != rotation->signer_dtor_ptr);
+    rotation->signer_dtor_ptr(&rotation->signer);
+  }
+
+  memset(rotation, 0, sizeof(iotc_jwt_rotation_t));
+}
+
+iotc_state_t iotc_jwt_rotation_update_password(
+    iotc_context_data_t* context_data) {
+  assert(NULL != context_data);
+  assert(NULL != context_data->connection_data);
+
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_jwt_rotation_t* rotation = &context_data->jwt_rotation;
+  char jwt[IOTC_JWT_SIZE] = {0};
+  size_t jwt_length = 0;
+  char* password = NULL;
+
+  if (NULL == rotation->signer) {
+    return IOTC_STATE_OK;
+  }
+
+  IOTC_CHECK_STATE(state = rotation->sign(rotation->signer, jwt, IOTC_JWT_SIZE,
+                                          &jwt_length,
+                                          &rotation->token_expiration_sec));
+
+  password = iotc_str_dup(jwt);
+  IOTC_CHECK_MEMORY(password, state);
+
+  IOTC_SAFE_FREE(context_data->connection_data->password);
+  context_data->connection_data->password = password;
+
+err_handling:
+  return state;
+}
+
+iotc_state_t iotc_jwt_rotation_connected(void* context) {
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+  iotc_jwt_rotation_t* rotation = &context_data->jwt_rotation;
+
+  rotation->in_progress = 0;
+
+  iotc_jwt_rotation_cancel_check(context_data);
+
+  if (NULL == rotation->signer) {
+    return IOTC_STATE_OK;
+  }
+
+  /* the swap happens in the last quarter of the token's lifetime but for a
+   * safety margin of an eighth, each context starts looking for a quiet
+   * moment at a random point of that window so a fleet that connected at
+   * once doesn't reconnect at once */
+  const iotc_time_t period_sec = rotation->expiration_period_sec;
+  const iotc_time_t now_sec = iotc_bsp_time_getcurrenttime_seconds();
+  const iotc_time_t window_sec = period_sec / 4 - period_sec / 8;
+
+  rotation->deadline_sec = rotation->token_expiration_sec - period_sec / 8;
+
+  iotc_time_t start_sec = rotation->token_expiration_sec - period_sec / 4 +
+                          (iotc_time_t)(iotc_bsp_rng_get() %
+                                        (uint32_t)(window_sec / 2 + 1));
+
+  start_sec = IOTC_MAX(start_sec, now_sec);
+
+  iotc_debug_format("JWT rotation in %ld s", (long)(start_sec - now_sec));
+
+  return iotc_evtd_execute_in(
+      context_data->evtd_instance,
+      iotc_make_handle(&iotc_jwt_rotation_check, context),
+      IOTC_SEC_TO_MSEC(start_sec - now_sec), &rotation->next_check);
+}
+
+void iotc_jwt_rotation_closed(void* context) {
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+
+  if (0 == context_data->jwt_rotation.in_progress) {
+    iotc_jwt_rotation_cancel_check(context_data);
+  }
+}
+
+iotc_state_t iotc_jwt_rotation_reconnect(void* context) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+
+  assert(0 != context_data->jwt_rotation.in_progress);
+
+  IOTC_CHECK_STATE(state = iotc_jwt_rotation_update_password(context_data));
+
+  context_data->connection_data->connection_state =
+      IOTC_CONNECTION_STATE_UNINITIALIZED;
+
+  /* like a connect of the application, a shutdown cancels it */
+  IOTC_CHECK_STATE(
+      state = iotc_evtd_execute_in(
+          context_data->evtd_instance,
+          iotc_make_handle(IOTC_THIS_LAYER(context)->layer_funcs->init,
+                           context, context_data->connection_data,
+                           IOTC_STATE_OK),
+          0, &context_data->connect_handler));
+
+err_handling:
+  return state;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef IOTC_JWT_ROTATION_H
+#define IOTC_JWT_ROTATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iotc_event_dispatcher_api.h"
+
+#include <iotc_error.h>
+#include <iotc_time.h>
+#include <iotc_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* writes a token valid for a new connection and when it expires */
+typedef iotc_state_t(iotc_jwt_rotation_sign_t)(void* signer, char* dst_buf,
+                                               size_t dst_buf_len,
+                                               size_t* bytes_written,
+                                               iotc_time_t* expiration_sec);
+
+/* the password rotation of a context, the signer is reached through function
+ * pointers so the context doesn't depend on the crypto BSP */
+typedef struct iotc_jwt_rotation_s {
+  /* NULL if the application passes the password itself */
+  void* signer;
+  iotc_jwt_rotation_sign_t* sign;
+  void (*signer_dtor_ptr)(void**);
+  uint32_t expiration_period_sec;
+  /* the expiration of the token of the current connection */
+  iotc_time_t token_expiration_sec;
+  /* the connection is swapped by then even if it isn't quiet */
+  iotc_time_t deadline_sec;
+  iotc_time_event_handle_t next_check;
+  /* set from the disconnect of the swap until the next connection is open,
+   * the session of the MQTT logic layer survives it */
+  uint8_t in_progress;
+} iotc_jwt_rotation_t;
+
+extern iotc_state_t iotc_jwt_rotation_set_signer(
+    iotc_context_handle_t iotc_h, void* signer, iotc_jwt_rotation_sign_t* sign,
+    void (*signer_dtor_ptr)(void**), uint32_t expiration_period_sec);
+
+extern void iotc_jwt_rotation_release(struct iotc_context_data_s* context_data);
+
+/* puts a fresh token in the connection data, a no-op without a signer */
+extern iotc_state_t iotc_jwt_rotation_update_password(
+    struct iotc_context_data_s* context_data);
+
+/* the functions below take the connectivity of the top layer */
+
+/* ends a swap and schedules the next one */
+extern iotc_state_t iotc_jwt_rotation_connected(void* context);
+
+/* cancels the next swap, unless the close is the swap itself */
+extern void iotc_jwt_rotation_closed(void* context);
+
+/* opens the connection of a swap with a fresh token */
+extern iotc_state_t iotc_jwt_rotation_reconnect(void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTC_JWT_ROTATION_H */
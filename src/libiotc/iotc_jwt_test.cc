@@ -216,5 +216,64 @@ TEST_F(IotcJwt, IoTCoreJwtCreateReturnsCorrectES256) {
                                     ecc_signature_length, kPublicKey));
 }
 
+TEST_F(IotcJwt, JwtManagerCreateShortExpirationReturnsInvalidParameter) {
+  iotc_context_handle_t context = iotc_create_context();
+  iotc_jwt_manager_t* manager = NULL;
+  EXPECT_EQ(iotc_jwt_manager_create(context, "projectID",
+                                    /*expiration_period_sec=*/1, &private_key_,
+                                    &manager),
+            IOTC_INVALID_PARAMETER);
+  EXPECT_EQ(manager, nullptr);
+  iotc_delete_context(context);
+}
+
+TEST_F(IotcJwt, JwtManagerGetJwtReturnsPreSignedToken) {
+  iotc_context_handle_t context = iotc_create_context();
+  iotc_jwt_manager_t* manager = NULL;
+  ASSERT_EQ(iotc_jwt_manager_create(context, "projectID",
+                                    /*expiration_period_sec=*/600,
+                                    &private_key_, &manager),
+            IOTC_STATE_OK);
+
+  char jwt_buffer[IOTC_JWT_SIZE] = {0};
+  size_t bytes_written = 0;
+  ASSERT_EQ(iotc_jwt_manager_get_jwt(manager, jwt_buffer, IOTC_JWT_SIZE,
+                                     &bytes_written),
+            IOTC_STATE_OK);
+  EXPECT_EQ(strlen(jwt_buffer), bytes_written);
+
+  std::string jwt(jwt_buffer, bytes_written);
+  ASSERT_THAT(jwt, ::testing::MatchesRegex(R"(^[^.]+\.[^.]+\.[^.]+)"));
+
+  // Until the next renewal every caller gets the same token.
+  char second_jwt_buffer[IOTC_JWT_SIZE] = {0};
+  ASSERT_EQ(iotc_jwt_manager_get_jwt(manager, second_jwt_buffer,
+                                     IOTC_JWT_SIZE, &bytes_written),
+            IOTC_STATE_OK);
+  EXPECT_EQ(jwt, std::string(second_jwt_buffer, bytes_written));
+
+  iotc_jwt_manager_destroy(&manager);
+  EXPECT_EQ(manager, nullptr);
+  iotc_delete_context(context);
+}
+
+TEST_F(IotcJwt, JwtManagerGetJwtSmallBufferReturnsBufferTooSmall) {
+  iotc_context_handle_t context = iotc_create_context();
+  iotc_jwt_manager_t* manager = NULL;
+  ASSERT_EQ(iotc_jwt_manager_create(context, "projectID",
+                                    /*expiration_period_sec=*/600,
+                                    &private_key_, &manager),
+            IOTC_STATE_OK);
+
+  char jwt_buffer[8] = {0};
+  size_t bytes_written = 0;
+  EXPECT_EQ(iotc_jwt_manager_get_jwt(manager, jwt_buffer, sizeof(jwt_buffer),
+                                     &bytes_written),
+            IOTC_BUFFER_TOO_SMALL_ERROR);
+
+  iotc_jwt_manager_destroy(&manager);
+  iotc_delete_context(context);
+}
+
 }  // namespace
 }  // namespace iotctest
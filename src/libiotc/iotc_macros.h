@@ -21,6 +21,7 @@
 #include "iotc_allocator.h"
 
 #include <iotc_error.h>
+#include <iotc_time.h>
 
 #define IOTC_STR_EXPAND(tok) #tok
 #define IOTC_STR(tok) IOTC_STR_EXPAND(tok)
@@ -28,6 +29,10 @@
 #define IOTC_MAX(a, b) ((a) > (b) ? (a) : (b))
 #define IOTC_UNUSED(x) (void)(x)
 
+/* the event dispatcher schedules time events in milliseconds */
+#define IOTC_MSEC_PER_SEC 1000
+#define IOTC_SEC_TO_MSEC(sec) ((iotc_time_t)(sec)*IOTC_MSEC_PER_SEC)
+
 #define IOTC_GUARD_EOS(s, size) \
   { (s)[(size)-1] = '\0'; }
 
@@ -99,6 +104,27 @@
   type_t* out = NULL;                  \
   IOTC_ALLOC_AT(type_t, out, state)
 
+/* Pooled allocation macro group, for the objects with a memory pool. */
+#define IOTC_ALLOC_POOLED_AT(pool_type, type_t, out, state)    \
+  out = (type_t*)iotc_alloc_pooled(pool_type, sizeof(type_t)); \
+  IOTC_CHECK_MEMORY(out, state);                               \
+  memset(out, 0, sizeof(type_t));
+
+#define IOTC_ALLOC_POOLED(pool_type, type_t, out, state) \
+  type_t* out = NULL;                                    \
+  IOTC_ALLOC_POOLED_AT(pool_type, type_t, out, state)
+
+#define IOTC_ALLOC_POOLED_BUFFER_AT(type_t, out, size, state)  \
+  out = (type_t*)iotc_alloc_pooled(IOTC_MEM_POOL_BUFFER, size); \
+  IOTC_CHECK_MEMORY(out, state);                                \
+  memset(out, 0, size);
+
+#define IOTC_ALLOC_SYSTEM_POOLED(pool_type, type_t, out, state)       \
+  type_t* out = NULL;                                                 \
+  out = (type_t*)iotc_alloc_system_pooled(pool_type, sizeof(type_t)); \
+  IOTC_CHECK_MEMORY(out, state);                                      \
+  memset(out, 0, sizeof(type_t));
+
 /* System allocation macro group. */
 #define IOTC_ALLOC_SYSTEM_BUFFER_AT(type_t, out, size, state) \
   out = (type_t*)iotc_alloc_system(size);                     \
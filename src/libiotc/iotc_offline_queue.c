@@ -0,0 +1,1064 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iotc_debug.h"
+#include "iotc_event_thread_dispatcher.h"
+#include "iotc_helpers.h"
+#include "iotc_internals.h"
+#include "iotc_layer_api.h"
+#include "iotc_list.h"
+#include "iotc_macros.h"
+#include "iotc_mqtt_logic_layer_data.h"
+#include "iotc_mqtt_logic_layer_task_helpers.h"
+#include "iotc_offline_queue.h"
+#include "iotc_types_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a record is this header followed by the topic and the payload:
+ * magic, flags, topic length (2 bytes), payload length (4 bytes) */
+#define IOTC_OFFLINE_QUEUE_RECORD_MAGIC 0xA5
+#define IOTC_OFFLINE_QUEUE_HEADER_SIZE 8
+#define IOTC_OFFLINE_QUEUE_QOS_MASK 0x03
+#define IOTC_OFFLINE_QUEUE_RETAIN_FLAG 0x04
+
+/* the index keeps head_seq and tail_seq */
+#define IOTC_OFFLINE_QUEUE_INDEX_SIZE 8
+
+/* room for ".idx" or "." and a sequence number */
+#define IOTC_OFFLINE_QUEUE_SUFFIX_SIZE 12
+
+static iotc_state_t iotc_offline_queue_drain(void* context);
+
+static void iotc_offline_queue_put_u32(uint8_t* dst, uint32_t value) {
+  dst[0] = (uint8_t)(value >> 24);
+  dst[1] = (uint8_t)(value >> 16);
+  dst[2] = (uint8_t)(value >> 8);
+  dst[3] = (uint8_t)value;
+}
+
+static uint32_t iotc_offline_queue_get_u32(const uint8_t* src) {
+  return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) |
+         ((uint32_t)src[2] << 8) | (uint32_t)src[3];
+}
+
+/* whether the position (seq, offset) comes before (other_seq, other_offset),
+ * the sequence numbers may wrap */
+static uint8_t iotc_offline_queue_before(uint32_t seq, size_t offset,
+                                         uint32_t other_seq,
+                                         size_t other_offset) {
+  if (seq != other_seq) {
+    return (int32_t)(seq - other_seq) < 0;
+  }
+
+  return offset < other_offset;
+}
+
+static const char* iotc_offline_queue_segment_name(iotc_offline_queue_t* queue,
+                                                   uint32_t seq) {
+  snprintf(queue->resource_name, queue->resource_name_size, "%s.%" PRIu32,
+           queue->name, seq);
+  return queue->resource_name;
+}
+
+static const char* iotc_offline_queue_index_name(iotc_offline_queue_t* queue) {
+  snprintf(queue->resource_name, queue->resource_name_size, "%s.idx",
+           queue->name);
+  return queue->resource_name;
+}
+
+static void iotc_offline_queue_reader_close(
+    iotc_offline_queue_reader_t* reader) {
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE != reader->handle) {
+    iotc_internals.fs_functions.close_resource(NULL, reader->handle);
+  }
+
+  reader->handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  reader->chunk = NULL;
+  reader->chunk_offset = 0;
+  reader->chunk_size = 0;
+}
+
+/* copies length bytes at offset, asking the filesystem for a new chunk only
+ * when the cached one doesn't have them */
+static iotc_state_t iotc_offline_queue_reader_read(
+    iotc_offline_queue_reader_t* reader, size_t offset, uint8_t* dst,
+    size_t length) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  while (0 < length) {
+    if (NULL == reader->chunk || offset < reader->chunk_offset ||
+        reader->chunk_offset + reader->chunk_size <= offset) {
+      const uint8_t* chunk = NULL;
+      size_t chunk_size = 0;
+
+      reader->chunk = NULL;
+
+      IOTC_CHECK_STATE(state = iotc_internals.fs_functions.read_resource(
+                           NULL, reader->handle, offset, &chunk, &chunk_size));
+      IOTC_CHECK_CND(NULL == chunk || 0 == chunk_size, IOTC_FS_READ_ERROR,
+                     state);
+
+      reader->chunk = chunk;
+      reader->chunk_offset = offset;
+      reader->chunk_size = chunk_size;
+    }
+
+    const size_t skip = offset - reader->chunk_offset;
+    const size_t count = IOTC_MIN(length, reader->chunk_size - skip);
+
+    memcpy(dst, reader->chunk + skip, count);
+
+    dst += count;
+    offset += count;
+    length -= count;
+  }
+
+err_handling:
+  return state;
+}
+
+/* the size of a segment as the filesystem has it, 0 if it is missing */
+static size_t iotc_offline_queue_stat_segment(iotc_offline_queue_t* queue,
+                                              uint32_t seq) {
+  iotc_fs_stat_t stat;
+  memset(&stat, 0, sizeof(stat));
+
+  if (IOTC_STATE_OK != iotc_internals.fs_functions.stat_resource(
+                           NULL, IOTC_FS_CONFIG_DATA,
+                           iotc_offline_queue_segment_name(queue, seq),
+                           &stat)) {
+    return 0;
+  }
+
+  return stat.resource_size;
+}
+
+/* the bytes of a segment a reader may see */
+static size_t iotc_offline_queue_segment_size(iotc_offline_queue_t* queue,
+                                              uint32_t seq) {
+  return (seq == queue->tail_seq) ? queue->tail_offset
+                                  : iotc_offline_queue_stat_segment(queue, seq);
+}
+
+static iotc_state_t iotc_offline_queue_write_index(
+    iotc_offline_queue_t* queue) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_fs_resource_handle_t handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  uint8_t index[IOTC_OFFLINE_QUEUE_INDEX_SIZE];
+  size_t written = 0;
+
+  iotc_offline_queue_put_u32(index, queue->head_seq);
+  iotc_offline_queue_put_u32(index + 4, queue->tail_seq);
+
+  IOTC_CHECK_STATE(state = iotc_internals.fs_functions.open_resource(
+                       NULL, IOTC_FS_CONFIG_DATA,
+                       iotc_offline_queue_index_name(queue),
+                       IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE, &handle));
+  IOTC_CHECK_STATE(state = iotc_internals.fs_functions.write_resource(
+                       NULL, handle, index, sizeof(index), 0, &written));
+
+err_handling:
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE != handle) {
+    iotc_internals.fs_functions.close_resource(NULL, handle);
+  }
+
+  return state;
+}
+
+/* a missing index is a new queue */
+static iotc_state_t iotc_offline_queue_read_index(iotc_offline_queue_t* queue) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_offline_queue_reader_t reader;
+  iotc_fs_stat_t stat;
+  uint8_t index[IOTC_OFFLINE_QUEUE_INDEX_SIZE];
+
+  memset(&reader, 0, sizeof(reader));
+  memset(&stat, 0, sizeof(stat));
+  reader.handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+
+  if (IOTC_STATE_OK != iotc_internals.fs_functions.stat_resource(
+                           NULL, IOTC_FS_CONFIG_DATA,
+                           iotc_offline_queue_index_name(queue), &stat) ||
+      stat.resource_size < sizeof(index)) {
+    queue->head_seq = 0;
+    queue->tail_seq = 0;
+    return IOTC_STATE_OK;
+  }
+
+  IOTC_CHECK_STATE(state = iotc_internals.fs_functions.open_resource(
+                       NULL, IOTC_FS_CONFIG_DATA,
+                       iotc_offline_queue_index_name(queue), IOTC_FS_OPEN_READ,
+                       &reader.handle));
+  IOTC_CHECK_STATE(
+      state = iotc_offline_queue_reader_read(&reader, 0, index, sizeof(index)));
+
+  queue->head_seq = iotc_offline_queue_get_u32(index);
+  queue->tail_seq = iotc_offline_queue_get_u32(index + 4);
+
+err_handling:
+  iotc_offline_queue_reader_close(&reader);
+
+  return state;
+}
+
+static void iotc_offline_queue_free(iotc_offline_queue_t** queue) {
+  if (NULL == queue || NULL == *queue) {
+    return;
+  }
+
+  iotc_offline_queue_reader_close(&(*queue)->reader);
+
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE != (*queue)->tail_handle) {
+    iotc_internals.fs_functions.close_resource(NULL, (*queue)->tail_handle);
+  }
+
+  /* the messages stay in the log, their callbacks go with this process */
+  while (NULL != (*queue)->callbacks) {
+    iotc_offline_queue_callback_t* callback = NULL;
+
+    IOTC_LIST_POP_WITH_TAIL(iotc_offline_queue_callback_t, (*queue)->callbacks,
+                            (*queue)->callbacks_tail, callback);
+    IOTC_SAFE_FREE(callback);
+  }
+
+  IOTC_SAFE_FREE((*queue)->name);
+  IOTC_SAFE_FREE((*queue)->resource_name);
+  IOTC_SAFE_FREE(*queue);
+}
+
+iotc_state_t iotc_offline_queue_create(const iotc_offline_queue_config_t* config,
+                                       iotc_offline_queue_t** out_queue) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_offline_queue_t* queue = NULL;
+  uint32_t seq = 0;
+
+  if (NULL == config || NULL == config->name || '\0' == config->name[0] ||
+      NULL == out_queue || 0 == config->segment_bytes ||
+      config->max_bytes < config->segment_bytes) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  IOTC_ALLOC_AT(iotc_offline_queue_t, queue, state);
+
+  queue->tail_handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  queue->reader.handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  queue->max_bytes = config->max_bytes;
+  queue->segment_bytes = config->segment_bytes;
+  queue->drop_policy = config->drop_policy;
+
+  queue->name = iotc_str_dup(config->name);
+  IOTC_CHECK_MEMORY(queue->name, state);
+
+  queue->resource_name_size =
+      strlen(config->name) + IOTC_OFFLINE_QUEUE_SUFFIX_SIZE;
+  IOTC_ALLOC_BUFFER_AT(char, queue->resource_name, queue->resource_name_size,
+                       state);
+
+  IOTC_CHECK_STATE(state = iotc_offline_queue_read_index(queue));
+
+  queue->read_seq = queue->head_seq;
+
+  /* new records go after what the tail segment already has */
+  queue->tail_offset = iotc_offline_queue_stat_segment(queue, queue->tail_seq);
+
+  for (seq = queue->head_seq; seq != queue->tail_seq + 1; ++seq) {
+    queue->size += iotc_offline_queue_segment_size(queue, seq);
+  }
+
+  *out_queue = queue;
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  iotc_offline_queue_free(&queue);
+
+  return state;
+}
+
+iotc_state_t iotc_offline_queue_flush(iotc_offline_queue_t* queue) {
+  assert(NULL != queue);
+
+  iotc_state_t state = IOTC_STATE_OK;
+  size_t written = 0;
+
+  if (0 == queue->write_buffer_length) {
+    return IOTC_STATE_OK;
+  }
+
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE == queue->tail_handle) {
+    const char* name = iotc_offline_queue_segment_name(queue, queue->tail_seq);
+
+    /* a new segment doesn't carry on what a lost index left behind */
+    if (0 == queue->tail_offset) {
+      iotc_internals.fs_functions.remove_resource(NULL, IOTC_FS_CONFIG_DATA,
+                                                  name);
+    }
+
+    IOTC_CHECK_STATE(state = iotc_internals.fs_functions.open_resource(
+                         NULL, IOTC_FS_CONFIG_DATA, name,
+                         IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE,
+                         &queue->tail_handle));
+  }
+
+  IOTC_CHECK_STATE(state = iotc_internals.fs_functions.write_resource(
+                       NULL, queue->tail_handle, queue->write_buffer,
+                       queue->write_buffer_length, queue->tail_offset,
+                       &written));
+
+  queue->tail_offset += queue->write_buffer_length;
+  queue->write_buffer_length = 0;
+
+  /* the filesystem may have moved the segment the reader has a chunk of */
+  if (queue->read_seq == queue->tail_seq) {
+    queue->reader.chunk = NULL;
+  }
+
+err_handling:
+  return state;
+}
+
+static iotc_state_t iotc_offline_queue_roll(iotc_offline_queue_t* queue) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  IOTC_CHECK_STATE(state = iotc_offline_queue_flush(queue));
+
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE != queue->tail_handle) {
+    iotc_internals.fs_functions.close_resource(NULL, queue->tail_handle);
+    queue->tail_handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  }
+
+  ++queue->tail_seq;
+  queue->tail_offset = 0;
+
+  IOTC_CHECK_STATE(state = iotc_offline_queue_write_index(queue));
+
+err_handling:
+  return state;
+}
+
+/* calls the callbacks of the messages before (seq, offset) */
+static void iotc_offline_queue_complete_callbacks(
+    iotc_context_data_t* context_data, iotc_offline_queue_t* queue,
+    uint32_t seq, size_t offset, iotc_state_t state) {
+  while (NULL != queue->callbacks &&
+         iotc_offline_queue_before(queue->callbacks->seq,
+                                   queue->callbacks->offset, seq, offset)) {
+    iotc_offline_queue_callback_t* callback = NULL;
+
+    IOTC_LIST_POP_WITH_TAIL(iotc_offline_queue_callback_t, queue->callbacks,
+                            queue->callbacks_tail, callback);
+
+    callback->callback.handlers.h3.a3 = state;
+    iotc_evttd_execute_ordered(context_data->evtd_instance, callback->callback,
+                               context_data);
+
+    IOTC_SAFE_FREE(callback);
+  }
+}
+
+/* removes the head segment with whatever is left of it */
+static iotc_state_t iotc_offline_queue_drop_head(
+    iotc_context_data_t* context_data, iotc_offline_queue_t* queue) {
+  assert(queue->head_seq != queue->tail_seq);
+
+  const size_t segment_size =
+      iotc_offline_queue_segment_size(queue, queue->head_seq);
+  const size_t left = (queue->head_offset < segment_size)
+                          ? segment_size - queue->head_offset
+                          : 0;
+
+  if (0 < left) {
+    iotc_debug_format("offline queue: dropping %lu bytes of segment %" PRIu32,
+                      (unsigned long)left, queue->head_seq);
+  }
+
+  iotc_offline_queue_complete_callbacks(context_data, queue,
+                                        queue->head_seq + 1, 0,
+                                        IOTC_OFFLINE_QUEUE_FULL);
+
+  /* whatever the connection does with them, they are gone */
+  while (0 < queue->in_flight_count &&
+         queue->head_seq ==
+             queue->in_flight[queue->in_flight_first].seq) {
+    queue->in_flight_first =
+        (queue->in_flight_first + 1) % IOTC_OFFLINE_QUEUE_DRAIN_BATCH;
+    --queue->in_flight_count;
+  }
+
+  if (queue->read_seq == queue->head_seq) {
+    iotc_offline_queue_reader_close(&queue->reader);
+    ++queue->read_seq;
+    queue->read_offset = 0;
+  }
+
+  iotc_internals.fs_functions.remove_resource(
+      NULL, IOTC_FS_CONFIG_DATA,
+      iotc_offline_queue_segment_name(queue, queue->head_seq));
+
+  queue->size -= IOTC_MIN(left, queue->size);
+  ++queue->head_seq;
+  queue->head_offset = 0;
+
+  return iotc_offline_queue_write_index(queue);
+}
+
+/* nothing is left, the next record starts a new segment */
+static iotc_state_t iotc_offline_queue_reset(iotc_context_data_t* context_data,
+                                             iotc_offline_queue_t* queue) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  while (queue->head_seq != queue->tail_seq) {
+    IOTC_CHECK_STATE(state = iotc_offline_queue_drop_head(context_data, queue));
+  }
+
+  iotc_offline_queue_reader_close(&queue->reader);
+
+  if (IOTC_FS_INVALID_RESOURCE_HANDLE != queue->tail_handle) {
+    iotc_internals.fs_functions.close_resource(NULL, queue->tail_handle);
+    queue->tail_handle = IOTC_FS_INVALID_RESOURCE_HANDLE;
+  }
+
+  iotc_internals.fs_functions.remove_resource(
+      NULL, IOTC_FS_CONFIG_DATA,
+      iotc_offline_queue_segment_name(queue, queue->tail_seq));
+
+  ++queue->tail_seq;
+  queue->head_seq = queue->tail_seq;
+  queue->head_offset = 0;
+  queue->read_seq = queue->tail_seq;
+  queue->read_offset = 0;
+  queue->tail_offset = 0;
+  queue->write_buffer_length = 0;
+  queue->size = 0;
+  queue->in_flight_first = 0;
+  queue->in_flight_count = 0;
+
+  IOTC_CHECK_STATE(state = iotc_offline_queue_write_index(queue));
+
+err_handling:
+  return state;
+}
+
+/* moves the head to (seq, offset), the messages before it are delivered or
+ * can't be and their callbacks are called with state */
+static iotc_state_t iotc_offline_queue_commit(iotc_context_data_t* context_data,
+                                              iotc_offline_queue_t* queue,
+                                              uint32_t seq, size_t offset,
+                                              iotc_state_t state) {
+  iotc_state_t local_state = IOTC_STATE_OK;
+
+  iotc_offline_queue_complete_callbacks(context_data, queue, seq, offset,
+                                        state);
+
+  while (iotc_offline_queue_before(queue->head_seq, 0, seq, 0)) {
+    IOTC_CHECK_STATE(local_state =
+                         iotc_offline_queue_drop_head(context_data, queue));
+  }
+
+  if (queue->head_seq == seq && queue->head_offset < offset) {
+    queue->size -= IOTC_MIN(offset - queue->head_offset, queue->size);
+    queue->head_offset = offset;
+  }
+
+  if (0 == queue->size) {
+    IOTC_CHECK_STATE(local_state =
+                         iotc_offline_queue_reset(context_data, queue));
+  }
+
+err_handling:
+  return local_state;
+}
+
+/* whether there is a message past the read position */
+static uint8_t iotc_offline_queue_has_unread(
+    const iotc_offline_queue_t* queue) {
+  return queue->read_seq != queue->tail_seq ||
+         queue->read_offset < queue->tail_offset + queue->write_buffer_length;
+}
+
+/* with nothing in flight and nothing left to read, what the head hasn't
+ * passed yet couldn't be read */
+static iotc_state_t iotc_offline_queue_settle(iotc_context_data_t* context_data,
+                                              iotc_offline_queue_t* queue) {
+  if (0 < queue->in_flight_count || 0 == queue->size ||
+      iotc_offline_queue_has_unread(queue)) {
+    return IOTC_STATE_OK;
+  }
+
+  return iotc_offline_queue_commit(context_data, queue, queue->read_seq,
+                                   queue->read_offset, IOTC_FS_READ_ERROR);
+}
+
+/* what is in flight is handed out again from the head */
+static void iotc_offline_queue_rewind(iotc_offline_queue_t* queue) {
+  if (queue->read_seq != queue->head_seq) {
+    iotc_offline_queue_reader_close(&queue->reader);
+  }
+
+  queue->read_seq = queue->head_seq;
+  queue->read_offset = queue->head_offset;
+  queue->in_flight_first = 0;
+  queue->in_flight_count = 0;
+}
+
+static iotc_state_t iotc_offline_queue_write(iotc_offline_queue_t* queue,
+                                             const uint8_t* bytes,
+                                             size_t length) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  while (0 < length) {
+    if (sizeof(queue->write_buffer) == queue->write_buffer_length) {
+      IOTC_CHECK_STATE(state = iotc_offline_queue_flush(queue));
+    }
+
+    const size_t count = IOTC_MIN(
+        length, sizeof(queue->write_buffer) - queue->write_buffer_length);
+
+    memcpy(queue->write_buffer + queue->write_buffer_length, bytes, count);
+
+    queue->write_buffer_length += count;
+    bytes += count;
+    length -= count;
+  }
+
+err_handling:
+  return state;
+}
+
+/* a record is written whole or not at all */
+static iotc_state_t iotc_offline_queue_write_record(
+    iotc_offline_queue_t* queue, const uint8_t* header, const uint8_t* topic,
+    size_t topic_length, const iotc_data_desc_t* payload) {
+  iotc_state_t state = IOTC_STATE_OK;
+  const size_t record_offset = queue->tail_offset + queue->write_buffer_length;
+
+  IOTC_CHECK_STATE(state = iotc_offline_queue_write(
+                       queue, header, IOTC_OFFLINE_QUEUE_HEADER_SIZE));
+  IOTC_CHECK_STATE(state =
+                       iotc_offline_queue_write(queue, topic, topic_length));
+  IOTC_CHECK_STATE(state = iotc_offline_queue_write(queue, payload->data_ptr,
+                                                    payload->length));
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  if (queue->tail_offset <= record_offset) {
+    queue->write_buffer_length = record_offset - queue->tail_offset;
+  } else {
+    /* the part written already is overwritten by the next record */
+    queue->tail_offset = record_offset;
+    queue->write_buffer_length = 0;
+  }
+
+  return state;
+}
+
+static iotc_state_t iotc_offline_queue_flush_event(void* data) {
+  iotc_context_data_t* context_data = (iotc_context_data_t*)data;
+  iotc_offline_queue_t* queue = context_data->offline_queue;
+
+  if (NULL == queue) {
+    return IOTC_STATE_OK;
+  }
+
+  const iotc_state_t state = iotc_offline_queue_flush(queue);
+
+  /* the buffer is kept, try again later */
+  if (IOTC_STATE_OK != state) {
+    iotc_debug_format("offline queue: flush failed: %d", state);
+
+    iotc_evtd_execute_in(
+        context_data->evtd_instance,
+        iotc_make_handle(&iotc_offline_queue_flush_event, context_data),
+        IOTC_OFFLINE_QUEUE_FLUSH_MS, &queue->flush_event);
+  }
+
+  return IOTC_STATE_OK;
+}
+
+void iotc_offline_queue_destroy(iotc_context_data_t* context_data) {
+  assert(NULL != context_data);
+
+  iotc_offline_queue_t* queue = context_data->offline_queue;
+
+  if (NULL == queue) {
+    return;
+  }
+
+  if (NULL != queue->flush_event.ptr_to_position) {
+    iotc_evtd_cancel(context_data->evtd_instance, &queue->flush_event);
+  }
+
+  if (NULL != queue->drain_event.ptr_to_position) {
+    iotc_evtd_cancel(context_data->evtd_instance, &queue->drain_event);
+  }
+
+  if (IOTC_STATE_OK != iotc_offline_queue_flush(queue)) {
+    iotc_debug_format("offline queue: %lu buffered bytes lost",
+                      (unsigned long)queue->write_buffer_length);
+  }
+
+  iotc_offline_queue_free(&queue);
+  context_data->offline_queue = NULL;
+}
+
+uint8_t iotc_offline_queue_takes(const iotc_context_data_t* context_data) {
+  assert(NULL != context_data);
+
+  /* a JWT rotation keeps its own messages for the new connection */
+  if (NULL == context_data->offline_queue ||
+      context_data->jwt_rotation.in_progress) {
+    return 0;
+  }
+
+  if (0 < context_data->offline_queue->size ||
+      NULL == context_data->connection_data) {
+    return 1;
+  }
+
+  switch (context_data->connection_data->connection_state) {
+    case IOTC_CONNECTION_STATE_OPENING:
+    case IOTC_CONNECTION_STATE_OPENED:
+      return 0;
+    default:
+      return 1;
+  }
+}
+
+iotc_state_t iotc_offline_queue_append(iotc_context_data_t* context_data,
+                                       const char* topic,
+                                       const iotc_data_desc_t* payload,
+                                       iotc_mqtt_qos_t qos,
+                                       iotc_mqtt_retain_t retain,
+                                       iotc_event_handle_t callback) {
+  assert(NULL != context_data);
+  assert(NULL != topic);
+  assert(NULL != payload);
+
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_offline_queue_t* queue = context_data->offline_queue;
+  iotc_offline_queue_callback_t* queued_callback = NULL;
+  uint8_t header[IOTC_OFFLINE_QUEUE_HEADER_SIZE];
+
+  assert(NULL != queue);
+
+  const size_t topic_length = strlen(topic);
+
+  if (UINT16_MAX < topic_length) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  const size_t record_size =
+      IOTC_OFFLINE_QUEUE_HEADER_SIZE + topic_length + payload->length;
+
+  if (queue->max_bytes < record_size) {
+    return IOTC_OFFLINE_QUEUE_FULL;
+  }
+
+  if (IOTC_EVENT_HANDLE_UNSET != callback.handle_type) {
+    IOTC_ALLOC_AT(iotc_offline_queue_callback_t, queued_callback, state);
+    queued_callback->callback = callback;
+  }
+
+  while (queue->max_bytes - queue->size < record_size) {
+    if (IOTC_OFFLINE_QUEUE_DROP_OLDEST != queue->drop_policy ||
+        queue->head_seq == queue->tail_seq) {
+      state = IOTC_OFFLINE_QUEUE_FULL;
+      goto err_handling;
+    }
+
+    IOTC_CHECK_STATE(state = iotc_offline_queue_drop_head(context_data, queue));
+  }
+
+  /* a segment takes at least one record however large it is */
+  const size_t tail_size = queue->tail_offset + queue->write_buffer_length;
+
+  if (0 < tail_size && queue->segment_bytes < tail_size + record_size) {
+    IOTC_CHECK_STATE(state = iotc_offline_queue_roll(queue));
+  }
+
+  header[0] = IOTC_OFFLINE_QUEUE_RECORD_MAGIC;
+  header[1] = (uint8_t)((qos & IOTC_OFFLINE_QUEUE_QOS_MASK) |
+                        (retain ? IOTC_OFFLINE_QUEUE_RETAIN_FLAG : 0));
+  header[2] = (uint8_t)(topic_length >> 8);
+  header[3] = (uint8_t)topic_length;
+  iotc_offline_queue_put_u32(header + 4, payload->length);
+
+  const size_t record_offset = queue->tail_offset + queue->write_buffer_length;
+
+  IOTC_CHECK_STATE(state = iotc_offline_queue_write_record(
+                       queue, header, (const uint8_t*)topic, topic_length,
+                       payload));
+
+  queue->size += record_size;
+
+  if (NULL != queued_callback) {
+    queued_callback->seq = queue->tail_seq;
+    queued_callback->offset = record_offset;
+
+    IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_offline_queue_callback_t,
+                                  queue->callbacks, queue->callbacks_tail,
+                                  queued_callback);
+  }
+
+  if (0 < queue->write_buffer_length &&
+      NULL == queue->flush_event.ptr_to_position) {
+    iotc_evtd_execute_in(
+        context_data->evtd_instance,
+        iotc_make_handle(&iotc_offline_queue_flush_event, context_data),
+        IOTC_OFFLINE_QUEUE_FLUSH_MS, &queue->flush_event);
+  }
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  IOTC_SAFE_FREE(queued_callback);
+
+  return state;
+}
+
+iotc_state_t iotc_offline_queue_pop(iotc_offline_queue_t* queue,
+                                    char** out_topic,
+                                    iotc_data_desc_t** out_payload,
+                                    iotc_mqtt_qos_t* out_qos,
+                                    iotc_mqtt_retain_t* out_retain,
+                                    uint32_t* out_id) {
+  assert(NULL != queue);
+  assert(IOTC_OFFLINE_QUEUE_DRAIN_BATCH > queue->in_flight_count);
+
+  iotc_state_t state = IOTC_STATE_OK;
+  uint8_t header[IOTC_OFFLINE_QUEUE_HEADER_SIZE];
+  size_t topic_length = 0;
+  size_t payload_length = 0;
+  size_t record_size = 0;
+  char* topic = NULL;
+  iotc_data_desc_t* payload = NULL;
+
+  /* the reader sees the records still buffered too */
+  IOTC_CHECK_STATE(state = iotc_offline_queue_flush(queue));
+
+  while (1) {
+    if (!iotc_offline_queue_has_unread(queue)) {
+      return IOTC_FS_RESOURCE_NOT_AVAILABLE;
+    }
+
+    const size_t limit =
+        iotc_offline_queue_segment_size(queue, queue->read_seq);
+
+    if (limit <= queue->read_offset) {
+      iotc_offline_queue_reader_close(&queue->reader);
+      ++queue->read_seq;
+      queue->read_offset = 0;
+      continue;
+    }
+
+    if (IOTC_FS_INVALID_RESOURCE_HANDLE == queue->reader.handle) {
+      IOTC_CHECK_STATE(state = iotc_internals.fs_functions.open_resource(
+                           NULL, IOTC_FS_CONFIG_DATA,
+                           iotc_offline_queue_segment_name(queue,
+                                                           queue->read_seq),
+                           IOTC_FS_OPEN_READ | IOTC_FS_OPEN_MMAP,
+                           &queue->reader.handle));
+    }
+
+    if (IOTC_OFFLINE_QUEUE_HEADER_SIZE <= limit - queue->read_offset) {
+      IOTC_CHECK_STATE(state = iotc_offline_queue_reader_read(
+                           &queue->reader, queue->read_offset, header,
+                           sizeof(header)));
+
+      topic_length = ((size_t)header[2] << 8) | header[3];
+      payload_length = iotc_offline_queue_get_u32(header + 4);
+      record_size =
+          IOTC_OFFLINE_QUEUE_HEADER_SIZE + topic_length + payload_length;
+
+      if (IOTC_OFFLINE_QUEUE_RECORD_MAGIC == header[0] &&
+          record_size <= limit - queue->read_offset) {
+        break;
+      }
+    }
+
+    /* a record cut short by a crash, nothing after it can be trusted, the
+     * head passes it with the next message delivered */
+    iotc_debug_format("offline queue: segment %" PRIu32 " is damaged",
+                      queue->read_seq);
+
+    queue->read_offset = limit;
+  }
+
+  IOTC_ALLOC_BUFFER_AT(char, topic, topic_length + 1, state);
+  IOTC_CHECK_STATE(state = iotc_offline_queue_reader_read(
+                       &queue->reader,
+                       queue->read_offset + IOTC_OFFLINE_QUEUE_HEADER_SIZE,
+                       (uint8_t*)topic, topic_length));
+
+  payload = iotc_make_empty_desc_alloc(IOTC_MAX(payload_length, 1));
+  IOTC_CHECK_MEMORY(payload, state);
+  IOTC_CHECK_STATE(state = iotc_offline_queue_reader_read(
+                       &queue->reader,
+                       queue->read_offset + IOTC_OFFLINE_QUEUE_HEADER_SIZE +
+                           topic_length,
+                       payload->data_ptr, payload_length));
+  payload->length = (uint32_t)payload_length;
+
+  iotc_offline_queue_in_flight_t* in_flight =
+      &queue->in_flight[(queue->in_flight_first + queue->in_flight_count) %
+                        IOTC_OFFLINE_QUEUE_DRAIN_BATCH];
+
+  in_flight->id = queue->next_id++;
+  in_flight->seq = queue->read_seq;
+  in_flight->offset = queue->read_offset;
+  in_flight->end = queue->read_offset + record_size;
+  in_flight->done = 0;
+  in_flight->state = IOTC_STATE_OK;
+
+  ++queue->in_flight_count;
+  queue->read_offset += record_size;
+
+  *out_topic = topic;
+  *out_payload = payload;
+  *out_qos = (iotc_mqtt_qos_t)(header[1] & IOTC_OFFLINE_QUEUE_QOS_MASK);
+  *out_retain = (iotc_mqtt_retain_t)(0 != (header[1] &
+                                           IOTC_OFFLINE_QUEUE_RETAIN_FLAG));
+  *out_id = in_flight->id;
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  IOTC_SAFE_FREE(topic);
+  iotc_free_desc(&payload);
+
+  return state;
+}
+
+/* the message popped last is read again next time */
+static void iotc_offline_queue_put_back(iotc_offline_queue_t* queue) {
+  assert(0 < queue->in_flight_count);
+
+  --queue->in_flight_count;
+
+  const iotc_offline_queue_in_flight_t* in_flight =
+      &queue->in_flight[(queue->in_flight_first + queue->in_flight_count) %
+                        IOTC_OFFLINE_QUEUE_DRAIN_BATCH];
+
+  if (queue->read_seq != in_flight->seq) {
+    iotc_offline_queue_reader_close(&queue->reader);
+  }
+
+  queue->read_seq = in_flight->seq;
+  queue->read_offset = in_flight->offset;
+}
+
+iotc_state_t iotc_offline_queue_delivered(iotc_context_data_t* context_data,
+                                          uint32_t id, iotc_state_t state) {
+  assert(NULL != context_data);
+
+  iotc_state_t local_state = IOTC_STATE_OK;
+  iotc_offline_queue_t* queue = context_data->offline_queue;
+  uint8_t all_done = 1;
+  uint32_t i = 0;
+
+  /* a message handed to a connection that is gone isn't in flight anymore */
+  if (NULL == queue) {
+    return IOTC_STATE_OK;
+  }
+
+  for (; i < queue->in_flight_count; ++i) {
+    iotc_offline_queue_in_flight_t* in_flight =
+        &queue->in_flight[(queue->in_flight_first + i) %
+                          IOTC_OFFLINE_QUEUE_DRAIN_BATCH];
+
+    if (id == in_flight->id && !in_flight->done) {
+      in_flight->done = 1;
+      in_flight->state = state;
+    }
+
+    all_done &= in_flight->done;
+  }
+
+  /* the head only passes what is delivered in order */
+  while (0 < queue->in_flight_count) {
+    const iotc_offline_queue_in_flight_t in_flight =
+        queue->in_flight[queue->in_flight_first];
+
+    if (!in_flight.done || IOTC_STATE_OK != in_flight.state) {
+      break;
+    }
+
+    queue->in_flight_first =
+        (queue->in_flight_first + 1) % IOTC_OFFLINE_QUEUE_DRAIN_BATCH;
+    --queue->in_flight_count;
+
+    IOTC_CHECK_STATE(local_state = iotc_offline_queue_commit(
+                         context_data, queue, in_flight.seq, in_flight.end,
+                         IOTC_STATE_OK));
+  }
+
+  /* the failed messages go again, after them the ones handed out since */
+  if (0 < queue->in_flight_count && all_done) {
+    iotc_offline_queue_rewind(queue);
+  }
+
+  IOTC_CHECK_STATE(local_state =
+                       iotc_offline_queue_settle(context_data, queue));
+
+err_handling:
+  return local_state;
+}
+
+static iotc_state_t iotc_offline_queue_schedule_drain(void* context,
+                                                      uint32_t delay_ms) {
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+  iotc_offline_queue_t* queue = context_data->offline_queue;
+
+  if (NULL != queue->drain_event.ptr_to_position) {
+    return IOTC_STATE_OK;
+  }
+
+  return iotc_evtd_execute_in(context_data->evtd_instance,
+                              iotc_make_handle(&iotc_offline_queue_drain,
+                                               context),
+                              delay_ms, &queue->drain_event);
+}
+
+/* the callback of a drained message, takes the connectivity of the top
+ * layer */
+static iotc_state_t iotc_offline_queue_on_delivered(void* context, void* id,
+                                                    iotc_state_t state) {
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+  const iotc_state_t local_state =
+      iotc_offline_queue_delivered(context_data, (uint32_t)(uintptr_t)id, state);
+
+  if (IOTC_STATE_OK != local_state) {
+    iotc_debug_format("offline queue: failed to move the head: %d",
+                      local_state);
+  }
+
+  if (NULL != context_data->offline_queue &&
+      iotc_offline_queue_has_unread(context_data->offline_queue)) {
+    return iotc_offline_queue_schedule_drain(
+        context, (IOTC_STATE_OK == state) ? 0
+                                          : IOTC_OFFLINE_QUEUE_DRAIN_RETRY_MS);
+  }
+
+  return IOTC_STATE_OK;
+}
+
+/* hands the connection the queued messages while fewer than a batch of them
+ * are in flight, so the queue never has more of them in memory than the
+ * connection is sending */
+static iotc_state_t iotc_offline_queue_drain(void* context) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+  iotc_offline_queue_t* queue = context_data->offline_queue;
+
+  /* the MQTT logic layer sits right below the top layer */
+  const iotc_mqtt_logic_layer_data_t* layer_data =
+      (const iotc_mqtt_logic_layer_data_t*)((iotc_layer_connectivity_t*)context)
+          ->prev->user_data;
+
+  /* the next connection carries on */
+  if (NULL == queue || NULL == layer_data ||
+      NULL == context_data->connection_data ||
+      IOTC_CONNECTION_STATE_OPENED !=
+          context_data->connection_data->connection_state ||
+      IOTC_SHUTDOWN_UNINITIALISED != context_data->shutdown_state) {
+    return IOTC_STATE_OK;
+  }
+
+  while (IOTC_OFFLINE_QUEUE_DRAIN_BATCH > queue->in_flight_count &&
+         iotc_offline_queue_has_unread(queue)) {
+    char* topic = NULL;
+    iotc_data_desc_t* payload = NULL;
+    iotc_mqtt_qos_t qos = IOTC_MQTT_QOS_AT_MOST_ONCE;
+    iotc_mqtt_retain_t retain = IOTC_MQTT_RETAIN_FALSE;
+    uint32_t id = 0;
+
+    state = iotc_offline_queue_pop(queue, &topic, &payload, &qos, &retain, &id);
+
+    if (IOTC_FS_RESOURCE_NOT_AVAILABLE == state) {
+      return iotc_offline_queue_settle(context_data, queue);
+    }
+
+    IOTC_CHECK_STATE(state);
+
+    iotc_mqtt_logic_task_t* task = iotc_mqtt_logic_make_publish_task(
+        topic, IOTC_MEMORY_TYPE_MANAGED, payload, qos, retain,
+        iotc_make_handle(&iotc_offline_queue_on_delivered, context,
+                         (void*)(uintptr_t)id, IOTC_STATE_OK));
+
+    IOTC_SAFE_FREE(topic);
+
+    if (NULL == task) {
+      iotc_offline_queue_put_back(queue);
+      state = IOTC_OUT_OF_MEMORY;
+      goto err_handling;
+    }
+
+    /* the messages kept wait for the backoff and the in-flight window too */
+    if (IOTC_STATE_OK !=
+        iotc_mqtt_logic_publish_admit(context_data, layer_data, task)) {
+      iotc_offline_queue_put_back(queue);
+      iotc_mqtt_logic_free_task(&task);
+
+      return iotc_offline_queue_schedule_drain(
+          context, IOTC_OFFLINE_QUEUE_DRAIN_RETRY_MS);
+    }
+
+    IOTC_PROCESS_PUSH_ON_THIS_LAYER(context, task, IOTC_STATE_OK);
+  }
+
+  /* the callbacks of the messages in flight carry on */
+  return IOTC_STATE_OK;
+
+err_handling:
+  iotc_debug_format("offline queue: drain failed: %d", state);
+
+  if (iotc_offline_queue_has_unread(queue)) {
+    return iotc_offline_queue_schedule_drain(context,
+                                             IOTC_OFFLINE_QUEUE_DRAIN_RETRY_MS);
+  }
+
+  return state;
+}
+
+iotc_state_t iotc_offline_queue_connected(void* context) {
+  iotc_offline_queue_t* queue = IOTC_CONTEXT_DATA(context)->offline_queue;
+
+  if (NULL == queue) {
+    return IOTC_STATE_OK;
+  }
+
+  /* the previous connection took what it didn't deliver with it */
+  iotc_offline_queue_rewind(queue);
+
+  if (0 == queue->size) {
+    return IOTC_STATE_OK;
+  }
+
+  return iotc_offline_queue_schedule_drain(context, 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
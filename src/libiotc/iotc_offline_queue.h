@@ -0,0 +1,148 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef IOTC_OFFLINE_QUEUE_H
+#define IOTC_OFFLINE_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iotc_config.h"
+#include "iotc_data_desc.h"
+#include "iotc_event_dispatcher_api.h"
+#include "iotc_fs_api.h"
+
+#include <iotc_error.h>
+#include <iotc_mqtt.h>
+#include <iotc_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* reads a resource of the filesystem at any offset, keeping the chunk the
+ * filesystem handed out last */
+typedef struct iotc_offline_queue_reader_s {
+  iotc_fs_resource_handle_t handle;
+  const uint8_t* chunk;
+  size_t chunk_offset;
+  size_t chunk_size;
+} iotc_offline_queue_reader_t;
+
+/* a message handed to the connection, the head moves past it once the
+ * connection has delivered it */
+typedef struct iotc_offline_queue_in_flight_s {
+  uint32_t id;
+  uint32_t seq;
+  size_t offset;
+  size_t end;
+  uint8_t done;
+  iotc_state_t state;
+} iotc_offline_queue_in_flight_t;
+
+/* the callback of a message queued by this process, called when the message
+ * is delivered or dropped */
+typedef struct iotc_offline_queue_callback_s {
+  struct iotc_offline_queue_callback_s* __next;
+  uint32_t seq;
+  size_t offset;
+  iotc_event_handle_t callback;
+} iotc_offline_queue_callback_t;
+
+/* the publishes a context couldn't send, appended to the segment tail_seq,
+ * handed out from the segment read_seq and removed from the segment head_seq
+ * once delivered */
+typedef struct iotc_offline_queue_s {
+  char* name;
+  /* the name of the last segment or index resource asked for */
+  char* resource_name;
+  size_t resource_name_size;
+  size_t max_bytes;
+  size_t segment_bytes;
+  iotc_offline_queue_drop_policy_t drop_policy;
+  uint32_t head_seq;
+  uint32_t tail_seq;
+  /* the bytes not delivered yet, the write buffer included */
+  size_t size;
+  /* the tail segment stays open between the writes */
+  iotc_fs_resource_handle_t tail_handle;
+  size_t tail_offset;
+  uint8_t write_buffer[IOTC_OFFLINE_QUEUE_WRITE_BUFFER_SIZE];
+  size_t write_buffer_length;
+  size_t head_offset;
+  /* reads the segment read_seq */
+  iotc_offline_queue_reader_t reader;
+  uint32_t read_seq;
+  size_t read_offset;
+  /* the messages between the head and the read position, oldest first */
+  iotc_offline_queue_in_flight_t in_flight[IOTC_OFFLINE_QUEUE_DRAIN_BATCH];
+  uint32_t in_flight_first;
+  uint32_t in_flight_count;
+  uint32_t next_id;
+  iotc_offline_queue_callback_t* callbacks;
+  iotc_offline_queue_callback_t* callbacks_tail;
+  iotc_time_event_handle_t flush_event;
+  iotc_time_event_handle_t drain_event;
+} iotc_offline_queue_t;
+
+/* picks up the segments a previous queue of the same name left */
+extern iotc_state_t iotc_offline_queue_create(
+    const iotc_offline_queue_config_t* config, iotc_offline_queue_t** out_queue);
+
+/* writes what is buffered and frees the queue of a context */
+extern void iotc_offline_queue_destroy(struct iotc_context_data_s* context_data);
+
+/* whether the publishes of a context go to its queue, they do while the
+ * connection is down and until the queue is drained so the order is kept */
+extern uint8_t iotc_offline_queue_takes(
+    const struct iotc_context_data_s* context_data);
+
+/* the callback is called once the message is delivered, or with an error if
+ * it is dropped to make room */
+extern iotc_state_t iotc_offline_queue_append(
+    struct iotc_context_data_s* context_data, const char* topic,
+    const iotc_data_desc_t* payload, iotc_mqtt_qos_t qos,
+    iotc_mqtt_retain_t retain, iotc_event_handle_t callback);
+
+/* takes the connectivity of the top layer, starts handing the queued
+ * messages to the new connection, what the previous one didn't deliver is
+ * handed out again */
+extern iotc_state_t iotc_offline_queue_connected(void* context);
+
+extern iotc_state_t iotc_offline_queue_flush(iotc_offline_queue_t* queue);
+
+/* reads the oldest message not handed out yet and keeps it in flight under
+ * out_id, IOTC_FS_RESOURCE_NOT_AVAILABLE if there is none */
+extern iotc_state_t iotc_offline_queue_pop(iotc_offline_queue_t* queue,
+                                           char** out_topic,
+                                           iotc_data_desc_t** out_payload,
+                                           iotc_mqtt_qos_t* out_qos,
+                                           iotc_mqtt_retain_t* out_retain,
+                                           uint32_t* out_id);
+
+/* the connection is done with the message popped under id, the head moves
+ * past the messages delivered in order and, once none is left in flight,
+ * the ones that failed are handed out again */
+extern iotc_state_t iotc_offline_queue_delivered(
+    struct iotc_context_data_s* context_data, uint32_t id,
+    iotc_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTC_OFFLINE_QUEUE_H */
@@ -31,7 +31,7 @@ typedef struct iotc_timed_task_data_s {
   void* data;
   iotc_time_event_handle_t delayed_event;
   iotc_evtd_instance_t* dispatcher;
-  iotc_time_t seconds_repeat;
+  iotc_time_t milliseconds_repeat;
   iotc_timed_task_state_e state;
 } iotc_timed_task_data_t;
 
@@ -63,7 +63,8 @@ void iotc_destroy_timed_task_container(iotc_timed_task_container_t* container) {
 iotc_timed_task_handle_t iotc_add_timed_task(
     iotc_timed_task_container_t* container, iotc_evtd_instance_t* dispatcher,
     iotc_context_handle_t context_handle, iotc_user_task_callback_t* callback,
-    iotc_time_t seconds_from_now, const uint8_t repeats_forever, void* data) {
+    iotc_time_t milliseconds_from_now, const uint8_t repeats_forever,
+    void* data) {
   assert(NULL != container);
   assert(NULL != dispatcher);
   assert(IOTC_INVALID_CONTEXT_HANDLE < context_handle);
@@ -78,7 +79,7 @@ iotc_timed_task_handle_t iotc_add_timed_task(
   task->callback = callback;
   task->data = data;
   task->dispatcher = dispatcher;
-  task->seconds_repeat = (repeats_forever) ? seconds_from_now : 0;
+  task->milliseconds_repeat = (repeats_forever) ? milliseconds_from_now : 0;
   task->state = IOTC_TTS_SCHEDULED;
 
   iotc_lock_critical_section(container->cs);
@@ -94,7 +95,7 @@ iotc_timed_task_handle_t iotc_add_timed_task(
       iotc_evtd_execute_in(dispatcher,
                            iotc_make_handle(&iotc_timed_task_callback_wrapper,
                                             (void*)task, (void*)container),
-                           seconds_from_now, &task->delayed_event);
+                           milliseconds_from_now, &task->delayed_event);
 
   IOTC_CHECK_STATE(state);
 
@@ -165,7 +166,7 @@ iotc_state_t iotc_timed_task_callback_wrapper(void* void_task,
 
     iotc_lock_critical_section(container->cs);
 
-    if (0 == task->seconds_repeat || IOTC_TTS_DELETABLE == task->state) {
+    if (0 == task->milliseconds_repeat || IOTC_TTS_DELETABLE == task->state) {
       iotc_state_t del_state =
           iotc_delete_handle_for_object(container->timed_tasks_vector, task);
 
@@ -180,7 +181,7 @@ iotc_state_t iotc_timed_task_callback_wrapper(void* void_task,
           task->dispatcher,
           iotc_make_handle(&iotc_timed_task_callback_wrapper, (void*)task,
                            (void*)container),
-          task->seconds_repeat, &task->delayed_event);
+          task->milliseconds_repeat, &task->delayed_event);
       assert(IOTC_STATE_OK == state);
       task->state = IOTC_TTS_SCHEDULED;
     }
@@ -34,7 +34,8 @@ void iotc_destroy_timed_task_container(iotc_timed_task_container_t* container);
 iotc_timed_task_handle_t iotc_add_timed_task(
     iotc_timed_task_container_t* container, iotc_evtd_instance_t* dispatcher,
     iotc_context_handle_t context_handle, iotc_user_task_callback_t* callback,
-    iotc_time_t seconds_from_now, const uint8_t repeats_forever, void* data);
+    iotc_time_t milliseconds_from_now, const uint8_t repeats_forever,
+    void* data);
 
 void iotc_remove_timed_task(iotc_timed_task_container_t* container,
                             iotc_timed_task_handle_t timed_task_handle);
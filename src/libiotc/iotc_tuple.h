@@ -30,24 +30,25 @@
 #define IOTC_DEF_TUPLE_TYPE_IMPL(_1, _2, _3, _4, N, ...) N
 
 #ifdef IOTC_TUPLES_C
-#define IOTC_DEF_TUPLE_TYPE_1(type_name, a1_t)                  \
-  typedef struct {                                              \
-    a1_t a1;                                                    \
-  } type_name;                                                  \
-  type_name iotc_make_tuple_##type_name(a1_t a1) {              \
-    type_name ret;                                              \
-    ret.a1 = a1;                                                \
-    return ret;                                                 \
-  }                                                             \
-  type_name* iotc_alloc_make_tuple_##type_name(a1_t a1) {       \
-    type_name* ret = (type_name*)iotc_alloc(sizeof(type_name)); \
-    iotc_state_t state = IOTC_STATE_OK;                         \
-    IOTC_CHECK_MEMORY(ret, state);                              \
-    memset(ret, 0, sizeof(type_name));                          \
-    ret->a1 = a1;                                               \
-    return ret;                                                 \
-  err_handling:                                                 \
-    return 0;                                                   \
+#define IOTC_DEF_TUPLE_TYPE_1(type_name, a1_t)            \
+  typedef struct {                                        \
+    a1_t a1;                                              \
+  } type_name;                                            \
+  type_name iotc_make_tuple_##type_name(a1_t a1) {        \
+    type_name ret;                                        \
+    ret.a1 = a1;                                          \
+    return ret;                                           \
+  }                                                       \
+  type_name* iotc_alloc_make_tuple_##type_name(a1_t a1) { \
+    type_name* ret = (type_name*)iotc_alloc_pooled(       \
+        IOTC_MEM_POOL_TUPLE, sizeof(type_name));          \
+    iotc_state_t state = IOTC_STATE_OK;                   \
+    IOTC_CHECK_MEMORY(ret, state);                        \
+    memset(ret, 0, sizeof(type_name));                    \
+    ret->a1 = a1;                                         \
+    return ret;                                           \
+  err_handling:                                           \
+    return 0;                                             \
   }
 #else /* IOTC_TUPLES_C */
 #define IOTC_DEF_TUPLE_TYPE_1(type_name, a1_t)           \
@@ -71,7 +72,8 @@
     return ret;                                                    \
   }                                                                \
   type_name* iotc_alloc_make_tuple_##type_name(a1_t a1, a2_t a2) { \
-    type_name* ret = (type_name*)iotc_alloc(sizeof(type_name));    \
+    type_name* ret = (type_name*)iotc_alloc_pooled(                \
+        IOTC_MEM_POOL_TUPLE, sizeof(type_name));                   \
     iotc_state_t state = IOTC_STATE_OK;                            \
     IOTC_CHECK_MEMORY(ret, state);                                 \
     memset(ret, 0, sizeof(type_name));                             \
@@ -106,7 +108,8 @@
     return ret;                                                             \
   }                                                                         \
   type_name* iotc_alloc_make_tuple_##type_name(a1_t a1, a2_t a2, a3_t a3) { \
-    type_name* ret = (type_name*)iotc_alloc(sizeof(type_name));             \
+    type_name* ret = (type_name*)iotc_alloc_pooled(                         \
+        IOTC_MEM_POOL_TUPLE, sizeof(type_name));                            \
     iotc_state_t state = IOTC_STATE_OK;                                     \
     IOTC_CHECK_MEMORY(ret, state);                                          \
     memset(ret, 0, sizeof(type_name));                                      \
@@ -147,7 +150,8 @@
   }                                                                            \
   type_name* iotc_alloc_make_tuple_##type_name(a1_t a1, a2_t a2, a3_t a3,      \
                                                a4_t, a4) {                     \
-    type_name* ret = (type_name*)iotc_alloc(sizeof(type_name));                \
+    type_name* ret = (type_name*)iotc_alloc_pooled(                            \
+        IOTC_MEM_POOL_TUPLE, sizeof(type_name));                               \
     iotc_state_t state = IOTC_STATE_OK;                                        \
     IOTC_CHECK_MEMORY(ret, state);                                             \
     memset(ret, 0, sizeof(type_name));                                         \
@@ -17,6 +17,7 @@
 #ifndef __IOTC_TUPLES_H__
 #define __IOTC_TUPLES_H__
 
+#include "iotc_event_handle_typedef.h"
 #include "iotc_mqtt_message.h"
 #include "iotc_tuple.h"
 
@@ -24,7 +25,13 @@
 /* IOTC_DEF_TUPLE_TYPE( iotc_even_handle_and_void_t, iotc_event_handle_t, void*
  * ) */
 
-IOTC_DEF_TUPLE_TYPE(iotc_mqtt_written_data_t, uint16_t, iotc_mqtt_type_t)
+/**
+ *  \tuple iotc_mqtt_written_data_t confirms a written message. When the codec
+ *  holds a QoS 0 PUBLISH in a batch the third element is where the logic
+ *  layer hands over the user's callback, otherwise it is NULL.
+ */
+IOTC_DEF_TUPLE_TYPE(iotc_mqtt_written_data_t, uint16_t, iotc_mqtt_type_t,
+                    iotc_event_handle_t*)
 
 /**
  *  \tuple iotc_uint32_and_void_t will be used to differantiate between
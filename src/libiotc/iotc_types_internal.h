@@ -18,9 +18,12 @@
 #define __IOTC_TYPES_INTERNAL_H__
 
 #include <iotc_types.h>
+#include "iotc_backoff_status_api.h"
 #include "iotc_connection_data.h"
 #include "iotc_event_dispatcher_api.h"
+#include "iotc_jwt_rotation.h"
 #include "iotc_layer_chain.h"
+#include "iotc_topic_trie.h"
 #include "iotc_vector.h"
 
 #ifdef __cplusplus
@@ -52,7 +55,7 @@ typedef struct iotc_context_data_s {
  * enable/disable it via flags or defines. Bu for now,
  * let's use that simplified form. */
 #if 1 /* MQTT context part. */
-  iotc_vector_t* copy_of_handlers_for_topics;
+  iotc_topic_trie_t* copy_of_handlers_for_topics;
   void* copy_of_q12_unacked_messages_queue; /* We have to use void* because we
                                                don't want to create mqtt logic
                                                layer dependency. */
@@ -60,13 +63,30 @@ typedef struct iotc_context_data_s {
       void**); /* This is dstr for unacked messages. */
   uint16_t
       copy_of_last_msg_id; /* Value of the msg_id for continious session. */
+  /* the messages that didn't start before a JWT rotation swapped the
+   * connection, released by copy_of_q12_unacked_messages_queue_dtor_ptr */
+  void* copy_of_unsent_tasks_queue;
+  /* limits of the QoS 1 publishes waiting for a PUBACK, 0 is no limit */
+  uint32_t in_flight_window_messages;
+  size_t in_flight_window_bytes;
 #endif
+  /* the TLS session of the last connection, offered by the next one */
+  void* copy_of_tls_session;
+  void (*copy_of_tls_session_dtor_ptr)(void**);
   /* this is the common part */
   iotc_time_event_handle_t connect_handler;
+  iotc_backoff_status_t backoff_status;
+  iotc_jwt_rotation_t jwt_rotation;
+  /* the publishes kept while the connection is down, NULL sends or fails
+   * them right away */
+  struct iotc_offline_queue_s* offline_queue;
   /* vector or a list of timeouts */
   iotc_vector_t* io_timeouts;
   iotc_connection_data_t* connection_data;
   iotc_evtd_instance_t* evtd_instance;
+  /* the I/O loop owning evtd_instance, NULL if it's driven by the event loop
+   * of the application */
+  struct iotc_io_loop_s* io_loop;
   iotc_event_handle_t connection_callback;
   iotc_shutdown_state_t shutdown_state;
 
@@ -15,12 +15,20 @@
  */
 #include "iotc_allocator.h"
 #include "iotc_bsp_mem.h"
+#include "iotc_mem_pool.h"
 #include <stdint.h>
 
 extern void* memset(void* ptr, int value, size_t num);
+extern void* memcpy(void* destination, const void* source, size_t num);
 
 void* __iotc_alloc(size_t byte_count) { return iotc_bsp_mem_alloc(byte_count); }
 
+void* __iotc_alloc_pooled(iotc_mem_pool_type_t type, size_t byte_count) {
+  void* ret = iotc_mem_pool_alloc(type, byte_count);
+
+  return (NULL != ret) ? ret : iotc_bsp_mem_alloc(byte_count);
+}
+
 void* __iotc_calloc(size_t num, size_t byte_count) {
   const size_t size_to_allocate = num * byte_count;
 
@@ -29,7 +37,7 @@ void* __iotc_calloc(size_t num, size_t byte_count) {
     return NULL;
   }
 
-  void* ret = iotc_bsp_mem_alloc(size_to_allocate);
+  void* ret = __iotc_alloc(size_to_allocate);
 
   /* It's unspecified if memset works with NULL pointer. */
   if (NULL != ret) {
@@ -39,7 +47,28 @@ void* __iotc_calloc(size_t num, size_t byte_count) {
 }
 
 void* __iotc_realloc(void* ptr, size_t byte_count) {
-  return iotc_bsp_mem_realloc(ptr, byte_count);
+  const size_t block_size = iotc_mem_pool_block_size(ptr);
+
+  if (0 == block_size) {
+    return iotc_bsp_mem_realloc(ptr, byte_count);
+  }
+
+  if (byte_count <= block_size) {
+    return ptr;
+  }
+
+  void* ret = __iotc_alloc(byte_count);
+
+  if (NULL != ret) {
+    memcpy(ret, ptr, block_size);
+    iotc_mem_pool_free(ptr);
+  }
+
+  return ret;
 }
 
-void __iotc_free(void* ptr) { iotc_bsp_mem_free(ptr); }
+void __iotc_free(void* ptr) {
+  if (0 == iotc_mem_pool_free(ptr)) {
+    iotc_bsp_mem_free(ptr);
+  }
+}
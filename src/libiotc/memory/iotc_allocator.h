@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include "iotc_config.h"
+#include "iotc_mem_pool.h"
 
 #ifdef IOTC_MEMORY_LIMITER_ENABLED
 #include "iotc_memory_limiter.h"
@@ -38,6 +39,13 @@ extern "C" {
  */
 extern void* __iotc_alloc(size_t b);
 
+/**
+ * @brief Allocates b bytes for an object of the given type, from the type's
+ * memory pool while it has idle blocks and from the BSP otherwise.
+ * @note The result is released with __iotc_free like any other allocation.
+ */
+extern void* __iotc_alloc_pooled(iotc_mem_pool_type_t type, size_t b);
+
 /**
  * @brief Allocates the number of elements given by the num parameter of size
  * described by size argument.
@@ -68,6 +76,16 @@ extern void* __iotc_realloc(void* ptr, size_t b);
  */
 extern void __iotc_free(void* ptr);
 
+/**
+ * @brief The number of bytes the facade adds to each request before it
+ * reaches __iotc_alloc, memory pools are sized with it in mind.
+ */
+#ifdef IOTC_MEMORY_LIMITER_ENABLED
+#define IOTC_ALLOC_OVERHEAD sizeof(iotc_memory_limiter_entry_t)
+#else
+#define IOTC_ALLOC_OVERHEAD 0
+#endif
+
 /**
  * @brief Macro to make thin facade for debug and memory limiting.
  */
@@ -78,6 +96,19 @@ extern void __iotc_free(void* ptr);
 #define iotc_alloc __iotc_alloc
 #endif
 
+/**
+ * @brief Macro to make thin facade for pooled objects. A pooled block isn't
+ * counted by the memory limiter, its slab is.
+ */
+#ifdef IOTC_MEMORY_LIMITER_ENABLED
+#define iotc_alloc_pooled(type, b)                                       \
+  iotc_memory_limiter_alloc_pooled(                                      \
+      IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_APPLICATION, type, b, __FILE__, \
+      __LINE__)
+#else
+#define iotc_alloc_pooled __iotc_alloc_pooled
+#endif
+
 #ifdef IOTC_MEMORY_LIMITER_ENABLED
 #define iotc_calloc(num, byte_count) \
   iotc_memory_limiter_calloc_application(num, byte_count, __FILE__, __LINE__)
@@ -112,6 +143,14 @@ extern void __iotc_free(void* ptr);
 #define iotc_alloc_system(b) __iotc_alloc(b)
 #endif
 
+#ifdef IOTC_MEMORY_LIMITER_ENABLED
+#define iotc_alloc_system_pooled(type, b)                                     \
+  iotc_memory_limiter_alloc_pooled(IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_SYSTEM, \
+                                   type, b, __FILE__, __LINE__)
+#else
+#define iotc_alloc_system_pooled(type, b) __iotc_alloc_pooled(type, b)
+#endif
+
 #ifdef IOTC_MEMORY_LIMITER_ENABLED
 #define iotc_calloc_system(num, byte_count) \
   iotc_memory_limiter_calloc_system(num, byte_count, __FILE__, __LINE__)
@@ -0,0 +1,319 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "iotc_allocator.h"
+#include "iotc_atomic.h"
+#include "iotc_critical_section.h"
+#include "iotc_critical_section_def.h"
+#include "iotc_debug.h"
+#include "iotc_mem_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* an idle block stores the link to the next idle block in its first bytes */
+typedef struct iotc_mem_pool_block_s {
+  struct iotc_mem_pool_block_s* __next;
+} iotc_mem_pool_block_t;
+
+typedef struct iotc_mem_pool_s {
+  uint8_t* slab;
+  uint8_t* slab_end;
+  size_t block_size;
+  size_t idle_count;
+  iotc_mem_pool_block_t* idle_blocks;
+} iotc_mem_pool_t;
+
+/* indexed by type, a type without blocks has no slab, the slabs of all the
+ * types are cut from one region */
+static iotc_mem_pool_t iotc_mem_pools[IOTC_MEM_POOL_TYPE_COUNT];
+static uint8_t iotc_mem_pools_created = 0;
+
+/* the bounds of the region, NULL without pools. Most of the frees and
+ * reallocs are of blocks that aren't pooled, these are told apart by the
+ * bounds alone and never take the lock */
+static void* iotc_mem_pools_begin = NULL;
+static void* iotc_mem_pools_end = NULL;
+
+/* static initialisation of the critical section */
+static struct iotc_critical_section_s iotc_mem_pool_cs = {0};
+
+static size_t iotc_mem_pool_round_up(size_t size) {
+  if (size < sizeof(iotc_mem_pool_block_t)) {
+    size = sizeof(iotc_mem_pool_block_t);
+  }
+
+  return (size + IOTC_MEM_POOL_ALIGNMENT - 1) &
+         ~((size_t)IOTC_MEM_POOL_ALIGNMENT - 1);
+}
+
+/* lock free, a block handed out by a pool is always within the bounds as
+ * they are published before the first block and cleared after the last one
+ * has come back */
+static uint8_t iotc_mem_pool_may_own(const void* ptr) {
+  const uint8_t* const begin =
+      (const uint8_t*)iotc_atomic_load_ptr(&iotc_mem_pools_begin);
+  const uint8_t* const end =
+      (const uint8_t*)iotc_atomic_load_ptr(&iotc_mem_pools_end);
+  const uint8_t* const block = (const uint8_t*)ptr;
+
+  return (begin <= block && block < end) ? 1 : 0;
+}
+
+/* the caller holds iotc_mem_pool_cs */
+static iotc_mem_pool_t* iotc_mem_pool_find_by_ptr(const void* ptr) {
+  const uint8_t* const block = (const uint8_t*)ptr;
+  size_t pool_id = 0;
+
+  for (pool_id = 0; pool_id < IOTC_MEM_POOL_TYPE_COUNT; ++pool_id) {
+    if (iotc_mem_pools[pool_id].slab <= block &&
+        block < iotc_mem_pools[pool_id].slab_end) {
+      return &iotc_mem_pools[pool_id];
+    }
+  }
+
+  return NULL;
+}
+
+static size_t iotc_mem_pool_block_count(const iotc_mem_pool_t* pool) {
+  return (0 == pool->block_size)
+             ? 0
+             : (size_t)(pool->slab_end - pool->slab) / pool->block_size;
+}
+
+static iotc_state_t iotc_mem_pool_publish(const iotc_mem_pool_t* pools,
+                                          void* region, void* region_end) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  iotc_lock_critical_section(&iotc_mem_pool_cs);
+
+  if (0 == iotc_mem_pools_created) {
+    memcpy(iotc_mem_pools, pools, sizeof(iotc_mem_pools));
+    iotc_mem_pools_created = 1;
+
+    iotc_atomic_store_ptr(&iotc_mem_pools_end, region_end);
+    iotc_atomic_store_ptr(&iotc_mem_pools_begin, region);
+  } else {
+    state = IOTC_ALREADY_INITIALIZED;
+  }
+
+  iotc_unlock_critical_section(&iotc_mem_pool_cs);
+
+  return state;
+}
+
+iotc_state_t iotc_mem_pool_create(const iotc_mem_pool_config_t* config,
+                                  size_t config_size) {
+  if (NULL == config && 0 != config_size) {
+    return IOTC_INVALID_PARAMETER;
+  }
+
+  /* just to satisfy the compiler */
+  (void)iotc_mem_pool_cs;
+
+  /* the slabs are set up aside and published at once, so a concurrent free
+   * never sees a half made pool */
+  iotc_mem_pool_t pools[IOTC_MEM_POOL_TYPE_COUNT];
+  memset(pools, 0, sizeof(pools));
+
+  uint8_t configured[IOTC_MEM_POOL_TYPE_COUNT] = {0};
+  size_t region_size = 0;
+  size_t config_id = 0;
+
+  for (config_id = 0; config_id < config_size; ++config_id) {
+    const iotc_mem_pool_config_t* entry = &config[config_id];
+
+    if (IOTC_MEM_POOL_TYPE_COUNT <= (size_t)entry->type ||
+        0 != configured[entry->type]) {
+      return IOTC_INVALID_PARAMETER;
+    }
+
+    configured[entry->type] = 1;
+
+    if (0 != entry->block_size) {
+      region_size +=
+          iotc_mem_pool_round_up(entry->block_size) * entry->block_count;
+    }
+  }
+
+  if (0 == region_size) {
+    return iotc_mem_pool_publish(pools, NULL, NULL);
+  }
+
+  uint8_t* const region = (uint8_t*)iotc_alloc_system(region_size);
+
+  if (NULL == region) {
+    return IOTC_OUT_OF_MEMORY;
+  }
+
+  uint8_t* slab = region;
+
+  for (config_id = 0; config_id < config_size; ++config_id) {
+    const iotc_mem_pool_config_t* entry = &config[config_id];
+
+    if (0 == entry->block_count || 0 == entry->block_size) {
+      continue;
+    }
+
+    iotc_mem_pool_t* pool = &pools[entry->type];
+    const size_t block_size = iotc_mem_pool_round_up(entry->block_size);
+
+    pool->slab = slab;
+    pool->slab_end = slab + block_size * entry->block_count;
+    pool->block_size = block_size;
+    pool->idle_count = entry->block_count;
+    slab = pool->slab_end;
+
+    /* thread the free list back to front so blocks are handed out in address
+     * order */
+    size_t block_id = entry->block_count;
+    while (0 < block_id) {
+      --block_id;
+      iotc_mem_pool_block_t* block =
+          (iotc_mem_pool_block_t*)(pool->slab + block_id * block_size);
+      block->__next = pool->idle_blocks;
+      pool->idle_blocks = block;
+    }
+  }
+
+  const iotc_state_t state = iotc_mem_pool_publish(pools, region, slab);
+
+  if (IOTC_STATE_OK != state) {
+    iotc_free(region);
+  }
+
+  return state;
+}
+
+iotc_state_t iotc_mem_pool_destroy(void) {
+  size_t pool_id = 0;
+
+  iotc_lock_critical_section(&iotc_mem_pool_cs);
+
+  for (pool_id = 0; pool_id < IOTC_MEM_POOL_TYPE_COUNT; ++pool_id) {
+    const iotc_mem_pool_t* pool = &iotc_mem_pools[pool_id];
+
+    if (pool->idle_count != iotc_mem_pool_block_count(pool)) {
+      iotc_debug_format("%lu pooled blocks of %lu bytes still in use",
+                        (unsigned long)(iotc_mem_pool_block_count(pool) -
+                                        pool->idle_count),
+                        (unsigned long)pool->block_size);
+      iotc_unlock_critical_section(&iotc_mem_pool_cs);
+      return IOTC_INTERNAL_ERROR;
+    }
+  }
+
+  void* const region = iotc_mem_pools_begin;
+
+  iotc_atomic_store_ptr(&iotc_mem_pools_begin, NULL);
+  iotc_atomic_store_ptr(&iotc_mem_pools_end, NULL);
+  memset(iotc_mem_pools, 0, sizeof(iotc_mem_pools));
+  iotc_mem_pools_created = 0;
+
+  iotc_unlock_critical_section(&iotc_mem_pool_cs);
+
+  /* freeing the region comes back here through the allocator, the lock has
+   * to be released by then */
+  iotc_free(region);
+
+  return IOTC_STATE_OK;
+}
+
+void* iotc_mem_pool_alloc(iotc_mem_pool_type_t type, size_t size) {
+  iotc_mem_pool_block_t* block = NULL;
+
+  if (IOTC_MEM_POOL_TYPE_COUNT <= (size_t)type ||
+      NULL == iotc_atomic_load_ptr(&iotc_mem_pools_begin)) {
+    return NULL;
+  }
+
+  iotc_lock_critical_section(&iotc_mem_pool_cs);
+
+  iotc_mem_pool_t* pool = &iotc_mem_pools[type];
+
+  /* an exhausted pool falls back to the BSP, another type's pool is never
+   * borrowed from */
+  if (size <= pool->block_size && NULL != pool->idle_blocks) {
+    block = pool->idle_blocks;
+    pool->idle_blocks = block->__next;
+    --pool->idle_count;
+  }
+
+  iotc_unlock_critical_section(&iotc_mem_pool_cs);
+
+  return block;
+}
+
+int iotc_mem_pool_free(void* ptr) {
+  if (0 == iotc_mem_pool_may_own(ptr)) {
+    return 0;
+  }
+
+  iotc_lock_critical_section(&iotc_mem_pool_cs);
+
+  iotc_mem_pool_t* pool = iotc_mem_pool_find_by_ptr(ptr);
+
+  if (NULL != pool) {
+    iotc_mem_pool_block_t* block = (iotc_mem_pool_block_t*)ptr;
+
+    block->__next = pool->idle_blocks;
+    pool->idle_blocks = block;
+    ++pool->idle_count;
+  }
+
+  iotc_unlock_critical_section(&iotc_mem_pool_cs);
+
+  return (NULL == pool) ? 0 : 1;
+}
+
+size_t iotc_mem_pool_block_size(const void* ptr) {
+  if (0 == iotc_mem_pool_may_own(ptr)) {
+    return 0;
+  }
+
+  iotc_lock_critical_section(&iotc_mem_pool_cs);
+
+  const iotc_mem_pool_t* pool = iotc_mem_pool_find_by_ptr(ptr);
+  const size_t block_size = (NULL == pool) ? 0 : pool->block_size;
+
+  iotc_unlock_critical_section(&iotc_mem_pool_cs);
+
+  return block_size;
+}
+
+size_t iotc_mem_pool_get_idle_space(void) {
+  size_t idle_space = 0;
+  size_t pool_id = 0;
+
+  iotc_lock_critical_section(&iotc_mem_pool_cs);
+
+  for (pool_id = 0; pool_id < IOTC_MEM_POOL_TYPE_COUNT; ++pool_id) {
+    idle_space +=
+        iotc_mem_pools[pool_id].idle_count * iotc_mem_pools[pool_id].block_size;
+  }
+
+  iotc_unlock_critical_section(&iotc_mem_pool_cs);
+
+  return idle_space;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,110 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IOTC_MEM_POOL_H__
+#define __IOTC_MEM_POOL_H__
+
+#include <stddef.h>
+
+#include <iotc_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef IOTC_MEM_POOL_ALIGNMENT
+#define IOTC_MEM_POOL_ALIGNMENT 8
+#endif
+
+/**
+ * @brief the objects that can be served from a pool, each type has a pool of
+ * its own
+ */
+typedef enum iotc_mem_pool_type_e {
+  IOTC_MEM_POOL_DATA_DESC = 0,
+  IOTC_MEM_POOL_MQTT_MESSAGE,
+  IOTC_MEM_POOL_MQTT_TASK,
+  IOTC_MEM_POOL_MQTT_TASK_DATA,
+  IOTC_MEM_POOL_TUPLE,
+  IOTC_MEM_POOL_BUFFER,
+  IOTC_MEM_POOL_EVENT_HANDLE,
+  IOTC_MEM_POOL_TYPE_COUNT
+} iotc_mem_pool_type_t;
+
+/**
+ * @brief describes the pool of one type: the size of its blocks and how many
+ * blocks it reserves
+ */
+typedef struct iotc_mem_pool_config_s {
+  iotc_mem_pool_type_t type;
+  size_t block_size;
+  size_t block_count;
+} iotc_mem_pool_config_t;
+
+/**
+ * @brief reserves one slab per configured type
+ *
+ * Entries with no blocks are skipped. The slabs are cut from one region taken
+ * with iotc_alloc_system, so the memory limiter counts them, and a pointer
+ * outside of the region is known not to be pooled without taking a lock.
+ *
+ * @return IOTC_ALREADY_INITIALIZED if the pools exist,
+ *         IOTC_INVALID_PARAMETER if a type is unknown or configured twice,
+ *         IOTC_OUT_OF_MEMORY if a slab can't be allocated
+ */
+extern iotc_state_t iotc_mem_pool_create(const iotc_mem_pool_config_t* config,
+                                         size_t config_size);
+
+/**
+ * @brief releases the slabs
+ *
+ * The slabs are kept if any block is still in use, freeing such a block
+ * later must still find its pool.
+ *
+ * @return IOTC_INTERNAL_ERROR if a block is still in use
+ */
+extern iotc_state_t iotc_mem_pool_destroy(void);
+
+/**
+ * @brief takes a block from the pool of the type
+ *
+ * @return NULL if the type has no pool, its blocks are smaller than size or
+ *         it has no idle blocks
+ */
+extern void* iotc_mem_pool_alloc(iotc_mem_pool_type_t type, size_t size);
+
+/**
+ * @brief returns a block to its pool
+ *
+ * @return 1 if ptr belongs to a pool, 0 if it has to be freed elsewhere
+ */
+extern int iotc_mem_pool_free(void* ptr);
+
+/**
+ * @return the size of the block behind ptr, 0 if ptr isn't pooled
+ */
+extern size_t iotc_mem_pool_block_size(const void* ptr);
+
+/**
+ * @return the number of bytes held by idle blocks of all pools
+ */
+extern size_t iotc_mem_pool_get_idle_space(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IOTC_MEM_POOL_H__ */
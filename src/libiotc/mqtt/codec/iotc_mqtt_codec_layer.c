@@ -16,7 +16,10 @@
 
 #include "iotc_mqtt_codec_layer.h"
 #include "iotc.h"
+#include "iotc_atomic.h"
 #include "iotc_coroutine.h"
+#include "iotc_event_thread_dispatcher.h"
+#include "iotc_globals.h"
 #include "iotc_layer_api.h"
 #include "iotc_layer_macros.h"
 #include "iotc_list.h"
@@ -29,6 +32,27 @@
 extern "C" {
 #endif
 
+/* Calls the users back for the messages of a batch, a written batch confirms
+ * them with IOTC_STATE_OK. */
+static void iotc_mqtt_codec_layer_complete_batched(
+    void* context, iotc_mqtt_codec_layer_task_t* batched, iotc_state_t state) {
+  if (IOTC_STATE_WRITTEN == state) {
+    state = IOTC_STATE_OK;
+  }
+
+  for (; NULL != batched; batched = batched->__next) {
+    if (0 == iotc_handle_disposed(&batched->callback)) {
+      iotc_event_handle_t handle = batched->callback;
+      handle.handlers.h3.a3 = state;
+
+      iotc_evttd_execute_ordered(IOTC_CONTEXT_DATA(context)->evtd_instance,
+                                 handle, IOTC_CONTEXT_DATA(context));
+
+      batched->callback = iotc_make_empty_handle();
+    }
+  }
+}
+
 static void clear_task_queue(void* context) {
   /* PRE-CONDITIONS */
   assert(context != 0);
@@ -40,15 +64,24 @@ static void clear_task_queue(void* context) {
   while (layer_data->task_queue) {
     iotc_mqtt_codec_layer_task_t* tmp_task = 0;
 
-    IOTC_LIST_POP(iotc_mqtt_codec_layer_task_t, layer_data->task_queue,
-                  tmp_task);
-
-    iotc_mqtt_written_data_t* written_data =
-        (iotc_mqtt_written_data_t*)iotc_alloc_make_tuple(
-            iotc_mqtt_written_data_t, tmp_task->msg_id, tmp_task->msg_type);
-
-    IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, written_data,
-                                    IOTC_STATE_FAILED_WRITING);
+    IOTC_LIST_POP_WITH_TAIL(iotc_mqtt_codec_layer_task_t,
+                            layer_data->task_queue, layer_data->task_queue_tail,
+                            tmp_task);
+
+    /* the messages of a batch task have been confirmed already, only their
+     * users are waiting */
+    if (NULL == tmp_task->batched) {
+      iotc_mqtt_written_data_t* written_data =
+          (iotc_mqtt_written_data_t*)iotc_alloc_make_tuple(
+              iotc_mqtt_written_data_t, tmp_task->msg_id, tmp_task->msg_type,
+              NULL);
+
+      IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, written_data,
+                                      IOTC_STATE_FAILED_WRITING);
+    } else {
+      iotc_mqtt_codec_layer_complete_batched(context, tmp_task->batched,
+                                             IOTC_STATE_FAILED_WRITING);
+    }
 
     iotc_mqtt_codec_layer_free_task(&tmp_task);
   }
@@ -57,6 +90,232 @@ static void clear_task_queue(void* context) {
   assert(layer_data->task_queue == 0);
 }
 
+/* Drops the pending batch, its messages fail with IOTC_STATE_FAILED_WRITING. */
+static void iotc_mqtt_codec_layer_discard_batch(void* context) {
+  iotc_mqtt_codec_layer_data_t* layer_data =
+      (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
+
+  if (NULL != layer_data->batch_timeout.ptr_to_position) {
+    iotc_evtd_cancel(IOTC_CONTEXT_DATA(context)->evtd_instance,
+                     &layer_data->batch_timeout);
+  }
+
+  iotc_mqtt_codec_layer_complete_batched(context, layer_data->batched,
+                                         IOTC_STATE_FAILED_WRITING);
+
+  while (NULL != layer_data->batched) {
+    iotc_mqtt_codec_layer_task_t* tmp_task = NULL;
+    IOTC_LIST_POP(iotc_mqtt_codec_layer_task_t, layer_data->batched, tmp_task);
+    iotc_mqtt_codec_layer_free_task(&tmp_task);
+  }
+
+  iotc_free_desc(&layer_data->batch);
+}
+
+/* Moves the pending batch to the task queue, so that it is written in order
+ * with the other messages. */
+static iotc_state_t iotc_mqtt_codec_layer_flush_batch(void* context) {
+  iotc_mqtt_codec_layer_data_t* layer_data =
+      (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
+
+  iotc_state_t state = IOTC_STATE_OK;
+
+  if (NULL == layer_data || NULL == layer_data->batch) {
+    return IOTC_STATE_OK;
+  }
+
+  if (NULL != layer_data->batch_timeout.ptr_to_position) {
+    iotc_evtd_cancel(IOTC_CONTEXT_DATA(context)->evtd_instance,
+                     &layer_data->batch_timeout);
+  }
+
+  iotc_mqtt_codec_layer_task_t* task = iotc_mqtt_codec_layer_make_batch_task(
+      layer_data->batch, layer_data->batched);
+
+  IOTC_CHECK_MEMORY(task, state);
+
+  layer_data->batch = NULL;
+  layer_data->batched = NULL;
+
+  IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_mqtt_codec_layer_task_t,
+                                layer_data->task_queue,
+                                layer_data->task_queue_tail, task);
+
+  if (IOTC_CR_IS_RUNNING(layer_data->push_cs)) {
+    return IOTC_STATE_OK;
+  }
+
+  return iotc_mqtt_codec_layer_push(context, NULL, IOTC_STATE_WANT_WRITE);
+
+err_handling:
+  iotc_mqtt_codec_layer_discard_batch(context);
+  return state;
+}
+
+static iotc_state_t iotc_mqtt_codec_layer_batch_timeout(void* data) {
+  iotc_layer_connectivity_t* context = data;
+
+  iotc_mqtt_codec_layer_data_t* layer_data =
+      (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
+
+  if (NULL == layer_data) {
+    return IOTC_STATE_OK;
+  }
+
+  layer_data->batch_timeout.ptr_to_position = NULL;
+
+  return iotc_mqtt_codec_layer_flush_batch(context);
+}
+
+/* Fails a message that couldn't be queued. */
+static iotc_state_t iotc_mqtt_codec_layer_fail_message(
+    void* context, iotc_mqtt_message_t* msg) {
+  const uint16_t msg_id = iotc_mqtt_get_message_id(msg);
+  const iotc_mqtt_type_t msg_type =
+      (iotc_mqtt_type_t)msg->common.common_u.common_bits.type;
+
+  iotc_mqtt_message_free(&msg);
+
+  iotc_mqtt_written_data_t* written_data =
+      iotc_alloc_make_tuple(iotc_mqtt_written_data_t, msg_id, msg_type, NULL);
+
+  if (NULL == written_data) {
+    return IOTC_OUT_OF_MEMORY;
+  }
+
+  return IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, written_data,
+                                         IOTC_STATE_FAILED_WRITING);
+}
+
+/* Serialises a QoS 0 PUBLISH at the end of the pending batch and confirms it
+ * to the next layer right away, so that the next message can join the batch.
+ * The confirmation lets the publish task release its payload, so the batch
+ * holds a copy of it, and hands the user's callback over to the batch, so
+ * that the user learns when the batch is written or dropped. */
+static iotc_state_t iotc_mqtt_codec_layer_batch_message(
+    void* context, iotc_mqtt_message_t* msg) {
+  iotc_mqtt_codec_layer_data_t* layer_data =
+      (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
+
+  const uint16_t msg_id = iotc_mqtt_get_message_id(msg);
+  const size_t max_bytes =
+      iotc_atomic_load_size(&iotc_globals.publish_coalescing_max_bytes);
+  iotc_mqtt_codec_layer_task_t* task = NULL;
+  iotc_mqtt_written_data_t* written_data = NULL;
+  size_t msg_contents_size = 0;
+  size_t remaining_len = 0;
+  size_t publish_payload_len = 0;
+  size_t batch_length = 0;
+  iotc_state_t state = IOTC_STATE_OK;
+
+  iotc_mqtt_serialiser_t serializer;
+  iotc_mqtt_serialiser_init(&serializer);
+
+  state = iotc_mqtt_serialiser_size(&msg_contents_size, &remaining_len,
+                                    &publish_payload_len, NULL, msg);
+
+  IOTC_CHECK_STATE(state);
+
+  task = iotc_mqtt_codec_layer_make_task(msg);
+
+  IOTC_CHECK_MEMORY(task, state);
+
+  written_data = iotc_alloc_make_tuple(iotc_mqtt_written_data_t, msg_id,
+                                       IOTC_MQTT_TYPE_PUBLISH, &task->callback);
+
+  IOTC_CHECK_MEMORY(written_data, state);
+
+  /* the frames are written back to back into one buffer, so that the batch
+   * leaves in one write however many messages it holds */
+  if (NULL == layer_data->batch) {
+    layer_data->batch =
+        iotc_make_empty_desc_alloc(IOTC_MAX(msg_contents_size, max_bytes));
+
+    IOTC_CHECK_MEMORY(layer_data->batch, state);
+  }
+
+  batch_length = layer_data->batch->length;
+
+  IOTC_CHECK_STATE(state = iotc_data_desc_assure_buf_len(layer_data->batch,
+                                                         msg_contents_size));
+
+  if (IOTC_MQTT_SERIALISER_RC_ERROR ==
+      iotc_mqtt_serialiser_write(&serializer, msg, layer_data->batch,
+                                 msg_contents_size - publish_payload_len,
+                                 remaining_len)) {
+    state = IOTC_MQTT_SERIALIZER_ERROR;
+    goto err_handling;
+  }
+
+  if (msg->publish.content->length > 0) {
+    IOTC_CHECK_STATE(state = iotc_data_desc_append_bytes(
+                         layer_data->batch, msg->publish.content->data_ptr,
+                         msg->publish.content->length));
+  }
+
+  /* the batch keeps a copy, only the callback is needed from now on */
+  iotc_mqtt_message_free(&task->msg);
+
+  IOTC_LIST_PUSH_BACK(iotc_mqtt_codec_layer_task_t, layer_data->batched, task);
+
+  iotc_atomic_add_u32(&iotc_globals.io_stats.messages_sent, 1);
+
+  state = IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, written_data,
+                                          IOTC_STATE_WRITTEN);
+
+  /* the confirmation may have closed the layer or queued more messages */
+  layer_data =
+      (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
+
+  if (NULL == layer_data || NULL == layer_data->batch) {
+    return state;
+  }
+
+  if (layer_data->batch->length >= max_bytes) {
+    return iotc_mqtt_codec_layer_flush_batch(context);
+  }
+
+  if (NULL == layer_data->batch_timeout.ptr_to_position &&
+      IOTC_STATE_OK !=
+          iotc_evtd_execute_in(
+              IOTC_CONTEXT_DATA(context)->evtd_instance,
+              iotc_make_handle(&iotc_mqtt_codec_layer_batch_timeout, context),
+              iotc_atomic_load_u32(
+                  &iotc_globals.publish_coalescing_max_delay_ms),
+              &layer_data->batch_timeout)) {
+    /* without a timer nothing would write the batch */
+    return iotc_mqtt_codec_layer_flush_batch(context);
+  }
+
+  return state;
+
+err_handling:
+  iotc_debug_format("[m.id[%d]] mqtt_codec_layer batching error: %s", msg_id,
+                    iotc_get_state_string(state));
+
+  /* drop what was written of this frame */
+  if (NULL != layer_data->batch) {
+    layer_data->batch->length = batch_length;
+
+    if (0 == batch_length) {
+      iotc_free_desc(&layer_data->batch);
+    }
+  }
+
+  IOTC_SAFE_FREE_TUPLE(written_data);
+
+  if (NULL != task) {
+    /* the task owns the msg from now on */
+    msg = task->msg;
+    task->msg = NULL;
+    iotc_mqtt_codec_layer_free_task(&task);
+  }
+
+  iotc_mqtt_codec_layer_fail_message(context, msg);
+
+  return state;
+}
+
 iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
                                         iotc_state_t in_out_state) {
   IOTC_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -87,13 +346,38 @@ iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
   /* There can be only one task that is being sent.
    * If msg != 0 means that we have a notification from next layer. */
   if (IOTC_STATE_OK == in_out_state && NULL != msg) {
+    if (0 < iotc_atomic_load_size(
+                &iotc_globals.publish_coalescing_max_bytes) &&
+        IOTC_MQTT_TYPE_PUBLISH == msg->common.common_u.common_bits.type &&
+        IOTC_MQTT_QOS_AT_MOST_ONCE == msg->common.common_u.common_bits.qos) {
+      return iotc_mqtt_codec_layer_batch_message(context, msg);
+    }
+
+    /* the pending batch goes first to keep the order of messages */
+    in_out_state = iotc_mqtt_codec_layer_flush_batch(context);
+
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_mqtt_codec_layer_fail_message(context, msg);
+      return in_out_state;
+    }
+
+    /* the flush may have closed the layer */
+    layer_data =
+        (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
+
+    if (NULL == layer_data) {
+      iotc_mqtt_message_free(&msg);
+      return IOTC_STATE_OK;
+    }
+
     iotc_mqtt_codec_layer_task_t* new_task =
         iotc_mqtt_codec_layer_make_task(msg);
 
     IOTC_CHECK_MEMORY(new_task, in_out_state);
 
-    IOTC_LIST_PUSH_BACK(iotc_mqtt_codec_layer_task_t, layer_data->task_queue,
-                        new_task);
+    IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_mqtt_codec_layer_task_t,
+                                  layer_data->task_queue,
+                                  layer_data->task_queue_tail, new_task);
 
     if (IOTC_CR_IS_RUNNING(layer_data->push_cs)) {
       return IOTC_STATE_OK;
@@ -103,7 +387,9 @@ iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
     assert(layer_data->push_cs <= 2);
 
     /* Make the task to continue it's processing with re-attached msg. */
-    iotc_mqtt_codec_layer_continue_task(task, msg);
+    if (NULL != msg) {
+      iotc_mqtt_codec_layer_continue_task(task, msg);
+    }
   }
 
   if (NULL != msg) {
@@ -113,6 +399,17 @@ iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
   /*------------------------------ BEGIN COROUTINE ----------------------- */
   IOTC_CR_START(layer_data->push_cs);
 
+  /* A batch task carries the messages serialised when they arrived. */
+  if (NULL != layer_data->task_queue->batch) {
+    data_desc = layer_data->task_queue->batch;
+    layer_data->task_queue->batch = NULL;
+    layer_data->msg_id = 0;
+    layer_data->msg_type = IOTC_MQTT_TYPE_PUBLISH;
+    in_out_state = IOTC_STATE_OK;
+
+    goto send;
+  }
+
   iotc_mqtt_serialiser_init(&serializer);
 
   IOTC_CHECK_MEMORY(msg, in_out_state);
@@ -134,9 +431,9 @@ iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
 
   IOTC_CHECK_MEMORY(data_desc, in_out_state);
 
-  /* If it's publish then the payload is sent separately
-   * for more details check serialiser implementation and this function
-   * at line 169. */
+  /* If it's publish then the payload is not copied into the header buffer
+   * for more details check serialiser implementation and the chaining of the
+   * payload below. */
   rc = iotc_mqtt_serialiser_write(&serializer, msg, data_desc,
                                   msg_contents_size, remaining_len);
 
@@ -150,6 +447,22 @@ iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
     goto err_handling;
   }
 
+  /* If publish and not empty payload then chain the payload behind the
+   * header, so that both are written with a single push. */
+  if (IOTC_MQTT_TYPE_PUBLISH == msg->common.common_u.common_bits.type &&
+      msg->publish.content->length > 0) {
+    /* make a new desc but keep sharing memory */
+    payload_desc = iotc_make_desc_from_buffer_share(
+        msg->publish.content->data_ptr, msg->publish.content->length);
+
+    IOTC_CHECK_MEMORY(payload_desc, in_out_state);
+
+    data_desc->__next = payload_desc;
+  }
+
+  iotc_atomic_add_u32(&iotc_globals.io_stats.messages_sent, 1);
+
+send:
   iotc_debug_format("[m.id[%d] m.type[%d]] mqtt_codec_layer sending message",
                     layer_data->msg_id, layer_data->msg_type);
 
@@ -169,28 +482,9 @@ iotc_state_t iotc_mqtt_codec_layer_push(void* context, void* data,
   msg = task->msg;
 
   /* PRE-CONTINUE-CONDITIONS */
-  assert(NULL != msg);
-
-  /* If header failed, then there's no need to. */
-  if (IOTC_STATE_WRITTEN != in_out_state) {
-    goto finalise;
-  }
+  assert(NULL != msg || NULL != task->batched);
 
-  /* If publish and not empty payload then send the payload. */
-  if (IOTC_MQTT_TYPE_PUBLISH == msg->common.common_u.common_bits.type &&
-      msg->publish.content->length > 0) {
-    /* make a new desc but keep sharing memory */
-    payload_desc = iotc_make_desc_from_buffer_share(
-        msg->publish.content->data_ptr, msg->publish.content->length);
-
-    IOTC_CHECK_MEMORY(payload_desc, in_out_state);
-
-    IOTC_CR_YIELD(
-        layer_data->push_cs,
-        IOTC_PROCESS_PUSH_ON_PREV_LAYER(context, payload_desc, IOTC_STATE_OK));
-  }
-
-finalise: /* Common part for all messages. */
+  /* Common part for all messages. */
   if (IOTC_STATE_WRITTEN == in_out_state) {
     iotc_debug_format("[m.id[%d] m.type[%d]] mqtt_codec_layer message sent",
                       layer_data->msg_id, layer_data->msg_type);
@@ -201,7 +495,7 @@ finalise: /* Common part for all messages. */
 
   /* PRE-CONDITIONS */
   assert(NULL != task);
-  assert(NULL != task->msg);
+  assert(NULL != task->msg || NULL != task->batched);
 
   /* Releases the msg memory as it's no longer needed. */
   iotc_mqtt_message_free(&task->msg);
@@ -211,14 +505,23 @@ finalise: /* Common part for all messages. */
   assert(in_out_state == IOTC_STATE_WRITTEN ||
          in_out_state == IOTC_STATE_FAILED_WRITING);
 
-  iotc_mqtt_written_data_t* written_data = iotc_alloc_make_tuple(
-      iotc_mqtt_written_data_t, layer_data->msg_id, layer_data->msg_type);
+  /* The messages of a batch have been confirmed when they were batched,
+   * their users learn the outcome of the write now. */
+  if (NULL == task->batched) {
+    iotc_mqtt_written_data_t* written_data =
+        iotc_alloc_make_tuple(iotc_mqtt_written_data_t, layer_data->msg_id,
+                              layer_data->msg_type, NULL);
 
-  IOTC_CHECK_MEMORY(written_data, in_out_state);
+    IOTC_CHECK_MEMORY(written_data, in_out_state);
 
-  IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, written_data, in_out_state);
+    IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, written_data, in_out_state);
+  } else {
+    iotc_mqtt_codec_layer_complete_batched(context, task->batched,
+                                           in_out_state);
+  }
 
-  IOTC_LIST_POP(iotc_mqtt_codec_layer_task_t, layer_data->task_queue, task);
+  IOTC_LIST_POP_WITH_TAIL(iotc_mqtt_codec_layer_task_t, layer_data->task_queue,
+                          layer_data->task_queue_tail, task);
 
   /* Release the task as it's no longer required. */
   iotc_mqtt_codec_layer_free_task(&task);
@@ -244,7 +547,7 @@ err_handling:
                     iotc_get_state_string(in_out_state));
 
   IOTC_SAFE_FREE(buffer);
-  IOTC_SAFE_FREE(data_desc);
+  iotc_free_desc_chain(&data_desc);
   clear_task_queue(context);
   IOTC_CR_RESET(layer_data->push_cs);
 
@@ -277,7 +580,8 @@ iotc_state_t iotc_mqtt_codec_layer_pull(void* context, void* data,
 
   assert(layer_data->msg == 0);
 
-  IOTC_ALLOC_AT(iotc_mqtt_message_t, layer_data->msg, in_out_state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                       layer_data->msg, in_out_state);
 
   iotc_mqtt_parser_init(&layer_data->parser);
 
@@ -391,6 +695,7 @@ iotc_state_t iotc_mqtt_codec_layer_close_externally(void* context, void* data,
       (iotc_mqtt_codec_layer_data_t*)IOTC_THIS_LAYER(context)->user_data;
 
   if (layer_data) {
+    iotc_mqtt_codec_layer_discard_batch(context);
     clear_task_queue(context);
     IOTC_CR_RESET(layer_data->push_cs);
 
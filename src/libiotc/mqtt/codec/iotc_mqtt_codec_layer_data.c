@@ -15,6 +15,7 @@
  */
 
 #include "iotc_mqtt_codec_layer_data.h"
+#include "iotc_list.h"
 #include "iotc_mqtt_message.h"
 
 iotc_mqtt_codec_layer_task_t* iotc_mqtt_codec_layer_make_task(
@@ -35,9 +36,33 @@ err_handling:
   return NULL;
 }
 
+iotc_mqtt_codec_layer_task_t* iotc_mqtt_codec_layer_make_batch_task(
+    iotc_data_desc_t* batch, iotc_mqtt_codec_layer_task_t* batched) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  assert(NULL != batch);
+  assert(NULL != batched);
+
+  IOTC_ALLOC(iotc_mqtt_codec_layer_task_t, new_task, state);
+
+  new_task->batch = batch;
+  new_task->batched = batched;
+  new_task->msg_type = IOTC_MQTT_TYPE_PUBLISH;
+
+  return new_task;
+
+err_handling:
+  return NULL;
+}
+
 iotc_mqtt_message_t* iotc_mqtt_codec_layer_activate_task(
     iotc_mqtt_codec_layer_task_t* task) {
   assert(NULL != task);
+
+  if (NULL != task->batched) {
+    return NULL;
+  }
+
   assert(NULL != task->msg);
 
   iotc_mqtt_message_t* msg = task->msg;
@@ -60,6 +85,13 @@ void iotc_mqtt_codec_layer_free_task(iotc_mqtt_codec_layer_task_t** task) {
     return;
   }
 
+  while (NULL != (*task)->batched) {
+    iotc_mqtt_codec_layer_task_t* batched = NULL;
+    IOTC_LIST_POP(iotc_mqtt_codec_layer_task_t, (*task)->batched, batched);
+    iotc_mqtt_codec_layer_free_task(&batched);
+  }
+
+  iotc_free_desc_chain(&(*task)->batch);
   iotc_mqtt_message_free(&(*task)->msg);
   IOTC_SAFE_FREE((*task));
 }
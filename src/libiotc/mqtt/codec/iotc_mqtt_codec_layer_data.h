@@ -17,6 +17,8 @@
 #ifndef __IOTC_MQTT_CODEC_LAYER_DATA_H__
 #define __IOTC_MQTT_CODEC_LAYER_DATA_H__
 
+#include "iotc_data_desc.h"
+#include "iotc_event_dispatcher_api.h"
 #include "iotc_mqtt_parser.h"
 #include "iotc_vector.h"
 
@@ -27,6 +29,12 @@ extern "C" {
 typedef struct iotc_mqtt_codec_layer_task_s {
   struct iotc_mqtt_codec_layer_task_s* __next;
   iotc_mqtt_message_t* msg;
+  /* a batch task carries the serialised messages instead of a msg, the
+   * batched tasks keep the callbacks of those messages */
+  iotc_data_desc_t* batch;
+  struct iotc_mqtt_codec_layer_task_s* batched;
+  /* the user's callback of a batched message */
+  iotc_event_handle_t callback;
   uint16_t msg_id;
   iotc_mqtt_type_t msg_type;
 } iotc_mqtt_codec_layer_task_t;
@@ -34,6 +42,11 @@ typedef struct iotc_mqtt_codec_layer_task_s {
 typedef struct iotc_mqtt_codec_layer_data_s {
   iotc_mqtt_message_t* msg;
   iotc_mqtt_codec_layer_task_t* task_queue;
+  iotc_mqtt_codec_layer_task_t* task_queue_tail;
+  /* the QoS 0 PUBLISH frames waiting to be written, back to back */
+  iotc_data_desc_t* batch;
+  iotc_mqtt_codec_layer_task_t* batched;
+  iotc_time_event_handle_t batch_timeout;
   iotc_mqtt_parser_t parser;
   iotc_state_t local_state;
   uint16_t msg_id;
@@ -53,15 +66,29 @@ typedef struct iotc_mqtt_codec_layer_data_s {
 extern iotc_mqtt_codec_layer_task_t* iotc_mqtt_codec_layer_make_task(
     iotc_mqtt_message_t* msg);
 
+/**
+ * @brief iotc_mqtt_codec_layer_make_batch_task
+ *
+ * Helper ctor like function to create a task that writes already serialised
+ * frames.
+ *
+ * @param batch the buffer of frames
+ * @param batched the tasks of the messages in the batch
+ * @return
+ */
+extern iotc_mqtt_codec_layer_task_t* iotc_mqtt_codec_layer_make_batch_task(
+    iotc_data_desc_t* batch, iotc_mqtt_codec_layer_task_t* batched);
+
 /**
  * @brief iotc_mqtt_codec_layer_activate_task
  *
  * After the task activation certain steps must be performed
  * like detaching the msg from the task so that the msg memory
  * won't be double deleted in case of an error or system shutdown.
+ * A batch task has no msg to detach.
  *
  * @param task
- * @return msg
+ * @return msg, NULL for a batch task
  */
 iotc_mqtt_message_t* iotc_mqtt_codec_layer_activate_task(
     iotc_mqtt_codec_layer_task_t* task);
@@ -0,0 +1,227 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "iotc_allocator.h"
+#include "iotc_macros.h"
+#include "iotc_mqtt_logic_in_flight.h"
+#include "iotc_mqtt_logic_layer_data.h"
+
+/*
+ * STATIC INTERNAL FUNCTIONS
+ */
+
+/* how far the task sits from the slot its msg_id hashes to */
+static uint32_t iotc_mqtt_logic_in_flight_distance(
+    const iotc_mqtt_logic_task_t* task, uint32_t slot, uint32_t mask) {
+  return (slot - task->msg_id) & mask;
+}
+
+/* returns the slot holding the msg_id or UINT32_MAX, the lookup stops as soon
+ * as it has gone further than the task it checks since a task with the msg_id
+ * would have taken that task's slot */
+static uint32_t iotc_mqtt_logic_in_flight_lookup(
+    iotc_mqtt_logic_task_t* const* slots, uint32_t capacity, uint16_t msg_id) {
+  const uint32_t mask = capacity - 1;
+  uint32_t slot = msg_id & mask;
+  uint32_t distance = 0;
+
+  for (; NULL != slots[slot]; slot = (slot + 1) & mask, ++distance) {
+    if (msg_id == slots[slot]->msg_id) {
+      return slot;
+    }
+
+    if (distance >
+        iotc_mqtt_logic_in_flight_distance(slots[slot], slot, mask)) {
+      break;
+    }
+  }
+
+  return UINT32_MAX;
+}
+
+/* robin hood insertion: a task takes over the slot of any task that sits
+ * closer to its own home slot, which then moves on, this keeps the probe runs
+ * short and sorted by home slot */
+static void iotc_mqtt_logic_in_flight_insert(iotc_mqtt_logic_task_t** slots,
+                                             uint32_t capacity,
+                                             iotc_mqtt_logic_task_t* task) {
+  const uint32_t mask = capacity - 1;
+  uint32_t slot = task->msg_id & mask;
+  uint32_t distance = 0;
+
+  while (NULL != slots[slot]) {
+    const uint32_t slot_distance =
+        iotc_mqtt_logic_in_flight_distance(slots[slot], slot, mask);
+
+    if (slot_distance < distance) {
+      iotc_mqtt_logic_task_t* displaced = slots[slot];
+      slots[slot] = task;
+      task = displaced;
+      distance = slot_distance;
+    }
+
+    slot = (slot + 1) & mask;
+    ++distance;
+  }
+
+  slots[slot] = task;
+}
+
+static iotc_state_t iotc_mqtt_logic_in_flight_grow(
+    iotc_mqtt_logic_in_flight_t* in_flight) {
+  iotc_state_t state = IOTC_STATE_OK;
+
+  const uint32_t capacity = (0 == in_flight->capacity)
+                                ? IOTC_MQTT_IN_FLIGHT_INITIAL_CAPACITY
+                                : 2 * in_flight->capacity;
+
+  IOTC_ALLOC_BUFFER(iotc_mqtt_logic_task_t*, slots,
+                    capacity * sizeof(iotc_mqtt_logic_task_t*), state);
+
+  uint32_t i = 0;
+  for (; i < in_flight->capacity; ++i) {
+    iotc_mqtt_logic_task_t* task = in_flight->slots[i];
+
+    if (NULL != task) {
+      iotc_mqtt_logic_in_flight_insert(slots, capacity, task);
+    }
+  }
+
+  IOTC_SAFE_FREE(in_flight->slots);
+
+  in_flight->slots = slots;
+  in_flight->capacity = capacity;
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  return state;
+}
+
+/*
+ * PUBLIC FUNCTIONS
+ */
+
+iotc_state_t iotc_mqtt_logic_in_flight_add(
+    iotc_mqtt_logic_in_flight_t* in_flight, iotc_mqtt_logic_task_t* task) {
+  assert(NULL != in_flight);
+  assert(NULL != task);
+  assert(NULL == iotc_mqtt_logic_in_flight_find(in_flight, task->msg_id) &&
+         "task with the same id already exist");
+
+  iotc_state_t state = IOTC_STATE_OK;
+
+  if (2 * (in_flight->size + 1) > in_flight->capacity) {
+    IOTC_CHECK_STATE(state = iotc_mqtt_logic_in_flight_grow(in_flight));
+  }
+
+  iotc_mqtt_logic_in_flight_insert(in_flight->slots, in_flight->capacity, task);
+  ++in_flight->size;
+  in_flight->bytes += task->payload_size;
+
+  task->__next = NULL;
+  task->__prev = in_flight->tail;
+
+  if (NULL != in_flight->tail) {
+    in_flight->tail->__next = task;
+  } else {
+    in_flight->head = task;
+  }
+
+  in_flight->tail = task;
+
+err_handling:
+  return state;
+}
+
+iotc_mqtt_logic_task_t* iotc_mqtt_logic_in_flight_find(
+    const iotc_mqtt_logic_in_flight_t* in_flight, uint16_t msg_id) {
+  assert(NULL != in_flight);
+
+  if (0 == in_flight->capacity) {
+    return NULL;
+  }
+
+  const uint32_t slot = iotc_mqtt_logic_in_flight_lookup(
+      in_flight->slots, in_flight->capacity, msg_id);
+
+  return (UINT32_MAX == slot) ? NULL : in_flight->slots[slot];
+}
+
+void iotc_mqtt_logic_in_flight_remove(iotc_mqtt_logic_in_flight_t* in_flight,
+                                      iotc_mqtt_logic_task_t* task) {
+  assert(NULL != in_flight);
+  assert(NULL != task);
+
+  if (0 == in_flight->capacity) {
+    return;
+  }
+
+  iotc_mqtt_logic_task_t** const slots = in_flight->slots;
+  const uint32_t mask = in_flight->capacity - 1;
+
+  uint32_t hole = iotc_mqtt_logic_in_flight_lookup(slots, in_flight->capacity,
+                                                   task->msg_id);
+
+  if (UINT32_MAX == hole || task != slots[hole]) {
+    return;
+  }
+
+  /* backward shift deletion: the rest of the probe run moves one slot back
+   * until a task that already sits in its home slot */
+  uint32_t next = (hole + 1) & mask;
+
+  while (NULL != slots[next] &&
+         0 != iotc_mqtt_logic_in_flight_distance(slots[next], next, mask)) {
+    slots[hole] = slots[next];
+    hole = next;
+    next = (next + 1) & mask;
+  }
+
+  slots[hole] = NULL;
+  --in_flight->size;
+  in_flight->bytes -= task->payload_size;
+
+  if (NULL != task->__prev) {
+    task->__prev->__next = task->__next;
+  } else {
+    in_flight->head = task->__next;
+  }
+
+  if (NULL != task->__next) {
+    task->__next->__prev = task->__prev;
+  } else {
+    in_flight->tail = task->__prev;
+  }
+
+  task->__next = NULL;
+  task->__prev = NULL;
+}
+
+iotc_mqtt_logic_task_t* iotc_mqtt_logic_in_flight_detach_all(
+    iotc_mqtt_logic_in_flight_t* in_flight) {
+  assert(NULL != in_flight);
+
+  iotc_mqtt_logic_task_t* tasks = in_flight->head;
+
+  IOTC_SAFE_FREE(in_flight->slots);
+  memset(in_flight, 0, sizeof(iotc_mqtt_logic_in_flight_t));
+
+  return tasks;
+}
@@ -0,0 +1,101 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file iotc_mqtt_logic_in_flight.h
+ * @brief Set of the QoS 1 tasks waiting for their acknowledgement
+ *
+ * Tasks are chained in the order they were added, so they can be resent in
+ * the order they were published, and indexed by their msg_id in an
+ * open-addressed table. Adding, finding and removing a task is O(1).
+ *
+ * The table uses robin hood linear probing on the low bits of the msg_id.
+ * Message ids are handed out sequentially so a window of consecutive ids maps
+ * to consecutive slots, each task sits in its home slot and neither lookups
+ * nor removals have to walk the run of occupied slots around it.
+ */
+
+#ifndef __IOTC_MQTT_LOGIC_IN_FLIGHT_H__
+#define __IOTC_MQTT_LOGIC_IN_FLIGHT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iotc_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef IOTC_MQTT_IN_FLIGHT_INITIAL_CAPACITY
+#define IOTC_MQTT_IN_FLIGHT_INITIAL_CAPACITY 8
+#endif
+
+struct iotc_mqtt_logic_task_s;
+
+typedef struct iotc_mqtt_logic_in_flight_s {
+  /* tasks in the order they were added */
+  struct iotc_mqtt_logic_task_s* head;
+  struct iotc_mqtt_logic_task_s* tail;
+  /* power of two sized, kept at most half full */
+  struct iotc_mqtt_logic_task_s** slots;
+  uint32_t capacity;
+  uint32_t size;
+  /* sum of the payload_size of the tasks */
+  size_t bytes;
+} iotc_mqtt_logic_in_flight_t;
+
+/**
+ * @brief iotc_mqtt_logic_in_flight_add
+ *
+ * Appends the task and indexes it by its msg_id. No other task of the set may
+ * have the same msg_id.
+ *
+ * @return IOTC_OUT_OF_MEMORY if the table could not grow, the task is not
+ *         added then
+ */
+extern iotc_state_t iotc_mqtt_logic_in_flight_add(
+    iotc_mqtt_logic_in_flight_t* in_flight,
+    struct iotc_mqtt_logic_task_s* task);
+
+extern struct iotc_mqtt_logic_task_s* iotc_mqtt_logic_in_flight_find(
+    const iotc_mqtt_logic_in_flight_t* in_flight, uint16_t msg_id);
+
+/**
+ * @brief iotc_mqtt_logic_in_flight_remove
+ *
+ * Unlinks the task if it belongs to the set, does nothing otherwise.
+ */
+extern void iotc_mqtt_logic_in_flight_remove(
+    iotc_mqtt_logic_in_flight_t* in_flight,
+    struct iotc_mqtt_logic_task_s* task);
+
+/**
+ * @brief iotc_mqtt_logic_in_flight_detach_all
+ *
+ * Empties the set and releases its table.
+ *
+ * @return the tasks of the set as a list linked through __next, in the order
+ *         they were added
+ */
+extern struct iotc_mqtt_logic_task_s* iotc_mqtt_logic_in_flight_detach_all(
+    iotc_mqtt_logic_in_flight_t* in_flight);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IOTC_MQTT_LOGIC_IN_FLIGHT_H__ */
@@ -50,7 +50,6 @@ static void iotc_mqtt_logic_task_queue_shutdown_wrap(void** task_queue) {
 uint8_t iotc_mqtt_logic_layer_task_should_be_stored_predicate(
     void* context, iotc_mqtt_logic_task_t* task, int i) {
   IOTC_UNUSED(i);
-  IOTC_UNUSED(context);
 
   assert(NULL != task);
 
@@ -58,7 +57,50 @@ uint8_t iotc_mqtt_logic_layer_task_should_be_stored_predicate(
     return 1;
   }
 
-  return 0;
+  /* a JWT rotation also keeps the ones that haven't been sent yet */
+  return IOTC_CONTEXT_DATA(context)->jwt_rotation.in_progress ? 1 : 0;
+}
+
+static uint8_t iotc_mqtt_logic_layer_task_is_publish_predicate(
+    void* context, iotc_mqtt_logic_task_t* task, int i) {
+  IOTC_UNUSED(context);
+  IOTC_UNUSED(i);
+
+  assert(NULL != task);
+
+  return IOTC_MQTT_PUBLISH == task->data.mqtt_settings.scenario ? 1 : 0;
+}
+
+/* a JWT rotation swaps the connection under the session, which survives it
+ * like a continued one */
+static uint8_t iotc_mqtt_logic_layer_keeps_session(
+    const iotc_context_data_t* context_data) {
+  return IOTC_SESSION_CONTINUE == context_data->connection_data->session_type ||
+         0 != context_data->jwt_rotation.in_progress;
+}
+
+/* a clean session forgets the subscriptions with the connection, a JWT
+ * rotation makes them again without reporting their SUBACK */
+static void iotc_mqtt_logic_layer_resubscribe(void* data, void* context) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_mqtt_task_specific_data_t* subscribe_data =
+      (iotc_mqtt_task_specific_data_t*)data;
+  iotc_mqtt_logic_task_t* task = NULL;
+
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                       state);
+
+  task->data.mqtt_settings.scenario = IOTC_MQTT_SUBSCRIBE;
+  task->data.mqtt_settings.qos = IOTC_MQTT_QOS_AT_LEAST_ONCE;
+  task->data.data_u = subscribe_data;
+  subscribe_data->subscribe.resubscribe = 1;
+
+  iotc_mqtt_logic_layer_push(context, task, IOTC_STATE_OK);
+
+  return;
+
+err_handling:
+  iotc_mqtt_task_spec_data_free_subscribe_data(&subscribe_data);
 }
 
 static void iotc_mqtt_logic_layer_task_make_context_null(
@@ -77,6 +119,25 @@ iotc_state_t iotc_mqtt_logic_layer_push(void* context, void* data,
   iotc_mqtt_logic_task_t* task = data;
 
   if (IOTC_THIS_LAYER_NOT_OPERATIONAL(context) || layer_data == 0) {
+    iotc_context_data_t* context_data = IOTC_CONTEXT_DATA(context);
+
+    /* what the application sends while a JWT rotation swaps the connection
+     * goes out on the next one */
+    if (in_out_state != IOTC_STATE_WRITTEN &&
+        in_out_state != IOTC_STATE_FAILED_WRITING &&
+        context_data->jwt_rotation.in_progress &&
+        (IOTC_MQTT_PUBLISH == task->data.mqtt_settings.scenario ||
+         IOTC_MQTT_SUBSCRIBE == task->data.mqtt_settings.scenario)) {
+      iotc_mqtt_logic_task_t* unsent_list =
+          (iotc_mqtt_logic_task_t*)context_data->copy_of_unsent_tasks_queue;
+
+      task->__next = NULL;
+      IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t, unsent_list, task);
+      context_data->copy_of_unsent_tasks_queue = unsent_list;
+
+      return IOTC_STATE_OK;
+    }
+
     iotc_debug_logger("no layer_data");
     goto err_handling;
   }
@@ -99,6 +160,7 @@ iotc_state_t iotc_mqtt_logic_layer_push(void* context, void* data,
 
     uint16_t msg_id = written_data->a1;
     iotc_mqtt_type_t msg_type = written_data->a2;
+    iotc_event_handle_t* batched_callback = written_data->a3;
 
     IOTC_SAFE_FREE_TUPLE(written_data);
 
@@ -111,14 +173,14 @@ iotc_state_t iotc_mqtt_logic_layer_push(void* context, void* data,
       iotc_mqtt_message_class_t msg_class =
           iotc_mqtt_class_msg_type_sending(msg_type);
 
-      iotc_mqtt_logic_task_t* task_queue = NULL;
+      const iotc_mqtt_logic_in_flight_t* task_queue = NULL;
 
       switch (msg_class) {
         case IOTC_MQTT_MESSAGE_CLASS_FROM_SERVER:
-          task_queue = layer_data->q12_recv_tasks_queue;
+          task_queue = &layer_data->q12_recv_tasks_queue;
           break;
         case IOTC_MQTT_MESSAGE_CLASS_TO_SERVER:
-          task_queue = layer_data->q12_tasks_queue;
+          task_queue = &layer_data->q12_tasks_queue;
           break;
         case IOTC_MQTT_MESSAGE_CLASS_UNKNOWN:
           in_out_state = IOTC_MQTT_MESSAGE_CLASS_UNKNOWN_ERROR;
@@ -129,8 +191,7 @@ iotc_state_t iotc_mqtt_logic_layer_push(void* context, void* data,
       }
 
       /* It is one of the qos12 tasks, find the proper task */
-      IOTC_LIST_FIND(iotc_mqtt_logic_task_t, task_queue, CMP_TASK_MSG_ID,
-                     msg_id, task_to_be_called);
+      task_to_be_called = iotc_mqtt_logic_in_flight_find(task_queue, msg_id);
     }
 
     /* restart the layer keepalive task timer after every every successful
@@ -140,12 +201,20 @@ iotc_state_t iotc_mqtt_logic_layer_push(void* context, void* data,
       iotc_state_t local_state = iotc_evtd_restart(
           IOTC_CONTEXT_DATA(context)->evtd_instance,
           &layer_data->keepalive_event,
-          IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout);
+          IOTC_SEC_TO_MSEC(
+              IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout));
 
       IOTC_CHECK_STATE(local_state);
     }
 
     if (task_to_be_called != 0) {
+      /* a batched message is not on the wire yet, the codec calls the
+       * user back once its batch is written or dropped */
+      if (NULL != batched_callback) {
+        *batched_callback = task_to_be_called->callback;
+        task_to_be_called->callback = iotc_make_empty_handle();
+      }
+
       task_to_be_called->logic.handlers.h4.a3 = in_out_state;
       return iotc_evtd_execute_handle(&task_to_be_called->logic);
     }
@@ -252,7 +321,8 @@ iotc_state_t iotc_mqtt_logic_layer_pull(void* context, void* data,
   }
 
   /* If there's a problem then update the backoff penalty. */
-  if (iotc_update_backoff_penalty(in_out_state) ==
+  if (iotc_update_backoff_penalty(&IOTC_CONTEXT_DATA(context)->backoff_status,
+                                  in_out_state) ==
       IOTC_BACKOFF_CLASS_TERMINAL) {
     IOTC_PROCESS_CLOSE_ON_THIS_LAYER(context, NULL, IOTC_BACKOFF_TERMINAL);
     goto err_handling;
@@ -279,7 +349,7 @@ iotc_state_t iotc_mqtt_logic_layer_pull(void* context, void* data,
      * otherway we are going to use the current qos_0 task */
     if (msg_id > 0) {
       iotc_mqtt_logic_task_t* task = 0;
-      iotc_mqtt_logic_task_t* task_queue = 0;
+      const iotc_mqtt_logic_in_flight_t* task_queue = NULL;
 
       /** store the msg class */
       iotc_mqtt_message_class_t msg_class = iotc_mqtt_class_msg_type_receiving(
@@ -288,10 +358,10 @@ iotc_state_t iotc_mqtt_logic_layer_pull(void* context, void* data,
       /** pick proper msg queue */
       switch (msg_class) {
         case IOTC_MQTT_MESSAGE_CLASS_FROM_SERVER:
-          task_queue = layer_data->q12_recv_tasks_queue;
+          task_queue = &layer_data->q12_recv_tasks_queue;
           break;
         case IOTC_MQTT_MESSAGE_CLASS_TO_SERVER:
-          task_queue = layer_data->q12_tasks_queue;
+          task_queue = &layer_data->q12_tasks_queue;
           break;
         case IOTC_MQTT_MESSAGE_CLASS_UNKNOWN:
         default:
@@ -299,8 +369,7 @@ iotc_state_t iotc_mqtt_logic_layer_pull(void* context, void* data,
           goto err_handling;
       }
 
-      IOTC_LIST_FIND(iotc_mqtt_logic_task_t, task_queue, CMP_TASK_MSG_ID,
-                     msg_id, task);
+      task = iotc_mqtt_logic_in_flight_find(task_queue, msg_id);
 
       if (task != 0) /* got the task let's call the proper handler */
       {
@@ -360,30 +429,58 @@ iotc_state_t iotc_mqtt_logic_layer_init(void* context, void* data,
 
   assert(layer_data != NULL);
 
-  if (IOTC_SESSION_CONTINUE ==
-      IOTC_CONTEXT_DATA(context)->connection_data->session_type) {
-    /* let's swap them with values so we are going to re-use the
-     * handlers for topics from last session */
-    layer_data->handlers_for_topics = context_data->copy_of_handlers_for_topics;
-    context_data->copy_of_handlers_for_topics = NULL;
-
-    /* same story goes with the qos1&2 unacked messages what we have to do is to
-     * re-plug them into the queue and connect task will restart the tasks */
-    layer_data->q12_tasks_queue =
-        context_data->copy_of_q12_unacked_messages_queue;
+  if (iotc_mqtt_logic_layer_keeps_session(context_data)) {
+    /* the qos1&2 unacked messages have to be re-plugged into the queue and
+     * connect task will restart the tasks */
+    iotc_mqtt_logic_task_t* unacked_list =
+        (iotc_mqtt_logic_task_t*)
+            context_data->copy_of_q12_unacked_messages_queue;
+
+    while (NULL != unacked_list) {
+      iotc_mqtt_logic_task_t* task = NULL;
+
+      IOTC_LIST_POP(iotc_mqtt_logic_task_t, unacked_list, task);
+
+      in_out_state =
+          iotc_mqtt_logic_in_flight_add(&layer_data->q12_tasks_queue, task);
+
+      if (IOTC_STATE_OK != in_out_state) {
+        /* leave the whole copy in place for the next attempt */
+        IOTC_LIST_PUSH_FRONT(iotc_mqtt_logic_task_t, unacked_list, task);
+
+        iotc_mqtt_logic_task_t* restored_list =
+            iotc_mqtt_logic_in_flight_detach_all(&layer_data->q12_tasks_queue);
+        IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t, restored_list,
+                            unacked_list);
+
+        context_data->copy_of_q12_unacked_messages_queue = restored_list;
+        goto err_handling;
+      }
+    }
+
     context_data->copy_of_q12_unacked_messages_queue = NULL;
 
+    /* same story goes with the handlers for topics, let's swap them with
+     * values so we are going to re-use the handlers from last session, a
+     * clean one makes the subscriptions again below */
+    if (IOTC_SESSION_CONTINUE ==
+        IOTC_CONTEXT_DATA(context)->connection_data->session_type) {
+      layer_data->handlers_for_topics =
+          context_data->copy_of_handlers_for_topics;
+      context_data->copy_of_handlers_for_topics = NULL;
+    }
+
     /* restoring the last_msg_id */
     layer_data->last_msg_id = context_data->copy_of_last_msg_id;
     context_data->copy_of_last_msg_id = 0;
   } else {
     if (NULL != context_data->copy_of_handlers_for_topics) {
-      iotc_vector_for_each(context_data->copy_of_handlers_for_topics,
-                           &iotc_mqtt_task_spec_data_free_subscribe_data_vec,
-                           NULL, 0);
+      iotc_topic_trie_for_each(
+          context_data->copy_of_handlers_for_topics,
+          &iotc_mqtt_task_spec_data_free_subscribe_data_trie, NULL);
 
       context_data->copy_of_handlers_for_topics =
-          iotc_vector_destroy(context_data->copy_of_handlers_for_topics);
+          iotc_topic_trie_destroy(context_data->copy_of_handlers_for_topics);
     }
 
     /* clean the unsent QoS12 unacked tasks */
@@ -398,13 +495,34 @@ iotc_state_t iotc_mqtt_logic_layer_init(void* context, void* data,
   /* if there was no copy or this is the fresh (re)start */
   if (NULL == layer_data->handlers_for_topics) {
     /* let's create fresh one */
-    layer_data->handlers_for_topics = iotc_vector_create();
+    layer_data->handlers_for_topics = iotc_topic_trie_create();
     IOTC_CHECK_MEMORY(layer_data->handlers_for_topics, in_out_state);
   }
 
   IOTC_CONTEXT_DATA(context)->connection_data->connection_state =
       IOTC_CONNECTION_STATE_OPENING;
 
+  /* the tasks below are queued and start once the connection is open */
+  if (NULL != context_data->copy_of_handlers_for_topics) {
+    iotc_topic_trie_for_each(context_data->copy_of_handlers_for_topics,
+                             &iotc_mqtt_logic_layer_resubscribe, context);
+
+    context_data->copy_of_handlers_for_topics =
+        iotc_topic_trie_destroy(context_data->copy_of_handlers_for_topics);
+  }
+
+  iotc_mqtt_logic_task_t* unsent_list =
+      (iotc_mqtt_logic_task_t*)context_data->copy_of_unsent_tasks_queue;
+  context_data->copy_of_unsent_tasks_queue = NULL;
+
+  while (NULL != unsent_list) {
+    iotc_mqtt_logic_task_t* task = NULL;
+
+    IOTC_LIST_POP(iotc_mqtt_logic_task_t, unsent_list, task);
+
+    iotc_mqtt_logic_layer_push(context, task, IOTC_STATE_OK);
+  }
+
   return IOTC_PROCESS_INIT_ON_PREV_LAYER(context, data, in_out_state);
 
 err_handling:
@@ -421,7 +539,8 @@ iotc_state_t iotc_mqtt_logic_layer_connect(void* context, void* data,
     return IOTC_PROCESS_CONNECT_ON_NEXT_LAYER(context, data, in_out_state);
   }
 
-  IOTC_ALLOC(iotc_mqtt_logic_task_t, task, in_out_state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                    in_out_state);
 
   task->data.mqtt_settings.scenario = IOTC_MQTT_CONNECT;
   task->data.mqtt_settings.qos = IOTC_MQTT_QOS_AT_MOST_ONCE;
@@ -448,7 +567,7 @@ iotc_state_t iotc_mqtt_logic_layer_post_connect(void* context, void* data,
   /* set new context and send timeout which will make the qos12 tasks to
    * continue they work just where they were stopped */
   IOTC_LIST_FOREACH_WITH_ARG(iotc_mqtt_logic_task_t,
-                             layer_data->q12_tasks_queue,
+                             layer_data->q12_tasks_queue.head,
                              set_new_context_and_call_resend, context);
 
   return iotc_layer_default_post_connect(context, data, in_out_state);
@@ -513,20 +632,26 @@ iotc_state_t iotc_mqtt_logic_layer_close_externally(void* context, void* data,
                                                        in_out_state);
   }
 
-  iotc_update_backoff_penalty(in_out_state);
+  iotc_update_backoff_penalty(&IOTC_CONTEXT_DATA(context)->backoff_status,
+                              in_out_state);
 
   /* disable timeouts of all tasks */
   IOTC_LIST_FOREACH_WITH_ARG(iotc_mqtt_logic_task_t,
-                             layer_data->q12_tasks_queue, cancel_task_timeout,
-                             context);
+                             layer_data->q12_tasks_queue.head,
+                             cancel_task_timeout, context);
 
   IOTC_LIST_FOREACH_WITH_ARG(iotc_mqtt_logic_task_t,
-                             layer_data->q12_recv_tasks_queue,
+                             layer_data->q12_recv_tasks_queue.head,
                              cancel_task_timeout, context);
 
+  /* from here on the queues are plain lists */
+  iotc_mqtt_logic_task_t* q12_queue =
+      iotc_mqtt_logic_in_flight_detach_all(&layer_data->q12_tasks_queue);
+  iotc_mqtt_logic_task_t* q12_recv_queue =
+      iotc_mqtt_logic_in_flight_detach_all(&layer_data->q12_recv_tasks_queue);
+
   /* if clean session not set check if we have anything to copy */
-  if (IOTC_SESSION_CONTINUE == context_data->connection_data->session_type) {
-    iotc_context_data_t* context_data = IOTC_THIS_LAYER(context)->context_data;
+  if (iotc_mqtt_logic_layer_keeps_session(context_data)) {
     /* this sets the copy of last_msg_id */
     context_data->copy_of_last_msg_id = layer_data->last_msg_id;
 
@@ -550,7 +675,7 @@ iotc_state_t iotc_mqtt_logic_layer_close_externally(void* context, void* data,
     /* we will construct new list out of them */
     iotc_mqtt_logic_task_t* unacked_list = NULL;
 
-    IOTC_LIST_SPLIT_I(iotc_mqtt_logic_task_t, layer_data->q12_tasks_queue,
+    IOTC_LIST_SPLIT_I(iotc_mqtt_logic_task_t, q12_queue,
                       iotc_mqtt_logic_layer_task_should_be_stored_predicate,
                       context, unacked_list);
 
@@ -563,10 +688,10 @@ iotc_state_t iotc_mqtt_logic_layer_close_externally(void* context, void* data,
   /* if the handlers for topics are left alone than it means
    * that it has to be freed */
   if (layer_data->handlers_for_topics != NULL) {
-    iotc_vector_for_each(layer_data->handlers_for_topics,
-                         &iotc_mqtt_task_spec_data_free_subscribe_data_vec,
-                         NULL, 0);
-    iotc_vector_destroy(layer_data->handlers_for_topics);
+    iotc_topic_trie_for_each(
+        layer_data->handlers_for_topics,
+        &iotc_mqtt_task_spec_data_free_subscribe_data_trie, NULL);
+    iotc_topic_trie_destroy(layer_data->handlers_for_topics);
   }
 
   /* let's stop the current task */
@@ -588,10 +713,24 @@ iotc_state_t iotc_mqtt_logic_layer_close_externally(void* context, void* data,
   /* sanity check */
   assert(layer_data != 0);
 
+  /* the publishes that haven't started go out before the ones sent during
+   * a JWT rotation */
+  if (context_data->jwt_rotation.in_progress) {
+    iotc_mqtt_logic_task_t* unsent_list = NULL;
+
+    IOTC_LIST_SPLIT_I(iotc_mqtt_logic_task_t, layer_data->q0_tasks_queue,
+                      iotc_mqtt_logic_layer_task_is_publish_predicate, context,
+                      unsent_list);
+
+    IOTC_LIST_PUSH_BACK(
+        iotc_mqtt_logic_task_t, unsent_list,
+        (iotc_mqtt_logic_task_t*)context_data->copy_of_unsent_tasks_queue);
+
+    context_data->copy_of_unsent_tasks_queue = unsent_list;
+  }
+
   /* save queues */
   iotc_mqtt_logic_task_t* current_q0 = layer_data->current_q0_task;
-  iotc_mqtt_logic_task_t* q12_queue = layer_data->q12_tasks_queue;
-  iotc_mqtt_logic_task_t* q12_recv_queue = layer_data->q12_recv_tasks_queue;
   iotc_mqtt_logic_task_t* q0_queue = layer_data->q0_tasks_queue;
 
   /* destroy user's data */
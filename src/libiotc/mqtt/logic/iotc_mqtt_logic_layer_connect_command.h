@@ -98,7 +98,8 @@ static inline iotc_state_t do_mqtt_connect(
 
   /* Fill in the fields which are required for serializing the MQTT connect
    * message. */
-  IOTC_ALLOC_AT(iotc_mqtt_message_t, msg_memory, state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                       msg_memory, state);
   IOTC_CHECK_STATE(
       state = fill_with_connect_data(
           msg_memory, IOTC_CONTEXT_DATA(context)->connection_data->username,
@@ -113,9 +114,10 @@ static inline iotc_state_t do_mqtt_connect(
 
   if (IOTC_CONTEXT_DATA(context)->connection_data->connection_timeout > 0) {
     state = iotc_io_timeouts_create(
-        iotc_globals.evtd_instance,
+        event_dispatcher,
         iotc_make_handle(&do_mqtt_connect_timeout, context, task),
-        IOTC_CONTEXT_DATA(context)->connection_data->connection_timeout,
+        IOTC_SEC_TO_MSEC(
+            IOTC_CONTEXT_DATA(context)->connection_data->connection_timeout),
         context->self->context_data->io_timeouts, &task->timeout);
 
     IOTC_CHECK_STATE(state);
@@ -143,7 +145,7 @@ static inline iotc_state_t do_mqtt_connect(
   if (msg_memory->common.common_u.common_bits.type == IOTC_MQTT_TYPE_CONNACK) {
     /* Cancel the io timeout. */
     if (NULL != task->timeout.ptr_to_position) {
-      iotc_io_timeouts_cancel(iotc_globals.evtd_instance, &task->timeout,
+      iotc_io_timeouts_cancel(event_dispatcher, &task->timeout,
                               IOTC_CONTEXT_DATA(context)->io_timeouts);
       assert(NULL == task->timeout.ptr_to_position);
     }
@@ -155,7 +157,8 @@ static inline iotc_state_t do_mqtt_connect(
         state = iotc_evtd_execute_in(
             event_dispatcher,
             iotc_make_handle(&do_mqtt_keepalive_once, context),
-            IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout,
+            IOTC_SEC_TO_MSEC(
+                IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout),
             &layer_data->keepalive_event);
 
         IOTC_CHECK_STATE(state);
@@ -183,7 +186,7 @@ static inline iotc_state_t do_mqtt_connect(
 
       /* Cancel io timeout. */
       if (NULL != task->timeout.ptr_to_position) {
-        iotc_io_timeouts_cancel(iotc_globals.evtd_instance, &task->timeout,
+        iotc_io_timeouts_cancel(event_dispatcher, &task->timeout,
                                 IOTC_CONTEXT_DATA(context)->io_timeouts);
         assert(NULL == task->timeout.ptr_to_position);
       }
@@ -197,7 +200,7 @@ static inline iotc_state_t do_mqtt_connect(
 
   /* Cancel io timeout. */
   if (NULL != task->timeout.ptr_to_position) {
-    iotc_io_timeouts_cancel(iotc_globals.evtd_instance, &task->timeout,
+    iotc_io_timeouts_cancel(event_dispatcher, &task->timeout,
                             IOTC_CONTEXT_DATA(context)->io_timeouts);
     assert(NULL == task->timeout.ptr_to_position);
   }
@@ -209,7 +212,7 @@ err_handling:
 
   /* Cancel io timeout. */
   if (NULL != task->timeout.ptr_to_position) {
-    iotc_io_timeouts_cancel(iotc_globals.evtd_instance, &task->timeout,
+    iotc_io_timeouts_cancel(event_dispatcher, &task->timeout,
                             IOTC_CONTEXT_DATA(context)->io_timeouts);
     assert(NULL == task->timeout.ptr_to_position);
   }
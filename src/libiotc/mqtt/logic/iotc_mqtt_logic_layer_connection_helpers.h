@@ -52,7 +52,8 @@ static inline iotc_state_t do_shutdown(
 
   IOTC_CR_START(task->cs);
 
-  IOTC_ALLOC_AT(iotc_mqtt_message_t, msg_memory, state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                       msg_memory, state);
 
   IOTC_CHECK_STATE(state = fill_with_disconnect_data(msg_memory));
 
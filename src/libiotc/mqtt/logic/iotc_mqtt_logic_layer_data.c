@@ -23,7 +23,8 @@ extern "C" {
 #endif
 
 iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_publish_task(
-    const char* topic, iotc_data_desc_t* data, const iotc_mqtt_qos_t qos,
+    const char* topic, const iotc_memory_type_t topic_memory_type,
+    iotc_data_desc_t* data, const iotc_mqtt_qos_t qos,
     const iotc_mqtt_retain_t retain, iotc_event_handle_t callback) {
   /* PRECONDITIONS */
   assert(NULL != topic);
@@ -31,22 +32,38 @@ iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_publish_task(
 
   iotc_state_t state = IOTC_STATE_OK;
 
-  IOTC_ALLOC(iotc_mqtt_logic_task_t, task, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                    state);
 
   task->data.mqtt_settings.scenario = IOTC_MQTT_PUBLISH;
   task->data.mqtt_settings.qos = qos;
 
   task->callback = callback;
 
-  IOTC_ALLOC_AT(iotc_mqtt_task_specific_data_t, task->data.data_u, state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_TASK_DATA,
+                       iotc_mqtt_task_specific_data_t, task->data.data_u,
+                       state);
 
   task->data.data_u->publish.retain = retain;
-  task->data.data_u->publish.topic = iotc_str_dup(topic);
+  task->data.data_u->publish.topic_memory_type = topic_memory_type;
   task->data.data_u->publish.data = data;
+  task->payload_size = data->length;
+
+  if (IOTC_MEMORY_TYPE_MANAGED == topic_memory_type) {
+    IOTC_CHECK_MEMORY(task->data.data_u->publish.topic = iotc_str_dup(topic),
+                      state);
+  } else {
+    task->data.data_u->publish.topic = (char*)topic;
+  }
 
   return task;
 
 err_handling:
+  /* the payload is released with the task, or here if it never got one */
+  if (NULL == task || NULL == task->data.data_u) {
+    iotc_free_desc(&data);
+  }
+
   if (task) {
     iotc_mqtt_logic_free_task(&task);
   }
@@ -60,12 +77,15 @@ iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_subscribe_task(
 
   iotc_state_t state = IOTC_STATE_OK;
 
-  IOTC_ALLOC(iotc_mqtt_logic_task_t, task, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                    state);
 
   task->data.mqtt_settings.scenario = IOTC_MQTT_SUBSCRIBE;
   task->data.mqtt_settings.qos = IOTC_MQTT_QOS_AT_LEAST_ONCE;
 
-  IOTC_ALLOC_AT(iotc_mqtt_task_specific_data_t, task->data.data_u, state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_TASK_DATA,
+                       iotc_mqtt_task_specific_data_t, task->data.data_u,
+                       state);
 
   task->data.data_u->subscribe.topic = topic;
   task->data.data_u->subscribe.qos = qos;
@@ -83,7 +103,8 @@ err_handling:
 iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_shutdown_task(void) {
   iotc_state_t state = IOTC_STATE_OK;
 
-  IOTC_ALLOC(iotc_mqtt_logic_task_t, task, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                    state);
 
   task->data.mqtt_settings.scenario = IOTC_MQTT_SHUTDOWN;
   task->priority = IOTC_MQTT_LOGIC_TASK_IMMEDIATE;
@@ -104,7 +125,11 @@ void iotc_mqtt_task_spec_data_free_publish_data(
   assert(NULL != *data);
 
   iotc_free_desc(&(*data)->publish.data);
-  IOTC_SAFE_FREE((*data)->publish.topic);
+
+  if (IOTC_MEMORY_TYPE_MANAGED == (*data)->publish.topic_memory_type) {
+    IOTC_SAFE_FREE((*data)->publish.topic);
+  }
+
   IOTC_SAFE_FREE((*data));
 }
 
@@ -118,12 +143,14 @@ void iotc_mqtt_task_spec_data_free_subscribe_data(
   IOTC_SAFE_FREE((*data));
 }
 
-void iotc_mqtt_task_spec_data_free_subscribe_data_vec(
-    union iotc_vector_selector_u* data, void* arg) {
+void iotc_mqtt_task_spec_data_free_subscribe_data_trie(void* data,
+                                                      void* arg) {
   IOTC_UNUSED(arg);
 
-  iotc_mqtt_task_spec_data_free_subscribe_data(
-      (iotc_mqtt_task_specific_data_t**)&data->ptr_value);
+  iotc_mqtt_task_specific_data_t* subscribe_data =
+      (iotc_mqtt_task_specific_data_t*)data;
+
+  iotc_mqtt_task_spec_data_free_subscribe_data(&subscribe_data);
 }
 
 iotc_mqtt_logic_task_t* iotc_mqtt_logic_free_task_data(
@@ -20,7 +20,9 @@
 #include "iotc_connection_data.h"
 #include "iotc_data_desc.h"
 #include "iotc_event_dispatcher_api.h"
+#include "iotc_mqtt_logic_in_flight.h"
 #include "iotc_mqtt_message.h"
+#include "iotc_topic_trie.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +40,7 @@ typedef enum iotc_scenario_e {
 typedef union {
   struct data_t_publish_t {
     char* topic;
+    iotc_memory_type_t topic_memory_type;
     iotc_data_desc_t* data;
     iotc_mqtt_retain_t retain;
     iotc_mqtt_dup_t dup;
@@ -47,6 +50,8 @@ typedef union {
     char* topic;
     iotc_event_handle_t handler;
     iotc_mqtt_qos_t qos;
+    /* made again after a JWT rotation, the handler only hears of a failure */
+    uint8_t resubscribe;
   } subscribe;
 
   struct data_t_shutdown_t {
@@ -78,6 +83,8 @@ typedef enum {
 
 typedef struct iotc_mqtt_logic_task_s {
   struct iotc_mqtt_logic_task_s* __next;
+  /* only maintained while the task is in an in-flight set */
+  struct iotc_mqtt_logic_task_s* __prev;
   iotc_time_event_handle_t timeout;
   iotc_event_handle_t logic;
   iotc_event_handle_t callback;
@@ -86,6 +93,8 @@ typedef struct iotc_mqtt_logic_task_s {
   iotc_mqtt_logic_task_session_state_t session_state;
   uint16_t cs;
   uint16_t msg_id;
+  /* payload bytes counted against the in-flight window */
+  size_t payload_size;
 } iotc_mqtt_logic_task_t;
 
 typedef struct {
@@ -95,18 +104,22 @@ typedef struct {
    * for each of the subscribed topics. */
 
   /* Handle to the user idle function that suppose to. */
-  iotc_mqtt_logic_task_t* q12_tasks_queue;
-  iotc_mqtt_logic_task_t* q12_recv_tasks_queue;
+  iotc_mqtt_logic_in_flight_t q12_tasks_queue;
+  iotc_mqtt_logic_in_flight_t q12_recv_tasks_queue;
   iotc_mqtt_logic_task_t* q0_tasks_queue;
+  iotc_mqtt_logic_task_t* q0_tasks_queue_tail;
   iotc_mqtt_logic_task_t* current_q0_task;
-  iotc_vector_t* handlers_for_topics;
+  iotc_topic_trie_t* handlers_for_topics;
   iotc_time_event_handle_t keepalive_event;
   uint16_t last_msg_id;
 } iotc_mqtt_logic_layer_data_t;
 
 /* Pseudo constructors. */
+/* A managed topic is copied, an unmanaged one is used in place and has to
+ * outlive the task. */
 extern iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_publish_task(
-    const char* topic, iotc_data_desc_t* data, const iotc_mqtt_qos_t qos,
+    const char* topic, const iotc_memory_type_t topic_memory_type,
+    iotc_data_desc_t* data, const iotc_mqtt_qos_t qos,
     const iotc_mqtt_retain_t retain, iotc_event_handle_t callback);
 
 extern iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_subscribe_task(
@@ -118,8 +131,8 @@ extern void iotc_mqtt_task_spec_data_free_publish_data(
 extern void iotc_mqtt_task_spec_data_free_subscribe_data(
     iotc_mqtt_task_specific_data_t** data);
 
-extern void iotc_mqtt_task_spec_data_free_subscribe_data_vec(
-    union iotc_vector_selector_u* data, void* arg);
+extern void iotc_mqtt_task_spec_data_free_subscribe_data_trie(void* data,
+                                                             void* arg);
 
 extern iotc_mqtt_logic_task_t* iotc_mqtt_logic_make_shutdown_task(void);
 
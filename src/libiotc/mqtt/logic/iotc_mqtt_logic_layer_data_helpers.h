@@ -26,64 +26,39 @@
 extern "C" {
 #endif
 
-static inline int8_t match_topics(const union iotc_vector_selector_u* a,
-                                  const union iotc_vector_selector_u* b) {
-  if (NULL == a || NULL == b) {
-    return 1;
-  }
+/* the subscriptions attached to a topic filter matching a received PUBLISH
+ * each get their own copy of the message since the subscription callback
+ * wrapper releases the message it's given */
+static inline iotc_state_t make_publish_message_copy(
+    const iotc_mqtt_message_t* msg, iotc_mqtt_message_t** out_msg) {
+  iotc_state_t local_state = IOTC_STATE_OK;
 
-  const iotc_mqtt_task_specific_data_t* ca =
-      (const iotc_mqtt_task_specific_data_t*)
-          a->ptr_value; /* This is supposed to be the one from the vector. */
-  const iotc_data_desc_t* cb =
-      (const iotc_data_desc_t*)b->ptr_value; /* This is supposed to be the one
-                                                from the msg. */
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t, msg_copy,
+                    local_state);
 
-  if (NULL == ca || NULL == cb || NULL == ca->subscribe.topic ||
-      NULL == cb->data_ptr) {
-    return 1;
-  }
+  msg_copy->common = msg->common;
+  msg_copy->publish.message_id = msg->publish.message_id;
 
-  // check if we have a wildcard in our subscription
-  const uint8_t subscription_length = strlen(ca->subscribe.topic);
-  if (subscription_length == 0) {
-    return 1;
-  }
+  IOTC_CHECK_MEMORY(msg_copy->publish.topic_name =
+                        iotc_make_desc_from_buffer_copy(
+                            msg->publish.topic_name->data_ptr,
+                            msg->publish.topic_name->length),
+                    local_state);
 
-  const uint8_t published_topic_length = cb->length;
-  if (published_topic_length == 0) {
-    return 1;
+  if (NULL != msg->publish.content && 0 < msg->publish.content->length) {
+    IOTC_CHECK_MEMORY(
+        msg_copy->publish.content = iotc_make_desc_from_buffer_copy(
+            msg->publish.content->data_ptr, msg->publish.content->length),
+        local_state);
   }
 
-  const char last_sub_token = ca->subscribe.topic[subscription_length - 1];
+  *out_msg = msg_copy;
 
-  // first deal with non-wildcard subscriptions. Must be exact
-  if ('#' != last_sub_token) {
-    // we can bail out if our topics aren't exactly the same length
-    if (published_topic_length != subscription_length) return 1;
+  return IOTC_STATE_OK;
 
-    return memcmp(ca->subscribe.topic, cb->data_ptr, published_topic_length)
-               ? 1
-               : 0;
-  } else {
-    // handle the wildcard subscriptions
-    if (subscription_length == 1) {
-      return 0;
-    }
-
-    if ((subscription_length - 1) <= published_topic_length) {
-      // if the published topic has something in the wildcard position
-      return memcmp(ca->subscribe.topic, cb->data_ptr, subscription_length - 1)
-                 ? 1
-                 : 0;
-    } else if ((subscription_length - 2) == published_topic_length) {
-      // match the parent topic, e.g. pear/banana/#, pear/banana
-      return memcmp(ca->subscribe.topic, cb->data_ptr, subscription_length - 2)
-                 ? 1
-                 : 0;
-    }
-  }
-  return 1;
+err_handling:
+  iotc_mqtt_message_free(&msg_copy);
+  return local_state;
 }
 
 static inline iotc_state_t fill_with_pingreq_data(iotc_mqtt_message_t* msg) {
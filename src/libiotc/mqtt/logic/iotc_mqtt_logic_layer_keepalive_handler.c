@@ -39,7 +39,8 @@ iotc_state_t do_mqtt_keepalive_once(void* data) {
 
   layer_data->keepalive_event.ptr_to_position = NULL;
 
-  IOTC_ALLOC(iotc_mqtt_logic_task_t, task, state);
+  IOTC_ALLOC_POOLED(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                    state);
 
   task->data.mqtt_settings.scenario = IOTC_MQTT_KEEPALIVE;
   task->data.mqtt_settings.qos = IOTC_MQTT_QOS_AT_MOST_ONCE;
@@ -73,7 +74,8 @@ iotc_state_t do_mqtt_keepalive_task(void* ctx, void* data, iotc_state_t state,
 
   IOTC_CR_START(task->cs);
 
-  IOTC_ALLOC_AT(iotc_mqtt_message_t, msg_memory, state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                       msg_memory, state);
 
   IOTC_CHECK_STATE(state = fill_with_pingreq_data(msg_memory));
 
@@ -96,7 +98,8 @@ iotc_state_t do_mqtt_keepalive_task(void* ctx, void* data, iotc_state_t state,
         event_dispatcher,
         iotc_make_handle(&on_keepalive_timeout_expiry, context, task, state,
                          msg_memory),
-        IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout,
+        IOTC_SEC_TO_MSEC(
+            IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout),
         &task->timeout);
 
     IOTC_CHECK_STATE(state);
@@ -131,7 +134,8 @@ iotc_state_t do_mqtt_keepalive_task(void* ctx, void* data, iotc_state_t state,
       IOTC_CONNECTION_STATE_OPENED) {
     state = iotc_evtd_execute_in(
         event_dispatcher, iotc_make_handle(&do_mqtt_keepalive_once, context),
-        IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout,
+        IOTC_SEC_TO_MSEC(
+            IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout),
         &layer_data->keepalive_event);
     IOTC_CHECK_STATE(state);
   }
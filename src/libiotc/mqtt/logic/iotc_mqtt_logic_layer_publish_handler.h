@@ -31,6 +31,48 @@
 extern "C" {
 #endif
 
+typedef struct {
+  void* context;
+  iotc_mqtt_message_t* msg;
+  iotc_mqtt_task_specific_data_t* pending_subscribe_data;
+} iotc_mqtt_topic_handler_dispatch_t;
+
+static inline void execute_topic_handler(
+    void* context, /* Should be the context of the logic layer. */
+    iotc_mqtt_task_specific_data_t* subscribe_data,
+    iotc_mqtt_message_t* msg_memory) {
+  subscribe_data->subscribe.handler.handlers.h3.a2 = msg_memory;
+  subscribe_data->subscribe.handler.handlers.h3.a3 = IOTC_STATE_OK;
+
+  /* the messages of a subscription are handled in the order they came in */
+  iotc_evttd_execute_ordered(IOTC_CONTEXT_DATA(context)->evtd_instance,
+                             subscribe_data->subscribe.handler, subscribe_data);
+}
+
+/* Each handler but the last one matched gets a copy of the message, the last
+ * one takes over the received message. Holding a match back until the next
+ * one is found spares a second walk over the trie to count the matches. */
+static inline void on_topic_handler_matched(void* value, void* arg) {
+  iotc_mqtt_topic_handler_dispatch_t* dispatch =
+      (iotc_mqtt_topic_handler_dispatch_t*)arg;
+
+  if (NULL != dispatch->pending_subscribe_data) {
+    iotc_mqtt_message_t* msg_copy = NULL;
+
+    if (IOTC_STATE_OK == make_publish_message_copy(dispatch->msg, &msg_copy)) {
+      execute_topic_handler(dispatch->context,
+                            dispatch->pending_subscribe_data, msg_copy);
+    } else {
+      iotc_debug_format(
+          "[m.id[%d]] not enough memory to pass the message to every "
+          "matching subscription",
+          iotc_mqtt_get_message_id(dispatch->msg));
+    }
+  }
+
+  dispatch->pending_subscribe_data = (iotc_mqtt_task_specific_data_t*)value;
+}
+
 static inline void call_topic_handler(
     void* context, /* Should be the context of the logic layer. */
     void* msg_data) {
@@ -42,27 +84,21 @@ static inline void call_topic_handler(
   /* Pre-conditions. */
   assert(NULL != msg_memory);
 
-  iotc_vector_index_type_t index = 0;
+  iotc_mqtt_topic_handler_dispatch_t dispatch = {context, msg_memory, NULL};
 
   iotc_debug_format("[m.id[%d]] looking for publish message handler",
                     iotc_mqtt_get_message_id(msg_memory));
 
-  index = iotc_vector_find(layer_data->handlers_for_topics,
-                           IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_PTR(
-                               msg_memory->publish.topic_name)),
-                           match_topics);
-
-  if (index != -1) {
-    iotc_mqtt_task_specific_data_t* subscribe_data =
-        (iotc_mqtt_task_specific_data_t*)layer_data->handlers_for_topics
-            ->array[index]
-            .selector_t.ptr_value;
-
-    subscribe_data->subscribe.handler.handlers.h3.a2 = msg_memory;
-    subscribe_data->subscribe.handler.handlers.h3.a3 = IOTC_STATE_OK;
+  if (NULL != msg_memory->publish.topic_name) {
+    iotc_topic_trie_match(layer_data->handlers_for_topics,
+                          msg_memory->publish.topic_name->data_ptr,
+                          msg_memory->publish.topic_name->length,
+                          &on_topic_handler_matched, &dispatch);
+  }
 
-    iotc_evttd_execute(IOTC_CONTEXT_DATA(context)->evtd_instance,
-                       subscribe_data->subscribe.handler);
+  if (NULL != dispatch.pending_subscribe_data) {
+    execute_topic_handler(context, dispatch.pending_subscribe_data,
+                          msg_memory);
   } else {
     iotc_debug_format(
         "[m.id[%d]] received publish message for topic which "
@@ -119,7 +155,8 @@ static inline iotc_state_t on_publish_q1_recieved(
   if (NULL == task) {
     uint16_t msg_id = msg->publish.message_id;
 
-    IOTC_ALLOC_AT(iotc_mqtt_logic_task_t, task, state);
+    IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_TASK, iotc_mqtt_logic_task_t, task,
+                         state);
 
     task->data.mqtt_settings.scenario = IOTC_MQTT_PUBACK;
     task->data.mqtt_settings.qos = IOTC_MQTT_QOS_AT_LEAST_ONCE;
@@ -129,21 +166,13 @@ static inline iotc_state_t on_publish_q1_recieved(
 
     task->msg_id = msg_id;
 
-/* @TODO: change this into debug only compilation. */
-#if 1
-    {
-      iotc_mqtt_logic_task_t* test_task = NULL;
+    state = iotc_mqtt_logic_in_flight_add(&layer_data->q12_recv_tasks_queue,
+                                          task);
 
-      IOTC_LIST_FIND(iotc_mqtt_logic_task_t, layer_data->q12_recv_tasks_queue,
-                     CMP_TASK_MSG_ID, task->msg_id, test_task);
-
-      // there must not be similar tasks
-      assert(NULL == test_task);
+    if (IOTC_STATE_OK != state) {
+      iotc_mqtt_logic_free_task(&task);
+      goto err_handling;
     }
-#endif
-
-    IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t,
-                        layer_data->q12_recv_tasks_queue, task);
   }
 
   IOTC_CR_START(task->cs);
@@ -153,7 +182,8 @@ static inline iotc_state_t on_publish_q1_recieved(
 
   do {
     /* Send puback to the server. */
-    IOTC_ALLOC_AT(iotc_mqtt_message_t, msg, state);
+    IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t, msg,
+                         state);
 
     IOTC_CHECK_STATE(state = fill_with_puback_data(msg, task->msg_id));
 
@@ -170,8 +200,7 @@ static inline iotc_state_t on_publish_q1_recieved(
   /* Msg sent now proceed with cleaning. */
 
   /* Clean the created task data. */
-  IOTC_LIST_DROP(iotc_mqtt_logic_task_t, layer_data->q12_recv_tasks_queue,
-                 task);
+  iotc_mqtt_logic_in_flight_remove(&layer_data->q12_recv_tasks_queue, task);
 
   iotc_mqtt_logic_free_task(&task);
 
@@ -59,7 +59,8 @@ static inline iotc_state_t do_mqtt_publish_q0(
 
   iotc_debug_logger("publish preparing message...");
 
-  IOTC_ALLOC_AT(iotc_mqtt_message_t, msg_memory, state);
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                       msg_memory, state);
 
   IOTC_CHECK_STATE(
       state = fill_with_publish_data(
@@ -63,7 +63,8 @@ static iotc_state_t do_mqtt_publish_q1(
   do {
     iotc_debug_format("[m.id[%d]]publish q1 preparing message", task->msg_id);
 
-    IOTC_ALLOC_AT(iotc_mqtt_message_t, msg_memory, state);
+    IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                         msg_memory, state);
 
     /* Note on memory - here the data ptr's are shared, so no data copy. */
     IOTC_CHECK_STATE(state = fill_with_publish_data(
@@ -101,7 +102,8 @@ static iotc_state_t do_mqtt_publish_q1(
           event_dispatcher,
           iotc_make_handle(&do_mqtt_publish_q1, context, task,
                            IOTC_STATE_TIMEOUT, NULL),
-          IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout,
+          IOTC_SEC_TO_MSEC(
+              IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout),
           &task->timeout);
       IOTC_CHECK_STATE(state);
     }
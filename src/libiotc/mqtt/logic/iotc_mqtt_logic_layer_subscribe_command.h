@@ -18,6 +18,7 @@
 #define __IOTC_MQTT_LOGIC_LAYER_SUBSCRIBE_COMMAND_H__
 
 #include "iotc_coroutine.h"
+#include "iotc_event_thread_dispatcher.h"
 #include "iotc_globals.h"
 #include "iotc_layer_api.h"
 #include "iotc_mqtt_logic_layer_data.h"
@@ -58,7 +59,8 @@ static inline iotc_state_t do_mqtt_subscribe(void* ctx, void* data,
   do {
     iotc_debug_format("[m.id[%d]]subscribe preparing message", task->msg_id);
 
-    IOTC_ALLOC_AT(iotc_mqtt_message_t, msg_memory, state);
+    IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t,
+                         msg_memory, state);
 
     IOTC_CHECK_STATE(state = fill_with_subscribe_data(
                          msg_memory, task->data.data_u->subscribe.topic,
@@ -87,7 +89,7 @@ static inline iotc_state_t do_mqtt_subscribe(void* ctx, void* data,
           iotc_evtd_execute_in(event_dispatcher,
                                iotc_make_handle(&do_mqtt_subscribe, context,
                                                 task, IOTC_STATE_RESEND, NULL),
-                               1, &task->timeout);
+                               IOTC_SEC_TO_MSEC(1), &task->timeout);
 
       IOTC_CHECK_STATE(local_state);
 
@@ -109,7 +111,8 @@ static inline iotc_state_t do_mqtt_subscribe(void* ctx, void* data,
           event_dispatcher,
           iotc_make_handle(&do_mqtt_subscribe, context, task,
                            IOTC_STATE_TIMEOUT, NULL),
-          IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout,
+          IOTC_SEC_TO_MSEC(
+              IOTC_CONTEXT_DATA(context)->connection_data->keepalive_timeout),
           &task->timeout);
       IOTC_CHECK_STATE(local_state);
     }
@@ -164,21 +167,29 @@ static inline iotc_state_t do_mqtt_subscribe(void* ctx, void* data,
     /* check if the suback registration was successfull */
     if (IOTC_MQTT_SUBACK_FAILED != suback_status) {
       /* now it can be registered - we are passing the ownership of the
-       * data.data_u to the vector */
-      IOTC_CHECK_MEMORY(
-          iotc_vector_push(
-              layer_data->handlers_for_topics,
-              IOTC_VEC_VALUE_PARAM(IOTC_VEC_VALUE_PTR(task->data.data_u))),
-          state);
+       * data.data_u to the topic trie */
+      IOTC_CHECK_STATE(state = iotc_topic_trie_add(
+                           layer_data->handlers_for_topics,
+                           task->data.data_u->subscribe.topic,
+                           task->data.data_u));
     }
 
-    IOTC_CHECK_MEMORY(iotc_evtd_execute(event_dispatcher,
-                                        task->data.data_u->subscribe.handler),
-                      state);
+    const uint8_t resubscribe = task->data.data_u->subscribe.resubscribe;
+    task->data.data_u->subscribe.resubscribe = 0;
+
+    /* keyed like the messages of the subscription so the SUBACK is handled
+     * before them */
+    if (0 == resubscribe || IOTC_MQTT_SUBACK_FAILED == suback_status) {
+      IOTC_CHECK_MEMORY(iotc_evttd_execute_ordered(
+                            event_dispatcher,
+                            task->data.data_u->subscribe.handler,
+                            task->data.data_u),
+                        state);
+    }
 
     /* now it's safe to nullify this pointer because the ownership of this
      * memory block is now passed either to a subscription callback or the
-     * handlers_for_topics vector if the subscription was succesfull */
+     * handlers_for_topics trie if the subscription was succesfull */
     task->data.data_u = NULL;
 
     IOTC_CR_EXIT(task->cs, iotc_mqtt_logic_layer_finalize_task(context, task));
@@ -15,6 +15,7 @@
  */
 
 #include "iotc_mqtt_logic_layer_task_helpers.h"
+#include "iotc_backoff_status_api.h"
 #include "iotc_event_thread_dispatcher.h"
 #include "iotc_layer_api.h"
 #include "iotc_list.h"
@@ -44,15 +45,17 @@ iotc_state_t iotc_mqtt_logic_layer_run_next_q0_task(void* data) {
   iotc_mqtt_logic_task_t* task = 0;
 
   if (layer_data->q0_tasks_queue != 0) {
-    IOTC_LIST_POP(iotc_mqtt_logic_task_t, layer_data->q0_tasks_queue, task);
+    IOTC_LIST_POP_WITH_TAIL(iotc_mqtt_logic_task_t, layer_data->q0_tasks_queue,
+                            layer_data->q0_tasks_queue_tail, task);
 
     /* prevent execution of other tasks while connecting */
     if (IOTC_CONTEXT_DATA(context)->connection_data->connection_state ==
         IOTC_CONNECTION_STATE_OPENING) {
       /* we only allow connect while client is disconnected */
       if (task->data.mqtt_settings.scenario != IOTC_MQTT_CONNECT) {
-        IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t, layer_data->q0_tasks_queue,
-                            task);
+        IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_mqtt_logic_task_t,
+                                      layer_data->q0_tasks_queue,
+                                      layer_data->q0_tasks_queue_tail, task);
 
         return IOTC_STATE_OK;
       }
@@ -80,10 +83,49 @@ void iotc_mqtt_logic_task_defer_users_callback(void* context,
     iotc_event_handle_t handle = task->callback;
     handle.handlers.h3.a3 = state;
 
-    iotc_evttd_execute(IOTC_CONTEXT_DATA(context)->evtd_instance, handle);
+    iotc_evttd_execute_ordered(IOTC_CONTEXT_DATA(context)->evtd_instance,
+                               handle, IOTC_CONTEXT_DATA(context));
   }
 }
 
+/* an empty window takes any message so a payload larger than the byte limit
+ * still goes out on its own */
+static int iotc_in_flight_window_is_full(
+    const iotc_context_data_t* context_data,
+    const iotc_mqtt_logic_in_flight_t* in_flight, size_t payload_size) {
+  if (0 == in_flight->size) {
+    return 0;
+  }
+
+  if (0 != context_data->in_flight_window_messages &&
+      context_data->in_flight_window_messages <= in_flight->size) {
+    return 1;
+  }
+
+  return 0 != context_data->in_flight_window_bytes &&
+         (context_data->in_flight_window_bytes <= in_flight->bytes ||
+          context_data->in_flight_window_bytes - in_flight->bytes <
+              payload_size);
+}
+
+iotc_state_t iotc_mqtt_logic_publish_admit(
+    const iotc_context_data_t* context_data,
+    const iotc_mqtt_logic_layer_data_t* layer_data,
+    const iotc_mqtt_logic_task_t* task) {
+  if (IOTC_BACKOFF_CLASS_NONE != context_data->backoff_status.backoff_class) {
+    return IOTC_BACKOFF_TERMINAL;
+  }
+
+  if (IOTC_MQTT_QOS_AT_MOST_ONCE != task->data.mqtt_settings.qos &&
+      NULL != layer_data &&
+      iotc_in_flight_window_is_full(context_data, &layer_data->q12_tasks_queue,
+                                    task->payload_size)) {
+    return IOTC_IN_FLIGHT_WINDOW_FULL;
+  }
+
+  return IOTC_STATE_OK;
+}
+
 iotc_state_t iotc_mqtt_logic_layer_finalize_task(
     iotc_layer_connectivity_t* context, iotc_mqtt_logic_task_t* task) {
   /* PRECONDITION */
@@ -102,7 +144,7 @@ iotc_state_t iotc_mqtt_logic_layer_finalize_task(
   } else /* I left it for better code readability */
   {
     /* detach the task from the qos 1 and 2 queue */
-    IOTC_LIST_DROP(iotc_mqtt_logic_task_t, layer_data->q12_tasks_queue, task);
+    iotc_mqtt_logic_in_flight_remove(&layer_data->q12_tasks_queue, task);
 
     /* release task's memory */
     iotc_mqtt_logic_free_task(&task);
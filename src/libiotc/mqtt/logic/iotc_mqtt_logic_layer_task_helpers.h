@@ -17,6 +17,7 @@
 #ifndef __IOTC_MQTT_LOGIC_LAYER_TASK_HELPERS_H__
 #define __IOTC_MQTT_LOGIC_LAYER_TASK_HELPERS_H__
 
+#include "iotc_coroutine.h"
 #include "iotc_event_dispatcher_api.h"
 #include "iotc_globals.h"
 #include "iotc_io_timeouts.h"
@@ -37,7 +38,12 @@ void iotc_mqtt_logic_task_defer_users_callback(void* context,
                                                iotc_mqtt_logic_task_t* task,
                                                iotc_state_t state);
 
-#define CMP_TASK_MSG_ID(task, id) (task->msg_id == id)
+/* whether a publish may be handed to the MQTT logic layer now, given the
+ * backoff and the in-flight window of the context */
+iotc_state_t iotc_mqtt_logic_publish_admit(
+    const iotc_context_data_t* context_data,
+    const iotc_mqtt_logic_layer_data_t* layer_data,
+    const iotc_mqtt_logic_task_t* task);
 
 static inline void cancel_task_timeout(iotc_mqtt_logic_task_t* task,
                                        iotc_layer_connectivity_t* context) {
@@ -95,6 +101,12 @@ static inline void set_new_context_and_call_resend(iotc_mqtt_logic_task_t* task,
   if (task->session_state == IOTC_MQTT_LOGIC_TASK_SESSION_STORE) {
     task->logic.handlers.h4.a1 = context;
     resend_task(task);
+  } else {
+    /* queued while the connection was opening or kept by a JWT rotation
+     * before its message was written, it starts over */
+    IOTC_CR_RESET(task->cs);
+    task->logic.handlers.h4.a1 = context;
+    signal_task(task, IOTC_STATE_OK);
   }
 }
 
@@ -114,12 +126,14 @@ static inline iotc_state_t run_task(iotc_layer_connectivity_t* context,
     /* task on qos0 can be prioritized */
     switch (task->priority) {
       case IOTC_MQTT_LOGIC_TASK_NORMAL:
-        IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t, layer_data->q0_tasks_queue,
-                            task);
+        IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_mqtt_logic_task_t,
+                                      layer_data->q0_tasks_queue,
+                                      layer_data->q0_tasks_queue_tail, task);
         break;
       case IOTC_MQTT_LOGIC_TASK_IMMEDIATE:
-        IOTC_LIST_PUSH_FRONT(iotc_mqtt_logic_task_t, layer_data->q0_tasks_queue,
-                             task);
+        IOTC_LIST_PUSH_FRONT_WITH_TAIL(iotc_mqtt_logic_task_t,
+                                       layer_data->q0_tasks_queue,
+                                       layer_data->q0_tasks_queue_tail, task);
         break;
     }
 
@@ -131,20 +145,16 @@ static inline iotc_state_t run_task(iotc_layer_connectivity_t* context,
      * and to demultiplex msgs */
     task->msg_id = ++layer_data->last_msg_id;
 
-#ifdef IOTC_DEBUG_EXTRA_INFO
-    iotc_mqtt_logic_task_t* needle = NULL;
-    IOTC_LIST_FIND(iotc_mqtt_logic_task_t, layer_data->q12_tasks_queue,
-                   CMP_TASK_MSG_ID,
-                   task->msg_id, /* this is linear search so we have O(n)
-                                    complexity it can be optimized but for the
-                                    small n it is acceptable complexity */
-                   needle);
-    assert(NULL == needle && "task with the same id already exist");
-#endif
-
     /* add it to the queue which is really a multiplexer of message id's */
-    IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t, layer_data->q12_tasks_queue,
-                        task);
+    iotc_state_t state =
+        iotc_mqtt_logic_in_flight_add(&layer_data->q12_tasks_queue, task);
+
+    if (IOTC_STATE_OK != state) {
+      /* the task never started, let the user know it won't be sent */
+      iotc_mqtt_logic_task_defer_users_callback(context, task, state);
+      iotc_mqtt_logic_free_task(&task);
+      return state;
+    }
 
     /* execute it immediately
      * @TODO concider a different strategy of execution in order to minimize the
@@ -0,0 +1,193 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IOTC_ATOMIC_H__
+#define __IOTC_ATOMIC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file iotc_atomic.h
+ * @brief Atomic operations on pointers, counters, sizes and 64 bit words
+ *
+ * With the thread module the operations map to the compiler builtins, loads
+ * acquire and stores release. Without it they are plain memory accesses, so
+ * the single threaded builds don't depend on atomic instructions or on
+ * libatomic.
+ */
+
+#ifdef IOTC_MODULE_THREAD_ENABLED
+
+static inline void* iotc_atomic_load_ptr(void* const* ptr) {
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void iotc_atomic_store_ptr(void** ptr, void* value) {
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline void* iotc_atomic_exchange_ptr(void** ptr, void* value) {
+  return __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+/* on failure expected is updated to the current value */
+static inline uint8_t iotc_atomic_compare_exchange_ptr(void** ptr,
+                                                       void** expected,
+                                                       void* desired) {
+  return __atomic_compare_exchange_n(ptr, expected, desired, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+             ? 1
+             : 0;
+}
+
+/* counters only, the additions don't order other memory accesses */
+static inline void iotc_atomic_add_u32(uint32_t* ptr, uint32_t value) {
+  __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+static inline void iotc_atomic_add_u64(uint64_t* ptr, uint64_t value) {
+  __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+/* returns the value before the addition */
+static inline uint32_t iotc_atomic_fetch_add_u32(uint32_t* ptr,
+                                                 uint32_t value) {
+  return __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t iotc_atomic_load_u32(const uint32_t* ptr) {
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void iotc_atomic_store_u32(uint32_t* ptr, uint32_t value) {
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline size_t iotc_atomic_load_size(const size_t* ptr) {
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void iotc_atomic_store_size(size_t* ptr, size_t value) {
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline uint64_t iotc_atomic_load_u64(const uint64_t* ptr) {
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void iotc_atomic_store_u64(uint64_t* ptr, uint64_t value) {
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+/* on failure expected is updated to the current value */
+static inline uint8_t iotc_atomic_compare_exchange_u64(uint64_t* ptr,
+                                                       uint64_t* expected,
+                                                       uint64_t desired) {
+  return __atomic_compare_exchange_n(ptr, expected, desired, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+             ? 1
+             : 0;
+}
+
+#else
+
+static inline void* iotc_atomic_load_ptr(void* const* ptr) { return *ptr; }
+
+static inline void iotc_atomic_store_ptr(void** ptr, void* value) {
+  *ptr = value;
+}
+
+static inline void* iotc_atomic_exchange_ptr(void** ptr, void* value) {
+  void* const prev = *ptr;
+  *ptr = value;
+  return prev;
+}
+
+static inline uint8_t iotc_atomic_compare_exchange_ptr(void** ptr,
+                                                       void** expected,
+                                                       void* desired) {
+  if (*ptr != *expected) {
+    *expected = *ptr;
+    return 0;
+  }
+
+  *ptr = desired;
+  return 1;
+}
+
+static inline void iotc_atomic_add_u32(uint32_t* ptr, uint32_t value) {
+  *ptr += value;
+}
+
+static inline void iotc_atomic_add_u64(uint64_t* ptr, uint64_t value) {
+  *ptr += value;
+}
+
+static inline uint32_t iotc_atomic_fetch_add_u32(uint32_t* ptr,
+                                                 uint32_t value) {
+  const uint32_t prev = *ptr;
+  *ptr += value;
+  return prev;
+}
+
+static inline uint32_t iotc_atomic_load_u32(const uint32_t* ptr) {
+  return *ptr;
+}
+
+static inline void iotc_atomic_store_u32(uint32_t* ptr, uint32_t value) {
+  *ptr = value;
+}
+
+static inline size_t iotc_atomic_load_size(const size_t* ptr) {
+  return *ptr;
+}
+
+static inline void iotc_atomic_store_size(size_t* ptr, size_t value) {
+  *ptr = value;
+}
+
+static inline uint64_t iotc_atomic_load_u64(const uint64_t* ptr) {
+  return *ptr;
+}
+
+static inline void iotc_atomic_store_u64(uint64_t* ptr, uint64_t value) {
+  *ptr = value;
+}
+
+static inline uint8_t iotc_atomic_compare_exchange_u64(uint64_t* ptr,
+                                                       uint64_t* expected,
+                                                       uint64_t desired) {
+  if (*ptr != *expected) {
+    *expected = *ptr;
+    return 0;
+  }
+
+  *ptr = desired;
+  return 1;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IOTC_ATOMIC_H__ */
@@ -0,0 +1,86 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef __IOTC_THREAD_IO_LOOP_H__
+#define __IOTC_THREAD_IO_LOOP_H__
+
+#include <stdint.h>
+
+#include <iotc_event_dispatcher_api.h>
+
+struct iotc_io_loop_s;
+
+#ifdef IOTC_MODULE_THREAD_ENABLED
+
+/**
+ * @brief Creates an I/O loop: a thread running the event loop on an event
+ * dispatcher of its own.
+ *
+ * The thread starts at once and sleeps in the event loop until its dispatcher
+ * gets work. Events queued from other threads wake it up, so contexts using
+ * the dispatcher of the I/O loop are driven by its thread only.
+ */
+struct iotc_io_loop_s* iotc_io_loop_create_instance(void);
+
+/**
+ * @brief Stops the I/O loop, joins its thread and destroys its dispatcher.
+ *
+ * No context may use the dispatcher of the I/O loop anymore.
+ */
+void iotc_io_loop_destroy_instance(struct iotc_io_loop_s** io_loop);
+
+iotc_evtd_instance_t* iotc_io_loop_get_evtd(struct iotc_io_loop_s* io_loop);
+
+/**
+ * @brief Stops the event loop of the I/O loop, safe to call from any thread.
+ */
+void iotc_io_loop_stop(struct iotc_io_loop_s* io_loop);
+
+/**
+ * @brief Waits for the thread of a stopped I/O loop to return.
+ *
+ * Once it returns the dispatcher of the I/O loop is not stepped anymore, so
+ * its contexts may be deleted. Joining a second time returns at once.
+ */
+void iotc_io_loop_join(struct iotc_io_loop_s* io_loop);
+
+/**
+ * @retval 1 the caller runs on the thread of the I/O loop
+ * @retval 0 the caller runs on any other thread
+ */
+uint8_t iotc_io_loop_is_current_thread(const struct iotc_io_loop_s* io_loop);
+
+#else
+
+/**
+ * @brief NULL I/O loop generator for non-threaded library versions.
+ */
+#define iotc_io_loop_create_instance(...) NULL
+
+/**
+ * @brief NOOPERATION functions for non-threaded library versions, all the
+ * contexts run on the thread calling the event loop.
+ */
+#define iotc_io_loop_destroy_instance(...)
+#define iotc_io_loop_get_evtd(...) NULL
+#define iotc_io_loop_stop(...)
+#define iotc_io_loop_join(...)
+#define iotc_io_loop_is_current_thread(...) 1
+
+#endif
+
+#endif /* __IOTC_THREAD_IO_LOOP_H__ */
@@ -25,12 +25,33 @@
 
 #define IOTC_THREADPOOL_MAXNUMOFTHREADS 10
 
+/* events of different ordering keys may share a strand, they are kept in
+ * order then too */
+#ifndef IOTC_THREADPOOL_STRANDS
+#define IOTC_THREADPOOL_STRANDS 16
+#endif
+
+struct iotc_threadpool_queue_s;
+struct iotc_threadpool_strand_s;
+
 /**
  * @brief threadpool, owns workerthreads, coordinates event executions
+ *
+ * Any-thread events are spread over the queues of the workerthreads, a
+ * workerthread out of work steals from the queues of the others. Events
+ * executed in order go through the strand of their ordering key, only one
+ * event of a strand is queued at a time.
  */
 typedef struct iotc_threadpool_s {
   iotc_vector_t* workerthreads;
   iotc_evtd_instance_t* threadpool_evtd;
+  /* the any-thread events wake the workerthreads in turns */
+  iotc_evtd_wakeup_t wakeup;
+  uint32_t next_workerthread;
+  /* one per workerthread */
+  struct iotc_threadpool_queue_s* queues;
+  uint8_t num_of_threads;
+  struct iotc_threadpool_strand_s* strands;
 } iotc_threadpool_t;
 
 /**
@@ -71,6 +92,33 @@ iotc_event_handle_queue_t* iotc_threadpool_execute(
 iotc_event_handle_queue_t* iotc_threadpool_execute_on_thread(
     iotc_threadpool_t* threadpool, iotc_event_handle_t handle, uint8_t tid);
 
+/**
+ * @brief Enqueues event for any-thread execution after the events enqueued
+ * before with the same key.
+ *
+ * Events of one key never run at the same time and run in the order they
+ * were enqueued, events of different keys may run in parallel.
+ *
+ * @param threadpool Enqueue the event into this threadpool.
+ * @param handle The event handle will be enqueued.
+ * @param key Any pointer identifying the sequence of events.
+ */
+iotc_event_handle_queue_t* iotc_threadpool_execute_ordered(
+    iotc_threadpool_t* threadpool, iotc_event_handle_t handle,
+    const void* key);
+
+/**
+ * @brief Executes one event of the threadpool on workerthread tid.
+ *
+ * Takes an event from the queue of the workerthread first, then from the
+ * threadpool evtd, then steals one from the queue of another workerthread.
+ * Called by the workerthreads of the pool in their loop.
+ *
+ * @retval 1 an event has been executed
+ * @retval 0 there was no event to execute
+ */
+uint8_t iotc_threadpool_run_one(iotc_threadpool_t* threadpool, uint8_t tid);
+
 #else
 
 struct iotc_threadpool_t;
@@ -20,6 +20,7 @@
 #include <iotc_event_dispatcher_api.h>
 
 struct iotc_workerthread_s;
+struct iotc_threadpool_s;
 
 /**
  * @brief Creates a workerthread instance.
@@ -31,6 +32,18 @@ struct iotc_workerthread_s;
 struct iotc_workerthread_s* iotc_workerthread_create_instance(
     iotc_evtd_instance_t* evtd_secondary);
 
+/**
+ * @brief Creates a workerthread of a threadpool.
+ *
+ * The workerthread executes the events of the threadpool with
+ * iotc_threadpool_run_one() in each loop, the evtd of the threadpool is its
+ * secondary evtd.
+ *
+ * @param tid The index of the workerthread in the threadpool.
+ */
+struct iotc_workerthread_s* iotc_workerthread_create_pool_instance(
+    struct iotc_threadpool_s* threadpool, uint8_t tid);
+
 /**
  * @brief Destroys workerthread instance.
  *
@@ -39,6 +52,15 @@ struct iotc_workerthread_s* iotc_workerthread_create_instance(
 void iotc_workerthread_destroy_instance(
     struct iotc_workerthread_s** workerthread);
 
+/**
+ * @brief Wakes the workerthread up if it sleeps.
+ *
+ * The event dispatchers of the workerthread call it whenever they get work,
+ * a threadpool calls it for events of the secondary evtd. Safe to call from
+ * any thread.
+ */
+void iotc_workerthread_wakeup(struct iotc_workerthread_s* workerthread);
+
 /**
  * @brief Waits for syncpoint: workerthread started to run.
  *
@@ -0,0 +1,201 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "iotc_allocator.h"
+#include "iotc_debug.h"
+#include "iotc_event_loop.h"
+#include "iotc_macros.h"
+#include "iotc_thread_io_loop.h"
+
+typedef struct iotc_io_loop_s {
+  iotc_evtd_instance_t* evtd;
+  pthread_t thread;
+  uint8_t joined;
+
+  /* the read end is registered on evtd, a byte written to the other end
+   * wakes the thread up from the select or the poller of the event loop */
+  int wake_fds[2];
+  /* set while a byte is on its way, the wakeups in between don't write */
+  uint8_t wake_pending;
+  /* registered on evtd, calls iotc_io_loop_wakeup() */
+  iotc_evtd_wakeup_t wakeup;
+} iotc_io_loop_t;
+
+/* the I/O loop the calling thread runs, if any */
+static __thread iotc_io_loop_t* iotc_io_loop_current = NULL;
+
+static void iotc_io_loop_wakeup(void* data) {
+  iotc_io_loop_t* io_loop = (iotc_io_loop_t*)data;
+
+  /* the thread itself calculates its timeout again before it blocks */
+  if (io_loop == iotc_io_loop_current) {
+    return;
+  }
+
+  if (0 == __atomic_exchange_n(&io_loop->wake_pending, 1, __ATOMIC_ACQ_REL)) {
+    const uint8_t byte = 0;
+    /* a full pipe wakes the thread up just as well */
+    const ssize_t written = write(io_loop->wake_fds[1], &byte, sizeof(byte));
+    IOTC_UNUSED(written);
+  }
+}
+
+/* The events queued by the wakeups coalesced since the byte was written are
+ * in the call queue already, the step after this handler executes them. */
+static iotc_state_t iotc_io_loop_drain(void* data) {
+  iotc_io_loop_t* io_loop = (iotc_io_loop_t*)data;
+
+  uint8_t buffer[16];
+  while (0 < read(io_loop->wake_fds[0], buffer, sizeof(buffer))) {
+    ;
+  }
+
+  __atomic_exchange_n(&io_loop->wake_pending, 0, __ATOMIC_ACQ_REL);
+
+  return IOTC_STATE_OK;
+}
+
+static void* iotc_io_loop_start_routine(void* ctx) {
+  iotc_io_loop_t* io_loop = (iotc_io_loop_t*)ctx;
+
+  iotc_io_loop_current = io_loop;
+
+  const iotc_state_t state = iotc_event_loop_with_evtds(0, &io_loop->evtd, 1);
+
+  if (IOTC_STATE_OK != state) {
+    iotc_debug_format("I/O loop [%p] failed, reason: %d", io_loop, state);
+  }
+
+  return NULL;
+}
+
+static int iotc_io_loop_set_nonblocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL);
+
+  return (-1 == flags) ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+iotc_io_loop_t* iotc_io_loop_create_instance(void) {
+  iotc_state_t state = IOTC_STATE_OK;
+  uint8_t registered = 0;
+
+  IOTC_ALLOC(iotc_io_loop_t, io_loop, state);
+
+  io_loop->wake_fds[0] = -1;
+  io_loop->wake_fds[1] = -1;
+
+  io_loop->evtd = iotc_evtd_create_instance();
+  IOTC_CHECK_MEMORY(io_loop->evtd, state);
+
+  IOTC_CHECK_CND_DBGMESSAGE(0 != pipe(io_loop->wake_fds), IOTC_INTERNAL_ERROR,
+                            state, "could not create the wake pipe");
+
+  IOTC_CHECK_CND_DBGMESSAGE(
+      -1 == iotc_io_loop_set_nonblocking(io_loop->wake_fds[0]) ||
+          -1 == iotc_io_loop_set_nonblocking(io_loop->wake_fds[1]),
+      IOTC_INTERNAL_ERROR, state, "could not set up the wake pipe");
+
+  IOTC_CHECK_CND_DBGMESSAGE(
+      1 != iotc_evtd_register_socket_fd(
+               io_loop->evtd, io_loop->wake_fds[0],
+               iotc_make_handle(&iotc_io_loop_drain, io_loop)),
+      IOTC_OUT_OF_MEMORY, state, "could not register the wake pipe");
+
+  registered = 1;
+
+  io_loop->wakeup.fn = &iotc_io_loop_wakeup;
+  io_loop->wakeup.data = io_loop;
+
+  iotc_evtd_set_wakeup(io_loop->evtd, &io_loop->wakeup);
+
+  const int ret_pthread_create = pthread_create(
+      &io_loop->thread, NULL, iotc_io_loop_start_routine, io_loop);
+
+  IOTC_CHECK_CND_DBGMESSAGE(0 != ret_pthread_create, IOTC_INTERNAL_ERROR,
+                            state, "creation of the I/O loop thread failed");
+
+  return io_loop;
+
+err_handling:
+  if (NULL != io_loop) {
+    if (0 != registered) {
+      iotc_evtd_set_wakeup(io_loop->evtd, NULL);
+      iotc_evtd_unregister_socket_fd(io_loop->evtd, io_loop->wake_fds[0]);
+    }
+
+    if (-1 != io_loop->wake_fds[0]) {
+      close(io_loop->wake_fds[0]);
+      close(io_loop->wake_fds[1]);
+    }
+
+    iotc_evtd_destroy_instance(io_loop->evtd);
+  }
+
+  IOTC_SAFE_FREE(io_loop);
+
+  return NULL;
+}
+
+void iotc_io_loop_destroy_instance(iotc_io_loop_t** io_loop) {
+  if (NULL == io_loop || NULL == *io_loop) {
+    return;
+  }
+
+  iotc_io_loop_stop(*io_loop);
+  iotc_io_loop_join(*io_loop);
+
+  iotc_evtd_set_wakeup((*io_loop)->evtd, NULL);
+  iotc_evtd_unregister_socket_fd((*io_loop)->evtd, (*io_loop)->wake_fds[0]);
+
+  close((*io_loop)->wake_fds[0]);
+  close((*io_loop)->wake_fds[1]);
+
+  iotc_evtd_destroy_instance((*io_loop)->evtd);
+
+  IOTC_SAFE_FREE(*io_loop);
+}
+
+iotc_evtd_instance_t* iotc_io_loop_get_evtd(iotc_io_loop_t* io_loop) {
+  assert(NULL != io_loop);
+
+  return io_loop->evtd;
+}
+
+void iotc_io_loop_stop(iotc_io_loop_t* io_loop) {
+  assert(NULL != io_loop);
+
+  iotc_evtd_stop(io_loop->evtd);
+}
+
+void iotc_io_loop_join(iotc_io_loop_t* io_loop) {
+  assert(NULL != io_loop);
+  assert(io_loop != iotc_io_loop_current);
+
+  if (0 == io_loop->joined) {
+    pthread_join(io_loop->thread, NULL);
+    io_loop->joined = 1;
+  }
+}
+
+uint8_t iotc_io_loop_is_current_thread(const iotc_io_loop_t* io_loop) {
+  return (NULL != io_loop && io_loop == iotc_io_loop_current) ? 1 : 0;
+}
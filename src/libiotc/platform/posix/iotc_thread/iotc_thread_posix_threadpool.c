@@ -14,9 +14,209 @@
  * limitations under the License.
  */
 
+#include <assert.h>
+
+#include <iotc_bsp_time.h>
 #include <iotc_thread_posix_workerthread.h>
+#include "iotc_critical_section.h"
+#include "iotc_list.h"
 #include "iotc_thread_threadpool.h"
 
+/* the events waiting for a workerthread, the workerthread takes the oldest
+ * one, so do the others when they steal */
+typedef struct iotc_threadpool_queue_s {
+  struct iotc_critical_section_s* cs;
+  iotc_event_handle_queue_t* events;
+  iotc_event_handle_queue_t* events_tail;
+  uint32_t size;
+} iotc_threadpool_queue_t;
+
+/* the events of the ordering keys hashed to the strand, task runs them one by
+ * one and is queued only while it is not running */
+typedef struct iotc_threadpool_strand_s {
+  struct iotc_critical_section_s* cs;
+  iotc_event_handle_queue_t* events;
+  iotc_event_handle_queue_t* events_tail;
+  uint8_t scheduled;
+  iotc_event_handle_queue_t task;
+} iotc_threadpool_strand_t;
+
+static iotc_workerthread_t* iotc_threadpool_get_workerthread(
+    iotc_threadpool_t* threadpool, uint32_t tid) {
+  if (NULL == threadpool->workerthreads ||
+      tid >= (uint32_t)threadpool->workerthreads->elem_no) {
+    return NULL;
+  }
+
+  return (iotc_workerthread_t*)threadpool->workerthreads->array[tid]
+      .selector_t.ptr_value;
+}
+
+static void iotc_threadpool_wakeup_workerthread(iotc_threadpool_t* threadpool,
+                                                uint32_t tid) {
+  iotc_workerthread_t* workerthread =
+      iotc_threadpool_get_workerthread(threadpool, tid);
+
+  if (NULL != workerthread) {
+    iotc_workerthread_wakeup(workerthread);
+  }
+}
+
+static void iotc_threadpool_wakeup(void* data) {
+  iotc_threadpool_t* threadpool = (iotc_threadpool_t*)data;
+
+  const uint32_t next =
+      __sync_fetch_and_add(&threadpool->next_workerthread, 1) %
+      threadpool->num_of_threads;
+
+  iotc_threadpool_wakeup_workerthread(threadpool, next);
+}
+
+/* Queues the event for the workerthreads in turns. If the workerthread still
+ * has events to execute the next one is woken up too, to steal them. */
+static void iotc_threadpool_push(iotc_threadpool_t* threadpool,
+                                 iotc_event_handle_queue_t* elem) {
+  const uint32_t tid =
+      __sync_fetch_and_add(&threadpool->next_workerthread, 1) %
+      threadpool->num_of_threads;
+
+  iotc_threadpool_queue_t* queue = &threadpool->queues[tid];
+
+  iotc_lock_critical_section(queue->cs);
+  IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_event_handle_queue_t, queue->events,
+                                queue->events_tail, elem);
+  const uint32_t size = ++queue->size;
+  iotc_unlock_critical_section(queue->cs);
+
+  iotc_threadpool_wakeup_workerthread(threadpool, tid);
+
+  if (1 < size) {
+    iotc_threadpool_wakeup_workerthread(threadpool,
+                                        (tid + 1) % threadpool->num_of_threads);
+  }
+}
+
+static iotc_event_handle_queue_t* iotc_threadpool_pop(
+    iotc_threadpool_queue_t* queue) {
+  iotc_event_handle_queue_t* elem = NULL;
+
+  iotc_lock_critical_section(queue->cs);
+
+  if (!IOTC_LIST_EMPTY(iotc_event_handle_queue_t, queue->events)) {
+    IOTC_LIST_POP_WITH_TAIL(iotc_event_handle_queue_t, queue->events,
+                            queue->events_tail, elem);
+    --queue->size;
+  }
+
+  iotc_unlock_critical_section(queue->cs);
+
+  return elem;
+}
+
+static uint8_t iotc_threadpool_is_strand_task(
+    const iotc_threadpool_t* threadpool, const iotc_event_handle_queue_t* elem) {
+  const uint8_t* strands = (const uint8_t*)threadpool->strands;
+
+  return ((const uint8_t*)elem >= strands &&
+          (const uint8_t*)elem <
+              strands + IOTC_THREADPOOL_STRANDS *
+                            sizeof(iotc_threadpool_strand_t))
+             ? 1
+             : 0;
+}
+
+/* Runs the oldest event of the strand. The strand task is queued again while
+ * there are events left, so the events of a strand never run in parallel. */
+static iotc_state_t iotc_threadpool_run_strand(void* data, void* strand_data) {
+  iotc_threadpool_t* threadpool = (iotc_threadpool_t*)data;
+  iotc_threadpool_strand_t* strand = (iotc_threadpool_strand_t*)strand_data;
+  iotc_event_handle_queue_t* elem = NULL;
+
+  iotc_lock_critical_section(strand->cs);
+  IOTC_LIST_POP_WITH_TAIL(iotc_event_handle_queue_t, strand->events,
+                          strand->events_tail, elem);
+  iotc_unlock_critical_section(strand->cs);
+
+  const iotc_state_t result = iotc_evtd_execute_handle(&elem->handle);
+  IOTC_SAFE_FREE(elem);
+
+  iotc_lock_critical_section(strand->cs);
+  const uint8_t reschedule =
+      IOTC_LIST_EMPTY(iotc_event_handle_queue_t, strand->events) ? 0 : 1;
+  strand->scheduled = reschedule;
+  iotc_unlock_critical_section(strand->cs);
+
+  if (0 != reschedule) {
+    iotc_threadpool_push(threadpool, &strand->task);
+  }
+
+  return result;
+}
+
+static uint32_t iotc_threadpool_strand_index(const void* key) {
+  /* the keys are pointers, the low bits of aligned ones are all the same,
+   * the high half of the product mixes in every bit */
+  const uint64_t bits = (uint64_t)(uintptr_t)key;
+  const uint32_t hash = (uint32_t)(bits ^ (bits >> 32)) * 2654435761u;
+
+  return (hash >> 16) % IOTC_THREADPOOL_STRANDS;
+}
+
+static void iotc_threadpool_destroy_queues(iotc_threadpool_t* threadpool) {
+  uint32_t i = 0;
+
+  if (NULL != threadpool->queues) {
+    for (i = 0; i < threadpool->num_of_threads; ++i) {
+      iotc_destroy_critical_section(&threadpool->queues[i].cs);
+    }
+  }
+
+  if (NULL != threadpool->strands) {
+    for (i = 0; i < IOTC_THREADPOOL_STRANDS; ++i) {
+      iotc_destroy_critical_section(&threadpool->strands[i].cs);
+    }
+  }
+
+  IOTC_SAFE_FREE(threadpool->queues);
+  IOTC_SAFE_FREE(threadpool->strands);
+}
+
+static iotc_state_t iotc_threadpool_create_queues(
+    iotc_threadpool_t* threadpool, uint8_t num_of_threads) {
+  iotc_state_t state = IOTC_STATE_OK;
+  uint32_t i = 0;
+
+  IOTC_ALLOC_BUFFER_AT(iotc_threadpool_queue_t, threadpool->queues,
+                       num_of_threads * sizeof(iotc_threadpool_queue_t),
+                       state);
+  threadpool->num_of_threads = num_of_threads;
+
+  IOTC_ALLOC_BUFFER_AT(
+      iotc_threadpool_strand_t, threadpool->strands,
+      IOTC_THREADPOOL_STRANDS * sizeof(iotc_threadpool_strand_t), state);
+
+  for (i = 0; i < num_of_threads; ++i) {
+    IOTC_CHECK_STATE(
+        state = iotc_init_critical_section(&threadpool->queues[i].cs));
+  }
+
+  for (i = 0; i < IOTC_THREADPOOL_STRANDS; ++i) {
+    iotc_threadpool_strand_t* strand = &threadpool->strands[i];
+
+    IOTC_CHECK_STATE(state = iotc_init_critical_section(&strand->cs));
+
+    strand->task.handle = iotc_make_threaded_handle(
+        IOTC_THREADID_ANYTHREAD, &iotc_threadpool_run_strand, threadpool,
+        strand);
+  }
+
+  return IOTC_STATE_OK;
+
+err_handling:
+  iotc_threadpool_destroy_queues(threadpool);
+  return state;
+}
+
 iotc_threadpool_t* iotc_threadpool_create_instance(uint8_t num_of_threads) {
   num_of_threads =
       IOTC_MIN(IOTC_MAX(num_of_threads, 1), IOTC_THREADPOOL_MAXNUMOFTHREADS);
@@ -30,6 +230,9 @@ iotc_threadpool_t* iotc_threadpool_create_instance(uint8_t num_of_threads) {
                             IOTC_OUT_OF_MEMORY, state,
                             "could not create event dispatcher for threadpool");
 
+  IOTC_CHECK_STATE(
+      state = iotc_threadpool_create_queues(threadpool, num_of_threads));
+
   threadpool->workerthreads = iotc_vector_create();
 
   IOTC_CHECK_CND_DBGMESSAGE(threadpool->workerthreads == NULL,
@@ -46,7 +249,8 @@ iotc_threadpool_t* iotc_threadpool_create_instance(uint8_t num_of_threads) {
   uint8_t counter_workerthread = 0;
   for (; counter_workerthread < num_of_threads; ++counter_workerthread) {
     iotc_workerthread_t* new_workerthread =
-        iotc_workerthread_create_instance(threadpool->threadpool_evtd);
+        iotc_workerthread_create_pool_instance(threadpool,
+                                               counter_workerthread);
 
     IOTC_CHECK_CND_DBGMESSAGE(new_workerthread == NULL, IOTC_OUT_OF_MEMORY,
                               state, "could not allocate a workerthread");
@@ -56,6 +260,11 @@ iotc_threadpool_t* iotc_threadpool_create_instance(uint8_t num_of_threads) {
         IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_PTR(new_workerthread)));
   }
 
+  threadpool->wakeup.fn = &iotc_threadpool_wakeup;
+  threadpool->wakeup.data = threadpool;
+
+  iotc_evtd_set_wakeup(threadpool->threadpool_evtd, &threadpool->wakeup);
+
   return threadpool;
 
 err_handling:
@@ -67,6 +276,10 @@ void iotc_threadpool_destroy_instance(iotc_threadpool_t** threadpool) {
 
   iotc_threadpool_t* threadpool_ptr = *threadpool;
 
+  if (threadpool_ptr->threadpool_evtd != NULL) {
+    iotc_evtd_set_wakeup(threadpool_ptr->threadpool_evtd, NULL);
+  }
+
   if (threadpool_ptr->workerthreads != NULL) {
     /* stop all workerthreads in advance their destroy to avoid summing up join
      * times at destruction with that all thread exits are done parallelly */
@@ -88,14 +301,22 @@ void iotc_threadpool_destroy_instance(iotc_threadpool_t** threadpool) {
               .selector_t.ptr_value);
     }
 
+    /* ensure all any-thread handlers are executed before destroy, a strand
+     * queues its task again as long as it has events */
+    if (threadpool_ptr->queues != NULL) {
+      while (0 != iotc_threadpool_run_one(threadpool_ptr, 0)) {
+      }
+    }
+
     if (threadpool_ptr->threadpool_evtd != NULL) {
-      /* ensure all any-thread handlers are executed before destroy */
-      iotc_evtd_step(threadpool_ptr->threadpool_evtd, time(0));
+      iotc_evtd_step(threadpool_ptr->threadpool_evtd,
+                     iotc_bsp_time_getmonotonictime_milliseconds());
     }
 
     iotc_vector_destroy(threadpool_ptr->workerthreads);
   }
 
+  iotc_threadpool_destroy_queues(threadpool_ptr);
   iotc_evtd_destroy_instance(threadpool_ptr->threadpool_evtd);
 
   IOTC_SAFE_FREE(*threadpool);
@@ -103,9 +324,19 @@ void iotc_threadpool_destroy_instance(iotc_threadpool_t** threadpool) {
 
 iotc_event_handle_queue_t* iotc_threadpool_execute(
     iotc_threadpool_t* threadpool, iotc_event_handle_t handle) {
-  if (threadpool == NULL || threadpool->threadpool_evtd == NULL) return NULL;
+  if (threadpool == NULL || threadpool->queues == NULL) return NULL;
 
-  return iotc_evtd_execute(threadpool->threadpool_evtd, handle);
+  iotc_state_t state = IOTC_STATE_OK;
+  IOTC_ALLOC_SYSTEM_POOLED(IOTC_MEM_POOL_EVENT_HANDLE,
+                           iotc_event_handle_queue_t, elem, state);
+
+  elem->handle = handle;
+  iotc_threadpool_push(threadpool, elem);
+
+  return elem;
+
+err_handling:
+  return NULL;
 }
 
 iotc_event_handle_queue_t* iotc_threadpool_execute_on_thread(
@@ -129,3 +360,72 @@ iotc_event_handle_queue_t* iotc_threadpool_execute_on_thread(
   /* invalid tid, fallback: execute handler on any thread */
   return iotc_threadpool_execute(threadpool, handle);
 }
+
+iotc_event_handle_queue_t* iotc_threadpool_execute_ordered(
+    iotc_threadpool_t* threadpool, iotc_event_handle_t handle,
+    const void* key) {
+  if (threadpool == NULL || threadpool->strands == NULL) return NULL;
+
+  iotc_state_t state = IOTC_STATE_OK;
+  IOTC_ALLOC_SYSTEM_POOLED(IOTC_MEM_POOL_EVENT_HANDLE,
+                           iotc_event_handle_queue_t, elem, state);
+
+  elem->handle = handle;
+
+  iotc_threadpool_strand_t* strand =
+      &threadpool->strands[iotc_threadpool_strand_index(key)];
+
+  iotc_lock_critical_section(strand->cs);
+  IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_event_handle_queue_t, strand->events,
+                                strand->events_tail, elem);
+  const uint8_t schedule = (0 == strand->scheduled) ? 1 : 0;
+  strand->scheduled = 1;
+  iotc_unlock_critical_section(strand->cs);
+
+  if (0 != schedule) {
+    iotc_threadpool_push(threadpool, &strand->task);
+  }
+
+  return elem;
+
+err_handling:
+  return NULL;
+}
+
+uint8_t iotc_threadpool_run_one(iotc_threadpool_t* threadpool, uint8_t tid) {
+  assert(NULL != threadpool);
+  assert(tid < threadpool->num_of_threads);
+
+  iotc_event_handle_queue_t* elem =
+      iotc_threadpool_pop(&threadpool->queues[tid]);
+
+  if (NULL == elem &&
+      0 != iotc_evtd_single_step(
+               threadpool->threadpool_evtd,
+               iotc_bsp_time_getmonotonictime_milliseconds())) {
+    return 1;
+  }
+
+  uint8_t victim = 1;
+  for (; NULL == elem && victim < threadpool->num_of_threads; ++victim) {
+    elem = iotc_threadpool_pop(
+        &threadpool->queues[(tid + victim) % threadpool->num_of_threads]);
+  }
+
+  if (NULL == elem) {
+    return 0;
+  }
+
+  /* a strand task may be queued again while it runs, it belongs to the
+   * strand so it is released neither way */
+  const uint8_t is_strand_task =
+      iotc_threadpool_is_strand_task(threadpool, elem);
+
+  iotc_evtd_execute_handle(&elem->handle);
+
+  if (0 == is_strand_task) {
+    IOTC_SAFE_FREE(elem);
+  }
+
+  return 1;
+}
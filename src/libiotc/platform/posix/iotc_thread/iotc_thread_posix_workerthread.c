@@ -13,14 +13,83 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <assert.h>
 #include <errno.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <iotc_bsp_time.h>
 #include <iotc_thread_posix_workerthread.h>
+#include "iotc_thread_threadpool.h"
 
-#define IOTC_THREAD_WORKERTHREAD_RESTTIME_IN_NANOSECONDS 10000000;  // 1/100 sec
-#define IOTC_THREAD_WORKERTHREAD_WAITFORSYNCTIME_IN_NANOSECONDS \
-  100000000;  // 1/10 sec
+#define IOTC_THREAD_WORKERTHREAD_WAITFORSYNCTIME_IN_SECONDS 5
+
+/* the wakeup condition runs on the monotonic clock so that setting the wall
+ * clock neither cuts a sleep short nor stretches it; osx can't pick the clock
+ * of a condition variable */
+#ifdef IOTC_PLATFORM_IS_OSX
+#define IOTC_THREAD_WORKERTHREAD_COND_CLOCK CLOCK_REALTIME
+#else
+#define IOTC_THREAD_WORKERTHREAD_COND_CLOCK CLOCK_MONOTONIC
+#endif
+
+/* pthread_cond_timedwait takes an absolute time of the condition's clock */
+static void iotc_workerthread_deadline(struct timespec* deadline,
+                                       iotc_time_t timeout_ms) {
+  clock_gettime(IOTC_THREAD_WORKERTHREAD_COND_CLOCK, deadline);
+
+  deadline->tv_sec += timeout_ms / 1000;
+  deadline->tv_nsec += (timeout_ms % 1000) * 1000000;
+
+  if (deadline->tv_nsec >= 1000000000) {
+    deadline->tv_sec += 1;
+    deadline->tv_nsec -= 1000000000;
+  }
+}
+
+static void iotc_workerthread_evtd_wakeup(void* data) {
+  iotc_workerthread_wakeup((iotc_workerthread_t*)data);
+}
+
+/* Sleeps until a wakeup or the earliest time event of the primary evtd,
+ * returns at once if a wakeup came in since the last sleep. */
+static void iotc_workerthread_sleep(iotc_workerthread_t* workerthread) {
+  iotc_time_t time_of_earliest_event = 0;
+  const uint8_t has_time_event =
+      IOTC_STATE_OK ==
+      iotc_evtd_get_time_of_earliest_event(workerthread->thread_evtd,
+                                           &time_of_earliest_event);
+
+  pthread_mutex_lock(&workerthread->wakeup_mutex);
+
+  if (has_time_event) {
+    const iotc_time_t now = iotc_bsp_time_getmonotonictime_milliseconds();
+
+    if (0 == workerthread->wakeup_pending && time_of_earliest_event > now) {
+      struct timespec deadline;
+      iotc_workerthread_deadline(&deadline, time_of_earliest_event - now);
+
+      int ret = 0;
+      while (0 == workerthread->wakeup_pending && ETIMEDOUT != ret) {
+        ret = pthread_cond_timedwait(&workerthread->wakeup_cond,
+                                     &workerthread->wakeup_mutex, &deadline);
+      }
+
+      ++workerthread->wakeups;
+    }
+  } else if (0 == workerthread->wakeup_pending) {
+    while (0 == workerthread->wakeup_pending) {
+      pthread_cond_wait(&workerthread->wakeup_cond,
+                        &workerthread->wakeup_mutex);
+    }
+
+    ++workerthread->wakeups;
+  }
+
+  workerthread->wakeup_pending = 0;
+
+  pthread_mutex_unlock(&workerthread->wakeup_mutex);
+}
 
 void* iotc_workerthread_start_routine(void* ctx) {
   iotc_state_t state = IOTC_STATE_OK;
@@ -31,40 +100,52 @@ void* iotc_workerthread_start_routine(void* ctx) {
   iotc_workerthread_t* corresponding_workerthread = (iotc_workerthread_t*)ctx;
 
   iotc_debug_format("[%p] sync point reached", pthread_self());
+  pthread_mutex_lock(&corresponding_workerthread->wakeup_mutex);
   corresponding_workerthread->sync_start_flag = 1;
+  pthread_cond_broadcast(&corresponding_workerthread->wakeup_cond);
+  pthread_mutex_unlock(&corresponding_workerthread->wakeup_mutex);
   iotc_debug_format("[%p] sync point passed", pthread_self());
 
-  struct timespec deltatime;
-  deltatime.tv_sec = 0;
-  deltatime.tv_nsec = IOTC_THREAD_WORKERTHREAD_RESTTIME_IN_NANOSECONDS;
-
-  /* Simple event loop impl, just executes all handlers in event dispatcher
-   * in each 1/100 sec. */
+  /* Simple event loop impl, executes all handlers of the event dispatcher and
+   * sleeps until one of the dispatchers gets work. */
   while (
       iotc_evtd_dispatcher_continue(corresponding_workerthread->thread_evtd)) {
     /* Consume all handles of evtd. */
-    iotc_evtd_step(corresponding_workerthread->thread_evtd, time(0));
-    /* Consume a single handle of secondary evtd. */
-    if (iotc_evtd_dispatcher_continue(
-            corresponding_workerthread->thread_evtd_secondary)) {
-      iotc_evtd_single_step(corresponding_workerthread->thread_evtd_secondary,
-                            time(0));
+    iotc_evtd_step(corresponding_workerthread->thread_evtd,
+                   iotc_bsp_time_getmonotonictime_milliseconds());
+    /* Consume a single handle of secondary evtd, the secondary evtd may still
+     * have more so the thread doesn't sleep after one. */
+    uint8_t secondary_handled = 0;
+    if (NULL != corresponding_workerthread->threadpool) {
+      secondary_handled =
+          iotc_threadpool_run_one(corresponding_workerthread->threadpool,
+                                  corresponding_workerthread->threadpool_tid);
+    } else if (iotc_evtd_dispatcher_continue(
+                   corresponding_workerthread->thread_evtd_secondary)) {
+      secondary_handled = iotc_evtd_single_step(
+          corresponding_workerthread->thread_evtd_secondary,
+          iotc_bsp_time_getmonotonictime_milliseconds());
+    }
+
+    if (0 == secondary_handled) {
+      iotc_workerthread_sleep(corresponding_workerthread);
     }
-    /* Let the thread rest a little. */
-    nanosleep(&deltatime, NULL);
   }
 
   /* Ensuring execution of handlers added right before turning of event
    * dispatcher. */
-  iotc_evtd_step(corresponding_workerthread->thread_evtd, time(0));
+  iotc_evtd_step(corresponding_workerthread->thread_evtd,
+                 iotc_bsp_time_getmonotonictime_milliseconds());
 
 err_handling:
   return NULL;
 }
 
-iotc_workerthread_t* iotc_workerthread_create_instance(
-    iotc_evtd_instance_t* evtd_secondary) {
+static iotc_workerthread_t* iotc_workerthread_create(
+    iotc_evtd_instance_t* evtd_secondary, iotc_threadpool_t* threadpool,
+    uint8_t threadpool_tid) {
   iotc_state_t state = IOTC_STATE_OK;
+  uint8_t sync_initialized = 0;
   IOTC_ALLOC(iotc_workerthread_t, new_workerthread_instance, state);
 
   new_workerthread_instance->thread_evtd = iotc_evtd_create_instance();
@@ -74,6 +155,51 @@ iotc_workerthread_t* iotc_workerthread_create_instance(
       "could not create event dispatcher for new iotc_workerthread instance");
 
   new_workerthread_instance->thread_evtd_secondary = evtd_secondary;
+  new_workerthread_instance->threadpool = threadpool;
+  new_workerthread_instance->threadpool_tid = threadpool_tid;
+
+  if (0 != pthread_mutex_init(&new_workerthread_instance->wakeup_mutex, NULL)) {
+    goto err_handling;
+  }
+
+  pthread_condattr_t wakeup_cond_attr;
+
+  if (0 != pthread_condattr_init(&wakeup_cond_attr)) {
+    pthread_mutex_destroy(&new_workerthread_instance->wakeup_mutex);
+    goto err_handling;
+  }
+
+#ifndef IOTC_PLATFORM_IS_OSX
+  if (0 != pthread_condattr_setclock(&wakeup_cond_attr,
+                                     IOTC_THREAD_WORKERTHREAD_COND_CLOCK)) {
+    pthread_condattr_destroy(&wakeup_cond_attr);
+    pthread_mutex_destroy(&new_workerthread_instance->wakeup_mutex);
+    goto err_handling;
+  }
+#endif
+
+  if (0 != pthread_cond_init(&new_workerthread_instance->wakeup_cond,
+                             &wakeup_cond_attr)) {
+    pthread_condattr_destroy(&wakeup_cond_attr);
+    pthread_mutex_destroy(&new_workerthread_instance->wakeup_mutex);
+    goto err_handling;
+  }
+
+  pthread_condattr_destroy(&wakeup_cond_attr);
+
+  sync_initialized = 1;
+
+  new_workerthread_instance->wakeup.fn = &iotc_workerthread_evtd_wakeup;
+  new_workerthread_instance->wakeup.data = new_workerthread_instance;
+
+  iotc_evtd_set_wakeup(new_workerthread_instance->thread_evtd,
+                       &new_workerthread_instance->wakeup);
+
+  /* a threadpool replaces this with its own wakeup spreading the secondary
+   * events over all of its workerthreads */
+  if (NULL != evtd_secondary && NULL == evtd_secondary->wakeup) {
+    iotc_evtd_set_wakeup(evtd_secondary, &new_workerthread_instance->wakeup);
+  }
 
   const int ret_pthread_create = pthread_create(
       &new_workerthread_instance->thread, NULL, iotc_workerthread_start_routine,
@@ -88,11 +214,37 @@ iotc_workerthread_t* iotc_workerthread_create_instance(
   return new_workerthread_instance;
 
 err_handling:
+  if (NULL != new_workerthread_instance) {
+    if (NULL != evtd_secondary &&
+        &new_workerthread_instance->wakeup == evtd_secondary->wakeup) {
+      iotc_evtd_set_wakeup(evtd_secondary, NULL);
+    }
+
+    if (0 != sync_initialized) {
+      pthread_cond_destroy(&new_workerthread_instance->wakeup_cond);
+      pthread_mutex_destroy(&new_workerthread_instance->wakeup_mutex);
+    }
+
+    iotc_evtd_destroy_instance(new_workerthread_instance->thread_evtd);
+  }
+
   IOTC_SAFE_FREE(new_workerthread_instance);
 
   return NULL;
 }
 
+iotc_workerthread_t* iotc_workerthread_create_instance(
+    iotc_evtd_instance_t* evtd_secondary) {
+  return iotc_workerthread_create(evtd_secondary, NULL, 0);
+}
+
+iotc_workerthread_t* iotc_workerthread_create_pool_instance(
+    iotc_threadpool_t* threadpool, uint8_t tid) {
+  assert(NULL != threadpool);
+
+  return iotc_workerthread_create(threadpool->threadpool_evtd, threadpool, tid);
+}
+
 void iotc_workerthread_destroy_instance(iotc_workerthread_t** workerthread) {
   if (workerthread == NULL || *workerthread == NULL) return;
 
@@ -103,33 +255,59 @@ void iotc_workerthread_destroy_instance(iotc_workerthread_t** workerthread) {
   const int ret_pthread_join = pthread_join((*workerthread)->thread, NULL);
   IOTC_UNUSED(ret_pthread_join);
 
+  if (NULL != (*workerthread)->thread_evtd_secondary &&
+      &(*workerthread)->wakeup ==
+          (*workerthread)->thread_evtd_secondary->wakeup) {
+    iotc_evtd_set_wakeup((*workerthread)->thread_evtd_secondary, NULL);
+  }
+
   if ((*workerthread)->thread_evtd != NULL) {
     iotc_evtd_destroy_instance((*workerthread)->thread_evtd);
   }
 
+  pthread_cond_destroy(&(*workerthread)->wakeup_cond);
+  pthread_mutex_destroy(&(*workerthread)->wakeup_mutex);
+
   IOTC_SAFE_FREE(*workerthread);
 }
 
+void iotc_workerthread_wakeup(iotc_workerthread_t* workerthread) {
+  assert(NULL != workerthread);
+
+  pthread_mutex_lock(&workerthread->wakeup_mutex);
+
+  workerthread->wakeup_pending = 1;
+  /* a broadcast, since iotc_workerthread_wait_sync_point() may wait on the
+   * same condition */
+  pthread_cond_broadcast(&workerthread->wakeup_cond);
+
+  pthread_mutex_unlock(&workerthread->wakeup_mutex);
+}
+
 uint8_t iotc_workerthread_wait_sync_point(iotc_workerthread_t* workerthread) {
   iotc_debug_format("[%p] waiting for sync start of thread [%p]...",
                     pthread_self(), workerthread->thread);
 
-  struct timespec deltatime;
-  deltatime.tv_sec = 0;
-  deltatime.tv_nsec = IOTC_THREAD_WORKERTHREAD_WAITFORSYNCTIME_IN_NANOSECONDS;
-
-  /* Note: pthread_mutex_timedlock_np is not available on osx.
-   * Note: pthread_barrier_t is optional for POSIX pthreads, not available on
+  /* Note: pthread_barrier_t is optional for POSIX pthreads, not available on
    * osx. */
-  size_t i = 0;
-  for (; i < 50; ++i) {
-    if (workerthread->sync_start_flag != 0) break;
-    nanosleep(&deltatime, NULL);
+  struct timespec deadline;
+  iotc_workerthread_deadline(
+      &deadline, IOTC_THREAD_WORKERTHREAD_WAITFORSYNCTIME_IN_SECONDS * 1000);
+
+  pthread_mutex_lock(&workerthread->wakeup_mutex);
+
+  int ret = 0;
+  while (workerthread->sync_start_flag == 0 && ETIMEDOUT != ret) {
+    ret = pthread_cond_timedwait(&workerthread->wakeup_cond,
+                                 &workerthread->wakeup_mutex, &deadline);
   }
 
+  const uint8_t sync_start_flag = workerthread->sync_start_flag;
+
+  pthread_mutex_unlock(&workerthread->wakeup_mutex);
+
   iotc_debug_format("[%p] sync start %s for thread [%p]", pthread_self(),
-                    workerthread->sync_start_flag ? "OK" : "FAILED",
-                    workerthread->thread);
+                    sync_start_flag ? "OK" : "FAILED", workerthread->thread);
 
-  return (workerthread->sync_start_flag != 0) ? 1 : 0;
+  return (sync_start_flag != 0) ? 1 : 0;
 }
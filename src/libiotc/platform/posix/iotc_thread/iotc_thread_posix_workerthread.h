@@ -23,9 +23,23 @@
 typedef struct iotc_workerthread_s {
   iotc_evtd_instance_t* thread_evtd;
   iotc_evtd_instance_t* thread_evtd_secondary;
+  /* the threadpool the workerthread runs the events of instead of the
+   * secondary evtd, tid is its index in the pool */
+  struct iotc_threadpool_s* threadpool;
+  uint8_t threadpool_tid;
 
   pthread_t thread;
   uint8_t sync_start_flag;
+
+  /* the thread sleeps on wakeup_cond until an event dispatcher it serves
+   * gets work, wakeup_pending keeps a wakeup that came in while it was busy */
+  pthread_mutex_t wakeup_mutex;
+  pthread_cond_t wakeup_cond;
+  /* registered on thread_evtd, calls iotc_workerthread_wakeup() */
+  iotc_evtd_wakeup_t wakeup;
+  uint8_t wakeup_pending;
+  /* the number of times the thread woke up, kept for benchmarks */
+  uint32_t wakeups;
 } iotc_workerthread_t;
 
 #endif /* __IOTC_THREAD_POSIX_WORKERTHREAD_H__ */
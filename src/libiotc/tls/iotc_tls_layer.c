@@ -22,10 +22,22 @@
 #include <iotc_macros.h>
 #include <iotc_tls_layer.h>
 #include <iotc_tls_layer_state.h>
+#include "iotc_atomic.h"
 #include "iotc_fs_filenames.h"
+#include "iotc_globals.h"
+#include "iotc_helpers.h"
 #include "iotc_layer_api.h"
 #include "iotc_resource_manager.h"
 
+/* the CA certificates the first connection read, released by
+ * iotc_tls_layer_shutdown() */
+static iotc_data_desc_t* iotc_tls_layer_ca_cert_pem = NULL;
+
+static iotc_data_desc_t* iotc_tls_layer_get_ca_cert_pem(void) {
+  return (iotc_data_desc_t*)iotc_atomic_load_ptr(
+      (void* const*)&iotc_tls_layer_ca_cert_pem);
+}
+
 /* Forward declarations. */
 static iotc_state_t send_handler(void* context, void* data, iotc_state_t state);
 static iotc_state_t recv_handler(void* context, void* data, iotc_state_t state);
@@ -137,6 +149,73 @@ err_handling:
   return IOTC_BSP_TLS_STATE_WRITE_ERROR;
 }
 
+static void iotc_tls_layer_free_session(void** session_ptr) {
+  assert(NULL != session_ptr);
+
+  iotc_tls_layer_session_t* session = (iotc_tls_layer_session_t*)*session_ptr;
+
+  if (NULL == session) {
+    return;
+  }
+
+  iotc_bsp_tls_free_session(&session->bsp_session);
+  IOTC_SAFE_FREE(session->host);
+  IOTC_SAFE_FREE(session);
+
+  *session_ptr = NULL;
+}
+
+/* Offers the session of the previous connection if it went to the same
+ * endpoint, a session the BSP does not take is dropped. */
+static void iotc_tls_layer_restore_session(
+    iotc_context_data_t* context_data, iotc_bsp_tls_context_t* tls_context,
+    const iotc_connection_data_t* connection_data) {
+  iotc_tls_layer_session_t* session =
+      (iotc_tls_layer_session_t*)context_data->copy_of_tls_session;
+
+  if (NULL == session) {
+    return;
+  }
+
+  if (session->port != connection_data->port ||
+      0 != strcmp(session->host, connection_data->host) ||
+      IOTC_BSP_TLS_STATE_OK !=
+          iotc_bsp_tls_restore_session(tls_context, session->bsp_session)) {
+    iotc_debug_logger("dropping the stored TLS session");
+    iotc_tls_layer_free_session(&context_data->copy_of_tls_session);
+  }
+}
+
+/* Replaces the stored session with the one the handshake just negotiated. */
+static void iotc_tls_layer_save_session(
+    iotc_context_data_t* context_data, iotc_bsp_tls_context_t* tls_context,
+    const iotc_connection_data_t* connection_data) {
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_tls_layer_session_t* session = NULL;
+
+  iotc_tls_layer_free_session(&context_data->copy_of_tls_session);
+
+  IOTC_ALLOC_AT(iotc_tls_layer_session_t, session, state);
+
+  if (IOTC_BSP_TLS_STATE_OK !=
+          iotc_bsp_tls_save_session(tls_context, &session->bsp_session) ||
+      NULL == session->bsp_session) {
+    goto err_handling;
+  }
+
+  session->host = iotc_str_dup(connection_data->host);
+  IOTC_CHECK_MEMORY(session->host, state);
+  session->port = connection_data->port;
+
+  context_data->copy_of_tls_session = session;
+  context_data->copy_of_tls_session_dtor_ptr = &iotc_tls_layer_free_session;
+
+  return;
+
+err_handling:
+  iotc_tls_layer_free_session((void**)&session);
+}
+
 static iotc_state_t connect_handler(void* context, void* data,
                                     iotc_state_t in_out_state) {
   IOTC_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -155,6 +234,9 @@ static iotc_state_t connect_handler(void* context, void* data,
   /* begin coroutine scope */
   IOTC_CR_START(layer_data->tls_layer_conn_cs);
 
+  layer_data->handshake_start_ms =
+      iotc_bsp_time_getmonotonictime_milliseconds();
+
   do {
     bsp_tls_state = iotc_bsp_tls_connect(layer_data->tls_context);
 
@@ -173,6 +255,19 @@ static iotc_state_t connect_handler(void* context, void* data,
     }
   } while (bsp_tls_state != IOTC_BSP_TLS_STATE_OK);
 
+  iotc_atomic_add_u32(&iotc_globals.io_stats.tls_handshakes, 1);
+  iotc_atomic_add_u64(&iotc_globals.io_stats.tls_handshake_time_ms,
+                      iotc_bsp_time_getmonotonictime_milliseconds() -
+                          layer_data->handshake_start_ms);
+
+  if (iotc_bsp_tls_session_resumed(layer_data->tls_context)) {
+    iotc_atomic_add_u32(&iotc_globals.io_stats.tls_resumed_handshakes, 1);
+  }
+
+  iotc_tls_layer_save_session(IOTC_CONTEXT_DATA(context),
+                              layer_data->tls_context,
+                              IOTC_CONTEXT_DATA(context)->connection_data);
+
   /* connection done we can restore the logic handlers */
   layer_data->tls_layer_logic_recv_handler = &recv_handler;
   layer_data->tls_layer_logic_send_handler = &send_handler;
@@ -191,10 +286,91 @@ static iotc_state_t connect_handler(void* context, void* data,
   IOTC_CR_END();
 
 err_handling:
+  /* a session the server refused to resume must not be offered again */
+  iotc_tls_layer_free_session(&IOTC_CONTEXT_DATA(context)->copy_of_tls_session);
+
   IOTC_CR_RESET(layer_data->tls_layer_conn_cs);
   return IOTC_PROCESS_CLOSE_ON_THIS_LAYER(context, NULL, in_out_state);
 }
 
+/* Returns the first part of a descriptor chain that still has data to write,
+ * NULL when the whole chain has been written. */
+static iotc_data_desc_t* iotc_tls_layer_first_unwritten(
+    iotc_data_desc_t* desc) {
+  while (NULL != desc && desc->curr_pos >= desc->capacity) {
+    desc = desc->__next;
+  }
+
+  return desc;
+}
+
+static size_t iotc_tls_layer_unwritten_size(const iotc_data_desc_t* desc) {
+  return desc->capacity - desc->curr_pos;
+}
+
+/* Copies each run of small parts of a descriptor chain into one buffer, so
+ * that an MQTT header with a short payload, or a coalesced batch, leaves as
+ * one TLS record. Larger parts, such as a big payload, stay in the chain and
+ * are handed to the TLS library where they are. Takes over the chain, NULL
+ * if a buffer can't be allocated. */
+static iotc_data_desc_t* iotc_tls_layer_gather(iotc_data_desc_t* chain) {
+  iotc_data_desc_t* gathered = NULL;
+  iotc_data_desc_t* gathered_tail = NULL;
+
+  while (NULL != chain) {
+    size_t run_size = 0;
+    size_t run_length = 0;
+    const iotc_data_desc_t* run_end = chain;
+
+    while (NULL != run_end) {
+      const size_t part_size = iotc_tls_layer_unwritten_size(run_end);
+
+      if (IOTC_TLS_GATHER_MAX_BYTES < part_size ||
+          IOTC_IO_BUFFER_SIZE_MAX < run_size + part_size) {
+        break;
+      }
+
+      run_size += part_size;
+      ++run_length;
+      run_end = run_end->__next;
+    }
+
+    iotc_data_desc_t* part = chain;
+
+    /* a large part or a lone small one goes out as it is */
+    if (run_length < 2) {
+      chain = chain->__next;
+      IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_data_desc_t, gathered, gathered_tail,
+                                    part);
+      continue;
+    }
+
+    iotc_data_desc_t* run = iotc_make_empty_desc_alloc(run_size);
+
+    if (NULL == run) {
+      iotc_free_desc_chain(&chain);
+      iotc_free_desc_chain(&gathered);
+      return NULL;
+    }
+
+    while (chain != run_end) {
+      part = chain;
+      chain = chain->__next;
+
+      iotc_data_desc_append_bytes(run, part->data_ptr + part->curr_pos,
+                                  iotc_tls_layer_unwritten_size(part));
+
+      part->__next = NULL;
+      iotc_free_desc(&part);
+    }
+
+    IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_data_desc_t, gathered, gathered_tail,
+                                  run);
+  }
+
+  return gathered;
+}
+
 static iotc_state_t send_handler(void* context, void* data,
                                  iotc_state_t in_out_state) {
   IOTC_UNUSED(data);
@@ -216,26 +392,32 @@ static iotc_state_t send_handler(void* context, void* data,
   /* cook temporary data before entering the coroutine scope */
   iotc_bsp_tls_state_t ret = IOTC_BSP_TLS_STATE_WRITE_ERROR;
   int bytes_written = 0;
-  const size_t offset = layer_data->to_write_buffer->curr_pos;
-  const size_t size_left = layer_data->to_write_buffer->capacity -
-                           layer_data->to_write_buffer->curr_pos;
+  iotc_data_desc_t* to_write = NULL;
 
   /* coroutine scope begins */
   IOTC_CR_START(layer_data->tls_layer_send_cs);
 
-  /* this loop can be break only by success, error state is being checked inside
-   */
-  do {
+  /* the push has gathered the small parts of the chain, the loop writes
+   * part after part until the TLS library took all of them; the loop can be
+   * left only by success, error state is being checked inside */
+  while (NULL != (to_write = iotc_tls_layer_first_unwritten(
+                      layer_data->to_write_buffer))) {
     /* passes data and a size to bsp tls write function */
     ret = iotc_bsp_tls_write(layer_data->tls_context,
-                             layer_data->to_write_buffer->data_ptr + offset,
-                             size_left, &bytes_written);
+                             to_write->data_ptr + to_write->curr_pos,
+                             to_write->capacity - to_write->curr_pos,
+                             &bytes_written);
+
+    /* a WANT_WRITE retry is the same record, only a completed one counts */
+    if (IOTC_BSP_TLS_STATE_OK == ret) {
+      iotc_atomic_add_u32(&iotc_globals.io_stats.tls_records, 1);
+    }
 
     if (bytes_written > 0) {
-      layer_data->to_write_buffer->curr_pos += bytes_written;
+      to_write->curr_pos += bytes_written;
     }
 
-    /* while bsp tls is unable to read let's exit the coroutine */
+    /* while bsp tls is unable to write let's exit the coroutine */
     IOTC_CR_YIELD_UNTIL(layer_data->tls_layer_send_cs,
                         ret == IOTC_BSP_TLS_STATE_WANT_WRITE,
                         IOTC_STATE_WANT_WRITE);
@@ -244,11 +426,10 @@ static iotc_state_t send_handler(void* context, void* data,
     if (IOTC_BSP_TLS_STATE_OK != ret) {
       goto err_handling;
     }
-
-  } while (ret != IOTC_BSP_TLS_STATE_OK);
+  }
 
   /* free the memory */
-  iotc_free_desc(&layer_data->to_write_buffer);
+  iotc_free_desc_chain(&layer_data->to_write_buffer);
 
   /* exit the coroutine scope */
   IOTC_CR_EXIT(
@@ -261,11 +442,86 @@ err_handling:
   /* coroutine reset */
   IOTC_CR_RESET(layer_data->tls_layer_send_cs);
   /* free the memory */
-  iotc_free_desc(&layer_data->to_write_buffer);
+  iotc_free_desc_chain(&layer_data->to_write_buffer);
   return IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, NULL,
                                          IOTC_STATE_FAILED_WRITING);
 }
 
+static void iotc_tls_layer_recv_buffer_returned(const uint8_t* buffer,
+                                                size_t len, void* user_data) {
+  IOTC_UNUSED(buffer);
+  IOTC_UNUSED(len);
+
+  iotc_tls_layer_recv_buffer_t* recv_buffer =
+      (iotc_tls_layer_recv_buffer_t*)user_data;
+
+  recv_buffer->lent = 0;
+
+  if (recv_buffer->orphaned) {
+    IOTC_SAFE_FREE(recv_buffer);
+  }
+}
+
+static void iotc_tls_layer_free_recv_buffer(
+    iotc_tls_layer_state_t* layer_data) {
+  iotc_tls_layer_recv_buffer_t* recv_buffer = layer_data->recv_buffer;
+  layer_data->recv_buffer = NULL;
+
+  if (NULL == recv_buffer) {
+    return;
+  }
+
+  if (recv_buffer->lent) {
+    recv_buffer->orphaned = 1;
+  } else {
+    IOTC_SAFE_FREE(recv_buffer);
+  }
+}
+
+/* Lends the receive buffer of the connection as an empty descriptor. The next
+ * layer parses a read before it returns, so the buffer is normally back by the
+ * next read; a new buffer is only made while it isn't. The buffer follows
+ * iotc_set_receive_buffer_size() the same way the plain net layer does. */
+static iotc_data_desc_t* iotc_tls_layer_lend_recv_buffer(
+    iotc_tls_layer_state_t* layer_data) {
+  iotc_state_t state = IOTC_STATE_OK;
+  const size_t buffer_size =
+      iotc_atomic_load_size(&iotc_globals.receive_buffer_size);
+  iotc_tls_layer_recv_buffer_t* recv_buffer = layer_data->recv_buffer;
+
+  if (NULL != recv_buffer && recv_buffer->capacity != buffer_size &&
+      !recv_buffer->lent) {
+    iotc_tls_layer_free_recv_buffer(layer_data);
+    recv_buffer = NULL;
+  }
+
+  if (NULL == recv_buffer) {
+    IOTC_ALLOC_BUFFER_AT(iotc_tls_layer_recv_buffer_t, recv_buffer,
+                         sizeof(iotc_tls_layer_recv_buffer_t) + buffer_size,
+                         state);
+
+    recv_buffer->capacity = buffer_size;
+    layer_data->recv_buffer = recv_buffer;
+  }
+
+  if (recv_buffer->lent) {
+    return iotc_make_empty_desc_alloc(buffer_size);
+  }
+
+  iotc_data_desc_t* desc = iotc_make_desc_from_buffer_borrow(
+      recv_buffer->data, recv_buffer->capacity,
+      &iotc_tls_layer_recv_buffer_returned, recv_buffer);
+  IOTC_CHECK_MEMORY(desc, state);
+
+  desc->length = 0;
+  recv_buffer->lent = 1;
+
+  return desc;
+
+err_handling:
+  return NULL;
+}
+
 static iotc_state_t recv_handler(void* context, void* data,
                                  iotc_state_t in_out_state) {
   IOTC_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -285,10 +541,9 @@ static iotc_state_t recv_handler(void* context, void* data,
     return IOTC_STATE_OK;
   }
 
-  /* if recv buffer is empty than create one */
+  /* if recv buffer is empty than lend the one of the connection */
   if (NULL == layer_data->decoded_buffer) {
-    layer_data->decoded_buffer =
-        iotc_make_empty_desc_alloc(IOTC_IO_BUFFER_SIZE);
+    layer_data->decoded_buffer = iotc_tls_layer_lend_recv_buffer(layer_data);
     IOTC_CHECK_MEMORY(layer_data->decoded_buffer, in_out_state);
   }
 
@@ -367,7 +622,7 @@ iotc_state_t iotc_tls_layer_push(void* context, void* data,
     iotc_debug_logger("IOTC_THIS_LAYER_NOT_OPERATIONAL");
 
     /* cleaning of not finished requests */
-    iotc_free_desc(&buffer);
+    iotc_free_desc_chain(&buffer);
 
     return IOTC_STATE_OK;
   }
@@ -395,6 +650,18 @@ iotc_state_t iotc_tls_layer_push(void* context, void* data,
     assert(0 == IOTC_CR_IS_RUNNING(layer_data->tls_layer_send_cs));
     assert(0 == IOTC_CR_IS_RUNNING(layer_data->tls_lib_handler_sending_cs));
 
+    /* a chain, such as an MQTT header and its payload or a coalesced batch,
+     * would leave as a TLS record per part, its small parts are gathered but
+     * a large payload isn't copied */
+    if (NULL != buffer->__next) {
+      buffer = iotc_tls_layer_gather(buffer);
+
+      if (NULL == buffer) {
+        return IOTC_PROCESS_PUSH_ON_NEXT_LAYER(context, NULL,
+                                               IOTC_STATE_FAILED_WRITING);
+      }
+    }
+
     layer_data->to_write_buffer = buffer;
 
     /* sanity check */
@@ -461,73 +728,124 @@ iotc_state_t iotc_tls_layer_init(void* context, void* data,
   /* let's use the connection coroutine state */
   IOTC_CR_START(layer_data->tls_layer_conn_cs);
 
-  /* make the resource manager context */
-  in_out_state =
-      iotc_resource_manager_make_context(NULL, &layer_data->rm_context);
+  /* the CA certificates are read from the filesystem once, reconnects reuse
+   * them */
+  if (NULL == iotc_tls_layer_get_ca_cert_pem()) {
+    /* make the resource manager context */
+    in_out_state =
+        iotc_resource_manager_make_context(NULL, &layer_data->rm_context);
+
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format(
+          "failed to create a resource manager context, reason: %d",
+          in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
 
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format("failed to create a resource manager context, reason: %d",
-                      in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+    /* the reads resume this coroutine on the thread of the connection */
+    layer_data->rm_context->evtd_instance =
+        IOTC_CONTEXT_DATA(context)->evtd_instance;
+
+    in_out_state = iotc_resource_manager_open(
+        layer_data->rm_context,
+        iotc_make_handle(&iotc_tls_layer_init, context, data, in_out_state),
+        IOTC_FS_CERTIFICATE, IOTC_GLOBAL_CERTIFICATE_FILE_NAME,
+        IOTC_FS_OPEN_READ, NULL);
+
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format(
+          "failed to start open on CA certificate using resource manager "
+          "context, reason: %d",
+          in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
 
-  in_out_state = iotc_resource_manager_open(
-      layer_data->rm_context,
-      iotc_make_handle(&iotc_tls_layer_init, context, data, in_out_state),
-      IOTC_FS_CERTIFICATE, IOTC_GLOBAL_CERTIFICATE_FILE_NAME, IOTC_FS_OPEN_READ,
-      NULL);
+    IOTC_CR_YIELD(layer_data->tls_layer_conn_cs, IOTC_STATE_OK);
 
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format(
-        "failed to start open on CA certificate using resource manager "
-        "context, reason: %d",
-        in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format(
+          "failed to open CA certificate from filesystem, reason: %d",
+          in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
 
-  IOTC_CR_YIELD(layer_data->tls_layer_conn_cs, IOTC_STATE_OK);
+    in_out_state = iotc_resource_manager_read(
+        layer_data->rm_context,
+        iotc_make_handle(&iotc_tls_layer_init, context, data, in_out_state),
+        NULL);
+
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format(
+          "failed to start read on CA certificate using resource manager, "
+          "reason: %d",
+          in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
 
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format(
-        "failed to open CA certificate from filesystem, reason: %d",
-        in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+    /* here the resource manager will start reading the resource content from
+     * a choosen filesystem */
+    IOTC_CR_YIELD(layer_data->tls_layer_conn_cs, IOTC_STATE_OK);
+    /* here the resource manager finished reading the resource content from a
+     * choosen filesystem */
+
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format(
+          "failed to read CA certificate from filesystem, reason: %d",
+          in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
 
-  in_out_state = iotc_resource_manager_read(
-      layer_data->rm_context,
-      iotc_make_handle(&iotc_tls_layer_init, context, data, in_out_state),
-      NULL);
+    /* POST/PRE-CONDITIONS */
+    assert(NULL != layer_data->rm_context->data_buffer->data_ptr);
+    assert(0 < layer_data->rm_context->data_buffer->length);
+
+    /* another connection may have read them in the meantime, possibly on
+     * another I/O thread, the first copy published wins */
+    if (NULL == iotc_tls_layer_get_ca_cert_pem()) {
+      iotc_data_desc_t* ca_cert_pem = iotc_make_desc_from_buffer_copy(
+          layer_data->rm_context->data_buffer->data_ptr,
+          layer_data->rm_context->data_buffer->length);
+      IOTC_CHECK_MEMORY(ca_cert_pem, in_out_state);
+
+      void* expected = NULL;
+      if (0 == iotc_atomic_compare_exchange_ptr(
+                   (void**)&iotc_tls_layer_ca_cert_pem, &expected,
+                   ca_cert_pem)) {
+        iotc_free_desc(&ca_cert_pem);
+      }
+    }
 
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format(
-        "failed to start read on CA certificate using resource manager, "
-        "reason: %d",
-        in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+    in_out_state = iotc_resource_manager_close(
+        layer_data->rm_context,
+        iotc_make_handle(&iotc_tls_layer_init, context, data, in_out_state),
+        NULL);
 
-  /* here the resource manager will start reading the resource content from a
-   * choosen filesystem */
-  IOTC_CR_YIELD(layer_data->tls_layer_conn_cs, IOTC_STATE_OK);
-  /* here the resource manager finished reading the resource content from a
-   * choosen filesystem */
+    /* here the resource manager will start the close action */
+    IOTC_CR_YIELD(layer_data->tls_layer_conn_cs, IOTC_STATE_OK);
+    /* here the resource manger finished closing this resource */
 
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format(
-        "failed to read CA certificate from filesystem, reason: %d",
-        in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format(
+          "failed to close the CA certificate resource, reason: %d",
+          in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
 
-  /* POST/PRE-CONDITIONS */
-  assert(NULL != layer_data->rm_context->data_buffer->data_ptr);
-  assert(0 < layer_data->rm_context->data_buffer->length);
+    in_out_state = iotc_resource_manager_free_context(&layer_data->rm_context);
+
+    if (IOTC_STATE_OK != in_out_state) {
+      iotc_debug_format("failed to free the context memory, reason: %d",
+                        in_out_state);
+      in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
+      goto err_handling;
+    }
+  }
 
   { /* initialisation block for bsp tls init function */
     iotc_bsp_tls_init_params_t init_params;
@@ -539,9 +857,9 @@ iotc_state_t iotc_tls_layer_init(void* context, void* data,
     init_params.fp_libiotc_free = iotc_free_ptr;
     init_params.fp_libiotc_realloc = iotc_realloc_ptr;
     init_params.domain_name = connection_data->host;
-    init_params.ca_cert_pem_buf = layer_data->rm_context->data_buffer->data_ptr;
-    init_params.ca_cert_pem_buf_length =
-        layer_data->rm_context->data_buffer->length;
+    const iotc_data_desc_t* ca_cert_pem = iotc_tls_layer_get_ca_cert_pem();
+    init_params.ca_cert_pem_buf = ca_cert_pem->data_ptr;
+    init_params.ca_cert_pem_buf_length = ca_cert_pem->length;
 
     /* bsp init function call */
     const iotc_bsp_tls_state_t bsp_tls_state =
@@ -557,32 +875,10 @@ iotc_state_t iotc_tls_layer_init(void* context, void* data,
     }
   }
 
-  iotc_debug_logger("BSP TLS initialization successfull");
-
-  in_out_state = iotc_resource_manager_close(
-      layer_data->rm_context,
-      iotc_make_handle(&iotc_tls_layer_init, context, data, in_out_state),
-      NULL);
-
-  /* here the resource manager will start the close action */
-  IOTC_CR_YIELD(layer_data->tls_layer_conn_cs, IOTC_STATE_OK);
-  /* here the resource manger finished closing this resource */
-
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format("failed to close the CA certificate resource, reason: %d",
-                      in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+  iotc_tls_layer_restore_session(IOTC_CONTEXT_DATA(context),
+                                 layer_data->tls_context, connection_data);
 
-  in_out_state = iotc_resource_manager_free_context(&layer_data->rm_context);
-
-  if (IOTC_STATE_OK != in_out_state) {
-    iotc_debug_format("failed to free the context memory, reason: %d",
-                      in_out_state);
-    in_out_state = IOTC_TLS_FAILED_LOADING_CERTIFICATE;
-    goto err_handling;
-  }
+  iotc_debug_logger("BSP TLS initialization successfull");
 
   /* setup the logic handlers for connection purposes */
   layer_data->tls_layer_logic_recv_handler = &connect_handler;
@@ -683,9 +979,11 @@ iotc_state_t iotc_tls_layer_close_externally(void* context, void* data,
       iotc_free_desc(&layer_data->decoded_buffer);
     }
 
+    iotc_tls_layer_free_recv_buffer(layer_data);
+
     if (layer_data->to_write_buffer) {
       iotc_debug_logger("cleaning to write buffer");
-      iotc_free_desc(&layer_data->to_write_buffer);
+      iotc_free_desc_chain(&layer_data->to_write_buffer);
     }
 
     /* user data removed */
@@ -701,3 +999,8 @@ iotc_state_t iotc_tls_layer_close_externally(void* context, void* data,
   return IOTC_PROCESS_CLOSE_EXTERNALLY_ON_NEXT_LAYER(context, data,
                                                      in_out_state);
 }
+
+void iotc_tls_layer_shutdown() {
+  iotc_free_desc(&iotc_tls_layer_ca_cert_pem);
+  iotc_bsp_tls_shutdown();
+}
@@ -38,6 +38,10 @@ iotc_state_t iotc_tls_layer_close(void* context, void* data,
 iotc_state_t iotc_tls_layer_close_externally(void* context, void* data,
                                              iotc_state_t state);
 
+/* releases the CA certificates and the TLS configuration that connections
+ * share, no connection may be left */
+void iotc_tls_layer_shutdown();
+
 #ifdef __cplusplus
 }
 #endif
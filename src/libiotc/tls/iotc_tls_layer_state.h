@@ -18,6 +18,7 @@
 #define __IOTC_TLS_LAYER_STATE_H__
 
 #include <iotc_bsp_tls.h>
+#include <iotc_bsp_time.h>
 #include <iotc_resource_manager.h>
 
 typedef enum iotc_tls_layer_data_write_state_e {
@@ -26,12 +27,31 @@ typedef enum iotc_tls_layer_data_write_state_e {
   IOTC_TLS_LAYER_DATA_WRITTEN,
 } iotc_tls_layer_data_write_state_t;
 
+/* the TLS session of a finished handshake, kept in the context data so that
+ * the next connection to the same endpoint can resume it */
+typedef struct iotc_tls_layer_session_s {
+  iotc_bsp_tls_session_t* bsp_session;
+  char* host;
+  uint16_t port;
+} iotc_tls_layer_session_t;
+
+/* the receive buffer of a connection, lent to the next layer for one read at a
+ * time; a buffer that is still lent when the connection closes is orphaned and
+ * freed once the next layer gives it back */
+typedef struct iotc_tls_layer_recv_buffer_s {
+  uint8_t lent;
+  uint8_t orphaned;
+  size_t capacity;
+  uint8_t data[];
+} iotc_tls_layer_recv_buffer_t;
+
 typedef struct iotc_tls_layer_state_s {
   iotc_bsp_tls_context_t* tls_context;
 
   iotc_data_desc_t* raw_buffer;
   iotc_data_desc_t* decoded_buffer;
   iotc_data_desc_t* to_write_buffer;
+  iotc_tls_layer_recv_buffer_t* recv_buffer;
 
   iotc_event_handle_func_argc3_ptr tls_layer_logic_recv_handler;
   iotc_event_handle_func_argc3_ptr tls_layer_logic_send_handler;
@@ -45,6 +65,9 @@ typedef struct iotc_tls_layer_state_s {
 
   iotc_tls_layer_data_write_state_t tls_layer_write_state;
 
+  /* when the handshake sent its first message */
+  iotc_time_t handshake_start_ms;
+
 } iotc_tls_layer_state_t;
 
 #endif /* __IOTC_TLS_LAYER_STATE_H__ */
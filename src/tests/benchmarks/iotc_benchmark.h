@@ -0,0 +1,60 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IOTC_BENCHMARK_H__
+#define __IOTC_BENCHMARK_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @file iotc_benchmark.h
+ * @brief Helpers shared by the benchmark programs.
+ *
+ * A benchmark measures the wall clock time of a loop of operations and reports
+ * the average cost of a single operation in nanoseconds.
+ */
+
+static inline uint64_t iotc_benchmark_now_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static inline void iotc_benchmark_report(const char* name, long size,
+                                         uint64_t elapsed_ns, long ops) {
+  printf("%-40s n=%-8ld %12.1f ns/op\n", name, size,
+         (ops > 0) ? (double)elapsed_ns / (double)ops : 0.0);
+}
+
+static inline void iotc_benchmark_report_value(const char* name, long size,
+                                               double value,
+                                               const char* unit) {
+  printf("%-40s n=%-8ld %12.1f %s\n", name, size, value, unit);
+}
+
+static inline void iotc_benchmark_skip(const char* name, long size,
+                                       const char* reason) {
+  printf("%-40s n=%-8ld      skipped (%s)\n", name, size, reason);
+}
+
+static inline void iotc_benchmark_fail(const char* name, long size,
+                                       const char* reason) {
+  printf("%-40s n=%-8ld       failed (%s)\n", name, size, reason);
+}
+
+#endif /* __IOTC_BENCHMARK_H__ */
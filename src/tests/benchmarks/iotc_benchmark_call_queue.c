@@ -0,0 +1,285 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "iotc_benchmark.h"
+
+#ifdef IOTC_MODULE_THREAD_ENABLED
+
+#include <pthread.h>
+
+#include "iotc.h"
+#include "iotc_critical_section.h"
+#include "iotc_event_dispatcher_api.h"
+#include "iotc_list.h"
+#include "iotc_macros.h"
+
+/* a number of producer threads feed events to one dispatcher which is
+ * stepped by the main thread, the time covers all the events from the first
+ * push to the last execution */
+
+#define IOTC_BENCHMARK_CALL_QUEUE_EVENTS_PER_PRODUCER 5000
+
+/* a heap cap of the memory limiter is sized for a device, the producers may
+ * queue all their events before the consumer gets to run */
+#define IOTC_BENCHMARK_CALL_QUEUE_MAX_HEAP_USAGE (64 * 1024 * 1024)
+
+static const long iotc_benchmark_call_queue_producers[] = {1, 2, 4, 8};
+
+/* the call queue as it was: every push and pop takes the critical section of
+ * the dispatcher, the list keeps its tail so that only the lock is measured
+ * and not the walk to the end of a long list */
+typedef struct iotc_benchmark_locked_list_s {
+  struct iotc_critical_section_s* cs;
+  iotc_event_handle_queue_t* call_queue;
+  iotc_event_handle_queue_t* call_queue_tail;
+} iotc_benchmark_locked_list_t;
+
+typedef struct iotc_benchmark_call_queue_ops_s {
+  const char* name;
+  void* (*create)(void);
+  void (*destroy)(void* queue);
+  int (*execute)(void* queue, iotc_event_handle_t handle);
+  uint8_t (*single_step)(void* queue);
+} iotc_benchmark_call_queue_ops_t;
+
+static void* iotc_benchmark_locked_list_create(void) {
+  iotc_benchmark_locked_list_t* list =
+      calloc(1, sizeof(iotc_benchmark_locked_list_t));
+
+  if (NULL != list && IOTC_STATE_OK != iotc_init_critical_section(&list->cs)) {
+    free(list);
+    return NULL;
+  }
+
+  return list;
+}
+
+static void iotc_benchmark_locked_list_destroy(void* queue) {
+  iotc_benchmark_locked_list_t* list = (iotc_benchmark_locked_list_t*)queue;
+
+  iotc_destroy_critical_section(&list->cs);
+  free(list);
+}
+
+static int iotc_benchmark_locked_list_execute(void* queue,
+                                              iotc_event_handle_t handle) {
+  iotc_benchmark_locked_list_t* list = (iotc_benchmark_locked_list_t*)queue;
+  iotc_state_t state = IOTC_STATE_OK;
+
+  IOTC_ALLOC_SYSTEM(iotc_event_handle_queue_t, queue_elem, state);
+
+  queue_elem->handle = handle;
+
+  iotc_lock_critical_section(list->cs);
+  IOTC_LIST_PUSH_BACK_WITH_TAIL(iotc_event_handle_queue_t, list->call_queue,
+                                list->call_queue_tail, queue_elem);
+  iotc_unlock_critical_section(list->cs);
+
+  return 0;
+
+err_handling:
+  return 1;
+}
+
+static uint8_t iotc_benchmark_locked_list_single_step(void* queue) {
+  iotc_benchmark_locked_list_t* list = (iotc_benchmark_locked_list_t*)queue;
+  iotc_event_handle_queue_t* queue_elem = NULL;
+
+  iotc_lock_critical_section(list->cs);
+  if (!IOTC_LIST_EMPTY(iotc_event_handle_queue_t, list->call_queue)) {
+    IOTC_LIST_POP_WITH_TAIL(iotc_event_handle_queue_t, list->call_queue,
+                            list->call_queue_tail, queue_elem);
+  }
+  iotc_unlock_critical_section(list->cs);
+
+  if (NULL == queue_elem) {
+    return 0;
+  }
+
+  iotc_evtd_execute_handle(&queue_elem->handle);
+  IOTC_SAFE_FREE(queue_elem);
+
+  return 1;
+}
+
+static void* iotc_benchmark_evtd_create(void) {
+  return iotc_evtd_create_instance();
+}
+
+static void iotc_benchmark_evtd_destroy(void* queue) {
+  iotc_evtd_destroy_instance((iotc_evtd_instance_t*)queue);
+}
+
+static int iotc_benchmark_evtd_execute(void* queue,
+                                       iotc_event_handle_t handle) {
+  return (NULL == iotc_evtd_execute((iotc_evtd_instance_t*)queue, handle)) ? 1
+                                                                           : 0;
+}
+
+static uint8_t iotc_benchmark_evtd_single_step(void* queue) {
+  return iotc_evtd_single_step((iotc_evtd_instance_t*)queue, 0);
+}
+
+static const iotc_benchmark_call_queue_ops_t iotc_benchmark_locked_list_ops = {
+    "locked list", &iotc_benchmark_locked_list_create,
+    &iotc_benchmark_locked_list_destroy, &iotc_benchmark_locked_list_execute,
+    &iotc_benchmark_locked_list_single_step};
+
+static const iotc_benchmark_call_queue_ops_t iotc_benchmark_mpsc_ops = {
+    "mpsc", &iotc_benchmark_evtd_create, &iotc_benchmark_evtd_destroy,
+    &iotc_benchmark_evtd_execute, &iotc_benchmark_evtd_single_step};
+
+typedef struct iotc_benchmark_call_queue_producer_s {
+  const iotc_benchmark_call_queue_ops_t* ops;
+  void* queue;
+  volatile uint8_t* start;
+  long* executed;
+  volatile long* finished;
+  int result;
+} iotc_benchmark_call_queue_producer_t;
+
+/* only ever runs on the consumer thread */
+static iotc_state_t iotc_benchmark_call_queue_handler(
+    iotc_event_handle_arg1_t arg1) {
+  ++*(long*)arg1;
+  return IOTC_STATE_OK;
+}
+
+static void* iotc_benchmark_call_queue_produce(void* arg) {
+  iotc_benchmark_call_queue_producer_t* producer =
+      (iotc_benchmark_call_queue_producer_t*)arg;
+
+  while (0 == *producer->start) {
+    __sync_synchronize();
+  }
+
+  long i = 0;
+  for (; i < IOTC_BENCHMARK_CALL_QUEUE_EVENTS_PER_PRODUCER; ++i) {
+    producer->result |= producer->ops->execute(
+        producer->queue, iotc_make_handle(&iotc_benchmark_call_queue_handler,
+                                          producer->executed));
+  }
+
+  __sync_fetch_and_add(producer->finished, 1);
+
+  return NULL;
+}
+
+static int iotc_benchmark_call_queue(const iotc_benchmark_call_queue_ops_t* ops,
+                                     long producers_count) {
+  iotc_benchmark_call_queue_producer_t producers[8];
+  pthread_t threads[8];
+  volatile uint8_t start = 0;
+  long executed = 0;
+  volatile long finished = 0;
+  long started = 0;
+  int result = 1;
+
+  const long events =
+      producers_count * IOTC_BENCHMARK_CALL_QUEUE_EVENTS_PER_PRODUCER;
+
+  void* queue = ops->create();
+
+  if (NULL == queue) {
+    return 1;
+  }
+
+  for (; started < producers_count; ++started) {
+    producers[started].ops = ops;
+    producers[started].queue = queue;
+    producers[started].start = &start;
+    producers[started].executed = &executed;
+    producers[started].finished = &finished;
+    producers[started].result = 0;
+
+    if (0 != pthread_create(&threads[started], NULL,
+                            &iotc_benchmark_call_queue_produce,
+                            &producers[started])) {
+      break;
+    }
+  }
+
+  const uint64_t start_ns = iotc_benchmark_now_ns();
+  __sync_synchronize();
+  start = 1;
+
+  if (started == producers_count) {
+    /* a queue found empty after every producer has finished stays empty, the
+     * events the queue refused, e.g. out of memory, are never coming */
+    while (executed < events) {
+      const long finished_before_step = __sync_fetch_and_add(&finished, 0);
+
+      if (0 == ops->single_step(queue) &&
+          producers_count == finished_before_step) {
+        break;
+      }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "call queue %s %ld producers", ops->name,
+             producers_count);
+
+    if (executed < events) {
+      iotc_benchmark_fail(name, events, "the queue refused events");
+    } else {
+      iotc_benchmark_report(name, events, iotc_benchmark_now_ns() - start_ns,
+                            events);
+      result = 0;
+    }
+  }
+
+  long i = 0;
+  for (; i < started; ++i) {
+    pthread_join(threads[i], NULL);
+    result |= producers[i].result;
+  }
+
+  while (ops->single_step(queue))
+    ;
+
+  ops->destroy(queue);
+
+  return result;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  /* not supported without the memory limiter, there's no cap then */
+  iotc_set_maximum_heap_usage(IOTC_BENCHMARK_CALL_QUEUE_MAX_HEAP_USAGE);
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_call_queue_producers); ++i) {
+    const long producers = iotc_benchmark_call_queue_producers[i];
+
+    result |= iotc_benchmark_call_queue(&iotc_benchmark_locked_list_ops,
+                                        producers);
+    result |= iotc_benchmark_call_queue(&iotc_benchmark_mpsc_ops, producers);
+  }
+
+  return result;
+}
+
+#else
+
+int main() {
+  iotc_benchmark_skip("call queue", 0, "built without threading");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,272 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iotc_benchmark.h"
+#include "iotc_bsp_io_fs.h"
+#include "iotc_fs_header.h"
+#include "iotc_macros.h"
+
+/* a file is written in chunks, looked up, read back and removed, once through
+ * the filesystem the library is built with and once through the POSIX BSP
+ * directly, the time of each step covers all the files */
+
+#define IOTC_BENCHMARK_FS_CHUNK_SIZE 256
+#define IOTC_BENCHMARK_FS_FILES 200
+#define IOTC_BENCHMARK_FS_FILE_NAME "iotc_benchmark_fs.file"
+
+#if defined(IOTC_FS_MEMORY)
+#define IOTC_BENCHMARK_FS_NAME "memory"
+#elif defined(IOTC_FS_POSIX)
+#define IOTC_BENCHMARK_FS_NAME "posix"
+#else
+#define IOTC_BENCHMARK_FS_NAME "fs"
+#endif
+
+static const long iotc_benchmark_fs_sizes[] = {256, 4096, 32768};
+
+typedef struct iotc_benchmark_fs_ops_s {
+  const char* name;
+  int (*open)(int write, intptr_t* handle);
+  int (*write)(intptr_t handle, const uint8_t* buffer, size_t size,
+               size_t offset);
+  int (*stat)(size_t* size);
+  int (*read)(intptr_t handle, size_t offset, const uint8_t** buffer,
+              size_t* size);
+  int (*close)(intptr_t handle);
+  int (*remove)(void);
+} iotc_benchmark_fs_ops_t;
+
+static int iotc_benchmark_iotc_fs_open(int write, intptr_t* handle) {
+  iotc_fs_resource_handle_t resource_handle = iotc_fs_init_resource_handle();
+
+  const iotc_state_t state = iotc_fs_open(
+      NULL, IOTC_FS_CONFIG_DATA, IOTC_BENCHMARK_FS_FILE_NAME,
+      write ? IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE : IOTC_FS_OPEN_READ,
+      &resource_handle);
+
+  *handle = (intptr_t)resource_handle;
+  return (IOTC_STATE_OK == state) ? 0 : 1;
+}
+
+static int iotc_benchmark_iotc_fs_write(intptr_t handle, const uint8_t* buffer,
+                                        size_t size, size_t offset) {
+  size_t bytes_written = 0;
+
+  return (IOTC_STATE_OK == iotc_fs_write(NULL,
+                                         (iotc_fs_resource_handle_t)handle,
+                                         buffer, size, offset,
+                                         &bytes_written) &&
+          size == bytes_written)
+             ? 0
+             : 1;
+}
+
+static int iotc_benchmark_iotc_fs_stat(size_t* size) {
+  iotc_fs_stat_t stat = {.resource_size = 0};
+
+  const iotc_state_t state = iotc_fs_stat(
+      NULL, IOTC_FS_CONFIG_DATA, IOTC_BENCHMARK_FS_FILE_NAME, &stat);
+
+  *size = stat.resource_size;
+  return (IOTC_STATE_OK == state) ? 0 : 1;
+}
+
+static int iotc_benchmark_iotc_fs_read(intptr_t handle, size_t offset,
+                                       const uint8_t** buffer, size_t* size) {
+  return (IOTC_STATE_OK == iotc_fs_read(NULL,
+                                        (iotc_fs_resource_handle_t)handle,
+                                        offset, buffer, size))
+             ? 0
+             : 1;
+}
+
+static int iotc_benchmark_iotc_fs_close(intptr_t handle) {
+  return (IOTC_STATE_OK ==
+          iotc_fs_close(NULL, (iotc_fs_resource_handle_t)handle))
+             ? 0
+             : 1;
+}
+
+static int iotc_benchmark_iotc_fs_remove(void) {
+  return (IOTC_STATE_OK == iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA,
+                                          IOTC_BENCHMARK_FS_FILE_NAME))
+             ? 0
+             : 1;
+}
+
+static int iotc_benchmark_bsp_fs_open(int write, intptr_t* handle) {
+  iotc_bsp_io_fs_resource_handle_t resource_handle = 0;
+
+  const iotc_bsp_io_fs_state_t state = iotc_bsp_io_fs_open(
+      IOTC_BENCHMARK_FS_FILE_NAME, 0,
+      write ? IOTC_BSP_IO_FS_OPEN_WRITE | IOTC_BSP_IO_FS_OPEN_CREATE
+            : IOTC_BSP_IO_FS_OPEN_READ,
+      &resource_handle);
+
+  *handle = resource_handle;
+  return (IOTC_BSP_IO_FS_STATE_OK == state) ? 0 : 1;
+}
+
+static int iotc_benchmark_bsp_fs_write(intptr_t handle, const uint8_t* buffer,
+                                       size_t size, size_t offset) {
+  size_t bytes_written = 0;
+
+  return (IOTC_BSP_IO_FS_STATE_OK == iotc_bsp_io_fs_write(handle, buffer,
+                                                          size, offset,
+                                                          &bytes_written) &&
+          size == bytes_written)
+             ? 0
+             : 1;
+}
+
+static int iotc_benchmark_bsp_fs_stat(size_t* size) {
+  iotc_bsp_io_fs_stat_t stat = {.resource_size = 0};
+
+  const iotc_bsp_io_fs_state_t state =
+      iotc_bsp_io_fs_stat(IOTC_BENCHMARK_FS_FILE_NAME, &stat);
+
+  *size = stat.resource_size;
+  return (IOTC_BSP_IO_FS_STATE_OK == state) ? 0 : 1;
+}
+
+static int iotc_benchmark_bsp_fs_read(intptr_t handle, size_t offset,
+                                      const uint8_t** buffer, size_t* size) {
+  return (IOTC_BSP_IO_FS_STATE_OK ==
+          iotc_bsp_io_fs_read(handle, offset, buffer, size))
+             ? 0
+             : 1;
+}
+
+static int iotc_benchmark_bsp_fs_close(intptr_t handle) {
+  return (IOTC_BSP_IO_FS_STATE_OK == iotc_bsp_io_fs_close(handle)) ? 0 : 1;
+}
+
+static int iotc_benchmark_bsp_fs_remove(void) {
+  return (IOTC_BSP_IO_FS_STATE_OK ==
+          iotc_bsp_io_fs_remove(IOTC_BENCHMARK_FS_FILE_NAME))
+             ? 0
+             : 1;
+}
+
+static const iotc_benchmark_fs_ops_t iotc_benchmark_iotc_fs_ops = {
+    IOTC_BENCHMARK_FS_NAME,         &iotc_benchmark_iotc_fs_open,
+    &iotc_benchmark_iotc_fs_write,  &iotc_benchmark_iotc_fs_stat,
+    &iotc_benchmark_iotc_fs_read,   &iotc_benchmark_iotc_fs_close,
+    &iotc_benchmark_iotc_fs_remove};
+
+static const iotc_benchmark_fs_ops_t iotc_benchmark_bsp_fs_ops = {
+    "posix bsp",                   &iotc_benchmark_bsp_fs_open,
+    &iotc_benchmark_bsp_fs_write,  &iotc_benchmark_bsp_fs_stat,
+    &iotc_benchmark_bsp_fs_read,   &iotc_benchmark_bsp_fs_close,
+    &iotc_benchmark_bsp_fs_remove};
+
+static void iotc_benchmark_fs_report(const iotc_benchmark_fs_ops_t* ops,
+                                     const char* step, long size,
+                                     uint64_t elapsed_ns) {
+  char name[64];
+
+  snprintf(name, sizeof(name), "fs %s %s", ops->name, step);
+  iotc_benchmark_report(name, size, elapsed_ns, IOTC_BENCHMARK_FS_FILES);
+}
+
+static int iotc_benchmark_fs(const iotc_benchmark_fs_ops_t* ops, long size) {
+  uint8_t chunk[IOTC_BENCHMARK_FS_CHUNK_SIZE];
+  uint64_t write_ns = 0;
+  uint64_t stat_ns = 0;
+  uint64_t read_ns = 0;
+  uint64_t remove_ns = 0;
+  int result = 0;
+  long i = 0;
+
+  memset(chunk, 0xA5, sizeof(chunk));
+
+  for (i = 0; i < IOTC_BENCHMARK_FS_FILES && 0 == result; ++i) {
+    intptr_t handle = 0;
+    size_t offset = 0;
+    size_t file_size = 0;
+
+    /* open, write in chunks and close */
+    uint64_t start = iotc_benchmark_now_ns();
+
+    result |= ops->open(1, &handle);
+
+    for (offset = 0; 0 == result && offset < (size_t)size;
+         offset += sizeof(chunk)) {
+      result |= ops->write(handle, chunk,
+                           IOTC_MIN(sizeof(chunk), (size_t)size - offset),
+                           offset);
+    }
+
+    result |= ops->close(handle);
+    write_ns += iotc_benchmark_now_ns() - start;
+
+    start = iotc_benchmark_now_ns();
+    result |= ops->stat(&file_size);
+    stat_ns += iotc_benchmark_now_ns() - start;
+
+    result |= (file_size == (size_t)size) ? 0 : 1;
+
+    /* open, read to the end and close */
+    start = iotc_benchmark_now_ns();
+
+    result |= ops->open(0, &handle);
+
+    for (offset = 0; 0 == result && offset < file_size;) {
+      const uint8_t* buffer = NULL;
+      size_t buffer_size = 0;
+
+      result |= ops->read(handle, offset, &buffer, &buffer_size);
+      result |= (0 == buffer_size) ? 1 : 0;
+      offset += buffer_size;
+    }
+
+    result |= ops->close(handle);
+    read_ns += iotc_benchmark_now_ns() - start;
+
+    start = iotc_benchmark_now_ns();
+    result |= ops->remove();
+    remove_ns += iotc_benchmark_now_ns() - start;
+  }
+
+  if (0 != result) {
+    ops->remove();
+    return result;
+  }
+
+  iotc_benchmark_fs_report(ops, "write", size, write_ns);
+  iotc_benchmark_fs_report(ops, "stat", size, stat_ns);
+  iotc_benchmark_fs_report(ops, "read", size, read_ns);
+  iotc_benchmark_fs_report(ops, "remove", size, remove_ns);
+
+  return 0;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_fs_sizes); ++i) {
+    const long size = iotc_benchmark_fs_sizes[i];
+
+    result |= iotc_benchmark_fs(&iotc_benchmark_iotc_fs_ops, size);
+    result |= iotc_benchmark_fs(&iotc_benchmark_bsp_fs_ops, size);
+  }
+
+  return result;
+}
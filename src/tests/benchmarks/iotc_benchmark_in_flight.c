@@ -0,0 +1,188 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iotc_benchmark.h"
+#include "iotc_list.h"
+#include "iotc_macros.h"
+#include "iotc_mqtt_logic_in_flight.h"
+#include "iotc_mqtt_logic_layer_data.h"
+
+/* holds a number of outstanding QoS 1 publishes and acknowledges them a bit
+ * out of order, the way PUBACKs come back over a lossy uplink */
+
+/* the ids start right below the wrap of the 16 bit msg_id */
+#define IOTC_BENCHMARK_IN_FLIGHT_FIRST_MSG_ID 65000
+
+#define IOTC_BENCHMARK_IN_FLIGHT_CMP_MSG_ID(task, id) (task->msg_id == id)
+
+static const long iotc_benchmark_in_flight_sizes[] = {100, 1000, 10000};
+
+typedef struct iotc_benchmark_in_flight_ops_s {
+  const char* name;
+  int (*add)(void* queue, iotc_mqtt_logic_task_t* task);
+  iotc_mqtt_logic_task_t* (*find)(void* queue, uint16_t msg_id);
+  void (*remove)(void* queue, iotc_mqtt_logic_task_t* task);
+  void (*destroy)(void* queue);
+} iotc_benchmark_in_flight_ops_t;
+
+static int iotc_benchmark_list_add(void* queue, iotc_mqtt_logic_task_t* task) {
+  IOTC_LIST_PUSH_BACK(iotc_mqtt_logic_task_t, *(iotc_mqtt_logic_task_t**)queue,
+                      task);
+  return 0;
+}
+
+static iotc_mqtt_logic_task_t* iotc_benchmark_list_find(void* queue,
+                                                        uint16_t msg_id) {
+  iotc_mqtt_logic_task_t* task = NULL;
+  IOTC_LIST_FIND(iotc_mqtt_logic_task_t, *(iotc_mqtt_logic_task_t**)queue,
+                 IOTC_BENCHMARK_IN_FLIGHT_CMP_MSG_ID, msg_id, task);
+  return task;
+}
+
+static void iotc_benchmark_list_remove(void* queue,
+                                       iotc_mqtt_logic_task_t* task) {
+  IOTC_LIST_DROP(iotc_mqtt_logic_task_t, *(iotc_mqtt_logic_task_t**)queue,
+                 task);
+}
+
+static void iotc_benchmark_list_destroy(void* queue) { IOTC_UNUSED(queue); }
+
+static int iotc_benchmark_table_add(void* queue, iotc_mqtt_logic_task_t* task) {
+  return (IOTC_STATE_OK ==
+          iotc_mqtt_logic_in_flight_add((iotc_mqtt_logic_in_flight_t*)queue,
+                                        task))
+             ? 0
+             : 1;
+}
+
+static iotc_mqtt_logic_task_t* iotc_benchmark_table_find(void* queue,
+                                                         uint16_t msg_id) {
+  return iotc_mqtt_logic_in_flight_find((iotc_mqtt_logic_in_flight_t*)queue,
+                                        msg_id);
+}
+
+static void iotc_benchmark_table_remove(void* queue,
+                                        iotc_mqtt_logic_task_t* task) {
+  iotc_mqtt_logic_in_flight_remove((iotc_mqtt_logic_in_flight_t*)queue, task);
+}
+
+static void iotc_benchmark_table_destroy(void* queue) {
+  iotc_mqtt_logic_in_flight_detach_all((iotc_mqtt_logic_in_flight_t*)queue);
+}
+
+static const iotc_benchmark_in_flight_ops_t iotc_benchmark_list_ops = {
+    "list", &iotc_benchmark_list_add, &iotc_benchmark_list_find,
+    &iotc_benchmark_list_remove, &iotc_benchmark_list_destroy};
+
+static const iotc_benchmark_in_flight_ops_t iotc_benchmark_table_ops = {
+    "table", &iotc_benchmark_table_add, &iotc_benchmark_table_find,
+    &iotc_benchmark_table_remove, &iotc_benchmark_table_destroy};
+
+static void iotc_benchmark_in_flight_report(
+    const iotc_benchmark_in_flight_ops_t* ops, const char* operation,
+    long size, uint64_t elapsed_ns) {
+  char name[64];
+  snprintf(name, sizeof(name), "in flight %s %s", ops->name, operation);
+  iotc_benchmark_report(name, size, elapsed_ns, size);
+}
+
+static int iotc_benchmark_in_flight(const iotc_benchmark_in_flight_ops_t* ops,
+                                    long size) {
+  iotc_mqtt_logic_task_t* tasks = calloc(size, sizeof(iotc_mqtt_logic_task_t));
+  long* acks = calloc(size, sizeof(long));
+
+  /* large enough for either of the queues */
+  union {
+    iotc_mqtt_logic_task_t* list;
+    iotc_mqtt_logic_in_flight_t table;
+  } queue;
+  memset(&queue, 0, sizeof(queue));
+
+  int result = 1;
+  long i = 0;
+
+  if (NULL == tasks || NULL == acks) {
+    goto end;
+  }
+
+  srand(0);
+
+  for (i = 0; i < size; ++i) {
+    tasks[i].msg_id = (uint16_t)(IOTC_BENCHMARK_IN_FLIGHT_FIRST_MSG_ID + i);
+    acks[i] = i;
+  }
+
+  /* mostly in order, each PUBACK swapped with one of the next few */
+  for (i = 0; i < size; ++i) {
+    const long step = rand() % 16;
+    const long other = IOTC_MIN(size - 1, i + step);
+    const long tmp = acks[i];
+    acks[i] = acks[other];
+    acks[other] = tmp;
+  }
+
+  uint64_t start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    if (0 != ops->add(&queue, &tasks[i])) {
+      goto end;
+    }
+  }
+
+  iotc_benchmark_in_flight_report(ops, "publish", size,
+                                  iotc_benchmark_now_ns() - start);
+
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    iotc_mqtt_logic_task_t* task = ops->find(&queue, tasks[acks[i]].msg_id);
+
+    if (&tasks[acks[i]] != task) {
+      goto end;
+    }
+
+    ops->remove(&queue, task);
+  }
+
+  iotc_benchmark_in_flight_report(ops, "puback", size,
+                                  iotc_benchmark_now_ns() - start);
+
+  result = 0;
+
+end:
+  ops->destroy(&queue);
+  free(acks);
+  free(tasks);
+
+  return result;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_in_flight_sizes); ++i) {
+    const long size = iotc_benchmark_in_flight_sizes[i];
+
+    result |= iotc_benchmark_in_flight(&iotc_benchmark_list_ops, size);
+    result |= iotc_benchmark_in_flight(&iotc_benchmark_table_ops, size);
+  }
+
+  return result;
+}
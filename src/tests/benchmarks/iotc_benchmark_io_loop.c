@@ -0,0 +1,183 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include "iotc_benchmark.h"
+
+#ifdef IOTC_MODULE_THREAD_ENABLED
+
+#include "iotc.h"
+#include "iotc_event_dispatcher_api.h"
+#include "iotc_event_handle.h"
+#include "iotc_thread_io_loop.h"
+
+/* posts single events to an idle I/O loop and measures how long it takes
+ * until the handler runs, then spreads events that stand for the processing
+ * of one message each over 1, 2 and 4 loops */
+
+#define IOTC_BENCHMARK_IO_LOOP_WAKEUPS 1000
+#define IOTC_BENCHMARK_IO_LOOP_MESSAGES 20000
+#define IOTC_BENCHMARK_IO_LOOP_WORK 5000
+#define IOTC_BENCHMARK_IO_LOOP_MAX_LOOPS 4
+
+/* a heap cap of the memory limiter is sized for a device, all the messages
+ * may be queued before the loops get to run */
+#define IOTC_BENCHMARK_IO_LOOP_MAX_HEAP_USAGE (64 * 1024 * 1024)
+
+typedef struct iotc_benchmark_io_loop_event_s {
+  volatile uint64_t handled_ns;
+} iotc_benchmark_io_loop_event_t;
+
+static uint32_t iotc_benchmark_io_loop_handled;
+
+static iotc_state_t iotc_benchmark_io_loop_wakeup_handler(
+    iotc_event_handle_arg1_t arg1) {
+  iotc_benchmark_io_loop_event_t* event =
+      (iotc_benchmark_io_loop_event_t*)arg1;
+
+  __sync_synchronize();
+  event->handled_ns = iotc_benchmark_now_ns();
+
+  return IOTC_STATE_OK;
+}
+
+static iotc_state_t iotc_benchmark_io_loop_message_handler(void) {
+  volatile uint32_t checksum = 0;
+  uint32_t i = 0;
+
+  for (; i < IOTC_BENCHMARK_IO_LOOP_WORK; ++i) {
+    checksum += i;
+  }
+
+  __atomic_add_fetch(&iotc_benchmark_io_loop_handled, 1, __ATOMIC_RELEASE);
+
+  return IOTC_STATE_OK;
+}
+
+static int iotc_benchmark_io_loop_latency(struct iotc_io_loop_s* io_loop,
+                                          long size) {
+  uint64_t elapsed_ns = 0;
+  long i = 0;
+
+  for (; i < size; ++i) {
+    iotc_benchmark_io_loop_event_t event = {0};
+
+    /* let the loop fall asleep in its poll before the next event */
+    usleep(100);
+
+    const uint64_t posted_ns = iotc_benchmark_now_ns();
+
+    if (NULL == iotc_evtd_execute(
+                    iotc_io_loop_get_evtd(io_loop),
+                    iotc_make_handle(&iotc_benchmark_io_loop_wakeup_handler,
+                                     &event))) {
+      iotc_benchmark_fail("io loop wakeup latency", size,
+                          "the loop refused an event");
+      return 1;
+    }
+
+    while (0 == event.handled_ns) {
+      __sync_synchronize();
+    }
+
+    elapsed_ns += event.handled_ns - posted_ns;
+  }
+
+  iotc_benchmark_report("io loop wakeup latency", size, elapsed_ns, size);
+
+  return 0;
+}
+
+static int iotc_benchmark_io_loop_spread(struct iotc_io_loop_s** io_loops,
+                                         long loops, long size) {
+  char name[64] = {0};
+  snprintf(name, sizeof(name), "io loop messages, %ld loop(s)", loops);
+
+  __atomic_store_n(&iotc_benchmark_io_loop_handled, 0, __ATOMIC_RELEASE);
+
+  const uint64_t start_ns = iotc_benchmark_now_ns();
+  long i = 0;
+
+  for (; i < size; ++i) {
+    iotc_evtd_instance_t* evtd = iotc_io_loop_get_evtd(io_loops[i % loops]);
+
+    if (NULL == iotc_evtd_execute(
+                    evtd, iotc_make_handle(
+                              &iotc_benchmark_io_loop_message_handler))) {
+      iotc_benchmark_fail(name, size, "a loop refused an event");
+
+      /* the loops still run the events they took */
+      while ((uint32_t)i != __atomic_load_n(&iotc_benchmark_io_loop_handled,
+                                            __ATOMIC_ACQUIRE)) {
+        usleep(10);
+      }
+
+      return 1;
+    }
+  }
+
+  while ((uint32_t)size != __atomic_load_n(&iotc_benchmark_io_loop_handled,
+                                           __ATOMIC_ACQUIRE)) {
+    usleep(10);
+  }
+
+  iotc_benchmark_report(name, size, iotc_benchmark_now_ns() - start_ns, size);
+
+  return 0;
+}
+
+int main() {
+  int result = 1;
+
+  struct iotc_io_loop_s* io_loops[IOTC_BENCHMARK_IO_LOOP_MAX_LOOPS] = {NULL};
+
+  /* not supported without the memory limiter, there's no cap then */
+  iotc_set_maximum_heap_usage(IOTC_BENCHMARK_IO_LOOP_MAX_HEAP_USAGE);
+
+  long i = 0;
+  for (; i < IOTC_BENCHMARK_IO_LOOP_MAX_LOOPS; ++i) {
+    io_loops[i] = iotc_io_loop_create_instance();
+
+    if (NULL == io_loops[i]) {
+      goto end;
+    }
+  }
+
+  result = iotc_benchmark_io_loop_latency(io_loops[0],
+                                          IOTC_BENCHMARK_IO_LOOP_WAKEUPS);
+
+  for (i = 1; i <= IOTC_BENCHMARK_IO_LOOP_MAX_LOOPS; i *= 2) {
+    result |= iotc_benchmark_io_loop_spread(io_loops, i,
+                                            IOTC_BENCHMARK_IO_LOOP_MESSAGES);
+  }
+
+end:
+  for (i = 0; i < IOTC_BENCHMARK_IO_LOOP_MAX_LOOPS; ++i) {
+    iotc_io_loop_destroy_instance(&io_loops[i]);
+  }
+
+  return result;
+}
+
+#else
+
+int main() {
+  iotc_benchmark_skip("io loop wakeup latency", 0, "built without threading");
+  return 0;
+}
+
+#endif
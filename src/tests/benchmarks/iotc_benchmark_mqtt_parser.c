@@ -0,0 +1,163 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iotc_allocator.h"
+#include "iotc_benchmark.h"
+#include "iotc_bsp_mem.h"
+#include "iotc_config.h"
+#include "iotc_macros.h"
+#include "iotc_mqtt_message.h"
+#include "iotc_mqtt_parser.h"
+
+/* parses inbound PUBLISH messages of growing payload sizes, fed to the parser
+ * in chunks of the default receive buffer size the way the codec layer gets
+ * them, and reports the throughput and the allocations made per message */
+#define IOTC_BENCHMARK_MQTT_PARSER_TOPIC "/devices/device-0/commands/reboot"
+
+typedef struct iotc_benchmark_mqtt_parser_case_s {
+  long payload_size;
+  long messages;
+} iotc_benchmark_mqtt_parser_case_t;
+
+static const iotc_benchmark_mqtt_parser_case_t
+    iotc_benchmark_mqtt_parser_cases[] = {
+        {16, 200000}, {1024, 100000}, {IOTC_MQTT_MAX_PAYLOAD_SIZE, 1000}};
+
+/* the library allocates through the BSP, so replacing the POSIX BSP memory
+ * functions is enough to count every allocation the parser makes */
+static long iotc_benchmark_mqtt_parser_allocations = 0;
+
+void* iotc_bsp_mem_alloc(size_t byte_count) {
+  ++iotc_benchmark_mqtt_parser_allocations;
+  return malloc(byte_count);
+}
+
+void* iotc_bsp_mem_realloc(void* ptr, size_t byte_count) {
+  ++iotc_benchmark_mqtt_parser_allocations;
+  return realloc(ptr, byte_count);
+}
+
+void iotc_bsp_mem_free(void* ptr) { free(ptr); }
+
+/* encodes a QoS 1 PUBLISH, returns its length or 0 if out doesn't fit it */
+static size_t iotc_benchmark_mqtt_parser_encode(long payload_size, uint8_t* out,
+                                                size_t out_size) {
+  const size_t topic_len = strlen(IOTC_BENCHMARK_MQTT_PARSER_TOPIC);
+  size_t remaining_length = 2 + topic_len + 2 + (size_t)payload_size;
+  size_t pos = 0;
+
+  if (out_size < remaining_length + 5) {
+    return 0;
+  }
+
+  out[pos++] = 0x32;
+
+  do {
+    uint8_t digit = remaining_length & 0x7f;
+    remaining_length >>= 7;
+    out[pos++] = (remaining_length > 0) ? (digit | 0x80) : digit;
+  } while (remaining_length > 0);
+
+  out[pos++] = (uint8_t)(topic_len >> 8);
+  out[pos++] = (uint8_t)topic_len;
+  memcpy(out + pos, IOTC_BENCHMARK_MQTT_PARSER_TOPIC, topic_len);
+  pos += topic_len;
+  out[pos++] = 0x12;
+  out[pos++] = 0x34;
+  memset(out + pos, 'x', payload_size);
+
+  return pos + payload_size;
+}
+
+static int iotc_benchmark_mqtt_parser(
+    const iotc_benchmark_mqtt_parser_case_t* bench_case) {
+  const size_t encoded_size = bench_case->payload_size + 64;
+  uint8_t* encoded = malloc(encoded_size);
+  iotc_mqtt_parser_t parser;
+  iotc_mqtt_message_t* msg = NULL;
+  iotc_state_t state = IOTC_STATE_OK;
+  int result = 1;
+  long i = 0;
+
+  if (NULL == encoded) {
+    return 1;
+  }
+
+  const size_t encoded_len = iotc_benchmark_mqtt_parser_encode(
+      bench_case->payload_size, encoded, encoded_size);
+
+  iotc_benchmark_mqtt_parser_allocations = 0;
+  const uint64_t start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < bench_case->messages; ++i) {
+    size_t offset = 0;
+
+    IOTC_ALLOC_AT(iotc_mqtt_message_t, msg, state);
+    iotc_mqtt_parser_init(&parser);
+
+    do {
+      const size_t len =
+          IOTC_MIN((size_t)IOTC_IO_BUFFER_SIZE, encoded_len - offset);
+      iotc_data_desc_t chunk = {encoded + offset, NULL, len, len, 0,
+                                IOTC_MEMORY_TYPE_UNMANAGED};
+
+      state = iotc_mqtt_parser_execute(&parser, msg, &chunk);
+      offset += chunk.curr_pos;
+    } while (IOTC_STATE_WANT_READ == state && offset < encoded_len);
+
+    if (IOTC_STATE_OK != state || NULL == msg->publish.content ||
+        msg->publish.content->length != (uint32_t)bench_case->payload_size) {
+      goto err_handling;
+    }
+
+    iotc_mqtt_message_free(&msg);
+  }
+
+  const uint64_t elapsed_ns = iotc_benchmark_now_ns() - start;
+
+  iotc_benchmark_report("mqtt parser publish", bench_case->payload_size,
+                        elapsed_ns, bench_case->messages);
+  iotc_benchmark_report_value(
+      "mqtt parser publish", bench_case->payload_size,
+      (double)bench_case->messages * 1e9 / (double)elapsed_ns, "msgs/s");
+  iotc_benchmark_report_value(
+      "mqtt parser publish", bench_case->payload_size,
+      (double)iotc_benchmark_mqtt_parser_allocations /
+          (double)bench_case->messages,
+      "allocs/msg");
+
+  result = 0;
+
+err_handling:
+  iotc_mqtt_message_free(&msg);
+  free(encoded);
+
+  return result;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_mqtt_parser_cases); ++i) {
+    result |= iotc_benchmark_mqtt_parser(&iotc_benchmark_mqtt_parser_cases[i]);
+  }
+
+  return result;
+}
@@ -0,0 +1,114 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "iotc_benchmark.h"
+
+#ifdef IOTC_MODULE_THREAD_ENABLED
+
+#include "iotc_event_handle.h"
+#include "iotc_macros.h"
+#include "iotc_thread_threadpool.h"
+
+/* dispatches slow subscription callbacks the way the mqtt logic layer does,
+ * ordered per subscription, and measures how long the pool takes to call all
+ * of them */
+
+#define IOTC_BENCHMARK_THREADPOOL_CALLBACKS 400
+#define IOTC_BENCHMARK_THREADPOOL_SUBSCRIPTIONS 8
+#define IOTC_BENCHMARK_THREADPOOL_CALLBACK_US 200
+
+static const uint8_t iotc_benchmark_threadpool_threads[] = {1, 2, 4, 8};
+
+static long iotc_benchmark_threadpool_called = 0;
+
+static iotc_state_t iotc_benchmark_threadpool_callback(
+    iotc_event_handle_arg1_t arg1) {
+  IOTC_UNUSED(arg1);
+
+  usleep(IOTC_BENCHMARK_THREADPOOL_CALLBACK_US);
+  __sync_fetch_and_add(&iotc_benchmark_threadpool_called, 1);
+
+  return IOTC_STATE_OK;
+}
+
+static int iotc_benchmark_threadpool(uint8_t threads, long size) {
+  char subscriptions[IOTC_BENCHMARK_THREADPOOL_SUBSCRIPTIONS];
+  char name[64];
+
+  iotc_threadpool_t* threadpool = iotc_threadpool_create_instance(threads);
+
+  if (NULL == threadpool) {
+    return 1;
+  }
+
+  iotc_benchmark_threadpool_called = 0;
+
+  const uint64_t start = iotc_benchmark_now_ns();
+
+  long i = 0;
+  for (; i < size; ++i) {
+    const void* key = &subscriptions[i % IOTC_ARRAYSIZE(subscriptions)];
+
+    if (NULL == iotc_threadpool_execute_ordered(
+                    threadpool,
+                    iotc_make_threaded_handle(
+                        IOTC_THREADID_ANYTHREAD,
+                        &iotc_benchmark_threadpool_callback, (void*)key),
+                    key)) {
+      iotc_threadpool_destroy_instance(&threadpool);
+      return 1;
+    }
+  }
+
+  while (size != __sync_fetch_and_add(&iotc_benchmark_threadpool_called, 0)) {
+    usleep(50);
+  }
+
+  const uint64_t elapsed_ns = iotc_benchmark_now_ns() - start;
+
+  iotc_threadpool_destroy_instance(&threadpool);
+
+  snprintf(name, sizeof(name), "threadpool %d threads ordered callbacks",
+           threads);
+  iotc_benchmark_report(name, size, elapsed_ns, size);
+
+  return 0;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_threadpool_threads); ++i) {
+    result |= iotc_benchmark_threadpool(iotc_benchmark_threadpool_threads[i],
+                                        IOTC_BENCHMARK_THREADPOOL_CALLBACKS);
+  }
+
+  return result;
+}
+
+#else
+
+int main() {
+  iotc_benchmark_skip("threadpool ordered callbacks", 0,
+                      "built without threading");
+  return 0;
+}
+
+#endif
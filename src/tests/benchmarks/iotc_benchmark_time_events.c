@@ -0,0 +1,217 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "iotc_benchmark.h"
+#include "iotc_macros.h"
+#include "iotc_time_event.h"
+#include "iotc_time_wheel.h"
+#include "iotc_vector.h"
+
+/* a restart-heavy load: every timer is pushed forward several times before the
+ * clock reaches it, the way keepalive and request timeouts are */
+#define IOTC_BENCHMARK_TIME_EVENTS_RESTARTS_PER_TIMER 8
+/* a restart costs the vector time proportional to the number of timers, so
+ * the sample is capped to keep the run short */
+#define IOTC_BENCHMARK_TIME_EVENTS_MAX_RESTARTS 20000
+#define IOTC_BENCHMARK_TIME_EVENTS_TIMEOUT 60
+
+static const long iotc_benchmark_time_events_sizes[] = {100, 10000, 100000};
+
+typedef struct iotc_benchmark_time_events_ops_s {
+  const char* name;
+  void* (*create)(void);
+  void (*destroy)(void* container);
+  iotc_state_t (*add)(void* container, iotc_time_event_t* time_event,
+                      iotc_time_event_handle_t* time_event_handle);
+  iotc_state_t (*restart)(void* container,
+                          iotc_time_event_handle_t* time_event_handle,
+                          iotc_time_t new_time);
+  iotc_time_event_t* (*get_top)(void* container);
+} iotc_benchmark_time_events_ops_t;
+
+static void* iotc_benchmark_vector_create(void) { return iotc_vector_create(); }
+
+static void iotc_benchmark_vector_destroy(void* container) {
+  iotc_vector_destroy((iotc_vector_t*)container);
+}
+
+static iotc_state_t iotc_benchmark_vector_add(
+    void* container, iotc_time_event_t* time_event,
+    iotc_time_event_handle_t* time_event_handle) {
+  return iotc_time_event_add((iotc_vector_t*)container, time_event,
+                             time_event_handle);
+}
+
+static iotc_state_t iotc_benchmark_vector_restart(
+    void* container, iotc_time_event_handle_t* time_event_handle,
+    iotc_time_t new_time) {
+  return iotc_time_event_restart((iotc_vector_t*)container, time_event_handle,
+                                 new_time);
+}
+
+static iotc_time_event_t* iotc_benchmark_vector_get_top(void* container) {
+  return iotc_time_event_get_top((iotc_vector_t*)container);
+}
+
+static void* iotc_benchmark_wheel_create(void) {
+  return iotc_time_wheel_create();
+}
+
+static void iotc_benchmark_wheel_destroy(void* container) {
+  iotc_time_wheel_destroy((iotc_time_wheel_t*)container);
+}
+
+static iotc_state_t iotc_benchmark_wheel_add(
+    void* container, iotc_time_event_t* time_event,
+    iotc_time_event_handle_t* time_event_handle) {
+  return iotc_time_wheel_add((iotc_time_wheel_t*)container, time_event,
+                             time_event_handle);
+}
+
+static iotc_state_t iotc_benchmark_wheel_restart(
+    void* container, iotc_time_event_handle_t* time_event_handle,
+    iotc_time_t new_time) {
+  return iotc_time_wheel_restart((iotc_time_wheel_t*)container,
+                                 time_event_handle, new_time);
+}
+
+static iotc_time_event_t* iotc_benchmark_wheel_get_top(void* container) {
+  return iotc_time_wheel_get_top((iotc_time_wheel_t*)container);
+}
+
+static const iotc_benchmark_time_events_ops_t iotc_benchmark_vector_ops = {
+    "vector", &iotc_benchmark_vector_create, &iotc_benchmark_vector_destroy,
+    &iotc_benchmark_vector_add, &iotc_benchmark_vector_restart,
+    &iotc_benchmark_vector_get_top};
+
+static const iotc_benchmark_time_events_ops_t iotc_benchmark_wheel_ops = {
+    "wheel", &iotc_benchmark_wheel_create, &iotc_benchmark_wheel_destroy,
+    &iotc_benchmark_wheel_add, &iotc_benchmark_wheel_restart,
+    &iotc_benchmark_wheel_get_top};
+
+static void iotc_benchmark_time_events_report(
+    const iotc_benchmark_time_events_ops_t* ops, const char* operation,
+    long size, uint64_t elapsed_ns, long count) {
+  char name[64];
+  snprintf(name, sizeof(name), "time events %s %s", ops->name, operation);
+  iotc_benchmark_report(name, size, elapsed_ns, count);
+}
+
+static int iotc_benchmark_time_events(
+    const iotc_benchmark_time_events_ops_t* ops, long size) {
+  void* container = ops->create();
+  iotc_time_event_t* time_events = calloc(size, sizeof(iotc_time_event_t));
+  iotc_time_event_handle_t* handles =
+      calloc(size, sizeof(iotc_time_event_handle_t));
+
+  int result = 1;
+  long i = 0;
+
+  if (NULL == container || NULL == time_events || NULL == handles) {
+    goto end;
+  }
+
+  srand(0);
+
+  /* timers armed at random moments within one timeout */
+  uint64_t start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    time_events[i].time_of_execution =
+        rand() % IOTC_BENCHMARK_TIME_EVENTS_TIMEOUT;
+    time_events[i].position = IOTC_TIME_EVENT_POSITION_INVALID;
+
+    if (IOTC_STATE_OK != ops->add(container, &time_events[i], &handles[i])) {
+      goto end;
+    }
+  }
+
+  iotc_benchmark_time_events_report(ops, "add", size,
+                                    iotc_benchmark_now_ns() - start, size);
+
+  /* the clock advances by one unit per round of restarts, a restarted timer
+   * fires a timeout after its last activity */
+  const long restarts =
+      IOTC_MIN(size * IOTC_BENCHMARK_TIME_EVENTS_RESTARTS_PER_TIMER,
+               IOTC_BENCHMARK_TIME_EVENTS_MAX_RESTARTS);
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < restarts; ++i) {
+    const long timer = rand() % size;
+    const iotc_time_t now = i / size;
+
+    if (IOTC_STATE_OK !=
+        ops->restart(container, &handles[timer],
+                     now + IOTC_BENCHMARK_TIME_EVENTS_TIMEOUT +
+                         rand() % IOTC_BENCHMARK_TIME_EVENTS_TIMEOUT)) {
+      goto end;
+    }
+  }
+
+  iotc_benchmark_time_events_report(ops, "restart", size,
+                                    iotc_benchmark_now_ns() - start, restarts);
+
+  iotc_time_t last_time = 0;
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    const iotc_time_event_t* time_event = ops->get_top(container);
+
+    if (NULL == time_event || time_event->time_of_execution < last_time) {
+      goto end;
+    }
+
+    last_time = time_event->time_of_execution;
+  }
+
+  iotc_benchmark_time_events_report(ops, "get top", size,
+                                    iotc_benchmark_now_ns() - start, size);
+
+  result = 0;
+
+end:
+  if (NULL != container) {
+    ops->destroy(container);
+  }
+  free(handles);
+  free(time_events);
+
+  return result;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  printf("vector index width: %d bits\n", IOTC_VECTOR_INDEX_WIDTH);
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_time_events_sizes); ++i) {
+    const long size = iotc_benchmark_time_events_sizes[i];
+
+    if (size > IOTC_VECTOR_INDEX_MAX) {
+      iotc_benchmark_skip("time events vector", size,
+                          "set IOTC_VECTOR_INDEX_WIDTH");
+    } else {
+      result |= iotc_benchmark_time_events(&iotc_benchmark_vector_ops, size);
+    }
+
+    result |= iotc_benchmark_time_events(&iotc_benchmark_wheel_ops, size);
+  }
+
+  return result;
+}
@@ -0,0 +1,140 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iotc.h"
+#include "iotc_benchmark.h"
+#include "iotc_macros.h"
+#include "iotc_topic_trie.h"
+
+/* dispatches the same number of inbound PUBLISH topics against growing
+ * numbers of subscriptions, the cost per publish should stay flat */
+#define IOTC_BENCHMARK_TOPIC_TRIE_PUBLISHES 1000000
+#define IOTC_BENCHMARK_TOPIC_TRIE_TOPIC_SIZE 64
+
+/* a heap cap of the memory limiter is sized for a device, not for the
+ * subscriptions of a large gateway */
+#define IOTC_BENCHMARK_TOPIC_TRIE_MAX_HEAP_USAGE (64 * 1024 * 1024)
+
+static const long iotc_benchmark_topic_trie_sizes[] = {10, 1000, 10000};
+
+static void iotc_benchmark_topic_trie_on_match(void* value, void* arg) {
+  IOTC_UNUSED(value);
+  *(long*)arg += 1;
+}
+
+/* a mix of the filters a gateway subscribes to for each device it serves */
+static void iotc_benchmark_topic_trie_make_filter(long id, char* out) {
+  switch (id % 3) {
+    case 0:
+      sprintf(out, "/devices/device-%ld/commands/#", id / 3);
+      break;
+    case 1:
+      sprintf(out, "/devices/device-%ld/config", id / 3);
+      break;
+    default:
+      sprintf(out, "/devices/+/state/%ld", id / 3);
+      break;
+  }
+}
+
+static int iotc_benchmark_topic_trie(long size) {
+  iotc_topic_trie_t* trie = iotc_topic_trie_create();
+  char(*topics)[IOTC_BENCHMARK_TOPIC_TRIE_TOPIC_SIZE] =
+      calloc(size, IOTC_BENCHMARK_TOPIC_TRIE_TOPIC_SIZE);
+  size_t* topic_lengths = calloc(size, sizeof(size_t));
+
+  int result = 1;
+  long i = 0;
+
+  if (NULL == trie || NULL == topics || NULL == topic_lengths) {
+    goto err_handling;
+  }
+
+  char topic_filter[IOTC_BENCHMARK_TOPIC_TRIE_TOPIC_SIZE];
+  uint64_t start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    iotc_benchmark_topic_trie_make_filter(i, topic_filter);
+
+    if (IOTC_STATE_OK != iotc_topic_trie_add(trie, topic_filter, trie)) {
+      iotc_benchmark_fail("topic trie add", size, "the trie refused a filter");
+      goto err_handling;
+    }
+  }
+
+  iotc_benchmark_report("topic trie add", size,
+                        iotc_benchmark_now_ns() - start, size);
+
+  /* one topic per subscription, each of them matches at least one filter */
+  for (i = 0; i < size; ++i) {
+    switch (i % 3) {
+      case 0:
+        sprintf(topics[i], "/devices/device-%ld/commands/reboot", i / 3);
+        break;
+      case 1:
+        sprintf(topics[i], "/devices/device-%ld/config", i / 3);
+        break;
+      default:
+        sprintf(topics[i], "/devices/device-%ld/state/%ld", i / 3, i / 3);
+        break;
+    }
+
+    topic_lengths[i] = strlen(topics[i]);
+  }
+
+  long matches = 0;
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < IOTC_BENCHMARK_TOPIC_TRIE_PUBLISHES; ++i) {
+    const long topic_id = i % size;
+
+    iotc_topic_trie_match(trie, (const uint8_t*)topics[topic_id],
+                          topic_lengths[topic_id],
+                          &iotc_benchmark_topic_trie_on_match, &matches);
+  }
+
+  iotc_benchmark_report("topic trie dispatch publish", size,
+                        iotc_benchmark_now_ns() - start,
+                        IOTC_BENCHMARK_TOPIC_TRIE_PUBLISHES);
+
+  result = (matches >= IOTC_BENCHMARK_TOPIC_TRIE_PUBLISHES) ? 0 : 1;
+
+err_handling:
+  if (NULL != trie) {
+    iotc_topic_trie_destroy(trie);
+  }
+  free(topics);
+  free(topic_lengths);
+
+  return result;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  /* not supported without the memory limiter, there's no cap then */
+  iotc_set_maximum_heap_usage(IOTC_BENCHMARK_TOPIC_TRIE_MAX_HEAP_USAGE);
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_topic_trie_sizes); ++i) {
+    result |= iotc_benchmark_topic_trie(iotc_benchmark_topic_trie_sizes[i]);
+  }
+
+  return result;
+}
@@ -0,0 +1,159 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "iotc_benchmark.h"
+#include "iotc_time_event.h"
+#include "iotc_vector.h"
+
+/* the cost of a find grows with the size of the vector so only a sample of the
+ * elements is looked up */
+#define IOTC_BENCHMARK_VECTOR_FIND_SAMPLES 1024
+
+static const long iotc_benchmark_vector_sizes[] = {10, 1000, 65536};
+
+static int8_t iotc_benchmark_vector_cmp(const union iotc_vector_selector_u* e0,
+                                        const union iotc_vector_selector_u* e1) {
+  if (e0->i32_value == e1->i32_value) {
+    return 0;
+  }
+
+  return (e0->i32_value < e1->i32_value) ? -1 : 1;
+}
+
+static int iotc_benchmark_vector(long size) {
+  iotc_vector_t* vector = iotc_vector_create();
+
+  if (NULL == vector) {
+    return 1;
+  }
+
+  long i = 0;
+  uint64_t start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    if (NULL == iotc_vector_push(vector, IOTC_VEC_CONST_VALUE_PARAM(
+                                             IOTC_VEC_VALUE_I32((int32_t)i)))) {
+      iotc_vector_destroy(vector);
+      return 1;
+    }
+  }
+
+  iotc_benchmark_report("vector push", size, iotc_benchmark_now_ns() - start,
+                        size);
+
+  const long find_step =
+      (size > IOTC_BENCHMARK_VECTOR_FIND_SAMPLES)
+          ? size / IOTC_BENCHMARK_VECTOR_FIND_SAMPLES
+          : 1;
+  long finds = 0;
+  long found = 0;
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; i += find_step, ++finds) {
+    found += (0 <= iotc_vector_find(vector,
+                                    IOTC_VEC_CONST_VALUE_PARAM(
+                                        IOTC_VEC_VALUE_I32((int32_t)i)),
+                                    &iotc_benchmark_vector_cmp));
+  }
+
+  iotc_benchmark_report("vector find", size, iotc_benchmark_now_ns() - start,
+                        finds);
+
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    iotc_vector_del(vector, 0);
+  }
+
+  iotc_benchmark_report("vector del", size, iotc_benchmark_now_ns() - start,
+                        size);
+
+  iotc_vector_destroy(vector);
+
+  return (found == finds) ? 0 : 1;
+}
+
+static int iotc_benchmark_time_events(long size) {
+  iotc_vector_t* vector = iotc_vector_create();
+  iotc_time_event_t* time_events = calloc(size, sizeof(iotc_time_event_t));
+
+  if (NULL == vector || NULL == time_events) {
+    free(time_events);
+    if (NULL != vector) {
+      iotc_vector_destroy(vector);
+    }
+    return 1;
+  }
+
+  long i = 0;
+  int result = 0;
+
+  srand(0);
+
+  uint64_t start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < size; ++i) {
+    time_events[i].time_of_execution = rand();
+    time_events[i].position = IOTC_TIME_EVENT_POSITION_INVALID;
+
+    if (IOTC_STATE_OK !=
+        iotc_time_event_add(vector, &time_events[i], NULL)) {
+      result = 1;
+      break;
+    }
+  }
+
+  iotc_benchmark_report("time event add", size,
+                        iotc_benchmark_now_ns() - start, i);
+
+  const long added = i;
+  start = iotc_benchmark_now_ns();
+
+  for (i = 0; i < added; ++i) {
+    iotc_time_event_get_top(vector);
+  }
+
+  iotc_benchmark_report("time event get top", size,
+                        iotc_benchmark_now_ns() - start, added);
+
+  iotc_vector_destroy(vector);
+  free(time_events);
+
+  return result;
+}
+
+int main() {
+  int result = 0;
+  size_t i = 0;
+
+  printf("vector index width: %d bits\n", IOTC_VECTOR_INDEX_WIDTH);
+
+  for (i = 0; i < IOTC_ARRAYSIZE(iotc_benchmark_vector_sizes); ++i) {
+    const long size = iotc_benchmark_vector_sizes[i];
+
+    if (size > IOTC_VECTOR_INDEX_MAX) {
+      iotc_benchmark_skip("vector", size, "set IOTC_VECTOR_INDEX_WIDTH");
+      continue;
+    }
+
+    result |= iotc_benchmark_vector(size);
+    result |= iotc_benchmark_time_events(size);
+  }
+
+  return result;
+}
@@ -0,0 +1,129 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include "iotc_benchmark.h"
+
+#ifdef IOTC_MODULE_THREAD_ENABLED
+
+#include "iotc_event_dispatcher_api.h"
+#include "iotc_event_handle.h"
+#include "iotc_thread_posix_workerthread.h"
+
+/* posts single events to an idle workerthread and measures how long it takes
+ * until the handler runs, then leaves the thread idle and counts how often it
+ * wakes up on its own */
+
+#define IOTC_BENCHMARK_WORKERTHREAD_WAKEUPS 1000
+#define IOTC_BENCHMARK_WORKERTHREAD_IDLE_SECONDS 1
+
+typedef struct iotc_benchmark_workerthread_event_s {
+  volatile uint64_t handled_ns;
+} iotc_benchmark_workerthread_event_t;
+
+static iotc_state_t iotc_benchmark_workerthread_handler(
+    iotc_event_handle_arg1_t arg1) {
+  iotc_benchmark_workerthread_event_t* event =
+      (iotc_benchmark_workerthread_event_t*)arg1;
+
+  __sync_synchronize();
+  event->handled_ns = iotc_benchmark_now_ns();
+
+  return IOTC_STATE_OK;
+}
+
+static int iotc_benchmark_workerthread_latency(
+    iotc_workerthread_t* workerthread, long size) {
+  uint64_t elapsed_ns = 0;
+  long i = 0;
+
+  for (; i < size; ++i) {
+    iotc_benchmark_workerthread_event_t event = {0};
+
+    /* let the thread fall asleep before the next event */
+    usleep(100);
+
+    const uint64_t posted_ns = iotc_benchmark_now_ns();
+
+    if (NULL ==
+        iotc_evtd_execute(workerthread->thread_evtd,
+                          iotc_make_handle(&iotc_benchmark_workerthread_handler,
+                                           &event))) {
+      return 1;
+    }
+
+    while (0 == event.handled_ns) {
+      __sync_synchronize();
+    }
+
+    elapsed_ns += event.handled_ns - posted_ns;
+  }
+
+  iotc_benchmark_report("workerthread wakeup latency", size, elapsed_ns, size);
+
+  return 0;
+}
+
+static int iotc_benchmark_workerthread_idle(iotc_workerthread_t* workerthread,
+                                            long seconds) {
+  const uint32_t wakeups_before = workerthread->wakeups;
+
+  sleep(seconds);
+
+  const uint32_t wakeups = workerthread->wakeups - wakeups_before;
+
+  iotc_benchmark_report_value("workerthread idle wakeups", seconds,
+                              (double)wakeups / (double)seconds, "wakeups/s");
+
+  return 0;
+}
+
+int main() {
+  int result = 1;
+
+  iotc_evtd_instance_t* evtd_secondary = iotc_evtd_create_instance();
+  iotc_workerthread_t* workerthread =
+      (NULL != evtd_secondary)
+          ? iotc_workerthread_create_instance(evtd_secondary)
+          : NULL;
+
+  if (NULL == workerthread || 0 == iotc_workerthread_wait_sync_point(
+                                       workerthread)) {
+    goto end;
+  }
+
+  result = iotc_benchmark_workerthread_latency(
+      workerthread, IOTC_BENCHMARK_WORKERTHREAD_WAKEUPS);
+  result |= iotc_benchmark_workerthread_idle(
+      workerthread, IOTC_BENCHMARK_WORKERTHREAD_IDLE_SECONDS);
+
+end:
+  iotc_workerthread_destroy_instance(&workerthread);
+  iotc_evtd_destroy_instance(evtd_secondary);
+
+  return result;
+}
+
+#else
+
+int main() {
+  iotc_benchmark_skip("workerthread wakeup latency", 0,
+                      "built without threading");
+  return 0;
+}
+
+#endif
@@ -106,12 +106,12 @@ IOTC_LAYER_TYPES_ADD(IOTC_LAYER_TYPE_IO, &iotc_io_dummy_layer_push,
         IOTC_DECLARE_LAYER_TYPES_END()
 
             static void iotc_inject_subscribe_handler(
-                iotc_vector_t** handler_vector,
+                iotc_topic_trie_t** handler_trie,
                 iotc_mqtt_task_specific_data_t* subs) {
   int i = 0;
 
-  if (*handler_vector == NULL) {
-    *handler_vector = iotc_vector_create();
+  if (*handler_trie == NULL) {
+    *handler_trie = iotc_topic_trie_create();
   }
 
   while (subs[i].subscribe.topic != NULL) {
@@ -121,8 +121,7 @@ IOTC_LAYER_TYPES_ADD(IOTC_LAYER_TYPE_IO, &iotc_io_dummy_layer_push,
     memcpy(data, &subs[i], sizeof(subs[i]));
     data->subscribe.topic = iotc_str_dup(subs[i].subscribe.topic);
 
-    iotc_vector_push(*handler_vector,
-                     IOTC_VEC_VALUE_PARAM(IOTC_VEC_VALUE_PTR(data)));
+    iotc_topic_trie_add(*handler_trie, data->subscribe.topic, data);
 
     i++;
   }
@@ -191,7 +190,7 @@ iotc_state_t iotc_mockfunction__layerfunction_init(void* context, void* data,
         mqtt_logic_layer_user_data->handlers_for_topics,
         mqtt_logic_layer_user_data->handlers_for_topics->elem_no); */
 
-    const iotc_vector_t* handlers_for_topics =
+    const iotc_topic_trie_t* handlers_for_topics =
         mqtt_logic_layer_user_data->handlers_for_topics;
 
     check_expected(handlers_for_topics);
@@ -226,7 +225,7 @@ iotc_state_t iotc_mockfunction__layerfunction_close(void* context, void* data,
         mqtt_logic_layer_user_data->handlers_for_topics,
         mqtt_logic_layer_user_data->handlers_for_topics->elem_no); */
 
-    const iotc_vector_t* handlers_for_topics =
+    const iotc_topic_trie_t* handlers_for_topics =
         mqtt_logic_layer_user_data->handlers_for_topics;
 
     check_expected(handlers_for_topics);
@@ -262,13 +261,15 @@ static void iotc_itest_clean_session_act() {
                &clean_session_on_connection_state_changed);
 
   iotc_evtd_step(iotc_context->context_data.evtd_instance,
-                 iotc_bsp_time_getcurrenttime_seconds() + 1);
+                 iotc_bsp_time_getmonotonictime_milliseconds() +
+                     IOTC_SEC_TO_MSEC(1));
 
   IOTC_PROCESS_CLOSE_EXTERNALLY_ON_THIS_LAYER(&iotc_context->layer_chain.bottom,
                                               NULL, IOTC_STATE_OK);
 
   iotc_evtd_step(iotc_context->context_data.evtd_instance,
-                 iotc_bsp_time_getcurrenttime_seconds() + 1);
+                 iotc_bsp_time_getmonotonictime_milliseconds() +
+                     IOTC_SEC_TO_MSEC(1));
 
   return;
 }
@@ -15,7 +15,6 @@
  */
 
 #include "iotc_itest_connect_error.h"
-#include "iotc_backoff_status_api.h"
 
 #include "iotc_debug.h"
 #include "iotc_globals.h"
@@ -107,9 +106,6 @@ int iotc_itest_connect_error_setup(void** fixture_void) {
 
   *fixture_void = iotc_itest_connect_error__generate_fixture();
 
-  iotc_globals.backoff_status.backoff_lut_i = 0;
-  iotc_cancel_backoff_event();
-
   iotc_initialize();
 
   IOTC_CHECK_STATE(iotc_create_context_with_custom_layers(
@@ -177,7 +173,7 @@ static void iotc_itest_connect_error__trigger_connect(
         IOTC_STATE_OK);
 
     iotc_evtd_step(iotc_globals.evtd_instance,
-                   iotc_bsp_time_getcurrenttime_seconds());
+                   iotc_bsp_time_getmonotonictime_milliseconds());
   }
 
   /* here we expect to connect succesfully */
@@ -194,7 +190,8 @@ static void iotc_itest_connect_error__trigger_event_dispatcher(
   while (iotc_evtd_dispatcher_continue(iotc_globals.evtd_instance) == 1 &&
          loop_counter < max_evtd_iterations) {
     iotc_evtd_step(iotc_globals.evtd_instance,
-                   iotc_bsp_time_getcurrenttime_seconds() + loop_counter);
+                   iotc_bsp_time_getmonotonictime_milliseconds() +
+                       IOTC_SEC_TO_MSEC(loop_counter));
     ++loop_counter;
   }
 }
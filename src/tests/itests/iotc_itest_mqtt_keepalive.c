@@ -17,7 +17,6 @@
 #include <iotc.h>
 #include <iotc_itest_mock_broker_layerchain.h>
 #include <iotc_macros.h>
-#include "iotc_backoff_status_api.h"
 #include "iotc_globals.h"
 #include "iotc_handle.h"
 #include "iotc_itest_helpers.h"
@@ -35,9 +34,6 @@ int iotc_itest_mqtt_keepalive_setup(void** fixture_void) {
 
   iotc_memory_limiter_tearup();
 
-  iotc_globals.backoff_status.backoff_lut_i = 0;
-  iotc_cancel_backoff_event();
-
   iotc_initialize();
 
   IOTC_CHECK_STATE(iotc_create_context_with_custom_layers(
@@ -109,7 +105,7 @@ static void iotc_itest_mqtt_keepalive__act(
       IOTC_STATE_OK);
 
   iotc_evtd_step(iotc_globals.evtd_instance,
-                 iotc_bsp_time_getcurrenttime_seconds());
+                 iotc_bsp_time_getmonotonictime_milliseconds());
 
   const uint16_t loop_counter_max = 23;
   const uint16_t loop_counter_disconnect = 18;
@@ -125,7 +121,8 @@ static void iotc_itest_mqtt_keepalive__act(
     // printf( "loop_counter = %d\n", loop_counter );
 
     iotc_evtd_step(iotc_globals.evtd_instance,
-                   iotc_bsp_time_getcurrenttime_seconds() + loop_counter);
+                   iotc_bsp_time_getmonotonictime_milliseconds() +
+                       IOTC_SEC_TO_MSEC(loop_counter));
     ++loop_counter;
 
     if (loop_id_reset_by_peer == loop_counter) {
@@ -15,11 +15,11 @@
  */
 
 #include "iotc_itest_tls_error.h"
-#include "iotc_backoff_status_api.h"
 #include "iotc_globals.h"
 #include "iotc_itest_helpers.h"
 
 #include "iotc_bsp_time.h"
+#include "iotc_config.h"
 #include "iotc_handle.h"
 #include "iotc_itest_layerchain_ct_ml_mc.h"
 #include "iotc_itest_mock_broker_layerchain.h"
@@ -86,6 +86,10 @@ typedef struct iotc_itest_tls_error__test_fixture_s {
   uint8_t loop_id__manual_publish;
   uint8_t loop_id__manual_disconnect;
 
+  iotc_mqtt_qos_t manual_publish_qos;
+  uint8_t manual_publish_count;
+  uint8_t manual_publish_delivered;
+
   uint8_t max_loop_count;
 
 } iotc_itest_tls_error__test_fixture_t;
@@ -110,6 +114,8 @@ iotc_itest_tls_error__test_fixture_t* iotc_itest_tls_error__generate_fixture() {
 
   fixture->loop_id__manual_publish = 6;
   fixture->loop_id__manual_disconnect = 15;
+  fixture->manual_publish_qos = IOTC_MQTT_QOS_AT_LEAST_ONCE;
+  fixture->manual_publish_count = 1;
   fixture->max_loop_count = 20;
 
   return fixture;
@@ -131,9 +137,6 @@ int iotc_itest_tls_error_setup(void** fixture_void) {
 
   *fixture_void = iotc_itest_tls_error__generate_fixture();
 
-  iotc_globals.backoff_status.backoff_lut_i = 0;
-  iotc_cancel_backoff_event();
-
   iotc_initialize();
 
   IOTC_CHECK_STATE(iotc_create_context_with_custom_layers(
@@ -185,6 +188,18 @@ void on_publish_received(iotc_context_handle_t in_context_handle,
   IOTC_UNUSED(user_data);
 }
 
+void tls_error_on_publish_finished(iotc_context_handle_t in_context_handle,
+                                   void* data, iotc_state_t state) {
+  IOTC_UNUSED(in_context_handle);
+
+  iotc_itest_tls_error__test_fixture_t* const fixture =
+      (iotc_itest_tls_error__test_fixture_t*)data;
+
+  if (IOTC_STATE_OK == state) {
+    ++fixture->manual_publish_delivered;
+  }
+}
+
 void tls_error_on_connection_state_changed(
     iotc_context_handle_t in_context_handle, void* data, iotc_state_t state) {
   IOTC_UNUSED(in_context_handle);
@@ -212,9 +227,9 @@ static void iotc_itest_tls_error__act(void** fixture_void, char do_publish_flag,
       IOTC_STATE_OK);
 
   iotc_evtd_step(iotc_globals.evtd_instance,
-                 iotc_bsp_time_getcurrenttime_seconds());
+                 iotc_bsp_time_getmonotonictime_milliseconds());
 
-  const iotc_itest_tls_error__test_fixture_t* const fixture =
+  iotc_itest_tls_error__test_fixture_t* const fixture =
       (iotc_itest_tls_error__test_fixture_t*)*fixture_void;
 
   const uint16_t keepalive_timeout = fixture->max_loop_count;
@@ -227,7 +242,8 @@ static void iotc_itest_tls_error__act(void** fixture_void, char do_publish_flag,
   while (iotc_evtd_dispatcher_continue(iotc_globals.evtd_instance) == 1 &&
          loop_counter < keepalive_timeout) {
     iotc_evtd_step(iotc_globals.evtd_instance,
-                   iotc_bsp_time_getcurrenttime_seconds() + loop_counter);
+                   iotc_bsp_time_getmonotonictime_milliseconds() +
+                       IOTC_SEC_TO_MSEC(loop_counter));
     ++loop_counter;
 
     if (loop_counter == fixture->loop_id__control_topic_auto_subscribe) {
@@ -236,8 +252,12 @@ static void iotc_itest_tls_error__act(void** fixture_void, char do_publish_flag,
     }
 
     if (do_publish_flag && loop_counter == fixture->loop_id__manual_publish) {
-      iotc_publish(iotc_context_handle, fixture->test_topic_name,
-                   "test message", IOTC_MQTT_QOS_AT_LEAST_ONCE, NULL, NULL);
+      uint8_t publish_id = 0;
+      for (; publish_id < fixture->manual_publish_count; ++publish_id) {
+        iotc_publish(iotc_context_handle, fixture->test_topic_name,
+                     "test message", fixture->manual_publish_qos,
+                     &tls_error_on_publish_finished, fixture);
+      }
     }
 
     if (do_disconnect_flag &&
@@ -322,13 +342,7 @@ void iotc_itest_tls_error__tls_pull_PUBACK_errors__graceful_error_handling(
       expect_value(iotc_mock_broker_layer_push, in_out_state,
                    IOTC_STATE_WRITTEN);
 
-      /* PUBLISH HEADER*/
-      expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
-      expect_value(iotc_mock_broker_layer_push, in_out_state,
-                   IOTC_STATE_WRITTEN);
-      expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
-
-      /* PUBLISH PAYLOAD*/
+      /* PUBLISH, the payload is chained behind the header*/
       expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
       expect_value(iotc_mock_broker_layer_push, in_out_state,
                    IOTC_STATE_WRITTEN);
@@ -837,12 +851,6 @@ void iotc_itest_tls_error__tls_push_PUBLISH_errors__graceful_error_handling(
                    IOTC_STATE_WRITTEN);
       expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
 
-      expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
-      will_return_count(iotc_mock_broker_layer_push, CONTROL_CONTINUE, 2);
-      expect_value(iotc_mock_broker_layer_push, in_out_state,
-                   IOTC_STATE_WRITTEN);
-      expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
-
       /* PUBLISH message arrives at mock broker*/
       expect_value(iotc_mock_broker_layer_pull, in_out_state, IOTC_STATE_OK);
       expect_value(iotc_mock_broker_layer_pull, recvd_msg_type,
@@ -987,11 +995,6 @@ void iotc_itest_tls_error__connection_flow__basic_checks(void** fixture_void) {
   expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
   expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
 
-  /* PUBLISH PAYLOAD*/
-  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
-  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
-  expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
-
   /* PUBLISH message arrives at mock broker*/
   expect_value(iotc_mock_broker_layer_pull, in_out_state, IOTC_STATE_OK);
   expect_value(iotc_mock_broker_layer_pull, recvd_msg_type,
@@ -1027,3 +1030,101 @@ void iotc_itest_tls_error__connection_flow__basic_checks(void** fixture_void) {
 
   iotc_itest_tls_error__act(fixture_void, 1, 1);
 }
+
+void iotc_itest_tls_error__publish_coalescing__QoS0_PUBLISHes_written_at_once(
+    void** fixture_void) {
+  iotc_itest_tls_error__test_fixture_t* const fixture =
+      (iotc_itest_tls_error__test_fixture_t*)*fixture_void;
+
+  fixture->manual_publish_qos = IOTC_MQTT_QOS_AT_MOST_ONCE;
+  fixture->manual_publish_count = 3;
+
+  iotc_set_publish_coalescing(IOTC_PUBLISH_COALESCING_MAX_BYTES, 1);
+  iotc_reset_io_stats();
+
+  /* one call for mock broker layer chain init*/
+  expect_value(iotc_mock_broker_layer_init, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_layer_tls_prev_init, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_layer_tls_prev_connect, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_connect, in_out_state, IOTC_STATE_OK);
+
+  expect_value(iotc_mock_broker_layer_init, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_connect, in_out_state, IOTC_STATE_OK);
+
+  /* CONNECT*/
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
+  expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
+
+  expect_value(iotc_mock_broker_layer_pull, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_pull, recvd_msg_type,
+               IOTC_MQTT_TYPE_CONNECT);
+
+  /* CONNACK sent*/
+  expect_value(iotc_mock_broker_secondary_layer_push, in_out_state,
+               IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
+
+  /* SUBSCRIBE on a control topic*/
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
+  expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
+
+  expect_value(iotc_mock_broker_layer_pull, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_pull, recvd_msg_type,
+               IOTC_MQTT_TYPE_SUBSCRIBE);
+  expect_any(iotc_mock_broker_layer_pull, subscribe_topic_name);
+
+  /* SUBACK sent*/
+  expect_value(iotc_mock_broker_secondary_layer_push, in_out_state,
+               IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
+
+  /* the three PUBLISHes leave in a single push*/
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
+  expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
+
+  uint8_t publish_id = 0;
+  for (; publish_id < fixture->manual_publish_count; ++publish_id) {
+    expect_value(iotc_mock_broker_layer_pull, in_out_state, IOTC_STATE_OK);
+    expect_value(iotc_mock_broker_layer_pull, recvd_msg_type,
+                 IOTC_MQTT_TYPE_PUBLISH);
+#ifdef IOTC_MANGLE_TOPIC
+    expect_string(iotc_mock_broker_layer_pull, publish_topic_name,
+                  fixture->test_full_topic_name);
+#else
+    expect_string(iotc_mock_broker_layer_pull, publish_topic_name,
+                  fixture->test_topic_name);
+#endif
+  }
+
+  /* DISCONNECT*/
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_push, in_out_state, IOTC_STATE_WRITTEN);
+  expect_value(iotc_mock_layer_tls_prev_push, in_out_state, IOTC_STATE_OK);
+
+  expect_value(iotc_mock_broker_layer_close, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_close, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_layer_tls_prev_close, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_layer_tls_prev_close_externally, in_out_state,
+               IOTC_STATE_OK);
+
+  expect_value(iotc_mock_broker_layer_pull, in_out_state, IOTC_STATE_OK);
+  expect_value(iotc_mock_broker_layer_pull, recvd_msg_type,
+               IOTC_MQTT_TYPE_DISCONNECT);
+
+  iotc_itest_tls_error__act(fixture_void, 1, 1);
+
+  iotc_set_publish_coalescing(0, 0);
+
+  /* the users learn about the batched PUBLISHes once the batch is written */
+  assert_int_equal(fixture->manual_publish_delivered,
+                   fixture->manual_publish_count);
+
+  /* CONNECT, SUBSCRIBE, the PUBLISHes and DISCONNECT, plus CONNACK and SUBACK
+   * from the mock broker which shares the codec */
+  iotc_io_stats_t stats;
+  iotc_get_io_stats(&stats);
+  assert_int_equal(stats.messages_sent, 5 + fixture->manual_publish_count);
+}
@@ -45,6 +45,9 @@ iotc_itest_tls_error__tls_pull_SUBACK_errors__graceful_error_handling(
 extern void
 iotc_itest_tls_error__tls_pull_PUBACK_errors__graceful_error_handling(
     void** state);
+extern void
+iotc_itest_tls_error__publish_coalescing__QoS0_PUBLISHes_written_at_once(
+    void** state);
 
 #ifdef IOTC_MOCK_TEST_PREPROCESSOR_RUN
 struct CMUnitTest iotc_itests_tls_error[] = {
@@ -74,6 +77,9 @@ struct CMUnitTest iotc_itests_tls_error[] = {
         iotc_itest_tls_error_setup, iotc_itest_tls_error_teardown),
     cmocka_unit_test_setup_teardown(
         iotc_itest_tls_error__tls_pull_PUBACK_errors__graceful_error_handling,
+        iotc_itest_tls_error_setup, iotc_itest_tls_error_teardown),
+    cmocka_unit_test_setup_teardown(
+        iotc_itest_tls_error__publish_coalescing__QoS0_PUBLISHes_written_at_once,
         iotc_itest_tls_error_setup, iotc_itest_tls_error_teardown)};
 #endif
 
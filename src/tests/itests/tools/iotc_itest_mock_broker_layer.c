@@ -58,6 +58,22 @@ iotc_mock_broker_layer__check_expected__MQTT_LEVEL() {
 /* next layer is not null only for the SUT layerchain */
 #define IS_MOCK_BROKER_LAYER_CHAIN (NULL == IOTC_NEXT_LAYER(context))
 
+/* the codec chains PUBLISH payloads behind the header, the receiving codec
+ * expects them in one buffer the same way the network delivers them */
+static iotc_data_desc_t* iotc_mock_broker_copy_chain(
+    const iotc_data_desc_t* orig) {
+  iotc_data_desc_t* copy =
+      iotc_make_desc_from_buffer_copy(orig->data_ptr, orig->length);
+
+  const iotc_data_desc_t* part = orig->__next;
+  for (; NULL != copy && NULL != part; part = part->__next) {
+    iotc_data_desc_append_data_resize(copy, (const char*)part->data_ptr,
+                                      part->length);
+  }
+
+  return copy;
+}
+
 iotc_state_t iotc_mock_broker_layer_push(void* context, void* data,
                                          iotc_state_t in_out_state) {
   IOTC_LAYER_FUNCTION_PRINT_FUNCTION_DIGEST();
@@ -69,7 +85,7 @@ iotc_state_t iotc_mock_broker_layer_push(void* context, void* data,
 
   if (control != CONTROL_CONTINUE) {
     iotc_data_desc_t* buffer = (iotc_data_desc_t*)data;
-    iotc_free_desc(&buffer);
+    iotc_free_desc_chain(&buffer);
 
     in_out_state = iotc_mock_broker_layer_push__ERROR_CHANNEL();
 
@@ -80,8 +96,7 @@ iotc_state_t iotc_mock_broker_layer_push(void* context, void* data,
     /* duplicate the received data since it will be forwarded in two directions
      */
     iotc_data_desc_t* orig = (iotc_data_desc_t*)data;
-    iotc_data_desc_t* copy =
-        iotc_make_desc_from_buffer_copy(orig->data_ptr, orig->length);
+    iotc_data_desc_t* copy = iotc_mock_broker_copy_chain(orig);
 
     /* forward to mockbroker layerchain, note the PUSH to PULL conversion */
     iotc_evtd_execute_in(
@@ -331,7 +346,7 @@ iotc_state_t iotc_mock_broker_secondary_layer_push(void* context, void* data,
 
   if (control == CONTROL_ERROR) {
     iotc_data_desc_t* buffer = (iotc_data_desc_t*)data;
-    iotc_free_desc(&buffer);
+    iotc_free_desc_chain(&buffer);
 
     in_out_state = mock_type(iotc_state_t);
 
@@ -353,11 +368,10 @@ iotc_state_t iotc_mock_broker_secondary_layer_push(void* context, void* data,
      * by the network as well. This is required for PUBLISH payloads which are
      * not copied between layers */
     iotc_data_desc_t* orig = (iotc_data_desc_t*)data;
-    iotc_data_desc_t* copy =
-        iotc_make_desc_from_buffer_copy(orig->data_ptr, orig->length);
+    iotc_data_desc_t* copy = iotc_mock_broker_copy_chain(orig);
 
     /* data_desc deallocation is done by the real IO layer too */
-    iotc_free_desc(&orig);
+    iotc_free_desc_chain(&orig);
 
     /* jump to SUT libiotc's codec layer pull function, mimicing incoming
      * encoded message */
@@ -44,7 +44,7 @@ iotc_state_t iotc_mock_layer_mqttlogic_prev_push(void* context, void* data,
     check_expected(data);
 
     iotc_mqtt_written_data_t* written_data =
-        iotc_alloc_make_tuple(iotc_mqtt_written_data_t, msg_id, msg_type);
+        iotc_alloc_make_tuple(iotc_mqtt_written_data_t, msg_id, msg_type, NULL);
 
     iotc_mqtt_message_free(&msg);
 
@@ -174,7 +174,7 @@ int main(int argc, char const* argv[]) {
   // do a single step on driver's evtd to start control
   // channel connect before doing first empty select 1sec blocking
   iotc_evtd_step(libiotc_driver->context->context_data.evtd_instance,
-                 iotc_bsp_time_getcurrenttime_seconds());
+                 iotc_bsp_time_getmonotonictime_milliseconds());
 
   iotc_evtd_instance_t* evtd_all[2] = {
       iotc_globals.evtd_instance,
@@ -191,9 +191,9 @@ int main(int argc, char const* argv[]) {
     // driver->libiotc and
     // driver->libiotc->driver requests (avoiding select timeout between)
     iotc_evtd_step(iotc_globals.evtd_instance,
-                   iotc_bsp_time_getcurrenttime_seconds());
+                   iotc_bsp_time_getmonotonictime_milliseconds());
     iotc_evtd_step(libiotc_driver->context->context_data.evtd_instance,
-                   iotc_bsp_time_getcurrenttime_seconds());
+                   iotc_bsp_time_getmonotonictime_milliseconds());
   }
 
   iotc_libiotc_driver_destroy_instance(&libiotc_driver);
@@ -20,163 +20,78 @@
 #include "tinytest_macros.h"
 
 #include "iotc.h"
-#include "iotc_backoff_lut_config.h"
 #include "iotc_backoff_status_api.h"
+#include "iotc_config.h"
 #include "iotc_globals.h"
+#include "iotc_handle.h"
 #include "iotc_helpers.h"
 
 #include <iotc_error.h>
 
-#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
-static const iotc_vector_elem_t iotc_utest_backoff_lut_test_1[] = {
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(1))};
-
-static const iotc_vector_elem_t iotc_utest_decay_lut_test_1[] = {
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(123))};
-
-static const iotc_vector_elem_t iotc_utest_backoff_lut_test_2[] = {
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(2)),
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(4)),
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(8)),
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(16))};
-
-static const iotc_vector_elem_t iotc_utest_decay_lut_test_2[] = {
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(2)),
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(4)),
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(8)),
-    IOTC_VEC_ELEM(IOTC_VEC_VALUE_UI32(30))};
-
-typedef struct iotc_utest_backoff_data_test_case_s {
-  const iotc_vector_elem_t* backoff_data;
-  const iotc_vector_elem_t* decay_data;
-  size_t data_len;
-} iotc_utest_backoff_data_test_case_t;
-
-static const iotc_utest_backoff_data_test_case_t
-    iotc_utest_backoff_test_cases[] = {
-        {IOTC_BACKOFF_LUT, IOTC_DECAY_LUT, IOTC_ARRAYSIZE(IOTC_BACKOFF_LUT)},
-        {iotc_utest_backoff_lut_test_1, iotc_utest_decay_lut_test_1,
-         IOTC_ARRAYSIZE(iotc_utest_backoff_lut_test_1)},
-        {iotc_utest_backoff_lut_test_2, iotc_utest_decay_lut_test_2,
-         IOTC_ARRAYSIZE(iotc_utest_backoff_lut_test_2)}};
-
-void iotc__utest__reset_backoff_penalty() {
-  iotc_globals.backoff_status.backoff_lut_i = 0;
-  iotc_cancel_backoff_event();
-}
+static const iotc_backoff_policy_t iotc_utest_backoff_policies[] = {
+    {IOTC_BACKOFF_BASE_MS, IOTC_BACKOFF_CAP_MS, IOTC_BACKOFF_DECAY_MS},
+    {1, 1, 123},
+    {2000, 16000, 2000},
+    {100, 100000, 30000}};
 
 #endif
 
 IOTC_TT_TESTGROUP_BEGIN(utest_backoff)
 
-IOTC_TT_TESTCASE(utest__backoff_and_decay_lut_sizes__no_data__must_be_equal, {
-  tt_int_op(IOTC_ARRAYSIZE(IOTC_BACKOFF_LUT), ==,
-            IOTC_ARRAYSIZE(IOTC_DECAY_LUT));
-
-  tt_int_op(IOTC_ARRAYSIZE(iotc_utest_backoff_lut_test_1), ==,
-            IOTC_ARRAYSIZE(iotc_utest_decay_lut_test_1));
-
-  tt_int_op(IOTC_ARRAYSIZE(iotc_utest_backoff_lut_test_2), ==,
-            IOTC_ARRAYSIZE(iotc_utest_decay_lut_test_2));
-end:;
-})
-
 IOTC_TT_TESTCASE(
-    utest__iotc_backoff_configure_using_data__valid_data__must_contain_proper_data,
-    {
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
-
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        tt_ptr_op(iotc_globals.backoff_status.backoff_lut->array, !=, NULL);
-        tt_ptr_op(iotc_globals.backoff_status.backoff_lut->array, ==,
-                  curr_test_case->backoff_data);
-
-        tt_ptr_op(iotc_globals.backoff_status.decay_lut->array, !=, NULL);
-        tt_ptr_op(iotc_globals.backoff_status.decay_lut->array, ==,
-                  curr_test_case->decay_data);
-      }
-
-    end:
-      iotc_backoff_release();
-    })
-
-IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_inc_backoff_penalty__no_data__use_proper_progression,
-    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
-      iotc_context_handle_t iotc_context_handle = iotc_create_context();
-      if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
-        tt_fail_msg("Failed to create default context!");
-        return;
-      }
+    utest__iotc_backoff_set_policy__invalid_policy__policy_not_changed, {
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
+      const iotc_backoff_policy_t invalid_policies[] = {
+          {0, 1000, 1000}, {1000, 999, 1000}, {1000, 1000, 0}};
 
       size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        tt_want_int_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       ==, 0);
-        iotc_globals.backoff_status.backoff_lut_i = 0;
-
-        int i = 0;
-        for (; i < iotc_globals.backoff_status.backoff_lut->elem_no - 1; ++i) {
-          uint32_t prev_backoff_lut_i =
-              iotc_globals.backoff_status.backoff_lut_i;
-          iotc_inc_backoff_penalty();
-
-          if (curr_test_case->data_len > 1) {
-            tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, >, 0);
-          }
-
-          tt_want_int_op(prev_backoff_lut_i, <,
-                         iotc_globals.backoff_status.backoff_lut_i);
-        }
-
-        uint32_t prev_backoff_lut_i = iotc_globals.backoff_status.backoff_lut_i;
-
-        iotc_inc_backoff_penalty();
-
-        if (curr_test_case->data_len > 1) {
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, >, 0);
-        }
+      for (; i < IOTC_ARRAYSIZE(invalid_policies); ++i) {
+        tt_want_int_op(iotc_backoff_set_policy(&status, &invalid_policies[i]),
+                       ==, IOTC_INVALID_PARAMETER);
+      }
 
-        tt_want_int_op(prev_backoff_lut_i, ==,
-                       iotc_globals.backoff_status.backoff_lut_i);
+      tt_want_int_op(iotc_backoff_set_policy(&status, NULL), ==,
+                     IOTC_INVALID_PARAMETER);
 
-        iotc_globals.backoff_status.next_update.ptr_to_position = 0;
-      }
+      tt_want_int_op(status.policy.base_ms, ==, IOTC_BACKOFF_BASE_MS);
+      tt_want_int_op(status.policy.cap_ms, ==, IOTC_BACKOFF_CAP_MS);
+      tt_want_int_op(status.policy.decay_ms, ==, IOTC_BACKOFF_DECAY_MS);
+    })
 
-      iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
+IOTC_TT_TESTCASE(
+    utest__iotc_backoff_set_policy__pending_delay__delay_kept_within_bounds, {
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
+
+      const iotc_backoff_policy_t policy = {1000, 5000, 1000};
+
+      status.delay_ms = 60000;
+      tt_want_int_op(iotc_backoff_set_policy(&status, &policy), ==,
+                     IOTC_STATE_OK);
+      tt_want_int_op(status.delay_ms, ==, 5000);
+
+      status.delay_ms = 10;
+      tt_want_int_op(iotc_backoff_set_policy(&status, &policy), ==,
+                     IOTC_STATE_OK);
+      tt_want_int_op(status.delay_ms, ==, 1000);
+
+      /* no penalty stays no penalty */
+      status.delay_ms = 0;
+      tt_want_int_op(iotc_backoff_set_policy(&status, &policy), ==,
+                     IOTC_STATE_OK);
+      tt_want_int_op(status.delay_ms, ==, 0);
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_dec_backoff_penalty__no_data__use_proper_equation,
+    utest__iotc_inc_backoff_penalty__no_data__decorrelated_jitter_range,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
       iotc_context_handle_t iotc_context_handle = iotc_create_context();
       if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
@@ -184,42 +99,41 @@ IOTC_TT_TESTCASE_WITH_SETUP(
         return;
       }
 
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
       size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        size_t last_index = IOTC_ARRAYSIZE(iotc_utest_backoff_lut_test_2) - 1;
-        iotc_globals.backoff_status.backoff_lut_i = last_index;
-
-        int backoff_i = last_index;
-
-        for (; backoff_i > 0; --backoff_i) {
-          uint32_t prev_backoff_i = iotc_globals.backoff_status.backoff_lut_i;
-
-          iotc_dec_backoff_penalty();
-
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==,
-                         prev_backoff_i - 1);
+      for (; i < IOTC_ARRAYSIZE(iotc_utest_backoff_policies); ++i) {
+        const iotc_backoff_policy_t* policy = &iotc_utest_backoff_policies[i];
+        tt_int_op(iotc_backoff_set_policy(&status, policy), ==,
+                  IOTC_STATE_OK);
+
+        int j = 0;
+        for (; j < 100; ++j) {
+          const uint64_t prev_delay =
+              (0 == status.delay_ms) ? policy->base_ms : status.delay_ms;
+          const uint32_t prev_failures = status.failures;
+
+          iotc_inc_backoff_penalty(&status);
+
+          tt_int_op(status.delay_ms, >=, policy->base_ms);
+          tt_int_op(status.delay_ms, <=, policy->cap_ms);
+          tt_int_op(status.delay_ms, <=, 3 * prev_delay);
+          tt_int_op(status.failures, ==, prev_failures + 1);
+          tt_ptr_op(status.next_update.ptr_to_position, !=, NULL);
         }
 
-        tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==, 0);
+        iotc_cancel_backoff_event(&status);
+        iotc_backoff_init(&status);
       }
 
+    end:
+      iotc_cancel_backoff_event(&status);
       iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_get_backoff_penalty__check_return_value_random_range,
+    utest__iotc_inc_backoff_penalty__repeated_failures__delay_reaches_cap,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
       iotc_context_handle_t iotc_context_handle = iotc_create_context();
       if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
@@ -227,86 +141,59 @@ IOTC_TT_TESTCASE_WITH_SETUP(
         return;
       }
 
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        size_t j = 0;
-        for (; j < curr_test_case->data_len; ++j) {
-          iotc_globals.backoff_status.backoff_lut_i = j;
-
-          const iotc_backoff_lut_index_t lower_index =
-              IOTC_MAX(iotc_globals.backoff_status.backoff_lut_i - 1, 0);
-
-          const int32_t orig_value =
-              iotc_globals.backoff_status.backoff_lut
-                  ->array[iotc_globals.backoff_status.backoff_lut_i]
-                  .selector_t.ui32_value;
+      const iotc_backoff_policy_t policy = {1000, 20000, 1000};
+      tt_int_op(iotc_backoff_set_policy(&status, &policy), ==, IOTC_STATE_OK);
 
-          const uint32_t rand_range =
-              iotc_globals.backoff_status.backoff_lut->array[lower_index]
-                  .selector_t.ui32_value;
+      /* the delay is drawn at random, but it can't stay low for long */
+      uint32_t max_delay = 0;
 
-          const int32_t half_range = IOTC_MAX(rand_range / 2, 1);
-
-          int jj = 0;
-          for (; jj < 1000; ++jj) {
-            const int32_t penalty = iotc_get_backoff_penalty();
-
-            tt_int_op(penalty, <=, orig_value + half_range);
-            tt_int_op(penalty, >=, orig_value - half_range);
-          }
-        }
+      int i = 0;
+      for (; i < 1000; ++i) {
+        iotc_inc_backoff_penalty(&status);
+        max_delay = IOTC_MAX(max_delay, status.delay_ms);
       }
 
+      tt_int_op(max_delay, >, policy.cap_ms / 2);
+      tt_int_op(max_delay, <=, policy.cap_ms);
+
     end:
+      iotc_cancel_backoff_event(&status);
       iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
     })
 
-IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_cancel_backoff_event__no_data__backoff_status_clean,
-    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
-      iotc_context_handle_t iotc_context_handle = iotc_create_context();
-      if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
-        tt_fail_msg("Failed to create default context!");
-        return;
-      }
-
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
+IOTC_TT_TESTCASE(
+    utest__iotc_dec_backoff_penalty__no_data__delay_halves_until_cleared, {
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
+      const iotc_backoff_policy_t policy = {1000, 100000, 1000};
+      tt_int_op(iotc_backoff_set_policy(&status, &policy), ==, IOTC_STATE_OK);
 
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
+      status.delay_ms = 8000;
+      status.failures = 5;
 
-        iotc_globals.backoff_status.backoff_lut_i = 5;
+      iotc_dec_backoff_penalty(&status);
+      tt_int_op(status.delay_ms, ==, 4000);
+      tt_int_op(status.failures, ==, 4);
 
-        iotc_inc_backoff_penalty();
+      iotc_dec_backoff_penalty(&status);
+      iotc_dec_backoff_penalty(&status);
+      tt_int_op(status.delay_ms, ==, 1000);
+      tt_int_op(status.failures, ==, 2);
 
-        iotc_cancel_backoff_event();
+      /* below the base delay there is no penalty left */
+      iotc_dec_backoff_penalty(&status);
+      tt_int_op(status.delay_ms, ==, 0);
+      tt_int_op(status.failures, ==, 0);
 
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       ==, 0);
-      }
+      iotc_dec_backoff_penalty(&status);
+      tt_int_op(status.delay_ms, ==, 0);
+      tt_int_op(iotc_get_backoff_penalty(&status), ==, 0);
 
-      iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
+    end:;
     })
 
 IOTC_TT_TESTCASE(
@@ -355,7 +242,7 @@ IOTC_TT_TESTCASE(
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_update_backoff_penalty__iotc_state_terminal__increase_penalty,
+    utest__iotc_update_backoff_penalty__iotc_state_failure__increase_penalty,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
       iotc_context_handle_t iotc_context_handle = iotc_create_context();
       if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
@@ -363,97 +250,47 @@ IOTC_TT_TESTCASE_WITH_SETUP(
         return;
       }
 
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
+      const iotc_state_t states[] = {IOTC_MQTT_BAD_USERNAME_OR_PASSWORD,
+                                     IOTC_SOCKET_READ_ERROR};
+      const iotc_backoff_class_t classes[] = {IOTC_BACKOFF_CLASS_TERMINAL,
+                                              IOTC_BACKOFF_CLASS_RECOVERABLE};
 
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        iotc_backoff_lut_index_t curr_index =
-            iotc_globals.backoff_status.backoff_lut_i;
-
-        iotc_update_backoff_penalty(IOTC_MQTT_BAD_USERNAME_OR_PASSWORD);
-
-        tt_want_int_op(iotc_globals.backoff_status.backoff_class, ==,
-                       IOTC_BACKOFF_CLASS_TERMINAL);
-
-        if (curr_test_case->data_len > 1) {
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, >,
-                         curr_index);
-        } else {
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==,
-                         curr_index);
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==, 0);
-        }
+      size_t i = 0;
+      for (; i < IOTC_ARRAYSIZE(states); ++i) {
+        tt_want_int_op(iotc_update_backoff_penalty(&status, states[i]), ==,
+                       classes[i]);
 
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       !=, 0);
+        tt_want_int_op(status.backoff_class, ==, classes[i]);
+        tt_want_int_op(status.failures, ==, 1);
+        tt_want_int_op(status.delay_ms, >=, status.policy.base_ms);
+        tt_want_ptr_op(status.next_update.ptr_to_position, !=, 0);
 
-        iotc__utest__reset_backoff_penalty();
+        iotc_cancel_backoff_event(&status);
+        iotc_backoff_init(&status);
       }
 
       iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
     })
 
-IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_update_backoff_penalty__iotc_state_recoverable__increase_penalty,
-    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
-      iotc_context_handle_t iotc_context_handle = iotc_create_context();
-      if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
-        tt_fail_msg("Failed to create default context!");
-        return;
-      }
-
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
-
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        iotc_backoff_lut_index_t curr_index =
-            iotc_globals.backoff_status.backoff_lut_i;
-
-        iotc_update_backoff_penalty(IOTC_SOCKET_READ_ERROR);
-
-        tt_want_int_op(iotc_globals.backoff_status.backoff_class, ==,
-                       IOTC_BACKOFF_CLASS_RECOVERABLE);
-
-        if (curr_test_case->data_len > 1) {
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, >,
-                         curr_index);
-        } else {
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==,
-                         curr_index);
-          tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==, 0);
-        }
-
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       !=, 0);
+IOTC_TT_TESTCASE(
+    utest__iotc_update_backoff_penalty__iotc_state_none__none_penalty, {
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-        iotc__utest__reset_backoff_penalty();
-      }
+      tt_want_int_op(iotc_update_backoff_penalty(&status, IOTC_STATE_OK), ==,
+                     IOTC_BACKOFF_CLASS_NONE);
 
-      iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
+      tt_want_int_op(status.backoff_class, ==, IOTC_BACKOFF_CLASS_NONE);
+      tt_want_int_op(status.delay_ms, ==, 0);
+      tt_want_int_op(status.failures, ==, 0);
+      tt_want_ptr_op(status.next_update.ptr_to_position, ==, 0);
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_update_backoff_penalty__iotc_state_none__none_penalty,
+    utest__iotc_restart_update_time__no_data__update_event_registered,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
       iotc_context_handle_t iotc_context_handle = iotc_create_context();
       if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
@@ -461,40 +298,30 @@ IOTC_TT_TESTCASE_WITH_SETUP(
         return;
       }
 
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
+      tt_want_ptr_op(status.next_update.ptr_to_position, ==, 0);
 
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
+      iotc_restart_update_time(&status);
 
-        iotc_backoff_lut_index_t curr_index =
-            iotc_globals.backoff_status.backoff_lut_i;
+      tt_want_ptr_op(status.next_update.ptr_to_position, !=, 0);
 
-        iotc_update_backoff_penalty(IOTC_STATE_OK);
+      iotc_vector_index_type_t* position = status.next_update.ptr_to_position;
 
-        tt_want_int_op(iotc_globals.backoff_status.backoff_class, ==,
-                       IOTC_BACKOFF_CLASS_NONE);
-        tt_want_int_op(iotc_globals.backoff_status.backoff_lut_i, ==,
-                       curr_index);
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       ==, 0);
+      iotc_restart_update_time(&status);
 
-        iotc__utest__reset_backoff_penalty();
-      }
+      tt_want_ptr_op(status.next_update.ptr_to_position, ==, position);
+
+      iotc_cancel_backoff_event(&status);
+
+      tt_want_ptr_op(status.next_update.ptr_to_position, ==, 0);
 
       iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_restart_update_time__no_data__update_event_registered,
+    utest__iotc_apply_cooldown__connection_failing__penalty_kept,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
       iotc_context_handle_t iotc_context_handle = iotc_create_context();
       if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
@@ -504,46 +331,26 @@ IOTC_TT_TESTCASE_WITH_SETUP(
 
       iotc_evtd_instance_t* event_dispatcher = iotc_globals.evtd_instance;
 
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
-
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       ==, 0);
+      iotc_update_backoff_penalty(&status, IOTC_MQTT_NOT_AUTHORIZED);
 
-        iotc_restart_update_time(event_dispatcher);
+      const uint32_t delay_ms = status.delay_ms;
 
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       !=, 0);
+      iotc_evtd_step(event_dispatcher, event_dispatcher->current_step +
+                                           status.policy.decay_ms + 1);
 
-        iotc_time_event_handle_t* backoff_handler =
-            &iotc_globals.backoff_status.next_update;
-
-        iotc_restart_update_time(event_dispatcher);
-
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       ==, backoff_handler->ptr_to_position);
-        tt_want_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                       !=, NULL);
-
-        iotc__utest__reset_backoff_penalty();
-      }
+      tt_int_op(status.delay_ms, ==, delay_ms);
+      tt_ptr_op(status.next_update.ptr_to_position, !=, NULL);
 
+    end:
+      iotc_cancel_backoff_event(&status);
       iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_update_backoff_penalty_time__no_data__update_update_time_and_no_backoff_penalty,
+    utest__iotc_apply_cooldown__connection_healthy__penalty_decays,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
       iotc_context_handle_t iotc_context_handle = iotc_create_context();
       if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
@@ -552,148 +359,93 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       }
 
       iotc_evtd_instance_t* event_dispatcher = iotc_globals.evtd_instance;
-      tt_int_op(iotc_globals.backoff_status.backoff_lut_i, ==, 0);
-
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
-
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
 
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
+      iotc_backoff_status_t status;
+      iotc_backoff_init(&status);
 
-        iotc_inc_backoff_penalty();
+      const iotc_backoff_policy_t policy = {1000, 1000, 500};
+      tt_int_op(iotc_backoff_set_policy(&status, &policy), ==, IOTC_STATE_OK);
 
-        iotc_globals.backoff_status.backoff_class = IOTC_BACKOFF_CLASS_TERMINAL;
+      iotc_update_backoff_penalty(&status, IOTC_SOCKET_READ_ERROR);
+      tt_int_op(status.delay_ms, ==, 1000);
 
-        iotc_vector_index_type_t* backoff_time_event_position =
-            iotc_globals.backoff_status.next_update.ptr_to_position;
+      /* the next connection succeeds */
+      status.backoff_class = IOTC_BACKOFF_CLASS_NONE;
 
-        iotc_backoff_lut_index_t curr_index =
-            iotc_globals.backoff_status.backoff_lut_i;
+      iotc_evtd_step(event_dispatcher,
+                     event_dispatcher->current_step + policy.decay_ms + 1);
 
-        iotc_evtd_step(
-            event_dispatcher,
-            event_dispatcher->current_step +
-                iotc_globals.backoff_status.decay_lut->array[curr_index]
-                    .selector_t.ui32_value +
-                1);
-
-        tt_int_op(iotc_globals.backoff_status.backoff_lut_i, ==, curr_index);
-
-        if (curr_test_case->data_len > 1) {
-          tt_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position, !=,
-                    NULL);
-        } else {
-          tt_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position, ==,
-                    NULL);
-        }
-
-        tt_ptr_op(&iotc_globals.backoff_status.next_update.ptr_to_position, !=,
-                  backoff_time_event_position);
-
-        iotc__utest__reset_backoff_penalty();
-      }
+      tt_int_op(status.delay_ms, ==, 0);
+      tt_int_op(status.failures, ==, 0);
+      tt_ptr_op(status.next_update.ptr_to_position, ==, NULL);
 
     end:
-      iotc__utest__reset_backoff_penalty();
+      iotc_cancel_backoff_event(&status);
       iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_update_backoff_penalty_time__no_data__update_update_time_and_backoff_penalty,
+    utest__iotc_get_backoff_state__penalty_on_one_context__other_context_unaffected,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
-      iotc_context_handle_t iotc_context_handle = iotc_create_context();
-      if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
-        tt_fail_msg("Failed to create default context!");
-        return;
-      }
-
-      iotc_evtd_instance_t* event_dispatcher = iotc_globals.evtd_instance;
-      size_t itests = IOTC_ARRAYSIZE(iotc_utest_backoff_test_cases);
-
-      size_t i = 0;
-      for (; i < itests; ++i) {
-        const iotc_utest_backoff_data_test_case_t* curr_test_case =
-            (iotc_utest_backoff_data_test_case_t*)&iotc_utest_backoff_test_cases
-                [i];
-
-        iotc_backoff_configure_using_data(
-            (iotc_vector_elem_t*)curr_test_case->backoff_data,
-            (iotc_vector_elem_t*)curr_test_case->decay_data,
-            curr_test_case->data_len, IOTC_MEMORY_TYPE_UNMANAGED);
-
-        iotc_inc_backoff_penalty();
+      iotc_context_handle_t failing_handle = iotc_create_context();
+      iotc_context_handle_t healthy_handle = iotc_create_context();
 
-        iotc_globals.backoff_status.backoff_class = IOTC_BACKOFF_CLASS_NONE;
+      iotc_context_t* failing = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, failing_handle);
+      tt_assert(NULL != failing);
 
-        iotc_vector_index_type_t* backoff_time_event_position =
-            iotc_globals.backoff_status.next_update.ptr_to_position;
+      iotc_update_backoff_penalty(&failing->context_data.backoff_status,
+                                  IOTC_SOCKET_READ_ERROR);
 
-        iotc_backoff_lut_index_t curr_index =
-            iotc_globals.backoff_status.backoff_lut_i;
+      iotc_backoff_state_t state;
+      memset(&state, 0, sizeof(state));
 
-        iotc_evtd_step(
-            event_dispatcher,
-            event_dispatcher->current_step +
-                iotc_globals.backoff_status.decay_lut->array[curr_index]
-                    .selector_t.ui32_value +
-                1);
+      tt_int_op(iotc_get_backoff_state(failing_handle, &state), ==,
+                IOTC_STATE_OK);
+      tt_int_op(state.delay_ms, >=, IOTC_BACKOFF_BASE_MS);
+      tt_int_op(state.failures, ==, 1);
+      tt_int_op(state.in_backoff, !=, 0);
 
-        if (curr_test_case->data_len > 1) {
-          tt_int_op(iotc_globals.backoff_status.backoff_lut_i, <, curr_index);
-        } else {
-          tt_int_op(iotc_globals.backoff_status.backoff_lut_i, ==, 0);
-        }
-
-        tt_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position, ==,
-                  NULL);
-        tt_ptr_op(iotc_globals.backoff_status.next_update.ptr_to_position, !=,
-                  backoff_time_event_position);
+      tt_int_op(iotc_get_backoff_state(healthy_handle, &state), ==,
+                IOTC_STATE_OK);
+      tt_int_op(state.delay_ms, ==, 0);
+      tt_int_op(state.failures, ==, 0);
+      tt_int_op(state.in_backoff, ==, 0);
 
-        iotc__utest__reset_backoff_penalty();
-      }
+      tt_int_op(iotc_get_backoff_state(healthy_handle, NULL), ==,
+                IOTC_INVALID_PARAMETER);
 
     end:
-      iotc__utest__reset_backoff_penalty();
-      iotc_delete_context(iotc_context_handle);
-      iotc_backoff_release();
+      iotc_delete_context(healthy_handle);
+      iotc_delete_context(failing_handle);
     })
 
 IOTC_TT_TESTCASE_WITH_SETUP(
-    utest__iotc_context__no_data__after_restarting_iotc_context_penalty_must_not_be_changed,
+    utest__iotc_set_backoff_policy__valid_policy__applies_to_context_only,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
-      // initialize xi library.
-      iotc_context_handle_t iotc_context_handle = iotc_create_context();
-      if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
-        tt_fail_msg("Failed to create default context!");
-        return;
-      }
+      iotc_context_handle_t first_handle = iotc_create_context();
+      iotc_context_handle_t second_handle = iotc_create_context();
 
-      iotc_inc_backoff_penalty();
+      const iotc_backoff_policy_t policy = {100, 200, 300};
 
-      iotc_backoff_lut_index_t curr_index =
-          iotc_globals.backoff_status.backoff_lut_i;
+      tt_int_op(iotc_set_backoff_policy(first_handle, &policy), ==,
+                IOTC_STATE_OK);
+      tt_int_op(iotc_set_backoff_policy(IOTC_INVALID_CONTEXT_HANDLE, &policy),
+                ==, IOTC_INVALID_PARAMETER);
 
-      iotc_delete_context(iotc_context_handle);
-
-      iotc_context_handle = iotc_create_context();
-      if (IOTC_INVALID_CONTEXT_HANDLE >= iotc_context_handle) {
-        tt_fail_msg("Failed to create default context!");
-        return;
-      }
+      iotc_context_t* first = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, first_handle);
+      iotc_context_t* second = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, second_handle);
+      tt_assert(NULL != first && NULL != second);
 
-      tt_want_int_op(curr_index, ==, iotc_globals.backoff_status.backoff_lut_i);
-      tt_want_int_op(iotc_globals.backoff_status.next_update.ptr_to_position,
-                     ==, NULL);
+      tt_int_op(first->context_data.backoff_status.policy.cap_ms, ==, 200);
+      tt_int_op(second->context_data.backoff_status.policy.cap_ms, ==,
+                IOTC_BACKOFF_CAP_MS);
 
-      iotc_delete_context(iotc_context_handle);
+    end:
+      iotc_delete_context(second_handle);
+      iotc_delete_context(first_handle);
     })
 
 IOTC_TT_TESTGROUP_END
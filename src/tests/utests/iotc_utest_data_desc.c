@@ -36,6 +36,21 @@
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
+typedef struct utest_data_desc_release_s {
+  const uint8_t* buffer;
+  size_t len;
+  int calls;
+} utest_data_desc_release_t;
+
+static void utest_data_desc_release(const uint8_t* buffer, size_t len,
+                                    void* user_data) {
+  utest_data_desc_release_t* release = (utest_data_desc_release_t*)user_data;
+
+  release->buffer = buffer;
+  release->len = len;
+  ++release->calls;
+}
+
 #endif
 
 IOTC_TT_TESTGROUP_BEGIN(utest_data_desc)
@@ -717,6 +732,84 @@ IOTC_TT_TESTCASE(
       tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
     })
 
+IOTC_TT_TESTCASE(
+    utest__iotc_make_empty_desc_alloc_inline__append_beyond_capacity__moves_to_managed_buffer,
+    {
+      iotc_data_desc_t* desc = iotc_make_empty_desc_alloc_inline(4);
+      tt_want_ptr_op(desc, !=, NULL);
+
+      if (NULL != desc) {
+        tt_want_ptr_op(desc->data_ptr, ==, (uint8_t*)(desc + 1));
+        tt_want_uint_op(desc->capacity, ==, 4);
+        tt_want_uint_op(desc->length, ==, 0);
+
+        tt_want_int_op(iotc_data_desc_append_data_resize(desc, "abcd", 4), ==,
+                       IOTC_STATE_OK);
+        tt_want_ptr_op(desc->data_ptr, ==, (uint8_t*)(desc + 1));
+
+        tt_want_int_op(iotc_data_desc_append_data_resize(desc, "efgh", 4), ==,
+                       IOTC_STATE_OK);
+        tt_want_ptr_op(desc->data_ptr, !=, (uint8_t*)(desc + 1));
+        tt_want_int_op(desc->memory_type, ==, IOTC_MEMORY_TYPE_MANAGED);
+        tt_want_int_op(memcmp(desc->data_ptr, "abcdefgh", 8), ==, 0);
+
+        iotc_free_desc(&desc);
+      }
+
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+
+IOTC_TT_TESTCASE(
+    utest__iotc_free_desc_chain__managed_and_shared_parts__all_released, {
+      unsigned char payload[] = "payload";
+
+      iotc_data_desc_t* header = iotc_make_empty_desc_alloc(2);
+      tt_want_ptr_op(header, !=, NULL);
+
+      if (NULL != header) {
+        header->__next =
+            iotc_make_desc_from_buffer_share(payload, sizeof(payload));
+        tt_want_ptr_op(header->__next, !=, NULL);
+
+        iotc_free_desc_chain(&header);
+        tt_want_ptr_op(header, ==, NULL);
+      }
+
+      /* shared memory stays untouched */
+      tt_want_int_op(memcmp(payload, "payload", sizeof(payload)), ==, 0);
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+
+IOTC_TT_TESTCASE(
+    utest__iotc_make_desc_from_buffer_borrow__free_desc__buffer_released_once, {
+      unsigned char payload[] = "payload";
+      utest_data_desc_release_t release = {NULL, 0, 0};
+
+      iotc_data_desc_t* desc = iotc_make_desc_from_buffer_borrow(
+          payload, sizeof(payload), &utest_data_desc_release, &release);
+      tt_want_ptr_op(desc, !=, NULL);
+
+      if (NULL != desc) {
+        tt_want_int_op(desc->memory_type, ==, IOTC_MEMORY_TYPE_BORROWED);
+        tt_want_int_op(desc->length, ==, sizeof(payload));
+
+        /* borrowed memory cannot grow */
+        tt_want_int_op(
+            iotc_data_desc_realloc(desc, 2 * sizeof(payload),
+                                   &iotc_data_desc_pow2_realloc_strategy),
+            ==, IOTC_INVALID_PARAMETER);
+        tt_want_int_op(release.calls, ==, 0);
+
+        iotc_free_desc(&desc);
+        tt_want_ptr_op(desc, ==, NULL);
+      }
+
+      tt_want_int_op(release.calls, ==, 1);
+      tt_want_ptr_op(release.buffer, ==, payload);
+      tt_want_int_op(release.len, ==, sizeof(payload));
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -430,6 +430,36 @@ IOTC_TT_TESTCASE(test_vector_remove_if_PTR, {
   tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
 })
 
+#if IOTC_VECTOR_INDEX_WIDTH != 32
+IOTC_TT_TESTCASE(test_vector_push_beyond_index_max_fails, {
+  iotc_vector_t* sv = iotc_vector_create();
+
+  tt_assert(sv != 0);
+
+  int32_t i = 0;
+  for (; i < IOTC_VECTOR_INDEX_MAX; ++i) {
+    tt_assert(NULL != iotc_vector_push(sv, IOTC_VEC_CONST_VALUE_PARAM(
+                                               IOTC_VEC_VALUE_I32(i))));
+  }
+
+  tt_want_int_op(sv->capacity, ==, IOTC_VECTOR_INDEX_MAX);
+  tt_want_int_op(sv->elem_no, ==, IOTC_VECTOR_INDEX_MAX);
+
+  tt_want_ptr_op(NULL, ==,
+                 iotc_vector_push(sv, IOTC_VEC_CONST_VALUE_PARAM(
+                                          IOTC_VEC_VALUE_I32(i))));
+  tt_want_int_op(sv->elem_no, ==, IOTC_VECTOR_INDEX_MAX);
+  tt_want_int_op(
+      iotc_vector_find(sv, IOTC_VEC_CONST_VALUE_PARAM(IOTC_VEC_VALUE_I32(i - 1)),
+                       &utest_datastructures_cmp_vector_i32),
+      ==, IOTC_VECTOR_INDEX_MAX - 1);
+
+end:;
+  iotc_vector_destroy(sv);
+  tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+})
+#endif
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -27,6 +27,12 @@
 #include "tinytest_macros.h"
 
 #include "iotc_event_dispatcher_api.h"
+#include "iotc_event_loop.h"
+
+#ifdef IOTC_PLATFORM_BASE_POSIX
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
@@ -52,6 +58,16 @@ iotc_state_t continuation1_3(iotc_event_handle_arg1_t a) {
   return 0;
 }
 
+#define TEST_CALL_ORDER_SIZE (3 * IOTC_EVTD_CALL_QUEUE_NODES)
+
+static uint32_t g_call_order[TEST_CALL_ORDER_SIZE];
+static uint32_t g_call_order_size = 0;
+
+iotc_state_t record_call_order(iotc_event_handle_arg1_t a) {
+  g_call_order[g_call_order_size++] = (uint32_t)(intptr_t)a;
+  return 0;
+}
+
 iotc_state_t continuation1_5(iotc_event_handle_arg1_t a) {
   *((uint32_t*)a) += 5;
   return 0;
@@ -125,6 +141,46 @@ void test_time_overflow_function(void) {
 end:;
 }
 
+/* a poller only takes descriptors that exist, e.g. epoll rejects the others,
+ * so the socket tests register real sockets where there are any */
+#ifdef IOTC_PLATFORM_BASE_POSIX
+static int utest_evtd_sockets[4] = {-1, -1, -1, -1};
+
+static int utest_evtd_open_sockets(iotc_fd_t* fds) {
+  if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, utest_evtd_sockets) ||
+      0 != socketpair(AF_UNIX, SOCK_STREAM, 0, utest_evtd_sockets + 2)) {
+    return 0;
+  }
+
+  fds[0] = utest_evtd_sockets[0];
+  fds[1] = utest_evtd_sockets[1];
+  fds[2] = utest_evtd_sockets[2];
+
+  return 1;
+}
+
+static void utest_evtd_close_sockets(void) {
+  size_t i = 0;
+
+  for (; i < IOTC_ARRAYSIZE(utest_evtd_sockets); ++i) {
+    if (0 <= utest_evtd_sockets[i]) {
+      close(utest_evtd_sockets[i]);
+      utest_evtd_sockets[i] = -1;
+    }
+  }
+}
+#else
+static int utest_evtd_open_sockets(iotc_fd_t* fds) {
+  fds[0] = 15;
+  fds[1] = 14;
+  fds[2] = 12;
+
+  return 1;
+}
+
+static void utest_evtd_close_sockets(void) {}
+#endif
+
 #endif
 
 /*-----------------------------------------------------------------------*/
@@ -181,7 +237,7 @@ IOTC_TT_TESTCASE(utest__handler_processing_loop, {
 
   iotc_evtd_execute_in(evtd_g_i, evtd_handle_g, 0, NULL);
 
-  while (evtd_g_i->time_events_container->elem_no > 0) {
+  while (iotc_time_event_container_size(evtd_g_i->time_events_container) > 0) {
     iotc_evtd_step(evtd_g_i, step);
     step += 1;
     tt_assert(counter == 10u - step);
@@ -194,59 +250,135 @@ end:
   iotc_evtd_destroy_instance(evtd_g_i);
 })
 
+IOTC_TT_TESTCASE(
+    utest__iotc_evtd_execute__more_events_than_preallocated_nodes__executed_in_order,
+    {
+      evtd_g_i = iotc_evtd_create_instance();
+      g_call_order_size = 0;
+
+      uint32_t i = 0;
+      for (; i < TEST_CALL_ORDER_SIZE; ++i) {
+        tt_assert(NULL !=
+                  iotc_evtd_execute(
+                      evtd_g_i, iotc_make_handle(&record_call_order,
+                                                 (void*)(intptr_t)i)));
+      }
+
+      tt_assert(0 == iotc_event_handle_mpsc_empty(&evtd_g_i->call_queue));
+
+      iotc_evtd_step(evtd_g_i, 0);
+
+      tt_assert(1 == iotc_event_handle_mpsc_empty(&evtd_g_i->call_queue));
+      tt_int_op(TEST_CALL_ORDER_SIZE, ==, g_call_order_size);
+
+      for (i = 0; i < TEST_CALL_ORDER_SIZE; ++i) {
+        tt_int_op(i, ==, g_call_order[i]);
+      }
+
+    end:
+      iotc_evtd_destroy_instance(evtd_g_i);
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+
+IOTC_TT_TESTCASE(utest__iotc_event_handle_mpsc__idle_nodes__recycled, {
+  iotc_event_handle_mpsc_t queue;
+  tt_assert(IOTC_STATE_OK == iotc_event_handle_mpsc_init(&queue, 2));
+
+  iotc_event_handle_queue_t* a = iotc_event_handle_mpsc_alloc_node(&queue);
+  iotc_event_handle_queue_t* b = iotc_event_handle_mpsc_alloc_node(&queue);
+  iotc_event_handle_queue_t* c = iotc_event_handle_mpsc_alloc_node(&queue);
+
+  /* the first two are preallocated, the third one is not */
+  tt_assert(&queue.nodes[0] == a);
+  tt_assert(&queue.nodes[1] == b);
+  tt_assert(NULL != c);
+  tt_assert(c < queue.nodes || c >= queue.nodes + queue.nodes_count);
+
+  tt_assert(NULL == iotc_event_handle_mpsc_pop(&queue));
+
+  iotc_event_handle_mpsc_push(&queue, b);
+  iotc_event_handle_mpsc_push(&queue, c);
+  iotc_event_handle_mpsc_push(&queue, a);
+
+  tt_assert(b == iotc_event_handle_mpsc_pop(&queue));
+  tt_assert(c == iotc_event_handle_mpsc_pop(&queue));
+  tt_assert(0 == iotc_event_handle_mpsc_empty(&queue));
+  tt_assert(a == iotc_event_handle_mpsc_pop(&queue));
+  tt_assert(1 == iotc_event_handle_mpsc_empty(&queue));
+  tt_assert(NULL == iotc_event_handle_mpsc_pop(&queue));
+
+  iotc_event_handle_mpsc_free_node(&queue, b);
+  iotc_event_handle_mpsc_free_node(&queue, c);
+
+  tt_assert(b == iotc_event_handle_mpsc_alloc_node(&queue));
+
+  iotc_event_handle_mpsc_free_node(&queue, a);
+  iotc_event_handle_mpsc_free_node(&queue, b);
+
+end:
+  iotc_event_handle_mpsc_destroy(&queue);
+  tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+})
+
 IOTC_TT_TESTCASE(utest__register_fd, {
+  iotc_fd_t fds[3] = {-1, -1, -1};
+
   evtd_g_i = iotc_evtd_create_instance();
+  tt_assert(utest_evtd_open_sockets(fds));
 
   iotc_event_handle_t handle = iotc_make_empty_handle();
 
-  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 15, handle) != 0);
+  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[0], handle) != 0);
   {
     iotc_evtd_fd_tuple_t* tmp =
         (iotc_evtd_fd_tuple_t*)evtd_g_i->handles_and_socket_fd->array[0]
             .selector_t.ptr_value;
-    tt_assert(tmp->fd == 15);
+    tt_assert(tmp->fd == fds[0]);
     tt_assert(tmp->event_type == IOTC_EVENT_WANT_READ);
   }
 
-  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 14, handle));
+  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[1], handle));
   {
     iotc_evtd_fd_tuple_t* tmp =
         (iotc_evtd_fd_tuple_t*)evtd_g_i->handles_and_socket_fd->array[1]
             .selector_t.ptr_value;
-    tt_assert(tmp->fd == 14);
+    tt_assert(tmp->fd == fds[1]);
     tt_assert(tmp->event_type == IOTC_EVENT_WANT_READ);
   }
 
-  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 12, handle));
+  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[2], handle));
   {
     iotc_evtd_fd_tuple_t* tmp =
         (iotc_evtd_fd_tuple_t*)evtd_g_i->handles_and_socket_fd->array[2]
             .selector_t.ptr_value;
-    tt_assert(tmp->fd == 12);
+    tt_assert(tmp->fd == fds[2]);
     tt_assert(tmp->event_type == IOTC_EVENT_WANT_READ);
   }
 
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 12);
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 15);
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 14);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[2]);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[0]);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[1]);
 
 end:
   iotc_evtd_destroy_instance(evtd_g_i);
+  utest_evtd_close_sockets();
 })
 
 IOTC_TT_TESTCASE(utest__evtd_updates, {
   uint32_t counter = 0;
+  iotc_fd_t fds[3] = {-1, -1, -1};
 
   evtd_g_i = iotc_evtd_create_instance();
+  tt_assert(utest_evtd_open_sockets(fds));
 
   {
     iotc_event_handle_t evtd_handle = {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_1, (iotc_event_handle_arg1_t)&counter}};
 
-    tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 15, evtd_handle) != 0);
-    tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 14, evtd_handle) != 0);
-    tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 12, evtd_handle) != 0);
+    tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[0], evtd_handle) != 0);
+    tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[1], evtd_handle) != 0);
+    tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[2], evtd_handle) != 0);
   }
 
   {
@@ -254,7 +386,7 @@ IOTC_TT_TESTCASE(utest__evtd_updates, {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_1, (iotc_event_handle_arg1_t)&counter}};
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_WANT_READ,
-                                          evtd_handle, 15);
+                                          evtd_handle, fds[0]);
 
     iotc_evtd_fd_tuple_t* tmp =
         (iotc_evtd_fd_tuple_t*)evtd_g_i->handles_and_socket_fd->array[0]
@@ -271,7 +403,7 @@ IOTC_TT_TESTCASE(utest__evtd_updates, {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_3, (iotc_event_handle_arg1_t)&counter}};
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_WANT_WRITE,
-                                          evtd_handle, 14);
+                                          evtd_handle, fds[1]);
 
     iotc_evtd_fd_tuple_t* tmp =
         (iotc_evtd_fd_tuple_t*)evtd_g_i->handles_and_socket_fd->array[1]
@@ -288,7 +420,7 @@ IOTC_TT_TESTCASE(utest__evtd_updates, {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_5, (iotc_event_handle_arg1_t)&counter}};
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_ERROR,
-                                          evtd_handle, 12);
+                                          evtd_handle, fds[2]);
 
     iotc_evtd_fd_tuple_t* tmp =
         (iotc_evtd_fd_tuple_t*)evtd_g_i->handles_and_socket_fd->array[2]
@@ -301,7 +433,7 @@ IOTC_TT_TESTCASE(utest__evtd_updates, {
   }
 
   tt_assert(counter == 0);
-  iotc_evtd_update_event_on_socket(evtd_g_i, 12);
+  iotc_evtd_update_event_on_socket(evtd_g_i, fds[2]);
   tt_assert(counter == 5);
 
   counter = 0;
@@ -311,12 +443,12 @@ IOTC_TT_TESTCASE(utest__evtd_updates, {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_5, (iotc_event_handle_arg1_t)&counter}};
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_ERROR,
-                                          evtd_handle, 12);
+                                          evtd_handle, fds[2]);
   }
 
   tt_assert(counter == 0);
-  iotc_evtd_update_event_on_socket(evtd_g_i, 12);
-  iotc_evtd_update_event_on_socket(evtd_g_i, 15);
+  iotc_evtd_update_event_on_socket(evtd_g_i, fds[2]);
+  iotc_evtd_update_event_on_socket(evtd_g_i, fds[0]);
   tt_assert(counter == 6);
 
   counter = 0;
@@ -326,30 +458,106 @@ IOTC_TT_TESTCASE(utest__evtd_updates, {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_5, (iotc_event_handle_arg1_t)&counter}};
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_ERROR,
-                                          evtd_handle, 12);
+                                          evtd_handle, fds[2]);
   }
   {
     iotc_event_handle_t evtd_handle = {
         IOTC_EVENT_HANDLE_ARGC1,
         .handlers.h1 = {&continuation1_3, (iotc_event_handle_arg1_t)&counter}};
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_WANT_WRITE,
-                                          evtd_handle, 14);
+                                          evtd_handle, fds[1]);
   }
 
   tt_assert(counter == 0);
-  iotc_evtd_update_event_on_socket(evtd_g_i, 12);
-  iotc_evtd_update_event_on_socket(evtd_g_i, 15);
-  iotc_evtd_update_event_on_socket(evtd_g_i, 14);
+  iotc_evtd_update_event_on_socket(evtd_g_i, fds[2]);
+  iotc_evtd_update_event_on_socket(evtd_g_i, fds[0]);
+  iotc_evtd_update_event_on_socket(evtd_g_i, fds[1]);
   tt_assert(counter == 9);
 
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 12);
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 15);
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 14);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[2]);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[0]);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[1]);
 
 end:
   iotc_evtd_destroy_instance(evtd_g_i);
+  utest_evtd_close_sockets();
 })
 
+#ifdef IOTC_PLATFORM_BASE_POSIX
+IOTC_TT_TESTCASE(
+    utest__iotc_event_loop_with_evtds__socket_ready__socket_handles_executed, {
+      int sockets[2] = {-1, -1};
+      tt_int_op(0, ==, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+      evtd_g_i = iotc_evtd_create_instance();
+      tt_assert(NULL != evtd_g_i);
+
+      uint32_t counter = 0;
+
+      tt_int_op(1, ==,
+                iotc_evtd_register_socket_fd(
+                    evtd_g_i, sockets[0],
+                    iotc_make_handle(&continuation1_1, &counter)));
+
+      /* a due time event keeps the iterations without ready sockets from
+       * blocking for the idle timeout */
+      uint32_t time_events_counter = 0;
+
+      /* nothing to read yet, the loop iteration times out */
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_evtd_execute_in(
+                    evtd_g_i,
+                    iotc_make_handle(&continuation1_1, &time_events_counter),
+                    0, NULL));
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_event_loop_with_evtds(1, &evtd_g_i, 1));
+      tt_int_op(0, ==, counter);
+
+      tt_int_op(1, ==, write(sockets[1], "x", 1));
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_event_loop_with_evtds(1, &evtd_g_i, 1));
+      tt_int_op(1, ==, counter);
+
+      /* the interest change has to reach the event loop */
+      tt_int_op(1, ==,
+                iotc_evtd_continue_when_evt_on_socket(
+                    evtd_g_i, IOTC_EVENT_WANT_WRITE,
+                    iotc_make_handle(&continuation1_3, &counter),
+                    sockets[0]));
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_event_loop_with_evtds(1, &evtd_g_i, 1));
+      tt_int_op(4, ==, counter);
+
+      /* and after the write handle the socket is back to the read handle */
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_event_loop_with_evtds(1, &evtd_g_i, 1));
+      tt_int_op(5, ==, counter);
+
+      tt_int_op(1, ==, iotc_evtd_unregister_socket_fd(evtd_g_i, sockets[0]));
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_evtd_execute_in(
+                    evtd_g_i,
+                    iotc_make_handle(&continuation1_1, &time_events_counter),
+                    0, NULL));
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_event_loop_with_evtds(1, &evtd_g_i, 1));
+      tt_int_op(5, ==, counter);
+      tt_int_op(2, ==, time_events_counter);
+
+      tt_assert(1 == iotc_evtd_dispatcher_continue(evtd_g_i));
+
+    end:
+      iotc_evtd_destroy_instance(evtd_g_i);
+      close(sockets[0]);
+      close(sockets[1]);
+
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+#endif
+
 /* skipped because this feature is not yet implemented */
 SKIP_IOTC_TT_TESTCASE(
     utest__iotc_evtd__events_to_call_added__overlap_timer__proper_events_executed,
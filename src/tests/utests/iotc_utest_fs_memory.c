@@ -18,6 +18,7 @@
 #include "tinytest.h"
 #include "tinytest_macros.h"
 
+#include "iotc_config.h"
 #include "iotc_fs_api.h"
 #include "iotc_fs_filenames.h"
 #include "iotc_fs_header.h"
@@ -33,6 +34,39 @@
 #include <string.h>
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+/* fills the buffer with a pattern that differs from block to block */
+static void iotc_utest_fs_memory_fill(uint8_t* buffer, size_t size,
+                                      size_t offset) {
+  size_t i = 0;
+
+  for (; i < size; ++i) {
+    buffer[i] = (uint8_t)((offset + i) * 7);
+  }
+}
+
+/* reads the whole file back chunk by chunk */
+static int iotc_utest_fs_memory_read_all(
+    iotc_fs_resource_handle_t resource_handle, uint8_t* dst, size_t size) {
+  size_t offset = 0;
+
+  while (offset < size) {
+    const uint8_t* buffer = NULL;
+    size_t buffer_size = 0;
+
+    if (IOTC_STATE_OK != iotc_fs_read(NULL, resource_handle, offset, &buffer,
+                                      &buffer_size) ||
+        0 == buffer_size || size - offset < buffer_size) {
+      return 0;
+    }
+
+    memcpy(dst + offset, buffer, buffer_size);
+    offset += buffer_size;
+  }
+
+  return 1;
+}
+
 #endif
 
 IOTC_TT_TESTGROUP_BEGIN(utest_fs_memory)
@@ -285,6 +319,207 @@ IOTC_TT_TESTCASE(
     })
 #endif
 
+IOTC_TT_TESTCASE(
+    utest__iotc_fs_memory_write__new_file__created_and_read_back_across_blocks,
+    {
+      iotc_fs_resource_handle_t resource_handle =
+          iotc_fs_init_resource_handle();
+      iotc_fs_stat_t stat = {.resource_size = 0};
+      uint8_t written[3 * IOTC_FS_MEMORY_BLOCK_SIZE + 10];
+      uint8_t read[sizeof(written)];
+      size_t bytes_written = 0;
+
+      iotc_utest_fs_memory_fill(written, sizeof(written), 0);
+
+      tt_int_op(IOTC_FS_RESOURCE_NOT_AVAILABLE, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                             IOTC_FS_OPEN_READ, &resource_handle));
+      tt_int_op(IOTC_FS_RESOURCE_NOT_AVAILABLE, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                             IOTC_FS_OPEN_WRITE, &resource_handle));
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                             IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE,
+                             &resource_handle));
+
+      /* two writes, the second one crossing block boundaries */
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_write(NULL, resource_handle, written, 100, 0,
+                              &bytes_written));
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_write(NULL, resource_handle, written + 100,
+                              sizeof(written) - 100, 100, &bytes_written));
+      tt_int_op(sizeof(written) - 100, ==, bytes_written);
+      tt_int_op(IOTC_STATE_OK, ==, iotc_fs_close(NULL, resource_handle));
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_stat(NULL, IOTC_FS_CONFIG_DATA, "utest_file", &stat));
+      tt_int_op(sizeof(written), ==, stat.resource_size);
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                             IOTC_FS_OPEN_READ, &resource_handle));
+      tt_assert(iotc_utest_fs_memory_read_all(resource_handle, read,
+                                              sizeof(read)));
+      tt_int_op(0, ==, memcmp(written, read, sizeof(written)));
+
+      /* writing to a file opened for reading fails */
+      tt_int_op(IOTC_FS_ERROR, ==,
+                iotc_fs_write(NULL, resource_handle, written, 1, 0,
+                              &bytes_written));
+
+    end:
+      iotc_fs_close(NULL, resource_handle);
+      iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, "utest_file");
+    })
+
+IOTC_TT_TESTCASE(
+    utest__iotc_fs_memory_read__file_appended_while_read__earlier_buffer_unchanged,
+    {
+      iotc_fs_resource_handle_t write_handle = iotc_fs_init_resource_handle();
+      iotc_fs_resource_handle_t read_handle = iotc_fs_init_resource_handle();
+      uint8_t written[2 * IOTC_FS_MEMORY_BLOCK_SIZE];
+      size_t bytes_written = 0;
+
+      iotc_utest_fs_memory_fill(written, sizeof(written), 0);
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                             IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE,
+                             &write_handle));
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_write(NULL, write_handle, written, 10, 0,
+                              &bytes_written));
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                             IOTC_FS_OPEN_READ, &read_handle));
+
+      const uint8_t* buffer = NULL;
+      size_t buffer_size = 0;
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_read(NULL, read_handle, 0, &buffer, &buffer_size));
+      tt_int_op(10, ==, buffer_size);
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_write(NULL, write_handle, written + 10,
+                              sizeof(written) - 10, 10, &bytes_written));
+
+      /* the blocks don't move */
+      tt_int_op(0, ==, memcmp(buffer, written, 10));
+
+      const uint8_t* next_buffer = NULL;
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_read(NULL, read_handle, IOTC_FS_MEMORY_BLOCK_SIZE,
+                             &next_buffer, &buffer_size));
+      tt_int_op(IOTC_FS_MEMORY_BLOCK_SIZE, ==, buffer_size);
+      tt_int_op(0, ==,
+                memcmp(next_buffer, written + IOTC_FS_MEMORY_BLOCK_SIZE,
+                       buffer_size));
+
+    end:
+      iotc_fs_close(NULL, read_handle);
+      iotc_fs_close(NULL, write_handle);
+      iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, "utest_file");
+    })
+
+IOTC_TT_TESTCASE(utest__iotc_fs_memory_remove__open_file__freed_on_close, {
+  iotc_fs_resource_handle_t resource_handle = iotc_fs_init_resource_handle();
+  iotc_fs_stat_t stat = {.resource_size = 0};
+  const uint8_t written[4] = {1, 2, 3, 4};
+  size_t bytes_written = 0;
+
+  tt_int_op(IOTC_STATE_OK, ==,
+            iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                         IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE,
+                         &resource_handle));
+  tt_int_op(IOTC_STATE_OK, ==,
+            iotc_fs_write(NULL, resource_handle, written, sizeof(written), 0,
+                          &bytes_written));
+
+  tt_int_op(IOTC_STATE_OK, ==,
+            iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, "utest_file"));
+  tt_int_op(IOTC_FS_RESOURCE_NOT_AVAILABLE, ==,
+            iotc_fs_stat(NULL, IOTC_FS_CONFIG_DATA, "utest_file", &stat));
+
+  /* still readable through the open handle */
+  const uint8_t* buffer = NULL;
+  size_t buffer_size = 0;
+
+  tt_int_op(IOTC_STATE_OK, ==,
+            iotc_fs_read(NULL, resource_handle, 0, &buffer, &buffer_size));
+  tt_int_op(sizeof(written), ==, buffer_size);
+
+  tt_int_op(IOTC_STATE_OK, ==, iotc_fs_close(NULL, resource_handle));
+  resource_handle = iotc_fs_init_resource_handle();
+
+  tt_int_op(IOTC_FS_RESOURCE_NOT_AVAILABLE, ==,
+            iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, "utest_file"));
+
+end:
+  iotc_fs_close(NULL, resource_handle);
+})
+
+IOTC_TT_TESTCASE(utest__iotc_fs_memory_write__budget_used_up__write_fails, {
+  iotc_fs_resource_handle_t resource_handle = iotc_fs_init_resource_handle();
+  const uint8_t byte = 1;
+  size_t bytes_written = 0;
+
+  tt_int_op(IOTC_STATE_OK, ==,
+            iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, "utest_file",
+                         IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE,
+                         &resource_handle));
+
+  tt_int_op(IOTC_OUT_OF_MEMORY, ==,
+            iotc_fs_write(NULL, resource_handle, &byte, 1,
+                          IOTC_FS_MEMORY_BUDGET, &bytes_written));
+  tt_int_op(0, ==, bytes_written);
+
+  tt_int_op(IOTC_STATE_OK, ==,
+            iotc_fs_write(NULL, resource_handle, &byte, 1, 0, &bytes_written));
+
+end:
+  iotc_fs_close(NULL, resource_handle);
+  iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, "utest_file");
+})
+
+IOTC_TT_TESTCASE(utest__iotc_fs_memory_stat__many_files__each_one_found, {
+  iotc_fs_resource_handle_t resource_handle = iotc_fs_init_resource_handle();
+  iotc_fs_stat_t stat = {.resource_size = 0};
+  char name[32];
+  size_t bytes_written = 0;
+  uint8_t i = 0;
+
+  /* more files than buckets */
+  for (i = 0; i < 2 * IOTC_FS_MEMORY_BUCKETS; ++i) {
+    snprintf(name, sizeof(name), "utest_file.%u", (unsigned)i);
+
+    tt_int_op(IOTC_STATE_OK, ==,
+              iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA, name,
+                           IOTC_FS_OPEN_WRITE | IOTC_FS_OPEN_CREATE,
+                           &resource_handle));
+    tt_int_op(IOTC_STATE_OK, ==,
+              iotc_fs_write(NULL, resource_handle, &i, 1, i, &bytes_written));
+    tt_int_op(IOTC_STATE_OK, ==, iotc_fs_close(NULL, resource_handle));
+  }
+
+  for (i = 0; i < 2 * IOTC_FS_MEMORY_BUCKETS; ++i) {
+    snprintf(name, sizeof(name), "utest_file.%u", (unsigned)i);
+
+    tt_int_op(IOTC_STATE_OK, ==,
+              iotc_fs_stat(NULL, IOTC_FS_CONFIG_DATA, name, &stat));
+    tt_int_op(i + 1, ==, stat.resource_size);
+  }
+
+end:
+  for (i = 0; i < 2 * IOTC_FS_MEMORY_BUCKETS; ++i) {
+    snprintf(name, sizeof(name), "utest_file.%u", (unsigned)i);
+    iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, name);
+  }
+})
+
 IOTC_TT_TESTCASE(utest__iotc_fs_memory_remove__incorrect_parameters, {
   iotc_state_t ret = iotc_fs_remove(NULL, IOTC_FS_CONFIG_DATA, "test_name");
 
@@ -280,6 +280,93 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       iotc_fs_close(NULL, resource_handle);
     })
 
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_fs_posix__mmap__whole_file_read_at_once,
+    utest__iotc_fs_posix__setup_big, utest__iotc_fs_posix__clean, NULL, {
+      iotc_fs_resource_handle_t resource_handle =
+          iotc_fs_init_resource_handle();
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CERTIFICATE,
+                             iotc_utest_fs_posix_existing_file_name,
+                             IOTC_FS_OPEN_READ | IOTC_FS_OPEN_MMAP,
+                             &resource_handle));
+
+      const uint8_t* buffer = NULL;
+      size_t buffer_size = 0u;
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_read(NULL, resource_handle, 0, &buffer, &buffer_size));
+      tt_int_op(buffer_size, ==, iotc_utest_fs_posix_file_test_size_big);
+      tt_int_op(0, ==,
+                memcmp(buffer, iotc_utest_fs_posix_memory_block,
+                       iotc_utest_fs_posix_file_test_size_big));
+
+      /* the rest of the file from an offset */
+      buffer = NULL;
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_read(NULL, resource_handle, 1000, &buffer,
+                             &buffer_size));
+      tt_int_op(buffer_size, ==, iotc_utest_fs_posix_file_test_size_big - 1000);
+      tt_int_op(0, ==,
+                memcmp(buffer, iotc_utest_fs_posix_memory_block + 1000,
+                       buffer_size));
+
+      /* nothing past the end */
+      buffer = NULL;
+      tt_int_op(IOTC_STATE_OK, !=,
+                iotc_fs_read(NULL, resource_handle,
+                             iotc_utest_fs_posix_file_test_size_big, &buffer,
+                             &buffer_size));
+
+    end:
+      iotc_fs_close(NULL, resource_handle);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_fs_posix__mmap_and_file_grows__appended_bytes_read,
+    utest__iotc_fs_posix__setup_small, utest__iotc_fs_posix__clean, NULL, {
+      iotc_fs_resource_handle_t read_handle = iotc_fs_init_resource_handle();
+      iotc_fs_resource_handle_t write_handle = iotc_fs_init_resource_handle();
+      const uint8_t appended[] = {1, 2, 3, 4};
+      size_t written = 0u;
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA,
+                             iotc_utest_fs_posix_existing_file_name,
+                             IOTC_FS_OPEN_READ | IOTC_FS_OPEN_MMAP,
+                             &read_handle));
+
+      const uint8_t* buffer = NULL;
+      size_t buffer_size = 0u;
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_read(NULL, read_handle, 0, &buffer, &buffer_size));
+      tt_int_op(buffer_size, ==, iotc_utest_fs_posix_file_test_size_small);
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_open(NULL, IOTC_FS_CONFIG_DATA,
+                             iotc_utest_fs_posix_existing_file_name,
+                             IOTC_FS_OPEN_WRITE, &write_handle));
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_write(NULL, write_handle, appended, sizeof(appended),
+                              iotc_utest_fs_posix_file_test_size_small,
+                              &written));
+
+      /* past the old mapping the file is mapped again */
+      buffer = NULL;
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_fs_read(NULL, read_handle,
+                             iotc_utest_fs_posix_file_test_size_small, &buffer,
+                             &buffer_size));
+      tt_int_op(buffer_size, ==, sizeof(appended));
+      tt_int_op(0, ==, memcmp(buffer, appended, sizeof(appended)));
+
+    end:
+      iotc_fs_close(NULL, write_handle);
+      iotc_fs_close(NULL, read_handle);
+    })
+
 IOTC_TT_TESTCASE_WITH_SETUP(utest__iotc_fs_posix__valid_data__close_success,
                             utest__iotc_fs_posix__setup_small,
                             utest__iotc_fs_posix__clean, NULL, {
@@ -0,0 +1,199 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "iotc_tt_testcase_management.h"
+#include "iotc_utest_basic_testcase_frame.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc.h"
+#include "iotc_bsp_rng.h"
+#include "iotc_bsp_time.h"
+#include "iotc_connection_data_internal.h"
+#include "iotc_globals.h"
+#include "iotc_handle.h"
+#include "iotc_jwt_rotation.h"
+#include "iotc_types_internal.h"
+
+#include <iotc_error.h>
+
+#include <string.h>
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+#define IOTC_UTEST_JWT "header.payload.signature"
+#define IOTC_UTEST_JWT_EXPIRATION_SEC 400
+
+/* a signer without crypto, it counts its releases */
+typedef struct iotc_utest_jwt_signer_s {
+  uint32_t released;
+} iotc_utest_jwt_signer_t;
+
+static iotc_utest_jwt_signer_t iotc_utest_jwt_signer;
+
+static iotc_state_t iotc_utest_jwt_sign(void* signer, char* dst_buf,
+                                        size_t dst_buf_len,
+                                        size_t* bytes_written,
+                                        iotc_time_t* expiration_sec) {
+  IOTC_UNUSED(signer);
+
+  if (dst_buf_len <= strlen(IOTC_UTEST_JWT)) {
+    return IOTC_BUFFER_TOO_SMALL_ERROR;
+  }
+
+  strcpy(dst_buf, IOTC_UTEST_JWT);
+  *bytes_written = strlen(IOTC_UTEST_JWT);
+  *expiration_sec =
+      iotc_bsp_time_getcurrenttime_seconds() + IOTC_UTEST_JWT_EXPIRATION_SEC;
+
+  return IOTC_STATE_OK;
+}
+
+static void iotc_utest_jwt_signer_release(void** signer) {
+  ++((iotc_utest_jwt_signer_t*)*signer)->released;
+  *signer = NULL;
+}
+
+#endif
+
+IOTC_TT_TESTGROUP_BEGIN(utest_jwt_rotation)
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_jwt_rotation_set_signer__replaced_and_deleted__signer_released,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      memset(&iotc_utest_jwt_signer, 0, sizeof(iotc_utest_jwt_signer));
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      tt_assert(IOTC_INVALID_CONTEXT_HANDLE < iotc_context_handle);
+
+      /* a signer without its functions */
+      tt_want_int_op(iotc_jwt_rotation_set_signer(iotc_context_handle,
+                                                  &iotc_utest_jwt_signer, NULL,
+                                                  NULL, 0),
+                     ==, IOTC_INVALID_PARAMETER);
+
+      tt_want_int_op(
+          iotc_jwt_rotation_set_signer(
+              iotc_context_handle, &iotc_utest_jwt_signer, &iotc_utest_jwt_sign,
+              &iotc_utest_jwt_signer_release, IOTC_UTEST_JWT_EXPIRATION_SEC),
+          ==, IOTC_STATE_OK);
+      tt_want_int_op(iotc_utest_jwt_signer.released, ==, 0);
+
+      tt_want_int_op(
+          iotc_jwt_rotation_set_signer(
+              iotc_context_handle, &iotc_utest_jwt_signer, &iotc_utest_jwt_sign,
+              &iotc_utest_jwt_signer_release, IOTC_UTEST_JWT_EXPIRATION_SEC),
+          ==, IOTC_STATE_OK);
+      tt_want_int_op(iotc_utest_jwt_signer.released, ==, 1);
+
+      iotc_delete_context(iotc_context_handle);
+      tt_want_int_op(iotc_utest_jwt_signer.released, ==, 2);
+
+    end:;
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_jwt_rotation_update_password__signer_set__password_replaced,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_t* iotc_context = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, iotc_context_handle);
+      tt_assert(NULL != iotc_context);
+
+      iotc_context_data_t* context_data = &iotc_context->context_data;
+
+      context_data->connection_data = iotc_alloc_connection_data(
+          "host", 8883, "user", "password", "client", 10, 20,
+          IOTC_SESSION_CLEAN);
+      tt_assert(NULL != context_data->connection_data);
+
+      /* without a signer the password of the application stays */
+      tt_want_int_op(iotc_jwt_rotation_update_password(context_data), ==,
+                     IOTC_STATE_OK);
+      tt_want_str_op(context_data->connection_data->password, ==, "password");
+
+      tt_want_int_op(
+          iotc_jwt_rotation_set_signer(
+              iotc_context_handle, &iotc_utest_jwt_signer, &iotc_utest_jwt_sign,
+              &iotc_utest_jwt_signer_release, IOTC_UTEST_JWT_EXPIRATION_SEC),
+          ==, IOTC_STATE_OK);
+
+      tt_want_int_op(iotc_jwt_rotation_update_password(context_data), ==,
+                     IOTC_STATE_OK);
+      tt_want_str_op(context_data->connection_data->password, ==,
+                     IOTC_UTEST_JWT);
+      tt_want_int_op(context_data->jwt_rotation.token_expiration_sec, >=,
+                     iotc_bsp_time_getcurrenttime_seconds() +
+                         IOTC_UTEST_JWT_EXPIRATION_SEC - 1);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_jwt_rotation_connected__token_signed__swap_in_last_quarter,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_bsp_rng_init();
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_t* iotc_context = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, iotc_context_handle);
+      tt_assert(NULL != iotc_context);
+
+      iotc_context_data_t* context_data = &iotc_context->context_data;
+      iotc_jwt_rotation_t* rotation = &context_data->jwt_rotation;
+      void* context = &iotc_context->layer_chain.top->layer_connection;
+
+      /* no signer, nothing to rotate */
+      tt_want_int_op(iotc_jwt_rotation_connected(context), ==, IOTC_STATE_OK);
+      tt_want(NULL == rotation->next_check.ptr_to_position);
+
+      tt_want_int_op(
+          iotc_jwt_rotation_set_signer(
+              iotc_context_handle, &iotc_utest_jwt_signer, &iotc_utest_jwt_sign,
+              &iotc_utest_jwt_signer_release, IOTC_UTEST_JWT_EXPIRATION_SEC),
+          ==, IOTC_STATE_OK);
+
+      const iotc_time_t now_sec = iotc_bsp_time_getcurrenttime_seconds();
+      rotation->token_expiration_sec = now_sec + IOTC_UTEST_JWT_EXPIRATION_SEC;
+      rotation->in_progress = 1;
+
+      tt_want_int_op(iotc_jwt_rotation_connected(context), ==, IOTC_STATE_OK);
+      tt_want_int_op(rotation->in_progress, ==, 0);
+      tt_want_int_op(rotation->deadline_sec, ==,
+                     rotation->token_expiration_sec -
+                         IOTC_UTEST_JWT_EXPIRATION_SEC / 8);
+
+      /* the swap is looked for before the deadline */
+      tt_want(NULL != rotation->next_check.ptr_to_position);
+
+      /* a close of the application cancels the swap */
+      iotc_jwt_rotation_closed(context);
+      tt_want(NULL == rotation->next_check.ptr_to_position);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_bsp_rng_shutdown();
+    })
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -0,0 +1,352 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "iotc_tt_testcase_management.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc_allocator.h"
+#include "iotc_data_desc.h"
+#include "iotc_event_handle_queue.h"
+#include "iotc_macros.h"
+#include "iotc_mem_pool.h"
+#include "iotc_mqtt_logic_layer_data.h"
+#include "iotc_mqtt_logic_layer_data_helpers.h"
+#include "iotc_mqtt_message.h"
+#include "iotc_tuples.h"
+
+#include <iotc_bsp_mem.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+static const iotc_mem_pool_config_t iotc_utest_mem_pool_config[] = {
+    {IOTC_MEM_POOL_TUPLE, 24, 4},
+    {IOTC_MEM_POOL_MQTT_MESSAGE, 64, 2},
+    {IOTC_MEM_POOL_DATA_DESC, 128, 0}};
+
+/* the objects a QoS 0 publish of borrowed buffers makes on its way to the
+ * socket, with room for the memory limiter's header */
+#define IOTC_UTEST_MEM_POOL_BLOCK(type, size) \
+  { (type), (size) + IOTC_ALLOC_OVERHEAD, 8 }
+
+static const iotc_mem_pool_config_t iotc_utest_mem_pool_publish_config[] = {
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_DATA_DESC,
+                              sizeof(iotc_data_desc_borrowed_t)),
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_MQTT_MESSAGE,
+                              sizeof(iotc_mqtt_message_t)),
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_MQTT_TASK,
+                              sizeof(iotc_mqtt_logic_task_t)),
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_MQTT_TASK_DATA,
+                              sizeof(iotc_mqtt_task_specific_data_t)),
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_TUPLE, 4 * sizeof(void*)),
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_BUFFER, 64),
+    IOTC_UTEST_MEM_POOL_BLOCK(IOTC_MEM_POOL_EVENT_HANDLE,
+                              sizeof(iotc_event_handle_queue_t))};
+
+/* the utests get the BSP allocator from here, so the tests can tell whether a
+ * pool or the BSP served an allocation */
+static size_t iotc_utest_mem_pool_bsp_allocations = 0;
+
+void* iotc_bsp_mem_alloc(size_t byte_count) {
+  ++iotc_utest_mem_pool_bsp_allocations;
+  return malloc(byte_count);
+}
+
+void* iotc_bsp_mem_realloc(void* ptr, size_t byte_count) {
+  ++iotc_utest_mem_pool_bsp_allocations;
+  return realloc(ptr, byte_count);
+}
+
+void iotc_bsp_mem_free(void* ptr) { free(ptr); }
+
+static void iotc_utest_mem_pool_release(const uint8_t* buffer, size_t len,
+                                        void* user_data) {
+  IOTC_UNUSED(buffer);
+  IOTC_UNUSED(len);
+
+  ++*(size_t*)user_data;
+}
+
+/* makes and frees what the logic and codec layers make for a QoS 0 publish:
+ * the task with its payload, the MQTT message, the serialised header chained
+ * to the shared payload, the written confirmation and a queued event */
+static iotc_state_t iotc_utest_mem_pool_publish_round_trip(
+    iotc_event_handle_mpsc_t* queue, size_t* released) {
+  static const char topic[] = "pooled/topic";
+  static const uint8_t payload[] = "pooled payload";
+
+  iotc_state_t state = IOTC_STATE_OK;
+  iotc_mqtt_logic_task_t* task = NULL;
+  iotc_mqtt_message_t* msg = NULL;
+  iotc_data_desc_t* header = NULL;
+  iotc_mqtt_written_data_t* written = NULL;
+  iotc_event_handle_queue_t* node = NULL;
+
+  iotc_data_desc_t* data = iotc_make_desc_from_buffer_borrow(
+      payload, sizeof(payload), &iotc_utest_mem_pool_release, released);
+  IOTC_CHECK_MEMORY(data, state);
+
+  task = iotc_mqtt_logic_make_publish_task(
+      topic, IOTC_MEMORY_TYPE_UNMANAGED, data, IOTC_MQTT_QOS_AT_MOST_ONCE,
+      (iotc_mqtt_retain_t)0, iotc_make_empty_handle());
+  IOTC_CHECK_MEMORY(task, state);
+
+  IOTC_ALLOC_POOLED_AT(IOTC_MEM_POOL_MQTT_MESSAGE, iotc_mqtt_message_t, msg,
+                       state);
+
+  IOTC_CHECK_STATE(state = fill_with_publish_data(
+                       msg, task->data.data_u->publish.topic,
+                       task->data.data_u->publish.data,
+                       IOTC_MQTT_QOS_AT_MOST_ONCE, (iotc_mqtt_retain_t)0,
+                       IOTC_MQTT_DUP_FALSE, 0));
+
+  header = iotc_make_empty_desc_alloc(2 + sizeof(topic));
+  IOTC_CHECK_MEMORY(header, state);
+
+  IOTC_CHECK_MEMORY(header->__next = iotc_make_desc_from_buffer_share(
+                        msg->publish.content->data_ptr,
+                        msg->publish.content->length),
+                    state);
+
+  written = iotc_alloc_make_tuple(iotc_mqtt_written_data_t, 0,
+                                  IOTC_MQTT_TYPE_PUBLISH, NULL);
+  IOTC_CHECK_MEMORY(written, state);
+
+  node = iotc_event_handle_mpsc_alloc_node(queue);
+  IOTC_CHECK_MEMORY(node, state);
+
+  iotc_event_handle_mpsc_push(queue, node);
+  node = iotc_event_handle_mpsc_pop(queue);
+
+err_handling:
+  iotc_event_handle_mpsc_free_node(queue, node);
+  IOTC_SAFE_FREE_TUPLE(written);
+
+  if (NULL != header) {
+    iotc_free_desc(&header->__next);
+  }
+
+  iotc_free_desc(&header);
+  iotc_mqtt_message_free(&msg);
+  iotc_mqtt_logic_free_task(&task);
+
+  return state;
+}
+
+#endif  // IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+IOTC_TT_TESTGROUP_BEGIN(utest_mem_pool)
+
+IOTC_TT_TESTCASE(utest__iotc_mem_pool_create__type_configured_twice__rejected, {
+  iotc_mem_pool_destroy();
+
+  const iotc_mem_pool_config_t config[] = {{IOTC_MEM_POOL_TUPLE, 24, 4},
+                                           {IOTC_MEM_POOL_TUPLE, 32, 1}};
+
+  tt_want_int_op(IOTC_INVALID_PARAMETER, ==,
+                 iotc_mem_pool_create(config, IOTC_ARRAYSIZE(config)));
+  tt_want_int_op(0, ==, iotc_mem_pool_get_idle_space());
+
+  tt_want_int_op(IOTC_STATE_OK, ==,
+                 iotc_mem_pool_create(
+                     iotc_utest_mem_pool_config,
+                     IOTC_ARRAYSIZE(iotc_utest_mem_pool_config)));
+
+  tt_want_int_op(4 * 24 + 2 * 64, ==, iotc_mem_pool_get_idle_space());
+  tt_want_int_op(IOTC_ALREADY_INITIALIZED, ==,
+                 iotc_mem_pool_create(
+                     iotc_utest_mem_pool_config,
+                     IOTC_ARRAYSIZE(iotc_utest_mem_pool_config)));
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+  tt_want_int_op(0, ==, iotc_mem_pool_get_idle_space());
+})
+
+IOTC_TT_TESTCASE(utest__iotc_alloc_pooled__pools_created__pool_of_type_used, {
+  iotc_mem_pool_destroy();
+  iotc_mem_pool_create(iotc_utest_mem_pool_config,
+                       IOTC_ARRAYSIZE(iotc_utest_mem_pool_config));
+
+  void* tuple = __iotc_alloc_pooled(IOTC_MEM_POOL_TUPLE, 10);
+  void* message = __iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 10);
+  void* desc = __iotc_alloc_pooled(IOTC_MEM_POOL_DATA_DESC, 10);
+  void* buffer = __iotc_alloc(10);
+
+  tt_want_int_op(24, ==, iotc_mem_pool_block_size(tuple));
+  tt_want_int_op(64, ==, iotc_mem_pool_block_size(message));
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(desc));
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(buffer));
+
+  __iotc_free(message);
+  tt_want_ptr_op(message, ==,
+                 __iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 64));
+
+  __iotc_free(tuple);
+  __iotc_free(message);
+  __iotc_free(desc);
+  __iotc_free(buffer);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTCASE(utest__iotc_alloc_pooled__object_too_large__bsp_fallback, {
+  iotc_mem_pool_destroy();
+  iotc_mem_pool_create(iotc_utest_mem_pool_config,
+                       IOTC_ARRAYSIZE(iotc_utest_mem_pool_config));
+
+  /* the message pool's blocks would fit, but they aren't lent to tuples */
+  void* tuple = __iotc_alloc_pooled(IOTC_MEM_POOL_TUPLE, 40);
+
+  tt_want_ptr_op(NULL, !=, tuple);
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(tuple));
+  tt_want_int_op(4 * 24 + 2 * 64, ==, iotc_mem_pool_get_idle_space());
+
+  __iotc_free(tuple);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTCASE(utest__iotc_alloc_pooled__pool_exhausted__bsp_fallback, {
+  iotc_mem_pool_destroy();
+  iotc_mem_pool_create(iotc_utest_mem_pool_config,
+                       IOTC_ARRAYSIZE(iotc_utest_mem_pool_config));
+
+  void* first = __iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 64);
+  void* second = __iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 64);
+
+  const size_t bsp_allocations = iotc_utest_mem_pool_bsp_allocations;
+  void* third = __iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 64);
+
+  tt_want_int_op(64, ==, iotc_mem_pool_block_size(first));
+  tt_want_int_op(64, ==, iotc_mem_pool_block_size(second));
+  tt_want_ptr_op(NULL, !=, third);
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(third));
+  tt_want_int_op(bsp_allocations + 1, ==,
+                 iotc_utest_mem_pool_bsp_allocations);
+
+  __iotc_free(first);
+  __iotc_free(second);
+  __iotc_free(third);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTCASE(utest__iotc_realloc__pooled_block_grows__content_kept, {
+  iotc_mem_pool_destroy();
+  iotc_mem_pool_create(iotc_utest_mem_pool_config,
+                       IOTC_ARRAYSIZE(iotc_utest_mem_pool_config));
+
+  char* buffer = (char*)__iotc_alloc_pooled(IOTC_MEM_POOL_TUPLE, 16);
+  memcpy(buffer, "pooled", sizeof("pooled"));
+
+  tt_want_ptr_op(buffer, ==, __iotc_realloc(buffer, 24));
+
+  buffer = (char*)__iotc_realloc(buffer, 48);
+
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(buffer));
+  tt_want_str_op("pooled", ==, buffer);
+  tt_want_int_op(4 * 24 + 2 * 64, ==, iotc_mem_pool_get_idle_space());
+
+  __iotc_free(buffer);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTCASE(utest__iotc_mem_pool_free__around_the_region__not_pooled, {
+  iotc_mem_pool_destroy();
+
+  void* buffer = __iotc_alloc(16);
+
+  /* without pools nothing is pooled */
+  tt_want_int_op(0, ==, iotc_mem_pool_free(buffer));
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(buffer));
+
+  iotc_mem_pool_create(iotc_utest_mem_pool_config,
+                       IOTC_ARRAYSIZE(iotc_utest_mem_pool_config));
+
+  uint8_t* tuple = (uint8_t*)__iotc_alloc_pooled(IOTC_MEM_POOL_TUPLE, 24);
+  uint8_t* message =
+      (uint8_t*)__iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 64);
+
+  /* the slabs are cut one after another from a single region */
+  tt_want_ptr_op(tuple + 4 * 24, ==, message);
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(tuple - 1));
+  tt_want_int_op(0, ==, iotc_mem_pool_block_size(message + 2 * 64));
+  tt_want_int_op(0, ==, iotc_mem_pool_free(buffer));
+
+  __iotc_free(tuple);
+  __iotc_free(message);
+  __iotc_free(buffer);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTCASE(utest__iotc_mem_pool_destroy__block_in_use__pools_kept, {
+  iotc_mem_pool_destroy();
+  iotc_mem_pool_create(iotc_utest_mem_pool_config,
+                       IOTC_ARRAYSIZE(iotc_utest_mem_pool_config));
+
+  void* block = __iotc_alloc_pooled(IOTC_MEM_POOL_MQTT_MESSAGE, 64);
+
+  tt_want_int_op(IOTC_INTERNAL_ERROR, ==, iotc_mem_pool_destroy());
+  tt_want_int_op(64, ==, iotc_mem_pool_block_size(block));
+
+  __iotc_free(block);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTCASE(utest__publish_round_trip__pools_warm__no_bsp_allocations, {
+  iotc_mem_pool_destroy();
+  tt_want_int_op(IOTC_STATE_OK, ==,
+                 iotc_mem_pool_create(
+                     iotc_utest_mem_pool_publish_config,
+                     IOTC_ARRAYSIZE(iotc_utest_mem_pool_publish_config)));
+
+  iotc_event_handle_mpsc_t queue;
+  size_t released = 0;
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_event_handle_mpsc_init(&queue, 0));
+
+  const size_t idle_space = iotc_mem_pool_get_idle_space();
+  const size_t bsp_allocations = iotc_utest_mem_pool_bsp_allocations;
+
+  size_t round_trip = 0;
+  for (round_trip = 0; round_trip < 16; ++round_trip) {
+    tt_want_int_op(IOTC_STATE_OK, ==,
+                   iotc_utest_mem_pool_publish_round_trip(&queue, &released));
+  }
+
+  tt_want_int_op(bsp_allocations, ==, iotc_utest_mem_pool_bsp_allocations);
+  tt_want_int_op(idle_space, ==, iotc_mem_pool_get_idle_space());
+  tt_want_int_op(16, ==, released);
+
+  iotc_event_handle_mpsc_destroy(&queue);
+
+  tt_want_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+})
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif  // IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -20,6 +20,8 @@
 #include "tinytest_macros.h"
 
 #include "iotc.h"
+#include "iotc_allocator.h"
+#include "iotc_mem_pool.h"
 #include "iotc_memory_checks.h"
 #include "iotc_memory_limiter.h"
 
@@ -318,6 +320,29 @@ IOTC_TT_TESTCASE(
     end:;
     })
 
+IOTC_TT_TESTCASE(
+    utest__iotc_memory_limiter_realloc__null_pointer__allocates_memory, {
+      const size_t application_capacity =
+          iotc_memory_limiter_get_current_limit(
+              IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_APPLICATION);
+      const size_t alloc_size = 0xAA;
+
+      void* ptr = iotc_memory_limiter_realloc(
+          IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_APPLICATION, NULL, alloc_size,
+          __FILE__, __LINE__);
+      tt_assert(NULL != ptr);
+      tt_assert(application_capacity -
+                    (alloc_size + sizeof(iotc_memory_limiter_entry_t)) ==
+                iotc_memory_limiter_get_current_limit(
+                    IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_APPLICATION));
+
+      iotc_memory_limiter_free(ptr);
+      tt_assert(application_capacity ==
+                iotc_memory_limiter_get_current_limit(
+                    IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_APPLICATION));
+    end:;
+    })
+
 IOTC_TT_TESTCASE(
     utest__iotc_memory_limiter_free_memory__valid_data_free_previously_allocated_value__return_state_ok,
     {
@@ -431,6 +456,43 @@ IOTC_TT_TESTCASE(
       iotc_memory_limiter_free(ptr2);
     })
 
+IOTC_TT_TESTCASE(
+    utest__iotc_memory_limiter_alloc_pooled__pool_created__slab_counted_once, {
+      const size_t block_size = 32 + IOTC_ALLOC_OVERHEAD;
+      const iotc_mem_pool_config_t config[] = {
+          {IOTC_MEM_POOL_TUPLE, block_size, 2}};
+
+      iotc_mem_pool_destroy();
+
+      const size_t allocated = iotc_memory_limiter_get_allocated_space();
+
+      tt_int_op(IOTC_STATE_OK, ==,
+                iotc_mem_pool_create(config, IOTC_ARRAYSIZE(config)));
+
+      const size_t slab_size =
+          iotc_memory_limiter_get_allocated_space() - allocated;
+
+      tt_int_op(slab_size, >=, 2 * block_size + IOTC_ALLOC_OVERHEAD);
+
+      void* block = iotc_memory_limiter_alloc_pooled(
+          IOTC_MEMORY_LIMITER_ALLOCATION_TYPE_APPLICATION, IOTC_MEM_POOL_TUPLE,
+          32, __FILE__, __LINE__);
+
+      tt_int_op(0, <, iotc_mem_pool_block_size((uint8_t*)block -
+                                                IOTC_ALLOC_OVERHEAD));
+      tt_int_op(iotc_memory_limiter_get_allocated_space(), ==,
+                allocated + slab_size);
+
+      iotc_memory_limiter_free(block);
+
+      tt_int_op(iotc_memory_limiter_get_allocated_space(), ==,
+                allocated + slab_size);
+      tt_int_op(IOTC_STATE_OK, ==, iotc_mem_pool_destroy());
+      tt_int_op(iotc_memory_limiter_get_allocated_space(), ==, allocated);
+
+    end:;
+    })
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -198,6 +198,48 @@ IOTC_TT_TESTCASE(
     end:;
     })
 
+IOTC_TT_TESTCASE(
+    utest__iotc_mqtt_codec_layer_make_batch_task__valid_data__batch_released,
+    {
+      iotc_state_t state = IOTC_STATE_OK;
+
+      iotc_mqtt_message_t* msg = NULL;
+
+      IOTC_ALLOC_AT(iotc_mqtt_message_t, msg, state);
+
+      state = fill_with_pingreq_data(msg);
+
+      IOTC_CHECK_STATE(state);
+
+      iotc_mqtt_codec_layer_task_t* batched =
+          iotc_mqtt_codec_layer_make_task(msg);
+
+      iotc_data_desc_t* batch = iotc_make_empty_desc_alloc(2);
+      batch->__next = iotc_make_empty_desc_alloc(2);
+
+      iotc_mqtt_codec_layer_task_t* task =
+          iotc_mqtt_codec_layer_make_batch_task(batch, batched);
+
+      tt_ptr_op(NULL, !=, task);
+      tt_ptr_op(task->batch, ==, batch);
+      tt_ptr_op(task->batched, ==, batched);
+
+      /* there is no msg to detach from a batch task */
+      tt_ptr_op(NULL, ==, iotc_mqtt_codec_layer_activate_task(task));
+
+      iotc_mqtt_codec_layer_free_task(&task);
+
+      tt_ptr_op(NULL, ==, task);
+
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+
+      return;
+
+    err_handling:
+      tt_fail();
+    end:;
+    })
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
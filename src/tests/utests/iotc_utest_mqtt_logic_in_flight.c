@@ -0,0 +1,194 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "iotc_bsp_rng.h"
+#include "iotc_memory_checks.h"
+#include "iotc_tt_testcase_management.h"
+#include "iotc_utest_basic_testcase_frame.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc.h"
+#include "iotc_globals.h"
+#include "iotc_handle.h"
+#include "iotc_mqtt_logic_in_flight.h"
+#include "iotc_mqtt_logic_layer_data.h"
+
+#include <string.h>
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+#define TEST_IN_FLIGHT_TEST_SIZE 300
+
+#endif
+
+IOTC_TT_TESTGROUP_BEGIN(utest_mqtt_logic_in_flight)
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_mqtt_logic_in_flight_remove__random_order__rest_found_in_order,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_bsp_rng_init();
+
+      iotc_mqtt_logic_in_flight_t in_flight;
+      memset(&in_flight, 0, sizeof(in_flight));
+
+      iotc_mqtt_logic_task_t tasks[TEST_IN_FLIGHT_TEST_SIZE];
+      memset(tasks, 0, sizeof(tasks));
+
+      /* the ids wrap around in the middle of the set */
+      int i = 0;
+      for (; i < TEST_IN_FLIGHT_TEST_SIZE; ++i) {
+        tasks[i].msg_id = (uint16_t)(UINT16_MAX - 100 + i);
+
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_mqtt_logic_in_flight_add(&in_flight, &tasks[i]));
+      }
+
+      tt_assert(TEST_IN_FLIGHT_TEST_SIZE == in_flight.size);
+
+      /* drop every task at most once, in a random order */
+      for (i = 0; i < TEST_IN_FLIGHT_TEST_SIZE; ++i) {
+        iotc_mqtt_logic_task_t* task =
+            &tasks[iotc_bsp_rng_get() % TEST_IN_FLIGHT_TEST_SIZE];
+
+        iotc_mqtt_logic_in_flight_remove(&in_flight, task);
+        tt_assert(NULL ==
+                  iotc_mqtt_logic_in_flight_find(&in_flight, task->msg_id));
+      }
+
+      /* whatever is left is still found and chained in the order it was
+       * added */
+      uint32_t left = 0;
+      iotc_mqtt_logic_task_t* prev = NULL;
+      iotc_mqtt_logic_task_t* task = in_flight.head;
+
+      for (; NULL != task; prev = task, task = task->__next, ++left) {
+        tt_assert(task ==
+                  iotc_mqtt_logic_in_flight_find(&in_flight, task->msg_id));
+        tt_assert(prev == task->__prev);
+        tt_assert(NULL == prev || prev < task);
+      }
+
+      tt_assert(prev == in_flight.tail);
+      tt_assert(left == in_flight.size);
+
+      tt_assert(in_flight.head ==
+                iotc_mqtt_logic_in_flight_detach_all(&in_flight));
+      tt_assert(0 == in_flight.capacity);
+
+    end:
+      iotc_mqtt_logic_in_flight_detach_all(&in_flight);
+      iotc_bsp_rng_shutdown();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_mqtt_logic_in_flight_find__unknown_msg_id__not_found,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_mqtt_logic_in_flight_t in_flight;
+      memset(&in_flight, 0, sizeof(in_flight));
+
+      iotc_mqtt_logic_task_t tasks[3];
+      memset(tasks, 0, sizeof(tasks));
+
+      tt_assert(NULL == iotc_mqtt_logic_in_flight_find(&in_flight, 1));
+
+      /* ids colliding on the same home slot */
+      tasks[0].msg_id = 1;
+      tasks[1].msg_id = 1 + IOTC_MQTT_IN_FLIGHT_INITIAL_CAPACITY;
+      tasks[2].msg_id = 2;
+
+      int i = 0;
+      for (; i < 3; ++i) {
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_mqtt_logic_in_flight_add(&in_flight, &tasks[i]));
+      }
+
+      tt_assert(&tasks[1] == iotc_mqtt_logic_in_flight_find(
+                                 &in_flight, tasks[1].msg_id));
+      tt_assert(NULL == iotc_mqtt_logic_in_flight_find(&in_flight, 3));
+
+      iotc_mqtt_logic_in_flight_remove(&in_flight, &tasks[0]);
+
+      tt_assert(&tasks[1] == iotc_mqtt_logic_in_flight_find(
+                                 &in_flight, tasks[1].msg_id));
+      tt_assert(&tasks[2] == iotc_mqtt_logic_in_flight_find(&in_flight, 2));
+      tt_assert(&tasks[1] == in_flight.head);
+
+    end:
+      iotc_mqtt_logic_in_flight_detach_all(&in_flight);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_publish__in_flight_window_full__publish_rejected,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_mqtt_logic_layer_data_t logic_layer_data;
+      memset(&logic_layer_data, 0, sizeof(logic_layer_data));
+
+      iotc_mqtt_logic_task_t tasks[2];
+      memset(tasks, 0, sizeof(tasks));
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_t* iotc_context = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, iotc_context_handle);
+      tt_assert(NULL != iotc_context);
+
+      int i = 0;
+      for (; i < 2; ++i) {
+        tasks[i].msg_id = (uint16_t)(i + 1);
+        tasks[i].payload_size = 8;
+
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_mqtt_logic_in_flight_add(
+                      &logic_layer_data.q12_tasks_queue, &tasks[i]));
+      }
+
+      tt_assert(16 == logic_layer_data.q12_tasks_queue.bytes);
+
+      iotc_context->layer_chain.top->layer_connection.prev->user_data =
+          &logic_layer_data;
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_in_flight_window(iotc_context_handle, 2, 0));
+      tt_assert(IOTC_IN_FLIGHT_WINDOW_FULL ==
+                iotc_publish(iotc_context_handle, "test/topic", "payload",
+                             IOTC_MQTT_QOS_AT_LEAST_ONCE, NULL, NULL));
+
+      /* 16 bytes in flight, 7 more don't fit */
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_in_flight_window(iotc_context_handle, 0, 22));
+      tt_assert(IOTC_IN_FLIGHT_WINDOW_FULL ==
+                iotc_publish(iotc_context_handle, "test/topic", "payload",
+                             IOTC_MQTT_QOS_AT_LEAST_ONCE, NULL, NULL));
+
+      iotc_mqtt_logic_in_flight_remove(&logic_layer_data.q12_tasks_queue,
+                                       &tasks[0]);
+      tt_assert(8 == logic_layer_data.q12_tasks_queue.bytes);
+
+    end:
+      if (NULL != iotc_context) {
+        iotc_context->layer_chain.top->layer_connection.prev->user_data = NULL;
+      }
+      iotc_mqtt_logic_in_flight_detach_all(&logic_layer_data.q12_tasks_queue);
+      iotc_delete_context(iotc_context_handle);
+    })
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -77,82 +77,6 @@ static iotc_state_t failed_subscribe_handler(
 
 IOTC_TT_TESTGROUP_BEGIN(utest_mqtt_logic_layer_subscribe)
 
-
-IOTC_TT_TESTCASE(utest__match_topics__batch_tests, {
-  iotc_event_handle_t handle = iotc_make_empty_handle();
-
-  typedef struct {
-    char* subscription_topic;
-    const char* published_topic;
-    const uint8_t expected_result;
-  } iotc_match_topics_test_cases_t;
-
-  iotc_match_topics_test_cases_t test_cases[] = {
-    // non-wildcard tests
-    {"long_topic_name_same_length_1", "long_topic_name_same_length_2", 1},
-    {"long_topic_name_same_length_2", "long_topic_name_same_length_1", 1},
-    {"long_topic_name", "long_topic_name_different_length", 1},
-    {"long_topic_name_different_length", "short", 1},
-    {"t1", "t2", 1},
-    {"t", "t", 0},
-    {"t", "t/", 1},
-    {"t/subfolder", "t", 1},
-
-    // wildcard tests
-    {"t1/#", "t2", 1},
-    {"t/#", "t", 0},
-    {"t/#", "t/", 0},
-    {"t/#", "t/subfolder", 0},
-    {"t1/#", "t2/subfolder", 1},
-    {"multi/level/#", "multi/level", 0},
-    {"multi/level/#", "multi/level/", 0},
-    {"multi/level/#", "multi/level/topic", 0},
-    {"multi/level/#", "multi/level/topic/", 0},
-    {"multi/level/#", "multi/level/topic/name", 0},
-    {"multi/level/#", "multi/level/topic/name/", 0},
-    {"multi/level/#", "multi/leve", 1},
-    {"multi/level/#", "multi/level2", 1},
-    {"multi/level/#", "multi/level2/topic/name", 1},
-    {"multi/#", "multi/level/topic/name", 0},
-
-    // NULL cases
-    {NULL, "short", 1},
-    {"sub", NULL, 1},
-    {NULL, NULL, 1},
-    {"#", NULL, 1},
-    {"#", "", 1},
-    {"", "", 1},
-
-    // root wildcard tests
-    {"#", "t", 0},
-    {"#", "long_topic_name", 0},
-    {"#", "multi/level/topic/name", 0},
-  };
-
-  uint8_t i = 0;
-  for (; i < sizeof(test_cases) / sizeof(iotc_match_topics_test_cases_t); ++i) {
-    iotc_match_topics_test_cases_t* test_case = test_cases + i;
-    // printf("match publish topics with subscriptions, expected: %s, %s, %s\n",
-           // test_case->expected_result ? "MISMATCH" : "MATCH",
-           // test_case->subscription_topic,
-           // test_case->published_topic);
-
-    const size_t string_len = test_case->published_topic ? strlen(test_case->published_topic) : 0;
-
-    iotc_mqtt_task_specific_data_t spd = {.subscribe = {test_case->subscription_topic, handle, 0}};
-    iotc_data_desc_t data = {
-        (unsigned char*)test_case->published_topic, NULL, string_len, string_len, string_len,
-        IOTC_MEMORY_TYPE_UNMANAGED};
-
-    union iotc_vector_selector_u a = {&spd};
-    union iotc_vector_selector_u b = {&data};
-
-    tt_want_int_op(match_topics(&a, &b), ==, test_case->expected_result);
-  }
-})
-
-
-
 IOTC_TT_TESTCASE_WITH_SETUP(
     utest__do_mqtt_subscribe__valid_data__subscription_handler_registered_with_success,
     iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
@@ -175,7 +99,7 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       // set the task data
       IOTC_ALLOC_AT(iotc_mqtt_logic_task_t, task, local_state);
 
-      task->cs = 118;  // this is very hakish since it depends on the code
+      task->cs = 121;  // this is very hakish since it depends on the code
       // so most probably this test will fail everytime we change anything in
       // tested function which is not too good at least you know what to check
       // if the test fails
@@ -191,11 +115,14 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       IOTC_ALLOC_AT(iotc_mqtt_task_specific_data_t, task->data.data_u,
                     local_state);
       iotc_mqtt_task_specific_data_t* data_u = task->data.data_u;
+      data_u->subscribe.topic = "test/topic";
 
-      task->data.data_u->subscribe.handler = iotc_make_threaded_handle(
-          IOTC_THREADID_THREAD_0, &iotc_user_sub_call_wrapper, iotc_context,
-          NULL, IOTC_STATE_OK, (void*)&successful_subscribe_handler,
-          (void*)NULL, (void*)task->data.data_u);
+      /* a main thread handle, so stepping the evtd calls it in threaded
+       * builds too */
+      task->data.data_u->subscribe.handler = iotc_make_handle(
+          &iotc_user_sub_call_wrapper, iotc_context, NULL, IOTC_STATE_OK,
+          (void*)&successful_subscribe_handler, (void*)NULL,
+          (void*)task->data.data_u);
 
       // set the msg data
       IOTC_ALLOC_AT(iotc_mqtt_message_t, msg, local_state);
@@ -209,9 +136,11 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       iotc_mqtt_logic_layer_data_t logic_layer_data;
       memset(&logic_layer_data, 0, sizeof(iotc_mqtt_logic_layer_data_t));
 
-      logic_layer_data.q12_tasks_queue = task;
+      tt_want_int_op(
+          iotc_mqtt_logic_in_flight_add(&logic_layer_data.q12_tasks_queue, task),
+          ==, IOTC_STATE_OK);
 
-      logic_layer_data.handlers_for_topics = iotc_vector_create();
+      logic_layer_data.handlers_for_topics = iotc_topic_trie_create();
 
       iotc_layer_t* layer = iotc_context->layer_chain.bottom;
       layer->user_data = &logic_layer_data;
@@ -221,9 +150,9 @@ IOTC_TT_TESTCASE_WITH_SETUP(
           do_mqtt_subscribe(&layer->layer_connection, task, IOTC_STATE_OK, msg),
           ==, IOTC_STATE_OK);
       tt_want_int_op(logic_layer_data.handlers_for_topics->elem_no, ==, 1);
-      tt_want_ptr_op(
-          logic_layer_data.handlers_for_topics->array[0].selector_t.ptr_value,
-          ==, data_u);
+      tt_want_int_op(iotc_topic_trie_remove(logic_layer_data.handlers_for_topics,
+                                            "test/topic", data_u),
+                     ==, IOTC_STATE_OK);
 
       // make the handler to be called
       iotc_evtd_step(iotc_globals.evtd_instance, 20);
@@ -232,10 +161,10 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       global_value_to_test = 0;
 
       IOTC_SAFE_FREE(data_u);
-      iotc_vector_del(logic_layer_data.handlers_for_topics, 0);
 
       logic_layer_data.handlers_for_topics =
-          iotc_vector_destroy(logic_layer_data.handlers_for_topics);
+          iotc_topic_trie_destroy(logic_layer_data.handlers_for_topics);
+      iotc_mqtt_logic_in_flight_detach_all(&logic_layer_data.q12_tasks_queue);
 
       iotc_delete_context(iotc_context_handle);
 
@@ -271,7 +200,7 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       // set the task data
       IOTC_ALLOC_AT(iotc_mqtt_logic_task_t, task, local_state);
 
-      task->cs = 118;  // this is very hakish since it depends on the code
+      task->cs = 121;  // this is very hakish since it depends on the code
       // so most probably this test will fail everytime we change anything in
       // tested function which is not too good at least you know what to check
       // if the test fails
@@ -287,9 +216,9 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       IOTC_ALLOC_AT(iotc_mqtt_task_specific_data_t, task->data.data_u,
                     local_state);
 
-      task->data.data_u->subscribe.handler = iotc_make_threaded_handle(
-          IOTC_THREADID_THREAD_0, &iotc_user_sub_call_wrapper, iotc_context,
-          NULL, IOTC_STATE_OK, (void*)&failed_subscribe_handler, (void*)NULL,
+      task->data.data_u->subscribe.handler = iotc_make_handle(
+          &iotc_user_sub_call_wrapper, iotc_context, NULL, IOTC_STATE_OK,
+          (void*)&failed_subscribe_handler, (void*)NULL,
           (void*)task->data.data_u);
 
       // set the msg data
@@ -304,9 +233,11 @@ IOTC_TT_TESTCASE_WITH_SETUP(
       iotc_mqtt_logic_layer_data_t logic_layer_data;
       memset(&logic_layer_data, 0, sizeof(iotc_mqtt_logic_layer_data_t));
 
-      logic_layer_data.q12_tasks_queue = task;
+      tt_want_int_op(
+          iotc_mqtt_logic_in_flight_add(&logic_layer_data.q12_tasks_queue, task),
+          ==, IOTC_STATE_OK);
 
-      logic_layer_data.handlers_for_topics = iotc_vector_create();
+      logic_layer_data.handlers_for_topics = iotc_topic_trie_create();
 
       iotc_layer_t* layer = iotc_context->layer_chain.bottom;
       layer->user_data = &logic_layer_data;
@@ -326,7 +257,8 @@ IOTC_TT_TESTCASE_WITH_SETUP(
 
       iotc_delete_context(iotc_context_handle);
       logic_layer_data.handlers_for_topics =
-          iotc_vector_destroy(logic_layer_data.handlers_for_topics);
+          iotc_topic_trie_destroy(logic_layer_data.handlers_for_topics);
+      iotc_mqtt_logic_in_flight_detach_all(&logic_layer_data.q12_tasks_queue);
 
       return;
 
@@ -20,7 +20,10 @@
 
 #include "iotc.h"
 #include "iotc_globals.h"
+#include "iotc_config.h"
 #include "iotc_helpers.h"
+#include "iotc_macros.h"
+#include "iotc_mqtt_message.h"
 #include "iotc_mqtt_parser.h"
 
 #include "iotc_memory_checks.h"
@@ -35,6 +38,62 @@
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
+#define UTEST_PARSER_TOPIC "a/topic"
+#define UTEST_PARSER_PAYLOAD_SIZE 300
+
+/* Encodes a QoS 1 PUBLISH with a payload of increasing byte values. */
+static size_t utest_parser_make_publish(uint8_t* out) {
+  const size_t topic_len = strlen(UTEST_PARSER_TOPIC);
+  const size_t remaining_length = 2 + topic_len + 2 + UTEST_PARSER_PAYLOAD_SIZE;
+  size_t pos = 0;
+  size_t i = 0;
+
+  out[pos++] = 0x32;
+  out[pos++] = (uint8_t)(0x80 | (remaining_length & 0x7f));
+  out[pos++] = (uint8_t)(remaining_length >> 7);
+  out[pos++] = 0;
+  out[pos++] = (uint8_t)topic_len;
+  memcpy(out + pos, UTEST_PARSER_TOPIC, topic_len);
+  pos += topic_len;
+  out[pos++] = 0x12;
+  out[pos++] = 0x34;
+
+  for (i = 0; i < UTEST_PARSER_PAYLOAD_SIZE; ++i) {
+    out[pos++] = (uint8_t)i;
+  }
+
+  return pos;
+}
+
+/* Feeds the encoded message to the parser in chunks of chunk_size bytes, the
+ * way the layers below hand over the receive buffer. */
+static iotc_state_t utest_parser_parse_in_chunks(const uint8_t* encoded,
+                                                 size_t encoded_len,
+                                                 size_t chunk_size,
+                                                 iotc_mqtt_message_t* msg) {
+  iotc_mqtt_parser_t parser;
+  iotc_state_t state = IOTC_STATE_WANT_READ;
+  size_t offset = 0;
+
+  iotc_mqtt_parser_init(&parser);
+
+  while (IOTC_STATE_WANT_READ == state && offset < encoded_len) {
+    const size_t len = IOTC_MIN(chunk_size, encoded_len - offset);
+    iotc_data_desc_t* chunk =
+        iotc_make_desc_from_buffer_copy(encoded + offset, len);
+
+    if (NULL == chunk) {
+      return IOTC_OUT_OF_MEMORY;
+    }
+
+    state = iotc_mqtt_parser_execute(&parser, msg, chunk);
+    offset += chunk->curr_pos;
+    iotc_free_desc(&chunk);
+  }
+
+  return state;
+}
+
 #endif
 
 IOTC_TT_TESTGROUP_BEGIN(utest_mqtt_parser)
@@ -100,6 +159,112 @@ IOTC_TT_TESTCASE(utest__parse_suback_response__invalid_data__parser_error, {
   tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
 })
 
+IOTC_TT_TESTCASE(
+    utest__parser_execute__publish_in_chunks__fields_read_into_sized_buffers, {
+      uint8_t encoded[UTEST_PARSER_PAYLOAD_SIZE + 32];
+      const size_t encoded_len = utest_parser_make_publish(encoded);
+      const size_t chunk_sizes[] = {1, 7, 32, 4096};
+      size_t i = 0;
+      size_t j = 0;
+
+      for (i = 0; i < IOTC_ARRAYSIZE(chunk_sizes); ++i) {
+        iotc_mqtt_message_t* msg = NULL;
+        iotc_state_t state = IOTC_STATE_OK;
+
+        IOTC_ALLOC_AT(iotc_mqtt_message_t, msg, state);
+
+        state = utest_parser_parse_in_chunks(encoded, encoded_len,
+                                             chunk_sizes[i], msg);
+        tt_want_int_op(state, ==, IOTC_STATE_OK);
+
+        tt_want_int_op(msg->publish.message_id, ==, 0x1234);
+        tt_want_uint_op(msg->publish.topic_name->length, ==,
+                        strlen(UTEST_PARSER_TOPIC));
+        tt_want_str_op((const char*)msg->publish.topic_name->data_ptr, ==,
+                       UTEST_PARSER_TOPIC);
+
+        /* one allocation per field regardless of how the input was split */
+        tt_want_uint_op(msg->publish.content->length, ==,
+                        UTEST_PARSER_PAYLOAD_SIZE);
+        tt_want_uint_op(msg->publish.content->capacity, ==,
+                        UTEST_PARSER_PAYLOAD_SIZE + 1);
+
+        for (j = 0; j < UTEST_PARSER_PAYLOAD_SIZE; ++j) {
+          if (msg->publish.content->data_ptr[j] != (uint8_t)j) {
+            tt_fail_msg("payload corrupted");
+            break;
+          }
+        }
+
+      err_handling:
+        iotc_mqtt_message_free(&msg);
+      }
+
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+
+IOTC_TT_TESTCASE(
+    utest__parser_execute__two_parsers_interleaved__both_messages_intact, {
+      uint8_t encoded[UTEST_PARSER_PAYLOAD_SIZE + 32];
+      const size_t encoded_len = utest_parser_make_publish(encoded);
+      iotc_mqtt_parser_t parsers[2];
+      iotc_mqtt_message_t* msgs[2] = {NULL, NULL};
+      iotc_state_t states[2] = {IOTC_STATE_WANT_READ, IOTC_STATE_WANT_READ};
+      iotc_state_t state = IOTC_STATE_OK;
+      size_t offset = 0;
+      size_t i = 0;
+
+      for (i = 0; i < 2; ++i) {
+        iotc_mqtt_parser_init(&parsers[i]);
+        IOTC_ALLOC_AT(iotc_mqtt_message_t, msgs[i], state);
+      }
+
+      /* one byte to each parser in turn, as two connections would */
+      for (offset = 0; offset < encoded_len; ++offset) {
+        for (i = 0; i < 2; ++i) {
+          iotc_data_desc_t* chunk =
+              iotc_make_desc_from_buffer_copy(encoded + offset, 1);
+          tt_want_ptr_op(chunk, !=, NULL);
+
+          if (NULL != chunk) {
+            states[i] = iotc_mqtt_parser_execute(&parsers[i], msgs[i], chunk);
+            iotc_free_desc(&chunk);
+          }
+        }
+      }
+
+      for (i = 0; i < 2; ++i) {
+        tt_want_int_op(states[i], ==, IOTC_STATE_OK);
+        tt_want_int_op(msgs[i]->publish.message_id, ==, 0x1234);
+        tt_want_str_op((const char*)msgs[i]->publish.topic_name->data_ptr, ==,
+                       UTEST_PARSER_TOPIC);
+        tt_want_uint_op(msgs[i]->publish.content->length, ==,
+                        UTEST_PARSER_PAYLOAD_SIZE);
+      }
+
+    err_handling:
+      iotc_mqtt_message_free(&msgs[0]);
+      iotc_mqtt_message_free(&msgs[1]);
+
+      tt_want_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    })
+
+IOTC_TT_TESTCASE(utest__set_receive_buffer_size__out_of_range__rejected, {
+  const size_t default_size = iotc_get_receive_buffer_size();
+
+  tt_want_int_op(iotc_set_receive_buffer_size(IOTC_IO_BUFFER_SIZE_MIN - 1), ==,
+                 IOTC_INVALID_PARAMETER);
+  tt_want_int_op(iotc_set_receive_buffer_size(IOTC_IO_BUFFER_SIZE_MAX + 1), ==,
+                 IOTC_INVALID_PARAMETER);
+  tt_want_uint_op(iotc_get_receive_buffer_size(), ==, default_size);
+
+  tt_want_int_op(iotc_set_receive_buffer_size(IOTC_IO_BUFFER_SIZE_MAX), ==,
+                 IOTC_STATE_OK);
+  tt_want_uint_op(iotc_get_receive_buffer_size(), ==, IOTC_IO_BUFFER_SIZE_MAX);
+
+  iotc_set_receive_buffer_size(default_size);
+})
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -0,0 +1,482 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "iotc_tt_testcase_management.h"
+#include "iotc_utest_basic_testcase_frame.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc.h"
+#include "iotc_globals.h"
+#include "iotc_event_dispatcher_api.h"
+#include "iotc_handle.h"
+#include "iotc_internals.h"
+#include "iotc_offline_queue.h"
+#include "iotc_types_internal.h"
+
+#include <iotc_error.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+#define IOTC_UTEST_OFFLINE_QUEUE_NAME "offline_queue.utest_file"
+#define IOTC_UTEST_OFFLINE_QUEUE_TOPIC "t/a"
+/* 8 bytes of header, 3 of topic and 10 of payload */
+#define IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE 21
+
+static void iotc_utest_offline_queue_remove_files(void) {
+  char name[64];
+  uint32_t seq = 0;
+
+  for (; seq < 16; ++seq) {
+    snprintf(name, sizeof(name), "%s.%u", IOTC_UTEST_OFFLINE_QUEUE_NAME,
+             (unsigned)seq);
+    iotc_internals.fs_functions.remove_resource(NULL, IOTC_FS_CONFIG_DATA,
+                                                name);
+  }
+
+  iotc_internals.fs_functions.remove_resource(
+      NULL, IOTC_FS_CONFIG_DATA, IOTC_UTEST_OFFLINE_QUEUE_NAME ".idx");
+}
+
+static uint8_t iotc_utest_offline_queue_segment_exists(uint32_t seq) {
+  char name[64];
+  iotc_fs_stat_t stat;
+
+  snprintf(name, sizeof(name), "%s.%u", IOTC_UTEST_OFFLINE_QUEUE_NAME,
+           (unsigned)seq);
+
+  return IOTC_STATE_OK == iotc_internals.fs_functions.stat_resource(
+                              NULL, IOTC_FS_CONFIG_DATA, name, &stat);
+}
+
+/* appends a 10 byte payload made of the digit */
+static iotc_state_t iotc_utest_offline_queue_append(
+    iotc_context_data_t* context_data, char digit) {
+  uint8_t bytes[10];
+  iotc_data_desc_t payload;
+  iotc_event_handle_t no_callback = iotc_make_empty_event_handle();
+
+  memset(bytes, digit, sizeof(bytes));
+  memset(&payload, 0, sizeof(payload));
+  payload.data_ptr = bytes;
+  payload.length = sizeof(bytes);
+  payload.capacity = sizeof(bytes);
+
+  return iotc_offline_queue_append(context_data, IOTC_UTEST_OFFLINE_QUEUE_TOPIC,
+                                   &payload, IOTC_MQTT_QOS_AT_LEAST_ONCE,
+                                   IOTC_MQTT_RETAIN_FALSE, no_callback);
+}
+
+/* the digit of the oldest message not handed out yet, 0 if it doesn't look
+ * like one, the message stays in flight under out_id */
+static char iotc_utest_offline_queue_pop_in_flight(iotc_offline_queue_t* queue,
+                                                   uint32_t* out_id) {
+  char* topic = NULL;
+  iotc_data_desc_t* payload = NULL;
+  iotc_mqtt_qos_t qos = IOTC_MQTT_QOS_AT_MOST_ONCE;
+  iotc_mqtt_retain_t retain = IOTC_MQTT_RETAIN_TRUE;
+  char digit = 0;
+
+  if (IOTC_STATE_OK != iotc_offline_queue_pop(queue, &topic, &payload, &qos,
+                                              &retain, out_id)) {
+    return 0;
+  }
+
+  if (0 == strcmp(topic, IOTC_UTEST_OFFLINE_QUEUE_TOPIC) &&
+      10 == payload->length && IOTC_MQTT_QOS_AT_LEAST_ONCE == qos &&
+      IOTC_MQTT_RETAIN_FALSE == retain &&
+      payload->data_ptr[0] == payload->data_ptr[9]) {
+    digit = (char)payload->data_ptr[0];
+  }
+
+  iotc_free(topic);
+  iotc_free_desc(&payload);
+
+  return digit;
+}
+
+/* the digit of the oldest message, delivered right away */
+static char iotc_utest_offline_queue_pop(iotc_context_data_t* context_data) {
+  uint32_t id = 0;
+  const char digit =
+      iotc_utest_offline_queue_pop_in_flight(context_data->offline_queue, &id);
+
+  if (0 == digit || IOTC_STATE_OK != iotc_offline_queue_delivered(
+                                         context_data, id, IOTC_STATE_OK)) {
+    return 0;
+  }
+
+  return digit;
+}
+
+static uint32_t iotc_utest_offline_queue_callback_calls = 0;
+static iotc_state_t iotc_utest_offline_queue_callback_state = IOTC_STATE_OK;
+
+static iotc_state_t iotc_utest_offline_queue_callback(void* context,
+                                                      void* data,
+                                                      iotc_state_t state) {
+  IOTC_UNUSED(context);
+  IOTC_UNUSED(data);
+
+  ++iotc_utest_offline_queue_callback_calls;
+  iotc_utest_offline_queue_callback_state = state;
+
+  return IOTC_STATE_OK;
+}
+
+static void iotc_utest_offline_queue_run_events(
+    iotc_context_data_t* context_data) {
+  while (iotc_evtd_single_step(context_data->evtd_instance,
+                               context_data->evtd_instance->current_step))
+    ;
+}
+
+static iotc_context_data_t* iotc_utest_offline_queue_context_data(
+    iotc_context_handle_t iotc_context_handle) {
+  iotc_context_t* iotc_context = iotc_object_for_handle(
+      iotc_globals.context_handles_vector, iotc_context_handle);
+
+  return (NULL != iotc_context) ? &iotc_context->context_data : NULL;
+}
+
+#endif
+
+IOTC_TT_TESTGROUP_BEGIN(utest_offline_queue)
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_offline_queue__context_deleted__messages_read_in_order_by_the_next_queue,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      iotc_offline_queue_config_t config = {IOTC_UTEST_OFFLINE_QUEUE_NAME, 1024,
+                                            64, IOTC_OFFLINE_QUEUE_DROP_NEWEST};
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_data_t* context_data =
+          iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+
+      /* not connected */
+      tt_assert(iotc_offline_queue_takes(context_data));
+
+      char digit = '0';
+      for (; digit < '5'; ++digit) {
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_utest_offline_queue_append(context_data, digit));
+      }
+
+      /* the buffered messages are written when the context goes */
+      iotc_delete_context(iotc_context_handle);
+
+      iotc_context_handle = iotc_create_context();
+      context_data = iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+
+      iotc_offline_queue_t* queue = context_data->offline_queue;
+      tt_assert(5 * IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE == queue->size);
+      tt_assert(queue->head_seq != queue->tail_seq);
+
+      for (digit = '0'; digit < '5'; ++digit) {
+        tt_assert(digit == iotc_utest_offline_queue_pop(context_data));
+      }
+
+      /* the drained segments are gone */
+      tt_assert(0 == queue->size);
+      tt_assert(!iotc_utest_offline_queue_segment_exists(0));
+      tt_assert(!iotc_utest_offline_queue_segment_exists(1));
+      tt_assert(!iotc_utest_offline_queue_segment_exists(2));
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_offline_queue_append__drop_newest_and_full__message_rejected,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      iotc_offline_queue_config_t config = {
+          IOTC_UTEST_OFFLINE_QUEUE_NAME,
+          2 * IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE,
+          IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE, IOTC_OFFLINE_QUEUE_DROP_NEWEST};
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_data_t* context_data =
+          iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_utest_offline_queue_append(context_data, '0'));
+      tt_assert(IOTC_STATE_OK ==
+                iotc_utest_offline_queue_append(context_data, '1'));
+      tt_assert(IOTC_OFFLINE_QUEUE_FULL ==
+                iotc_utest_offline_queue_append(context_data, '2'));
+
+      tt_assert('0' == iotc_utest_offline_queue_pop(context_data));
+      tt_assert('1' == iotc_utest_offline_queue_pop(context_data));
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_offline_queue_append__drop_oldest_and_full__oldest_segment_dropped,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      /* a segment per message */
+      iotc_offline_queue_config_t config = {
+          IOTC_UTEST_OFFLINE_QUEUE_NAME,
+          3 * IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE,
+          IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE, IOTC_OFFLINE_QUEUE_DROP_OLDEST};
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_data_t* context_data =
+          iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+
+      char digit = '0';
+      for (; digit < '4'; ++digit) {
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_utest_offline_queue_append(context_data, digit));
+      }
+
+      iotc_offline_queue_t* queue = context_data->offline_queue;
+      tt_assert(3 * IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE == queue->size);
+      tt_assert(!iotc_utest_offline_queue_segment_exists(0));
+
+      for (digit = '1'; digit < '4'; ++digit) {
+        tt_assert(digit == iotc_utest_offline_queue_pop(context_data));
+      }
+
+      tt_assert(0 == queue->size);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_publish__not_connected__message_queued,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      iotc_offline_queue_config_t config = {IOTC_UTEST_OFFLINE_QUEUE_NAME, 1024,
+                                            64, IOTC_OFFLINE_QUEUE_DROP_NEWEST};
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_data_t* context_data =
+          iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+      tt_assert(IOTC_STATE_OK ==
+                iotc_publish(iotc_context_handle,
+                             IOTC_UTEST_OFFLINE_QUEUE_TOPIC, "0000000000",
+                             IOTC_MQTT_QOS_AT_LEAST_ONCE, NULL, NULL));
+
+      tt_assert('0' == iotc_utest_offline_queue_pop(context_data));
+
+      /* a queue going away keeps its files */
+      tt_assert(IOTC_STATE_OK == iotc_set_offline_queue(iotc_context_handle, NULL));
+      tt_assert(NULL == context_data->offline_queue);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_offline_queue_delivered__one_failed__failed_and_later_read_again,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      iotc_offline_queue_config_t config = {IOTC_UTEST_OFFLINE_QUEUE_NAME, 1024,
+                                            64, IOTC_OFFLINE_QUEUE_DROP_NEWEST};
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_data_t* context_data =
+          iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+
+      char digit = '0';
+      for (; digit < '3'; ++digit) {
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_utest_offline_queue_append(context_data, digit));
+      }
+
+      iotc_offline_queue_t* queue = context_data->offline_queue;
+      uint32_t ids[3] = {0, 0, 0};
+
+      tt_assert('0' == iotc_utest_offline_queue_pop_in_flight(queue, &ids[0]));
+      tt_assert('1' == iotc_utest_offline_queue_pop_in_flight(queue, &ids[1]));
+      tt_assert('2' == iotc_utest_offline_queue_pop_in_flight(queue, &ids[2]));
+
+      /* delivered out of order, the head waits for the first one */
+      tt_assert(IOTC_STATE_OK == iotc_offline_queue_delivered(
+                                     context_data, ids[1], IOTC_STATE_OK));
+      tt_assert(3 * IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE == queue->size);
+
+      tt_assert(IOTC_STATE_OK == iotc_offline_queue_delivered(
+                                     context_data, ids[0], IOTC_STATE_OK));
+      tt_assert(IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE == queue->size);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_offline_queue_delivered(context_data, ids[2],
+                                             IOTC_SOCKET_WRITE_ERROR));
+      tt_assert(IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE == queue->size);
+      tt_assert(iotc_offline_queue_takes(context_data));
+
+      tt_assert('2' == iotc_utest_offline_queue_pop(context_data));
+      tt_assert(0 == queue->size);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_offline_queue_connected__message_in_flight__message_read_again,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      iotc_offline_queue_config_t config = {IOTC_UTEST_OFFLINE_QUEUE_NAME, 1024,
+                                            64, IOTC_OFFLINE_QUEUE_DROP_NEWEST};
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_t* iotc_context = iotc_object_for_handle(
+          iotc_globals.context_handles_vector, iotc_context_handle);
+      tt_assert(NULL != iotc_context);
+
+      iotc_context_data_t* context_data = &iotc_context->context_data;
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+      tt_assert(IOTC_STATE_OK ==
+                iotc_utest_offline_queue_append(context_data, '0'));
+      tt_assert(IOTC_STATE_OK ==
+                iotc_utest_offline_queue_append(context_data, '1'));
+
+      uint32_t id = 0;
+      tt_assert('0' == iotc_utest_offline_queue_pop_in_flight(
+                           context_data->offline_queue, &id));
+
+      /* the connection went down before delivering it */
+      tt_assert(IOTC_STATE_OK ==
+                iotc_offline_queue_connected(
+                    &iotc_context->layer_chain.top->layer_connection));
+
+      /* a late completion of the lost connection is ignored */
+      tt_assert(IOTC_STATE_OK == iotc_offline_queue_delivered(
+                                     context_data, id, IOTC_STATE_OK));
+      tt_assert(2 * IOTC_UTEST_OFFLINE_QUEUE_RECORD_SIZE ==
+                context_data->offline_queue->size);
+
+      tt_assert('0' == iotc_utest_offline_queue_pop(context_data));
+      tt_assert('1' == iotc_utest_offline_queue_pop(context_data));
+      tt_assert(0 == context_data->offline_queue->size);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_offline_queue_append__with_callback__called_once_delivered,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_utest_offline_queue_remove_files();
+
+      iotc_offline_queue_config_t config = {IOTC_UTEST_OFFLINE_QUEUE_NAME, 1024,
+                                            64, IOTC_OFFLINE_QUEUE_DROP_NEWEST};
+      uint8_t bytes[10];
+      iotc_data_desc_t payload;
+
+      memset(bytes, '0', sizeof(bytes));
+      memset(&payload, 0, sizeof(payload));
+      payload.data_ptr = bytes;
+      payload.length = sizeof(bytes);
+      payload.capacity = sizeof(bytes);
+
+      iotc_utest_offline_queue_callback_calls = 0;
+      iotc_utest_offline_queue_callback_state = IOTC_STATE_TIMEOUT;
+
+      iotc_context_handle_t iotc_context_handle = iotc_create_context();
+      iotc_context_data_t* context_data =
+          iotc_utest_offline_queue_context_data(iotc_context_handle);
+      tt_assert(NULL != context_data);
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_set_offline_queue(iotc_context_handle, &config));
+      tt_assert(IOTC_STATE_OK ==
+                iotc_offline_queue_append(
+                    context_data, IOTC_UTEST_OFFLINE_QUEUE_TOPIC, &payload,
+                    IOTC_MQTT_QOS_AT_LEAST_ONCE, IOTC_MQTT_RETAIN_FALSE,
+                    iotc_make_handle(&iotc_utest_offline_queue_callback, NULL,
+                                     NULL, IOTC_STATE_OK)));
+
+      iotc_utest_offline_queue_run_events(context_data);
+      tt_assert(0 == iotc_utest_offline_queue_callback_calls);
+
+      uint32_t id = 0;
+      tt_assert('0' == iotc_utest_offline_queue_pop_in_flight(
+                           context_data->offline_queue, &id));
+      tt_assert(IOTC_STATE_OK ==
+                iotc_offline_queue_delivered(context_data, id,
+                                             IOTC_SOCKET_WRITE_ERROR));
+
+      iotc_utest_offline_queue_run_events(context_data);
+      tt_assert(0 == iotc_utest_offline_queue_callback_calls);
+
+      tt_assert('0' == iotc_utest_offline_queue_pop(context_data));
+
+      iotc_utest_offline_queue_run_events(context_data);
+      tt_assert(1 == iotc_utest_offline_queue_callback_calls);
+      tt_assert(IOTC_STATE_OK == iotc_utest_offline_queue_callback_state);
+
+    end:
+      iotc_delete_context(iotc_context_handle);
+      iotc_utest_offline_queue_remove_files();
+    })
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -20,6 +20,7 @@
 #include "tinytest_macros.h"
 
 #include "iotc.h"
+#include "iotc_config.h"
 #include "iotc_macros.h"
 
 #include <errno.h>
@@ -35,6 +36,29 @@ const int max_csv_string_size = 1024;
 
 IOTC_TT_TESTGROUP_BEGIN(utest_publish)
 
+IOTC_TT_TESTCASE(utest__set_publish_coalescing__budget_out_of_range__rejected, {
+  tt_want_int_op(
+      iotc_set_publish_coalescing(IOTC_PUBLISH_COALESCING_MAX_BYTES + 1, 0),
+      ==, IOTC_INVALID_PARAMETER);
+
+  tt_want_int_op(
+      iotc_set_publish_coalescing(IOTC_PUBLISH_COALESCING_MAX_BYTES, 0), ==,
+      IOTC_STATE_OK);
+
+  tt_want_int_op(iotc_set_publish_coalescing(0, 0), ==, IOTC_STATE_OK);
+})
+
+IOTC_TT_TESTCASE(utest__reset_io_stats__counters_zeroed, {
+  iotc_io_stats_t stats;
+
+  iotc_reset_io_stats();
+  iotc_get_io_stats(&stats);
+
+  tt_want_uint_op(stats.messages_sent, ==, 0);
+  tt_want_uint_op(stats.socket_writes, ==, 0);
+  tt_want_uint_op(stats.tls_records, ==, 0);
+})
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
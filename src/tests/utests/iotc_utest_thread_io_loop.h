@@ -0,0 +1,266 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "iotc_tt_testcase_management.h"
+#include "iotc_utest_basic_testcase_frame.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc.h"
+#include "iotc_globals.h"
+#include "iotc_handle.h"
+#include "iotc_thread_io_loop.h"
+
+#include <unistd.h>
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+typedef struct iotc_utest_local_io_loop_probe_s {
+  struct iotc_io_loop_s* io_loop;
+  uint32_t on_loop_thread;
+  uint32_t done;
+} iotc_utest_local_io_loop_probe_t;
+
+iotc_state_t iotc_utest_local_action_probe_io_loop(
+    iotc_event_handle_arg1_t data) {
+  iotc_utest_local_io_loop_probe_t* probe =
+      (iotc_utest_local_io_loop_probe_t*)data;
+
+  probe->on_loop_thread = iotc_io_loop_is_current_thread(probe->io_loop);
+  __atomic_store_n(&probe->done, 1, __ATOMIC_RELEASE);
+
+  return IOTC_STATE_OK;
+}
+
+iotc_context_t* iotc_utest_local_context(iotc_context_handle_t handle) {
+  return (iotc_context_t*)iotc_object_for_handle(
+      iotc_globals.context_handles_vector, handle);
+}
+
+static iotc_state_t iotc_utest_local_connect_state = IOTC_STATE_OK;
+
+void iotc_utest_local_connect_callback(iotc_context_handle_t in_context_handle,
+                                       void* data, iotc_state_t state) {
+  IOTC_UNUSED(in_context_handle);
+  IOTC_UNUSED(data);
+
+  __atomic_store_n(&iotc_utest_local_connect_state, state, __ATOMIC_RELEASE);
+}
+
+#endif  // IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+IOTC_TT_TESTGROUP_BEGIN(utest_thread_io_loop)
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_set_io_threads__invalid_or_late_request__rejected,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_context_handle_t context_handle = IOTC_INVALID_CONTEXT_HANDLE;
+
+      tt_want_int_op(IOTC_INVALID_PARAMETER, ==,
+                     iotc_set_io_threads(IOTC_MAX_IO_THREADS + 1));
+      tt_want_int_op(IOTC_STATE_OK, ==, iotc_set_io_threads(2));
+
+      context_handle = iotc_create_context();
+      tt_assert(IOTC_INVALID_CONTEXT_HANDLE < context_handle);
+
+      /* the running contexts keep their loops */
+      tt_want_int_op(IOTC_ALREADY_INITIALIZED, ==, iotc_set_io_threads(0));
+
+    end:
+      if (IOTC_INVALID_CONTEXT_HANDLE < context_handle) {
+        iotc_delete_context(context_handle);
+      }
+
+      tt_want_int_op(IOTC_STATE_OK, ==, iotc_set_io_threads(0));
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_create_context__io_threads__contexts_assigned_in_turns,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_context_handle_t context_handles[2] = {
+          IOTC_INVALID_CONTEXT_HANDLE, IOTC_INVALID_CONTEXT_HANDLE};
+      iotc_context_t* contexts[2] = {NULL};
+
+      tt_assert(IOTC_STATE_OK == iotc_set_io_threads(2));
+
+      size_t i = 0;
+      for (; i < IOTC_ARRAYSIZE(context_handles); ++i) {
+        context_handles[i] = iotc_create_context();
+        tt_assert(IOTC_INVALID_CONTEXT_HANDLE < context_handles[i]);
+
+        contexts[i] = iotc_utest_local_context(context_handles[i]);
+        tt_assert(NULL != contexts[i]);
+        tt_assert(NULL != contexts[i]->context_data.io_loop);
+        tt_assert(iotc_globals.evtd_instance !=
+                  contexts[i]->context_data.evtd_instance);
+        tt_assert(contexts[i]->context_data.evtd_instance ==
+                  contexts[i]->context_data.backoff_status.evtd_instance);
+      }
+
+      tt_assert(contexts[0]->context_data.io_loop !=
+                contexts[1]->context_data.io_loop);
+      tt_assert(contexts[0]->context_data.evtd_instance !=
+                contexts[1]->context_data.evtd_instance);
+
+    end:
+      for (i = 0; i < IOTC_ARRAYSIZE(context_handles); ++i) {
+        if (IOTC_INVALID_CONTEXT_HANDLE < context_handles[i]) {
+          iotc_delete_context(context_handles[i]);
+        }
+      }
+
+      iotc_set_io_threads(0);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_evtd_execute__io_loop_evtd__handle_runs_on_the_loop_thread,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_context_handle_t context_handle = IOTC_INVALID_CONTEXT_HANDLE;
+      iotc_utest_local_io_loop_probe_t probe = {NULL, 0, 0};
+
+      tt_assert(IOTC_STATE_OK == iotc_set_io_threads(1));
+
+      context_handle = iotc_create_context();
+      tt_assert(IOTC_INVALID_CONTEXT_HANDLE < context_handle);
+
+      iotc_context_t* context = iotc_utest_local_context(context_handle);
+      tt_assert(NULL != context);
+
+      probe.io_loop = context->context_data.io_loop;
+      tt_assert(0 == iotc_io_loop_is_current_thread(probe.io_loop));
+
+      tt_assert(NULL !=
+                iotc_evtd_execute(
+                    context->context_data.evtd_instance,
+                    iotc_make_handle(&iotc_utest_local_action_probe_io_loop,
+                                     &probe)));
+
+      /* the pipe wakes the loop up long before its idle timeout */
+      int wait_ms = 0;
+      for (; wait_ms < 1000 && 0 == __atomic_load_n(&probe.done,
+                                                      __ATOMIC_ACQUIRE);
+           ++wait_ms) {
+        usleep(1000);
+      }
+
+      tt_want_int_op(1, ==, probe.done);
+      tt_want_int_op(1, ==, probe.on_loop_thread);
+
+    end:
+      /* stop and join the loop before the context goes away */
+      iotc_events_stop();
+      iotc_events_process_blocking();
+
+      if (IOTC_INVALID_CONTEXT_HANDLE < context_handle) {
+        iotc_delete_context(context_handle);
+      }
+
+      iotc_set_io_threads(0);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_shutdown_connection__other_thread__handed_over_to_the_loop,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_context_handle_t context_handle = IOTC_INVALID_CONTEXT_HANDLE;
+
+      context_handle = iotc_create_context();
+      tt_assert(IOTC_INVALID_CONTEXT_HANDLE < context_handle);
+
+      /* checked right away without I/O threads */
+      tt_want_int_op(IOTC_SOCKET_NO_ACTIVE_CONNECTION_ERROR, ==,
+                     iotc_shutdown_connection(context_handle));
+
+      iotc_delete_context(context_handle);
+
+      tt_assert(IOTC_STATE_OK == iotc_set_io_threads(1));
+
+      context_handle = iotc_create_context();
+      tt_assert(IOTC_INVALID_CONTEXT_HANDLE < context_handle);
+
+      /* checked on the loop, the caller only learns about the handover */
+      tt_want_int_op(IOTC_STATE_OK, ==,
+                     iotc_shutdown_connection(context_handle));
+
+    end:
+      iotc_events_stop();
+      iotc_events_process_blocking();
+
+      if (IOTC_INVALID_CONTEXT_HANDLE < context_handle) {
+        iotc_delete_context(context_handle);
+      }
+
+      iotc_set_io_threads(0);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_connect__other_thread__second_request_rejected_on_the_loop,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_context_handle_t context_handle = IOTC_INVALID_CONTEXT_HANDLE;
+
+      __atomic_store_n(&iotc_utest_local_connect_state, IOTC_STATE_OK,
+                       __ATOMIC_RELEASE);
+
+      tt_assert(IOTC_STATE_OK == iotc_set_io_threads(1));
+
+      context_handle = iotc_create_context();
+      tt_assert(IOTC_INVALID_CONTEXT_HANDLE < context_handle);
+
+      iotc_context_t* context = iotc_utest_local_context(context_handle);
+      tt_assert(NULL != context);
+
+      /* keeps the first connection attempt pending on the loop */
+      context->context_data.backoff_status.delay_ms = 60000;
+
+      tt_want_int_op(IOTC_STATE_OK, ==,
+                     iotc_connect_to(context_handle, "localhost", 8883, NULL,
+                                     NULL, "client_id", 10, 20,
+                                     &iotc_utest_local_connect_callback));
+
+      /* the context is left alone until the loop takes the request */
+      tt_want_int_op(IOTC_STATE_OK, ==,
+                     iotc_connect_to(context_handle, "localhost", 8883, NULL,
+                                     NULL, "client_id", 10, 20,
+                                     &iotc_utest_local_connect_callback));
+
+      int wait_ms = 0;
+      while (wait_ms++ < 1000 &&
+             IOTC_STATE_OK == __atomic_load_n(&iotc_utest_local_connect_state,
+                                              __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+      }
+
+      tt_want_int_op(IOTC_ALREADY_INITIALIZED, ==,
+                     iotc_utest_local_connect_state);
+
+    end:
+      iotc_events_stop();
+      iotc_events_process_blocking();
+
+      if (IOTC_INVALID_CONTEXT_HANDLE < context_handle) {
+        iotc_delete_context(context_handle);
+      }
+
+      iotc_set_io_threads(0);
+    })
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif  // IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
@@ -21,6 +21,9 @@
 #include "iotc_thread_ids.h"
 #include "iotc_thread_threadpool.h"
 
+#include <string.h>
+#include <unistd.h>
+
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
 #include "iotc_utest_thread_util_actions.h"
@@ -44,6 +47,38 @@ void iotc_utest_local__add_handler__threadpool(
   }
 }
 
+#define IOTC_UTEST_THREADPOOL_ORDERED_EVENTS 500
+
+typedef struct iotc_utest_local_ordered_record_s {
+  uint32_t values[IOTC_UTEST_THREADPOOL_ORDERED_EVENTS];
+  uint32_t count;
+} iotc_utest_local_ordered_record_t;
+
+iotc_state_t iotc_utest_local_action_record_value(
+    iotc_event_handle_arg1_t record, iotc_event_handle_arg2_t value) {
+  iotc_utest_local_ordered_record_t* ordered_record =
+      (iotc_utest_local_ordered_record_t*)record;
+
+  /* no lock, the events of a key never run in parallel */
+  ordered_record->values[ordered_record->count++] = (uint32_t)(intptr_t)value;
+
+  return IOTC_STATE_OK;
+}
+
+iotc_state_t iotc_utest_local_action_block(iotc_event_handle_arg1_t flag) {
+  while (0 == __atomic_load_n((uint32_t*)flag, __ATOMIC_ACQUIRE)) {
+    usleep(100);
+  }
+
+  return IOTC_STATE_OK;
+}
+
+iotc_state_t iotc_utest_local_action_count(iotc_event_handle_arg1_t counter) {
+  __atomic_add_fetch((uint32_t*)counter, 1, __ATOMIC_RELEASE);
+
+  return IOTC_STATE_OK;
+}
+
 #endif  // IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
 
 IOTC_TT_TESTGROUP_BEGIN(utest_thread_threadpool)
@@ -253,6 +288,89 @@ IOTC_TT_TESTCASE(
       iotc_destroy_critical_section(&iotc_uteset_local_action_store_cs);
     })
 
+IOTC_TT_TESTCASE(
+    utest__iotc_threadpool_execute_ordered__multikeys__events_of_a_key_executed_in_order,
+    {
+      iotc_utest_local_ordered_record_t records[5];
+      memset(records, 0, sizeof(records));
+
+      iotc_threadpool_t* threadpool = iotc_threadpool_create_instance(4);
+      tt_ptr_op(NULL, !=, threadpool);
+
+      uint32_t counter_event = 0;
+      for (; counter_event < IOTC_UTEST_THREADPOOL_ORDERED_EVENTS;
+           ++counter_event) {
+        uint8_t counter_key = 0;
+        for (; counter_key < IOTC_ARRAYSIZE(records); ++counter_key) {
+          tt_ptr_op(NULL, !=,
+                    iotc_threadpool_execute_ordered(
+                        threadpool,
+                        iotc_make_threaded_handle(
+                            IOTC_THREADID_ANYTHREAD,
+                            &iotc_utest_local_action_record_value,
+                            &records[counter_key],
+                            (void*)(intptr_t)counter_event),
+                        &records[counter_key]));
+        }
+      }
+
+      iotc_threadpool_destroy_instance(&threadpool);
+
+      uint8_t counter_key = 0;
+      for (; counter_key < IOTC_ARRAYSIZE(records); ++counter_key) {
+        tt_want_int_op(IOTC_UTEST_THREADPOOL_ORDERED_EVENTS, ==,
+                       records[counter_key].count);
+
+        for (counter_event = 0;
+             counter_event < IOTC_UTEST_THREADPOOL_ORDERED_EVENTS;
+             ++counter_event) {
+          tt_want_int_op(counter_event, ==,
+                         records[counter_key].values[counter_event]);
+        }
+      }
+    end:
+      iotc_threadpool_destroy_instance(&threadpool);
+    })
+
+IOTC_TT_TESTCASE(
+    utest__iotc_threadpool_execute__one_workerthread_blocked__its_events_stolen_by_the_other,
+    {
+      uint32_t unblock = 0;
+      uint32_t executed = 0;
+      const uint32_t events = 20;
+
+      iotc_threadpool_t* threadpool = iotc_threadpool_create_instance(2);
+      tt_ptr_op(NULL, !=, threadpool);
+
+      iotc_threadpool_execute(
+          threadpool,
+          iotc_make_threaded_handle(IOTC_THREADID_ANYTHREAD,
+                                    &iotc_utest_local_action_block, &unblock));
+
+      /* every second event is queued for the blocked workerthread */
+      uint32_t counter_event = 0;
+      for (; counter_event < events; ++counter_event) {
+        iotc_threadpool_execute(
+            threadpool,
+            iotc_make_threaded_handle(IOTC_THREADID_ANYTHREAD,
+                                      &iotc_utest_local_action_count,
+                                      &executed));
+      }
+
+      uint32_t counter_wait = 0;
+      for (; counter_wait < 5000 &&
+             events != __atomic_load_n(&executed, __ATOMIC_ACQUIRE);
+           ++counter_wait) {
+        usleep(1000);
+      }
+
+      tt_want_int_op(events, ==, __atomic_load_n(&executed, __ATOMIC_ACQUIRE));
+
+    end:
+      __atomic_store_n(&unblock, 1, __ATOMIC_RELEASE);
+      iotc_threadpool_destroy_instance(&threadpool);
+    })
+
 IOTC_TT_TESTGROUP_END
 
 #ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
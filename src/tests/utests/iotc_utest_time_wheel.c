@@ -0,0 +1,156 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "iotc_bsp_rng.h"
+#include "iotc_memory_checks.h"
+#include "iotc_tt_testcase_management.h"
+#include "iotc_utest_basic_testcase_frame.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc.h"
+#include "iotc_time_wheel.h"
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+#define TEST_TIME_WHEEL_TEST_SIZE 256
+
+#endif
+
+IOTC_TT_TESTGROUP_BEGIN(utest_time_wheel)
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_time_wheel_get_top__random_times_across_levels__sorted_order,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_bsp_rng_init();
+
+      iotc_time_wheel_t* wheel = iotc_time_wheel_create();
+      tt_assert(NULL != wheel);
+
+      iotc_time_event_t time_events[TEST_TIME_WHEEL_TEST_SIZE] = {
+          iotc_make_empty_time_event()};
+
+      /* times up to 2^26 spread the time events over every level and the
+       * overflow list */
+      int i = 0;
+      for (; i < TEST_TIME_WHEEL_TEST_SIZE; ++i) {
+        time_events[i].time_of_execution =
+            (i % 2) ? iotc_bsp_rng_get() % 100
+                    : (iotc_bsp_rng_get() % ((iotc_time_t)1 << 26));
+
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_time_wheel_add(wheel, &time_events[i], NULL));
+      }
+
+      iotc_time_t last_time = 0;
+      for (i = 0; i < TEST_TIME_WHEEL_TEST_SIZE; ++i) {
+        iotc_time_event_t* time_event = iotc_time_wheel_get_top(wheel);
+
+        tt_assert(NULL != time_event);
+        tt_assert(time_event->time_of_execution >= last_time);
+        last_time = time_event->time_of_execution;
+      }
+
+      tt_assert(0 == wheel->size);
+      tt_assert(NULL == iotc_time_wheel_peek_top(wheel));
+
+    end:
+      iotc_time_wheel_destroy(wheel);
+      iotc_bsp_rng_shutdown();
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_time_wheel_restart__earlier_than_now__becomes_top,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_time_wheel_t* wheel = iotc_time_wheel_create();
+      tt_assert(NULL != wheel);
+
+      iotc_time_event_t time_events[3] = {iotc_make_empty_time_event()};
+      iotc_time_event_handle_t time_event_handles[3] = {
+          iotc_make_empty_time_event_handle()};
+
+      time_events[0].time_of_execution = 10;
+      time_events[1].time_of_execution = 5000;
+      time_events[2].time_of_execution = 7000;
+
+      int i = 0;
+      for (; i < 3; ++i) {
+        tt_assert(IOTC_STATE_OK == iotc_time_wheel_add(wheel, &time_events[i],
+                                                       &time_event_handles[i]));
+      }
+
+      tt_assert(&time_events[0] == iotc_time_wheel_get_top(wheel));
+      tt_assert(NULL == time_event_handles[0].ptr_to_position);
+
+      /* peeking cascades the wheel forward to the slot of 5000 */
+      tt_assert(&time_events[1] == iotc_time_wheel_peek_top(wheel));
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_time_wheel_restart(wheel, &time_event_handles[2], 3));
+      tt_assert(&time_events[2] == iotc_time_wheel_peek_top(wheel));
+
+      tt_assert(IOTC_STATE_OK ==
+                iotc_time_wheel_restart(wheel, &time_event_handles[1], 2));
+      tt_assert(&time_events[1] == iotc_time_wheel_get_top(wheel));
+      tt_assert(&time_events[2] == iotc_time_wheel_get_top(wheel));
+
+    end:
+      iotc_time_wheel_destroy(wheel);
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_time_wheel_cancel_all_elements__elements_removed_their_handlers_cleared,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_time_wheel_t* wheel = iotc_time_wheel_create();
+      tt_assert(NULL != wheel);
+
+      iotc_time_event_t time_events[TEST_TIME_WHEEL_TEST_SIZE] = {
+          iotc_make_empty_time_event()};
+      iotc_time_event_handle_t time_event_handles[TEST_TIME_WHEEL_TEST_SIZE] = {
+          iotc_make_empty_time_event_handle()};
+
+      int i = 0;
+      for (; i < TEST_TIME_WHEEL_TEST_SIZE; ++i) {
+        time_events[i].time_of_execution = i * 97;
+
+        tt_assert(IOTC_STATE_OK == iotc_time_wheel_add(wheel, &time_events[i],
+                                                       &time_event_handles[i]));
+      }
+
+      for (i = 0; i < TEST_TIME_WHEEL_TEST_SIZE; ++i) {
+        iotc_time_event_t* cancelled_time_event = NULL;
+
+        tt_assert(IOTC_STATE_OK ==
+                  iotc_time_wheel_cancel(wheel, &time_event_handles[i],
+                                         &cancelled_time_event));
+        tt_assert(&time_events[i] == cancelled_time_event);
+        tt_assert(NULL == time_event_handles[i].ptr_to_position);
+      }
+
+      tt_assert(0 == wheel->size);
+      tt_assert(NULL == iotc_time_wheel_peek_top(wheel));
+
+    end:
+      iotc_time_wheel_destroy(wheel);
+    })
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
@@ -115,6 +115,38 @@ IOTC_TT_TESTCASE(utest__add_timed_task__callback_called, {
 end:;
 })
 
+IOTC_TT_TESTCASE(
+    utest__add_timed_task__sub_second_interval__callback_called_on_time, {
+      iotc_utest_timed_task_reset_globals();
+      iotc_evtd_instance_t* dispatcher = iotc_evtd_create_instance();
+      iotc_timed_task_container_t* container =
+          iotc_make_timed_task_container();
+
+      iotc_context_handle_t context_handle = 1;
+
+      /* the dispatcher counts milliseconds */
+      iotc_evtd_step(dispatcher, 1000);
+
+      iotc_timed_task_handle_t task_handle =
+          iotc_add_timed_task(container, dispatcher, context_handle,
+                              &iotc_utest_timed_task_callback, 250, 0, NULL);
+
+      iotc_evtd_step(dispatcher, 1249);
+
+      tt_want_int_op(task_handle, !=,
+                     iotc_utest_timed_task_last_timed_task_handle);
+
+      iotc_evtd_step(dispatcher, 1250);
+
+      tt_want_int_op(task_handle, ==,
+                     iotc_utest_timed_task_last_timed_task_handle);
+
+      iotc_destroy_timed_task_container(container);
+      iotc_evtd_destroy_instance(dispatcher);
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+    end:;
+    })
+
 IOTC_TT_TESTCASE(
     utest__remove_timed_task__called_after_fired_callback_wont_break, {
       iotc_utest_timed_task_reset_globals();
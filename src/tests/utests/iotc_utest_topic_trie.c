@@ -0,0 +1,313 @@
+/* Copyright 2018-2020 Google LLC
+ *
+ * This is part of the Google Cloud IoT Device SDK for Embedded C.
+ * It is licensed under the BSD 3-Clause license; you may not use this file
+ * except in compliance with the License.
+ *
+ * You may obtain a copy of the License at:
+ *  https://opensource.org/licenses/BSD-3-Clause
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iotc_utest_basic_testcase_frame.h"
+#include "tinytest.h"
+#include "tinytest_macros.h"
+
+#include "iotc_macros.h"
+#include "iotc_memory_checks.h"
+#include "iotc_topic_trie.h"
+#include "iotc_tt_testcase_management.h"
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+
+typedef struct {
+  int values[8];
+  size_t values_no;
+} iotc_utest_topic_trie_matches_t;
+
+static void iotc_utest_topic_trie_collect(void* value, void* arg) {
+  iotc_utest_topic_trie_matches_t* matches =
+      (iotc_utest_topic_trie_matches_t*)arg;
+
+  if (matches->values_no < IOTC_ARRAYSIZE(matches->values)) {
+    matches->values[matches->values_no] = *(int*)value;
+  }
+
+  matches->values_no += 1;
+}
+
+static size_t iotc_utest_topic_trie_match(const iotc_topic_trie_t* trie,
+                                          const char* topic,
+                                          iotc_utest_topic_trie_matches_t* out) {
+  memset(out, 0, sizeof(iotc_utest_topic_trie_matches_t));
+
+  return iotc_topic_trie_match(trie, (const uint8_t*)topic,
+                               (NULL == topic) ? 0 : strlen(topic),
+                               &iotc_utest_topic_trie_collect, out);
+}
+
+static uint8_t iotc_utest_topic_trie_contains(
+    const iotc_utest_topic_trie_matches_t* matches, int value) {
+  size_t i = 0;
+  for (; i < matches->values_no; ++i) {
+    if (matches->values[i] == value) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static void iotc_utest_topic_trie_count(void* value, void* arg) {
+  IOTC_UNUSED(value);
+  *(size_t*)arg += 1;
+}
+
+#endif
+
+IOTC_TT_TESTGROUP_BEGIN(utest_topic_trie)
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_topic_trie_match__single_filter__matches_like_mqtt,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      typedef struct {
+        const char* topic_filter;
+        const char* topic;
+        const uint8_t expected_match;
+      } iotc_utest_topic_trie_case_t;
+
+      const iotc_utest_topic_trie_case_t test_cases[] = {
+          /* literal levels */
+          {"t", "t", 1},
+          {"t", "t/", 0},
+          {"t/subfolder", "t", 0},
+          {"t1", "t2", 0},
+          {"long_topic_name", "long_topic_name_different_length", 0},
+          {"/devices/d1/commands", "/devices/d1/commands", 1},
+
+          /* multi level wildcard */
+          {"#", "t", 1},
+          {"#", "multi/level/topic/name", 1},
+          {"#", "/leading/separator", 1},
+          {"t/#", "t", 1},
+          {"t/#", "t/", 1},
+          {"t/#", "t/subfolder", 1},
+          {"t1/#", "t2", 0},
+          {"t1/#", "t2/subfolder", 0},
+          {"multi/level/#", "multi/level", 1},
+          {"multi/level/#", "multi/level/topic/name/", 1},
+          {"multi/level/#", "multi/leve", 0},
+          {"multi/level/#", "multi/level2/topic/name", 0},
+
+          /* single level wildcard */
+          {"+", "t", 1},
+          {"+", "t/subfolder", 0},
+          {"+/+", "/t", 1},
+          {"t/+", "t/", 1},
+          {"t/+", "t", 0},
+          {"t/+/c", "t/b/c", 1},
+          {"t/+/c", "t/b/d", 0},
+          {"t/+/#", "t/b", 1},
+          {"/devices/+/commands/#", "/devices/d1/commands/sub", 1},
+
+          /* wildcards of the first level skip the $ topics */
+          {"#", "$SYS/uptime", 0},
+          {"+/uptime", "$SYS/uptime", 0},
+          {"$SYS/#", "$SYS/uptime", 1},
+          {"t/+", "t/$x", 1},
+
+          /* empty topic */
+          {"#", "", 0},
+          {"#", NULL, 0},
+      };
+
+      size_t i = 0;
+      for (; i < IOTC_ARRAYSIZE(test_cases); ++i) {
+        iotc_topic_trie_t* trie = iotc_topic_trie_create();
+        tt_ptr_op(NULL, !=, trie);
+
+        int value = (int)i;
+        iotc_utest_topic_trie_matches_t matches;
+
+        tt_int_op(IOTC_STATE_OK, ==,
+                  iotc_topic_trie_add(trie, test_cases[i].topic_filter, &value));
+
+        if (test_cases[i].expected_match !=
+            iotc_utest_topic_trie_match(trie, test_cases[i].topic, &matches)) {
+          TT_FAIL(("filter [%s] topic [%s] expected match: %d",
+                   test_cases[i].topic_filter,
+                   test_cases[i].topic ? test_cases[i].topic : "NULL",
+                   test_cases[i].expected_match));
+        }
+
+        iotc_topic_trie_destroy(trie);
+      }
+
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+
+    end:;
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_topic_trie_add__empty_filter__invalid_parameter_returned,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_topic_trie_t* trie = iotc_topic_trie_create();
+      tt_ptr_op(NULL, !=, trie);
+
+      int value = 0;
+
+      tt_int_op(IOTC_INVALID_PARAMETER, ==,
+                iotc_topic_trie_add(trie, NULL, &value));
+      tt_int_op(IOTC_INVALID_PARAMETER, ==,
+                iotc_topic_trie_add(trie, "", &value));
+
+      tt_uint_op(0, ==, trie->elem_no);
+
+      iotc_topic_trie_destroy(trie);
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+
+    end:;
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_topic_trie_add__misplaced_wildcards__levels_matched_literally,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      const char* filters[] = {"a/#/b", "a#", "a/b+", "#/a", "+a/b"};
+
+      iotc_topic_trie_t* trie = iotc_topic_trie_create();
+      tt_ptr_op(NULL, !=, trie);
+
+      int values[] = {0, 1, 2, 3, 4};
+      iotc_utest_topic_trie_matches_t matches;
+
+      size_t i = 0;
+      for (; i < IOTC_ARRAYSIZE(filters); ++i) {
+        tt_int_op(IOTC_STATE_OK, ==,
+                  iotc_topic_trie_add(trie, filters[i], &values[i]));
+      }
+
+      tt_uint_op(IOTC_ARRAYSIZE(filters), ==, trie->elem_no);
+
+      /* the misplaced '#' isn't a wildcard, '+' of a whole level still is */
+      tt_int_op(0, ==, iotc_utest_topic_trie_match(trie, "a/c/b", &matches));
+      tt_int_op(0, ==, iotc_utest_topic_trie_match(trie, "a/b", &matches));
+      tt_int_op(1, ==, iotc_utest_topic_trie_match(trie, "a/b+", &matches));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 2));
+      tt_int_op(1, ==, iotc_utest_topic_trie_match(trie, "+a/b", &matches));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 4));
+
+      for (i = 0; i < IOTC_ARRAYSIZE(filters); ++i) {
+        tt_int_op(IOTC_STATE_OK, ==,
+                  iotc_topic_trie_remove(trie, filters[i], &values[i]));
+      }
+
+      tt_uint_op(0, ==, trie->elem_no);
+
+      iotc_topic_trie_destroy(trie);
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+
+    end:;
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_topic_trie_match__overlapping_filters__every_value_visited,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_topic_trie_t* trie = iotc_topic_trie_create();
+      tt_ptr_op(NULL, !=, trie);
+
+      int values[] = {0, 1, 2, 3, 4, 5};
+      iotc_utest_topic_trie_matches_t matches;
+
+      tt_int_op(IOTC_STATE_OK, ==, iotc_topic_trie_add(trie, "a/b", &values[0]));
+      tt_int_op(IOTC_STATE_OK, ==, iotc_topic_trie_add(trie, "a/+", &values[1]));
+      tt_int_op(IOTC_STATE_OK, ==, iotc_topic_trie_add(trie, "a/#", &values[2]));
+      tt_int_op(IOTC_STATE_OK, ==, iotc_topic_trie_add(trie, "#", &values[3]));
+      tt_int_op(IOTC_STATE_OK, ==, iotc_topic_trie_add(trie, "a/c", &values[4]));
+      /* the same filter can carry more than one value */
+      tt_int_op(IOTC_STATE_OK, ==, iotc_topic_trie_add(trie, "a/b", &values[5]));
+
+      tt_uint_op(6, ==, trie->elem_no);
+
+      tt_int_op(5, ==, iotc_utest_topic_trie_match(trie, "a/b", &matches));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 0));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 1));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 2));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 3));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 5));
+
+      tt_int_op(2, ==, iotc_utest_topic_trie_match(trie, "a", &matches));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 2));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 3));
+
+      tt_int_op(1, ==, iotc_utest_topic_trie_match(trie, "b", &matches));
+      tt_int_op(1, ==, iotc_utest_topic_trie_contains(&matches, 3));
+
+      size_t visited = 0;
+      iotc_topic_trie_for_each(trie, &iotc_utest_topic_trie_count, &visited);
+      tt_uint_op(6, ==, visited);
+
+      iotc_topic_trie_destroy(trie);
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+
+    end:;
+    })
+
+IOTC_TT_TESTCASE_WITH_SETUP(
+    utest__iotc_topic_trie_remove__many_filters__nothing_matches,
+    iotc_utest_setup_basic, iotc_utest_teardown_basic, NULL, {
+      iotc_topic_trie_t* trie = iotc_topic_trie_create();
+      tt_ptr_op(NULL, !=, trie);
+
+      /* enough siblings to grow the hash table of a level a few times */
+      int values[100];
+      char topic_filter[32];
+      iotc_utest_topic_trie_matches_t matches;
+
+      size_t i = 0;
+      for (; i < IOTC_ARRAYSIZE(values); ++i) {
+        values[i] = (int)i;
+        sprintf(topic_filter, "devices/d%d/+", (int)i);
+        tt_int_op(IOTC_STATE_OK, ==,
+                  iotc_topic_trie_add(trie, topic_filter, &values[i]));
+      }
+
+      tt_int_op(1, ==,
+                iotc_utest_topic_trie_match(trie, "devices/d42/x", &matches));
+      tt_int_op(42, ==, matches.values[0]);
+
+      tt_int_op(IOTC_ELEMENT_NOT_FOUND, ==,
+                iotc_topic_trie_remove(trie, "devices/d42", &values[42]));
+      tt_int_op(IOTC_ELEMENT_NOT_FOUND, ==,
+                iotc_topic_trie_remove(trie, "devices/d42/+", &values[41]));
+
+      for (i = 0; i < IOTC_ARRAYSIZE(values); ++i) {
+        sprintf(topic_filter, "devices/d%d/+", (int)i);
+        tt_int_op(IOTC_STATE_OK, ==,
+                  iotc_topic_trie_remove(trie, topic_filter, &values[i]));
+      }
+
+      tt_uint_op(0, ==, trie->elem_no);
+      tt_int_op(0, ==,
+                iotc_utest_topic_trie_match(trie, "devices/d42/x", &matches));
+
+      iotc_topic_trie_destroy(trie);
+      tt_int_op(iotc_is_whole_memory_deallocated(), >, 0);
+
+    end:;
+    })
+
+IOTC_TT_TESTGROUP_END
+
+#ifndef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#define IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#include __FILE__
+#undef IOTC_TT_TESTCASE_ENUMERATION__SECONDPREPROCESSORRUN
+#endif
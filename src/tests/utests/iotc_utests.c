@@ -38,13 +38,17 @@
 #define IOTC_TT_THREAD                            ( IOTC_TT_MEMORY_LIMITER << 1 )
 #define IOTC_TT_THREAD_WORKERTHREAD               ( IOTC_TT_THREAD << 1 )
 #define IOTC_TT_THREAD_THREADPOOL                 ( IOTC_TT_THREAD_WORKERTHREAD << 1 )
-#define IOTC_TT_HELPERS                           ( IOTC_TT_THREAD_THREADPOOL << 1 )
+#define IOTC_TT_THREAD_IO_LOOP                    ( IOTC_TT_THREAD_THREADPOOL << 1 )
+#define IOTC_TT_HELPERS                           ( IOTC_TT_THREAD_IO_LOOP << 1 )
 #define IOTC_TT_MQTT_CODEC_LAYER_DATA             ( IOTC_TT_HELPERS << 1 )
 #define IOTC_TT_PUBLISH                           ( IOTC_TT_MQTT_CODEC_LAYER_DATA << 1 )
 #define IOTC_TT_FS                                ( IOTC_TT_PUBLISH << 1 )
 #define IOTC_TT_RESOURCE_MANAGER                  ( IOTC_TT_FS << 1 )
 #define IOTC_TT_IO_LAYER                          ( IOTC_TT_RESOURCE_MANAGER << 1 )
 #define IOTC_TT_TIME_EVENT                        ( IOTC_TT_IO_LAYER << 1 )
+#define IOTC_TT_MQTT_LOGIC_IN_FLIGHT              ( IOTC_TT_TIME_EVENT << 1 )
+#define IOTC_TT_JWT_ROTATION                      ( IOTC_TT_MQTT_LOGIC_IN_FLIGHT << 1 )
+#define IOTC_TT_OFFLINE_QUEUE                     ( IOTC_TT_JWT_ROTATION << 1 )
 
 // clang-format on
 
@@ -62,12 +66,16 @@ IOTC_TT_TESTCASE_PREDECLARATION(utest_event_dispatcher);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_event_dispatcher_timed);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_datastructures);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_list);
+IOTC_TT_TESTCASE_PREDECLARATION(utest_topic_trie);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_data_desc);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_backoff);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_memory_calloc);
+IOTC_TT_TESTCASE_PREDECLARATION(utest_mem_pool);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_mqtt_ctors_dtors);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_mqtt_parser);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_mqtt_logic_layer_subscribe);
+IOTC_TT_TESTCASE_PREDECLARATION(utest_mqtt_logic_in_flight);
+IOTC_TT_TESTCASE_PREDECLARATION(utest_jwt_rotation);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_mqtt_codec_layer_data);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_publish);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_helpers);
@@ -86,6 +94,7 @@ IOTC_TT_TESTCASE_PREDECLARATION(utest_rng);
 #include "iotc_utest_thread.h"
 #include "iotc_utest_thread_workerthread.h"
 #include "iotc_utest_thread_threadpool.h"
+#include "iotc_utest_thread_io_loop.h"
 #endif
 
 IOTC_TT_TESTCASE_PREDECLARATION(utest_resource_manager);
@@ -104,7 +113,12 @@ IOTC_TT_TESTCASE_PREDECLARATION(utest_fs_dummy);
 IOTC_TT_TESTCASE_PREDECLARATION(utest_fs_posix);
 #endif
 
+#if defined(IOTC_FS_POSIX) || defined(IOTC_FS_MEMORY)
+IOTC_TT_TESTCASE_PREDECLARATION(utest_offline_queue);
+#endif
+
 IOTC_TT_TESTCASE_PREDECLARATION(utest_time_event);
+IOTC_TT_TESTCASE_PREDECLARATION(utest_time_wheel);
 
 #include "iotc_test_utils.h"
 #include "iotc_lamp_communication.h"
@@ -121,6 +135,7 @@ struct testgroup_t groups[] = {
 #if (IOTC_TT_TEST_SET & IOTC_TT_DATASTRUCTURES)
     {"utest_datastructures - ", utest_datastructures},
     {"utest_list - ", utest_list},
+    {"utest_topic_trie - ", utest_topic_trie},
 #endif
 
 #if (IOTC_TT_TEST_SET & IOTC_TT_EVENT_DISPATCHER)
@@ -159,6 +174,19 @@ struct testgroup_t groups[] = {
     {"utest_mqtt_logic_layer_subscribe - ", utest_mqtt_logic_layer_subscribe},
 #endif
 
+#if (IOTC_TT_TEST_SET & IOTC_TT_MQTT_LOGIC_IN_FLIGHT)
+    {"utest_mqtt_logic_in_flight - ", utest_mqtt_logic_in_flight},
+#endif
+
+#if (IOTC_TT_TEST_SET & IOTC_TT_JWT_ROTATION)
+    {"utest_jwt_rotation - ", utest_jwt_rotation},
+#endif
+
+#if (IOTC_TT_TEST_SET & IOTC_TT_OFFLINE_QUEUE) && \
+    (defined(IOTC_FS_POSIX) || defined(IOTC_FS_MEMORY))
+    {"utest_offline_queue - ", utest_offline_queue},
+#endif
+
 #if (IOTC_TT_TEST_SET & IOTC_TT_PUBLISH)
     {"utest_publish - ", utest_publish},
 #endif
@@ -185,6 +213,10 @@ struct testgroup_t groups[] = {
 #if (IOTC_TT_TEST_SET & IOTC_TT_THREAD_THREADPOOL)
     {"utest_thread_threadpool - ", utest_thread_threadpool},
 #endif
+
+#if (IOTC_TT_TEST_SET & IOTC_TT_THREAD_IO_LOOP)
+    {"utest_thread_io_loop - ", utest_thread_io_loop},
+#endif
 #endif
 
 #if (IOTC_TT_TEST_SET & IOTC_TT_HELPERS)
@@ -198,6 +230,8 @@ struct testgroup_t groups[] = {
 
     {"utest_memory_calloc  - ", utest_memory_calloc},
 
+    {"utest_mem_pool - ", utest_mem_pool},
+
 #if (IOTC_TT_TEST_SET & IOTC_TT_MQTT_CODEC_LAYER_DATA)
     {"utest_mqtt_codec_layer_data - ", utest_mqtt_codec_layer_data},
 #endif
@@ -221,6 +255,7 @@ struct testgroup_t groups[] = {
 
 #if (IOTC_TT_TEST_SET & IOTC_TT_TIME_EVENT)
     {"utest_time_event - ", utest_time_event},
+    {"utest_time_wheel - ", utest_time_wheel},
 #endif
 
     {"utest_rng - ", utest_rng},
@@ -66,7 +66,10 @@ iotc_state_t proc_loop_thread(iotc_event_handle_arg1_t a) {
 #endif
 
 IOTC_TT_TESTCASE(utest__thread_safety_clash__entities_must_not_clash, {
+  iotc_fd_t fds[3] = {-1, -1, -1};
+
   evtd_g_i = iotc_evtd_create_instance();
+  tt_assert(utest_evtd_open_sockets(fds));
 
   uint32_t counter = 10;
   iotc_time_t step = 0;
@@ -81,17 +84,17 @@ IOTC_TT_TESTCASE(utest__thread_safety_clash__entities_must_not_clash, {
       IOTC_EVENT_HANDLE_ARGC1,
       .handlers.h1 = {&register_evtd_handle,
                       (iotc_event_handle_arg1_t)&evtd_g_i}};
-  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 12, evtd_handle) != 0);
+  tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[0], evtd_handle) != 0);
 
   tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
   iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_ERROR, evtd_handle,
-                                        12);
+                                        fds[0]);
   tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
 
-  while (evtd_g_i->time_events_container->elem_no > 0) {
+  while (iotc_time_event_container_size(evtd_g_i->time_events_container) > 0) {
     tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
     iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_WANT_READ,
-                                          evtd_handle, 12);
+                                          evtd_handle, fds[0]);
     tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
 
     iotc_evtd_step(evtd_g_i, step);
@@ -102,10 +105,11 @@ IOTC_TT_TESTCASE(utest__thread_safety_clash__entities_must_not_clash, {
   tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
   tt_assert(counter == 0);
   tt_assert(step == 10);
-  iotc_evtd_unregister_socket_fd(evtd_g_i, 12);
+  iotc_evtd_unregister_socket_fd(evtd_g_i, fds[0]);
 
 end:
   iotc_evtd_destroy_instance(evtd_g_i);
+  utest_evtd_close_sockets();
 })
 
 IOTC_TT_TESTCASE(
@@ -127,21 +131,26 @@ IOTC_TT_TESTCASE(
 
 IOTC_TT_TESTCASE(
     utest__thread_safety_clash_event_handler_on_stop__entities_must_not_clash, {
+      iotc_fd_t fds[3] = {-1, -1, -1};
+
       evtd_g_i = iotc_evtd_create_instance();
+      tt_assert(utest_evtd_open_sockets(fds));
 
       iotc_event_handle_t evtd_handle = {
           IOTC_EVENT_HANDLE_ARGC1,
           .handlers.h1 = {&stop_evtd_handle,
                           (iotc_event_handle_arg1_t)&evtd_g_i}};
-      tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, 12, evtd_handle) != 0);
+      tt_assert(iotc_evtd_register_socket_fd(evtd_g_i, fds[0], evtd_handle) !=
+                0);
 
       tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
       iotc_evtd_continue_when_evt_on_socket(evtd_g_i, IOTC_EVENT_WANT_READ,
-                                            evtd_handle, 12);
+                                            evtd_handle, fds[0]);
       tt_want_int_op(evtd_g_i->cs->cs_state, ==, 0);
 
-      iotc_evtd_unregister_socket_fd(evtd_g_i, 12);
-      iotc_evtd_destroy_instance(evtd_g_i);
+      iotc_evtd_unregister_socket_fd(evtd_g_i, fds[0]);
 
-    end:;
+    end:
+      iotc_evtd_destroy_instance(evtd_g_i);
+      utest_evtd_close_sockets();
     })
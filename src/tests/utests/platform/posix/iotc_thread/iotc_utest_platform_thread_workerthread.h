@@ -183,9 +183,8 @@ IOTC_TT_TESTCASE(
             (iotc_event_handle_arg1_t)&value_shared_between_threads,
             nb_handler_additions[id_handler_adds]);
 
-        while (
-            !IOTC_LIST_EMPTY(iotc_event_handle_t,
-                             workerthread->thread_evtd_secondary->call_queue)) {
+        while (!iotc_event_handle_mpsc_empty(
+            &workerthread->thread_evtd_secondary->call_queue)) {
           IOTC_TIME_MILLISLEEP(10, deltatime);
         }
 
@@ -236,9 +235,8 @@ IOTC_TT_TESTCASE(
             (iotc_event_handle_arg1_t)&value_shared_between_threads,
             nb_handler_additions[id_handler_adds]);
 
-        while (
-            !IOTC_LIST_EMPTY(iotc_event_handle_t,
-                             workerthread->thread_evtd_secondary->call_queue)) {
+        while (!iotc_event_handle_mpsc_empty(
+            &workerthread->thread_evtd_secondary->call_queue)) {
           IOTC_TIME_MILLISLEEP(10, deltatime);
         }
 
@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "iotc_allocator.h"
+#include "iotc_config.h"
 #include "iotc_coroutine.h"
 #include "iotc_layer.h"
 #include "iotc_macros.h"
@@ -26,6 +27,23 @@
 #include "iotc_mqtt_message.h"
 #include "iotc_mqtt_parser.h"
 
+/* The length of a string or a payload is known before its first byte is read,
+ * so the destination is allocated once, together with its descriptor, with
+ * room for the whole field and a terminating zero. Each chunk of the receive
+ * buffer is then copied exactly once instead of growing the destination from
+ * a few bytes. */
+static iotc_state_t make_sized_desc(iotc_data_desc_t** dst, size_t length) {
+  if (NULL != *dst) {
+    return IOTC_STATE_OK;
+  }
+
+  /* the remaining length comes from the peer, so don't trust it blindly */
+  *dst = iotc_make_empty_desc_alloc_inline(
+      IOTC_MIN(length, (size_t)IOTC_MQTT_MAX_PAYLOAD_SIZE) + 1);
+
+  return (NULL == *dst) ? IOTC_OUT_OF_MEMORY : IOTC_STATE_OK;
+}
+
 static iotc_state_t read_string(iotc_mqtt_parser_t* parser,
                                 iotc_data_desc_t** dst, iotc_data_desc_t* src) {
   assert(NULL != parser);
@@ -38,16 +56,13 @@ static iotc_state_t read_string(iotc_mqtt_parser_t* parser,
   size_t src_left = 0;
   size_t len_to_read = 0;
 
-  /* Check for the existance of the data descriptor. */
-  if (NULL == *dst) {
-    IOTC_CHECK_MEMORY(*dst = iotc_make_empty_desc_alloc(4), local_state);
+  /* Local variables, the destination exists once the length is known. */
+  if (NULL != *dst) {
+    to_read = parser->str_length - (*dst)->length;
+    src_left = src->length - src->curr_pos;
+    len_to_read = IOTC_MIN(to_read, src_left);
   }
 
-  /* Local variables. */
-  to_read = parser->str_length - (*dst)->length;
-  src_left = src->length - src->curr_pos;
-  len_to_read = IOTC_MIN(to_read, src_left);
-
   IOTC_CR_START(parser->read_cs);
 
   IOTC_CR_YIELD_ON(parser->read_cs, ((src->curr_pos - src->length) == 0),
@@ -62,6 +77,8 @@ static iotc_state_t read_string(iotc_mqtt_parser_t* parser,
   src->curr_pos += 1;
   parser->data_length += 1;
 
+  IOTC_CHECK_STATE(local_state = make_sized_desc(dst, parser->str_length));
+
   to_read = parser->str_length - (*dst)->length;
   src_left = src->length - src->curr_pos;
   len_to_read = IOTC_MIN(to_read, src_left);
@@ -122,9 +139,7 @@ static iotc_state_t read_data(iotc_mqtt_parser_t* parser,
   size_t src_left = 0;
   size_t len_to_read = 0;
 
-  if (NULL == *dst) {
-    IOTC_CHECK_MEMORY(*dst = iotc_make_empty_desc_alloc(4), local_state);
-  }
+  IOTC_CHECK_STATE(local_state = make_sized_desc(dst, parser->str_length));
 
   /* Local variables. */
   to_read = parser->str_length - (*dst)->length;
@@ -156,25 +171,25 @@ err_handling:
   IOTC_CR_END();
 }
 
-#define READ_STRING(into)                                                  \
-  do {                                                                     \
-    local_state = read_string(parser, into, src);                          \
-    IOTC_CR_YIELD_UNTIL(parser->cs, (local_state == IOTC_STATE_WANT_READ), \
-                        IOTC_STATE_WANT_READ);                             \
-    if (local_state != IOTC_STATE_OK) {                                    \
-      IOTC_CR_EXIT(parser->cs, local_state);                               \
-    }                                                                      \
-  } while (local_state != IOTC_STATE_OK)
-
-#define READ_DATA(into)                                                    \
-  do {                                                                     \
-    local_state = read_data(parser, into, src);                            \
-    IOTC_CR_YIELD_UNTIL(parser->cs, (local_state == IOTC_STATE_WANT_READ), \
-                        IOTC_STATE_WANT_READ);                             \
-    if (local_state != IOTC_STATE_OK) {                                    \
-      IOTC_CR_EXIT(parser->cs, local_state);                               \
-    }                                                                      \
-  } while (local_state != IOTC_STATE_OK)
+#define READ_STRING(into)                                                      \
+  do {                                                                         \
+    parser->state = read_string(parser, into, src);                            \
+    IOTC_CR_YIELD_UNTIL(parser->cs, (parser->state == IOTC_STATE_WANT_READ),   \
+                        IOTC_STATE_WANT_READ);                                 \
+    if (parser->state != IOTC_STATE_OK) {                                      \
+      IOTC_CR_EXIT(parser->cs, parser->state);                                 \
+    }                                                                          \
+  } while (parser->state != IOTC_STATE_OK)
+
+#define READ_DATA(into)                                                        \
+  do {                                                                         \
+    parser->state = read_data(parser, into, src);                              \
+    IOTC_CR_YIELD_UNTIL(parser->cs, (parser->state == IOTC_STATE_WANT_READ),   \
+                        IOTC_STATE_WANT_READ);                                 \
+    if (parser->state != IOTC_STATE_OK) {                                      \
+      IOTC_CR_EXIT(parser->cs, parser->state);                                 \
+    }                                                                          \
+  } while (parser->state != IOTC_STATE_OK)
 
 void iotc_mqtt_parser_init(iotc_mqtt_parser_t* parser) {
   memset(parser, 0, sizeof(iotc_mqtt_parser_t));
@@ -191,11 +206,10 @@ iotc_state_t iotc_mqtt_parser_execute(iotc_mqtt_parser_t* parser,
                                       iotc_mqtt_message_t* message,
                                       iotc_data_desc_t* data_buffer_desc) {
   iotc_data_desc_t* src = data_buffer_desc;
-  static iotc_state_t local_state = IOTC_STATE_OK;
 
   IOTC_CR_START(parser->cs);
 
-  local_state = IOTC_STATE_OK;
+  parser->state = IOTC_STATE_OK;
 
   IOTC_CR_YIELD_ON(parser->cs, ((src->curr_pos - src->length) == 0),
                    IOTC_STATE_WANT_READ);
@@ -419,7 +433,7 @@ iotc_state_t iotc_mqtt_parser_execute(iotc_mqtt_parser_t* parser,
                      IOTC_STATE_WANT_READ);
 
     IOTC_ALLOC_AT(iotc_mqtt_topicpair_t, message->subscribe.topics,
-                  local_state);
+                  parser->state);
 
     READ_STRING(&message->subscribe.topics->name);
 
@@ -451,10 +465,11 @@ iotc_state_t iotc_mqtt_parser_execute(iotc_mqtt_parser_t* parser,
     IOTC_CR_YIELD_ON(parser->cs, ((src->curr_pos - src->length) == 0),
                      IOTC_STATE_WANT_READ);
 
-    IOTC_ALLOC_AT(iotc_mqtt_topicpair_t, message->suback.topics, local_state);
+    IOTC_ALLOC_AT(iotc_mqtt_topicpair_t, message->suback.topics,
+                  parser->state);
 
     IOTC_CHECK_STATE(
-        local_state = iotc_mqtt_parse_suback_response(
+        parser->state = iotc_mqtt_parse_suback_response(
             &message->suback.topics->iotc_mqtt_topic_pair_payload_u.status,
             src->data_ptr[src->curr_pos]));
 
@@ -480,7 +495,7 @@ iotc_state_t iotc_mqtt_parser_execute(iotc_mqtt_parser_t* parser,
   }
 
 err_handling:
-  IOTC_CR_EXIT(parser->cs, local_state);
+  IOTC_CR_EXIT(parser->cs, parser->state);
 
   IOTC_CR_END();
 }
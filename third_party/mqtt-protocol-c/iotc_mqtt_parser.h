@@ -39,6 +39,9 @@ typedef enum iotc_mqtt_parser_rc_e {
 
 typedef struct iotc_mqtt_parser_s {
   iotc_mqtt_error_t error;
+  /* the READ_* loops test the state when they resume after a yield, so it
+   * has to outlive a call */
+  iotc_state_t state;
   uint16_t cs;
   uint16_t read_cs;
   char buffer_pending;
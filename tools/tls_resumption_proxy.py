@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+# Copyright 2018-2020 Google LLC
+#
+# This is part of the Google Cloud IoT Device SDK for Embedded C.
+# It is licensed under the BSD 3-Clause license; you may not use this file
+# except in compliance with the License.
+#
+# You may obtain a copy of the License at:
+#  https://opensource.org/licenses/BSD-3-Clause
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Stands in for the TLS endpoint of the MQTT bridge when trying TLS session
+# resumption locally. Terminates TLS with session tickets and session ids
+# enabled and forwards the plain MQTT stream to a local broker, e.g.
+#
+#   mosquitto -p 1883 &
+#   tools/tls_resumption_proxy.py --cert server.pem --key server.key
+#
+# Every accepted connection is logged along with whether it resumed a
+# session.
+
+import argparse
+import socket
+import ssl
+import threading
+
+
+def pump(source, sink):
+    try:
+        while True:
+            data = source.recv(4096)
+            if not data:
+                break
+            sink.sendall(data)
+    except OSError:
+        pass
+    finally:
+        for s in (source, sink):
+            try:
+                s.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+
+
+def serve(client, address, args):
+    with client:
+        print("%s:%d TLS %s, session %s" %
+              (address[0], address[1], client.version(),
+               "resumed" if client.session_reused else "new"),
+              flush=True)
+
+        with socket.create_connection(
+            (args.broker_host, args.broker_port)) as broker:
+            upstream = threading.Thread(target=pump, args=(client, broker))
+            upstream.start()
+            pump(broker, client)
+            upstream.join()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="TLS terminating proxy that resumes TLS sessions")
+    parser.add_argument("--cert", required=True,
+                        help="server certificate chain, PEM")
+    parser.add_argument("--key", required=True, help="server key, PEM")
+    parser.add_argument("--port", type=int, default=8883,
+                        help="TLS port to listen on")
+    parser.add_argument("--broker_host", default="localhost",
+                        help="host of the plain MQTT broker")
+    parser.add_argument("--broker_port", type=int, default=1883,
+                        help="port of the plain MQTT broker")
+    args = parser.parse_args()
+
+    # one context for all connections, its ticket keys and session cache
+    # outlive a single connection
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(args.cert, args.key)
+    context.options &= ~ssl.OP_NO_TICKET
+
+    with socket.create_server(("", args.port)) as listener:
+        while True:
+            sock, address = listener.accept()
+            try:
+                client = context.wrap_socket(sock, server_side=True)
+            except (ssl.SSLError, OSError) as e:
+                print("%s:%d handshake failed: %s" %
+                      (address[0], address[1], e), flush=True)
+                sock.close()
+                continue
+
+            threading.Thread(target=serve, args=(client, address, args),
+                             daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()